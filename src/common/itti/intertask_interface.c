@@ -578,8 +578,9 @@ itti_receive_msg_internal_event_fd (
 
   if (epoll_ret == 0 && polling) {
     /*
-     * No data to read -> return
+     * No data to read -> return, no events left to handle either
      */
+    itti_desc.threads[thread_id].epoll_nb_events = 0;
     return;
   }
 
@@ -632,6 +633,14 @@ itti_receive_msg (
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_RECV_MSG, __sync_or_and_fetch (&itti_desc.vcd_receive_msg, 1L << task_id));
 }
 
+void
+itti_try_receive_msg (
+  task_id_t task_id,
+  MessageDef ** received_msg)
+{
+  itti_receive_msg_internal_event_fd (task_id, 1, received_msg);
+}
+
 void
 itti_poll_msg (
   task_id_t task_id,
@@ -136,6 +136,14 @@ int itti_get_events(task_id_t task_id, struct epoll_event **events);
  **/
 void itti_receive_msg(task_id_t task_id, MessageDef **received_msg);
 
+/** \brief Retrieves a message in the queue associated to task_id, without blocking.
+ * Unlike itti_poll_msg, the task event fd is consumed too, such that it can be mixed with itti_receive_msg.
+ * The events of the other subscribed fds are updated (itti_get_events).
+ \param task_id Task ID of the receiving task
+ \param received_msg Pointer to the allocated message, NULL if the queue is empty
+ **/
+void itti_try_receive_msg(task_id_t task_id, MessageDef **received_msg);
+
 /** \brief Try to retrieves a message in the queue associated to task_id.
  \param task_id Task ID of the receiving task
  \param received_msg Pointer to the allocated message
@@ -68,6 +68,11 @@ void itti_free_msg_content (MessageDef * const message_p)
     AssertFatal(NULL == message_p->ittiMsg.sctp_data_req.payload, "TODO clean pointer");
     break;
 
+  case SCTP_DATA_MULTI_REQ:
+    bdestroy_wrapper (&message_p->ittiMsg.sctp_data_multi_req.payload);
+    free_wrapper ((void**)&message_p->ittiMsg.sctp_data_multi_req.dests);
+    break;
+
   case SCTP_DATA_IND:
     bdestroy_wrapper (&message_p->ittiMsg.sctp_data_ind.payload);
     AssertFatal(NULL == message_p->ittiMsg.sctp_data_ind.payload, "TODO clean pointer");
@@ -85,6 +90,10 @@ void itti_free_msg_content (MessageDef * const message_p)
     /** Changed to stacked buffer. */
    break;
 
+  case UDP_DATA_MULTI_IND:
+    free_wrapper ((void**)&message_p->ittiMsg.udp_data_multi_ind.datagrams);
+    break;
+
    /**
      * Sm Messages
      */
@@ -96,6 +105,8 @@ void itti_free_msg_content (MessageDef * const message_p)
   case SM_MBMS_SESSION_UPDATE_RESPONSE:
   case SM_MBMS_SESSION_STOP_RESPONSE:
     break;
+  case SM_MBMS_GW_RESTART_IND:
+    break;
   default:
     ;
   }
@@ -31,6 +31,7 @@
 
 #define SCTP_DATA_IND(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_ind
 #define SCTP_DATA_REQ(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_req
+#define SCTP_DATA_MULTI_REQ(mSGpTR)     (mSGpTR)->ittiMsg.sctp_data_multi_req
 #define SCTP_DATA_CNF(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_cnf
 #define SCTP_INIT_MSG(mSGpTR)           (mSGpTR)->ittiMsg.sctpInit
 #define SCTP_NEW_ASSOCIATION(mSGpTR)    (mSGpTR)->ittiMsg.sctp_new_peer
@@ -57,6 +58,19 @@ typedef struct sctp_data_req_s {
   uint32_t         mme_ue_s1ap_id; // for helping data_rej
 } sctp_data_req_t;
 
+/** Destination of a batched send. */
+typedef struct sctp_data_dest_s {
+  sctp_assoc_id_t  assoc_id;
+  sctp_stream_id_t stream;
+} sctp_data_dest_t;
+
+/** Same payload to several associations. A failure is confirmed per association with SCTP_DATA_CNF. */
+typedef struct sctp_data_multi_req_s {
+  bstring            payload;          ///< Sent unchanged on each destination
+  uint32_t           nb_dests;
+  sctp_data_dest_t  *dests;            ///< Allocated by the sender, released with the message
+} sctp_data_multi_req_t;
+
 typedef struct sctp_data_ind_s {
   bstring            payload;          ///< SCTP buffer
   sctp_assoc_id_t    assoc_id;         ///< SCTP physical association ID
@@ -31,4 +31,5 @@ MESSAGE_DEF(SM_MBMS_SESSION_STOP_RESPONSE,  MESSAGE_PRIORITY_MED, itti_sm_mbms_s
 
 /** Internal Messages. */
 MESSAGE_DEF(SM_REMOVE_TUNNEL,   MESSAGE_PRIORITY_MED, itti_sm_remove_tunnel_t,  sm_remove_tunnel)
+MESSAGE_DEF(SM_MBMS_GW_RESTART_IND,   MESSAGE_PRIORITY_MED, itti_sm_mbms_gw_restart_ind_t,  sm_mbms_gw_restart_ind)
 
@@ -44,6 +44,7 @@
 
 /** Internal Messages. */
 #define SM_REMOVE_TUNNEL(mSGpTR)                             	(mSGpTR)->ittiMsg.sm_remove_tunnel
+#define SM_MBMS_GW_RESTART_IND(mSGpTR)                          (mSGpTR)->ittiMsg.sm_mbms_gw_restart_ind
 
 //-----------------------------------------------------------------------------
 /** @struct itti_sm_mbms_session_start_request_t
@@ -236,4 +237,17 @@ typedef struct itti_sm_remove_tunnel_s {
   /** Cause to set (like error cause in GTPV2c State Machine). */
 } itti_sm_remove_tunnel_t;
 
+/**
+ * Restart of an MBMS-GW, detected by Sm with a changed restart counter in its Recovery IE (3GPP TS 23.007).
+ * Sm already released the GTPv2-C transactions and Sm tunnels of the MBMS-GW, no SM_REMOVE_TUNNEL is expected.
+ */
+typedef struct itti_sm_mbms_gw_restart_ind_s {
+  union {
+    struct sockaddr_in                peer_ipv4;             ///< MBMS-GW Sm IPv4 address
+    struct sockaddr_in6               peer_ipv6;             ///< MBMS-GW Sm IPv6 address
+  }mbms_peer_ip;
+  uint8_t                 restart_counter;           ///< New restart counter of the MBMS-GW
+  uint32_t                nb_tunnels;                ///< Sm tunnels released by Sm
+} itti_sm_mbms_gw_restart_ind_t;
+
 #endif /* FILE_SM_MESSAGES_TYPES_SEEN */
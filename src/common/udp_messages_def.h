@@ -29,3 +29,4 @@
 MESSAGE_DEF(UDP_INIT,     MESSAGE_PRIORITY_MED, udp_init_t,     udp_init)
 MESSAGE_DEF(UDP_DATA_REQ, MESSAGE_PRIORITY_MED, udp_data_req_t, udp_data_req)
 MESSAGE_DEF(UDP_DATA_IND, MESSAGE_PRIORITY_MED, udp_data_ind_t, udp_data_ind)
+MESSAGE_DEF(UDP_DATA_MULTI_IND, MESSAGE_PRIORITY_MED, udp_data_multi_ind_t, udp_data_multi_ind)
@@ -30,6 +30,7 @@
 #define FILE_UDP_MESSAGES_TYPES_SEEN
 
 #define UDP_INIT(mSGpTR)    (mSGpTR)->ittiMsg.udp_init
+#define UDP_DATA_MULTI_IND(mSGpTR)    (mSGpTR)->ittiMsg.udp_data_multi_ind
 #define UDP_DATA_MAX_MSG_LEN    (4096)  /**< Maximum supported gtpv2c packet length including header */
 
 typedef struct {
@@ -38,12 +39,21 @@ typedef struct {
   uint16_t         port;
 } udp_init_t;
 
+/** The datagram and the peer address are copied: the buffers of the sender may be reused before the UDP task sends. */
 typedef struct {
-  uint8_t  *buffer;
+  uint8_t                       buffer[UDP_DATA_MAX_MSG_LEN];
   uint32_t  buffer_length;
-  uint32_t  buffer_offset;
   uint16_t  local_port;
-  struct sockaddr *peer_address;
+  /** Source address, left zeroed (AF_UNSPEC) to send from the first socket of the task on the local port. */
+  union {
+	  struct sockaddr_in    addrv4;
+	  struct sockaddr_in6   addrv6;
+  }local_address;
+  union {
+	  struct sockaddr_in    addrv4;
+	  struct sockaddr_in6   addrv6;
+  }peer_address;
+
   uint16_t  peer_port;
 } udp_data_req_t;
 
@@ -59,4 +69,22 @@ typedef struct {
   uint16_t  peer_port;
 } udp_data_ind_t;
 
+typedef struct {
+  uint8_t  *buffer;                   ///< Payload, behind the datagram array
+  uint32_t  buffer_length;
+  union {
+	  struct sockaddr_in    addrv4;
+	  struct sockaddr_in6   addrv6;
+  }sock_addr;
+
+  uint16_t  peer_port;
+} udp_datagram_t;
+
+/** Datagrams read from one socket with a single recvmmsg. */
+typedef struct {
+  uint16_t         local_port;
+  uint32_t         nb_datagrams;
+  udp_datagram_t  *datagrams;         ///< Datagrams and their payloads in one allocation, released with the message
+} udp_data_multi_ind_t;
+
 #endif /* FILE_UDP_MESSAGES_TYPES_SEEN */
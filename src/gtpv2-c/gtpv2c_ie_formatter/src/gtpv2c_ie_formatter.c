@@ -166,6 +166,10 @@ gtpv2c_fteid_ie_get (
    fteid_t                                *fteid = (fteid_t *) arg;
 
    DevAssert (fteid );
+   if (ieLength < 5 || ieLength < 5 + ((ieValue[0] & 0x80) ? 4 : 0) + ((ieValue[0] & 0x40) ? 16 : 0)) {
+     OAILOG_ERROR (LOG_GTPV2C, "Bad F-TEID IE length %"PRIu16"\n", ieLength);
+     return NW_GTPV2C_IE_INCORRECT;
+   }
    fteid->ipv4 = (ieValue[0] & 0x80) >> 7;
    fteid->ipv6 = (ieValue[0] & 0x40) >> 6;
    fteid->interface_type = ieValue[0] & 0x1F;
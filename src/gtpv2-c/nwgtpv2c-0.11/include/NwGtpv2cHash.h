@@ -0,0 +1,137 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/**
+ * @file NwGtpv2cHash.h
+ * @author Dincer BEKEN
+ * @brief
+ *
+ * Intrusive chained hash map used by the stack for the tunnel (TEID, peer) and the outstanding transaction
+ * (sequence number, peer) lookups. Like the RB trees it replaces, elements embed their node, lookups take a key element
+ * and the element comparators are reused (0 if equal). The table doubles when the load exceeds one element per bucket.
+ * The RB trees are kept where the stack needs ordering (active timer list).
+ *
+ **/
+
+#ifndef __NW_GTPV2C_HASH_H__
+#define __NW_GTPV2C_HASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#include "NwTypes.h"
+#include "NwError.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NW_GTPV2C_HASH_DEFAULT_SIZE                             (1024)  /**< Initial number of buckets, power of two */
+
+typedef struct nw_gtpv2c_hash_node_s {
+  struct nw_gtpv2c_hash_node_s *next;
+  uint32_t                      hash;
+} nw_gtpv2c_hash_node_t;
+
+typedef struct nw_gtpv2c_hash_s {
+  nw_gtpv2c_hash_node_t       **buckets;
+  uint32_t                      mask;                                   /**< Number of buckets - 1              */
+  uint32_t                      count;
+  size_t                        nodeOffset;                             /**< Offset of the node in the element  */
+  uint32_t                    (*hashFunc)(const void *elem);
+  int32_t                     (*cmpFunc)(const void *a, const void *b);
+} nw_gtpv2c_hash_t;
+
+/**
+ * Initialize an empty map.
+ *
+ * @param[in] thiz : Map.
+ * @param[in] size : Initial number of buckets, rounded up to a power of two.
+ * @param[in] nodeOffset : offsetof the nw_gtpv2c_hash_node_t in the element.
+ * @param[in] hashFunc : Hash of the key fields of an element.
+ * @param[in] cmpFunc : Element comparator, 0 if the key fields are equal.
+ * @return NW_OK on success.
+ */
+nw_rc_t
+nwGtpv2cHashInit(nw_gtpv2c_hash_t *thiz, uint32_t size, size_t nodeOffset,
+    uint32_t (*hashFunc)(const void *elem), int32_t (*cmpFunc)(const void *a, const void *b));
+
+/**
+ * Release the buckets, the elements are owned by the caller.
+ */
+void
+nwGtpv2cHashDestroy(nw_gtpv2c_hash_t *thiz);
+
+/**
+ * Find the element with the key fields of the key element, NULL if none.
+ */
+void*
+nwGtpv2cHashFind(const nw_gtpv2c_hash_t *thiz, const void *key);
+
+/**
+ * Insert an element, as RB_INSERT.
+ *
+ * @return NULL on success, the element with the same key (left in place) on collision.
+ */
+void*
+nwGtpv2cHashInsert(nw_gtpv2c_hash_t *thiz, void *elem);
+
+/**
+ * Remove an element, as RB_REMOVE. Removing an element not in the map is harmless.
+ *
+ * @return The element, NULL if it was not in the map.
+ */
+void*
+nwGtpv2cHashRemove(nw_gtpv2c_hash_t *thiz, void *elem);
+
+/**
+ * Remove the elements matching a predicate, in one pass over the buckets. Each matching element is unlinked before it
+ * is given to the release function, which may thus delete it.
+ *
+ * @param[in] match : Predicate on an element.
+ * @param[in] release : Called for each removed element, may be NULL.
+ * @param[in] arg : Argument of both functions.
+ * @return The number of removed elements.
+ */
+uint32_t
+nwGtpv2cHashRemoveIf(nw_gtpv2c_hash_t *thiz, bool (*match)(const void *elem, void *arg),
+    void (*release)(void *elem, void *arg), void *arg);
+
+/**
+ * Hash helpers for the key fields of the stack elements.
+ */
+uint32_t
+nwGtpv2cHashMix(uint32_t hash, uint32_t value);
+
+uint32_t
+nwGtpv2cHashPeer(uint32_t hash, const struct sockaddr *peer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*--------------------------------------------------------------------------*
+ *                      E N D     O F    F I L E                            *
+ *--------------------------------------------------------------------------*/
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/**
+ * @file NwGtpv2cPool.h
+ * @author Dincer BEKEN
+ * @brief
+ *
+ * Free list of fixed size objects (messages, transactions, tunnels, timeout infos), one per object type and stack
+ * instance, so stack instances on different threads share no state. Released objects are kept for reuse, linked
+ * through the next pointer of the object, and the number of objects in use is tracked with its high-water marks.
+ *
+ * Released objects are only freed by nwGtpv2cPoolTrim(), never on release: the stack still reads some objects after
+ * releasing them (timeout infos), so the stack trims its pools at its API entry points only. A trim keeps as many
+ * objects as the peak use of the last trim window needed (capped by the pool bound) and frees the rest, so the memory
+ * of a burst is returned one window after the burst. A message sent through the UDP entity is released right after
+ * the send callback, so the UDP entity copies the datagrams it does not send at once (UDP_DATA_REQ of the Sm task).
+ *
+ **/
+
+#ifndef __NW_GTPV2C_POOL_H__
+#define __NW_GTPV2C_POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NW_GTPV2C_POOL_DEFAULT_MAX_FREE                         (1024)  /**< Released objects kept at most          */
+#define NW_GTPV2C_POOL_TRIM_INTERVAL                            (4096)  /**< Releases per trim window               */
+
+typedef struct nw_gtpv2c_pool_s {
+  void                         *freeList;
+  size_t                        objSize;
+  size_t                        nextOffset;                             /**< Offset of the next pointer in the object */
+  uint32_t                      maxFree;
+  uint32_t                      freeCount;
+  uint32_t                      inUse;
+  uint32_t                      highWaterMark;                          /**< Peak in use since the creation     */
+  uint32_t                      windowHighWaterMark;                    /**< Peak in use since the last trim    */
+  uint32_t                      releases;                               /**< Releases since the last trim       */
+  uint64_t                      allocated;                              /**< Objects taken from the heap        */
+  uint64_t                      trimmed;                                /**< Objects given back to the heap     */
+} nw_gtpv2c_pool_t;
+
+/**
+ * Initialize an empty pool.
+ *
+ * @param[in] thiz : Pool.
+ * @param[in] objSize : Size of the objects.
+ * @param[in] nextOffset : offsetof the next pointer in the object, used to link the released objects.
+ * @param[in] maxFree : Bound on the released objects kept after a trim.
+ */
+void
+nwGtpv2cPoolInit(nw_gtpv2c_pool_t *thiz, size_t objSize, size_t nextOffset, uint32_t maxFree);
+
+/**
+ * Free the released objects, the objects still in use are owned by the caller.
+ */
+void
+nwGtpv2cPoolDestroy(nw_gtpv2c_pool_t *thiz);
+
+/**
+ * Take an object, a released one if any. The object is not initialized.
+ *
+ * @return The object, NULL if no memory is left.
+ */
+void*
+nwGtpv2cPoolAlloc(nw_gtpv2c_pool_t *thiz);
+
+/**
+ * Give an object back to the pool, it stays readable until the next trim.
+ */
+void
+nwGtpv2cPoolRelease(nw_gtpv2c_pool_t *thiz, void *obj);
+
+/**
+ * Free the released objects not needed by the peak use of the last window, if the window is over.
+ *
+ * @param[in] force : Trim even if the window is not over.
+ * @return Number of objects freed.
+ */
+uint32_t
+nwGtpv2cPoolTrim(nw_gtpv2c_pool_t *thiz, bool force);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*--------------------------------------------------------------------------*
+ *                      E N D     O F    F I L E                            *
+ *--------------------------------------------------------------------------*/
@@ -47,6 +47,8 @@
 #include "NwGtpv2cMsg.h"
 #include "NwGtpv2cMsgIeParseInfo.h"
 #include "NwGtpv2cTunnel.h"
+#include "NwGtpv2cHash.h"
+#include "NwGtpv2cPool.h"
 
 /**
  * @file NwGtpv2cPrivate.h
@@ -107,11 +109,16 @@ typedef struct nw_gtpv2c_stack_s {
   nw_gtpv2c_msg_ie_parse_info_t       *pGtpv2cMsgIeParseInfo[NW_GTP_MSG_END];
   struct nw_gtpv2c_timeout_info_s    *activeTimerInfo;
 
-  RB_HEAD( NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s                ) tunnelMap;
-  RB_HEAD( NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s ) outstandingTxSeqNumMap;
-  RB_HEAD( NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s ) outstandingRxSeqNumMap;
+  nw_gtpv2c_hash_t                tunnelMap;                      /**< Key TEID and peer                          */
+  nw_gtpv2c_hash_t                outstandingTxSeqNumMap;         /**< Key sequence number and peer               */
+  nw_gtpv2c_hash_t                outstandingRxSeqNumMap;         /**< Key sequence number, peer and peer port    */
   RB_HEAD( NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s     ) activeTimerList;
   NwPtrT                        hTmrMinHeap;
+
+  nw_gtpv2c_pool_t                msgPool;                        /**< Released messages                          */
+  nw_gtpv2c_pool_t                trxnPool;                       /**< Released transactions                      */
+  nw_gtpv2c_pool_t                tunnelPool;                     /**< Released tunnels                           */
+  nw_gtpv2c_pool_t                timeoutInfoPool;                /**< Released timeout infos                     */
 } nw_gtpv2c_stack_t;
 
 
@@ -191,8 +198,8 @@ typedef struct nw_gtpv2c_trxn_s {
   nw_gtpv2c_tunnel_handle_t     hTunnel;                                /**< Handle to local tunnel context     */
   nw_gtpv2c_ulp_trxn_handle_t   hUlpTrxn;                               /**< Handle to ULP tunnel context       */
   uint8_t                       trx_flags;                              /**< Flags in the trx to be signalized back. */
-  RB_ENTRY (nw_gtpv2c_trxn_s)   outstandingTxSeqNumMapRbtNode;          /**< RB Tree Data Structure Node        */
-  RB_ENTRY (nw_gtpv2c_trxn_s)   outstandingRxSeqNumMapRbtNode;          /**< RB Tree Data Structure Node        */
+  nw_gtpv2c_hash_node_t         outstandingTxSeqNumMapHashNode;         /**< Hash Map Data Structure Node       */
+  nw_gtpv2c_hash_node_t         outstandingRxSeqNumMapHashNode;         /**< Hash Map Data Structure Node       */
   struct nw_gtpv2c_trxn_s*      next;
 } nw_gtpv2c_trxn_t;
 
@@ -211,9 +218,6 @@ typedef struct NwGtpv2cPathS {
 } NwGtpv2cPathT;
 
 
-RB_PROTOTYPE(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapRbtNode, nwGtpv2cCompareTunnel)
-RB_PROTOTYPE(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingTxSeqNumMapRbtNode, nwGtpv2cCompareSeqNum)
-RB_PROTOTYPE(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingRxSeqNumMapRbtNode, nwGtpv2cCompareSeqNum)
 RB_PROTOTYPE(NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s, activeTimerListRbtNode, nwGtpv2cCompareOutstandingTxRexmitTime)
 
 /**
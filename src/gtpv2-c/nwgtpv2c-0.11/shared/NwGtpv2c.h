@@ -384,6 +384,7 @@ typedef struct nw_gtpv2c_ulp_entity_s{
 
 /**
  * Gtpv2c UDP entity definition
+ * The data buffer and the peer address belong to the stack and may be released as soon as the callback returns.
  */
 
 typedef struct nw_gtpv2c_udp_entity_s {
@@ -447,6 +448,25 @@ typedef struct nw_gtpv2c_log_mgr_entity_s {
                            NW_IN      char* logStr);
 } nw_gtpv2c_log_mgr_entity_t;
 
+/**
+ * Gtpv2c object pool usage of a stack instance
+ */
+
+typedef struct nw_gtpv2c_pool_stats_s {
+  uint32_t                      inUse;
+  uint32_t                      cached;                 /**< Released objects kept for reuse    */
+  uint32_t                      highWaterMark;          /**< Peak in use                        */
+  uint64_t                      allocated;              /**< Objects taken from the heap        */
+  uint64_t                      trimmed;                /**< Objects given back to the heap     */
+} nw_gtpv2c_pool_stats_t;
+
+typedef struct nw_gtpv2c_stack_pool_stats_s {
+  nw_gtpv2c_pool_stats_t        msg;
+  nw_gtpv2c_pool_stats_t        trxn;
+  nw_gtpv2c_pool_stats_t        tunnel;
+  nw_gtpv2c_pool_stats_t        timeoutInfo;
+} nw_gtpv2c_stack_pool_stats_t;
+
 
 /*--------------------------------------------------------------------------*
  *                     P U B L I C   F U N C T I O N S                      *
@@ -609,6 +629,77 @@ nwGtpv2cProcessUlpReq( NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
 nw_rc_t
 nwGtpv2cProcessTimeout( NW_IN void* timeoutArg);
 
+/**
+ Get the object pool usage of the stack. The pools of a stack instance are
+ only used by the thread driving it.
+
+ @param[in] hGtpcStackHandle : Stack handle
+ @param[out] pStats : Pool usage.
+ @return NW_OK on success.
+ */
+
+nw_rc_t
+nwGtpv2cGetPoolStats( NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+                      NW_OUT nw_gtpv2c_stack_pool_stats_t *pStats);
+
+/**
+ Set the restart counter sent in the Recovery IE of the Echo messages.
+
+ @param[in] hGtpcStackHandle : Stack handle
+ @param[in] restartCounter : Restart counter of the local node.
+ @return NW_OK on success.
+ */
+
+nw_rc_t
+nwGtpv2cSetRestartCounter( NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+                           NW_IN uint8_t restartCounter);
+
+/**
+ Send an Echo Request with the restart counter of the stack to a peer. No
+ transaction is kept, the ULP matches the Echo Response by its sequence
+ number before giving the datagrams to the stack. The message is released
+ once sent, the UDP entity must not keep its buffer.
+
+ @param[in] hGtpcStackHandle : Stack handle
+ @param[in] peerIp : Peer address.
+ @param[in] peerPort : Peer port.
+ @param[in] retransmit : Resend the request of sequence number *pSeqNum.
+ @param[in,out] pSeqNum : Sequence number of the request.
+ @return NW_OK on success.
+ */
+
+nw_rc_t
+nwGtpv2cSendEchoReq( NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+                     NW_IN struct sockaddr *peerIp,
+                     NW_IN uint16_t peerPort,
+                     NW_IN bool retransmit,
+                     NW_INOUT uint32_t *pSeqNum);
+
+/**
+ Purge the state of a peer, e.g. after its restart or a path failure, in one
+ pass over each map. The outstanding requests towards the peer are removed,
+ as well as the received requests whose response was already sent. The
+ received requests still waiting for the ULP are kept, the ULP holds their
+ handle. Optionally the local tunnels of the peer are deleted, each one
+ reported to the ULP by its local TEID.
+
+ @param[in] hGtpcStackHandle : Stack handle
+ @param[in] peerIp : Peer address (any port).
+ @param[in] tunnelCallback : If set, delete the tunnels of the peer and call it for each.
+ @param[in] arg : Argument of the tunnel callback.
+ @param[out] pNbTrxns : Number of removed transactions.
+ @param[out] pNbTunnels : Number of deleted tunnels.
+ @return NW_OK on success.
+ */
+
+nw_rc_t
+nwGtpv2cPurgePeer( NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+                   NW_IN const struct sockaddr *peerIp,
+                   NW_IN void (*tunnelCallback)(void *arg, uint32_t teidLocal),
+                   NW_IN void *arg,
+                   NW_OUT uint32_t *pNbTrxns,
+                   NW_OUT uint32_t *pNbTunnels);
+
 
 #ifdef __cplusplus
 }
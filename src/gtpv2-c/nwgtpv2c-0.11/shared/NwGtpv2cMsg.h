@@ -334,6 +334,15 @@ nwGtpv2cMsgGetSeqNumber(NW_IN nw_gtpv2c_msg_handle_t hMsg);
 uint32_t
 nwGtpv2cMsgGetLength(NW_IN nw_gtpv2c_msg_handle_t hMsg);
 
+/**
+ * Get the encoded gtpv2c message, header included (nwGtpv2cMsgGetLength bytes).
+ *
+ * @param[in] hMsg : Message handle.
+ */
+
+uint8_t*
+nwGtpv2cMsgGetBuffer(NW_IN nw_gtpv2c_msg_handle_t hMsg);
+
 /**
  * Add a gtpv2c information element of length 1 to gtpv2c message.
  *
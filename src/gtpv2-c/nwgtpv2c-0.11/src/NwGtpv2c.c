@@ -97,8 +97,6 @@
 extern                                  "C" {
 #endif
 
-  static nw_gtpv2c_timeout_info_t            *gpGtpv2cTimeoutInfoPool = NULL;
-
   typedef struct {
     int                                     currSize;
     int                                     maxSize;
@@ -255,7 +253,7 @@ extern                                  "C" {
   }
 
 /*---------------------------------------------------------------------------
-   Tunnel RBTree Search Data Structure
+   Tunnel Hash Map Search Data Structure
   --------------------------------------------------------------------------*/
 
 /**
@@ -299,10 +297,24 @@ extern                                  "C" {
     return 0;
   }
 
-  RB_GENERATE (NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapRbtNode, nwGtpv2cCompareTunnel)
+  static int32_t                           nwGtpv2cTunnelMapCmp (
+  const void *a,
+  const void *b) {
+    return nwGtpv2cCompareTunnel ((struct nw_gtpv2c_tunnel_s *)a, (struct nw_gtpv2c_tunnel_s *)b);
+  }
+
+/**
+  Hash of the tunnel key fields, the fields compared by nwGtpv2cCompareTunnel.
+*/
+  static uint32_t                          nwGtpv2cTunnelMapHash (
+  const void *elem) {
+    const struct nw_gtpv2c_tunnel_s         *pTunnel = (const struct nw_gtpv2c_tunnel_s *)elem;
+
+    return nwGtpv2cHashPeer (nwGtpv2cHashMix (0, pTunnel->teid), (const struct sockaddr *)&pTunnel->ipAddrRemote);
+  }
 
 /*---------------------------------------------------------------------------
-   Transaction RBTree Search Data Structure
+   Transaction Hash Map Search Data Structure
   --------------------------------------------------------------------------*/
 /**
   Comparator funtion for comparing two outstancing TX transactions.
@@ -344,7 +356,18 @@ extern                                  "C" {
     return 0;
   }
 
-  RB_GENERATE (NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingTxSeqNumMapRbtNode, nwGtpv2cCompareOutstandingTxSeqNumTrxn)
+  static int32_t                           nwGtpv2cOutstandingTxSeqNumTrxnMapCmp (
+  const void *a,
+  const void *b) {
+    return nwGtpv2cCompareOutstandingTxSeqNumTrxn ((struct nw_gtpv2c_trxn_s *)a, (struct nw_gtpv2c_trxn_s *)b);
+  }
+
+  static uint32_t                          nwGtpv2cOutstandingTxSeqNumTrxnMapHash (
+  const void *elem) {
+    const struct nw_gtpv2c_trxn_s           *pTrxn = (const struct nw_gtpv2c_trxn_s *)elem;
+
+    return nwGtpv2cHashPeer (nwGtpv2cHashMix (0, pTrxn->seqNum), (const struct sockaddr *)&pTrxn->peer_ip);
+  }
 
 /**
   Comparator funtion for comparing outstanding RX transactions.
@@ -391,7 +414,54 @@ extern                                  "C" {
     return 0;
   }
 
-  RB_GENERATE (NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingRxSeqNumMapRbtNode, nwGtpv2cCompareOutstandingRxSeqNumTrxn)
+  static int32_t                           nwGtpv2cOutstandingRxSeqNumTrxnMapCmp (
+  const void *a,
+  const void *b) {
+    return nwGtpv2cCompareOutstandingRxSeqNumTrxn ((struct nw_gtpv2c_trxn_s *)a, (struct nw_gtpv2c_trxn_s *)b);
+  }
+
+/**
+  Hash of the RX transaction key fields. The peer port is only compared for IPv4 peers, so only hashed for them.
+*/
+  static uint32_t                          nwGtpv2cOutstandingRxSeqNumTrxnMapHash (
+  const void *elem) {
+    const struct nw_gtpv2c_trxn_s           *pTrxn = (const struct nw_gtpv2c_trxn_s *)elem;
+    const uint32_t                          hash = nwGtpv2cHashPeer (nwGtpv2cHashMix (0, pTrxn->seqNum), (const struct sockaddr *)&pTrxn->peer_ip);
+
+    return (((const struct sockaddr *)&pTrxn->peer_ip)->sa_family == AF_INET) ? nwGtpv2cHashMix (hash, pTrxn->peerPort) : hash;
+  }
+
+/**
+  Trim the object pools whose trim window is over. Only called at the API entry points, where no released object is
+  still referenced by the stack.
+
+  @param[in] thiz: Pointer to stack.
+  @param[in] force: Trim all pools.
+*/
+  static void                               nwGtpv2cTrimPools (
+  nw_gtpv2c_stack_t * thiz,
+  bool force) {
+    uint32_t                                nbTrimmed = 0;
+
+    nbTrimmed += nwGtpv2cPoolTrim (&thiz->msgPool, force);
+    nbTrimmed += nwGtpv2cPoolTrim (&thiz->trxnPool, force);
+    nbTrimmed += nwGtpv2cPoolTrim (&thiz->tunnelPool, force);
+    nbTrimmed += nwGtpv2cPoolTrim (&thiz->timeoutInfoPool, force);
+    if (nbTrimmed) {
+      OAILOG_DEBUG (LOG_GTPV2C, "Trimmed %u pooled objects, %u messages and %u transactions in use\n", nbTrimmed,
+          thiz->msgPool.inUse, thiz->trxnPool.inUse);
+    }
+  }
+
+  static void                               nwGtpv2cGetPoolStatsOf (
+  const nw_gtpv2c_pool_t * pool,
+  nw_gtpv2c_pool_stats_t * pStats) {
+    pStats->inUse = pool->inUse;
+    pStats->cached = pool->freeCount;
+    pStats->highWaterMark = pool->highWaterMark;
+    pStats->allocated = pool->allocated;
+    pStats->trimmed = pool->trimmed;
+  }
 
 /*---------------------------------------------------------------------------
    Timer RB-tree data structure.
@@ -534,7 +604,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
     pTunnel = nwGtpv2cTunnelNew (thiz, teid, fa, hUlpTunnel);
 
     if (pTunnel) {
-      pCollision = RB_INSERT (NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
+      pCollision = nwGtpv2cHashInsert (&(thiz->tunnelMap), pTunnel);
 
       if (pCollision) {
         rc = nwGtpv2cTunnelDelete (thiz, pTunnel);
@@ -568,7 +638,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
 
     OAILOG_FUNC_IN (LOG_GTPV2C);
 
-    pTunnel = RB_REMOVE (NwGtpv2cTunnelMap, &(thiz->tunnelMap), (nw_gtpv2c_tunnel_t *) hTunnel);
+    pTunnel = nwGtpv2cHashRemove (&(thiz->tunnelMap), (nw_gtpv2c_tunnel_t *) hTunnel);
     NW_ASSERT (pTunnel == (nw_gtpv2c_tunnel_t *) hTunnel);
 
     inet_ntop (((struct sockaddr*)&pTunnel->ipAddrRemote)->sa_family, (void*)&pTunnel->ipAddrRemote, ip,
@@ -613,9 +683,8 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
         keyTunnel.teid = pUlpReq->u_api_info.initialReqInfo.teidLocal;
         memcpy(((struct sockaddr*)&keyTunnel.ipAddrRemote), pUlpReq->u_api_info.initialReqInfo.edns_peer_ip,
         		pUlpReq->u_api_info.initialReqInfo.edns_peer_ip->sa_family==AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
-        pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+        pLocalTunnel = nwGtpv2cHashFind (&(thiz->tunnelMap), &keyTunnel);
         if (!pLocalTunnel) {
-          pLocalTunnel = RB_MIN (NwGtpv2cTunnelMap, &(thiz->tunnelMap));
           OAILOG_WARNING (LOG_GTPV2C,  "Request message received on non-existent teid 0x%x received! Creating new tunnel.\n", ntohl (pUlpReq->u_api_info.initialReqInfo.teidLocal));
           rc = nwGtpv2cCreateLocalTunnel (thiz, pUlpReq->u_api_info.initialReqInfo.teidLocal, pUlpReq->u_api_info.initialReqInfo.edns_peer_ip, pUlpReq->u_api_info.initialReqInfo.hUlpTunnel, &pUlpReq->u_api_info.initialReqInfo.hTunnel);
           NW_ASSERT (NW_OK == rc);
@@ -637,6 +706,11 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
       pTrxn->noDelete  = pUlpReq->u_api_info.initialReqInfo.noDelete;
       pTrxn->trx_flags = pUlpReq->u_api_info.initialReqInfo.internal_flags;
       pTrxn->localPort = 0; /**< Set the local port to 0 (initialize it). */
+      /** T3 (seconds) and N3 of the request, if set by the ULP. */
+      if (pUlpReq->u_api_info.initialReqInfo.t3Timer)
+        pTrxn->t3Timer = pUlpReq->u_api_info.initialReqInfo.t3Timer;
+      if (pUlpReq->u_api_info.initialReqInfo.maxRetries)
+        pTrxn->maxRetries = pUlpReq->u_api_info.initialReqInfo.maxRetries;
       if (pUlpReq->apiType & NW_GTPV2C_ULP_API_FLAG_IS_COMMAND_MESSAGE) {
         pTrxn->seqNum |= 0x00800000UL;
       }
@@ -650,7 +724,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
         /*
          * Insert into search tree
          */
-        pTrxn = RB_INSERT (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+        pTrxn = nwGtpv2cHashInsert (&(thiz->outstandingTxSeqNumMap), pTrxn);
         NW_ASSERT (pTrxn == NULL);
       } else {
         rc = nwGtpv2cTrxnDelete (&pTrxn);
@@ -703,7 +777,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
         /*
          * Insert into search tree
          */
-        RB_INSERT (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+        nwGtpv2cHashInsert (&(thiz->outstandingTxSeqNumMap), pTrxn);
 
         if (!pUlpReq->u_api_info.triggeredReqInfo.hTunnel) {
           rc = nwGtpv2cCreateLocalTunnel (thiz, pUlpReq->u_api_info.triggeredReqInfo.teidLocal, &pReqTrxn->peer_ip,
@@ -778,7 +852,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
       memcpy(((struct sockaddr*)&keyTunnel.ipAddrRemote), ((struct sockaddr*)&pReqTrxn->peer_ip),
     		  ((struct sockaddr*)&pReqTrxn->peer_ip)->sa_family==AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
 
-      pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+      pLocalTunnel = nwGtpv2cHashFind (&(thiz->tunnelMap), &keyTunnel);
       char                                      ip[INET6_ADDRSTRLEN];
       inet_ntop (AF_INET, (void*)&pReqTrxn->peer_ip, ip, ((struct sockaddr*)&pReqTrxn->peer_ip)->sa_family == AF_INET ? INET_ADDRSTRLEN : INET6_ADDRSTRLEN);
       if (!pLocalTunnel) {
@@ -817,7 +891,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
     		  (((struct sockaddr*)pUlpAck->u_api_info.triggeredAckInfo.peerIp)->sa_family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
 
       /** A transaction of the initial request (cmd) for the triggered request should exist. */
-      pAckTrxn = RB_FIND (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+      pAckTrxn = nwGtpv2cHashFind (&(thiz->outstandingTxSeqNumMap), &keyTrxn);
 
       if (pAckTrxn) {
     	  OAILOG_INFO (LOG_GTPV2C,  "Found an initial request transaction for the triggered ACK. Appending the ACK and keeping the transaction for a while.\n");
@@ -869,7 +943,7 @@ static nw_rc_t nwGtpv2cHandleUlpCreateLocalTunnel (NW_IN nw_gtpv2c_stack_t * thi
                               pUlpReq->u_api_info.createLocalTunnelInfo.peerIp,
                               pUlpReq->u_api_info.triggeredRspInfo.hUlpTunnel);
   NW_ASSERT (pTunnel);
-  pCollision = RB_INSERT (NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
+  pCollision = nwGtpv2cHashInsert (&(thiz->tunnelMap), pTunnel);
 
   if (pCollision) {
     rc = nwGtpv2cTunnelDelete (thiz, pTunnel);
@@ -973,12 +1047,12 @@ static nw_rc_t                            nwGtpv2cSendTriggeredReqIndToUlp (
   static nw_rc_t                            nwGtpv2cSendTriggeredRspIndToUlp (
   NW_IN nw_gtpv2c_stack_t * thiz,
   NW_IN nw_gtpv2c_error_t * pError,
-  NW_IN uint32_t hUlpTrxn,
+  NW_IN nw_gtpv2c_ulp_trxn_handle_t hUlpTrxn,
   NW_IN uint8_t * trxFlags_p,
   NW_IN uint16_t localPort,
   NW_IN uint16_t peerPort,
   NW_IN struct sockaddr *peerIp,
-  NW_IN uint32_t hUlpTunnel,
+  NW_IN nw_gtpv2c_ulp_tunnel_handle_t hUlpTunnel,
   NW_IN uint32_t msgType,
   NW_IN bool     noDelete,
   NW_IN nw_gtpv2c_msg_handle_t hMsg) {
@@ -1047,7 +1121,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     keyTunnel.teid = pUlpReq->u_api_info.findLocalTunnelInfo.teidLocal;
     memcpy((void*)&keyTunnel.ipAddrRemote, pUlpReq->u_api_info.findLocalTunnelInfo.edns_peer_ip,
       		  (((struct sockaddr*)&keyTunnel.ipAddrRemote)->sa_family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
-    pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+    pLocalTunnel = nwGtpv2cHashFind (&(thiz->tunnelMap), &keyTunnel);
     pUlpReq->u_api_info.findLocalTunnelInfo.hTunnel = (nw_gtpv2c_tunnel_handle_t) pLocalTunnel;
 
     if(pLocalTunnel){
@@ -1127,7 +1201,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     if (teidLocal) {
       keyTunnel.teid = ntohl (teidLocal);
       memcpy((void*)&keyTunnel.ipAddrRemote, peerIp, (peerIp->sa_family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
-      pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+      pLocalTunnel = nwGtpv2cHashFind (&(thiz->tunnelMap), &keyTunnel);
 
       if (!pLocalTunnel) {
         OAILOG_WARNING (LOG_GTPV2C,  "Request message received on non-existent teid 0x%x from peer %s received! Discarding.\n", ntohl (teidLocal), ip);
@@ -1147,11 +1221,14 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     if (pTrxn) {
       pTrxn->localPort = thiz->udp.gtpv2cStandardPort;
       rc = nwGtpv2cMsgFromBufferNew ((nw_gtpv2c_stack_handle_t) thiz, msgBuf, msgBufLen, &(hMsg));
-      NW_ASSERT (thiz->pGtpv2cMsgIeParseInfo[msgType]);
-      rc = nwGtpv2cMsgIeParse (thiz->pGtpv2cMsgIeParseInfo[msgType], hMsg, &error);
 
-      if (rc != NW_OK) {
-        OAILOG_WARNING (LOG_GTPV2C,  "Malformed request message received on TEID %u from peer %s. Notifying ULP.\n", ntohl (teidLocal), ip);
+      /** Requests without stack parse info (Sm MBMS session requests) are validated by the ULP decoder only. */
+      if (thiz->pGtpv2cMsgIeParseInfo[msgType]) {
+        rc = nwGtpv2cMsgIeParse (thiz->pGtpv2cMsgIeParseInfo[msgType], hMsg, &error);
+
+        if (rc != NW_OK) {
+          OAILOG_WARNING (LOG_GTPV2C,  "Malformed request message received on TEID %u from peer %s. Notifying ULP.\n", ntohl (teidLocal), ip);
+        }
       }
 
       rc = nwGtpv2cSendInitialReqIndToUlp (thiz, &error, pTrxn, hUlpTunnel, msgType, peerIp, peerPort, hMsg);
@@ -1192,7 +1269,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     OAILOG_DEBUG (LOG_GTPV2C,  "RECEIVED GTPV2c triggered request message of type %d, length %d and seqNum %x.\n", msgType, msgBufLen, keyTrxn.seqNum);
 
     /** A transaction of the initial request (cmd) for the triggered request should exist. */
-    pTrxn = RB_FIND (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+    pTrxn = nwGtpv2cHashFind (&(thiz->outstandingTxSeqNumMap), &keyTrxn);
 
     if (pTrxn) {
       uint32_t                                hUlpTrxn;
@@ -1204,7 +1281,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
       /**
        * We remove the transaction of the initial request and create a new transaction the the received triggered request.
        */
-      RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+      nwGtpv2cHashRemove (&(thiz->outstandingTxSeqNumMap), pTrxn);
       rc = nwGtpv2cTrxnDelete (&pTrxn);
       NW_ASSERT (NW_OK == rc);
     } else {
@@ -1217,7 +1294,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     if (teidLocal) {
       keyTunnel.teid = ntohl (teidLocal);
       memcpy((void*)&keyTunnel.ipAddrRemote, peerIp, (peerIp->sa_family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
-      pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+      pLocalTunnel = nwGtpv2cHashFind (&(thiz->tunnelMap), &keyTunnel);
 
       if (!pLocalTunnel) {
         OAILOG_WARNING (LOG_GTPV2C,  "Request message received on non-existent teid 0x%x from peer %s received! Discarding.\n", ntohl (teidLocal), peerIp);
@@ -1277,11 +1354,11 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     OAILOG_DEBUG (LOG_GTPV2C,  "RECEIVED GTPV2c  response message of type %d, length %d and seqNum %x.\n", msgType, msgBufLen, keyTrxn.seqNum);
 
 
-    pTrxn = RB_FIND (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+    pTrxn = nwGtpv2cHashFind (&(thiz->outstandingTxSeqNumMap), &keyTrxn);
     uint8_t trx_flags = 0;
     if (pTrxn) {
-      uint32_t                                hUlpTrxn;
-      uint32_t                                hUlpTunnel;
+      nw_gtpv2c_ulp_trxn_handle_t             hUlpTrxn;
+      nw_gtpv2c_ulp_tunnel_handle_t           hUlpTunnel;
 
       hUlpTrxn = pTrxn->hUlpTrxn;
       noDelete = pTrxn->noDelete;
@@ -1320,12 +1397,12 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
         inet_ntop (peerIp->sa_family, (void*)peerIp, ip, peerIp->sa_family == AF_INET ? INET_ADDRSTRLEN : INET_ADDRSTRLEN);
         OAILOG_WARNING (LOG_GTPV2C,  "Malformed message received on TEID %u from peer %s. Notifying ULP.\n", ntohl ((*((uint32_t *) (msgBuf + 4)))), ip);
       }
-      rc = nwGtpv2cSendTriggeredRspIndToUlp (thiz, &error, keyTrxn.seqNum, &trx_flags, localPort, peerPort, peerIp, hUlpTunnel, msgType, noDelete, hMsg);
+      rc = nwGtpv2cSendTriggeredRspIndToUlp (thiz, &error, hUlpTrxn, &trx_flags, localPort, peerPort, peerIp, hUlpTunnel, msgType, noDelete, hMsg);
       if(remove && !(trx_flags & INTERNAL_LATE_RESPONS_IND)){
     	  OAILOG_WARNING (LOG_GTPV2C,  "Removing the initial request transaction for message type %d, seqNo %x in conclusion (not late response). \n",
     			  msgType, keyTrxn.seqNum);
     	  /** Remove the transaction. */
-    	  RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+    	  nwGtpv2cHashRemove (&(thiz->outstandingTxSeqNumMap), pTrxn);
     	  rc = nwGtpv2cTrxnDelete (&pTrxn);
     	  NW_ASSERT (NW_OK == rc);
     	  remove = false;
@@ -1343,6 +1420,72 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     return rc;
   }
 
+/*---------------------------------------------------------------------------
+   Peer Purge
+  --------------------------------------------------------------------------*/
+
+  typedef struct nw_gtpv2c_purge_s {
+    nw_gtpv2c_stack_t                        *thiz;
+    const struct sockaddr                    *peerIp;
+    void                                    (*tunnelCallback) (void *arg, uint32_t teidLocal);
+    void                                     *arg;
+  } nw_gtpv2c_purge_t;
+
+  static inline bool                        nwGtpv2cIsPeer (
+  const struct sockaddr *a,
+  const struct sockaddr *b) {
+    if (a->sa_family != b->sa_family)
+      return false;
+
+    if (a->sa_family == AF_INET)
+      return ((struct sockaddr_in *)a)->sin_addr.s_addr == ((struct sockaddr_in *)b)->sin_addr.s_addr;
+
+    return !memcmp (((struct sockaddr_in6 *)a)->sin6_addr.s6_addr, ((struct sockaddr_in6 *)b)->sin6_addr.s6_addr, 16);
+  }
+
+  static bool                               nwGtpv2cPurgeMatchTxTrxn (
+  const void *elem,
+  void *arg) {
+    return nwGtpv2cIsPeer ((const struct sockaddr *)&((const nw_gtpv2c_trxn_t *)elem)->peer_ip, ((nw_gtpv2c_purge_t *)arg)->peerIp);
+  }
+
+  static bool                               nwGtpv2cPurgeMatchRxTrxn (
+  const void *elem,
+  void *arg) {
+    const nw_gtpv2c_trxn_t                    *pTrxn = (const nw_gtpv2c_trxn_t *)elem;
+
+    /** Only the answered requests hold the duplicate request timer. */
+    return pTrxn->hRspTmr && nwGtpv2cIsPeer ((const struct sockaddr *)&pTrxn->peer_ip, ((nw_gtpv2c_purge_t *)arg)->peerIp);
+  }
+
+  static void                               nwGtpv2cPurgeReleaseTrxn (
+  void *elem,
+  void *arg) {
+    nw_gtpv2c_trxn_t                          *pTrxn = (nw_gtpv2c_trxn_t *)elem;
+    nw_rc_t                                   rc;
+
+    rc = nwGtpv2cTrxnDelete (&pTrxn);
+    NW_ASSERT (NW_OK == rc);
+  }
+
+  static bool                               nwGtpv2cPurgeMatchTunnel (
+  const void *elem,
+  void *arg) {
+    return nwGtpv2cIsPeer ((const struct sockaddr *)&((const nw_gtpv2c_tunnel_t *)elem)->ipAddrRemote, ((nw_gtpv2c_purge_t *)arg)->peerIp);
+  }
+
+  static void                               nwGtpv2cPurgeReleaseTunnel (
+  void *elem,
+  void *arg) {
+    nw_gtpv2c_purge_t                         *pPurge = (nw_gtpv2c_purge_t *)arg;
+    nw_gtpv2c_tunnel_t                        *pTunnel = (nw_gtpv2c_tunnel_t *)elem;
+    nw_rc_t                                   rc;
+
+    pPurge->tunnelCallback (pPurge->arg, pTunnel->teid);
+    rc = nwGtpv2cTunnelDelete (pPurge->thiz, pTunnel);
+    NW_ASSERT (NW_OK == rc);
+  }
+
 /*--------------------------------------------------------------------------*
                        P U B L I C   F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -1364,9 +1507,20 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
       thiz->id = (uint32_t) thiz;
       thiz->seqNum = ((uint32_t) thiz) & 0x0000FFFF;
       OAI_GCC_DIAG_ON(pointer-to-int-cast);
-      RB_INIT (&(thiz->tunnelMap));
-      RB_INIT (&(thiz->outstandingTxSeqNumMap));
-      RB_INIT (&(thiz->outstandingRxSeqNumMap));
+      rc = nwGtpv2cHashInit (&(thiz->tunnelMap), NW_GTPV2C_HASH_DEFAULT_SIZE, offsetof (nw_gtpv2c_tunnel_t, tunnelMapHashNode),
+          nwGtpv2cTunnelMapHash, nwGtpv2cTunnelMapCmp);
+      NW_ASSERT (NW_OK == rc);
+      rc = nwGtpv2cHashInit (&(thiz->outstandingTxSeqNumMap), NW_GTPV2C_HASH_DEFAULT_SIZE, offsetof (nw_gtpv2c_trxn_t, outstandingTxSeqNumMapHashNode),
+          nwGtpv2cOutstandingTxSeqNumTrxnMapHash, nwGtpv2cOutstandingTxSeqNumTrxnMapCmp);
+      NW_ASSERT (NW_OK == rc);
+      rc = nwGtpv2cHashInit (&(thiz->outstandingRxSeqNumMap), NW_GTPV2C_HASH_DEFAULT_SIZE, offsetof (nw_gtpv2c_trxn_t, outstandingRxSeqNumMapHashNode),
+          nwGtpv2cOutstandingRxSeqNumTrxnMapHash, nwGtpv2cOutstandingRxSeqNumTrxnMapCmp);
+      NW_ASSERT (NW_OK == rc);
+      nwGtpv2cPoolInit (&thiz->msgPool, sizeof (nw_gtpv2c_msg_t), offsetof (nw_gtpv2c_msg_t, next), NW_GTPV2C_POOL_DEFAULT_MAX_FREE);
+      nwGtpv2cPoolInit (&thiz->trxnPool, sizeof (nw_gtpv2c_trxn_t), offsetof (nw_gtpv2c_trxn_t, next), NW_GTPV2C_POOL_DEFAULT_MAX_FREE);
+      nwGtpv2cPoolInit (&thiz->tunnelPool, sizeof (nw_gtpv2c_tunnel_t), offsetof (nw_gtpv2c_tunnel_t, next), NW_GTPV2C_POOL_DEFAULT_MAX_FREE);
+      nwGtpv2cPoolInit (&thiz->timeoutInfoPool, sizeof (nw_gtpv2c_timeout_info_t), offsetof (nw_gtpv2c_timeout_info_t, next),
+          NW_GTPV2C_POOL_DEFAULT_MAX_FREE);
       RB_INIT (&(thiz->activeTimerList));
       OAI_GCC_DIAG_OFF(pointer-to-int-cast);
       thiz->hTmrMinHeap = (NwPtrT) nwGtpv2cTmrMinHeapNew (10000);
@@ -1414,6 +1568,12 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
 
       NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_IDENTIFICATION_REQ);
       NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_IDENTIFICATION_RSP);
+      /*
+       * For Sm interface (MBMS-GW side)
+       */
+      NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_MBMS_SESSION_START_RSP);
+      NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_MBMS_SESSION_UPDATE_RSP);
+      NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_MBMS_SESSION_STOP_RSP);
       nwGtpv2cDisplayBanner (thiz);
     } else {
       rc = NW_FAILURE;
@@ -1482,9 +1642,20 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     nwGtpv2cMsgIeParseInfoDelete(((nw_gtpv2c_stack_t*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_IDENTIFICATION_REQ]);
     nwGtpv2cMsgIeParseInfoDelete(((nw_gtpv2c_stack_t*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_IDENTIFICATION_RSP]);
 
+    nwGtpv2cMsgIeParseInfoDelete(((nw_gtpv2c_stack_t*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_MBMS_SESSION_START_RSP]);
+    nwGtpv2cMsgIeParseInfoDelete(((nw_gtpv2c_stack_t*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_MBMS_SESSION_UPDATE_RSP]);
+    nwGtpv2cMsgIeParseInfoDelete(((nw_gtpv2c_stack_t*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_MBMS_SESSION_STOP_RSP]);
+
     OAI_GCC_DIAG_OFF(int-to-pointer-cast);
     nwGtpv2cTmrMinHeapDelete((NwGtpv2cTmrMinHeapT*)((nw_gtpv2c_stack_t*)hGtpcStackHandle)->hTmrMinHeap);
     OAI_GCC_DIAG_ON(int-to-pointer-cast);
+    nwGtpv2cHashDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->tunnelMap);
+    nwGtpv2cHashDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->outstandingTxSeqNumMap);
+    nwGtpv2cHashDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->outstandingRxSeqNumMap);
+    nwGtpv2cPoolDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->msgPool);
+    nwGtpv2cPoolDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->trxnPool);
+    nwGtpv2cPoolDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->tunnelPool);
+    nwGtpv2cPoolDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->timeoutInfoPool);
     free_wrapper ((void**)&hGtpcStackHandle);
     return NW_OK;
   }
@@ -1584,6 +1755,94 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     return NW_OK;
   }
 
+/**
+   Get the object pool usage
+*/
+
+  nw_rc_t                                   nwGtpv2cGetPoolStats (
+  NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+  NW_OUT nw_gtpv2c_stack_pool_stats_t * pStats) {
+    nw_gtpv2c_stack_t                         *thiz = (nw_gtpv2c_stack_t *) hGtpcStackHandle;
+
+    NW_ASSERT (thiz);
+    nwGtpv2cGetPoolStatsOf (&thiz->msgPool, &pStats->msg);
+    nwGtpv2cGetPoolStatsOf (&thiz->trxnPool, &pStats->trxn);
+    nwGtpv2cGetPoolStatsOf (&thiz->tunnelPool, &pStats->tunnel);
+    nwGtpv2cGetPoolStatsOf (&thiz->timeoutInfoPool, &pStats->timeoutInfo);
+    return NW_OK;
+  }
+
+/**
+   Set the restart counter of the Recovery IE
+*/
+
+  nw_rc_t                                   nwGtpv2cSetRestartCounter (
+  NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+  NW_IN uint8_t restartCounter) {
+    nw_gtpv2c_stack_t                         *thiz = (nw_gtpv2c_stack_t *) hGtpcStackHandle;
+
+    NW_ASSERT (thiz);
+    thiz->restartCounter = restartCounter;
+    return NW_OK;
+  }
+
+/**
+   Send an Echo Request to a peer, a retransmission keeps the sequence number of the original request
+*/
+
+  nw_rc_t                                   nwGtpv2cSendEchoReq (
+  NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+  NW_IN struct sockaddr * peerIp,
+  NW_IN uint16_t peerPort,
+  NW_IN bool retransmit,
+  NW_INOUT uint32_t * pSeqNum) {
+    nw_rc_t                                   rc = NW_FAILURE;
+    nw_gtpv2c_stack_t                         *thiz = (nw_gtpv2c_stack_t *) hGtpcStackHandle;
+    nw_gtpv2c_msg_handle_t                      hMsg = 0;
+    uint32_t                                seqNum = 0;
+
+    NW_ASSERT (thiz);
+    if (retransmit) {
+      seqNum = *pSeqNum;
+    } else {
+      seqNum = thiz->seqNum++;
+      if (thiz->seqNum == 0x800000)
+        thiz->seqNum = 0;
+    }
+
+    rc = nwGtpv2cMsgNew ((nw_gtpv2c_stack_handle_t) thiz, false, NW_GTP_ECHO_REQ, 0x00, seqNum, (&hMsg));
+    NW_ASSERT (NW_OK == rc);
+    rc = nwGtpv2cMsgAddIeTV1 (hMsg, NW_GTPV2C_IE_RECOVERY, 0, thiz->restartCounter);
+    NW_ASSERT (NW_OK == rc);
+    rc = nwGtpv2cCreateAndSendMsg (thiz, seqNum, NW_GTPV2C_UDP_PORT, peerIp, peerPort, (nw_gtpv2c_msg_t *) hMsg);
+    *pSeqNum = seqNum;
+    if (NW_OK != nwGtpv2cMsgDelete ((nw_gtpv2c_stack_handle_t) thiz, hMsg))
+      return NW_FAILURE;
+    return rc;
+  }
+
+/**
+   Purge the transactions and optionally the tunnels of a peer
+*/
+
+  nw_rc_t                                   nwGtpv2cPurgePeer (
+  NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+  NW_IN const struct sockaddr * peerIp,
+  NW_IN void (*tunnelCallback) (void *arg, uint32_t teidLocal),
+  NW_IN void *arg,
+  NW_OUT uint32_t * pNbTrxns,
+  NW_OUT uint32_t * pNbTunnels) {
+    nw_gtpv2c_stack_t                         *thiz = (nw_gtpv2c_stack_t *) hGtpcStackHandle;
+    nw_gtpv2c_purge_t                         purge = {.thiz = thiz, .peerIp = peerIp, .tunnelCallback = tunnelCallback, .arg = arg};
+
+    NW_ASSERT (thiz);
+    *pNbTrxns = nwGtpv2cHashRemoveIf (&(thiz->outstandingTxSeqNumMap), nwGtpv2cPurgeMatchTxTrxn, nwGtpv2cPurgeReleaseTrxn, &purge);
+    *pNbTrxns += nwGtpv2cHashRemoveIf (&(thiz->outstandingRxSeqNumMap), nwGtpv2cPurgeMatchRxTrxn, nwGtpv2cPurgeReleaseTrxn, &purge);
+    *pNbTunnels = tunnelCallback ? nwGtpv2cHashRemoveIf (&(thiz->tunnelMap), nwGtpv2cPurgeMatchTunnel, nwGtpv2cPurgeReleaseTunnel, &purge) : 0;
+    OAILOG_DEBUG (LOG_GTPV2C, "Purged %u transactions and %u tunnels of a peer\n", *pNbTrxns, *pNbTunnels);
+    return NW_OK;
+  }
+
 /**
    Process Request from Udp Layer
 */
@@ -1602,6 +1861,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     thiz = (nw_gtpv2c_stack_t *) hGtpcStackHandle;
     NW_ASSERT (thiz);
     OAILOG_FUNC_IN (LOG_GTPV2C);
+    nwGtpv2cTrimPools (thiz, false);
 
     if (udpDataLen < NW_GTPV2C_MINIMUM_HEADER_SIZE) {
       /*
@@ -1651,6 +1911,10 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     case NW_GTP_CONTEXT_REQ:
       /** S11: Paging. */
     case NW_GTP_DOWNLINK_DATA_NOTIFICATION:
+      /** Sm: MBMS session requests from the MBMS-GW. */
+    case NW_GTP_MBMS_SESSION_START_REQ:
+    case NW_GTP_MBMS_SESSION_UPDATE_REQ:
+    case NW_GTP_MBMS_SESSION_STOP_REQ:
       rc = nwGtpv2cHandleInitialReq(thiz, msgType, udpData, udpDataLen, peerPort, peerIp);
       break;
 
@@ -1693,6 +1957,10 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     case NW_GTP_DELETE_INDIRECT_DATA_FORWARDING_TUNNEL_RSP:
     case NW_GTP_FORWARD_RELOCATION_COMPLETE_ACK:
     case NW_GTP_RELOCATION_CANCEL_RSP:
+    /** Sm: MBMS session responses, if the stack is used as MBMS-GW. */
+    case NW_GTP_MBMS_SESSION_START_RSP:
+    case NW_GTP_MBMS_SESSION_UPDATE_RSP:
+    case NW_GTP_MBMS_SESSION_STOP_RSP:
       rc = nwGtpv2cHandleTriggeredRsp (thiz, msgType, udpData, udpDataLen, localPort, peerPort, peerIp, true); /**< We will check inside, if the received response is to be acked. */
       break;
     case NW_GTP_CONTEXT_RSP:
@@ -1732,6 +2000,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     NW_ASSERT (thiz);
     NW_ASSERT (pUlpReq != NULL);
     OAILOG_FUNC_IN (LOG_GTPV2C);
+    nwGtpv2cTrimPools (thiz, false);
 
     switch (pUlpReq->apiType & 0x00FFFFFFL) {
     case NW_GTPV2C_ULP_API_INITIAL_REQ:{
@@ -1806,8 +2075,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     if (thiz->activeTimerInfo == timeoutInfo) {
       thiz->activeTimerInfo = NULL;
       RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      nwGtpv2cPoolRelease (&thiz->timeoutInfoPool, timeoutInfo);
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
     } else {
       OAILOG_WARNING (LOG_GTPV2C,  "Received timeout event from ULP for non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n", timeoutInfo, thiz->activeTimerInfo);
@@ -1822,8 +2090,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
 
       pNextTimeoutInfo = RB_NEXT (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
       RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      nwGtpv2cPoolRelease (&thiz->timeoutInfoPool, timeoutInfo);
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
       timeoutInfo = pNextTimeoutInfo;
     }
@@ -1862,8 +2129,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
       rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
       OAI_GCC_DIAG_ON(int-to-pointer-cast);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      nwGtpv2cPoolRelease (&thiz->timeoutInfoPool, timeoutInfo);
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
     } else {
       OAILOG_WARNING (LOG_GTPV2C,  "Received timeout event from ULP for " "non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n", timeoutInfo, thiz->activeTimerInfo);
@@ -1883,8 +2149,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
       rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
       OAI_GCC_DIAG_ON(int-to-pointer-cast);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      nwGtpv2cPoolRelease (&thiz->timeoutInfoPool, timeoutInfo);
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
       timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
@@ -1929,12 +2194,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
 
     OAILOG_FUNC_IN (LOG_GTPV2C);
 
-    if (gpGtpv2cTimeoutInfoPool) {
-      timeoutInfo = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_timeout_info_t), timeoutInfo, nw_gtpv2c_timeout_info_t *);
-    }
+    timeoutInfo = (nw_gtpv2c_timeout_info_t *) nwGtpv2cPoolAlloc (&thiz->timeoutInfoPool);
 
     if (timeoutInfo) {
       timeoutInfo->tmrType = tmrType;
@@ -2006,12 +2266,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     NW_ASSERT (thiz != NULL);
     OAILOG_FUNC_IN (LOG_GTPV2C);
 
-    if (gpGtpv2cTimeoutInfoPool) {
-      timeoutInfo = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_timeout_info_t), timeoutInfo, nw_gtpv2c_timeout_info_t *);
-    }
+    timeoutInfo = (nw_gtpv2c_timeout_info_t *) nwGtpv2cPoolAlloc (&thiz->timeoutInfoPool);
 
     if (timeoutInfo) {
       timeoutInfo->tmrType = tmrType;
@@ -2077,8 +2332,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     OAI_GCC_DIAG_OFF(int-to-pointer-cast);
     rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
     OAI_GCC_DIAG_ON(int-to-pointer-cast);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
+    nwGtpv2cPoolRelease (&thiz->timeoutInfoPool, timeoutInfo);
 //    OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
 
     if (thiz->activeTimerInfo == timeoutInfo) {
@@ -2124,8 +2378,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     OAILOG_FUNC_IN (LOG_GTPV2C);
     timeoutInfo = (nw_gtpv2c_timeout_info_t *) hTimer;
     RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
+    nwGtpv2cPoolRelease (&thiz->timeoutInfoPool, timeoutInfo);
     OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
 
     if (thiz->activeTimerInfo == timeoutInfo) {
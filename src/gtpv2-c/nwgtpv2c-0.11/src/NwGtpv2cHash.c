@@ -0,0 +1,229 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/**
+ * @file NwGtpv2cHash.c
+ * @author Dincer BEKEN
+ * @brief Intrusive chained hash map for the tunnel and transaction lookups of the stack.
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include "NwGtpv2cHash.h"
+
+#ifdef __cplusplus
+extern                                  "C" {
+#endif
+
+#define NW_GTPV2C_HASH_NODE(_thiz, _elem)     ((nw_gtpv2c_hash_node_t *)((uint8_t *)(_elem) + (_thiz)->nodeOffset))
+#define NW_GTPV2C_HASH_ELEM(_thiz, _node)     ((void *)((uint8_t *)(_node) - (_thiz)->nodeOffset))
+
+/*--------------------------------------------------------------------------*
+                     P R I V A T E      F U N C T I O N S
+  --------------------------------------------------------------------------*/
+
+/**
+  Double the number of buckets, the stored hashes are reused. The map stays as is if no memory is left.
+*/
+static void nwGtpv2cHashGrow (nw_gtpv2c_hash_t * thiz)
+{
+  const uint32_t                          newSize = (thiz->mask + 1) << 1;
+  nw_gtpv2c_hash_node_t                 **newBuckets = NULL;
+
+  if (!newSize || !(newBuckets = calloc (newSize, sizeof (nw_gtpv2c_hash_node_t *))))
+    return;
+
+  for (uint32_t i = 0; i <= thiz->mask; i++) {
+    nw_gtpv2c_hash_node_t                  *node = thiz->buckets[i];
+
+    while (node) {
+      nw_gtpv2c_hash_node_t                  *next = node->next;
+
+      node->next = newBuckets[node->hash & (newSize - 1)];
+      newBuckets[node->hash & (newSize - 1)] = node;
+      node = next;
+    }
+  }
+  free (thiz->buckets);
+  thiz->buckets = newBuckets;
+  thiz->mask = newSize - 1;
+}
+
+/*--------------------------------------------------------------------------*
+                       P U B L I C   F U N C T I O N S
+  --------------------------------------------------------------------------*/
+
+nw_rc_t nwGtpv2cHashInit (
+  nw_gtpv2c_hash_t * thiz,
+  uint32_t size,
+  size_t nodeOffset,
+  uint32_t (*hashFunc) (const void *elem),
+  int32_t (*cmpFunc) (const void *a, const void *b))
+{
+  uint32_t                                buckets = 1;
+
+  while (buckets < size)
+    buckets <<= 1;
+
+  memset (thiz, 0, sizeof (nw_gtpv2c_hash_t));
+  if (!(thiz->buckets = calloc (buckets, sizeof (nw_gtpv2c_hash_node_t *))))
+    return NW_FAILURE;
+  thiz->mask = buckets - 1;
+  thiz->nodeOffset = nodeOffset;
+  thiz->hashFunc = hashFunc;
+  thiz->cmpFunc = cmpFunc;
+  return NW_OK;
+}
+
+void nwGtpv2cHashDestroy (nw_gtpv2c_hash_t * thiz)
+{
+  free (thiz->buckets);
+  thiz->buckets = NULL;
+  thiz->mask = 0;
+  thiz->count = 0;
+}
+
+void *nwGtpv2cHashFind (
+  const nw_gtpv2c_hash_t * thiz,
+  const void *key)
+{
+  const uint32_t                          hash = thiz->hashFunc (key);
+
+  for (nw_gtpv2c_hash_node_t * node = thiz->buckets[hash & thiz->mask]; node; node = node->next) {
+    if (node->hash == hash && !thiz->cmpFunc (NW_GTPV2C_HASH_ELEM (thiz, node), key))
+      return NW_GTPV2C_HASH_ELEM (thiz, node);
+  }
+  return NULL;
+}
+
+void *nwGtpv2cHashInsert (
+  nw_gtpv2c_hash_t * thiz,
+  void *elem)
+{
+  nw_gtpv2c_hash_node_t                  *node = NW_GTPV2C_HASH_NODE (thiz, elem);
+  void                                   *pCollision = NULL;
+
+  node->hash = thiz->hashFunc (elem);
+  for (nw_gtpv2c_hash_node_t * other = thiz->buckets[node->hash & thiz->mask]; other; other = other->next) {
+    if (other->hash == node->hash && !thiz->cmpFunc (NW_GTPV2C_HASH_ELEM (thiz, other), elem)) {
+      pCollision = NW_GTPV2C_HASH_ELEM (thiz, other);
+      return pCollision;
+    }
+  }
+  if (thiz->count > thiz->mask)
+    nwGtpv2cHashGrow (thiz);
+  node->next = thiz->buckets[node->hash & thiz->mask];
+  thiz->buckets[node->hash & thiz->mask] = node;
+  thiz->count++;
+  return NULL;
+}
+
+void *nwGtpv2cHashRemove (
+  nw_gtpv2c_hash_t * thiz,
+  void *elem)
+{
+  nw_gtpv2c_hash_node_t                  *node = NW_GTPV2C_HASH_NODE (thiz, elem);
+
+  /** The stored hash is used, the key fields of the element may have been changed since the insertion. */
+  for (nw_gtpv2c_hash_node_t ** pp = &thiz->buckets[node->hash & thiz->mask]; *pp; pp = &(*pp)->next) {
+    if (*pp == node) {
+      *pp = node->next;
+      node->next = NULL;
+      thiz->count--;
+      return elem;
+    }
+  }
+  return NULL;
+}
+
+uint32_t nwGtpv2cHashRemoveIf (
+  nw_gtpv2c_hash_t * thiz,
+  bool (*match) (const void *elem, void *arg),
+  void (*release) (void *elem, void *arg),
+  void *arg)
+{
+  uint32_t                                removed = 0;
+
+  for (uint32_t i = 0; i <= thiz->mask && thiz->count; i++) {
+    nw_gtpv2c_hash_node_t                 **pp = &thiz->buckets[i];
+
+    while (*pp) {
+      nw_gtpv2c_hash_node_t                  *node = *pp;
+
+      if (!match (NW_GTPV2C_HASH_ELEM (thiz, node), arg)) {
+        pp = &node->next;
+        continue;
+      }
+      *pp = node->next;
+      node->next = NULL;
+      thiz->count--;
+      removed++;
+      if (release)
+        release (NW_GTPV2C_HASH_ELEM (thiz, node), arg);
+    }
+  }
+  return removed;
+}
+
+uint32_t nwGtpv2cHashMix (
+  uint32_t hash,
+  uint32_t value)
+{
+  /** Murmur3 32 bit block mixing. */
+  value *= 0xcc9e2d51;
+  value = (value << 15) | (value >> 17);
+  value *= 0x1b873593;
+  hash ^= value;
+  hash = (hash << 13) | (hash >> 19);
+  return hash * 5 + 0xe6546b64;
+}
+
+uint32_t nwGtpv2cHashPeer (
+  uint32_t hash,
+  const struct sockaddr *peer)
+{
+  hash = nwGtpv2cHashMix (hash, peer->sa_family);
+  if (peer->sa_family == AF_INET) {
+    return nwGtpv2cHashMix (hash, ((const struct sockaddr_in *)peer)->sin_addr.s_addr);
+  }
+  if (peer->sa_family == AF_INET6) {
+    const uint8_t                          *addr = ((const struct sockaddr_in6 *)peer)->sin6_addr.s6_addr;
+
+    for (int i = 0; i < 16; i += 4) {
+      uint32_t                                word;
+
+      memcpy (&word, &addr[i], sizeof (word));
+      hash = nwGtpv2cHashMix (hash, word);
+    }
+  }
+  return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*--------------------------------------------------------------------------*
+                        E N D     O F    F I L E
+  --------------------------------------------------------------------------*/
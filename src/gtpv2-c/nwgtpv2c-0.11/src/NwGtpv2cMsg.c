@@ -58,8 +58,6 @@ extern                                  "C" {
                        P R I V A T E     F U N C T I O N S
   ----------------------------------------------------------------------------*/
 
-  static nw_gtpv2c_msg_t                    *gpGtpv2cMsgPool = NULL;
-
 /*----------------------------------------------------------------------------*
                          P U B L I C   F U N C T I O N S
   ----------------------------------------------------------------------------*/
@@ -76,13 +74,7 @@ extern                                  "C" {
                                             NW_ASSERT (
   pStack);
 
-    if (gpGtpv2cMsgPool) {
-      pMsg = gpGtpv2cMsgPool;
-      gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (pStack, sizeof (nw_gtpv2c_msg_t), pMsg, nw_gtpv2c_msg_t *);
-      OAILOG_DEBUG (LOG_GTPV2C, "ALLOCATED NEW MESSAGE %p!\n", pMsg);
-    }
+    pMsg = (nw_gtpv2c_msg_t *) nwGtpv2cPoolAlloc (&pStack->msgPool);
 
     if (pMsg) {
       pMsg->version = NW_GTP_VERSION;
@@ -111,12 +103,7 @@ extern                                  "C" {
 
     NW_ASSERT (pStack);
 
-    if (gpGtpv2cMsgPool) {
-      pMsg = gpGtpv2cMsgPool;
-      gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (pStack, sizeof (nw_gtpv2c_msg_t), pMsg, nw_gtpv2c_msg_t *);
-    }
+    pMsg = (nw_gtpv2c_msg_t *) nwGtpv2cPoolAlloc (&pStack->msgPool);
 
     if (pMsg) {
       *phMsg = (nw_gtpv2c_msg_handle_t) pMsg;
@@ -146,13 +133,12 @@ extern                                  "C" {
   nw_rc_t                                   nwGtpv2cMsgDelete (
   NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
   NW_IN nw_gtpv2c_msg_handle_t hMsg) {
-    // warning: unused variable ‘pStack’ [-Wunused-variable]: NwGtpv2cStackT                         *pStack = (NwGtpv2cStackT *) hGtpcStackHandle;
+    /** Back to the pool of the stack which created the message. */
+    nw_gtpv2c_stack_t                         *pStack = (nw_gtpv2c_stack_t *) ((nw_gtpv2c_msg_t *) hMsg)->hStack;
 
+    NW_ASSERT (pStack);
     OAILOG_DEBUG (LOG_GTPV2C, "Purging message 0x%" PRIxPTR "!\n", hMsg);
-    ((nw_gtpv2c_msg_t *) hMsg)->next = gpGtpv2cMsgPool;
-    gpGtpv2cMsgPool = (nw_gtpv2c_msg_t *) hMsg;
-    OAILOG_DEBUG (LOG_GTPV2C, "Message pool %" PRIxPTR "! Next element %" PRIxPTR "! \n",
-    		gpGtpv2cMsgPool, gpGtpv2cMsgPool->next);
+    nwGtpv2cPoolRelease (&pStack->msgPool, (void *)hMsg);
 
     return NW_OK;
   }
@@ -270,6 +256,13 @@ extern                                  "C" {
     return (thiz->msgLen);
   }
 
+  uint8_t                                  *nwGtpv2cMsgGetBuffer (
+  NW_IN nw_gtpv2c_msg_handle_t hMsg) {
+    nw_gtpv2c_msg_t                           *thiz = (nw_gtpv2c_msg_t *) hMsg;
+
+    return (thiz->msgBuf);
+  }
+
 
   nw_rc_t                                   nwGtpv2cMsgAddIeTV1 (
   NW_IN nw_gtpv2c_msg_handle_t hMsg,
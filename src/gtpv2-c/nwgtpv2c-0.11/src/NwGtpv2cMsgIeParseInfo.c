@@ -535,6 +535,32 @@ extern                                  "C" {
     {0, 0, 0}
   };
 
+  /** Sm: MBMS session responses of the MCE, received by an MBMS-GW. */
+  static
+  NwGtpv2cMsgIeInfoT                      mbmsSessionStartRspIeInfoTbl[] = {
+    {NW_GTPV2C_IE_CAUSE, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, NULL},
+    {NW_GTPV2C_IE_FTEID, 9, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, NULL},
+    {NW_GTPV2C_IE_RECOVERY, 1, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, NULL},
+    {NW_GTPV2C_IE_PRIVATE_EXTENSION, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, NULL},
+
+    /*
+     * Do not add below this
+     */
+    {0, 0, 0}
+  };
+
+  static
+  NwGtpv2cMsgIeInfoT                      mbmsSessionUpdateStopRspIeInfoTbl[] = {
+    {NW_GTPV2C_IE_CAUSE, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, NULL},
+    {NW_GTPV2C_IE_RECOVERY, 1, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, NULL},
+    {NW_GTPV2C_IE_PRIVATE_EXTENSION, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, NULL},
+
+    /*
+     * Do not add below this
+     */
+    {0, 0, 0}
+  };
+
   static
   NwGtpv2cMsgIeInfoT                      contextReqIeInfoTbl[] = {
     {NW_GTPV2C_IE_IMSI, 8, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, NULL},
@@ -1023,6 +1049,19 @@ extern                                  "C" {
         }
         break;
 
+      case NW_GTP_MBMS_SESSION_START_RSP:{
+          rc = nwGtpv2cMsgIeParseInfoUpdate (thiz, mbmsSessionStartRspIeInfoTbl);
+          NW_ASSERT (NW_OK == rc);
+        }
+        break;
+
+      case NW_GTP_MBMS_SESSION_UPDATE_RSP:
+      case NW_GTP_MBMS_SESSION_STOP_RSP:{
+          rc = nwGtpv2cMsgIeParseInfoUpdate (thiz, mbmsSessionUpdateStopRspIeInfoTbl);
+          NW_ASSERT (NW_OK == rc);
+        }
+        break;
+
       /** Paging related downlink data notification. */
       case NW_GTP_DOWNLINK_DATA_NOTIFICATION: {
         rc = nwGtpv2cMsgIeParseInfoUpdate (thiz, downlinkDataNtfIeInfoTbl);
@@ -181,6 +181,7 @@ extern                                  "C" {
     uint8_t                                *pIeStart;
     uint8_t                                *pIeEnd;
     uint16_t                                ieLength;
+    uint8_t                                 ieInstance;
     nw_gtpv2c_msg_t                           *pMsg = (nw_gtpv2c_msg_t *) hMsg;
 
     NW_ASSERT (pMsg);
@@ -192,48 +193,67 @@ extern                                  "C" {
 
     while (pIeStart < pIeEnd) {
       pIe = (nw_gtpv2c_ie_tlv_t *) pIeStart;
+
+      if (pIeStart + 4 > pIeEnd) {
+        /** Not even the IE header left. */
+        *pOffendingIeType = pIe->t;
+        *pOffendingIeLength = 0;
+        *pOffendingIeInstance = 0;
+        return NW_GTPV2C_MSG_MALFORMED;
+      }
+
       ieLength = ntohs (pIe->l);
+      ieInstance = pIe->i & 0x0F;
 
       if (pIeStart + 4 + ieLength > pIeEnd) {
         *pOffendingIeType = pIe->t;
-        *pOffendingIeLength = pIe->l;
-        *pOffendingIeInstance = pIe->i;
+        *pOffendingIeLength = ieLength;
+        *pOffendingIeInstance = ieInstance;
         return NW_GTPV2C_MSG_MALFORMED;
       }
 
-      if ((thiz->ieParseInfo[pIe->t][pIe->i].iePresence)) {
-        thiz->pIe[pIe->t][pIe->i] = (uint8_t *) pIeStart;
-        pMsg->pIe[pIe->t][pIe->i] = (uint8_t *) pIeStart;
+      if (ieInstance >= NW_GTPV2C_IE_INSTANCE_MAXIMUM) {
+        /** No parse info can exist for the instance (the spare bits are ignored). */
+        OAILOG_WARNING (LOG_GTPV2C,  "Unexpected IE %u with instance %u of length %u received in msg %u!\n", pIe->t, ieInstance, ieLength, thiz->msgType);
+      } else if ((thiz->ieParseInfo[pIe->t][ieInstance].iePresence)) {
+        thiz->pIe[pIe->t][ieInstance] = (uint8_t *) pIeStart;
+        pMsg->pIe[pIe->t][ieInstance] = (uint8_t *) pIeStart;
         OAILOG_DEBUG (LOG_GTPV2C,  "Received IE %u of length %u!\n", pIe->t, ieLength);
 
-        if ((thiz->ieParseInfo[pIe->t][pIe->i].ieReadCallback) != NULL) {
-          rc = thiz->ieParseInfo[pIe->t][pIe->i].ieReadCallback (pIe->t, ieLength, pIe->i, pIeStart + 4, thiz->ieParseInfo[pIe->t][pIe->i].ieReadCallbackArg);
+        if ((thiz->ieParseInfo[pIe->t][ieInstance].ieReadCallback) != NULL) {
+          rc = thiz->ieParseInfo[pIe->t][ieInstance].ieReadCallback (pIe->t, ieLength, ieInstance, pIeStart + 4, thiz->ieParseInfo[pIe->t][ieInstance].ieReadCallbackArg);
 
           if (NW_OK == rc) {
-            if (thiz->ieParseInfo[pIe->t][pIe->i].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
-              if(!thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred){
+            if (thiz->ieParseInfo[pIe->t][ieInstance].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
+              if(!thiz->ieParseInfo[pIe->t][ieInstance].firstInstanceOccurred){
                 mandatoryIeCount++;
-                thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred = true;
+                thiz->ieParseInfo[pIe->t][ieInstance].firstInstanceOccurred = true;
               }
             }
           } else {
-            OAILOG_ERROR (LOG_GTPV2C, "Error while parsing IE %u with instance %u and length %u!\n", pIe->t, pIe->i, ieLength);
+            OAILOG_ERROR (LOG_GTPV2C, "Error while parsing IE %u with instance %u and length %u!\n", pIe->t, ieInstance, ieLength);
+            *pOffendingIeType = pIe->t;
+            *pOffendingIeLength = ieLength;
+            *pOffendingIeInstance = ieInstance;
             break;
           }
         } else {
           if ((thiz->ieReadCallback) != NULL) {
             OAILOG_DEBUG (LOG_GTPV2C,  "Received IE %u of length %u!\n", pIe->t, ieLength);
-            rc = thiz->ieReadCallback (pIe->t, ieLength, pIe->i, pIeStart + 4, thiz->ieReadCallbackArg);
+            rc = thiz->ieReadCallback (pIe->t, ieLength, ieInstance, pIeStart + 4, thiz->ieReadCallbackArg);
 
             if (NW_OK == rc) {
-              if (thiz->ieParseInfo[pIe->t][pIe->i].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
-                if(!thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred){
+              if (thiz->ieParseInfo[pIe->t][ieInstance].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
+                if(!thiz->ieParseInfo[pIe->t][ieInstance].firstInstanceOccurred){
                   mandatoryIeCount++;
-                  thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred = true;
+                  thiz->ieParseInfo[pIe->t][ieInstance].firstInstanceOccurred = true;
                 }
               }
             } else {
               OAILOG_ERROR (LOG_GTPV2C, "Error while parsing IE %u of length %u!\n", pIe->t, ieLength);
+              *pOffendingIeType = pIe->t;
+              *pOffendingIeLength = ieLength;
+              *pOffendingIeInstance = ieInstance;
               break;
             }
           } else {
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/**
+ * @file NwGtpv2cPool.c
+ * @author Dincer BEKEN
+ * @brief Per stack instance free lists of the stack objects, with high-water-mark tracking and bounded trimming.
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "NwGtpv2cPool.h"
+
+#ifdef __cplusplus
+extern                                  "C" {
+#endif
+
+#define NW_GTPV2C_POOL_NEXT(_thiz, _obj)      (*(void **)((uint8_t *)(_obj) + (_thiz)->nextOffset))
+
+/*--------------------------------------------------------------------------*
+                       P U B L I C   F U N C T I O N S
+  --------------------------------------------------------------------------*/
+
+void nwGtpv2cPoolInit (
+  nw_gtpv2c_pool_t * thiz,
+  size_t objSize,
+  size_t nextOffset,
+  uint32_t maxFree)
+{
+  memset (thiz, 0, sizeof (nw_gtpv2c_pool_t));
+  thiz->objSize = objSize;
+  thiz->nextOffset = nextOffset;
+  thiz->maxFree = maxFree;
+}
+
+void nwGtpv2cPoolDestroy (nw_gtpv2c_pool_t * thiz)
+{
+  while (thiz->freeList) {
+    void                                   *obj = thiz->freeList;
+
+    thiz->freeList = NW_GTPV2C_POOL_NEXT (thiz, obj);
+    free (obj);
+  }
+  thiz->freeCount = 0;
+}
+
+void *nwGtpv2cPoolAlloc (nw_gtpv2c_pool_t * thiz)
+{
+  void                                   *obj = thiz->freeList;
+
+  if (obj) {
+    thiz->freeList = NW_GTPV2C_POOL_NEXT (thiz, obj);
+    thiz->freeCount--;
+  } else if ((obj = malloc (thiz->objSize))) {
+    thiz->allocated++;
+  } else {
+    return NULL;
+  }
+  thiz->inUse++;
+  if (thiz->inUse > thiz->windowHighWaterMark) {
+    thiz->windowHighWaterMark = thiz->inUse;
+    if (thiz->inUse > thiz->highWaterMark)
+      thiz->highWaterMark = thiz->inUse;
+  }
+  return obj;
+}
+
+void nwGtpv2cPoolRelease (
+  nw_gtpv2c_pool_t * thiz,
+  void *obj)
+{
+  NW_GTPV2C_POOL_NEXT (thiz, obj) = thiz->freeList;
+  thiz->freeList = obj;
+  thiz->freeCount++;
+  thiz->inUse--;
+  thiz->releases++;
+}
+
+uint32_t nwGtpv2cPoolTrim (
+  nw_gtpv2c_pool_t * thiz,
+  bool force)
+{
+  uint32_t                                keep = thiz->windowHighWaterMark - thiz->inUse;
+  uint32_t                                nbTrimmed = 0;
+
+  if (!force && thiz->releases < NW_GTPV2C_POOL_TRIM_INTERVAL)
+    return 0;
+
+  /** Enough objects to serve the peak use of the window again, within the bound. */
+  if (keep > thiz->maxFree)
+    keep = thiz->maxFree;
+  while (thiz->freeCount > keep) {
+    void                                   *obj = thiz->freeList;
+
+    thiz->freeList = NW_GTPV2C_POOL_NEXT (thiz, obj);
+    thiz->freeCount--;
+    free (obj);
+    nbTrimmed++;
+  }
+  thiz->trimmed += nbTrimmed;
+  thiz->windowHighWaterMark = thiz->inUse;
+  thiz->releases = 0;
+  return nbTrimmed;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*--------------------------------------------------------------------------*
+                        E N D     O F    F I L E
+  --------------------------------------------------------------------------*/
@@ -0,0 +1,308 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/**
+ * @file NwGtpv2cPoolTest.c
+ * @author Dincer BEKEN
+ * @brief Test of the object pools of the stack and of their trimming while datagrams are queued for sending.
+ *
+ * The pool checks cover the trim window, the bound on the kept objects and the peak use kept over a window.
+ * The stack check grows the message pool with a burst, then answers Echo Requests through a UDP entity which, like
+ * the Sm task, queues the datagrams in UDP_DATA_REQ messages and sends them later: the queued datagrams must be
+ * intact after the trims that freed the released messages. The path supervision sends its periodic Echo Requests,
+ * and their retransmissions, through the same queue. Run it with AddressSanitizer to see a borrowed buffer.
+ * Exit status 1 on any failed check.
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+
+#include "NwTypes.h"
+#include "NwLog.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cPool.h"
+#include "udp_messages_types.h"
+
+#define NW_GTPV2C_POOL_TEST_BURST                               (3000)  /**< Messages of the burst growing the pool  */
+#define NW_GTPV2C_POOL_TEST_ECHO_REQUESTS                       (20000)
+#define NW_GTPV2C_POOL_TEST_ECHO_INTERVAL                       (100)   /**< Received Echo Requests per sent one     */
+#define NW_GTPV2C_POOL_TEST_QUEUE_SIZE                          (64)    /**< Datagrams queued before they are sent   */
+#define NW_GTPV2C_POOL_TEST_RESTART_COUNTER                     (7)
+#define NW_GTPV2C_POOL_TEST_PEER_PORT                           (2123)
+
+#define NW_GTPV2C_POOL_TEST_CHECK(_cond, ...)                                  \
+  do {                                                                         \
+    if (!(_cond)) {                                                            \
+      printf ("FAILED %s:%d: ", __FILE__, __LINE__);                           \
+      printf (__VA_ARGS__);                                                    \
+      printf ("\n");                                                           \
+      nwGtpv2cPoolTestErrors++;                                                \
+    }                                                                          \
+  } while (0)
+
+/** A queued datagram and what the test expects to read from it once sent. */
+typedef struct nw_gtpv2c_pool_test_datagram_s {
+  udp_data_req_t                          req;
+  uint8_t                                 msgType;
+  uint32_t                                seqNum;
+} nw_gtpv2c_pool_test_datagram_t;
+
+static uint32_t                           nwGtpv2cPoolTestErrors = 0;
+static nw_gtpv2c_pool_test_datagram_t     nwGtpv2cPoolTestQueue[NW_GTPV2C_POOL_TEST_QUEUE_SIZE];
+static uint32_t                           nwGtpv2cPoolTestQueued = 0;
+static uint32_t                           nwGtpv2cPoolTestSent = 0;
+static uint8_t                            nwGtpv2cPoolTestExpectedType = 0;
+static uint32_t                           nwGtpv2cPoolTestExpectedSeqNum = 0;
+
+/*---------------------------------------------------------------------------
+                        P O O L   C H E C K S
+  --------------------------------------------------------------------------*/
+
+static void nwGtpv2cPoolTestPool (void)
+{
+  nw_gtpv2c_pool_t                        pool;
+  void                                   *objs[100];
+  uint8_t                                *obj = NULL;
+
+  nwGtpv2cPoolInit (&pool, 64, 0, 16);
+  for (int i = 0; i < 100; i++)
+    objs[i] = nwGtpv2cPoolAlloc (&pool);
+  NW_GTPV2C_POOL_TEST_CHECK (pool.allocated == 100 && pool.inUse == 100 && pool.highWaterMark == 100,
+      "allocated %" PRIu64 " in use %u high-water mark %u", pool.allocated, pool.inUse, pool.highWaterMark);
+  memset ((uint8_t *)objs[99] + sizeof (void *), 0xA5, 64 - sizeof (void *));
+  for (int i = 0; i < 100; i++)
+    nwGtpv2cPoolRelease (&pool, objs[i]);
+
+  /** Released objects stay readable until the next trim, the stack relies on it for its timeout infos. */
+  obj = (uint8_t *)pool.freeList;
+  NW_GTPV2C_POOL_TEST_CHECK (obj == objs[99] && obj[sizeof (void *)] == 0xA5 && obj[63] == 0xA5, "released object changed");
+
+  /** The trim window is not over. */
+  NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cPoolTrim (&pool, false) == 0 && pool.freeCount == 100, "trimmed within the window");
+
+  /** The peak of the window would keep 100 objects, the bound keeps 16. */
+  NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cPoolTrim (&pool, true) == 84 && pool.freeCount == 16 && pool.trimmed == 84,
+      "first trim kept %u objects", pool.freeCount);
+
+  /** Nothing was in use over the last window. */
+  NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cPoolTrim (&pool, true) == 16 && pool.freeCount == 0, "second trim kept %u objects", pool.freeCount);
+
+  /** A steady use of 8 objects is served from the pool, and a window over keeps the 8 objects of its peak. */
+  for (int round = 0; round < (NW_GTPV2C_POOL_TRIM_INTERVAL / 8) + 1; round++) {
+    for (int i = 0; i < 8; i++)
+      objs[i] = nwGtpv2cPoolAlloc (&pool);
+    for (int i = 0; i < 8; i++)
+      nwGtpv2cPoolRelease (&pool, objs[i]);
+  }
+  NW_GTPV2C_POOL_TEST_CHECK (pool.allocated == 108, "allocated %" PRIu64 " objects for a steady use of 8", pool.allocated);
+  NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cPoolTrim (&pool, false) == 0 && pool.freeCount == 8 && pool.releases == 0,
+      "steady use trim kept %u objects", pool.freeCount);
+  nwGtpv2cPoolDestroy (&pool);
+  NW_GTPV2C_POOL_TEST_CHECK (pool.freeCount == 0, "destroyed pool keeps %u objects", pool.freeCount);
+}
+
+/*---------------------------------------------------------------------------
+                        S T A C K   E N T I T I E S
+  --------------------------------------------------------------------------*/
+
+static void nwGtpv2cPoolTestSendQueued (void)
+{
+  for (uint32_t i = 0; i < nwGtpv2cPoolTestQueued; i++) {
+    const nw_gtpv2c_pool_test_datagram_t   *datagram = &nwGtpv2cPoolTestQueue[i];
+    const uint8_t                          *buf = datagram->req.buffer;
+    const uint32_t                          seqNum = ((uint32_t)buf[4] << 16) | ((uint32_t)buf[5] << 8) | buf[6];
+
+    /** Header without TEID, then the Recovery IE. */
+    NW_GTPV2C_POOL_TEST_CHECK (datagram->req.buffer_length == 13 && buf[1] == datagram->msgType && seqNum == datagram->seqNum
+        && buf[8] == NW_GTPV2C_IE_RECOVERY && buf[12] == NW_GTPV2C_POOL_TEST_RESTART_COUNTER,
+        "datagram %u of type %u seq %u sent as %u bytes of type %u seq %u", nwGtpv2cPoolTestSent, datagram->msgType,
+        datagram->seqNum, datagram->req.buffer_length, buf[1], seqNum);
+    NW_GTPV2C_POOL_TEST_CHECK (datagram->req.peer_address.addrv4.sin_family == AF_INET
+        && datagram->req.peer_address.addrv4.sin_addr.s_addr == htonl (INADDR_LOOPBACK)
+        && datagram->req.peer_port == NW_GTPV2C_POOL_TEST_PEER_PORT, "datagram %u to the wrong peer", nwGtpv2cPoolTestSent);
+    nwGtpv2cPoolTestSent++;
+  }
+  nwGtpv2cPoolTestQueued = 0;
+}
+
+/**
+ * Queues the datagram as the Sm task does, in the message read later by the UDP task.
+ */
+static nw_rc_t nwGtpv2cPoolTestUdpDataReq (
+  nw_gtpv2c_udp_handle_t udpHandle,
+  uint8_t * dataBuf,
+  uint32_t dataSize,
+  uint16_t localPort,
+  struct sockaddr * peerIp,
+  uint16_t peerPort)
+{
+  nw_gtpv2c_pool_test_datagram_t         *datagram = NULL;
+
+  if (nwGtpv2cPoolTestQueued == NW_GTPV2C_POOL_TEST_QUEUE_SIZE)
+    nwGtpv2cPoolTestSendQueued ();
+  datagram = &nwGtpv2cPoolTestQueue[nwGtpv2cPoolTestQueued++];
+  memset (&datagram->req, 0, sizeof (datagram->req));
+  if (dataSize > UDP_DATA_MAX_MSG_LEN)
+    return NW_FAILURE;
+  datagram->req.local_port = localPort;
+  datagram->req.peer_address.addrv4 = *(struct sockaddr_in *)peerIp;
+  datagram->req.peer_port = peerPort;
+  memcpy (datagram->req.buffer, dataBuf, dataSize);
+  datagram->req.buffer_length = dataSize;
+  datagram->msgType = nwGtpv2cPoolTestExpectedType;
+  datagram->seqNum = nwGtpv2cPoolTestExpectedSeqNum;
+  return NW_OK;
+}
+
+static nw_rc_t nwGtpv2cPoolTestUlpReq (
+  nw_gtpv2c_ulp_handle_t hUlp,
+  nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  return NW_OK;
+}
+
+static nw_rc_t nwGtpv2cPoolTestTimerStart (
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  uint32_t timeoutSec,
+  uint32_t timeoutUsec,
+  uint32_t tmrType,
+  void *tmrArg,
+  nw_gtpv2c_timer_handle_t * tmrHandle)
+{
+  *tmrHandle = (nw_gtpv2c_timer_handle_t) 1;
+  return NW_OK;
+}
+
+static nw_rc_t nwGtpv2cPoolTestTimerStop (
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  nw_gtpv2c_timer_handle_t tmrHandle)
+{
+  return NW_OK;
+}
+
+static nw_rc_t nwGtpv2cPoolTestLog (
+  nw_gtpv2c_log_mgr_handle_t logMgrHandle,
+  uint32_t logLevel,
+  char *file,
+  uint32_t line,
+  char *logStr)
+{
+  return NW_OK;
+}
+
+/*---------------------------------------------------------------------------
+                        S T A C K   C H E C K S
+  --------------------------------------------------------------------------*/
+
+static void nwGtpv2cPoolTestStack (void)
+{
+  nw_gtpv2c_stack_handle_t                hStack = 0;
+  nw_gtpv2c_ulp_entity_t                  ulp;
+  nw_gtpv2c_udp_entity_t                  udp;
+  nw_gtpv2c_timer_mgr_entity_t            tmrMgr;
+  nw_gtpv2c_log_mgr_entity_t              logMgr;
+  nw_gtpv2c_stack_pool_stats_t            stats;
+  static nw_gtpv2c_msg_handle_t           hMsgs[NW_GTPV2C_POOL_TEST_BURST];
+  struct sockaddr_in                      peer = {.sin_family = AF_INET};
+  uint32_t                                echoSeqNum = 0;
+  uint32_t                                nbEchoSent = 0;
+  uint8_t                                 echoReq[13] = {0x40, NW_GTP_ECHO_REQ, 0x00, 0x09, 0, 0, 0, 0,
+                                                         NW_GTPV2C_IE_RECOVERY, 0x00, 0x01, 0x00, 1};
+
+  peer.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cInitialize (&hStack) == NW_OK, "no stack");
+  ulp.hUlp = 0;
+  ulp.ulpReqCallback = nwGtpv2cPoolTestUlpReq;
+  nwGtpv2cSetUlpEntity (hStack, &ulp);
+  udp.hUdp = 0;
+  udp.gtpv2cStandardPort = NW_GTPV2C_POOL_TEST_PEER_PORT;
+  udp.udpDataReqCallback = nwGtpv2cPoolTestUdpDataReq;
+  nwGtpv2cSetUdpEntity (hStack, &udp);
+  tmrMgr.tmrMgrHandle = 0;
+  tmrMgr.tmrStartCallback = nwGtpv2cPoolTestTimerStart;
+  tmrMgr.tmrStopCallback = nwGtpv2cPoolTestTimerStop;
+  nwGtpv2cSetTimerMgrEntity (hStack, &tmrMgr);
+  logMgr.logMgrHandle = 0;
+  logMgr.logReqCallback = nwGtpv2cPoolTestLog;
+  nwGtpv2cSetLogMgrEntity (hStack, &logMgr);
+  nwGtpv2cSetLogLevel (hStack, NW_LOG_LEVEL_EMER);
+  nwGtpv2cSetRestartCounter (hStack, NW_GTPV2C_POOL_TEST_RESTART_COUNTER);
+
+  /** A burst fills the message pool beyond its bound, the trims of the following windows free the messages. */
+  for (int i = 0; i < NW_GTPV2C_POOL_TEST_BURST; i++)
+    nwGtpv2cMsgNew (hStack, false, NW_GTP_ECHO_REQ, 0, i, &hMsgs[i]);
+  for (int i = 0; i < NW_GTPV2C_POOL_TEST_BURST; i++)
+    nwGtpv2cMsgDelete (hStack, hMsgs[i]);
+
+  /** Each Echo message is released right after it was queued, and freed by a later trim before it is sent. */
+  nwGtpv2cPoolTestExpectedType = NW_GTP_ECHO_RSP;
+  for (uint32_t seqNum = 0; seqNum < NW_GTPV2C_POOL_TEST_ECHO_REQUESTS; seqNum++) {
+    echoReq[4] = (uint8_t)(seqNum >> 16);
+    echoReq[5] = (uint8_t)(seqNum >> 8);
+    echoReq[6] = (uint8_t)seqNum;
+    nwGtpv2cPoolTestExpectedSeqNum = seqNum;
+    nwGtpv2cProcessUdpReq (hStack, echoReq, sizeof (echoReq), NW_GTPV2C_POOL_TEST_PEER_PORT, NW_GTPV2C_POOL_TEST_PEER_PORT,
+        (struct sockaddr *)&peer);
+
+    /** Path supervision: an Echo Request every interval, every other one retransmitted with its sequence number. */
+    if ((seqNum % NW_GTPV2C_POOL_TEST_ECHO_INTERVAL) == 0) {
+      const bool                            retransmit = (seqNum % (2 * NW_GTPV2C_POOL_TEST_ECHO_INTERVAL)) != 0;
+
+      nwGtpv2cPoolTestExpectedType = NW_GTP_ECHO_REQ;
+      NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cSendEchoReq (hStack, (struct sockaddr *)&peer, NW_GTPV2C_POOL_TEST_PEER_PORT, retransmit,
+          &echoSeqNum) == NW_OK, "Echo Request not sent");
+      /** The sequence number is known once sent, the datagram is the last one queued. */
+      nwGtpv2cPoolTestQueue[nwGtpv2cPoolTestQueued - 1].seqNum = echoSeqNum;
+      nwGtpv2cPoolTestExpectedType = NW_GTP_ECHO_RSP;
+      nbEchoSent++;
+    }
+  }
+  nwGtpv2cPoolTestSendQueued ();
+  NW_GTPV2C_POOL_TEST_CHECK (nwGtpv2cPoolTestSent == NW_GTPV2C_POOL_TEST_ECHO_REQUESTS + nbEchoSent, "%u of %u datagrams sent",
+      nwGtpv2cPoolTestSent, NW_GTPV2C_POOL_TEST_ECHO_REQUESTS + nbEchoSent);
+
+  nwGtpv2cGetPoolStats (hStack, &stats);
+  printf ("Messages: in use %u, cached %u, high-water mark %u, allocated %" PRIu64 ", trimmed %" PRIu64 "\n",
+      stats.msg.inUse, stats.msg.cached, stats.msg.highWaterMark, stats.msg.allocated, stats.msg.trimmed);
+  NW_GTPV2C_POOL_TEST_CHECK (stats.msg.inUse == 0, "%u messages leaked", stats.msg.inUse);
+  NW_GTPV2C_POOL_TEST_CHECK (stats.msg.trimmed >= NW_GTPV2C_POOL_TEST_BURST - 1, "only %" PRIu64 " messages trimmed", stats.msg.trimmed);
+  NW_GTPV2C_POOL_TEST_CHECK (stats.msg.cached <= NW_GTPV2C_POOL_DEFAULT_MAX_FREE, "%u messages cached", stats.msg.cached);
+  nwGtpv2cFinalize (hStack);
+}
+
+int main (int argc, char **argv)
+{
+  nwGtpv2cPoolTestPool ();
+  nwGtpv2cPoolTestStack ();
+  printf ("%s: %u errors\n", argv[0], nwGtpv2cPoolTestErrors);
+  return nwGtpv2cPoolTestErrors ? 1 : 0;
+}
@@ -54,7 +54,6 @@
 extern                                  "C" {
 #endif
 
-  static nw_gtpv2c_trxn_t                   *gpGtpv2cTrxnPool = NULL;
 
 /*--------------------------------------------------------------------------*
                      P R I V A T E      F U N C T I O N S
@@ -88,7 +87,7 @@ extern                                  "C" {
 
     if(thiz->trx_flags & INTERNAL_FLAG_TRIGGERED_ACK){
     	OAILOG_ERROR (LOG_GTPV2C, "Transaction transaction %p (seqNo=0x%x) was acknowledged. Removing for timeout. \n", thiz, thiz->seqNum);
-    	RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(pStack->outstandingTxSeqNumMap), thiz);
+    	nwGtpv2cHashRemove (&(pStack->outstandingTxSeqNumMap), thiz);
     	rc = nwGtpv2cTrxnDelete (&thiz);
         return rc;
     }
@@ -99,7 +98,7 @@ extern                                  "C" {
     	                                            keyTunnel = {0};
     	keyTunnel.teid = thiz->teidLocal;
     	memcpy((void*)&keyTunnel.ipAddrRemote, (void*)&thiz->peer_ip, sizeof(thiz->peer_ip));
-        pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(pStack->tunnelMap), &keyTunnel);
+        pLocalTunnel = nwGtpv2cHashFind (&(pStack->tunnelMap), &keyTunnel);
 		if(pLocalTunnel) {
 	    	rc = nwGtpv2cTrxnSendMsgRetransmission (thiz);
 	    	NW_ASSERT (NW_OK == rc);
@@ -107,7 +106,7 @@ extern                                  "C" {
 		} else {
 			OAILOG_WARNING (LOG_GTPV2C,  "Tunnel for local-TEID 0x%x is removed for request transaction %p (seqNo=0x%x)! Removing the trx and ignoring timeout. \n",
 					thiz->teidLocal, thiz, thiz->seqNum);
-			RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(pStack->outstandingTxSeqNumMap), thiz);
+			nwGtpv2cHashRemove (&(pStack->outstandingTxSeqNumMap), thiz);
 			rc = nwGtpv2cTrxnDelete (&thiz);
 		}
     } else {
@@ -124,7 +123,7 @@ extern                                  "C" {
       /** Set the flags. */
       ulpApi.u_api_info.rspFailureInfo.trx_flags  = thiz->trx_flags;
       OAILOG_ERROR (LOG_GTPV2C, "N3 retries expired for transaction %p\n", thiz);
-      RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(pStack->outstandingTxSeqNumMap), thiz);
+      nwGtpv2cHashRemove (&(pStack->outstandingTxSeqNumMap), thiz);
       rc = nwGtpv2cTrxnDelete (&thiz);
       rc = pStack->ulp.ulpReqCallback (pStack->ulp.hUlp, &ulpApi);
     }
@@ -144,7 +143,7 @@ extern                                  "C" {
     NW_ASSERT (pStack);
     OAILOG_DEBUG (LOG_GTPV2C,  "Duplicate request hold timer expired for transaction %p with seqNum %d\n", thiz, thiz->seqNum);
     thiz->hRspTmr = 0;
-    RB_REMOVE (NwGtpv2cOutstandingRxSeqNumTrxnMap, &(pStack->outstandingRxSeqNumMap), thiz);
+    nwGtpv2cHashRemove (&(pStack->outstandingRxSeqNumMap), thiz);
     rc = nwGtpv2cTrxnDelete (&thiz);
     NW_ASSERT (NW_OK == rc);
     return rc;
@@ -213,16 +212,11 @@ extern                                  "C" {
   NW_IN nw_gtpv2c_stack_t * thiz) {
     nw_gtpv2c_trxn_t                          *pTrxn;
 
-    if (gpGtpv2cTrxnPool) {
-      pTrxn = gpGtpv2cTrxnPool;
-      gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t *);
-    }
+    pTrxn = (nw_gtpv2c_trxn_t *) nwGtpv2cPoolAlloc (&thiz->trxnPool);
 
     if (pTrxn) {
-    	OAILOG_DEBUG (LOG_GTPV2C,  "Created not trx without seqNum as transaction %p. Head %p, Next %p\n", pTrxn,
-      	gpGtpv2cTrxnPool, (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : "null");
+    	OAILOG_DEBUG (LOG_GTPV2C,  "Created not trx without seqNum as transaction %p. %u transactions in use\n", pTrxn,
+      	thiz->trxnPool.inUse);
 
       pTrxn->pStack = thiz;
       pTrxn->pMsg = NULL;
@@ -255,16 +249,11 @@ extern                                  "C" {
   NW_IN uint32_t seqNum) {
     nw_gtpv2c_trxn_t                          *pTrxn;
 
-    if (gpGtpv2cTrxnPool) {
-      pTrxn = gpGtpv2cTrxnPool;
-      gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t *);
-    }
+    pTrxn = (nw_gtpv2c_trxn_t *) nwGtpv2cPoolAlloc (&thiz->trxnPool);
 
     if (pTrxn) {
-      OAILOG_DEBUG (LOG_GTPV2C,  "Created new trx with seqNum %d as transaction %p. Head %p, Next %p\n", pTrxn, seqNum,
-    	gpGtpv2cTrxnPool, (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : "null");
+      OAILOG_DEBUG (LOG_GTPV2C,  "Created new trx with seqNum %d as transaction %p. %u transactions in use\n", seqNum, pTrxn,
+    	thiz->trxnPool.inUse);
 
       pTrxn->pStack = thiz;
       pTrxn->pMsg = NULL;
@@ -301,16 +290,11 @@ extern                                  "C" {
 
     // todo: ipv6 for retransmission1
 
-    if (gpGtpv2cTrxnPool) {
-      pTrxn = gpGtpv2cTrxnPool;
-      gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t *);
-    }
+    pTrxn = (nw_gtpv2c_trxn_t *) nwGtpv2cPoolAlloc (&thiz->trxnPool);
 
     if (pTrxn) {
-      OAILOG_DEBUG (LOG_GTPV2C,  "Received new Rx transaction %p, Head %p, Next %p\n", pTrxn,
-        	gpGtpv2cTrxnPool, (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : "null");
+      OAILOG_DEBUG (LOG_GTPV2C,  "Received new Rx transaction %p, %u transactions in use\n", pTrxn,
+        	thiz->trxnPool.inUse);
 
       pTrxn->pStack = thiz;
       pTrxn->maxRetries = 2;
@@ -321,7 +305,7 @@ extern                                  "C" {
       pTrxn->pMsg = NULL;
       pTrxn->hRspTmr = 0;
       pTrxn->pt_trx = false;
-      pCollision = RB_INSERT (NwGtpv2cOutstandingRxSeqNumTrxnMap, &(thiz->outstandingRxSeqNumMap), pTrxn);
+      pCollision = nwGtpv2cHashInsert (&(thiz->outstandingRxSeqNumMap), pTrxn);
 
       if (pCollision) {
         OAILOG_WARNING (LOG_GTPV2C,  "Duplicate request message received for seq num 0x%x for trx (%p)!\n", (uint32_t) seqNum, pCollision);
@@ -378,14 +362,12 @@ extern                                  "C" {
       NW_ASSERT (NW_OK == rc);
     }
 
-    OAILOG_DEBUG (LOG_GTPV2C,  "Purging  transaction %p with seqNum %d. (before) Head %p, Next %p. \n", thiz, thiz->seqNum,
-    		gpGtpv2cTrxnPool, (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next: 0);
-    thiz->next = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = thiz;
+    OAILOG_DEBUG (LOG_GTPV2C,  "Purging  transaction %p with seqNum %d.\n", thiz, thiz->seqNum);
+    nwGtpv2cPoolRelease (&pStack->trxnPool, thiz);
     *pthiz = NULL;
 
-    OAILOG_DEBUG (LOG_GTPV2C,  "After purging  transaction %p, Head %p, Next %p\n", thiz,
-    		gpGtpv2cTrxnPool, (gpGtpv2cTrxnPool) ? gpGtpv2cTrxnPool->next : "null");
+    OAILOG_DEBUG (LOG_GTPV2C,  "After purging  transaction %p, %u transactions in use\n", thiz,
+    		pStack->trxnPool.inUse);
 
     return rc;
   }
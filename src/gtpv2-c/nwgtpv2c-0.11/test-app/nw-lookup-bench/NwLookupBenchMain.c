@@ -0,0 +1,277 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/**
+ * @file NwLookupBenchMain.c
+ * @author Dincer BEKEN
+ * @brief
+ *
+ * Lookup cost of the stack tunnel (TEID, peer) and outstanding transaction (sequence number, peer) maps, the former
+ * RB trees against the hash maps. The elements mirror the key fields and comparators of nw_gtpv2c_tunnel_t and
+ * nw_gtpv2c_trxn_t, the peers are spread over a set of IPv4 MBMS-GWs.
+ *
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "tree.h"
+#include "NwGtpv2cHash.h"
+
+#define NW_LOOKUP_BENCH_DEFAULT_ENTRIES                         (100000)
+#define NW_LOOKUP_BENCH_DEFAULT_LOOKUPS                         (10000000)
+#define NW_LOOKUP_BENCH_DEFAULT_PEERS                           (16)
+
+typedef struct NwLookupBenchTunnel {
+  uint32_t                      teid;
+  union {
+    struct sockaddr_in          ipv4_addr;
+    struct sockaddr_in6         ipv6_addr;
+  }ipAddrRemote;
+  RB_ENTRY (NwLookupBenchTunnel) tunnelMapRbtNode;
+  nw_gtpv2c_hash_node_t         tunnelMapHashNode;
+} NwLookupBenchTunnelT;
+
+typedef struct NwLookupBenchTrxn {
+  uint32_t                      seqNum;
+  union {
+    struct sockaddr_in          ipv4_addr;
+    struct sockaddr_in6         ipv6_addr;
+  }peer_ip;
+  RB_ENTRY (NwLookupBenchTrxn)  trxnMapRbtNode;
+  nw_gtpv2c_hash_node_t         trxnMapHashNode;
+} NwLookupBenchTrxnT;
+
+/*---------------------------------------------------------------------------
+   Comparators and hashes, as in NwGtpv2c.c
+  --------------------------------------------------------------------------*/
+
+static int32_t nwLookupBenchCompareTunnel (struct NwLookupBenchTunnel *a, struct NwLookupBenchTunnel *b)
+{
+  if (a->teid > b->teid)
+    return 1;
+  if (a->teid < b->teid)
+    return -1;
+  if (a->ipAddrRemote.ipv4_addr.sin_family != b->ipAddrRemote.ipv4_addr.sin_family)
+    return (a->ipAddrRemote.ipv4_addr.sin_family > b->ipAddrRemote.ipv4_addr.sin_family) ? 1 : -1;
+  if (a->ipAddrRemote.ipv4_addr.sin_addr.s_addr > b->ipAddrRemote.ipv4_addr.sin_addr.s_addr)
+    return 1;
+  if (a->ipAddrRemote.ipv4_addr.sin_addr.s_addr < b->ipAddrRemote.ipv4_addr.sin_addr.s_addr)
+    return -1;
+  return 0;
+}
+
+static int32_t nwLookupBenchCompareTrxn (struct NwLookupBenchTrxn *a, struct NwLookupBenchTrxn *b)
+{
+  if (a->seqNum > b->seqNum)
+    return 1;
+  if (a->seqNum < b->seqNum)
+    return -1;
+  if (a->peer_ip.ipv4_addr.sin_family != b->peer_ip.ipv4_addr.sin_family)
+    return (a->peer_ip.ipv4_addr.sin_family > b->peer_ip.ipv4_addr.sin_family) ? 1 : -1;
+  if (a->peer_ip.ipv4_addr.sin_addr.s_addr > b->peer_ip.ipv4_addr.sin_addr.s_addr)
+    return 1;
+  if (a->peer_ip.ipv4_addr.sin_addr.s_addr < b->peer_ip.ipv4_addr.sin_addr.s_addr)
+    return -1;
+  return 0;
+}
+
+RB_HEAD (NwLookupBenchTunnelMap, NwLookupBenchTunnel);
+RB_GENERATE (NwLookupBenchTunnelMap, NwLookupBenchTunnel, tunnelMapRbtNode, nwLookupBenchCompareTunnel)
+RB_HEAD (NwLookupBenchTrxnMap, NwLookupBenchTrxn);
+RB_GENERATE (NwLookupBenchTrxnMap, NwLookupBenchTrxn, trxnMapRbtNode, nwLookupBenchCompareTrxn)
+
+static int32_t nwLookupBenchTunnelCmp (const void *a, const void *b)
+{
+  return nwLookupBenchCompareTunnel ((struct NwLookupBenchTunnel *)a, (struct NwLookupBenchTunnel *)b);
+}
+
+static uint32_t nwLookupBenchTunnelHash (const void *elem)
+{
+  const NwLookupBenchTunnelT             *pTunnel = (const NwLookupBenchTunnelT *)elem;
+
+  return nwGtpv2cHashPeer (nwGtpv2cHashMix (0, pTunnel->teid), (const struct sockaddr *)&pTunnel->ipAddrRemote);
+}
+
+static int32_t nwLookupBenchTrxnCmp (const void *a, const void *b)
+{
+  return nwLookupBenchCompareTrxn ((struct NwLookupBenchTrxn *)a, (struct NwLookupBenchTrxn *)b);
+}
+
+static uint32_t nwLookupBenchTrxnHash (const void *elem)
+{
+  const NwLookupBenchTrxnT               *pTrxn = (const NwLookupBenchTrxnT *)elem;
+
+  return nwGtpv2cHashPeer (nwGtpv2cHashMix (0, pTrxn->seqNum), (const struct sockaddr *)&pTrxn->peer_ip);
+}
+
+/*---------------------------------------------------------------------------
+   Bench
+  --------------------------------------------------------------------------*/
+
+static uint64_t nwLookupBenchNowNs (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void nwLookupBenchPeer (struct sockaddr_in *peer, uint32_t index, uint32_t peers)
+{
+  peer->sin_family = AF_INET;
+  peer->sin_addr.s_addr = htonl (0x0A000001 + (index % peers));
+}
+
+static void nwLookupBenchReport (const char *map, const char *impl, uint64_t lookups, uint64_t found, uint64_t duration)
+{
+  printf ("  %-8s %-8s: %10lu lookups %8.1f ns/lookup %12.1f lookups/s  %10lu found\n", map, impl, lookups,
+      lookups ? (double)duration / lookups : 0.0, duration ? (double)lookups * 1e9 / duration : 0.0, found);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t                                nbEntries = NW_LOOKUP_BENCH_DEFAULT_ENTRIES;
+  uint64_t                                nbLookups = NW_LOOKUP_BENCH_DEFAULT_LOOKUPS;
+  uint32_t                                nbPeers = NW_LOOKUP_BENCH_DEFAULT_PEERS;
+  struct NwLookupBenchTunnelMap           tunnelTree = RB_INITIALIZER (&tunnelTree);
+  struct NwLookupBenchTrxnMap             trxnTree = RB_INITIALIZER (&trxnTree);
+  nw_gtpv2c_hash_t                        tunnelHash;
+  nw_gtpv2c_hash_t                        trxnHash;
+  NwLookupBenchTunnelT                   *pTunnels = NULL;
+  NwLookupBenchTrxnT                     *pTrxns = NULL;
+  uint32_t                               *pKeys = NULL;
+  uint64_t                                found = 0;
+  uint64_t                                t0 = 0;
+  int                                     opt = 0;
+
+  while ((opt = getopt (argc, argv, "n:l:p:h")) != -1) {
+    switch (opt) {
+    case 'n': nbEntries = strtoul (optarg, NULL, 10); break;
+    case 'l': nbLookups = strtoull (optarg, NULL, 10); break;
+    case 'p': nbPeers = strtoul (optarg, NULL, 10); break;
+    default:
+      fprintf (stderr, "Usage: %s [-n entries] [-l lookups] [-p peers]\n", argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (!nbEntries || !nbLookups || !nbPeers) {
+    fprintf (stderr, "Invalid number of entries, lookups or peers\n");
+    return 1;
+  }
+
+  pTunnels = calloc (nbEntries, sizeof (NwLookupBenchTunnelT));
+  pTrxns = calloc (nbEntries, sizeof (NwLookupBenchTrxnT));
+  pKeys = calloc (1 << 20, sizeof (uint32_t));
+  if (!pTunnels || !pTrxns || !pKeys
+      || NW_OK != nwGtpv2cHashInit (&tunnelHash, NW_GTPV2C_HASH_DEFAULT_SIZE, offsetof (NwLookupBenchTunnelT, tunnelMapHashNode),
+                                    nwLookupBenchTunnelHash, nwLookupBenchTunnelCmp)
+      || NW_OK != nwGtpv2cHashInit (&trxnHash, NW_GTPV2C_HASH_DEFAULT_SIZE, offsetof (NwLookupBenchTrxnT, trxnMapHashNode),
+                                    nwLookupBenchTrxnHash, nwLookupBenchTrxnCmp)) {
+    fprintf (stderr, "Out of memory\n");
+    return 1;
+  }
+
+  /** TEIDs are allocated from a counter by the MCE, sequence numbers wrap per peer. */
+  srandom (1);
+  for (uint32_t i = 0; i < nbEntries; i++) {
+    pTunnels[i].teid = 0x80000000 + i;
+    nwLookupBenchPeer (&pTunnels[i].ipAddrRemote.ipv4_addr, random (), nbPeers);
+    RB_INSERT (NwLookupBenchTunnelMap, &tunnelTree, &pTunnels[i]);
+    nwGtpv2cHashInsert (&tunnelHash, &pTunnels[i]);
+    pTrxns[i].seqNum = (i / nbPeers) & 0x00FFFFFF;
+    nwLookupBenchPeer (&pTrxns[i].peer_ip.ipv4_addr, i, nbPeers);
+    RB_INSERT (NwLookupBenchTrxnMap, &trxnTree, &pTrxns[i]);
+    nwGtpv2cHashInsert (&trxnHash, &pTrxns[i]);
+  }
+  /** Random order of the lookups, precomputed so the generator is not measured. */
+  for (uint32_t i = 0; i < (1 << 20); i++)
+    pKeys[i] = random () % nbEntries;
+
+  printf ("%u entries over %u peers, %lu lookups, %u hash buckets\n", nbEntries, nbPeers, nbLookups, tunnelHash.mask + 1);
+
+  NwLookupBenchTunnelT                    keyTunnel;
+  NwLookupBenchTrxnT                      keyTrxn;
+
+  memset (&keyTunnel, 0, sizeof (keyTunnel));
+  memset (&keyTrxn, 0, sizeof (keyTrxn));
+
+  found = 0;
+  t0 = nwLookupBenchNowNs ();
+  for (uint64_t i = 0; i < nbLookups; i++) {
+    const NwLookupBenchTunnelT             *pEntry = &pTunnels[pKeys[i & ((1 << 20) - 1)]];
+
+    keyTunnel.teid = pEntry->teid;
+    keyTunnel.ipAddrRemote = pEntry->ipAddrRemote;
+    found += (RB_FIND (NwLookupBenchTunnelMap, &tunnelTree, &keyTunnel) != NULL);
+  }
+  nwLookupBenchReport ("tunnel", "rb-tree", nbLookups, found, nwLookupBenchNowNs () - t0);
+
+  found = 0;
+  t0 = nwLookupBenchNowNs ();
+  for (uint64_t i = 0; i < nbLookups; i++) {
+    const NwLookupBenchTunnelT             *pEntry = &pTunnels[pKeys[i & ((1 << 20) - 1)]];
+
+    keyTunnel.teid = pEntry->teid;
+    keyTunnel.ipAddrRemote = pEntry->ipAddrRemote;
+    found += (nwGtpv2cHashFind (&tunnelHash, &keyTunnel) != NULL);
+  }
+  nwLookupBenchReport ("tunnel", "hash", nbLookups, found, nwLookupBenchNowNs () - t0);
+
+  found = 0;
+  t0 = nwLookupBenchNowNs ();
+  for (uint64_t i = 0; i < nbLookups; i++) {
+    const NwLookupBenchTrxnT               *pEntry = &pTrxns[pKeys[i & ((1 << 20) - 1)]];
+
+    keyTrxn.seqNum = pEntry->seqNum;
+    keyTrxn.peer_ip = pEntry->peer_ip;
+    found += (RB_FIND (NwLookupBenchTrxnMap, &trxnTree, &keyTrxn) != NULL);
+  }
+  nwLookupBenchReport ("trxn", "rb-tree", nbLookups, found, nwLookupBenchNowNs () - t0);
+
+  found = 0;
+  t0 = nwLookupBenchNowNs ();
+  for (uint64_t i = 0; i < nbLookups; i++) {
+    const NwLookupBenchTrxnT               *pEntry = &pTrxns[pKeys[i & ((1 << 20) - 1)]];
+
+    keyTrxn.seqNum = pEntry->seqNum;
+    keyTrxn.peer_ip = pEntry->peer_ip;
+    found += (nwGtpv2cHashFind (&trxnHash, &keyTrxn) != NULL);
+  }
+  nwLookupBenchReport ("trxn", "hash", nbLookups, found, nwLookupBenchNowNs () - t0);
+
+  nwGtpv2cHashDestroy (&tunnelHash);
+  nwGtpv2cHashDestroy (&trxnHash);
+  free (pKeys);
+  free (pTrxns);
+  free (pTunnels);
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*
+                        E N D     O F    F I L E
+  --------------------------------------------------------------------------*/
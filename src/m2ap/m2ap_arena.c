@@ -0,0 +1,196 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_arena.c
+  \brief Per message arena for the asn1c M2AP decoder.
+  Kept free of the logging and ITTI dependencies, since it is linked into every user of the asn1c M2AP library.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "m2ap_arena.h"
+
+#define M2AP_ARENA_FIRST_CHUNK_SIZE   (16 * 1024)
+#define M2AP_ARENA_ALIGN              16
+#define M2AP_ARENA_ALIGN_UP(x)        (((x) + (M2AP_ARENA_ALIGN - 1)) & ~((size_t)M2AP_ARENA_ALIGN - 1))
+/** Each block is prefixed with its size, needed by REALLOC. Keeps the blocks aligned. */
+#define M2AP_ARENA_BLOCK_HDR_SIZE     M2AP_ARENA_ALIGN_UP(sizeof(size_t))
+
+typedef struct m2ap_arena_chunk_s {
+  struct m2ap_arena_chunk_s  *next;
+  size_t                      size;   ///< Usable bytes after the (aligned) chunk header
+  size_t                      used;
+} m2ap_arena_chunk_t;
+
+#define M2AP_ARENA_CHUNK_HDR_SIZE     M2AP_ARENA_ALIGN_UP(sizeof(m2ap_arena_chunk_t))
+#define M2AP_ARENA_CHUNK_DATA(cHuNk)  ((uint8_t*)(cHuNk) + M2AP_ARENA_CHUNK_HDR_SIZE)
+
+typedef struct m2ap_arena_s {
+  m2ap_arena_chunk_t         *chunks;      ///< Newest (largest) chunk first
+  bool                        allocating;
+  size_t                      message_bytes;
+  m2ap_arena_stats_t          stats;
+} m2ap_arena_t;
+
+/** One arena per thread, the M2AP task only uses the arena of its own thread. */
+static __thread m2ap_arena_t m2ap_arena = {0};
+
+//------------------------------------------------------------------------------
+static bool m2ap_arena_owns (const void * const ptr)
+{
+  for (const m2ap_arena_chunk_t * chunk = m2ap_arena.chunks; chunk; chunk = chunk->next) {
+    const uint8_t * const data = M2AP_ARENA_CHUNK_DATA(chunk);
+    if (((const uint8_t*)ptr >= data) && ((const uint8_t*)ptr < (data + chunk->size)))
+      return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static void *m2ap_arena_alloc (const size_t size)
+{
+  const size_t          block_size = M2AP_ARENA_BLOCK_HDR_SIZE + M2AP_ARENA_ALIGN_UP(size);
+  m2ap_arena_chunk_t   *chunk = m2ap_arena.chunks;
+  uint8_t              *block = NULL;
+
+  if (!chunk || (chunk->used + block_size) > chunk->size) {
+    size_t chunk_size = chunk ? (2 * chunk->size) : M2AP_ARENA_FIRST_CHUNK_SIZE;
+    if (chunk_size < block_size)
+      chunk_size = block_size;
+    if (!(chunk = malloc(M2AP_ARENA_CHUNK_HDR_SIZE + chunk_size)))
+      return NULL;
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    chunk->next = m2ap_arena.chunks;
+    m2ap_arena.chunks = chunk;
+    m2ap_arena.stats.num_chunk_allocs++;
+  }
+  block = M2AP_ARENA_CHUNK_DATA(chunk) + chunk->used;
+  chunk->used += block_size;
+  *(size_t*)block = size;
+  m2ap_arena.message_bytes += block_size;
+  m2ap_arena.stats.num_allocs++;
+  m2ap_arena.stats.num_bytes += size;
+  return block + M2AP_ARENA_BLOCK_HDR_SIZE;
+}
+
+//------------------------------------------------------------------------------
+void *m2ap_asn_calloc (size_t nmemb, size_t size)
+{
+  void *ptr = NULL;
+  if (!m2ap_arena.allocating) {
+    m2ap_arena.stats.num_heap_allocs++;
+    return calloc(nmemb, size);
+  }
+  if (size && nmemb > (SIZE_MAX / size))
+    return NULL;
+  /** Chunks are not zeroed. */
+  if ((ptr = m2ap_arena_alloc(nmemb * size)))
+    memset(ptr, 0, nmemb * size);
+  return ptr;
+}
+
+//------------------------------------------------------------------------------
+void *m2ap_asn_malloc (size_t size)
+{
+  if (!m2ap_arena.allocating) {
+    m2ap_arena.stats.num_heap_allocs++;
+    return malloc(size);
+  }
+  return m2ap_arena_alloc(size);
+}
+
+//------------------------------------------------------------------------------
+void *m2ap_asn_realloc (void *ptr, size_t size)
+{
+  void   *new_ptr  = NULL;
+  size_t  old_size = 0;
+
+  if (ptr && !m2ap_arena_owns(ptr)) {
+    /** Heap block, allocated outside of a decode. */
+    m2ap_arena.stats.num_heap_allocs++;
+    return realloc(ptr, size);
+  }
+  if (ptr) {
+    old_size = *(size_t*)((uint8_t*)ptr - M2AP_ARENA_BLOCK_HDR_SIZE);
+    if (size <= old_size)
+      return ptr;
+  }
+  /** Arena blocks are never resized, the old block is released with the arena. */
+  new_ptr = m2ap_asn_malloc(size);
+  if (new_ptr && ptr)
+    memcpy(new_ptr, ptr, old_size);
+  return new_ptr;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_asn_free (void *ptr)
+{
+  if (!ptr)
+    return;
+  if (m2ap_arena.chunks && m2ap_arena_owns(ptr))
+    return; // released with the arena
+  free(ptr);
+}
+
+//------------------------------------------------------------------------------
+void m2ap_arena_decode_start (void)
+{
+  m2ap_arena.allocating = true;
+  m2ap_arena.stats.num_decodes++;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_arena_decode_stop (void)
+{
+  m2ap_arena.allocating = false;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_arena_release (void)
+{
+  m2ap_arena_chunk_t   *chunk = NULL;
+
+  m2ap_arena.allocating = false;
+  if (!m2ap_arena.chunks)
+    return;
+  if (m2ap_arena.message_bytes > m2ap_arena.stats.max_message_bytes)
+    m2ap_arena.stats.max_message_bytes = m2ap_arena.message_bytes;
+  m2ap_arena.message_bytes = 0;
+  /** Keep the largest chunk for the next message. */
+  while ((chunk = m2ap_arena.chunks->next)) {
+    m2ap_arena.chunks->next = chunk->next;
+    free(chunk);
+  }
+  m2ap_arena.chunks->used = 0;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_arena_get_stats (m2ap_arena_stats_t * const stats)
+{
+  *stats = m2ap_arena.stats;
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_arena.h
+  \brief Per message arena for the asn1c M2AP decoder.
+  The generated asn_internal.h routes CALLOC/MALLOC/REALLOC/FREEMEM through the m2ap_asn_* functions.
+  Between m2ap_arena_decode_start() and m2ap_arena_decode_stop() all asn1c allocations of the calling thread
+  are served from the thread's arena. FREEMEM on arena memory is a no-op and the whole decoded PDU is released
+  in one shot with m2ap_arena_release(). Outside of a decode, the functions fall back to the heap, so the encoder
+  and its output buffers are not affected.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#ifndef FILE_M2AP_ARENA_SEEN
+#define FILE_M2AP_ARENA_SEEN
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct m2ap_arena_stats_s {
+  uint64_t    num_decodes;        ///< Number of m2ap_arena_decode_start() calls
+  uint64_t    num_allocs;         ///< asn1c allocations served from the arena
+  uint64_t    num_bytes;          ///< Bytes served from the arena
+  uint64_t    num_heap_allocs;    ///< asn1c allocations served from the heap (outside of a decode)
+  uint64_t    num_chunk_allocs;   ///< Heap allocations done by the arena itself
+  size_t      max_message_bytes;  ///< Largest arena usage of a single message
+} m2ap_arena_stats_t;
+
+/** Allocation functions referenced by the generated asn_internal.h, do not call directly. */
+void *m2ap_asn_calloc (size_t nmemb, size_t size);
+void *m2ap_asn_malloc (size_t size);
+void *m2ap_asn_realloc (void *ptr, size_t size);
+void  m2ap_asn_free (void *ptr);
+
+/** \brief Serve the following asn1c allocations of the calling thread from its arena.
+ **/
+void m2ap_arena_decode_start (void);
+
+/** \brief Stop serving asn1c allocations from the arena. The decoded memory stays valid until m2ap_arena_release().
+ **/
+void m2ap_arena_decode_stop (void);
+
+/** \brief Release all memory decoded into the arena of the calling thread in one shot.
+ * The first chunk is kept for the next message.
+ **/
+void m2ap_arena_release (void);
+
+/** \brief Copy the arena statistics of the calling thread.
+ **/
+void m2ap_arena_get_stats (m2ap_arena_stats_t * const stats);
+
+#endif /* FILE_M2AP_ARENA_SEEN */
@@ -0,0 +1,172 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_decode_bench.c
+  \brief Compare heap and arena decoding of the asn1c M2AP decoder on a recorded message corpus.
+  Each corpus file holds one APER encoded M2AP PDU (e.g. exported M2AP packet bytes of a capture).
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "M2AP_M2AP-PDU.h"
+#include "m2ap_arena.h"
+
+#define M2AP_DECODE_BENCH_DEFAULT_ITERATIONS 10000
+
+typedef struct corpus_msg_s {
+  const char  *file_name;
+  uint8_t     *buffer;
+  size_t       length;
+} corpus_msg_t;
+
+//------------------------------------------------------------------------------
+static uint64_t bench_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int load_corpus_msg (const char * const file_name, corpus_msg_t * const msg)
+{
+  FILE  *fp = fopen(file_name, "rb");
+  long   length = 0;
+
+  memset(msg, 0, sizeof(*msg));
+  if (!fp)
+    return -1;
+  if (fseek(fp, 0, SEEK_END) || (length = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET)) {
+    fclose(fp);
+    return -1;
+  }
+  msg->file_name = file_name;
+  msg->length = (size_t)length;
+  msg->buffer = malloc(msg->length);
+  if (!msg->buffer || fread(msg->buffer, 1, msg->length, fp) != msg->length) {
+    free(msg->buffer);
+    fclose(fp);
+    return -1;
+  }
+  fclose(fp);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Decode and release the message as the M2AP task does, either on the heap (ASN_STRUCT_FREE_CONTENTS_ONLY)
+ * or in the arena (m2ap_arena_release() only, the PDU is not walked).
+ */
+static int decode_msg (const corpus_msg_t * const msg, const bool use_arena)
+{
+  M2AP_M2AP_PDU_t   pdu;
+  M2AP_M2AP_PDU_t  *pdu_p = &pdu;
+  asn_dec_rval_t    dec_ret;
+
+  memset(&pdu, 0, sizeof(pdu));
+  if (use_arena)
+    m2ap_arena_decode_start();
+  dec_ret = aper_decode(NULL, &asn_DEF_M2AP_M2AP_PDU, (void **)&pdu_p, msg->buffer, msg->length, 0, 0);
+  if (use_arena)
+    m2ap_arena_decode_stop();
+  if (use_arena)
+    m2ap_arena_release();
+  else
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, &pdu);
+  return (dec_ret.code == RC_OK) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+static void run_bench (const corpus_msg_t * const msg, const int iterations, const bool use_arena)
+{
+  m2ap_arena_stats_t  stats_before;
+  m2ap_arena_stats_t  stats_after;
+  uint64_t            t0 = 0;
+  uint64_t            duration = 0;
+
+  m2ap_arena_get_stats(&stats_before);
+  t0 = bench_now_ns();
+  for (int i = 0; i < iterations; i++) {
+    decode_msg(msg, use_arena);
+  }
+  duration = bench_now_ns() - t0;
+  m2ap_arena_get_stats(&stats_after);
+
+  /** In heap mode, all asn1c allocations hit malloc. In arena mode, only new chunks do. */
+  printf("  %-5s %8.1f ns/msg %9.0f msg/s  heap allocs/msg %7.2f  arena allocs/msg %7.2f  arena bytes/msg %8.1f\n",
+      use_arena ? "arena" : "heap",
+      (double)duration / iterations,
+      duration ? (1e9 * iterations / duration) : 0.0,
+      (double)((stats_after.num_heap_allocs - stats_before.num_heap_allocs) + (stats_after.num_chunk_allocs - stats_before.num_chunk_allocs)) / iterations,
+      (double)(stats_after.num_allocs - stats_before.num_allocs) / iterations,
+      (double)(stats_after.num_bytes - stats_before.num_bytes) / iterations);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int iterations = M2AP_DECODE_BENCH_DEFAULT_ITERATIONS;
+  int opt = 0;
+  int rc = 0;
+
+  while ((opt = getopt(argc, argv, "i:h")) != -1) {
+    switch (opt) {
+    case 'i': iterations = atoi(optarg); break;
+    default:
+      fprintf(stderr, "Usage: %s [-i iterations] corpus_file...\n", argv[0]);
+      fprintf(stderr, "  Each corpus file holds one APER encoded M2AP PDU.\n");
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (optind >= argc || iterations <= 0) {
+    fprintf(stderr, "Usage: %s [-i iterations] corpus_file...\n", argv[0]);
+    return 1;
+  }
+
+  for (int f = optind; f < argc; f++) {
+    corpus_msg_t msg;
+    if (load_corpus_msg(argv[f], &msg)) {
+      fprintf(stderr, "Could not read corpus file %s\n", argv[f]);
+      rc = 1;
+      continue;
+    }
+    if (decode_msg(&msg, false) || decode_msg(&msg, true)) {
+      fprintf(stderr, "Could not decode %s as M2AP PDU\n", msg.file_name);
+      free(msg.buffer);
+      rc = 1;
+      continue;
+    }
+    printf("%s (%zu bytes)\n", msg.file_name, msg.length);
+    run_bench(&msg, iterations, false);
+    run_bench(&msg, iterations, true);
+    free(msg.buffer);
+  }
+  return rc;
+}
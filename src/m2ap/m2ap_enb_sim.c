@@ -0,0 +1,850 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_enb_sim.c
+  \brief M2 eNB load simulator, for M2 scale tests against an MCE on the same host.
+  Opens one SCTP association per simulated eNB, performs the M2 Setup and acknowledges the MBMS Session Start,
+  Stop, Update and MBMS Scheduling Information of the MCE after a configurable delay.
+  M2 Setup latency is measured from request to response. The recovery time is measured from the start until all
+  simulated eNBs are set up, including the M2 Setups repeated after a TimeToWait. For MCE initiated procedures,
+  the fan-out latency is measured per simulated eNB from the first simulated eNB receiving the same message (same
+  MCE MBMS M2AP ID).
+  Exits with 2 if not all simulated eNBs are set up at the end or an association was lost, for scripted scale tests.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/queue.h>
+#include <sys/socket.h>
+
+#include "assertions.h"
+#include "conversions.h"
+#include "mme_default_values.h"
+#include "sctp_common.h"
+#include "sctp_primitives_client.h"
+#include "M2AP_M2AP-PDU.h"
+#include "M2AP_InitiatingMessage.h"
+#include "M2AP_SuccessfulOutcome.h"
+#include "M2AP_UnsuccessfulOutcome.h"
+#include "M2AP_ProtocolIE-Field.h"
+#include "M2AP_ProcedureCode.h"
+#include "M2AP_ProtocolIE-ID.h"
+
+#define M2AP_ENB_SIM_DEFAULT_ENBS             16
+#define M2AP_ENB_SIM_DEFAULT_ENB_ID           0x1000
+#define M2AP_ENB_SIM_DEFAULT_MCC              1
+#define M2AP_ENB_SIM_DEFAULT_MNC              1
+#define M2AP_ENB_SIM_DEFAULT_SAIS             "1"
+#define M2AP_ENB_SIM_DEFAULT_INTERVAL         5
+#define M2AP_ENB_SIM_MAX_SAIS                 32
+#define M2AP_ENB_SIM_FANOUT_SLOTS             4096
+#define M2AP_ENB_SIM_FANOUT_WINDOW_NS         1000000000ULL   ///< Same message at the other eNBs, if received within this window
+#define M2AP_ENB_SIM_CONNECTS_PER_LOOP        64
+#define M2AP_ENB_SIM_LOAD_BURST               64              ///< Load messages sent per eNB and loop at most
+
+#define NSEC_PER_MSEC                         1000000ULL
+#define NSEC_PER_SEC                          1000000000ULL
+
+typedef enum m2ap_enb_sim_procedure_e {
+  M2AP_ENB_SIM_M2_SETUP = 0,
+  M2AP_ENB_SIM_SESSION_START,
+  M2AP_ENB_SIM_SESSION_STOP,
+  M2AP_ENB_SIM_SESSION_UPDATE,
+  M2AP_ENB_SIM_SCHEDULING_INFO,
+  M2AP_ENB_SIM_OTHER,
+  M2AP_ENB_SIM_MAX_PROCEDURE
+} m2ap_enb_sim_procedure_t;
+
+static const char * const m2ap_enb_sim_procedure_str[M2AP_ENB_SIM_MAX_PROCEDURE] = {
+  "M2 Setup", "Session Start", "Session Stop", "Session Update", "Scheduling Info", "Other"
+};
+
+typedef struct m2ap_enb_sim_stats_s {
+  uint64_t    num;              ///< Received messages (responses for the M2 Setup)
+  uint64_t    num_failed;       ///< Unsuccessful outcomes / messages which could not be answered
+  uint64_t    num_interval;     ///< Received messages in the current report interval
+  uint64_t    latency_sum;
+  uint64_t    latency_min;
+  uint64_t    latency_max;
+} m2ap_enb_sim_stats_t;
+
+typedef struct m2ap_enb_sim_enb_s {
+  int                 index;
+  uint32_t            enb_id;
+  sctp_data_t         sctp_data;
+  bool                connected;
+  bool                setup_done;
+  uint64_t            setup_sent_ns;
+  uint64_t            setup_retry_ns;       ///< M2 Setup to be repeated after a TimeToWait, 0 if none
+  uint16_t            next_enb_mbms_m2ap_id;
+  int                 num_sais;
+  uint16_t            sais[M2AP_ENB_SIM_MAX_SAIS];
+  uint64_t            load_start_ns;        ///< Start of the load, once the M2 Setup is done
+  uint64_t            load_sent;
+} m2ap_enb_sim_enb_t;
+
+/** Encoded response waiting for the configured delay. The delay is constant, so the queue is ordered by due time. */
+typedef struct m2ap_enb_sim_response_s {
+  uint64_t                                due_ns;
+  m2ap_enb_sim_enb_t                     *enb;
+  sctp_stream_id_t                        stream;
+  void                                   *buffer;
+  ssize_t                                 length;
+  TAILQ_ENTRY(m2ap_enb_sim_response_s)    entry;
+} m2ap_enb_sim_response_t;
+
+typedef struct m2ap_enb_sim_fanout_slot_s {
+  m2ap_enb_sim_procedure_t  procedure;
+  uint32_t                  mce_mbms_m2ap_id;
+  uint64_t                  first_ns;
+} m2ap_enb_sim_fanout_slot_t;
+
+typedef struct m2ap_enb_sim_config_s {
+  char               *mce_address;
+  char               *local_address;
+  uint16_t            port;
+  int                 num_enbs;
+  uint32_t            enb_id;
+  uint16_t            mcc;
+  uint16_t            mnc;
+  int                 mnc_len;
+  int                 mbsfn_synch_area_id;
+  int                 num_sais;
+  uint16_t            sais[M2AP_ENB_SIM_MAX_SAIS];
+  int                 sais_per_enb;         ///< 0: each eNB announces all SAIs, else a round-robin share
+  uint64_t            response_delay_ns;
+  double              setup_rate;           ///< M2 Setups per second, 0 for as fast as possible
+  int                 duration;             ///< Seconds, 0 until SIGINT
+  int                 interval;             ///< Report interval in seconds
+  double              load_rate;            ///< Error Indications per second and set up eNB, 0 for no load
+} m2ap_enb_sim_config_t;
+
+/** Receive load on the MCE, the same encoded message is sent by all eNBs. */
+typedef struct m2ap_enb_sim_load_s {
+  void               *buffer;
+  ssize_t             length;
+  uint64_t            num_sent;
+  uint64_t            num_failed;
+  uint64_t            num_interval;
+} m2ap_enb_sim_load_t;
+
+static m2ap_enb_sim_config_t            m2ap_enb_sim_config;
+static m2ap_enb_sim_enb_t              *m2ap_enb_sim_enbs = NULL;
+static m2ap_enb_sim_stats_t             m2ap_enb_sim_stats[M2AP_ENB_SIM_MAX_PROCEDURE];
+static m2ap_enb_sim_fanout_slot_t       m2ap_enb_sim_fanout[M2AP_ENB_SIM_FANOUT_SLOTS];
+static TAILQ_HEAD(m2ap_enb_sim_response_head_s, m2ap_enb_sim_response_s) m2ap_enb_sim_responses =
+    TAILQ_HEAD_INITIALIZER(m2ap_enb_sim_responses);
+static volatile sig_atomic_t            m2ap_enb_sim_terminate = 0;
+static uint64_t                         m2ap_enb_sim_start_ns = 0;
+static int                              m2ap_enb_sim_num_setup = 0;
+static int                              m2ap_enb_sim_num_lost = 0;
+static uint64_t                         m2ap_enb_sim_recovery_ns = 0;   ///< Until all eNBs were set up, 0 if not yet
+static m2ap_enb_sim_load_t              m2ap_enb_sim_load;
+
+//------------------------------------------------------------------------------
+static uint64_t m2ap_enb_sim_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_signal_handler (__attribute__((unused)) int sig)
+{
+  m2ap_enb_sim_terminate = 1;
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_record (const m2ap_enb_sim_procedure_t procedure, const bool success, const uint64_t latency_ns)
+{
+  m2ap_enb_sim_stats_t * const stats = &m2ap_enb_sim_stats[procedure];
+
+  if (!success) {
+    stats->num_failed++;
+    return;
+  }
+  if (!stats->num || latency_ns < stats->latency_min)
+    stats->latency_min = latency_ns;
+  if (latency_ns > stats->latency_max)
+    stats->latency_max = latency_ns;
+  stats->latency_sum += latency_ns;
+  stats->num++;
+  stats->num_interval++;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Latency of an MCE initiated message at this eNB, against the first simulated eNB which received the same message.
+ */
+static uint64_t m2ap_enb_sim_fanout_latency (const m2ap_enb_sim_procedure_t procedure, const uint32_t mce_mbms_m2ap_id, const uint64_t now_ns)
+{
+  m2ap_enb_sim_fanout_slot_t * const slot = &m2ap_enb_sim_fanout[((mce_mbms_m2ap_id * M2AP_ENB_SIM_MAX_PROCEDURE) + procedure) % M2AP_ENB_SIM_FANOUT_SLOTS];
+
+  if (slot->procedure != procedure || slot->mce_mbms_m2ap_id != mce_mbms_m2ap_id
+      || !slot->first_ns || now_ns - slot->first_ns > M2AP_ENB_SIM_FANOUT_WINDOW_NS) {
+    slot->procedure = procedure;
+    slot->mce_mbms_m2ap_id = mce_mbms_m2ap_id;
+    slot->first_ns = now_ns;
+  }
+  return now_ns - slot->first_ns;
+}
+
+//------------------------------------------------------------------------------
+static int m2ap_enb_sim_send_pdu (m2ap_enb_sim_enb_t * const enb, const sctp_stream_id_t stream, M2AP_M2AP_PDU_t * const pdu)
+{
+  void      *buffer = NULL;
+  ssize_t    length = aper_encode_to_new_buffer(&asn_DEF_M2AP_M2AP_PDU, NULL, pdu, &buffer);
+  const bool response = (pdu->present == M2AP_M2AP_PDU_PR_successfulOutcome);
+  int        rc = -1;
+
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, pdu);
+  if (length <= 0) {
+    fprintf(stderr, "eNB %d: could not encode M2AP PDU\n", enb->index);
+    return -1;
+  }
+  if (m2ap_enb_sim_config.response_delay_ns && response) {
+    m2ap_enb_sim_response_t * const delayed = calloc(1, sizeof(m2ap_enb_sim_response_t));
+    delayed->due_ns = m2ap_enb_sim_now_ns() + m2ap_enb_sim_config.response_delay_ns;
+    delayed->enb = enb;
+    delayed->stream = stream;
+    delayed->buffer = buffer;
+    delayed->length = length;
+    TAILQ_INSERT_TAIL(&m2ap_enb_sim_responses, delayed, entry);
+    return 0;
+  }
+  rc = sctp_send_msg(&enb->sctp_data, M2AP_SCTP_PPID, stream, buffer, length);
+  free(buffer);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_send_responses (const uint64_t now_ns)
+{
+  m2ap_enb_sim_response_t *response = NULL;
+
+  while ((response = TAILQ_FIRST(&m2ap_enb_sim_responses)) && response->due_ns <= now_ns) {
+    TAILQ_REMOVE(&m2ap_enb_sim_responses, response, entry);
+    if (response->enb->connected)
+      sctp_send_msg(&response->enb->sctp_data, M2AP_SCTP_PPID, response->stream, response->buffer, response->length);
+    free(response->buffer);
+    free(response);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int m2ap_enb_sim_send_m2_setup_request (m2ap_enb_sim_enb_t * const enb)
+{
+  M2AP_M2AP_PDU_t                                 pdu;
+  M2AP_M2SetupRequest_t                          *out = NULL;
+  M2AP_M2SetupRequest_IEs_t                      *ie = NULL;
+  M2AP_ENB_MBMS_Configuration_data_ItemIEs_t     *item_ies = NULL;
+  M2AP_ENB_MBMS_Configuration_data_Item_t        *item = NULL;
+  char                                            enb_name[32];
+
+  memset(&pdu, 0, sizeof(pdu));
+  pdu.present = M2AP_M2AP_PDU_PR_initiatingMessage;
+  pdu.choice.initiatingMessage.procedureCode = M2AP_ProcedureCode_id_m2Setup;
+  pdu.choice.initiatingMessage.criticality = M2AP_Criticality_reject;
+  pdu.choice.initiatingMessage.value.present = M2AP_InitiatingMessage__value_PR_M2SetupRequest;
+  out = &pdu.choice.initiatingMessage.value.choice.M2SetupRequest;
+
+  /* mandatory */
+  ie = calloc(1, sizeof(M2AP_M2SetupRequest_IEs_t));
+  ie->id = M2AP_ProtocolIE_ID_id_GlobalENB_ID;
+  ie->criticality = M2AP_Criticality_reject;
+  ie->value.present = M2AP_M2SetupRequest_IEs__value_PR_GlobalENB_ID;
+  MCC_MNC_TO_PLMNID(m2ap_enb_sim_config.mcc, m2ap_enb_sim_config.mnc, m2ap_enb_sim_config.mnc_len, &ie->value.choice.GlobalENB_ID.pLMN_Identity);
+  ie->value.choice.GlobalENB_ID.eNB_ID.present = M2AP_ENB_ID_PR_macro_eNB_ID;
+  MACRO_ENB_ID_TO_BIT_STRING(enb->enb_id, &ie->value.choice.GlobalENB_ID.eNB_ID.choice.macro_eNB_ID);
+  ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+
+  /* optional */
+  snprintf(enb_name, sizeof(enb_name), "m2ap_enb_sim_%d", enb->index);
+  ie = calloc(1, sizeof(M2AP_M2SetupRequest_IEs_t));
+  ie->id = M2AP_ProtocolIE_ID_id_ENBname;
+  ie->criticality = M2AP_Criticality_ignore;
+  ie->value.present = M2AP_M2SetupRequest_IEs__value_PR_ENBname;
+  OCTET_STRING_fromBuf(&ie->value.choice.ENBname, enb_name, strlen(enb_name));
+  ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+
+  /* mandatory: a single cell, as supported by the MCE. */
+  ie = calloc(1, sizeof(M2AP_M2SetupRequest_IEs_t));
+  ie->id = M2AP_ProtocolIE_ID_id_ENB_MBMS_Configuration_data_List;
+  ie->criticality = M2AP_Criticality_reject;
+  ie->value.present = M2AP_M2SetupRequest_IEs__value_PR_ENB_MBMS_Configuration_data_List;
+  item_ies = calloc(1, sizeof(M2AP_ENB_MBMS_Configuration_data_ItemIEs_t));
+  item_ies->id = M2AP_ProtocolIE_ID_id_ENB_MBMS_Configuration_data_Item;
+  item_ies->criticality = M2AP_Criticality_reject;
+  item_ies->value.present = M2AP_ENB_MBMS_Configuration_data_ItemIEs__value_PR_ENB_MBMS_Configuration_data_Item;
+  item = &item_ies->value.choice.ENB_MBMS_Configuration_data_Item;
+  MCC_MNC_TO_PLMNID(m2ap_enb_sim_config.mcc, m2ap_enb_sim_config.mnc, m2ap_enb_sim_config.mnc_len, &item->eCGI.pLMN_Identity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY(enb->enb_id, 0, &item->eCGI.eUTRANcellIdentifier);
+  item->mbsfnSynchronisationArea = m2ap_enb_sim_config.mbsfn_synch_area_id;
+  for (int i = 0; i < enb->num_sais; i++) {
+    M2AP_MBMS_Service_Area_t * sai = calloc(1, sizeof(M2AP_MBMS_Service_Area_t));
+    INT16_TO_OCTET_STRING(enb->sais[i], sai);
+    ASN_SEQUENCE_ADD(&item->mbmsServiceAreaList.list, sai);
+  }
+  ASN_SEQUENCE_ADD(&ie->value.choice.ENB_MBMS_Configuration_data_List.list, item_ies);
+  ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+
+  enb->setup_sent_ns = m2ap_enb_sim_now_ns();
+  enb->setup_retry_ns = 0;
+  return m2ap_enb_sim_send_pdu(enb, 0, &pdu);
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_connect (m2ap_enb_sim_enb_t * const enb)
+{
+  char * local_addresses[1] = {m2ap_enb_sim_config.local_address};
+
+  memset(&enb->sctp_data, 0, sizeof(enb->sctp_data));
+  if (sctp_connect_to_remote_host(local_addresses, 1, m2ap_enb_sim_config.mce_address, m2ap_enb_sim_config.port,
+      SOCK_STREAM, &enb->sctp_data) < 0) {
+    fprintf(stderr, "eNB %d: could not connect to %s:%u\n", enb->index, m2ap_enb_sim_config.mce_address, m2ap_enb_sim_config.port);
+    m2ap_enb_sim_record(M2AP_ENB_SIM_M2_SETUP, false, 0);
+    return;
+  }
+  enb->connected = true;
+  m2ap_enb_sim_send_m2_setup_request(enb);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Acknowledge an MBMS Session Start/Stop/Update, echoing the MCE MBMS M2AP ID.
+ * The eNB MBMS M2AP ID is allocated on Session Start and echoed otherwise.
+ */
+static int m2ap_enb_sim_handle_session (m2ap_enb_sim_enb_t * const enb, const sctp_stream_id_t stream,
+    const M2AP_ProcedureCode_t procedure_code, const M2AP_InitiatingMessage_t * const msg)
+{
+  M2AP_M2AP_PDU_t                 pdu;
+  uint32_t                        mce_mbms_m2ap_id = 0;
+  uint32_t                        enb_mbms_m2ap_id = 0;
+  bool                            mce_id_present = false;
+  m2ap_enb_sim_procedure_t        procedure;
+
+  if (procedure_code == M2AP_ProcedureCode_id_sessionStart) {
+    const M2AP_SessionStartRequest_t * const req = &msg->value.choice.SessionStartRequest;
+    for (int i = 0; i < req->protocolIEs.list.count; i++) {
+      if (req->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID) {
+        mce_mbms_m2ap_id = req->protocolIEs.list.array[i]->value.choice.MCE_MBMS_M2AP_ID;
+        mce_id_present = true;
+      }
+    }
+    enb_mbms_m2ap_id = enb->next_enb_mbms_m2ap_id++;
+    procedure = M2AP_ENB_SIM_SESSION_START;
+  } else if (procedure_code == M2AP_ProcedureCode_id_sessionStop) {
+    const M2AP_SessionStopRequest_t * const req = &msg->value.choice.SessionStopRequest;
+    for (int i = 0; i < req->protocolIEs.list.count; i++) {
+      if (req->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID) {
+        mce_mbms_m2ap_id = req->protocolIEs.list.array[i]->value.choice.MCE_MBMS_M2AP_ID;
+        mce_id_present = true;
+      } else if (req->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID) {
+        enb_mbms_m2ap_id = req->protocolIEs.list.array[i]->value.choice.ENB_MBMS_M2AP_ID;
+      }
+    }
+    procedure = M2AP_ENB_SIM_SESSION_STOP;
+  } else {
+    const M2AP_SessionUpdateRequest_t * const req = &msg->value.choice.SessionUpdateRequest;
+    for (int i = 0; i < req->protocolIEs.list.count; i++) {
+      if (req->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID) {
+        mce_mbms_m2ap_id = req->protocolIEs.list.array[i]->value.choice.MCE_MBMS_M2AP_ID;
+        mce_id_present = true;
+      } else if (req->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID) {
+        enb_mbms_m2ap_id = req->protocolIEs.list.array[i]->value.choice.ENB_MBMS_M2AP_ID;
+      }
+    }
+    procedure = M2AP_ENB_SIM_SESSION_UPDATE;
+  }
+  if (!mce_id_present) {
+    m2ap_enb_sim_record(procedure, false, 0);
+    return -1;
+  }
+  m2ap_enb_sim_record(procedure, true, m2ap_enb_sim_fanout_latency(procedure, mce_mbms_m2ap_id, m2ap_enb_sim_now_ns()));
+
+  memset(&pdu, 0, sizeof(pdu));
+  pdu.present = M2AP_M2AP_PDU_PR_successfulOutcome;
+  pdu.choice.successfulOutcome.procedureCode = procedure_code;
+  pdu.choice.successfulOutcome.criticality = M2AP_Criticality_reject;
+  if (procedure == M2AP_ENB_SIM_SESSION_START) {
+    M2AP_SessionStartResponse_Ies_t * ie = NULL;
+    pdu.choice.successfulOutcome.value.present = M2AP_SuccessfulOutcome__value_PR_SessionStartResponse;
+    ie = calloc(1, sizeof(M2AP_SessionStartResponse_Ies_t));
+    ie->id = M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID;
+    ie->criticality = M2AP_Criticality_ignore;
+    ie->value.present = M2AP_SessionStartResponse_Ies__value_PR_MCE_MBMS_M2AP_ID;
+    ie->value.choice.MCE_MBMS_M2AP_ID = mce_mbms_m2ap_id;
+    ASN_SEQUENCE_ADD(&pdu.choice.successfulOutcome.value.choice.SessionStartResponse.protocolIEs.list, ie);
+    ie = calloc(1, sizeof(M2AP_SessionStartResponse_Ies_t));
+    ie->id = M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID;
+    ie->criticality = M2AP_Criticality_ignore;
+    ie->value.present = M2AP_SessionStartResponse_Ies__value_PR_ENB_MBMS_M2AP_ID;
+    ie->value.choice.ENB_MBMS_M2AP_ID = enb_mbms_m2ap_id;
+    ASN_SEQUENCE_ADD(&pdu.choice.successfulOutcome.value.choice.SessionStartResponse.protocolIEs.list, ie);
+  } else if (procedure == M2AP_ENB_SIM_SESSION_STOP) {
+    M2AP_SessionStopResponse_Ies_t * ie = NULL;
+    pdu.choice.successfulOutcome.value.present = M2AP_SuccessfulOutcome__value_PR_SessionStopResponse;
+    ie = calloc(1, sizeof(M2AP_SessionStopResponse_Ies_t));
+    ie->id = M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID;
+    ie->criticality = M2AP_Criticality_ignore;
+    ie->value.present = M2AP_SessionStopResponse_Ies__value_PR_MCE_MBMS_M2AP_ID;
+    ie->value.choice.MCE_MBMS_M2AP_ID = mce_mbms_m2ap_id;
+    ASN_SEQUENCE_ADD(&pdu.choice.successfulOutcome.value.choice.SessionStopResponse.protocolIEs.list, ie);
+    ie = calloc(1, sizeof(M2AP_SessionStopResponse_Ies_t));
+    ie->id = M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID;
+    ie->criticality = M2AP_Criticality_ignore;
+    ie->value.present = M2AP_SessionStopResponse_Ies__value_PR_ENB_MBMS_M2AP_ID;
+    ie->value.choice.ENB_MBMS_M2AP_ID = enb_mbms_m2ap_id;
+    ASN_SEQUENCE_ADD(&pdu.choice.successfulOutcome.value.choice.SessionStopResponse.protocolIEs.list, ie);
+  } else {
+    M2AP_SessionUpdateResponse_Ies_t * ie = NULL;
+    pdu.choice.successfulOutcome.value.present = M2AP_SuccessfulOutcome__value_PR_SessionUpdateResponse;
+    ie = calloc(1, sizeof(M2AP_SessionUpdateResponse_Ies_t));
+    ie->id = M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID;
+    ie->criticality = M2AP_Criticality_ignore;
+    ie->value.present = M2AP_SessionUpdateResponse_Ies__value_PR_MCE_MBMS_M2AP_ID;
+    ie->value.choice.MCE_MBMS_M2AP_ID = mce_mbms_m2ap_id;
+    ASN_SEQUENCE_ADD(&pdu.choice.successfulOutcome.value.choice.SessionUpdateResponse.protocolIEs.list, ie);
+    ie = calloc(1, sizeof(M2AP_SessionUpdateResponse_Ies_t));
+    ie->id = M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID;
+    ie->criticality = M2AP_Criticality_ignore;
+    ie->value.present = M2AP_SessionUpdateResponse_Ies__value_PR_ENB_MBMS_M2AP_ID;
+    ie->value.choice.ENB_MBMS_M2AP_ID = enb_mbms_m2ap_id;
+    ASN_SEQUENCE_ADD(&pdu.choice.successfulOutcome.value.choice.SessionUpdateResponse.protocolIEs.list, ie);
+  }
+  return m2ap_enb_sim_send_pdu(enb, stream, &pdu);
+}
+
+//------------------------------------------------------------------------------
+static int m2ap_enb_sim_handle_scheduling_information (m2ap_enb_sim_enb_t * const enb, const sctp_stream_id_t stream)
+{
+  M2AP_M2AP_PDU_t                 pdu;
+
+  /** The MBMS Scheduling Information carries no ID, all eNBs of one MCCH update share a fan-out slot. */
+  m2ap_enb_sim_record(M2AP_ENB_SIM_SCHEDULING_INFO, true, m2ap_enb_sim_fanout_latency(M2AP_ENB_SIM_SCHEDULING_INFO, 0, m2ap_enb_sim_now_ns()));
+  memset(&pdu, 0, sizeof(pdu));
+  pdu.present = M2AP_M2AP_PDU_PR_successfulOutcome;
+  pdu.choice.successfulOutcome.procedureCode = M2AP_ProcedureCode_id_mbmsSchedulingInformation;
+  pdu.choice.successfulOutcome.criticality = M2AP_Criticality_reject;
+  pdu.choice.successfulOutcome.value.present = M2AP_SuccessfulOutcome__value_PR_MbmsSchedulingInformationResponse;
+  return m2ap_enb_sim_send_pdu(enb, stream, &pdu);
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_handle_m2_setup_failure (m2ap_enb_sim_enb_t * const enb, const M2AP_M2SetupFailure_t * const failure)
+{
+  /** TS 36.443: the eNB shall wait at least for the TimeToWait before repeating the M2 Setup. */
+  static const uint64_t time_to_wait_s[] = {1, 2, 5, 10, 20, 60};
+
+  m2ap_enb_sim_record(M2AP_ENB_SIM_M2_SETUP, false, 0);
+  for (int i = 0; i < failure->protocolIEs.list.count; i++) {
+    const M2AP_M2SetupFailure_IEs_t * const ie = failure->protocolIEs.list.array[i];
+    if (ie->id == M2AP_ProtocolIE_ID_id_TimeToWait && ie->value.choice.TimeToWait >= 0
+        && ie->value.choice.TimeToWait < (long)(sizeof(time_to_wait_s) / sizeof(time_to_wait_s[0]))) {
+      enb->setup_retry_ns = m2ap_enb_sim_now_ns() + time_to_wait_s[ie->value.choice.TimeToWait] * NSEC_PER_SEC;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_handle_message (m2ap_enb_sim_enb_t * const enb, const sctp_queue_item_t * const item)
+{
+  M2AP_M2AP_PDU_t     pdu;
+  M2AP_M2AP_PDU_t    *pdu_p = &pdu;
+  asn_dec_rval_t      dec_ret;
+
+  memset(&pdu, 0, sizeof(pdu));
+  dec_ret = aper_decode(NULL, &asn_DEF_M2AP_M2AP_PDU, (void **)&pdu_p, item->buffer, item->length, 0, 0);
+  if (dec_ret.code != RC_OK) {
+    fprintf(stderr, "eNB %d: could not decode M2AP PDU of %u bytes\n", enb->index, item->length);
+    m2ap_enb_sim_record(M2AP_ENB_SIM_OTHER, false, 0);
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, &pdu);
+    return;
+  }
+
+  switch (pdu.present) {
+  case M2AP_M2AP_PDU_PR_initiatingMessage:
+    switch (pdu.choice.initiatingMessage.procedureCode) {
+    case M2AP_ProcedureCode_id_sessionStart:
+    case M2AP_ProcedureCode_id_sessionStop:
+    case M2AP_ProcedureCode_id_sessionUpdate:
+      m2ap_enb_sim_handle_session(enb, item->local_stream, pdu.choice.initiatingMessage.procedureCode, &pdu.choice.initiatingMessage);
+      break;
+    case M2AP_ProcedureCode_id_mbmsSchedulingInformation:
+      m2ap_enb_sim_handle_scheduling_information(enb, item->local_stream);
+      break;
+    default:
+      m2ap_enb_sim_record(M2AP_ENB_SIM_OTHER, true, 0);
+      break;
+    }
+    break;
+
+  case M2AP_M2AP_PDU_PR_successfulOutcome:
+    if (pdu.choice.successfulOutcome.procedureCode == M2AP_ProcedureCode_id_m2Setup && !enb->setup_done) {
+      enb->setup_done = true;
+      enb->load_start_ns = m2ap_enb_sim_now_ns();
+      enb->load_sent = 0;
+      m2ap_enb_sim_record(M2AP_ENB_SIM_M2_SETUP, true, m2ap_enb_sim_now_ns() - enb->setup_sent_ns);
+      if (++m2ap_enb_sim_num_setup == m2ap_enb_sim_config.num_enbs && !m2ap_enb_sim_recovery_ns)
+        m2ap_enb_sim_recovery_ns = m2ap_enb_sim_now_ns() - m2ap_enb_sim_start_ns;
+    } else {
+      m2ap_enb_sim_record(M2AP_ENB_SIM_OTHER, true, 0);
+    }
+    break;
+
+  case M2AP_M2AP_PDU_PR_unsuccessfulOutcome:
+    if (pdu.choice.unsuccessfulOutcome.procedureCode == M2AP_ProcedureCode_id_m2Setup) {
+      m2ap_enb_sim_handle_m2_setup_failure(enb, &pdu.choice.unsuccessfulOutcome.value.choice.M2SetupFailure);
+    } else {
+      m2ap_enb_sim_record(M2AP_ENB_SIM_OTHER, false, 0);
+    }
+    break;
+
+  default:
+    m2ap_enb_sim_record(M2AP_ENB_SIM_OTHER, false, 0);
+    break;
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, &pdu);
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_receive (m2ap_enb_sim_enb_t * const enb)
+{
+  sctp_queue_item_t *item = NULL;
+
+  if (sctp_run(&enb->sctp_data) < 0) {
+    fprintf(stderr, "eNB %d: association lost\n", enb->index);
+    m2ap_enb_sim_num_lost++;
+    close(enb->sctp_data.sd);
+    enb->connected = false;
+    if (enb->setup_done)
+      m2ap_enb_sim_num_setup--;
+    enb->setup_done = false;
+  }
+  while ((item = TAILQ_FIRST(&enb->sctp_data.sctp_queue))) {
+    TAILQ_REMOVE(&enb->sctp_data.sctp_queue, item, entry);
+    enb->sctp_data.queue_length--;
+    enb->sctp_data.queue_size -= item->length;
+    if (item->ppid == M2AP_SCTP_PPID)
+      m2ap_enb_sim_handle_message(enb, item);
+    free(item->buffer);
+    free(item);
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Error Indication without MBMS M2AP IDs. The MCE decodes and drops it, without a response, such that
+ * the load exercises the MCE receive path (SCTP receivers, ITTI, M2AP decoding) only.
+ */
+static int m2ap_enb_sim_encode_load_pdu (void)
+{
+  M2AP_M2AP_PDU_t                 pdu;
+  M2AP_ErrorIndication_Ies_t     *ie = NULL;
+
+  memset(&pdu, 0, sizeof(pdu));
+  pdu.present = M2AP_M2AP_PDU_PR_initiatingMessage;
+  pdu.choice.initiatingMessage.procedureCode = M2AP_ProcedureCode_id_errorIndication;
+  pdu.choice.initiatingMessage.criticality = M2AP_Criticality_ignore;
+  pdu.choice.initiatingMessage.value.present = M2AP_InitiatingMessage__value_PR_ErrorIndication;
+  ie = calloc(1, sizeof(M2AP_ErrorIndication_Ies_t));
+  ie->id = M2AP_ProtocolIE_ID_id_Cause;
+  ie->criticality = M2AP_Criticality_ignore;
+  ie->value.present = M2AP_ErrorIndication_Ies__value_PR_Cause;
+  ie->value.choice.Cause.present = M2AP_Cause_PR_misc;
+  ie->value.choice.Cause.choice.misc = M2AP_CauseMisc_unspecified;
+  ASN_SEQUENCE_ADD(&pdu.choice.initiatingMessage.value.choice.ErrorIndication.protocolIEs.list, ie);
+  m2ap_enb_sim_load.length = aper_encode_to_new_buffer(&asn_DEF_M2AP_M2AP_PDU, NULL, &pdu, &m2ap_enb_sim_load.buffer);
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, &pdu);
+  return (m2ap_enb_sim_load.length > 0) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Keep each set up eNB at the configured load rate, catching up at most a burst per loop.
+ */
+static void m2ap_enb_sim_send_load (const uint64_t now_ns)
+{
+  for (int i = 0; i < m2ap_enb_sim_config.num_enbs; i++) {
+    m2ap_enb_sim_enb_t * const enb = &m2ap_enb_sim_enbs[i];
+    uint64_t due = 0;
+
+    if (!enb->connected || !enb->setup_done)
+      continue;
+    due = (uint64_t)((double)(now_ns - enb->load_start_ns) * m2ap_enb_sim_config.load_rate / NSEC_PER_SEC);
+    for (int n = 0; n < M2AP_ENB_SIM_LOAD_BURST && enb->load_sent < due; n++) {
+      enb->load_sent++;
+      /** Non-signalling stream, as for all non UE-associated signalling. */
+      if (sctp_send_msg(&enb->sctp_data, M2AP_SCTP_PPID, 0, m2ap_enb_sim_load.buffer, m2ap_enb_sim_load.length) < 0) {
+        m2ap_enb_sim_load.num_failed++;
+        break;
+      }
+      m2ap_enb_sim_load.num_sent++;
+      m2ap_enb_sim_load.num_interval++;
+    }
+    /** Behind by more than a burst (e.g. the socket blocked), do not try to catch up on the backlog. */
+    if (enb->load_sent < due)
+      enb->load_sent = due;
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Print the counters. The message rate is the one of the report interval, or of the whole run for the total.
+ */
+static void m2ap_enb_sim_report (const bool total, const double seconds)
+{
+  printf("%s: %d of %d eNBs set up", total ? "total" : "interval", m2ap_enb_sim_num_setup, m2ap_enb_sim_config.num_enbs);
+  if (m2ap_enb_sim_recovery_ns)
+    printf(", all set up after %.3f s", (double)m2ap_enb_sim_recovery_ns / NSEC_PER_SEC);
+  if (m2ap_enb_sim_num_lost)
+    printf(", %d associations lost", m2ap_enb_sim_num_lost);
+  printf("\n");
+  for (int p = 0; p < M2AP_ENB_SIM_MAX_PROCEDURE; p++) {
+    m2ap_enb_sim_stats_t * const stats = &m2ap_enb_sim_stats[p];
+    if (!stats->num && !stats->num_failed)
+      continue;
+    printf("  %-16s %8lu ok %6lu failed %10.1f msg/s  latency avg %9.1f us  min %9.1f us  max %9.1f us\n",
+        m2ap_enb_sim_procedure_str[p], stats->num, stats->num_failed,
+        seconds > 0 ? (total ? stats->num : stats->num_interval) / seconds : 0.0,
+        stats->num ? (double)stats->latency_sum / stats->num / 1000.0 : 0.0,
+        (double)stats->latency_min / 1000.0, (double)stats->latency_max / 1000.0);
+    stats->num_interval = 0;
+  }
+  if (m2ap_enb_sim_config.load_rate > 0) {
+    printf("  %-16s %8lu sent %4lu failed %10.1f msg/s\n", "Load (Error Ind)",
+        m2ap_enb_sim_load.num_sent, m2ap_enb_sim_load.num_failed,
+        seconds > 0 ? (total ? m2ap_enb_sim_load.num_sent : m2ap_enb_sim_load.num_interval) / seconds : 0.0);
+    m2ap_enb_sim_load.num_interval = 0;
+  }
+  fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+static int m2ap_enb_sim_parse_sais (const char * const sais)
+{
+  m2ap_enb_sim_config.num_sais = 0;
+  for (const char *s = sais; s && *s; s = strchr(s, ',') ? strchr(s, ',') + 1 : NULL) {
+    if (m2ap_enb_sim_config.num_sais == M2AP_ENB_SIM_MAX_SAIS)
+      return -1;
+    m2ap_enb_sim_config.sais[m2ap_enb_sim_config.num_sais++] = (uint16_t)atoi(s);
+  }
+  return m2ap_enb_sim_config.num_sais ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_enb_sim_usage (const char * const name)
+{
+  fprintf(stderr, "Usage: %s [options]\n", name);
+  fprintf(stderr, "  -a address   MCE M2 address (default 127.0.0.1)\n");
+  fprintf(stderr, "  -l address   local address of the eNBs (default 127.0.0.1)\n");
+  fprintf(stderr, "  -p port      MCE M2 port (default %d)\n", M2AP_PORT_NUMBER);
+  fprintf(stderr, "  -n enbs      number of simulated eNBs (default %d)\n", M2AP_ENB_SIM_DEFAULT_ENBS);
+  fprintf(stderr, "  -e enb_id    macro eNB ID of the first eNB (default 0x%x)\n", M2AP_ENB_SIM_DEFAULT_ENB_ID);
+  fprintf(stderr, "  -m mcc.mnc   PLMN (default %03d.%02d, a 3 digit MNC is given with leading zeros)\n", M2AP_ENB_SIM_DEFAULT_MCC, M2AP_ENB_SIM_DEFAULT_MNC);
+  fprintf(stderr, "  -y area      MBSFN synchronisation area ID (default 0)\n");
+  fprintf(stderr, "  -s sai,...   MBMS service area IDs (default %s)\n", M2AP_ENB_SIM_DEFAULT_SAIS);
+  fprintf(stderr, "  -k count     MBMS service areas per eNB, assigned round-robin (default all)\n");
+  fprintf(stderr, "  -d msec      delay of the responses to the MCE (default 0)\n");
+  fprintf(stderr, "  -r rate      M2 Setups per second (default as fast as possible)\n");
+  fprintf(stderr, "  -t seconds   duration (default until interrupted)\n");
+  fprintf(stderr, "  -i seconds   report interval (default %d)\n", M2AP_ENB_SIM_DEFAULT_INTERVAL);
+  fprintf(stderr, "  -g rate      Error Indications per second sent by each set up eNB, to load the MCE receive path (default 0)\n");
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  struct pollfd      *fds = NULL;
+  int                 opt = 0;
+  int                 next_enb = 0;
+  const char         *sais = M2AP_ENB_SIM_DEFAULT_SAIS;
+  uint64_t            start_ns = 0;
+  uint64_t            report_ns = 0;
+  uint64_t            now_ns = 0;
+
+  m2ap_enb_sim_config.mce_address = "127.0.0.1";
+  m2ap_enb_sim_config.local_address = "127.0.0.1";
+  m2ap_enb_sim_config.port = M2AP_PORT_NUMBER;
+  m2ap_enb_sim_config.num_enbs = M2AP_ENB_SIM_DEFAULT_ENBS;
+  m2ap_enb_sim_config.enb_id = M2AP_ENB_SIM_DEFAULT_ENB_ID;
+  m2ap_enb_sim_config.mcc = M2AP_ENB_SIM_DEFAULT_MCC;
+  m2ap_enb_sim_config.mnc = M2AP_ENB_SIM_DEFAULT_MNC;
+  m2ap_enb_sim_config.mnc_len = 2;
+  m2ap_enb_sim_config.interval = M2AP_ENB_SIM_DEFAULT_INTERVAL;
+
+  while ((opt = getopt(argc, argv, "a:l:p:n:e:m:y:s:k:d:r:t:i:g:h")) != -1) {
+    switch (opt) {
+    case 'a': m2ap_enb_sim_config.mce_address = optarg; break;
+    case 'l': m2ap_enb_sim_config.local_address = optarg; break;
+    case 'p': m2ap_enb_sim_config.port = (uint16_t)atoi(optarg); break;
+    case 'n': m2ap_enb_sim_config.num_enbs = atoi(optarg); break;
+    case 'e': m2ap_enb_sim_config.enb_id = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'm': {
+      const char * const mnc = strchr(optarg, '.');
+      if (!mnc) {
+        m2ap_enb_sim_usage(argv[0]);
+        return 1;
+      }
+      m2ap_enb_sim_config.mcc = (uint16_t)atoi(optarg);
+      m2ap_enb_sim_config.mnc = (uint16_t)atoi(mnc + 1);
+      m2ap_enb_sim_config.mnc_len = (strlen(mnc + 1) == 3) ? 3 : 2;
+      break;
+    }
+    case 'y': m2ap_enb_sim_config.mbsfn_synch_area_id = atoi(optarg); break;
+    case 's': sais = optarg; break;
+    case 'k': m2ap_enb_sim_config.sais_per_enb = atoi(optarg); break;
+    case 'd': m2ap_enb_sim_config.response_delay_ns = (uint64_t)atoi(optarg) * NSEC_PER_MSEC; break;
+    case 'r': m2ap_enb_sim_config.setup_rate = atof(optarg); break;
+    case 't': m2ap_enb_sim_config.duration = atoi(optarg); break;
+    case 'i': m2ap_enb_sim_config.interval = atoi(optarg); break;
+    case 'g': m2ap_enb_sim_config.load_rate = atof(optarg); break;
+    default:
+      m2ap_enb_sim_usage(argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (m2ap_enb_sim_config.num_enbs <= 0 || m2ap_enb_sim_config.interval <= 0 || m2ap_enb_sim_parse_sais(sais)) {
+    m2ap_enb_sim_usage(argv[0]);
+    return 1;
+  }
+
+  /** One socket per eNB, beyond FD_SETSIZE if asked for. */
+  if (m2ap_enb_sim_config.load_rate > 0 && m2ap_enb_sim_encode_load_pdu()) {
+    fprintf(stderr, "Could not encode the load message\n");
+    return 1;
+  }
+  if (sctp_raise_fd_limit(m2ap_enb_sim_config.num_enbs + 64) < 0) {
+    fprintf(stderr, "Open file limit too low for %d eNBs, raise the hard limit (ulimit -Hn)\n", m2ap_enb_sim_config.num_enbs);
+    return 1;
+  }
+  m2ap_enb_sim_enbs = calloc(m2ap_enb_sim_config.num_enbs, sizeof(m2ap_enb_sim_enb_t));
+  fds = calloc(m2ap_enb_sim_config.num_enbs, sizeof(struct pollfd));
+  for (int i = 0; i < m2ap_enb_sim_config.num_enbs; i++) {
+    m2ap_enb_sim_enb_t * const enb = &m2ap_enb_sim_enbs[i];
+    const int num_sais = (m2ap_enb_sim_config.sais_per_enb > 0 && m2ap_enb_sim_config.sais_per_enb < m2ap_enb_sim_config.num_sais) ?
+        m2ap_enb_sim_config.sais_per_enb : m2ap_enb_sim_config.num_sais;
+    enb->index = i;
+    enb->enb_id = (m2ap_enb_sim_config.enb_id + i) & 0xFFFFF;
+    enb->sctp_data.sd = -1;
+    enb->num_sais = num_sais;
+    for (int s = 0; s < num_sais; s++) {
+      enb->sais[s] = m2ap_enb_sim_config.sais[((i * num_sais) + s) % m2ap_enb_sim_config.num_sais];
+    }
+  }
+  signal(SIGINT, m2ap_enb_sim_signal_handler);
+  signal(SIGTERM, m2ap_enb_sim_signal_handler);
+  signal(SIGPIPE, SIG_IGN);
+
+  printf("%d eNBs towards %s:%u, %d MBMS SAIs, response delay %lu ms, M2 Setup rate %.1f/s (0: unlimited)\n",
+      m2ap_enb_sim_config.num_enbs, m2ap_enb_sim_config.mce_address, m2ap_enb_sim_config.port, m2ap_enb_sim_config.num_sais,
+      (unsigned long)(m2ap_enb_sim_config.response_delay_ns / NSEC_PER_MSEC), m2ap_enb_sim_config.setup_rate);
+  if (m2ap_enb_sim_config.load_rate > 0)
+    printf("Load of %.1f Error Indications/s per eNB (%zd bytes each)\n", m2ap_enb_sim_config.load_rate, m2ap_enb_sim_load.length);
+  start_ns = report_ns = m2ap_enb_sim_start_ns = m2ap_enb_sim_now_ns();
+
+  while (!m2ap_enb_sim_terminate) {
+    int     nfds = 0;
+    int     timeout_ms = 100;
+
+    now_ns = m2ap_enb_sim_now_ns();
+    if (m2ap_enb_sim_config.duration && now_ns - start_ns >= (uint64_t)m2ap_enb_sim_config.duration * NSEC_PER_SEC)
+      break;
+
+    /** Connect the next eNBs, paced by the M2 Setup rate. */
+    for (int n = 0; n < M2AP_ENB_SIM_CONNECTS_PER_LOOP && next_enb < m2ap_enb_sim_config.num_enbs; n++) {
+      if (m2ap_enb_sim_config.setup_rate > 0
+          && (double)(now_ns - start_ns) < (double)next_enb * NSEC_PER_SEC / m2ap_enb_sim_config.setup_rate)
+        break;
+      m2ap_enb_sim_connect(&m2ap_enb_sim_enbs[next_enb++]);
+    }
+    /** Repeat rejected M2 Setups after the TimeToWait. */
+    for (int i = 0; i < next_enb; i++) {
+      m2ap_enb_sim_enb_t * const enb = &m2ap_enb_sim_enbs[i];
+      if (enb->connected && !enb->setup_done && enb->setup_retry_ns && enb->setup_retry_ns <= now_ns)
+        m2ap_enb_sim_send_m2_setup_request(enb);
+    }
+
+    m2ap_enb_sim_send_responses(now_ns);
+    if (m2ap_enb_sim_config.load_rate > 0)
+      m2ap_enb_sim_send_load(now_ns);
+    if (!TAILQ_EMPTY(&m2ap_enb_sim_responses)) {
+      const uint64_t due_ns = TAILQ_FIRST(&m2ap_enb_sim_responses)->due_ns;
+      timeout_ms = (due_ns > now_ns) ? (int)((due_ns - now_ns + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC) : 0;
+      timeout_ms = (timeout_ms < 100) ? timeout_ms : 100;
+    }
+    if (next_enb < m2ap_enb_sim_config.num_enbs || m2ap_enb_sim_config.load_rate > 0)
+      timeout_ms = (timeout_ms < 1) ? timeout_ms : 1;
+
+    for (int i = 0; i < next_enb; i++) {
+      if (m2ap_enb_sim_enbs[i].connected) {
+        fds[nfds].fd = m2ap_enb_sim_enbs[i].sctp_data.sd;
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        nfds++;
+      }
+    }
+    if (poll(fds, nfds, timeout_ms) > 0) {
+      /** The poll set is built from the connected eNBs in order. */
+      int f = 0;
+      for (int i = 0; i < next_enb && f < nfds; i++) {
+        if (!m2ap_enb_sim_enbs[i].connected)
+          continue;
+        if (fds[f++].revents)
+          m2ap_enb_sim_receive(&m2ap_enb_sim_enbs[i]);
+      }
+    }
+
+    now_ns = m2ap_enb_sim_now_ns();
+    if (now_ns - report_ns >= (uint64_t)m2ap_enb_sim_config.interval * NSEC_PER_SEC) {
+      m2ap_enb_sim_report(false, (double)(now_ns - report_ns) / NSEC_PER_SEC);
+      report_ns = now_ns;
+    }
+  }
+
+  now_ns = m2ap_enb_sim_now_ns();
+  m2ap_enb_sim_report(true, (double)(now_ns - start_ns) / NSEC_PER_SEC);
+  for (int i = 0; i < m2ap_enb_sim_config.num_enbs; i++) {
+    if (m2ap_enb_sim_enbs[i].connected)
+      close(m2ap_enb_sim_enbs[i].sctp_data.sd);
+  }
+  while (!TAILQ_EMPTY(&m2ap_enb_sim_responses)) {
+    m2ap_enb_sim_response_t * const response = TAILQ_FIRST(&m2ap_enb_sim_responses);
+    TAILQ_REMOVE(&m2ap_enb_sim_responses, response, entry);
+    free(response->buffer);
+    free(response);
+  }
+  free(m2ap_enb_sim_load.buffer);
+  free(fds);
+  free(m2ap_enb_sim_enbs);
+  return (m2ap_enb_sim_num_setup == m2ap_enb_sim_config.num_enbs && !m2ap_enb_sim_num_lost) ? 0 : 2;
+}
@@ -0,0 +1,193 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_encode_bench.c
+  \brief Measure the fan-out latency of encoding one M2AP PDU per eNB against the number of M2AP encoder threads.
+  The PDUs are decoded once from a recorded message corpus (one APER encoded M2AP PDU per file) and assigned
+  round-robin to the simulated eNBs. A fan-out is complete when all eNB PDUs are encoded and collected in eNB order.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "M2AP_M2AP-PDU.h"
+#include "m2ap_mce_encoder_pool.h"
+
+#define M2AP_ENCODE_BENCH_DEFAULT_ENBS        512
+#define M2AP_ENCODE_BENCH_DEFAULT_ROUNDS      50
+#define M2AP_ENCODE_BENCH_DEFAULT_THREADS     "0,1,2,4,8"
+
+typedef struct encode_job_s {
+  const M2AP_M2AP_PDU_t  *pdu;
+  void                   *buffer;
+  ssize_t                 length;
+} encode_job_t;
+
+//------------------------------------------------------------------------------
+static uint64_t bench_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int load_corpus_pdu (const char * const file_name, M2AP_M2AP_PDU_t ** const pdu_pp)
+{
+  FILE            *fp = fopen(file_name, "rb");
+  uint8_t         *buffer = NULL;
+  long             length = 0;
+  asn_dec_rval_t   dec_ret;
+
+  *pdu_pp = NULL;
+  if (!fp)
+    return -1;
+  if (fseek(fp, 0, SEEK_END) || (length = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET)
+      || !(buffer = malloc(length)) || fread(buffer, 1, length, fp) != (size_t)length) {
+    free(buffer);
+    fclose(fp);
+    return -1;
+  }
+  fclose(fp);
+  dec_ret = aper_decode(NULL, &asn_DEF_M2AP_M2AP_PDU, (void **)pdu_pp, buffer, length, 0, 0);
+  free(buffer);
+  if (dec_ret.code != RC_OK) {
+    ASN_STRUCT_FREE(asn_DEF_M2AP_M2AP_PDU, *pdu_pp);
+    *pdu_pp = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int encode_job (void * const job_p)
+{
+  encode_job_t * const job = (encode_job_t*)job_p;
+  job->length = aper_encode_to_new_buffer(&asn_DEF_M2AP_M2AP_PDU, NULL, job->pdu, &job->buffer);
+  return (job->length > 0) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+static int run_bench (encode_job_t * const jobs, const int num_enbs, const int rounds, const int num_threads)
+{
+  uint64_t  total = 0;
+  uint64_t  min = UINT64_MAX;
+  uint64_t  max = 0;
+  size_t    bytes = 0;
+
+  if (m2ap_encoder_pool_init(num_threads)) {
+    fprintf(stderr, "Could not start %d encoder threads\n", num_threads);
+    return -1;
+  }
+  for (int round = 0; round < rounds; round++) {
+    uint64_t t0 = bench_now_ns();
+    int num_failed = m2ap_encoder_pool_run(encode_job, jobs, num_enbs, sizeof(encode_job_t));
+    /** Collect the buffers in eNB order, as the M2AP task hands them to SCTP. */
+    bytes = 0;
+    for (int i = 0; i < num_enbs; i++) {
+      bytes += (jobs[i].length > 0) ? jobs[i].length : 0;
+      free(jobs[i].buffer);
+      jobs[i].buffer = NULL;
+    }
+    uint64_t duration = bench_now_ns() - t0;
+    if (num_failed) {
+      fprintf(stderr, "%d of %d PDUs could not be encoded\n", num_failed, num_enbs);
+      m2ap_encoder_pool_exit();
+      return -1;
+    }
+    total += duration;
+    min = (duration < min) ? duration : min;
+    max = (duration > max) ? duration : max;
+  }
+  m2ap_encoder_pool_exit();
+  printf("  %2d encoder threads: fan-out to %d eNBs avg %9.1f us  min %9.1f us  max %9.1f us  (%zu bytes)\n",
+      num_threads, num_enbs, (double)total / rounds / 1000.0, (double)min / 1000.0, (double)max / 1000.0, bytes);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                num_enbs = M2AP_ENCODE_BENCH_DEFAULT_ENBS;
+  int                rounds = M2AP_ENCODE_BENCH_DEFAULT_ROUNDS;
+  const char        *threads = M2AP_ENCODE_BENCH_DEFAULT_THREADS;
+  int                num_pdus = 0;
+  M2AP_M2AP_PDU_t  **pdus = NULL;
+  encode_job_t      *jobs = NULL;
+  int                opt = 0;
+  int                rc = 0;
+
+  while ((opt = getopt(argc, argv, "n:r:t:h")) != -1) {
+    switch (opt) {
+    case 'n': num_enbs = atoi(optarg); break;
+    case 'r': rounds = atoi(optarg); break;
+    case 't': threads = optarg; break;
+    default:
+      fprintf(stderr, "Usage: %s [-n enbs] [-r rounds] [-t thread counts, e.g. %s] corpus_file...\n", argv[0], M2AP_ENCODE_BENCH_DEFAULT_THREADS);
+      fprintf(stderr, "  Each corpus file holds one APER encoded M2AP PDU.\n");
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (optind >= argc || num_enbs <= 0 || rounds <= 0) {
+    fprintf(stderr, "Usage: %s [-n enbs] [-r rounds] [-t thread counts] corpus_file...\n", argv[0]);
+    return 1;
+  }
+
+  pdus = calloc(argc - optind, sizeof(M2AP_M2AP_PDU_t*));
+  for (int f = optind; f < argc; f++) {
+    if (load_corpus_pdu(argv[f], &pdus[num_pdus])) {
+      fprintf(stderr, "Could not read %s as M2AP PDU\n", argv[f]);
+      rc = 1;
+      continue;
+    }
+    num_pdus++;
+  }
+  if (!num_pdus) {
+    free(pdus);
+    return 1;
+  }
+
+  /** Each eNB gets its own PDU, no two neighbouring eNBs share the same content if the corpus allows. */
+  jobs = calloc(num_enbs, sizeof(encode_job_t));
+  for (int i = 0; i < num_enbs; i++) {
+    jobs[i].pdu = pdus[i % num_pdus];
+  }
+  printf("%d corpus PDUs, %d eNBs, %d rounds\n", num_pdus, num_enbs, rounds);
+  for (const char *t = threads; t && *t; t = strchr(t, ',') ? strchr(t, ',') + 1 : NULL) {
+    if (run_bench(jobs, num_enbs, rounds, atoi(t)))
+      rc = 1;
+  }
+
+  free(jobs);
+  for (int i = 0; i < num_pdus; i++) {
+    ASN_STRUCT_FREE(asn_DEF_M2AP_M2AP_PDU, pdus[i]);
+  }
+  free(pdus);
+  return rc;
+}
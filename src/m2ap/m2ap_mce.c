@@ -34,7 +34,9 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <pthread.h>
+#include <time.h>
 
 
 #include "bstrlib.h"
@@ -51,13 +53,17 @@
 #include "itti_free_defined_msg.h"
 #include "m2ap_mce.h"
 #include "m2ap_mce_decoder.h"
+#include "m2ap_arena.h"
 #include "m2ap_mce_handlers.h"
 #include "m2ap_mce_procedures.h"
+#include "m2ap_mce_encoder_pool.h"
 #include "m2ap_mce_retransmission.h"
 #include "m2ap_mce_itti_messaging.h"
+#include "sctp_primitives_server.h"
 #include "dynamic_memory_check.h"
 #include "3gpp_23.003.h"
 #include "mce_config.h"
+#include "mce_app_statistics.h"
 
 
 #if M2AP_DEBUG_LIST
@@ -76,10 +82,41 @@ hash_table_ts_t g_m2ap_enb_coll 	= {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // c
 hash_table_ts_t g_m2ap_mbms_coll 	= {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains MBMS_description_s, key is MBMS_description_s.mbms_m2ap_id (uint24_t);
 /** An MBMS Service can be associated to multiple SCTP IDs. */
 
+/**
+ * Secondary indexes on the M2AP eNBs, from MBMS Service Area Id and from local MBMS area to the associated eNBs.
+ * Maintained on M2 Setup, eNB configuration update and eNB removal, such that collecting the target eNBs of a
+ * procedure costs the number of matching eNBs and not the number of all eNBs. Only accessed by the M2AP task.
+ */
+typedef struct m2ap_enb_ref_set_s {
+  int                       num_enbs;
+  int                       max_enbs;
+  m2ap_enb_description_t  **enbs;
+  hash_table_t             *positions;                 ///< SCTP association id of an eNB to its position in enbs + 1
+} m2ap_enb_ref_set_t;
+
+hash_table_ts_t g_m2ap_mbms_sai2enb_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains m2ap_enb_ref_set_t, key is mbms_service_area_id_t;
+static m2ap_enb_ref_set_t m2ap_local_mbms_area2enb_set[MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS + 1];
+
+/** Received M2AP messages, from the first to the last SCTP data indication. Only accessed by the M2AP task. */
+static struct {
+  uint64_t                  messages;
+  uint64_t                  bytes;
+  uint64_t                  first_ns;
+  uint64_t                  last_ns;
+} m2ap_ingest_stats;
+
 static int                              indent = 0;
 extern struct mce_config_s              mce_config;
 void *m2ap_mce_thread (void *args);
 
+//------------------------------------------------------------------------------
+static uint64_t m2ap_ingest_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 //------------------------------------------------------------------------------
 static int m2ap_send_init_sctp (void)
 {
@@ -169,6 +206,66 @@ static bool m2ap_clear_enb_mbms_stats_cb (__attribute__((unused)) const hash_key
   return false;
 }
 
+//------------------------------------------------------------------------------
+static void
+m2ap_enb_ref_set_add (
+  m2ap_enb_ref_set_t * const enb_set, m2ap_enb_description_t * const m2ap_enb_ref)
+{
+  if(!enb_set->positions) {
+    bstring bs = bfromcstr("m2ap_enb_ref_set_positions");
+    enb_set->positions = hashtable_create(mce_config.mbms.max_m2_enbs, NULL, hash_free_int_func, bs);
+    bdestroy_wrapper(&bs);
+    DevAssert(enb_set->positions != NULL);
+  }
+  /** The eNB may already be in the set, e.g. with a Service Area Id listed twice. */
+  if(hashtable_is_key_exists(enb_set->positions, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id) == HASH_TABLE_OK)
+    return;
+  if(enb_set->num_enbs == enb_set->max_enbs) {
+    enb_set->max_enbs = enb_set->max_enbs ? (2 * enb_set->max_enbs) : 8;
+    enb_set->enbs = realloc(enb_set->enbs, enb_set->max_enbs * sizeof(m2ap_enb_description_t*));
+    DevAssert(enb_set->enbs != NULL);
+  }
+  hashtable_insert(enb_set->positions, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id, (void*)(uintptr_t)(enb_set->num_enbs + 1));
+  enb_set->enbs[enb_set->num_enbs++] = m2ap_enb_ref;
+}
+
+//------------------------------------------------------------------------------
+static void
+m2ap_enb_ref_set_remove (
+  m2ap_enb_ref_set_t * const enb_set, const m2ap_enb_description_t * const m2ap_enb_ref)
+{
+  void                                 *position = NULL;
+  int                                   i = 0;
+
+  if(!enb_set->positions
+      || hashtable_get(enb_set->positions, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id, &position) != HASH_TABLE_OK)
+    return;
+  i = (int)(uintptr_t)position - 1;
+  hashtable_free(enb_set->positions, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id);
+  /** Order is not relevant, move the last element into the gap. */
+  enb_set->enbs[i] = enb_set->enbs[--enb_set->num_enbs];
+  enb_set->enbs[enb_set->num_enbs] = NULL;
+  if(i < enb_set->num_enbs) {
+    hashtable_insert(enb_set->positions, (const hash_key_t)enb_set->enbs[i]->sctp_assoc_id, (void*)(uintptr_t)(i + 1));
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+m2ap_free_enb_ref_set (
+  void ** enb_set_pp)
+{
+  m2ap_enb_ref_set_t                   *enb_set = NULL;
+  if (*enb_set_pp) {
+    enb_set = (m2ap_enb_ref_set_t*)(*enb_set_pp);
+    if(enb_set->positions)
+      hashtable_destroy(enb_set->positions);
+    if(enb_set->enbs)
+      free_wrapper((void**)&enb_set->enbs);
+    free_wrapper(enb_set_pp);
+  }
+}
+
 //------------------------------------------------------------------------------
 static void
 m2ap_remove_enb (
@@ -178,6 +275,10 @@ m2ap_remove_enb (
   mbms_description_t                   *mbms_ref 			 = NULL;
   if (*enb_ref ) {
     m2ap_enb_description = (m2ap_enb_description_t*)(*enb_ref);
+    /** Remove the eNB from the MBMS Service Area and local MBMS area indexes, before the reference gets invalid. */
+    m2ap_enb_index_remove(m2ap_enb_description);
+    m2ap_m2_setup_admission_release(m2ap_enb_description);
+    m2ap_timer_remove_enb(m2ap_enb_description->sctp_assoc_id);
     /**
      * Go through the MBMS Services, and remove the SCTP association.
      * This should not trigger anything, only key removal.
@@ -231,41 +332,6 @@ m2ap_remove_mbms (
   free_wrapper(mbms_ref_pp);
 }
 
-//------------------------------------------------------------------------------
-static
-bool m2ap_enb_compare_by_mbms_sai_cb (__attribute__((unused)) const hash_key_t keyP,
-                                    void * const elementP,
-                                    void * parameterP, void **resultP)
-{
-  const mbms_service_area_id_t * const mbms_sai_p  	= (const mbms_service_area_id_t *const)parameterP;
-  m2ap_enb_description_t       * m2ap_enb_ref  	    = (m2ap_enb_description_t*)elementP;
-  hashtable_element_array_t    * ea_p								= (hashtable_element_array_t*)*resultP;
-  for(int i = 0; i < m2ap_enb_ref->mbms_sa_list.num_service_area; i++) {
-    if (*mbms_sai_p == m2ap_enb_ref->mbms_sa_list.serviceArea[i]) {
-    	ea_p->elements[ea_p->num_elements++] = (void*)m2ap_enb_ref;
-      return false;
-    }
-  }
-  return false;
-}
-
-//------------------------------------------------------------------------------
-static
-bool m2ap_enb_compare_by_local_mbms_area_cb (__attribute__((unused)) const hash_key_t keyP,
-                                    void * const elementP,
-                                    void * parameterP, void **resultP)
-{
-  const uint8_t 							 * const local_mbms_area_p  = (const uint8_t *const)parameterP;
-  m2ap_enb_description_t       * m2ap_enb_ref  	    			= (m2ap_enb_description_t*)elementP;
-  hashtable_element_array_t    * ea_p											= (hashtable_element_array_t*)*resultP;
-  if (*local_mbms_area_p == m2ap_enb_ref->local_mbms_area) {
-  		/** Just return true. */
-    	ea_p->elements[ea_p->num_elements++] = (void*)m2ap_enb_ref;
-    	return false;
-  }
-  return false;
-}
-
 //------------------------------------------------------------------------------
 static
 bool m2ap_enb_compare_by_mbms_sai_NACK_cb (__attribute__((unused)) const hash_key_t keyP,
@@ -274,24 +340,24 @@ bool m2ap_enb_compare_by_mbms_sai_NACK_cb (__attribute__((unused)) const hash_ke
 {
   const mbms_service_area_id_t * const mbms_sai_p  = (const mbms_service_area_id_t *const)parameterP;
   m2ap_enb_description_t       * m2ap_enb_ref  	    = (m2ap_enb_description_t*)elementP;
-  hashtable_element_array_t    * ea_p								= (hashtable_element_array_t*)*resultP;
   for(int i = 0; i < m2ap_enb_ref->mbms_sa_list.num_service_area; i++) {
     if (*mbms_sai_p == m2ap_enb_ref->mbms_sa_list.serviceArea[i]) {
       return false;
     }
   }
-  /** Found an M2AP eNB, where none of the MBMS Service Area Ids match the given key. */
-	ea_p->elements[ea_p->num_elements++] = (void*)m2ap_enb_ref;
-  return false;
+  /** Found an M2AP eNB, where none of the MBMS Service Area Ids match the given key. Collected by the caller. */
+  return true;
 }
 
 //------------------------------------------------------------------------------
 static bool m2ap_mbms_compare_by_tmgi_cb (__attribute__((unused)) const hash_key_t keyP,
                                       void * const elementP, void * parameterP, void **resultP)
 {
-  mce_mbms_m2ap_id_t                      * mce_mbms_m2ap_id_p = (mce_mbms_m2ap_id_t*)parameterP;
+  const m2ap_tmgi_t                       * m2ap_tmgi_p        = (const m2ap_tmgi_t*)parameterP;
   mbms_description_t                       *mbms_ref           = (mbms_description_t*)elementP;
-  if ( *mce_mbms_m2ap_id_p == mbms_ref->mce_mbms_m2ap_id ) {
+  if ( m2ap_tmgi_p->tmgi.mbms_service_id == mbms_ref->tmgi.mbms_service_id
+      && PLMNS_ARE_EQUAL(m2ap_tmgi_p->tmgi.plmn, mbms_ref->tmgi.plmn)
+      && m2ap_tmgi_p->mbms_service_area_id_t == mbms_ref->mbms_service_area_id) {
     *resultP = elementP;
     OAILOG_TRACE(LOG_M2AP, "Found mbms_ref %p mce_mbms_m2ap_id " MCE_MBMS_M2AP_ID_FMT "\n", mbms_ref, mbms_ref->mce_mbms_m2ap_id);
     return true;
@@ -354,8 +420,8 @@ m2ap_mce_thread (
 
     case M3AP_MBMS_SESSION_STOP_REQUEST:{
     	m2ap_handle_mbms_session_stop_request (&M3AP_MBMS_SESSION_STOP_REQUEST (received_message_p).tmgi,
-    			&M3AP_MBMS_SESSION_STOP_REQUEST (received_message_p).mbms_service_area_id,
-				&M3AP_MBMS_SESSION_STOP_REQUEST (received_message_p).inform_enbs);
+    			M3AP_MBMS_SESSION_STOP_REQUEST (received_message_p).mbms_service_area_id,
+				M3AP_MBMS_SESSION_STOP_REQUEST (received_message_p).inform_enbs);
     }
     break;
 
@@ -387,6 +453,15 @@ m2ap_mce_thread (
     }
     break;
 
+    // From SCTP, a message could not be sent to the eNB. The response timer repeats it, until the association is lost.
+    case SCTP_DATA_CNF:{
+    	if (!SCTP_DATA_CNF (received_message_p).is_success) {
+    	  OAILOG_WARNING (LOG_M2AP, "SCTP could not send the M2AP message to the eNB with sctp_assoc=%d on stream %d.\n",
+    		  SCTP_DATA_CNF (received_message_p).assoc_id, SCTP_DATA_CNF (received_message_p).stream);
+    	}
+    }
+    break;
+
     // From SCTP
     case SCTP_DATA_IND:{
     	/*
@@ -395,8 +470,13 @@ m2ap_mce_thread (
     	 */
     	M2AP_M2AP_PDU_t                            pdu = {0};
 
+    	m2ap_ingest_stats.last_ns = m2ap_ingest_now_ns();
+    	if (!m2ap_ingest_stats.messages++)
+    	  m2ap_ingest_stats.first_ns = m2ap_ingest_stats.last_ns;
+    	m2ap_ingest_stats.bytes += blength(SCTP_DATA_IND (received_message_p).payload);
+
     	/*
-    	 * Invoke M2AP message decoder
+    	 * Invoke M2AP message decoder, directly on the SCTP receive buffer.
     	 */
     	if (m2ap_mce_decode_pdu (&pdu, SCTP_DATA_IND (received_message_p).payload) < 0) {
     		// TODO: Notify eNB of failure with right cause
@@ -404,11 +484,17 @@ m2ap_mce_thread (
     	} else {
     		m2ap_mce_handle_message (SCTP_DATA_IND (received_message_p).assoc_id, SCTP_DATA_IND (received_message_p).stream, &pdu);
     	}
+#if M2AP_DECODE_ARENA
+    	/*
+    	 * Release the decoded PDU (also partially decoded ones) in one shot.
+    	 */
+    	m2ap_arena_release();
+#endif
 
     	/*
-    	 * Free received PDU array
+    	 * Give the received buffer back to SCTP
     	 */
-    	bdestroy_wrapper (&SCTP_DATA_IND (received_message_p).payload);
+    	sctp_release_recv_buffer (&SCTP_DATA_IND (received_message_p).payload);
     }
     break;
 
@@ -419,6 +505,9 @@ m2ap_mce_thread (
 
     case TIMER_HAS_EXPIRED:{
     	mbms_description_t                       *mbms_ref_p = NULL;
+    	/** Tick of the M2AP response timers. */
+    	if (m2ap_handle_timer_expiry (&received_message_p->ittiMsg.timer_has_expired) == 0)
+    	  break;
     	if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) {
     	  mce_mbms_m2ap_id_t mce_mbms_m2ap_id = (mce_mbms_m2ap_id_t) received_message_p->ittiMsg.timer_has_expired.arg;
     	  /** Check if the MBMS still exists. */
@@ -493,6 +582,24 @@ m2ap_mce_init(void)
   bdestroy_wrapper (&bs1);
   if (!h) return RETURNerror;
 
+  /** Index of the M2AP eNBs per MBMS Service Area Id. The eNB references are not owned by the index. */
+  bs1 = bfromcstr("m2ap_mbms_sai2enb_coll");
+  h = hashtable_ts_init (&g_m2ap_mbms_sai2enb_coll, MAX_MBMS_SERVICE_AREA, NULL, m2ap_free_enb_ref_set, bs1);
+  bdestroy_wrapper (&bs1);
+  if (!h) return RETURNerror;
+  memset(m2ap_local_mbms_area2enb_set, 0, sizeof(m2ap_local_mbms_area2enb_set));
+
+  /** Encoded MBMS Scheduling Information of the last MBMS scheduling period. */
+  if (m2ap_mbms_scheduling_cache_init() != RETURNok) return RETURNerror;
+
+  /** Response timers of the MCE initiated procedures. */
+  if (m2ap_timer_init() != 0) return RETURNerror;
+
+  if (m2ap_encoder_pool_init(mce_config.mbms.m2ap_encoder_threads) != 0) {
+    OAILOG_ERROR (LOG_M2AP, "Error while creating (%d) M2AP encoder threads\n", mce_config.mbms.m2ap_encoder_threads);
+    return RETURNerror;
+  }
+
   if (itti_create_task (TASK_M2AP, &m2ap_mce_thread, NULL) < 0) {
     OAILOG_ERROR (LOG_M2AP, "Error while creating M2AP task\n");
     return RETURNerror;
@@ -504,6 +611,13 @@ m2ap_mce_init(void)
 void m2ap_mce_exit (void)
 {
   OAILOG_DEBUG (LOG_M2AP, "Cleaning M2AP\n");
+  if (m2ap_ingest_stats.messages) {
+    double duration_s = (double)(m2ap_ingest_stats.last_ns - m2ap_ingest_stats.first_ns) / 1e9;
+    OAILOG_INFO (LOG_M2AP, "Received %" PRIu64 " M2AP messages, %" PRIu64 " bytes in %.3f s (%.0f messages/s).\n",
+        m2ap_ingest_stats.messages, m2ap_ingest_stats.bytes, duration_s, (duration_s > 0) ? (m2ap_ingest_stats.messages - 1) / duration_s : 0.0);
+  }
+  m2ap_encoder_pool_exit();
+  m2ap_timer_exit();
   if (hashtable_ts_destroy(&g_m2ap_mbms_coll) != HASH_TABLE_OK) {
     OAILOG_ERROR(LOG_M2AP, "An error occurred while destroying MBMS Service hash table. \n");
   }
@@ -511,6 +625,21 @@ void m2ap_mce_exit (void)
   if (hashtable_ts_destroy(&g_m2ap_enb_coll) != HASH_TABLE_OK) {
     OAILOG_ERROR(LOG_M2AP, "An error occurred while destroying M2 eNB hash table. \n");
   }
+
+  /** Destroy the indexes after the eNBs, which remove themselves from the indexes. */
+  if (hashtable_ts_destroy(&g_m2ap_mbms_sai2enb_coll) != HASH_TABLE_OK) {
+    OAILOG_ERROR(LOG_M2AP, "An error occurred while destroying MBMS SAI to M2 eNB hash table. \n");
+  }
+  for(int local_mbms_area = 0; local_mbms_area < (MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS + 1); local_mbms_area++) {
+    if(m2ap_local_mbms_area2enb_set[local_mbms_area].positions)
+      hashtable_destroy(m2ap_local_mbms_area2enb_set[local_mbms_area].positions);
+    m2ap_local_mbms_area2enb_set[local_mbms_area].positions = NULL;
+    if(m2ap_local_mbms_area2enb_set[local_mbms_area].enbs)
+      free_wrapper((void**)&m2ap_local_mbms_area2enb_set[local_mbms_area].enbs);
+    m2ap_local_mbms_area2enb_set[local_mbms_area].num_enbs = 0;
+    m2ap_local_mbms_area2enb_set[local_mbms_area].max_enbs = 0;
+  }
+  m2ap_mbms_scheduling_cache_exit();
   OAILOG_DEBUG (LOG_M2AP, "Cleaning M2AP: DONE\n");
 }
 
@@ -556,6 +685,8 @@ m2ap_dump_enb (
   m2AP_eNB_LIST_OUT ("SCTP instreams:     %d", m2ap_enb_ref->instreams);
   m2AP_eNB_LIST_OUT ("SCTP outstreams:    %d", m2ap_enb_ref->outstreams);
   m2AP_eNB_LIST_OUT ("MBMS active on eNB: %d", m2ap_enb_ref->nb_mbms_associated);
+  m2AP_eNB_LIST_OUT ("M2AP retransmits:   %u", m2ap_enb_ref->num_m2ap_retransmissions);
+  m2AP_eNB_LIST_OUT ("M2AP timeouts:      %u", m2ap_enb_ref->num_m2ap_timeouts);
   m2AP_eNB_LIST_OUT ("");
 #  else
   m2ap_dump_mbms (NULL);
@@ -617,21 +748,86 @@ m2ap_is_enb_id_in_list (
   return m2ap_enb_ref;
 }
 
+//------------------------------------------------------------------------------
+void m2ap_enb_index_add (
+  m2ap_enb_description_t * const m2ap_enb_ref)
+{
+  m2ap_enb_ref_set_t                     *enb_set = NULL;
+  DevAssert(m2ap_enb_ref);
+
+  for(int i = 0; i < m2ap_enb_ref->mbms_sa_list.num_service_area; i++) {
+    enb_set = NULL;
+    if(hashtable_ts_get(&g_m2ap_mbms_sai2enb_coll, (const hash_key_t)m2ap_enb_ref->mbms_sa_list.serviceArea[i], (void**)&enb_set) != HASH_TABLE_OK) {
+      enb_set = calloc(1, sizeof(m2ap_enb_ref_set_t));
+      DevAssert(enb_set != NULL);
+      hashtable_rc_t hash_rc = hashtable_ts_insert(&g_m2ap_mbms_sai2enb_coll, (const hash_key_t)m2ap_enb_ref->mbms_sa_list.serviceArea[i], (void*)enb_set);
+      DevAssert(HASH_TABLE_OK == hash_rc);
+    }
+    m2ap_enb_ref_set_add(enb_set, m2ap_enb_ref);
+  }
+  if(m2ap_enb_ref->local_mbms_area <= MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS) {
+    m2ap_enb_ref_set_add(&m2ap_local_mbms_area2enb_set[m2ap_enb_ref->local_mbms_area], m2ap_enb_ref);
+  } else {
+    OAILOG_ERROR(LOG_M2AP, "Local MBMS area (%d) of M2AP eNB with sctp assoc id (%d) is out of bounds. Not indexing it. \n",
+        m2ap_enb_ref->local_mbms_area, m2ap_enb_ref->sctp_assoc_id);
+  }
+}
+
+//------------------------------------------------------------------------------
+void m2ap_enb_index_remove (
+  const m2ap_enb_description_t * const m2ap_enb_ref)
+{
+  m2ap_enb_ref_set_t                     *enb_set = NULL;
+  DevAssert(m2ap_enb_ref);
+
+  for(int i = 0; i < m2ap_enb_ref->mbms_sa_list.num_service_area; i++) {
+    enb_set = NULL;
+    if(hashtable_ts_get(&g_m2ap_mbms_sai2enb_coll, (const hash_key_t)m2ap_enb_ref->mbms_sa_list.serviceArea[i], (void**)&enb_set) == HASH_TABLE_OK) {
+      m2ap_enb_ref_set_remove(enb_set, m2ap_enb_ref);
+      if(!enb_set->num_enbs) {
+        /** Last eNB of the MBMS Service Area removed. */
+        hashtable_ts_free(&g_m2ap_mbms_sai2enb_coll, (const hash_key_t)m2ap_enb_ref->mbms_sa_list.serviceArea[i]);
+      }
+    }
+  }
+  if(m2ap_enb_ref->local_mbms_area <= MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS) {
+    m2ap_enb_ref_set_remove(&m2ap_local_mbms_area2enb_set[m2ap_enb_ref->local_mbms_area], m2ap_enb_ref);
+  }
+}
+
+//------------------------------------------------------------------------------
+void m2ap_set_enb_local_mbms_area (
+  m2ap_enb_description_t * const m2ap_enb_ref, const uint8_t local_mbms_area)
+{
+  DevAssert(m2ap_enb_ref);
+  if(m2ap_enb_ref->local_mbms_area == local_mbms_area)
+    return;
+  if(m2ap_enb_ref->local_mbms_area <= MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS) {
+    m2ap_enb_ref_set_remove(&m2ap_local_mbms_area2enb_set[m2ap_enb_ref->local_mbms_area], m2ap_enb_ref);
+  }
+  m2ap_enb_ref->local_mbms_area = local_mbms_area;
+  if(local_mbms_area <= MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS) {
+    m2ap_enb_ref_set_add(&m2ap_local_mbms_area2enb_set[local_mbms_area], m2ap_enb_ref);
+  }
+}
+
 //------------------------------------------------------------------------------
 void m2ap_is_mbms_area_list (
   const uint8_t local_mbms_area,
   int *num_m2ap_enbs,
   m2ap_enb_description_t ** m2ap_enbs)
 {
-  m2ap_enb_description_t    *m2ap_enb_ref 			 = NULL;
-  /** Collect all M2AP eNBs for the given MBSFN Area Id. */
-  hashtable_element_array_t  ea, *ea_p = &ea;
-  memset(&ea, 0, sizeof(hashtable_element_array_t));
-  ea.elements = m2ap_enbs;
-  hashtable_ts_apply_list_callback_on_elements((hash_table_ts_t * const)&g_m2ap_enb_coll,
-  		m2ap_enb_compare_by_local_mbms_area_cb, (void *)&local_mbms_area, &ea_p);
-  OAILOG_DEBUG(LOG_M2AP, "Found (%d) matching m2ap_enb references based on the received local MBMS area (%d). \n", ea.num_elements, local_mbms_area);
-  *num_m2ap_enbs = ea.num_elements;
+  const m2ap_enb_ref_set_t               *enb_set = NULL;
+  *num_m2ap_enbs = 0;
+  /** Collect all M2AP eNBs for the given local MBMS area from the index. */
+  if(local_mbms_area <= MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS) {
+    enb_set = &m2ap_local_mbms_area2enb_set[local_mbms_area];
+    if(enb_set->num_enbs) {
+      memcpy((void*)m2ap_enbs, (void*)enb_set->enbs, enb_set->num_enbs * sizeof(m2ap_enb_description_t*));
+      *num_m2ap_enbs = enb_set->num_enbs;
+    }
+  }
+  OAILOG_DEBUG(LOG_M2AP, "Found (%d) matching m2ap_enb references based on the received local MBMS area (%d). \n", *num_m2ap_enbs, local_mbms_area);
 }
 
 //------------------------------------------------------------------------------
@@ -640,17 +836,15 @@ void m2ap_is_mbms_sai_in_list (
   int *num_m2ap_enbs,
 	const m2ap_enb_description_t ** m2ap_enbs)
 {
-  m2ap_enb_description_t                 *m2ap_enb_ref 	= NULL;
-  mbms_service_area_id_t                 *mbms_sai_p  	= (mbms_service_area_id_t*)&mbms_sai;
-
-  /** Collect all M2AP eNBs for the given MBMS Service Area Id. */
-  hashtable_element_array_t              ea, *ea_p = NULL;
-  memset(&ea, 0, sizeof(hashtable_element_array_t));
-  ea.elements = m2ap_enbs;
-  ea_p = &ea;
-  hashtable_ts_apply_list_callback_on_elements((hash_table_ts_t * const)&g_m2ap_enb_coll, m2ap_enb_compare_by_mbms_sai_cb, (void *)mbms_sai_p, &ea_p);
-  OAILOG_DEBUG(LOG_M2AP, "Found %d matching m2ap_enb references based on the received MBMS SAI" MBMS_SERVICE_AREA_ID_FMT". \n", ea.num_elements, mbms_sai);
-  *num_m2ap_enbs = ea.num_elements;
+  m2ap_enb_ref_set_t                     *enb_set = NULL;
+  *num_m2ap_enbs = 0;
+  /** Collect all M2AP eNBs for the given MBMS Service Area Id from the index. */
+  hashtable_ts_get(&g_m2ap_mbms_sai2enb_coll, (const hash_key_t)mbms_sai, (void**)&enb_set);
+  if(enb_set && enb_set->num_enbs) {
+    memcpy((void*)m2ap_enbs, (void*)enb_set->enbs, enb_set->num_enbs * sizeof(m2ap_enb_description_t*));
+    *num_m2ap_enbs = enb_set->num_enbs;
+  }
+  OAILOG_DEBUG(LOG_M2AP, "Found %d matching m2ap_enb references based on the received MBMS SAI" MBMS_SERVICE_AREA_ID_FMT". \n", *num_m2ap_enbs, mbms_sai);
 }
 
 //------------------------------------------------------------------------------
@@ -663,11 +857,10 @@ void m2ap_is_mbms_sai_not_in_list (
   mbms_service_area_id_t                 *mbms_sai_p  	= (mbms_service_area_id_t*)&mbms_sai;
 
   /** Collect all M2AP eNBs for the given MBMS Service Area Id. */
-  hashtable_element_array_t              ea, *ea_p = NULL;
+  hashtable_element_array_t              ea;
   memset(&ea, 0, sizeof(hashtable_element_array_t));
-  ea.elements = m2ap_enbs;
-  ea_p = &ea;
-  hashtable_ts_apply_list_callback_on_elements((hash_table_ts_t * const)&g_m2ap_enb_coll, m2ap_enb_compare_by_mbms_sai_NACK_cb, (void *)mbms_sai_p, &ea_p);
+  ea.elements = (void**)m2ap_enbs;
+  hashtable_ts_apply_list_callback_on_elements((hash_table_ts_t * const)&g_m2ap_enb_coll, m2ap_enb_compare_by_mbms_sai_NACK_cb, (void *)mbms_sai_p, &ea);
   OAILOG_DEBUG(LOG_M2AP, "Found %d unmatching m2ap_enb references based on the received MBMS SAI" MBMS_SERVICE_AREA_ID_FMT". \n", ea.num_elements, mbms_sai);
   *num_m2ap_enbs = ea.num_elements;
 }
@@ -794,7 +987,7 @@ m2ap_new_mbms (
   /** No Deadlocks should occur, since we check the nb_mbms services in the eNBs above,
    * when removing keys from the list. */
   DevAssert(pthread_mutex_init(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll.mutex, NULL) == 0);
-  hashtable_rc_t  hash_rc = hashtable_ts_insert (&g_m2ap_enb_coll, (const hash_key_t)mce_mbms_m2ap_id, (void *)mbms_ref);
+  hashtable_rc_t  hash_rc = hashtable_ts_insert (&g_m2ap_mbms_coll, (const hash_key_t)mce_mbms_m2ap_id, (void *)mbms_ref);
   DevAssert (HASH_TABLE_OK == hash_rc); /**< Else we need an extra method to avoid a leak. This should not happens, since we check above. */
   return mbms_ref;
 }
@@ -805,6 +998,11 @@ m2ap_set_embms_cfg_item (m2ap_enb_description_t * const m2ap_enb_ref,
 	M2AP_MBMS_Service_Area_ID_List_t * mbms_service_areas)
 {
   uint16_t                                mbms_sa_value = 0;
+  /**
+   * Remove the eNB from the index with its old MBMS Service Areas (M2 Setup or eNB configuration update).
+   */
+  m2ap_enb_index_remove(m2ap_enb_ref);
+  m2ap_enb_ref->mbms_sa_list.num_service_area = 0;
   /**
    * Create a new MBMS Service Area item with the MBMS Service Areas matching the MME configuration.
    */
@@ -833,4 +1031,6 @@ m2ap_set_embms_cfg_item (m2ap_enb_description_t * const m2ap_enb_ref,
 		}
   }
   mce_config_unlock (&mce_config);
+  /** Index the eNB with the new MBMS Service Areas. */
+  m2ap_enb_index_add(m2ap_enb_ref);
 }
@@ -88,6 +88,8 @@ typedef struct mbms_description_s {
 
   /** MBMS Bearer. */
   struct mbms_bearer_context_s		mbms_bc;
+  /** The MBMS Service Area or the TNL information changed, the associated eNBs need an MBMS Session Update. */
+  bool                      update_enbs;
 
   // MBMS Action timer
   struct m2ap_timer_t       m2ap_action_timer;
@@ -107,6 +109,7 @@ typedef struct m2ap_tmgi_s{
 typedef struct m2ap_enb_description_s {
 
   enum mce_m2_enb_state_s m2_state;         ///< State of the eNB specific M2AP association
+  bool                    m2_setup_pending; ///< M2 Setup admitted and waiting for MCE_APP
 
   /** eNB related parameters **/
   /*@{*/
@@ -125,6 +128,12 @@ typedef struct m2ap_enb_description_s {
   uint32_t nb_mbms_associated; ///< Number of NAS associated UE on this eNB
   /*@}*/
 
+  /** M2AP response timers **/
+  /*@{*/
+  uint32_t num_m2ap_retransmissions; ///< Requests retransmitted to the eNB after a response timeout
+  uint32_t num_m2ap_timeouts;        ///< Procedures towards the eNB, which timed out after all retransmissions
+  /*@}*/
+
   /** SCTP stuff **/
   /*@{*/
   sctp_assoc_id_t  sctp_assoc_id;    ///< SCTP association id on this machine
@@ -221,6 +230,20 @@ void
 m2ap_set_embms_cfg_item (m2ap_enb_description_t * const m2ap_enb_ref,
 	M2AP_MBMS_Service_Area_ID_List_t * mbms_service_areas);
 
+/** \brief Add the eNB to the MBMS Service Area and local MBMS area indexes.
+ * Must be called whenever the MBMS Service Areas or the local MBMS area of the eNB got updated.
+ **/
+void m2ap_enb_index_add (m2ap_enb_description_t * const m2ap_enb_ref);
+
+/** \brief Remove the eNB from the MBMS Service Area and local MBMS area indexes.
+ * Must be called before the MBMS Service Areas or the local MBMS area of the eNB are changed and before the eNB is removed.
+ **/
+void m2ap_enb_index_remove (const m2ap_enb_description_t * const m2ap_enb_ref);
+
+/** \brief Set the local MBMS area of the eNB and move it in the local MBMS area index.
+ **/
+void m2ap_set_enb_local_mbms_area (m2ap_enb_description_t * const m2ap_enb_ref, const uint8_t local_mbms_area);
+
 /** \brief Dump the eNB related information.
  * hashtable callback. It is called by hashtable_ts_apply_funct_on_elements()
  * Calls m2ap_dump_enb
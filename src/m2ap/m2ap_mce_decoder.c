@@ -33,6 +33,7 @@
 
 #include "m2ap_common.h"
 #include "m2ap_mce_handlers.h"
+#include "m2ap_arena.h"
 #include "bstrlib.h"
 
 #include "log.h"
@@ -47,6 +48,12 @@ int m2ap_mce_decode_pdu(M2AP_M2AP_PDU_t *pdu, const_bstring const raw)
   asn_dec_rval_t dec_ret;
   DevAssert(pdu != NULL);
   DevAssert(blength(raw) != 0);
+#if M2AP_DECODE_ARENA
+  /**
+   * Decode all IEs into the arena of the M2AP thread. The PDU is released with m2ap_arena_release() after the handler.
+   */
+  m2ap_arena_decode_start();
+#endif
   dec_ret = aper_decode(NULL,
                         &asn_DEF_M2AP_M2AP_PDU,
                         (void **)&pdu,
@@ -54,6 +61,9 @@ int m2ap_mce_decode_pdu(M2AP_M2AP_PDU_t *pdu, const_bstring const raw)
                         blength(raw),
                         0,
                         0);
+#if M2AP_DECODE_ARENA
+  m2ap_arena_decode_stop();
+#endif
 
   if (dec_ret.code != RC_OK) {
     OAILOG_ERROR (LOG_S1AP, "Failed to decode PDU\n");
@@ -26,4 +26,14 @@
 #include "bstrlib.h"
 
 int m2ap_mce_decode_pdu(M2AP_M2AP_PDU_t *pdu, const_bstring const raw) __attribute__ ((warn_unused_result));
+
+/**
+ * Release the contents of a PDU decoded by m2ap_mce_decode_pdu. With the decode arena this is a no-op: the M2AP
+ * task resets the arena after the handler, without walking the PDU.
+ */
+#if M2AP_DECODE_ARENA
+#define M2AP_MCE_FREE_DECODED_PDU(pDU)
+#else
+#define M2AP_MCE_FREE_DECODED_PDU(pDU)    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, (pDU))
+#endif
 #endif /* FILE_M2AP_MCE_DECODER_SEEN */
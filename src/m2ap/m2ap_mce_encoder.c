@@ -113,6 +113,12 @@ m2ap_mce_encode_initiating (
 
   memset(&res, 0, sizeof(res));
   res = asn_encode_to_new_buffer(NULL, ATS_ALIGNED_CANONICAL_PER, &asn_DEF_M2AP_M2AP_PDU, pdu);
+  if (res.result.encoded < 0) {
+    OAILOG_ERROR (LOG_M2AP, "Encoding of the M2AP PDU failed at type %s\n", res.result.failed_type ? res.result.failed_type->name : "unknown");
+    *buffer = NULL;
+    *length = 0;
+    return -1;
+  }
   *buffer = res.buffer;
   *length = res.result.encoded;
   return 0;
@@ -142,6 +148,12 @@ m2ap_mce_encode_successfull_outcome (
 
   memset(&res, 0, sizeof(res));
   res = asn_encode_to_new_buffer(NULL, ATS_ALIGNED_CANONICAL_PER, &asn_DEF_M2AP_M2AP_PDU, pdu);
+  if (res.result.encoded < 0) {
+    OAILOG_ERROR (LOG_M2AP, "Encoding of the M2AP PDU failed at type %s\n", res.result.failed_type ? res.result.failed_type->name : "unknown");
+    *buffer = NULL;
+    *length = 0;
+    return -1;
+  }
   *buffer = res.buffer;
   *length = res.result.encoded;
   return 0;
@@ -171,6 +183,12 @@ m2ap_mce_encode_unsuccessfull_outcome (
 
   memset(&res, 0, sizeof(res));
   res = asn_encode_to_new_buffer(NULL, ATS_ALIGNED_CANONICAL_PER, &asn_DEF_M2AP_M2AP_PDU, pdu);
+  if (res.result.encoded < 0) {
+    OAILOG_ERROR (LOG_M2AP, "Encoding of the M2AP PDU failed at type %s\n", res.result.failed_type ? res.result.failed_type->name : "unknown");
+    *buffer = NULL;
+    *length = 0;
+    return -1;
+  }
   *buffer = res.buffer;
   *length = res.result.encoded;
   return 0;
@@ -0,0 +1,167 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_mce_encoder_pool.c
+  \brief Optional pool of encoder threads for the M2AP task.
+  Kept free of the logging and ITTI dependencies, such that it can be used by the M2AP benchmarks.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "m2ap_mce_encoder_pool.h"
+
+typedef struct m2ap_encoder_pool_s {
+  pthread_mutex_t             mutex;
+  pthread_cond_t              job_cond;     ///< Signalled on a new batch and on termination
+  pthread_cond_t              done_cond;    ///< Signalled when the last job of a batch is done
+  pthread_t                  *threads;
+  int                         num_threads;
+  bool                        terminate;
+
+  /** Current batch. */
+  m2ap_encoder_pool_job_f     job_f;
+  uint8_t                    *jobs;
+  size_t                      job_size;
+  int                         num_jobs;
+  int                         next_job;
+  int                         num_done;
+  int                         num_failed;
+} m2ap_encoder_pool_t;
+
+static m2ap_encoder_pool_t m2ap_encoder_pool = {
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  .job_cond = PTHREAD_COND_INITIALIZER,
+  .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+//------------------------------------------------------------------------------
+/*
+ * Claim and run jobs of the current batch until none is left. Called with the mutex held, returns with the mutex held.
+ */
+static void m2ap_encoder_pool_work (void)
+{
+  while (m2ap_encoder_pool.next_job < m2ap_encoder_pool.num_jobs) {
+    void * const job = m2ap_encoder_pool.jobs + ((size_t)m2ap_encoder_pool.next_job++ * m2ap_encoder_pool.job_size);
+    m2ap_encoder_pool_job_f job_f = m2ap_encoder_pool.job_f;
+    pthread_mutex_unlock(&m2ap_encoder_pool.mutex);
+    int rc = job_f(job);
+    pthread_mutex_lock(&m2ap_encoder_pool.mutex);
+    if (rc)
+      m2ap_encoder_pool.num_failed++;
+    if (++m2ap_encoder_pool.num_done == m2ap_encoder_pool.num_jobs)
+      pthread_cond_signal(&m2ap_encoder_pool.done_cond);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *m2ap_encoder_pool_thread (__attribute__((unused)) void *args)
+{
+  pthread_mutex_lock(&m2ap_encoder_pool.mutex);
+  while (!m2ap_encoder_pool.terminate) {
+    if (m2ap_encoder_pool.next_job < m2ap_encoder_pool.num_jobs)
+      m2ap_encoder_pool_work();
+    else
+      pthread_cond_wait(&m2ap_encoder_pool.job_cond, &m2ap_encoder_pool.mutex);
+  }
+  pthread_mutex_unlock(&m2ap_encoder_pool.mutex);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+int m2ap_encoder_pool_init (const int num_threads)
+{
+  if (num_threads <= 0)
+    return 0;
+  m2ap_encoder_pool.threads = calloc(num_threads, sizeof(pthread_t));
+  if (!m2ap_encoder_pool.threads)
+    return -1;
+  m2ap_encoder_pool.terminate = false;
+  for (int i = 0; i < num_threads; i++) {
+    if (pthread_create(&m2ap_encoder_pool.threads[i], NULL, m2ap_encoder_pool_thread, NULL)) {
+      m2ap_encoder_pool_exit();
+      return -1;
+    }
+    m2ap_encoder_pool.num_threads++;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_encoder_pool_exit (void)
+{
+  pthread_mutex_lock(&m2ap_encoder_pool.mutex);
+  m2ap_encoder_pool.terminate = true;
+  pthread_cond_broadcast(&m2ap_encoder_pool.job_cond);
+  pthread_mutex_unlock(&m2ap_encoder_pool.mutex);
+  for (int i = 0; i < m2ap_encoder_pool.num_threads; i++) {
+    pthread_join(m2ap_encoder_pool.threads[i], NULL);
+  }
+  free(m2ap_encoder_pool.threads);
+  m2ap_encoder_pool.threads = NULL;
+  m2ap_encoder_pool.num_threads = 0;
+}
+
+//------------------------------------------------------------------------------
+int m2ap_encoder_pool_num_threads (void)
+{
+  return m2ap_encoder_pool.num_threads;
+}
+
+//------------------------------------------------------------------------------
+int m2ap_encoder_pool_run (m2ap_encoder_pool_job_f job_f, void * const jobs, const int num_jobs, const size_t job_size)
+{
+  int num_failed = 0;
+
+  if (!m2ap_encoder_pool.num_threads || num_jobs <= 1) {
+    /** Nothing to share. */
+    for (int i = 0; i < num_jobs; i++) {
+      if (job_f((uint8_t*)jobs + ((size_t)i * job_size)))
+        num_failed++;
+    }
+    return num_failed;
+  }
+
+  pthread_mutex_lock(&m2ap_encoder_pool.mutex);
+  m2ap_encoder_pool.job_f = job_f;
+  m2ap_encoder_pool.jobs = (uint8_t*)jobs;
+  m2ap_encoder_pool.job_size = job_size;
+  m2ap_encoder_pool.num_jobs = num_jobs;
+  m2ap_encoder_pool.next_job = 0;
+  m2ap_encoder_pool.num_done = 0;
+  m2ap_encoder_pool.num_failed = 0;
+  pthread_cond_broadcast(&m2ap_encoder_pool.job_cond);
+  /** The calling thread works on the batch, too. */
+  m2ap_encoder_pool_work();
+  while (m2ap_encoder_pool.num_done < m2ap_encoder_pool.num_jobs)
+    pthread_cond_wait(&m2ap_encoder_pool.done_cond, &m2ap_encoder_pool.mutex);
+  num_failed = m2ap_encoder_pool.num_failed;
+  m2ap_encoder_pool.num_jobs = 0;
+  m2ap_encoder_pool.next_job = 0;
+  m2ap_encoder_pool.jobs = NULL;
+  pthread_mutex_unlock(&m2ap_encoder_pool.mutex);
+  return num_failed;
+}
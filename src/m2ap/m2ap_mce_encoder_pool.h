@@ -0,0 +1,59 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_mce_encoder_pool.h
+  \brief Optional pool of encoder threads for the M2AP task.
+  The M2AP task hands a batch of independent encoding jobs to the pool and blocks until all of them are done,
+  working on the batch itself in the meantime. The results stay in the job structures, so the M2AP task sends
+  them in job order, independent of which thread encoded which job. Without encoder threads, the jobs are run
+  on the calling thread.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#ifndef FILE_M2AP_MCE_ENCODER_POOL_SEEN
+#define FILE_M2AP_MCE_ENCODER_POOL_SEEN
+
+#include <stddef.h>
+
+/** A job must only read shared state, which the caller does not change while the batch is running. Returns 0 on success. */
+typedef int (*m2ap_encoder_pool_job_f)(void * const job);
+
+/** \brief Start the encoder threads (none if num_threads is 0).
+ **/
+int m2ap_encoder_pool_init (const int num_threads);
+
+/** \brief Stop and join the encoder threads.
+ **/
+void m2ap_encoder_pool_exit (void);
+
+/** \brief Number of running encoder threads, the calling thread not included.
+ **/
+int m2ap_encoder_pool_num_threads (void);
+
+/** \brief Run job_f on each of the num_jobs jobs of size job_size, in parallel, and wait for all of them.
+ * Only a single thread may run batches.
+ * @return the number of failed jobs
+ **/
+int m2ap_encoder_pool_run (m2ap_encoder_pool_job_f job_f, void * const jobs, const int num_jobs, const size_t job_size);
+
+#endif /* FILE_M2AP_MCE_ENCODER_POOL_SEEN */
@@ -32,6 +32,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <pthread.h>
+#include <time.h>
 
 #include "3gpp_requirements_36.443.h"
 #include "bstrlib.h"
@@ -52,7 +53,9 @@
 #include "m2ap_mce_procedures.h"
 #include "m2ap_common.h"
 #include "m2ap_mce_encoder.h"
+#include "m2ap_mce_decoder.h"
 #include "m2ap_mce_mbms_sa.h"
+#include "m2ap_mce_retransmission.h"
 
 extern hash_table_ts_t 					g_m2ap_enb_coll; 	// SCTP Association ID association to M2AP eNB Reference;
 extern hash_table_ts_t 					g_m2ap_mbms_coll; 	// MCE MBMS M2AP ID association to MBMS Reference;
@@ -61,6 +64,25 @@ static const char * const m2_enb_state_str [] = {"M2AP_INIT", "M2AP_RESETTING",
 
 static int m2ap_generate_m2_setup_response (m2ap_enb_description_t * m2ap_enb_association, mbsfn_areas_t * mbsfn_areas);
 
+/**
+ * Admission of M2 Setup Requests. A token bucket limits the rate of admitted setups and the number of setups waiting
+ * for MCE_APP is limited. Rejected eNBs are handed out consecutive retry slots, one admission interval apart, which are
+ * rounded up to the next M2AP TimeToWait value, such that the retries of a reconnection storm are spread.
+ * Only accessed by the M2AP task.
+ */
+typedef struct m2ap_m2_setup_admission_s {
+  double                tokens;
+  uint64_t              last_refill_ns;     ///< 0 until the first M2 Setup Request, which finds a full bucket
+  uint64_t              next_retry_ns;      ///< Retry slot handed to the last rejected eNB
+  uint32_t              num_pending;        ///< Admitted M2 Setups waiting for MCE_APP
+  uint64_t              num_admitted;
+  uint64_t              num_rejected;
+} m2ap_m2_setup_admission_t;
+
+static m2ap_m2_setup_admission_t m2ap_m2_setup_admission = {0};
+
+static const long m2ap_time_to_wait_s [] = {1, 2, 5, 10, 20, 60}; /**< Indexed by M2AP_TimeToWait_t. */
+
 //static int                              m2ap_mme_generate_ue_context_release_command (
 //    mbms_description_t * mbms_ref_p, mce_mbms_m2ap_id_t mce_mbms_m2ap_id, enum s1cause, m2ap_enb_description_t* enb_ref_p);
 
@@ -105,7 +127,7 @@ m2ap_mce_handle_message (
       || (pdu->present > M2AP_M2AP_PDU_PR_unsuccessfulOutcome)) {
     OAILOG_DEBUG (LOG_M2AP, "[SCTP %d] Either procedureCode %ld or direction %d exceed expected\n",
                assoc_id, pdu->choice.initiatingMessage.procedureCode, pdu->present);
-    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, pdu);
+    M2AP_MCE_FREE_DECODED_PDU(pdu);
     return -1;
   }
 
@@ -116,13 +138,13 @@ m2ap_mce_handle_message (
     OAILOG_DEBUG (LOG_M2AP, "[SCTP %d] No handler for procedureCode %ld in %s\n",
                assoc_id, pdu->choice.initiatingMessage.procedureCode,
                m2ap_direction2String[pdu->present]);
-    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, pdu);
+    M2AP_MCE_FREE_DECODED_PDU(pdu);
     return -1;
   }
 
   /* Calling the right handler */
   int ret = (*m2ap_messages_callback[pdu->choice.initiatingMessage.procedureCode][pdu->present - 1])(assoc_id, stream, pdu);
-  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_M2AP_M2AP_PDU, pdu);
+  M2AP_MCE_FREE_DECODED_PDU(pdu);
   return ret;
 }
 
@@ -222,6 +244,92 @@ m2ap_mce_generate_m2_setup_failure (
 //************************** Management procedures ***************************//
 ////////////////////////////////////////////////////////////////////////////////
 
+//------------------------------------------------------------------------------
+static uint64_t m2ap_m2_setup_admission_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Returns -1 if the M2 Setup Request may be processed, else the M2AP_TimeToWait value for the M2 Setup Failure.
+ */
+static long
+m2ap_m2_setup_admit (
+    const m2ap_enb_description_t * const m2ap_enb_association)
+{
+  uint32_t                                rate = 0;
+  uint32_t                                burst = 0;
+  uint32_t                                max_pending = 0;
+  uint64_t                                now_ns = 0;
+  uint64_t                                interval_ns = 0;
+  long                                    time_to_wait = M2AP_TimeToWait_v60s;
+
+  /** A repeated request of an admitted eNB is not counted twice. */
+  if (m2ap_enb_association && m2ap_enb_association->m2_setup_pending)
+    return -1;
+
+  mce_config_read_lock (&mce_config);
+  rate = mce_config.mbms.m2_setup_rate;
+  burst = mce_config.mbms.m2_setup_burst ? mce_config.mbms.m2_setup_burst : rate;
+  max_pending = mce_config.mbms.m2_setup_max_pending;
+  mce_config_unlock (&mce_config);
+
+  now_ns = m2ap_m2_setup_admission_now_ns();
+  if (rate) {
+    if (!m2ap_m2_setup_admission.last_refill_ns) {
+      m2ap_m2_setup_admission.tokens = burst;
+    } else {
+      m2ap_m2_setup_admission.tokens += (double)(now_ns - m2ap_m2_setup_admission.last_refill_ns) * rate / 1000000000.0;
+      if (m2ap_m2_setup_admission.tokens > burst)
+        m2ap_m2_setup_admission.tokens = burst;
+    }
+    m2ap_m2_setup_admission.last_refill_ns = now_ns;
+  }
+
+  if ((!max_pending || m2ap_m2_setup_admission.num_pending < max_pending)
+      && (!rate || m2ap_m2_setup_admission.tokens >= 1.0)) {
+    if (rate)
+      m2ap_m2_setup_admission.tokens -= 1.0;
+    m2ap_m2_setup_admission.num_admitted++;
+    return -1;
+  }
+
+  /**
+   * Hand out the next retry slot. Without a rate, assume that MCE_APP answers the pending setups within a second.
+   * Slots beyond the largest TimeToWait are not handed out, such that the slots do not drift after a long storm.
+   */
+  interval_ns = 1000000000ULL / (rate ? rate : max_pending);
+  if (m2ap_m2_setup_admission.next_retry_ns < now_ns)
+    m2ap_m2_setup_admission.next_retry_ns = now_ns;
+  if (m2ap_m2_setup_admission.next_retry_ns - now_ns + interval_ns <= m2ap_time_to_wait_s[M2AP_TimeToWait_v60s] * 1000000000ULL)
+    m2ap_m2_setup_admission.next_retry_ns += interval_ns;
+  for (long ttw = M2AP_TimeToWait_v1s; ttw <= M2AP_TimeToWait_v60s; ttw++) {
+    if (m2ap_m2_setup_admission.next_retry_ns - now_ns <= m2ap_time_to_wait_s[ttw] * 1000000000ULL) {
+      time_to_wait = ttw;
+      break;
+    }
+  }
+  m2ap_m2_setup_admission.num_rejected++;
+  OAILOG_WARNING (LOG_M2AP, "Rejecting M2 Setup Request with TimeToWait %lds (pending %u, admitted %lu, rejected %lu)\n",
+      m2ap_time_to_wait_s[time_to_wait], m2ap_m2_setup_admission.num_pending,
+      (unsigned long)m2ap_m2_setup_admission.num_admitted, (unsigned long)m2ap_m2_setup_admission.num_rejected);
+  return time_to_wait;
+}
+
+//------------------------------------------------------------------------------
+void
+m2ap_m2_setup_admission_release (
+    m2ap_enb_description_t * const m2ap_enb_association)
+{
+  if (m2ap_enb_association->m2_setup_pending) {
+    m2ap_enb_association->m2_setup_pending = false;
+    m2ap_m2_setup_admission.num_pending--;
+  }
+}
+
 //------------------------------------------------------------------------------
 int
 m2ap_mce_handle_m2_setup_request (
@@ -243,6 +351,7 @@ m2ap_mce_handle_m2_setup_request (
   char                                   *m2ap_enb_name = NULL;
   int                                     mbms_sa_ret = 0;
   uint16_t                                max_m2_enb_connected = 0;
+  long                                    time_to_wait = -1;
 
   DevAssert (pdu != NULL);
   container = &pdu->choice.initiatingMessage.value.choice.M2SetupRequest;
@@ -273,6 +382,14 @@ m2ap_mce_handle_m2_setup_request (
     OAILOG_FUNC_RETURN (LOG_M2AP, rc);
   }
 
+  /**
+   * Check the admission before processing the request, such that eNBs reconnecting all at once are not all set up at once.
+   */
+  if ((time_to_wait = m2ap_m2_setup_admit (m2ap_is_enb_assoc_id_in_list (assoc_id))) >= 0) {
+    rc = m2ap_mce_generate_m2_setup_failure (assoc_id, stream, M2AP_Cause_PR_misc, M2AP_CauseMisc_control_processing_overload, time_to_wait);
+    OAILOG_FUNC_RETURN (LOG_M2AP, rc);
+  }
+
   shared_log_queue_item_t *  context = NULL;
   OAILOG_MESSAGE_START (OAILOG_LEVEL_DEBUG, LOG_M2AP, (&context), "New m2 setup request incoming from ");
 
@@ -329,7 +446,7 @@ m2ap_mce_handle_m2_setup_request (
    * Request procedure with the appropriate cause value, e.g, “Unknown PLMN”.
    */
   M2AP_FIND_PROTOCOLIE_BY_ID(M2AP_M2SetupRequest_IEs_t, ie_enb_mbms_configuration_per_cell, container,
-		  M2AP_ProtocolIE_ID_id_ENB_MBMS_Configuration_data_Item, true);
+		  M2AP_ProtocolIE_ID_id_ENB_MBMS_Configuration_data_List, true);
 
   M2AP_ENB_MBMS_Configuration_data_List_t	* enb_mbms_cfg_data_list = &ie_enb_mbms_configuration_per_cell->value.choice.ENB_MBMS_Configuration_data_List;
   /** Take the first cell. */
@@ -338,8 +455,10 @@ m2ap_mce_handle_m2_setup_request (
     rc =  m2ap_mce_generate_m2_setup_failure (assoc_id, stream, M2AP_Cause_PR_misc, M2AP_CauseMisc_unspecified, M2AP_TimeToWait_v20s);
     OAILOG_FUNC_RETURN (LOG_M2AP, rc);
   }
-  M2AP_ENB_MBMS_Configuration_data_Item_t 	* m2ap_enb_mbms_cfg_item = enb_mbms_cfg_data_list->list.array[0];
-  DevAssert(m2ap_enb_mbms_cfg_item);
+  /** The list elements are single IE containers, holding the item. */
+  M2AP_ENB_MBMS_Configuration_data_ItemIEs_t * m2ap_enb_mbms_cfg_item_ies = (M2AP_ENB_MBMS_Configuration_data_ItemIEs_t *)enb_mbms_cfg_data_list->list.array[0];
+  DevAssert(m2ap_enb_mbms_cfg_item_ies);
+  M2AP_ENB_MBMS_Configuration_data_Item_t 	* m2ap_enb_mbms_cfg_item = &m2ap_enb_mbms_cfg_item_ies->value.choice.ENB_MBMS_Configuration_data_Item;
   mbms_sa_ret = m2ap_mce_compare_mbms_enb_configuration_item(m2ap_enb_mbms_cfg_item);
 
   /*
@@ -420,7 +539,12 @@ m2ap_mce_handle_m2_setup_request (
   /**
    * For the case of a new eNB, forward the M2 Setup Request to MCE_APP.
    * It needs the information to create and manage MBSFN areas.
+   * The setup stays pending for the admission until MCE_APP answers or the eNB is removed.
    */
+  if (!m2ap_enb_association->m2_setup_pending) {
+    m2ap_enb_association->m2_setup_pending = true;
+    m2ap_m2_setup_admission.num_pending++;
+  }
   m2ap_mce_itti_m3ap_enb_setup_request(assoc_id, m2ap_enb_id, &m2ap_enb_association->mbms_sa_list);
   OAILOG_FUNC_RETURN (LOG_M2AP, rc);
 }
@@ -531,6 +655,7 @@ int m2ap_handle_m3ap_enb_setup_res(itti_m3ap_enb_setup_res_t * m3ap_enb_setup_re
     OAILOG_ERROR (LOG_M2AP, "No eNB association found for %d. Cannot trigger M2 setup response. \n", m3ap_enb_setup_res->sctp_assoc);
     OAILOG_FUNC_RETURN(LOG_M2AP, rc);
   }
+  m2ap_m2_setup_admission_release(m2ap_enb_association);
 
   /** Nothing extra is to be done for the MBSFNs. MCE_APP takes care of it. */
   if(!m3ap_enb_setup_res->mbsfn_areas.num_mbsfn_areas){
@@ -544,7 +669,7 @@ int m2ap_handle_m3ap_enb_setup_res(itti_m3ap_enb_setup_res_t * m3ap_enb_setup_re
   /**
    * Update the MBSFN and MBMS areas.
    */
-  m2ap_enb_association->local_mbms_area = m3ap_enb_setup_res->local_mbms_area;
+  m2ap_set_enb_local_mbms_area(m2ap_enb_association, m3ap_enb_setup_res->local_mbms_area);
   for(int num_mbsfn = 0; num_mbsfn < m3ap_enb_setup_res->mbsfn_areas.num_mbsfn_areas; num_mbsfn++) {
   	/** Set it in the M2 ENB Description element. */
   	m2ap_enb_association->mbsfn_area_ids.mbsfn_area_id[m2ap_enb_association->mbsfn_area_ids.num_mbsfn_area_ids] =
@@ -590,6 +715,7 @@ m2ap_mce_handle_mbms_session_start_response (
 		  M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID, true);
   mce_mbms_m2ap_id = ie->value.choice.MCE_MBMS_M2AP_ID;
   mce_mbms_m2ap_id &= MCE_MBMS_M2AP_ID_MASK;
+  m2ap_timer_remove(assoc_id, M2AP_ProcedureCode_id_sessionStart, mce_mbms_m2ap_id);
 
   M2AP_FIND_PROTOCOLIE_BY_ID(M2AP_SessionStartResponse_Ies_t, ie, container,
                              M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID, true);
@@ -643,6 +769,7 @@ m2ap_mce_handle_mbms_session_start_failure (
 		  M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID, true);
   mce_mbms_m2ap_id = ie->value.choice.MCE_MBMS_M2AP_ID;
   mce_mbms_m2ap_id &= MCE_MBMS_M2AP_ID_MASK;
+  m2ap_timer_remove(assoc_id, M2AP_ProcedureCode_id_sessionStart, mce_mbms_m2ap_id);
 
   if ((mbms_ref_p = m2ap_is_mbms_mce_m2ap_id_in_list((uint32_t) mce_mbms_m2ap_id)) == NULL) {
     OAILOG_ERROR(LOG_M2AP, "No MBMS is attached to this MCE MBMS M2AP id: " MCE_MBMS_M2AP_ID_FMT "\n", mce_mbms_m2ap_id);
@@ -683,6 +810,7 @@ m2ap_mce_handle_mbms_session_stop_response (
 	M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID, true);
   mce_mbms_m2ap_id = ie->value.choice.MCE_MBMS_M2AP_ID;
   mce_mbms_m2ap_id &= MCE_MBMS_M2AP_ID_MASK;
+  m2ap_timer_remove(assoc_id, M2AP_ProcedureCode_id_sessionStop, mce_mbms_m2ap_id);
 
   M2AP_FIND_PROTOCOLIE_BY_ID(M2AP_SessionStopResponse_Ies_t, ie, container,
 	M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID, true);
@@ -721,6 +849,7 @@ m2ap_mce_handle_mbms_session_update_response (
 	M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID, true);
   mce_mbms_m2ap_id = ie->value.choice.MCE_MBMS_M2AP_ID;
   mce_mbms_m2ap_id &= MCE_MBMS_M2AP_ID_MASK;
+  m2ap_timer_remove(assoc_id, M2AP_ProcedureCode_id_sessionUpdate, mce_mbms_m2ap_id);
 
   M2AP_FIND_PROTOCOLIE_BY_ID(M2AP_SessionUpdateResponse_Ies_t, ie, container,
 	M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID, true);
@@ -765,6 +894,7 @@ m2ap_mce_handle_mbms_session_update_failure (
 		  M2AP_ProtocolIE_ID_id_MCE_MBMS_M2AP_ID, true);
   mce_mbms_m2ap_id = ie->value.choice.MCE_MBMS_M2AP_ID;
   mce_mbms_m2ap_id &= MCE_MBMS_M2AP_ID_MASK;
+  m2ap_timer_remove(assoc_id, M2AP_ProcedureCode_id_sessionUpdate, mce_mbms_m2ap_id);
 
   M2AP_FIND_PROTOCOLIE_BY_ID(M2AP_SessionUpdateResponse_Ies_t, ie, container,
 	M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID, true);
@@ -803,7 +933,7 @@ m2ap_mce_handle_mbms_scheduling_information_response (
   enb_mbms_m2ap_id_t                 enb_mbms_m2ap_id = 0;
   OAILOG_FUNC_IN (LOG_M2AP);
 
-
+  m2ap_timer_remove(assoc_id, M2AP_ProcedureCode_id_mbmsSchedulingInformation, INVALID_MCE_MBMS_M2AP_ID);
   OAILOG_FUNC_RETURN (LOG_M2AP, rc);
 }
 
@@ -1128,6 +1258,8 @@ m2ap_handle_new_association (
     if (HASH_TABLE_OK != hash_rc) {
       OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
     }
+    /** No MBMS Service Areas yet, only index the eNB in the default local MBMS area. */
+    m2ap_enb_index_add(m2ap_enb_association);
   } else if ((m2ap_enb_association->m2_state == M2AP_SHUTDOWN) || (m2ap_enb_association->m2_state == M2AP_RESETING)) {
     OAILOG_WARNING(LOG_M2AP, "Received new association request on an association that is being %s, ignoring",
                    m2_enb_state_str[m2ap_enb_association->m2_state]);
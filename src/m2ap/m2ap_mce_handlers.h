@@ -56,6 +56,10 @@ int m2ap_mce_handle_message(const sctp_assoc_id_t assoc_id, const sctp_stream_id
 int m2ap_mce_handle_m2_setup_request(const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream,
                                      M2AP_M2AP_PDU_t *pdu);
 
+/** \brief Release the admission of a pending M2 Setup of the eNB, once MCE_APP answered or the eNB is removed.
+ **/
+void m2ap_m2_setup_admission_release (m2ap_enb_description_t * const m2ap_enb_association);
+
 //------------------------------------------------------------------------------
 int m2ap_handle_m3ap_enb_setup_res(itti_m3ap_enb_setup_res_t * m3ap_enb_setup_res);
 
@@ -35,6 +35,7 @@
 #include "m2ap_mce_itti_messaging.h"
 
 #include "log.h"
+#include "dynamic_memory_check.h"
 #include "assertions.h"
 #include "intertask_interface.h"
 
@@ -59,6 +60,36 @@ m2ap_mce_itti_send_sctp_request (
   return itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
 }
 
+//------------------------------------------------------------------------------
+/*
+ * Fan-out of the same payload, sent by the SCTP task to all associations in one pass.
+ */
+int
+m2ap_mce_itti_send_sctp_multi_request (
+  STOLEN_REF bstring *payload,
+  const int num_assocs,
+  const sctp_assoc_id_t * const assoc_ids,
+  const sctp_stream_id_t stream)
+{
+  MessageDef                             *message_p = NULL;
+
+  if (num_assocs <= 0) {
+    bdestroy_wrapper (payload);
+    return RETURNok;
+  }
+  message_p = itti_alloc_new_message (TASK_M2AP, SCTP_DATA_MULTI_REQ);
+  SCTP_DATA_MULTI_REQ (message_p).dests = calloc (num_assocs, sizeof (sctp_data_dest_t));
+  DevAssert (SCTP_DATA_MULTI_REQ (message_p).dests);
+  for (int i = 0; i < num_assocs; i++) {
+    SCTP_DATA_MULTI_REQ (message_p).dests[i].assoc_id = assoc_ids[i];
+    SCTP_DATA_MULTI_REQ (message_p).dests[i].stream = stream;
+  }
+  SCTP_DATA_MULTI_REQ (message_p).nb_dests = num_assocs;
+  SCTP_DATA_MULTI_REQ (message_p).payload = *payload;
+  *payload = NULL;
+  return itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
+}
+
 //------------------------------------------------------------------------------
 void m2ap_mce_itti_m3ap_enb_setup_request(
   const sctp_assoc_id_t   assoc_id,
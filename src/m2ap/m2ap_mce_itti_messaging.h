@@ -37,6 +37,12 @@ int m2ap_mce_itti_send_sctp_request(STOLEN_REF bstring *payload,
                                     const sctp_stream_id_t stream,
                                     const mce_mbms_m2ap_id_t mbms_id);
 
+//------------------------------------------------------------------------------
+int m2ap_mce_itti_send_sctp_multi_request(STOLEN_REF bstring *payload,
+                                          const int num_assocs,
+                                          const sctp_assoc_id_t * const assoc_ids,
+                                          const sctp_stream_id_t stream);
+
 //------------------------------------------------------------------------------
 void m2ap_mce_itti_m3ap_enb_setup_request(
   const sctp_assoc_id_t   assoc_id,
@@ -31,6 +31,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <time.h>
+#include <math.h>
 
 #include "bstrlib.h"
 
@@ -51,6 +53,8 @@
 #include "m2ap_mce.h"
 #include "m2ap_mce_itti_messaging.h"
 #include "m2ap_mce_procedures.h"
+#include "m2ap_mce_encoder_pool.h"
+#include "m2ap_mce_retransmission.h"
 
 
 /* Every time a new MBMS service is associated, increment this variable.
@@ -67,10 +71,53 @@ extern hash_table_ts_t 					g_m2ap_enb_coll; 	// SCTP Association ID association
 /****************************************************************************/
 
 static void m2ap_update_mbms_service_context(const mce_mbms_m2ap_id_t mce_mbms_m2ap_id);
-static int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mbms_m2ap_id, const uint8_t num_m2ap_enbs, m2ap_enb_description_t ** m2ap_enb_descriptions);
-static int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id, sctp_assoc_id_t sctp_assoc_id);
-static int m2ap_mbms_scheduling_cluster(const uint8_t num_m2_enb_mbms_area, const m2ap_enb_description_t** const m2ap_enb_p_elements, const uint8_t num_mbms_area, const mbsfn_areas_t * const mbsfn_cluster_global, const mbsfn_areas_t * const mbsfn_cluster_local, const long mcch_rep_abs_rf);
-static int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_enb_description, mbsfn_area_cfg_t **mbsfn_area_cfg, const uint8_t num_mbsfn_area_per_enb, long mcch_rep_abs_rf);
+static int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mbms_m2ap_id, const int num_m2ap_enbs, m2ap_enb_description_t ** m2ap_enb_descriptions);
+static int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id, const int num_m2ap_enbs, m2ap_enb_description_t ** m2ap_enb_descriptions);
+static int m2ap_encode_mbms_session_update_request(mbms_description_t * const mbms_ref, const enb_mbms_m2ap_id_t enb_mbms_m2ap_id, bstring * payload);
+static int m2ap_locate_encoded_value(const_bstring payload, const_bstring probe, const uint8_t * const value, const uint8_t * const probe_value, const int value_length);
+static int m2ap_mbms_scheduling_cluster(const int num_m2_enb_mbms_area, const m2ap_enb_description_t** const m2ap_enb_p_elements, const uint8_t num_mbms_area, const mbsfn_areas_t * const mbsfn_cluster_global, const mbsfn_areas_t * const mbsfn_cluster_local, const long mcch_rep_abs_rf);
+static int m2ap_generate_mbms_scheduling_information(mbsfn_area_cfg_t ** const mbsfn_area_cfgs, const int num_mbsfn_area_per_enb, const uint8_t mcch_update_time, bstring * payload);
+static void m2ap_mbms_scheduling_cache_evict(void);
+
+/**
+ * M2 eNBs of an MBMS area, which are scheduled with the same MBSFN area configurations and thus receive byte-identical MBMS Scheduling Information.
+ * The MBSFN area configuration references point into the received M3AP message, so equal references mean equal content.
+ * Groups missing in the cache are encoding jobs for the M2AP encoder pool, which only read the MBSFN area configurations and fill the payload.
+ */
+typedef struct m2ap_mbms_scheduling_group_s {
+  int                         num_mbsfn_area_cfgs;
+  mbsfn_area_cfg_t          **mbsfn_area_cfgs;
+  int                         num_m2_enbs;
+  bstring                     key;                      ///< Encoded fields of the MBSFN area configurations, see m2ap_mbms_scheduling_key
+  hash_key_t                  digest;
+  uint8_t                     mcch_update_time;
+  bool                        cached;                   ///< Payload copied from the cache
+  bstring                     payload;
+  int                         mcch_update_time_offset;  ///< Octet of the MCCH Update Time in the payload, -1 if it could not be located
+} m2ap_mbms_scheduling_group_t;
+
+static bstring m2ap_mbms_scheduling_key(mbsfn_area_cfg_t ** const mbsfn_area_cfgs, const int num_mbsfn_area_per_enb);
+static hash_key_t m2ap_mbms_scheduling_digest(const_bstring const key);
+static bool m2ap_mbms_scheduling_cache_get(m2ap_mbms_scheduling_group_t * const mbms_scheduling_group);
+static void m2ap_mbms_scheduling_cache_put(const m2ap_mbms_scheduling_group_t * const mbms_scheduling_group);
+static int m2ap_mbms_scheduling_encode_group(void * const mbms_scheduling_group);
+
+/**
+ * Encoded MBMS Scheduling Information of the last MBMS scheduling period, keyed by a digest of the MBSFN area configuration fields it was encoded from.
+ * With unchanged MBSFN area configurations, only the MCCH Update Time changes between MCCH modification periods.
+ * It is patched into a copy of the cached payload, instead of encoding the message again. Only accessed by the M2AP task.
+ */
+typedef struct m2ap_mbms_scheduling_cache_entry_s {
+  bstring                     key;                      ///< Source of the digest, compared on a hit against digest collisions
+  bstring                     payload;
+  int                         mcch_update_time_offset;  ///< Octet of the (octet-aligned) MCCH Update Time in the payload
+  uint64_t                    last_scheduling_period;   ///< Last MBMS scheduling period, in which the payload was used
+} m2ap_mbms_scheduling_cache_entry_t;
+
+static hash_table_ts_t                      m2ap_mbms_scheduling_cache = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains m2ap_mbms_scheduling_cache_entry_t, key is the MBSFN area configuration digest;
+static uint64_t                             m2ap_mbms_scheduling_period = 0;
+static m2ap_mbms_scheduling_cache_stats_t   m2ap_mbms_scheduling_cache_stats = {0};
+static m2ap_mbms_session_update_stats_t     m2ap_mbms_session_update_stats = {0};
 //------------------------------------------------------------------------------
 void
 m2ap_handle_mbms_session_start_request (
@@ -84,7 +131,7 @@ m2ap_handle_mbms_session_start_request (
    */
   uint8_t                              *buffer_p = NULL;
   uint32_t                              length = 0;
-  uint8_t								  							num_m2ap_enbs = 0;
+  int								  							num_m2ap_enbs = 0;
   mbms_description_t               		 *mbms_ref = NULL;
   mce_mbms_m2ap_id_t 					  				mce_mbms_m2ap_id 	= INVALID_MCE_MBMS_M2AP_ID;
   OAILOG_FUNC_IN (LOG_M2AP);
@@ -137,6 +184,7 @@ m2ap_handle_mbms_session_start_request (
    */
   memcpy((void*)&mbms_ref->mbms_bc.mbms_ip_mc_distribution,  (void*)&mbms_session_start_req_pP->mbms_bearer_tbc.mbms_ip_mc_dist, sizeof(mbms_ip_multicast_distribution_t));
   memcpy((void*)&mbms_ref->mbms_bc.eps_bearer_context.bearer_level_qos, (void*)&mbms_session_start_req_pP->mbms_bearer_tbc.bc_tbc.bearer_level_qos, sizeof(bearer_qos_t));
+  mce_mbms_m2ap_id = mbms_ref->mce_mbms_m2ap_id;
   /**
    * Check if a timer has been given, if so start the timer.
    * If not send immediately. MBMS Session start will be based on the absolute time and not on the MCCH modification/repetition periods.
@@ -164,7 +212,7 @@ m2ap_handle_mbms_session_start_request (
    * If it cannot be sent, we still keep the MBMS Service Description in the map.
    * The SCTP associations will only be removed with a successful response.
    */
-  m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id, num_m2ap_enbs, &m2ap_enb_p_elements);
+  m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id, num_m2ap_enbs, m2ap_enb_p_elements);
   OAILOG_FUNC_OUT(LOG_M2AP);
 }
 
@@ -196,9 +244,17 @@ m2ap_handle_mbms_session_update_request (
   }
 
   /**
-   * Cleared the MBMS service from eNBs with unmatching MBMS Service Area Id.
-   * We can continue with the update of the MBMS service.
+   * The M2AP MBMS Session Update only carries the MBMS Service Area and the TNL information.
+   * QoS (bitrate) changes only affect the MBMS scheduling of the MCE, and are signalled with the next MBMS Scheduling Information.
+   * Keep a pending flag, in case an earlier update is still waiting for its timer.
    */
+  if(mbms_ref->mbms_service_area_id != mbms_session_update_req_pP->new_mbms_service_area_id
+      || memcmp((void*)&mbms_ref->mbms_bc.mbms_ip_mc_distribution, (void*)&mbms_session_update_req_pP->mbms_bearer_tbc.mbms_ip_mc_dist, sizeof(mbms_ip_multicast_distribution_t))) {
+    mbms_ref->update_enbs = true;
+  } else if (!mbms_ref->update_enbs) {
+    OAILOG_INFO(LOG_M2AP, "No M2AP relevant changes for MBMS Service with TMGI " TMGI_FMT ". Only new M2AP eNBs of the MBMS SA will be started. \n",
+        TMGI_ARG(&mbms_session_update_req_pP->tmgi));
+  }
   memcpy((void*)&mbms_ref->mbms_bc.mbms_ip_mc_distribution,  (void*)&mbms_session_update_req_pP->mbms_bearer_tbc.mbms_ip_mc_dist, sizeof(mbms_ip_multicast_distribution_t));
   memcpy((void*)&mbms_ref->mbms_bc.eps_bearer_context.bearer_level_qos, (void*)&mbms_session_update_req_pP->mbms_bearer_tbc.bc_tbc.bearer_level_qos, sizeof(bearer_qos_t));
 
@@ -227,12 +283,18 @@ m2ap_handle_mbms_session_update_request (
   memset(m2ap_enb_p_elements, 0, (sizeof(m2ap_enb_description_t*) * mce_config.mbms.max_m2_enbs));
   mce_config_unlock (&mce_config);
   int num_m2ap_enbs_missing_new_mbms_sai = 0;
+  int num_m2ap_enbs_leaving = 0;
   m2ap_is_mbms_sai_not_in_list(mbms_session_update_req_pP->new_mbms_service_area_id, &num_m2ap_enbs_missing_new_mbms_sai, (m2ap_enb_description_t **)&m2ap_enb_p_elements);
-  if(num_m2ap_enbs_missing_new_mbms_sai){
+  /** Only the eNBs, which currently run the MBMS session, leave it. */
+  for(int i = 0; i < num_m2ap_enbs_missing_new_mbms_sai; i++){
+    if(HASH_TABLE_OK == hashtable_uint64_ts_is_key_exists(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, m2ap_enb_p_elements[i]->sctp_assoc_id))
+      m2ap_enb_p_elements[num_m2ap_enbs_leaving++] = m2ap_enb_p_elements[i];
+  }
+  if(num_m2ap_enbs_leaving){
 	  OAILOG_ERROR (LOG_M2AP, "(%d) M2AP eNBs not supporting new MBMS SAI " MBMS_SERVICE_AREA_ID_FMT" for the MBMS Service with TMGI " TMGI_FMT". "
-		"Stopping the MBMS session in the M2AP eNBs. \n", mbms_session_update_req_pP->new_mbms_service_area_id, TMGI_ARG(&mbms_session_update_req_pP->tmgi));
+		"Stopping the MBMS session in the M2AP eNBs. \n", num_m2ap_enbs_leaving, mbms_session_update_req_pP->new_mbms_service_area_id, TMGI_ARG(&mbms_session_update_req_pP->tmgi));
      /** Send an MBMS session stop and remove the association. */
-     for(int i = 0; i < num_m2ap_enbs_missing_new_mbms_sai; i++){
+     for(int i = 0; i < num_m2ap_enbs_leaving; i++){
        m2ap_generate_mbms_session_stop_request(mbms_ref->mce_mbms_m2ap_id, m2ap_enb_p_elements[i]->sctp_assoc_id);
        /** Remove the association and decrement the count. */
        m2ap_enb_p_elements[i]->nb_mbms_associated--; /**< We don't check for restart, since it is trigger due update. */
@@ -354,7 +416,9 @@ int m2ap_generate_mbms_session_stop_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
   }
 
   /** Check that an eNB-MBMS-ID exists. */
-  hashtable_uint64_ts_get (&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)sctp_assoc_id, (void *)&enb_mbms_m2ap_id);
+  uint64_t enb_mbms_m2ap_id_value = INVALID_ENB_MBMS_M2AP_ID;
+  if(HASH_TABLE_OK == hashtable_uint64_ts_get (&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)sctp_assoc_id, &enb_mbms_m2ap_id_value))
+    enb_mbms_m2ap_id = (enb_mbms_m2ap_id_t)enb_mbms_m2ap_id_value;
   if(enb_mbms_m2ap_id == INVALID_ENB_MBMS_M2AP_ID){
   	OAILOG_ERROR (LOG_M2AP, "No ENB MBMS M2AP ID could be retrieved. Cannot generate MBMS Session Stop Request. \n", enb_mbms_m2ap_id);
   	OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
@@ -400,6 +464,7 @@ int m2ap_generate_mbms_session_stop_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
   bstring b = blk2bstr(buffer_p, length);
   free(buffer_p);
   OAILOG_NOTICE (LOG_M2AP, "Send M2AP_MBMS_SESSION_STOP_REQUEST message MCE_MBMS_M2AP_ID = " MCE_MBMS_M2AP_ID_FMT "\n", mce_mbms_m2ap_id);
+  m2ap_timer_insert(m2ap_enb_description->sctp_assoc_id, M2AP_ProcedureCode_id_sessionStop, mce_mbms_m2ap_id, MBMS_SERVICE_SCTP_STREAM_ID, b);
   m2ap_mce_itti_send_sctp_request(&b, m2ap_enb_description->sctp_assoc_id, MBMS_SERVICE_SCTP_STREAM_ID, mce_mbms_m2ap_id);
   OAILOG_FUNC_RETURN (LOG_M2AP, RETURNok);
 }
@@ -450,6 +515,15 @@ m2ap_mce_handle_mbms_action_timer_expiry (void *arg)
 int m2ap_handle_m3ap_mbms_scheduling_info(itti_m3ap_mbms_scheduling_info_t * m3ap_mbms_scheduling_info){
 	OAILOG_FUNC_IN(LOG_M2AP);
 	int																		 rc = RETURNerror;
+	struct timespec                        cpu_start = {0};
+	struct timespec                        cpu_end   = {0};
+	struct timespec                        wall_start = {0};
+	struct timespec                        wall_end   = {0};
+	int                                    num_m2_enbs_scheduled = 0;
+	/** Measure the M2AP CPU time and the fan-out latency (encoding of all groups until the last SCTP request) of the MBMS scheduling period. */
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+	clock_gettime(CLOCK_MONOTONIC, &wall_start);
+	m2ap_mbms_scheduling_period++;
   /** Iterate through the MBSFN clusters. The M2AP eNB associations here should have an MBSFN Id. */
   for(int num_mbms_area = 0; num_mbms_area < (MME_CONFIG_MAX_LOCAL_MBMS_SERVICE_AREAS + 1); num_mbms_area++){
   	/** Take a cluster: Check if eNBs exist for the MBMS area. */
@@ -458,7 +532,7 @@ int m2ap_handle_m3ap_mbms_scheduling_info(itti_m3ap_mbms_scheduling_info_t * m3a
     	OAILOG_DEBUG(LOG_M2AP, "No MBSFN areas scheduled for for MBMS area (%d). Skipping.. \n", num_mbms_area);
     	continue;
     }
-  	uint8_t num_m2_enb_mbms_area = 0;
+  	int num_m2_enb_mbms_area = 0;
   	mce_config_read_lock (&mce_config);
     m2ap_enb_description_t *			         m2ap_enb_p_elements[mce_config.mbms.max_m2_enbs];
     memset(m2ap_enb_p_elements, 0, (sizeof(m2ap_enb_description_t*) * mce_config.mbms.max_m2_enbs));
@@ -481,12 +555,69 @@ int m2ap_handle_m3ap_mbms_scheduling_info(itti_m3ap_mbms_scheduling_info_t * m3a
     {
     	DevMessage("Could not generate MBMS scheduling information for MBMS area " + num_mbms_area);
     }
+    num_m2_enbs_scheduled += num_m2_enb_mbms_area;
     OAILOG_INFO(LOG_M2AP, "Successfully handled MBMS Scheduling for MBMS area (%d) for M2 eNBs.\n", num_mbms_area);
   }
-  OAILOG_INFO(LOG_M2AP, "Successfully handled MBMS scheduling for all MBMS areas. \n");
+  /** Remove the payloads of MBSFN area configurations, which are not scheduled anymore. */
+  m2ap_mbms_scheduling_cache_evict();
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+  clock_gettime(CLOCK_MONOTONIC, &wall_end);
+  OAILOG_INFO(LOG_M2AP, "Successfully handled MBMS scheduling for all MBMS areas (%d M2 eNBs) in %ld us (%ld us M2AP CPU time) with (%d) M2AP encoder threads. "
+      "Scheduling cache hits (%lu), misses (%lu), uncacheable (%lu), evictions (%lu). \n",
+      num_m2_enbs_scheduled, ((wall_end.tv_sec - wall_start.tv_sec) * 1000000L) + ((wall_end.tv_nsec - wall_start.tv_nsec) / 1000L),
+      ((cpu_end.tv_sec - cpu_start.tv_sec) * 1000000L) + ((cpu_end.tv_nsec - cpu_start.tv_nsec) / 1000L), m2ap_encoder_pool_num_threads(),
+      m2ap_mbms_scheduling_cache_stats.num_hits, m2ap_mbms_scheduling_cache_stats.num_misses,
+      m2ap_mbms_scheduling_cache_stats.num_uncacheable, m2ap_mbms_scheduling_cache_stats.num_evictions);
   OAILOG_FUNC_RETURN(LOG_M2AP, RETURNok);
 }
 
+//------------------------------------------------------------------------------
+static void
+m2ap_free_mbms_scheduling_cache_entry (
+  void ** entry_pp)
+{
+  m2ap_mbms_scheduling_cache_entry_t   *entry = NULL;
+  if (*entry_pp) {
+    entry = (m2ap_mbms_scheduling_cache_entry_t*)(*entry_pp);
+    bdestroy_wrapper(&entry->key);
+    bdestroy_wrapper(&entry->payload);
+    free_wrapper(entry_pp);
+  }
+}
+
+//------------------------------------------------------------------------------
+int m2ap_mbms_scheduling_cache_init(void)
+{
+  /** One entry per scheduling group, there are not more groups than M2 eNBs. */
+  bstring bs1 = bfromcstr("m2ap_mbms_scheduling_cache");
+  hash_table_ts_t* h = hashtable_ts_init (&m2ap_mbms_scheduling_cache, mce_config.mbms.max_m2_enbs, NULL, m2ap_free_mbms_scheduling_cache_entry, bs1);
+  bdestroy_wrapper (&bs1);
+  if (!h) return RETURNerror;
+  m2ap_mbms_scheduling_period = 0;
+  memset(&m2ap_mbms_scheduling_cache_stats, 0, sizeof(m2ap_mbms_scheduling_cache_stats));
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_mbms_scheduling_cache_exit(void)
+{
+  if (hashtable_ts_destroy(&m2ap_mbms_scheduling_cache) != HASH_TABLE_OK) {
+    OAILOG_ERROR(LOG_M2AP, "An error occurred while destroying the MBMS Scheduling Information cache. \n");
+  }
+}
+
+//------------------------------------------------------------------------------
+void m2ap_mbms_scheduling_cache_get_stats(m2ap_mbms_scheduling_cache_stats_t * const stats)
+{
+  *stats = m2ap_mbms_scheduling_cache_stats;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_mbms_session_update_get_stats(m2ap_mbms_session_update_stats_t * const stats)
+{
+  *stats = m2ap_mbms_session_update_stats;
+}
+
 
 /****************************************************************************/
 /*********************  L O C A L    F U N C T I O N S  *********************/
@@ -531,57 +662,87 @@ void m2ap_update_mbms_service_context(const mce_mbms_m2ap_id_t mce_mbms_m2ap_id)
 	OAILOG_FUNC_OUT (LOG_M2AP);
   }
 
-  /** Update all eNBs, which are already in the MBMS Service. */
+  /**
+   * Split the eNBs of the MBMS Service Area into the ones already running the MBMS session and the new ones.
+   * The running ones only need an MBMS Session Update, if the MBMS Service Area or the TNL information changed.
+   */
+  int num_m2ap_enbs_update = 0;
+  int num_m2ap_enbs_start = 0;
   for(int i = 0; i < num_m2ap_enbs_new_mbms_sai; i++) {
-    /** Get the eNB from the SCTP association. */
 	m2ap_enb_description_t * m2ap_enb_ref = m2ap_enb_p_elements[i];
-	hashtable_rc_t h_rc = hashtable_uint64_ts_is_key_exists(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, m2ap_enb_ref->sctp_assoc_id);
-	if(HASH_TABLE_OK == h_rc) {
-	  /** eNB is already in the list, update it. */
-	  int rc = m2ap_generate_mbms_session_update_request(mbms_ref->mce_mbms_m2ap_id, m2ap_enb_ref->sctp_assoc_id);
-	  if(rc != RETURNok) {
-	    OAILOG_ERROR(LOG_M2AP, "Error updating M2AP eNB with SCTP Assoc ID (%d) for the updated MBMS Service with TMGI " TMGI_FMT". "
-	    "Removing the association.\n", m2ap_enb_ref->sctp_assoc_id, TMGI_ARG(&mbms_ref->tmgi));
-	    m2ap_generate_mbms_session_stop_request(mbms_ref->mce_mbms_m2ap_id, m2ap_enb_ref->sctp_assoc_id);
-	    /** Remove the hash key, which should also update the eNB. */
-	    hashtable_uint64_ts_free(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id);
-	    if(m2ap_enb_ref->nb_mbms_associated)
-	      m2ap_enb_ref->nb_mbms_associated--;
-	    OAILOG_ERROR(LOG_M2AP, "Removed association after erroneous update.\n");
+	if(HASH_TABLE_OK == hashtable_uint64_ts_is_key_exists(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, m2ap_enb_ref->sctp_assoc_id)) {
+	  m2ap_enb_p_elements[num_m2ap_enbs_update++] = m2ap_enb_ref;
+	} else {
+	  new_mbms_sai_m2ap_enb_p_elements[num_m2ap_enbs_start++] = m2ap_enb_ref;
+	}
+  }
+
+  if(num_m2ap_enbs_update && mbms_ref->update_enbs) {
+	if(m2ap_generate_mbms_session_update_request(mbms_ref->mce_mbms_m2ap_id, num_m2ap_enbs_update, m2ap_enb_p_elements) != RETURNok) {
+	  OAILOG_ERROR(LOG_M2AP, "Error updating (%d) M2AP eNBs for the updated MBMS Service with TMGI " TMGI_FMT". Removing the associations.\n",
+		  num_m2ap_enbs_update, TMGI_ARG(&mbms_ref->tmgi));
+	  for(int i = 0; i < num_m2ap_enbs_update; i++) {
+		m2ap_enb_description_t * m2ap_enb_ref = m2ap_enb_p_elements[i];
+		m2ap_generate_mbms_session_stop_request(mbms_ref->mce_mbms_m2ap_id, m2ap_enb_ref->sctp_assoc_id);
+		/** Remove the hash key, which should also update the eNB. */
+		hashtable_uint64_ts_free(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id);
+		if(m2ap_enb_ref->nb_mbms_associated)
+		  m2ap_enb_ref->nb_mbms_associated--;
 	  }
-	  OAILOG_INFO(LOG_M2AP, "Successfully updated eNB with SCTP-Assoc (%d) for MBMS Service " MCE_MBMS_M2AP_ID_FMT " with updated MBMS SAI (%d).\n",
-			  m2ap_enb_ref->sctp_assoc_id, mbms_ref->mce_mbms_m2ap_id, mbms_ref->mbms_service_area_id);
-	  /** continue. */
+	  OAILOG_ERROR(LOG_M2AP, "Removed associations after erroneous update.\n");
+	}
+  }
+  if(num_m2ap_enbs_start) {
+	/** The MBMS Session Start has no eNB specific content and is encoded once for all new eNBs. */
+	if(m2ap_generate_mbms_session_start_request(mbms_ref->mce_mbms_m2ap_id, num_m2ap_enbs_start, new_mbms_sai_m2ap_enb_p_elements) == RETURNok) {
+	  OAILOG_INFO(LOG_M2AP, "Successfully adding (%d) new eNBs for MBMS Service " MCE_MBMS_M2AP_ID_FMT " with updated MBMS SAI (%d).\n",
+		  num_m2ap_enbs_start, mbms_ref->mce_mbms_m2ap_id, mbms_ref->mbms_service_area_id);
 	} else {
-		int rc = m2ap_generate_mbms_session_start_request(mbms_ref->mce_mbms_m2ap_id, 1, &m2ap_enb_ref); // todo: test if this works..
-		/** continue. */
-		if(rc == RETURNok) {
-		  OAILOG_INFO(LOG_M2AP, "Successfully adding new eNB with SCTP-Assoc (%d) for MBMS Service " MCE_MBMS_M2AP_ID_FMT " with updated MBMS SAI (%d).\n",
-				  m2ap_enb_ref->sctp_assoc_id, mbms_ref->mce_mbms_m2ap_id, mbms_ref->mbms_service_area_id);
-		} else {
-		  OAILOG_ERROR(LOG_M2AP, "Error adding new NB with SCTP-Assoc (%d) for MBMS Service " MCE_MBMS_M2AP_ID_FMT " with updated MBMS SAI (%d).\n",
-				  m2ap_enb_ref->sctp_assoc_id, mbms_ref->mce_mbms_m2ap_id, mbms_ref->mbms_service_area_id);
-		}
+	  OAILOG_ERROR(LOG_M2AP, "Error adding (%d) new eNBs for MBMS Service " MCE_MBMS_M2AP_ID_FMT " with updated MBMS SAI (%d).\n",
+		  num_m2ap_enbs_start, mbms_ref->mce_mbms_m2ap_id, mbms_ref->mbms_service_area_id);
 	}
   }
+  /**
+   * Stopped (leaving) and started (joining) eNBs cost the same as with a stop/start cycle.
+   * A stop/start cycle would have sent an MBMS Session Stop and Start to each of the remaining eNBs.
+   */
+  const int num_m2ap_enbs_updated = mbms_ref->update_enbs ? num_m2ap_enbs_update : 0;
+  m2ap_mbms_session_update_stats.num_updates_sent += num_m2ap_enbs_updated;
+  m2ap_mbms_session_update_stats.num_enbs_unchanged += (num_m2ap_enbs_update - num_m2ap_enbs_updated);
+  m2ap_mbms_session_update_stats.num_messages_saved += (2 * num_m2ap_enbs_update) - num_m2ap_enbs_updated;
+  OAILOG_INFO(LOG_M2AP, "Updated MBMS Service " MCE_MBMS_M2AP_ID_FMT " with MBMS SAI (%d): (%d) MBMS Session Updates, (%d) unchanged eNBs, (%d) MBMS Session Starts. "
+	  "Saved (%d) M2AP messages against a stop/start cycle (total %lu). \n", mbms_ref->mce_mbms_m2ap_id, mbms_ref->mbms_service_area_id,
+	  num_m2ap_enbs_updated, num_m2ap_enbs_update - num_m2ap_enbs_updated, num_m2ap_enbs_start,
+	  (2 * num_m2ap_enbs_update) - num_m2ap_enbs_updated, m2ap_mbms_session_update_stats.num_messages_saved);
+  mbms_ref->update_enbs = false;
   OAILOG_FUNC_OUT(LOG_M2AP);
 }
 
 //------------------------------------------------------------------------------
 static
-int m2ap_mbms_scheduling_cluster(const uint8_t num_m2_enb_mbms_area, const m2ap_enb_description_t** const m2ap_enb_p_elements,
+int m2ap_mbms_scheduling_cluster(const int num_m2_enb_mbms_area, const m2ap_enb_description_t** const m2ap_enb_p_elements,
 		const uint8_t num_mbms_area, const mbsfn_areas_t * const mbsfn_cluster_global, const mbsfn_areas_t * const mbsfn_cluster_local, const long mcch_rep_abs_rf){
+	m2ap_mbms_scheduling_group_t  mbms_scheduling_groups[num_m2_enb_mbms_area ? num_m2_enb_mbms_area : 1];
+	int                           m2_enb_group[num_m2_enb_mbms_area ? num_m2_enb_mbms_area : 1];
+	int                           num_groups = 0;
+	int                           rc = RETURNok;
 
 	OAILOG_FUNC_IN(LOG_M2AP);
+	if(num_m2_enb_mbms_area <= 0){
+		OAILOG_WARNING(LOG_M2AP, "No M2 eNBs to schedule in MBMS area (%d).\n", num_mbms_area);
+		OAILOG_FUNC_RETURN(LOG_M2AP, RETURNok);
+	}
  	/**
 	 * Each eNB in the cluster may have different MBSFN areas.
-	 * Thus we need to encode for each M2 eNB separately, based on its MBSFN areas.
+	 * Group the M2 eNBs by the MBSFN area configurations they are scheduled with, encode once per group and send the same payload to all members.
 	 */
+	memset(mbms_scheduling_groups, 0, sizeof(mbms_scheduling_groups));
 	for(int num_m2_enbs = 0; num_m2_enbs < num_m2_enb_mbms_area; num_m2_enbs++){
 		uint8_t 			 					num_scheduled_mbsfn_areas_cfgs_m2_enb = 0;
 		mbsfn_area_cfg_t 			 *mbsfn_area_cfgs_pP[MAX_MBMSFN_AREAS];
-		m2ap_enb_description_t *m2_enb_description = m2ap_enb_p_elements[num_m2_enbs];
-		memset((void*)mbsfn_area_cfgs_pP, 0, MAX_MBMSFN_AREAS * sizeof(mbsfn_areas_t*));
+		const m2ap_enb_description_t *m2_enb_description = m2ap_enb_p_elements[num_m2_enbs];
+		memset((void*)mbsfn_area_cfgs_pP, 0, MAX_MBMSFN_AREAS * sizeof(mbsfn_area_cfg_t*));
+		m2_enb_group[num_m2_enbs] = -1;
 		for(int num_mbsfn_area_m2_enb = 0; num_mbsfn_area_m2_enb < m2_enb_description->mbsfn_area_ids.num_mbsfn_area_ids; num_mbsfn_area_m2_enb++){
 			/** Collect the scheduling data for the MBSFN area from the global list. No need to check local/global flag. */
 			if(m2_enb_description->local_mbms_area == 0 || !mce_config.mbms.mbms_global_mbsfn_area_per_local_group){
@@ -590,7 +751,7 @@ int m2ap_mbms_scheduling_cluster(const uint8_t num_m2_enb_mbms_area, const m2ap_
 					for(int num_scheduled_mbsfn_area = 0; num_scheduled_mbsfn_area < mbsfn_cluster_global->num_mbsfn_areas; num_scheduled_mbsfn_area++){
 						if(mbsfn_cluster_global->mbsfn_area_cfg[num_scheduled_mbsfn_area].mbsfnArea.mbsfn_area_id == m2_enb_description->mbsfn_area_ids.mbsfn_area_id[num_mbsfn_area_m2_enb]){
 							/** Add the configuration to the list of MBSFN areas. */
-							mbsfn_area_cfgs_pP[num_scheduled_mbsfn_areas_cfgs_m2_enb++] = &mbsfn_cluster_global->mbsfn_area_cfg[num_scheduled_mbsfn_area];
+							mbsfn_area_cfgs_pP[num_scheduled_mbsfn_areas_cfgs_m2_enb++] = (mbsfn_area_cfg_t*)&mbsfn_cluster_global->mbsfn_area_cfg[num_scheduled_mbsfn_area];
 						}
 					}
 				}
@@ -600,29 +761,94 @@ int m2ap_mbms_scheduling_cluster(const uint8_t num_m2_enb_mbms_area, const m2ap_
 				for(int num_scheduled_mbsfn_area = 0; num_scheduled_mbsfn_area < mbsfn_cluster_local->num_mbsfn_areas; num_scheduled_mbsfn_area++){
 					if(mbsfn_cluster_local->mbsfn_area_cfg[num_scheduled_mbsfn_area].mbsfnArea.mbsfn_area_id == m2_enb_description->mbsfn_area_ids.mbsfn_area_id[num_mbsfn_area_m2_enb]){
 						/** Add the configuration to the list of MBSFN areas. */
-						mbsfn_area_cfgs_pP[num_scheduled_mbsfn_areas_cfgs_m2_enb++] = &mbsfn_cluster_local->mbsfn_area_cfg[num_scheduled_mbsfn_area];
+						mbsfn_area_cfgs_pP[num_scheduled_mbsfn_areas_cfgs_m2_enb++] = (mbsfn_area_cfg_t*)&mbsfn_cluster_local->mbsfn_area_cfg[num_scheduled_mbsfn_area];
 					}
 				}
 			}
 		}
 		OAILOG_INFO(LOG_M2AP, "Collected (%d) MBSFN areas for M2AP eNB with eNB Id (%d) in local_mbms_area (%d).\n",
 				num_scheduled_mbsfn_areas_cfgs_m2_enb, m2_enb_description->m2ap_enb_id, m2_enb_description->local_mbms_area);
-		if(num_scheduled_mbsfn_areas_cfgs_m2_enb){
-			if(m2ap_generate_mbms_scheduling_information(m2_enb_description, (mbsfn_area_cfg_t **)mbsfn_area_cfgs_pP, num_scheduled_mbsfn_areas_cfgs_m2_enb, mcch_rep_abs_rf) == RETURNerror){
-				OAILOG_ERROR(LOG_M2AP, "Error encoding MBMS scheduling information for M2AP eNB with eNB Id (%d) in local_mbms_area (%d).\n",
-						m2_enb_description->m2ap_enb_id, m2_enb_description->local_mbms_area);
-				OAILOG_FUNC_RETURN(LOG_M2AP, RETURNerror);
+		if(!num_scheduled_mbsfn_areas_cfgs_m2_enb)
+			continue;
+		/** Check if an eNB with the same MBSFN area configurations exists. */
+		int num_group = 0;
+		for(; num_group < num_groups; num_group++){
+			if(mbms_scheduling_groups[num_group].num_mbsfn_area_cfgs == num_scheduled_mbsfn_areas_cfgs_m2_enb
+					&& !memcmp(mbms_scheduling_groups[num_group].mbsfn_area_cfgs, mbsfn_area_cfgs_pP, num_scheduled_mbsfn_areas_cfgs_m2_enb * sizeof(mbsfn_area_cfg_t*)))
+				break;
+		}
+		if(num_group == num_groups){
+			/** New scheduling group. */
+			mbms_scheduling_groups[num_group].num_mbsfn_area_cfgs = num_scheduled_mbsfn_areas_cfgs_m2_enb;
+			mbms_scheduling_groups[num_group].mbsfn_area_cfgs = calloc(num_scheduled_mbsfn_areas_cfgs_m2_enb, sizeof(mbsfn_area_cfg_t*));
+			DevAssert(mbms_scheduling_groups[num_group].mbsfn_area_cfgs);
+			memcpy(mbms_scheduling_groups[num_group].mbsfn_area_cfgs, mbsfn_area_cfgs_pP, num_scheduled_mbsfn_areas_cfgs_m2_enb * sizeof(mbsfn_area_cfg_t*));
+			num_groups++;
+		}
+		mbms_scheduling_groups[num_group].num_m2_enbs++;
+		m2_enb_group[num_m2_enbs] = num_group;
+	}
+
+	/**
+	 * Reuse the payloads of the last period, where the MBSFN area configurations did not change.
+	 * Encode the remaining groups once each (in parallel, if M2AP encoder threads are configured).
+	 */
+	for(int num_group = 0; num_group < num_groups; num_group++){
+		m2ap_mbms_scheduling_group_t * mbms_scheduling_group = &mbms_scheduling_groups[num_group];
+		DevAssert(mcch_rep_abs_rf % mbms_scheduling_group->mbsfn_area_cfgs[0]->mbsfnArea.mcch_modif_period_rf == 0); /**< Assert that it is a multiple. */
+		mbms_scheduling_group->mcch_update_time = (mcch_rep_abs_rf / mbms_scheduling_group->mbsfn_area_cfgs[0]->mbsfnArea.mcch_modif_period_rf) % 256;
+		mbms_scheduling_group->key = m2ap_mbms_scheduling_key(mbms_scheduling_group->mbsfn_area_cfgs, mbms_scheduling_group->num_mbsfn_area_cfgs);
+		mbms_scheduling_group->digest = m2ap_mbms_scheduling_digest(mbms_scheduling_group->key);
+		mbms_scheduling_group->cached = m2ap_mbms_scheduling_cache_get(mbms_scheduling_group);
+	}
+	m2ap_encoder_pool_run(m2ap_mbms_scheduling_encode_group, mbms_scheduling_groups, num_groups, sizeof(m2ap_mbms_scheduling_group_t));
+
+	/** Send the payload of each group to all members, in group order. */
+	for(int num_group = 0; num_group < num_groups; num_group++){
+		m2ap_mbms_scheduling_group_t * mbms_scheduling_group = &mbms_scheduling_groups[num_group];
+		if(!mbms_scheduling_group->payload){
+			OAILOG_ERROR(LOG_M2AP, "Error encoding MBMS scheduling information for (%d) M2AP eNBs in local_mbms_area (%d).\n",
+					mbms_scheduling_group->num_m2_enbs, num_mbms_area);
+			rc = RETURNerror;
+		} else {
+			sctp_assoc_id_t group_assoc_ids[mbms_scheduling_group->num_m2_enbs];
+			int             num_group_assocs = 0;
+			/** One copy of the payload for the response timers of the whole group. */
+			m2ap_timer_payload_t * timer_payload = m2ap_timer_payload_create(mbms_scheduling_group->payload);
+			if(!mbms_scheduling_group->cached)
+				m2ap_mbms_scheduling_cache_put(mbms_scheduling_group);
+			for(int num_m2_enbs = 0; num_m2_enbs < num_m2_enb_mbms_area; num_m2_enbs++){
+				if(m2_enb_group[num_m2_enbs] != num_group)
+					continue;
+				/** Non-MBMS signalling -> stream 0. */
+				m2ap_timer_insert_shared(m2ap_enb_p_elements[num_m2_enbs]->sctp_assoc_id, M2AP_ProcedureCode_id_mbmsSchedulingInformation, INVALID_MCE_MBMS_M2AP_ID,
+						M2AP_ENB_SERVICE_SCTP_STREAM_ID, timer_payload);
+				group_assoc_ids[num_group_assocs++] = m2ap_enb_p_elements[num_m2_enbs]->sctp_assoc_id;
+			}
+			m2ap_timer_payload_release(&timer_payload);
+			/**
+			 * One request for all members of the group, the SCTP task sends the same payload on each association.
+			 * Associations which fail are confirmed with SCTP_DATA_CNF.
+			 */
+			if(m2ap_mce_itti_send_sctp_multi_request (&mbms_scheduling_group->payload, num_group_assocs, group_assoc_ids, M2AP_ENB_SERVICE_SCTP_STREAM_ID) == RETURNerror){
+				OAILOG_ERROR (LOG_M2AP, "Error sending MBMS Scheduling Information to (%d) eNBs in local_mbms_area (%d).\n", num_group_assocs, num_mbms_area);
+				/** Continue. */
 			}
+			bdestroy_wrapper(&mbms_scheduling_group->payload);
 		}
-		/** Done scheduling the eNB, continue clear with the next eNB. */
+		bdestroy_wrapper(&mbms_scheduling_group->key);
+		free_wrapper((void**)&mbms_scheduling_group->mbsfn_area_cfgs);
 	}
-	OAILOG_INFO(LOG_M2AP, "Successfully scheduled all (%d) M2 eNBs in MBMS area (%d). \n", num_m2_enb_mbms_area, num_mbms_area);
+	if(rc == RETURNerror)
+		OAILOG_FUNC_RETURN(LOG_M2AP, RETURNerror);
+	OAILOG_INFO(LOG_M2AP, "Successfully scheduled all (%d) M2 eNBs in MBMS area (%d) with (%d) encoded MBMS Scheduling Information messages. \n",
+			num_m2_enb_mbms_area, num_mbms_area, num_groups);
 	OAILOG_FUNC_RETURN(LOG_M2AP, RETURNok);
 }
 
 //------------------------------------------------------------------------------
 static
-int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id, const uint8_t num_m2ap_enbs, m2ap_enb_description_t ** m2ap_enb_descriptions)
+int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id, const int num_m2ap_enbs, m2ap_enb_description_t ** m2ap_enb_descriptions)
 {
   OAILOG_FUNC_IN (LOG_M2AP);
   mbms_description_t                     *mbms_ref = NULL;
@@ -633,6 +859,9 @@ int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id
   M2AP_M2AP_PDU_t                         pdu = {0};
   M2AP_SessionStartRequest_t			 			 *out;
   M2AP_SessionStartRequest_Ies_t		  	 *ie = NULL;
+  uint16_t                                mcc = 0;
+  uint16_t                                mnc = 0;
+  uint16_t                                mnc_len = 0;
 
   mbms_ref = m2ap_is_mbms_mce_m2ap_id_in_list(mce_mbms_m2ap_id);
   if (!mbms_ref) {
@@ -678,7 +907,8 @@ int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id
   ie->criticality = M2AP_Criticality_reject;
   ie->value.present = M2AP_SessionStartRequest_Ies__value_PR_TMGI;
   INT24_TO_OCTET_STRING(mbms_ref->tmgi.mbms_service_id, &ie->value.choice.TMGI.serviceID);
-  TBCD_TO_PLMN_T(&ie->value.choice.TMGI.pLMNidentity, &mbms_ref->tmgi.plmn);
+  PLMN_T_TO_MCC_MNC (mbms_ref->tmgi.plmn, mcc, mnc, mnc_len);
+  MCC_MNC_TO_PLMNID (mcc, mnc, mnc_len, &ie->value.choice.TMGI.pLMNidentity);
   ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
 
   /** No MBMS Session Id since we only support GCS-AS (public safety). */
@@ -687,7 +917,7 @@ int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id
    * Only a single MBMS Service Area Id per MBMS Service is supported right now.
    */
   ie = (M2AP_SessionStartRequest_Ies_t *)calloc(1, sizeof(M2AP_SessionStartRequest_Ies_t));
-  ie->id = M2AP_ProtocolIE_ID_id_TMGI;
+  ie->id = M2AP_ProtocolIE_ID_id_MBMS_Service_Area;
   ie->criticality = M2AP_Criticality_reject;
   ie->value.present = M2AP_SessionStartRequest_Ies__value_PR_MBMS_Service_Area;
   uint32_t mbms_sai = mbms_ref->mbms_service_area_id | (0x01 << 16); /**< Add the length into the encoded value. */
@@ -734,36 +964,41 @@ int m2ap_generate_mbms_session_start_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id
   }
 
   // todo: the next_sctp_stream is the one without incrementation?
+  /** No eNB specific content, every eNB gets the same encoded message, sent by the SCTP task in one pass. */
+  bstring         b = blk2bstr(buffer_p, length);
+  sctp_assoc_id_t assoc_ids[num_m2ap_enbs ? num_m2ap_enbs : 1];
+  int             num_assocs = 0;
+  /** One copy of the payload for the response timers of all eNBs. */
+  m2ap_timer_payload_t * timer_payload = m2ap_timer_payload_create(b);
+  free(buffer_p);
   for(int i = 0; i < num_m2ap_enbs; i++){
 	  m2ap_enb_description_t * target_enb_ref = m2ap_enb_descriptions[i];
 	  if(target_enb_ref){
 	  	/** Check if it is in the list of the MBMS Service. */
-	  	bstring b = blk2bstr(buffer_p, length);
-	  	free(buffer_p);
-	  	OAILOG_NOTICE (LOG_M2AP, "Send M2AP_MBMS_SESSION_START_REQUEST message MCE_MBMS_M2AP_ID = " MCE_MBMS_M2AP_ID_FMT "\n", mce_mbms_m2ap_id);
+	  	OAILOG_NOTICE (LOG_M2AP, "Send M2AP_MBMS_SESSION_START_REQUEST message MCE_MBMS_M2AP_ID = " MCE_MBMS_M2AP_ID_FMT " to eNB with SCTP Assoc Id (%d)\n",
+	  		mce_mbms_m2ap_id, target_enb_ref->sctp_assoc_id);
 	  	/** For the sake of complexity (we wan't to keep it simple, and the same ), we are using the same SCTP Stream Id for all MBMS Service Index. */
-	  	m2ap_mce_itti_send_sctp_request(&b, target_enb_ref->sctp_assoc_id, MBMS_SERVICE_SCTP_STREAM_ID, mce_mbms_m2ap_id);
+	  	m2ap_timer_insert_shared(target_enb_ref->sctp_assoc_id, M2AP_ProcedureCode_id_sessionStart, mce_mbms_m2ap_id, MBMS_SERVICE_SCTP_STREAM_ID, timer_payload);
+	  	assoc_ids[num_assocs++] = target_enb_ref->sctp_assoc_id;
 	  }
   }
+  m2ap_timer_payload_release(&timer_payload);
+  m2ap_mce_itti_send_sctp_multi_request(&b, num_assocs, assoc_ids, MBMS_SERVICE_SCTP_STREAM_ID);
 
   OAILOG_FUNC_RETURN (LOG_M2AP, RETURNok);
 }
 
 //------------------------------------------------------------------------------
 static
-int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id, sctp_assoc_id_t sctp_assoc_id)
+int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id, const int num_m2ap_enbs, m2ap_enb_description_t ** m2ap_enb_descriptions)
 {
   OAILOG_FUNC_IN (LOG_M2AP);
   mbms_description_t                     *mbms_ref = NULL;
-  m2ap_enb_description_t				 *m2ap_enb_description = NULL;
-  uint8_t                                *buffer_p = NULL;
-  uint32_t                                length = 0;
-  enb_mbms_m2ap_id_t					  enb_mbms_m2ap_id = INVALID_ENB_MBMS_M2AP_ID;
-  MessagesIds                             message_id = MESSAGES_ID_MAX;
-  void                                   *id = NULL;
-  M2AP_M2AP_PDU_t                         pdu = {0};
-  M2AP_SessionUpdateRequest_t		 	 *out;
-  M2AP_SessionUpdateRequest_Ies_t		 *ie = NULL;
+  enb_mbms_m2ap_id_t                      enb_mbms_m2ap_ids[num_m2ap_enbs];
+  bstring                                 payload = NULL;
+  bstring                                 probe = NULL;
+  int                                     enb_mbms_m2ap_id_offset = -1;
+  int                                     num_m2ap_enbs_id = 0;
 
   mbms_ref = m2ap_is_mbms_mce_m2ap_id_in_list(mce_mbms_m2ap_id);
   if (!mbms_ref) {
@@ -771,18 +1006,77 @@ int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_i
     OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
   }
 
-  m2ap_enb_description = m2ap_is_enb_assoc_id_in_list(sctp_assoc_id);
-  if (!m2ap_enb_description) {
-	OAILOG_ERROR (LOG_M2AP, "No M2AP eNB description for SCTP Assoc Id (%d). Cannot trigger MBMS Session Update Request for MBMS Service with MCE MBMS M2AP ID " MCE_MBMS_M2AP_ID_FMT". \n", sctp_assoc_id, mce_mbms_m2ap_id);
-    OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
+  /** Check that an eNB-MBMS-ID exists for each eNB. */
+  for(int i = 0; i < num_m2ap_enbs; i++) {
+	uint64_t enb_mbms_m2ap_id = INVALID_ENB_MBMS_M2AP_ID;
+	enb_mbms_m2ap_ids[i] = INVALID_ENB_MBMS_M2AP_ID;
+	if(HASH_TABLE_OK != hashtable_uint64_ts_get (&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)m2ap_enb_descriptions[i]->sctp_assoc_id, &enb_mbms_m2ap_id)
+		|| (enb_mbms_m2ap_id_t)enb_mbms_m2ap_id == INVALID_ENB_MBMS_M2AP_ID) {
+	  OAILOG_ERROR (LOG_M2AP, "No ENB MBMS M2AP ID could be retrieved for SCTP Assoc Id (%d). Cannot generate MBMS Session Update Request. \n",
+		  m2ap_enb_descriptions[i]->sctp_assoc_id);
+	  continue;
+	}
+	enb_mbms_m2ap_ids[i] = (enb_mbms_m2ap_id_t)enb_mbms_m2ap_id;
+	num_m2ap_enbs_id++;
   }
+  if(!num_m2ap_enbs_id)
+	OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
 
-  /** Check that an eNB-MBMS-ID exists. */
-  hashtable_uint64_ts_get (&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)sctp_assoc_id, (void *)&enb_mbms_m2ap_id);
-  if(enb_mbms_m2ap_id == INVALID_ENB_MBMS_M2AP_ID){
-	OAILOG_ERROR (LOG_M2AP, "No ENB MBMS M2AP ID could be retrieved. Cannot generate MBMS Session Update Request. \n");
+  /**
+   * The ENB MBMS M2AP ID is the only eNB specific IE. Encode the message once and locate the (octet-aligned) ENB MBMS M2AP ID,
+   * by encoding it a second time with all bits of the ID flipped. Each eNB gets a copy with its own ID.
+   * If the ID cannot be located, the message is encoded for each eNB.
+   */
+  int first = 0;
+  while(enb_mbms_m2ap_ids[first] == INVALID_ENB_MBMS_M2AP_ID)
+	first++;
+  if(m2ap_encode_mbms_session_update_request(mbms_ref, enb_mbms_m2ap_ids[first], &payload) != RETURNok)
 	OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
+  if(num_m2ap_enbs_id > 1
+	  && m2ap_encode_mbms_session_update_request(mbms_ref, (enb_mbms_m2ap_id_t)~enb_mbms_m2ap_ids[first], &probe) == RETURNok) {
+	const uint8_t value[2]       = {(enb_mbms_m2ap_ids[first] >> 8) & 0xFF, enb_mbms_m2ap_ids[first] & 0xFF};
+	const uint8_t probe_value[2] = {~value[0] & 0xFF, ~value[1] & 0xFF};
+	enb_mbms_m2ap_id_offset = m2ap_locate_encoded_value(payload, probe, value, probe_value, 2);
   }
+  bdestroy_wrapper(&probe);
+
+  for(int i = first; i < num_m2ap_enbs; i++) {
+	bstring b = NULL;
+	if(enb_mbms_m2ap_ids[i] == INVALID_ENB_MBMS_M2AP_ID)
+	  continue;
+	if(i == first) {
+	  b = bstrcpy(payload);
+	} else if(enb_mbms_m2ap_id_offset != -1) {
+	  b = bstrcpy(payload);
+	  b->data[enb_mbms_m2ap_id_offset]     = (enb_mbms_m2ap_ids[i] >> 8) & 0xFF;
+	  b->data[enb_mbms_m2ap_id_offset + 1] = enb_mbms_m2ap_ids[i] & 0xFF;
+	} else if(m2ap_encode_mbms_session_update_request(mbms_ref, enb_mbms_m2ap_ids[i], &b) != RETURNok) {
+	  continue;
+	}
+	OAILOG_NOTICE (LOG_M2AP, "Send M2AP_MBMS_SESSION_UPDATE_REQUEST message MCE_MBMS_M2AP_ID = " MCE_MBMS_M2AP_ID_FMT " to eNB with SCTP Assoc Id (%d)\n",
+		mce_mbms_m2ap_id, m2ap_enb_descriptions[i]->sctp_assoc_id);
+	m2ap_timer_insert(m2ap_enb_descriptions[i]->sctp_assoc_id, M2AP_ProcedureCode_id_sessionUpdate, mce_mbms_m2ap_id, MBMS_SERVICE_SCTP_STREAM_ID, b);
+	m2ap_mce_itti_send_sctp_request(&b, m2ap_enb_descriptions[i]->sctp_assoc_id, MBMS_SERVICE_SCTP_STREAM_ID, mce_mbms_m2ap_id);
+  }
+  bdestroy_wrapper(&payload);
+  OAILOG_FUNC_RETURN (LOG_M2AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+static
+int m2ap_encode_mbms_session_update_request(mbms_description_t * const mbms_ref, const enb_mbms_m2ap_id_t enb_mbms_m2ap_id, bstring * payload)
+{
+  OAILOG_FUNC_IN (LOG_M2AP);
+  uint8_t                                *buffer_p = NULL;
+  uint32_t                                length = 0;
+  mce_mbms_m2ap_id_t                      mce_mbms_m2ap_id = mbms_ref->mce_mbms_m2ap_id;
+  M2AP_M2AP_PDU_t                         pdu = {0};
+  M2AP_SessionUpdateRequest_t		 	 *out;
+  M2AP_SessionUpdateRequest_Ies_t		 *ie = NULL;
+  uint16_t                                mcc = 0;
+  uint16_t                                mnc = 0;
+  uint16_t                                mnc_len = 0;
+
   /*
    * We have found the UE in the list.
    * Create new IE list message and encode it.
@@ -819,7 +1113,8 @@ int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_i
   ie->criticality = M2AP_Criticality_reject;
   ie->value.present = M2AP_SessionUpdateRequest_Ies__value_PR_TMGI;
   INT24_TO_OCTET_STRING(mbms_ref->tmgi.mbms_service_id, &ie->value.choice.TMGI.serviceID);
-  TBCD_TO_PLMN_T(&ie->value.choice.TMGI.pLMNidentity, &mbms_ref->tmgi.plmn);
+  PLMN_T_TO_MCC_MNC (mbms_ref->tmgi.plmn, mcc, mnc, mnc_len);
+  MCC_MNC_TO_PLMNID (mcc, mnc, mnc_len, &ie->value.choice.TMGI.pLMNidentity);
   ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
 
   /** No MBMS Session Id since we only support GCS-AS (public safety). */
@@ -828,7 +1123,7 @@ int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_i
    * Only a single MBMS Service Area Id per MBMS Service is supported right now.
    */
   ie = (M2AP_SessionUpdateRequest_Ies_t *)calloc(1, sizeof(M2AP_SessionUpdateRequest_Ies_t));
-  ie->id = M2AP_ProtocolIE_ID_id_TMGI;
+  ie->id = M2AP_ProtocolIE_ID_id_MBMS_Service_Area;
   ie->criticality = M2AP_Criticality_reject;
   ie->value.present = M2AP_SessionUpdateRequest_Ies__value_PR_MBMS_Service_Area;
   uint32_t mbms_sai = mbms_ref->mbms_service_area_id | (1 << 16); /**< Add the length into the encoded value. */
@@ -875,24 +1170,207 @@ int m2ap_generate_mbms_session_update_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_i
 	OAILOG_ERROR (LOG_M2AP, "Failed to encode MBMS Session Update Request. \n");
 	OAILOG_FUNC_RETURN (LOG_M2AP, RETURNerror);
   }
-
-  bstring b = blk2bstr(buffer_p, length);
+  *payload = blk2bstr(buffer_p, length);
   free(buffer_p);
-  OAILOG_NOTICE (LOG_M2AP, "Send M2AP_MBMS_SESSION_UPDATE_REQUEST message MCE_MBMS_M2AP_ID = " MCE_MBMS_M2AP_ID_FMT "\n", mce_mbms_m2ap_id);
-  m2ap_mce_itti_send_sctp_request(&b, m2ap_enb_description->sctp_assoc_id, MBMS_SERVICE_SCTP_STREAM_ID, mce_mbms_m2ap_id);
   OAILOG_FUNC_RETURN (LOG_M2AP, RETURNok);
 }
 
+//-----------------------------------------------------------------------------
+/*
+ * Locate an octet-aligned value in an encoded payload. The probe is the same message encoded with the probe value,
+ * which must differ from the value in every octet. Returns the offset of the value, or -1 if the payloads differ anywhere else.
+ */
+static
+int m2ap_locate_encoded_value(const_bstring payload, const_bstring probe, const uint8_t * const value, const uint8_t * const probe_value, const int value_length)
+{
+	int offset = 0;
+
+	if(!payload || !probe || blength(payload) != blength(probe))
+		return -1;
+	while(offset < blength(payload) && payload->data[offset] == probe->data[offset])
+		offset++;
+	if(offset + value_length > blength(payload)
+			|| memcmp(&payload->data[offset], value, value_length) || memcmp(&probe->data[offset], probe_value, value_length)
+			|| memcmp(&payload->data[offset + value_length], &probe->data[offset + value_length], blength(payload) - offset - value_length))
+		return -1;
+	return offset;
+}
+
+//-----------------------------------------------------------------------------
+static
+void m2ap_mbms_scheduling_key_add(bstring key, const uint8_t tag, const uint64_t value)
+{
+	bcatblk(key, &tag, sizeof(tag));
+	bcatblk(key, &value, sizeof(value));
+}
+
+//-----------------------------------------------------------------------------
+static
+bstring m2ap_mbms_scheduling_key(mbsfn_area_cfg_t ** const mbsfn_area_cfgs, const int num_mbsfn_area_per_enb)
+{
+	/**
+	 * Only the fields m2ap_generate_mbms_scheduling_information encodes, in scheduling order, each tagged with its element.
+	 * Structure padding and fields the eNBs never see (bitrates, CSA bookkeeping) do not split the groups in the cache.
+	 */
+	bstring key = bfromcstralloc(64 * num_mbsfn_area_per_enb, "");
+	DevAssert(key);
+	for(int num_mbsfn = 0; num_mbsfn < num_mbsfn_area_per_enb; num_mbsfn++){
+		const mbsfn_area_cfg_t * const cfg = mbsfn_area_cfgs[num_mbsfn];
+		m2ap_mbms_scheduling_key_add(key, 'A', cfg->mbsfnArea.mbsfn_area_id);
+		m2ap_mbms_scheduling_key_add(key, 'A', cfg->mbsfnArea.mbsfn_csa_period_rf);
+		for(int n_mch = 0; n_mch < MAX_MCH_PER_MBSFN; n_mch++){
+			const mch_t * const mch = &cfg->mchs.mch_array[n_mch];
+			if(!mch->mch_qci)
+				continue;
+			m2ap_mbms_scheduling_key_add(key, 'M', mch->mch_subframe_stop);
+			m2ap_mbms_scheduling_key_add(key, 'M', mch->mcs);
+			m2ap_mbms_scheduling_key_add(key, 'M', mch->msp_rf);
+			for(int num_mbms_session = 0; num_mbms_session < mch->mbms_session_list.num_mbms_sessions; num_mbms_session++){
+				const tmgi_t * const tmgi = &mch->mbms_session_list.tmgis[num_mbms_session];
+				m2ap_mbms_scheduling_key_add(key, 'T', ((uint64_t)tmgi->mbms_service_id << 24)
+						| (tmgi->plmn.mcc_digit1 << 20) | (tmgi->plmn.mcc_digit2 << 16) | (tmgi->plmn.mcc_digit3 << 12)
+						| (tmgi->plmn.mnc_digit1 << 8) | (tmgi->plmn.mnc_digit2 << 4) | tmgi->plmn.mnc_digit3);
+			}
+		}
+		for(int mbsfn_csa_pattern = 0; mbsfn_csa_pattern < MBSFN_AREA_MAX_CSA_PATTERN; mbsfn_csa_pattern++) {
+			const struct csa_pattern_s * const csa_pattern = &cfg->csa_patterns.csa_pattern[mbsfn_csa_pattern];
+			if(!csa_pattern->mbms_csa_pattern_rfs)
+				continue;
+			m2ap_mbms_scheduling_key_add(key, 'C', csa_pattern->mbms_csa_pattern_rfs);
+			m2ap_mbms_scheduling_key_add(key, 'C', csa_pattern->csa_pattern_repetition_period_rf);
+			m2ap_mbms_scheduling_key_add(key, 'C', csa_pattern->csa_pattern_offset_rf);
+			m2ap_mbms_scheduling_key_add(key, 'C', (csa_pattern->mbms_csa_pattern_rfs == CSA_FOUR_FRAME) ?
+					csa_pattern->csa_pattern_sf.mbms_mch_csa_pattern_4rf : csa_pattern->csa_pattern_sf.mbms_mch_csa_pattern_1rf);
+		}
+	}
+	return key;
+}
+
+//-----------------------------------------------------------------------------
+static
+hash_key_t m2ap_mbms_scheduling_digest(const_bstring const key)
+{
+	/** 64-bit FNV-1a over the scheduling key. */
+	uint64_t digest = 0xcbf29ce484222325ULL;
+	for(int offset = 0; offset < blength(key); offset++){
+		digest ^= key->data[offset];
+		digest *= 0x100000001b3ULL;
+	}
+	return (hash_key_t)digest;
+}
+
 //-----------------------------------------------------------------------------
 static
-int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_enb_description, mbsfn_area_cfg_t **mbsfn_area_cfgs, const uint8_t num_mbsfn_area_per_enb, long mcch_rep_abs_rf)
+bool m2ap_mbms_scheduling_cache_get(m2ap_mbms_scheduling_group_t * const mbms_scheduling_group)
+{
+	m2ap_mbms_scheduling_cache_entry_t  *cache_entry = NULL;
+
+	if(HASH_TABLE_OK != hashtable_ts_get(&m2ap_mbms_scheduling_cache, mbms_scheduling_group->digest, (void**)&cache_entry) || !cache_entry){
+		m2ap_mbms_scheduling_cache_stats.num_misses++;
+		return false;
+	}
+	/** A digest collision is a miss, the entry is overwritten with the new payload. */
+	if(blength(cache_entry->key) != blength(mbms_scheduling_group->key)
+			|| memcmp(cache_entry->key->data, mbms_scheduling_group->key->data, blength(mbms_scheduling_group->key))){
+		m2ap_mbms_scheduling_cache_stats.num_misses++;
+		return false;
+	}
+	/** Unchanged MBSFN area configurations, just set the new MCCH Update Time. */
+	mbms_scheduling_group->payload = bstrcpy(cache_entry->payload);
+	DevAssert(mbms_scheduling_group->payload);
+	mbms_scheduling_group->payload->data[cache_entry->mcch_update_time_offset] = mbms_scheduling_group->mcch_update_time;
+	mbms_scheduling_group->mcch_update_time_offset = cache_entry->mcch_update_time_offset;
+	cache_entry->last_scheduling_period = m2ap_mbms_scheduling_period;
+	m2ap_mbms_scheduling_cache_stats.num_hits++;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+static
+void m2ap_mbms_scheduling_cache_put(const m2ap_mbms_scheduling_group_t * const mbms_scheduling_group)
+{
+	m2ap_mbms_scheduling_cache_entry_t  *cache_entry = NULL;
+
+	if(mbms_scheduling_group->mcch_update_time_offset == -1){
+		OAILOG_WARNING(LOG_M2AP, "Could not locate the MCCH Update Time in the encoded MBMS Scheduling Information. Not caching the payload.\n");
+		m2ap_mbms_scheduling_cache_stats.num_uncacheable++;
+		return;
+	}
+	cache_entry = calloc(1, sizeof(m2ap_mbms_scheduling_cache_entry_t));
+	DevAssert(cache_entry);
+	cache_entry->key = bstrcpy(mbms_scheduling_group->key);
+	cache_entry->payload = bstrcpy(mbms_scheduling_group->payload);
+	cache_entry->mcch_update_time_offset = mbms_scheduling_group->mcch_update_time_offset;
+	cache_entry->last_scheduling_period = m2ap_mbms_scheduling_period;
+	/** On a digest collision, the entry of the other configurations is replaced (and freed by the hashtable). */
+	hashtable_rc_t hash_rc = hashtable_ts_insert(&m2ap_mbms_scheduling_cache, mbms_scheduling_group->digest, (void*)cache_entry);
+	if(HASH_TABLE_OK != hash_rc && HASH_TABLE_INSERT_OVERWRITTEN_DATA != hash_rc){
+		OAILOG_WARNING(LOG_M2AP, "Could not cache the encoded MBMS Scheduling Information.\n");
+		m2ap_free_mbms_scheduling_cache_entry((void**)&cache_entry);
+	}
+}
+
+//-----------------------------------------------------------------------------
+/*
+ * Encoding job of the M2AP encoder pool, may run on any encoder thread.
+ * Only reads the MBSFN area configurations of the group and only writes the group.
+ */
+static
+int m2ap_mbms_scheduling_encode_group(void * const mbms_scheduling_group_p)
+{
+	m2ap_mbms_scheduling_group_t        *mbms_scheduling_group = (m2ap_mbms_scheduling_group_t*)mbms_scheduling_group_p;
+	bstring                              probe = NULL;
+
+	if(mbms_scheduling_group->cached)
+		return RETURNok;
+	mbms_scheduling_group->mcch_update_time_offset = -1;
+	if(m2ap_generate_mbms_scheduling_information(mbms_scheduling_group->mbsfn_area_cfgs, mbms_scheduling_group->num_mbsfn_area_cfgs,
+			mbms_scheduling_group->mcch_update_time, &mbms_scheduling_group->payload) == RETURNerror)
+		return RETURNerror;
+
+	/**
+	 * Locate the MCCH Update Time in the payload by encoding the message a second time with all bits of the MCCH Update Time flipped.
+	 * The octet-aligned APER INTEGER (0..255) must be the only differing octet, else the payload is not cached.
+	 */
+	const uint8_t mcch_update_time = mbms_scheduling_group->mcch_update_time;
+	const uint8_t probe_mcch_update_time = ~mcch_update_time;
+	if(m2ap_generate_mbms_scheduling_information(mbms_scheduling_group->mbsfn_area_cfgs, mbms_scheduling_group->num_mbsfn_area_cfgs,
+			probe_mcch_update_time, &probe) == RETURNok){
+		mbms_scheduling_group->mcch_update_time_offset = m2ap_locate_encoded_value(mbms_scheduling_group->payload, probe, &mcch_update_time, &probe_mcch_update_time, 1);
+	}
+	bdestroy_wrapper(&probe);
+	return RETURNok;
+}
+
+//-----------------------------------------------------------------------------
+static
+void m2ap_mbms_scheduling_cache_evict(void)
+{
+	m2ap_mbms_scheduling_cache_entry_t  *cache_entry = NULL;
+	hashtable_key_array_t               *key_array = hashtable_ts_get_keys(&m2ap_mbms_scheduling_cache);
+
+	if(!key_array)
+		return;
+	/** Payloads not used in this MBMS scheduling period belong to changed MBSFN area configurations. */
+	for(int num_key = 0; num_key < key_array->num_keys; num_key++){
+		if(HASH_TABLE_OK == hashtable_ts_get(&m2ap_mbms_scheduling_cache, key_array->keys[num_key], (void**)&cache_entry)
+				&& cache_entry && cache_entry->last_scheduling_period != m2ap_mbms_scheduling_period){
+			hashtable_ts_free(&m2ap_mbms_scheduling_cache, key_array->keys[num_key]);
+			m2ap_mbms_scheduling_cache_stats.num_evictions++;
+		}
+	}
+	free_wrapper((void**)&key_array->keys);
+	free_wrapper((void**)&key_array);
+}
+
+//-----------------------------------------------------------------------------
+static
+int m2ap_generate_mbms_scheduling_information(mbsfn_area_cfg_t ** const mbsfn_area_cfgs, const int num_mbsfn_area_per_enb, const uint8_t mcch_update_time, bstring * payload)
 {
 	OAILOG_FUNC_IN(LOG_M2AP);
 
 	uint8_t                                *buffer_p = NULL;
 	uint32_t                                length = 0;
-	uint8_t															 		num_m2ap_enbs = 0;
-	void                                   *id = NULL;
 
 	M2AP_M2AP_PDU_t                         pdu = {0};
 	M2AP_MbmsSchedulingInformation_t			 *out;
@@ -900,9 +1378,7 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 	M2AP_MBSFN_Area_Configuration_Item_t	 *mbsfnAreaCfgItem = NULL;
 
 	/**
-	 * At least one eNB exists,
-	 * Create and encode the message for all eNBs.
-	 * We have found the UE in the list.
+	 * Create and encode the message for all eNBs of a scheduling group.
 	 * Create new IE list message and encode it.
 	 */
 	memset(&pdu, 0, sizeof(pdu));
@@ -919,8 +1395,6 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 	ie->id = M2AP_ProtocolIE_ID_id_MCCH_Update_Time;
 	ie->criticality = M2AP_Criticality_reject;
 	ie->value.present = M2AP_MbmsSchedulingInformation_Ies__value_PR_MCCH_Update_Time;
-	DevAssert(mcch_rep_abs_rf % mbsfn_area_cfgs[0]->mbsfnArea.mcch_modif_period_rf == 0); /**< Assert that it is a multiple. */
-	uint8_t mcch_update_time = (mcch_rep_abs_rf / mbsfn_area_cfgs[0]->mbsfnArea.mcch_modif_period_rf) % 256;
 	ie->value.choice.MCCH_Update_Time = mcch_update_time; /**< Absolute counter of the MCCH update period for the MBSFN area. */
 	ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
 
@@ -965,11 +1439,14 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 				pmch_configuration_item_ie->id = M2AP_ProtocolIE_ID_id_PMCH_Configuration_Item;
 				pmch_configuration_item_ie->criticality 	= M2AP_Criticality_reject;
 				pmch_configuration_item_ie->value.present = M2AP_PMCH_Configuration_ItemIEs__value_PR_PMCH_Configuration_Item;
-				M2AP_PMCH_Configuration_Item_t * pmch_configuration_item = &pmch_configuration_item_ie->value.choice.PMCH_Configuration_Item.pmch_Configuration;
+				M2AP_PMCH_Configuration_Item_t * pmch_configuration_item = &pmch_configuration_item_ie->value.choice.PMCH_Configuration_Item;
 				/** Absolute subframe number in a CSA period. */
 				pmch_configuration_item->pmch_Configuration.allocatedSubframesEnd = mbsfn_area_cfgs[num_mbsfn]->mchs.mch_array[n_mch].mch_subframe_stop;
 				pmch_configuration_item->pmch_Configuration.dataMCS								= mbsfn_area_cfgs[num_mbsfn]->mchs.mch_array[n_mch].mcs;
-				pmch_configuration_item->pmch_Configuration.mchSchedulingPeriod   = mbsfn_area_cfgs[num_mbsfn]->mchs.mch_array[n_mch].msp_rf;
+				/** The MCH scheduling period is given in radio frames, the enumeration starts at rf8. */
+				pmch_configuration_item->pmch_Configuration.mchSchedulingPeriod   = log2(mbsfn_area_cfgs[num_mbsfn]->mchs.mch_array[n_mch].msp_rf/8);
+				DevAssert(pmch_configuration_item->pmch_Configuration.mchSchedulingPeriod >= M2AP_MCH_Scheduling_Period_rf8);
+				DevAssert(pmch_configuration_item->pmch_Configuration.mchSchedulingPeriod <= M2AP_MCH_Scheduling_Period_rf1024);
 				/** Set the MBMS sessions to schedule. */
 				for(int num_mbms_session = 0; num_mbms_session < mbsfn_area_cfgs[num_mbsfn]->mchs.mch_array[n_mch].mbms_session_list.num_mbms_sessions; num_mbms_session++){
 					/**
@@ -981,8 +1458,10 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 					mbms_session_list_item->lcid = (num_mbms_session +1);
 					tmgi_t * tmgi_p = &mbsfn_area_cfgs[num_mbsfn]->mchs.mch_array[n_mch].mbms_session_list.tmgis[num_mbms_session];
 				  INT24_TO_OCTET_STRING(tmgi_p->mbms_service_id, &mbms_session_list_item->tmgi.serviceID);
-				  TBCD_TO_PLMN_T(&mbms_session_list_item->tmgi.pLMNidentity, &tmgi_p->plmn);
-				  ASN_SEQUENCE_ADD(&out->protocolIEs.list, ie);
+				  uint16_t mcc = 0, mnc = 0, mnc_len = 0;
+				  PLMN_T_TO_MCC_MNC (tmgi_p->plmn, mcc, mnc, mnc_len);
+				  MCC_MNC_TO_PLMNID (mcc, mnc, mnc_len, &mbms_session_list_item->tmgi.pLMNidentity);
+				  ASN_SEQUENCE_ADD(&pmch_configuration_item->mbms_Session_List.list, mbms_session_list_item);
 				}
 				ASN_SEQUENCE_ADD(&mbsfnAreaCfgItem->value.choice.PMCH_Configuration_List.list, pmch_configuration_item_ie);
 			}
@@ -1003,7 +1482,12 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 		for(int mbsfn_csa_pattern = 0; mbsfn_csa_pattern < MBSFN_AREA_MAX_CSA_PATTERN; mbsfn_csa_pattern++) {
 			if(!mbsfn_area_cfgs[num_mbsfn]->csa_patterns.csa_pattern[mbsfn_csa_pattern].mbms_csa_pattern_rfs)
 				continue;
-			M2AP_MBSFN_Subframe_Configuration_t * mbsfn_sf_confg = calloc(1, sizeof(M2AP_MBSFN_Subframe_Configuration_t));
+			/** Each subframe configuration is a single IE container of the list. */
+			M2AP_MBSFN_Subframe_ConfigurationItem_t * mbsfn_sf_confg_item = calloc(1, sizeof(M2AP_MBSFN_Subframe_ConfigurationItem_t));
+			mbsfn_sf_confg_item->id = M2AP_ProtocolIE_ID_id_MBSFN_Subframe_Configuration_Item;
+			mbsfn_sf_confg_item->criticality = M2AP_Criticality_reject;
+			mbsfn_sf_confg_item->value.present = M2AP_MBSFN_Subframe_ConfigurationItem__value_PR_MBSFN_Subframe_Configuration;
+			M2AP_MBSFN_Subframe_Configuration_t * mbsfn_sf_confg = &mbsfn_sf_confg_item->value.choice.MBSFN_Subframe_Configuration;
 			/** Check the RF-Allocation Period as log2. */
 			mbsfn_sf_confg->radioframeAllocationPeriod = log2(mbsfn_area_cfgs[num_mbsfn]->csa_patterns.csa_pattern[mbsfn_csa_pattern].csa_pattern_repetition_period_rf);
 			DevAssert(mbsfn_sf_confg->radioframeAllocationPeriod >=0);
@@ -1023,7 +1507,7 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 						&mbsfn_sf_confg->subframeAllocation.choice.oneFrame);
 			}
 			/** Add it to the MBSFN configuration items. */
-			ASN_SEQUENCE_ADD(&mbsfnAreaCfgItem->value.choice.MBSFN_Subframe_ConfigurationList.list, mbsfn_sf_confg);
+			ASN_SEQUENCE_ADD(&mbsfnAreaCfgItem->value.choice.MBSFN_Subframe_ConfigurationList.list, mbsfn_sf_confg_item);
 		}
 
 		/**
@@ -1044,24 +1528,13 @@ int m2ap_generate_mbms_scheduling_information(const m2ap_enb_description_t * m2_
 	}
 
 	/**
-	 * Encode and send it to all eNBs.
+	 * Encode it once, the caller sends it to all eNBs of the scheduling group.
 	 */
 	if (m2ap_mce_encode_pdu (&pdu, &buffer_p, &length) < 0) {
 		OAILOG_ERROR (LOG_M2AP, "Error encoding MBMS Scheduling Information.\n");
 		OAILOG_FUNC_RETURN(LOG_M2AP, RETURNerror);
 	}
-	bstring b = blk2bstr(buffer_p, length);
+	*payload = blk2bstr(buffer_p, length);
 	free(buffer_p);
-
-	/**
-	 * Todo: Encode and send it to all M2AP eNBs.. hash_callback.
-	 * Non-MBMS signalling -> stream 0
-	 */
-	int rc = m2ap_mce_itti_send_sctp_request (&b, m2_enb_description->sctp_assoc_id, M2AP_ENB_SERVICE_SCTP_STREAM_ID, INVALID_MCE_MBMS_M2AP_ID);
-	if(rc == RETURNerror){
-		OAILOG_ERROR (LOG_M2AP, "Error sending MBMS Scheduling Information to eNB with sctp_assoc=%d.\n", m2_enb_description->sctp_assoc_id);
-		/** Continue. */
-		OAILOG_FUNC_RETURN(LOG_M2AP, RETURNerror);
-	}
 	OAILOG_FUNC_RETURN(LOG_M2AP, RETURNok);
 }
@@ -31,6 +31,19 @@
 
 #include "common_defs.h"
 
+typedef struct m2ap_mbms_scheduling_cache_stats_s {
+  uint64_t    num_hits;           ///< Scheduling groups sent from a cached payload
+  uint64_t    num_misses;         ///< Scheduling groups encoded
+  uint64_t    num_uncacheable;    ///< Encoded payloads, where the MCCH Update Time could not be located
+  uint64_t    num_evictions;      ///< Entries removed, since they were not used in the last MBMS scheduling period
+} m2ap_mbms_scheduling_cache_stats_t;
+
+typedef struct m2ap_mbms_session_update_stats_s {
+  uint64_t    num_updates_sent;   ///< MBMS Session Update Requests sent to eNBs remaining in the MBMS Service Area
+  uint64_t    num_enbs_unchanged; ///< Remaining eNBs, which did not need any message
+  uint64_t    num_messages_saved; ///< M2AP messages saved against an MBMS Session Stop/Start of the remaining eNBs
+} m2ap_mbms_session_update_stats_t;
+
 /** \brief Handle MBMS Session Start Request from the MCE_APP.
  **/
 void
@@ -58,6 +71,22 @@ int m2ap_generate_mbms_session_stop_request(mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
  **/
 int m2ap_handle_m3ap_mbms_scheduling_info(itti_m3ap_mbms_scheduling_info_t * m3ap_mbms_scheduling_info);
 
+/** \brief Initialize the cache of encoded MBMS Scheduling Information.
+ **/
+int m2ap_mbms_scheduling_cache_init(void);
+
+/** \brief Remove all encoded MBMS Scheduling Information from the cache.
+ **/
+void m2ap_mbms_scheduling_cache_exit(void);
+
+/** \brief Copy the hit/miss counters of the MBMS Scheduling Information cache.
+ **/
+void m2ap_mbms_scheduling_cache_get_stats(m2ap_mbms_scheduling_cache_stats_t * const stats);
+
+/** \brief Copy the counters of the MBMS Session Updates.
+ **/
+void m2ap_mbms_session_update_get_stats(m2ap_mbms_session_update_stats_t * const stats);
+
 /** \brief Handles M2AP Timeouts.
  **/
 void m2ap_mce_handle_mbms_action_timer_expiry (void *arg);
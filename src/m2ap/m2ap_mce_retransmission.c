@@ -20,7 +20,10 @@
  */
 
 /*! \file m2ap_mce_retransmission.c
-  \brief
+  \brief Response timers of the MCE initiated M2AP procedures, with retransmission and backoff.
+  The outstanding procedures are kept in two RB trees, one ordered by eNB, procedure and MCE MBMS M2AP ID, to stop
+  the timer on the response, and one ordered by expiry, which is checked on a periodic tick. The tick only runs while
+  procedures are outstanding. Each operation costs O(log n) in the number of outstanding procedures.
   \author Dincer BEKEN
   \company Blackned GmbH
 */
@@ -29,55 +32,66 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "bstrlib.h"
 
 #include "tree.h"
+#include "hashtable.h"
 #include "assertions.h"
 #include "intertask_interface.h"
 #include "timer.h"
 #include "dynamic_memory_check.h"
+#include "mce_config.h"
+#include "m2ap_mce.h"
+#include "m2ap_mce_itti_messaging.h"
+#include "m2ap_mce_procedures.h"
 #include "m2ap_mce_retransmission.h"
 #include "log.h"
 
+/** Resolution of the response timers. */
+#define M2AP_TIMER_TICK_MS          100
+
 //------------------------------------------------------------------------------
-inline int                              m2ap_mce_timer_map_compare_id (
+static int                              m2ap_mce_timer_map_compare_expiry (
   const struct m2ap_timer_map_s * const p1,
   const struct m2ap_timer_map_s * const p2);
 
-/* Reference to tree root element */
+/* Reference to tree root elements */
 RB_HEAD (m2ap_timer_map, m2ap_timer_map_s) m2ap_timer_tree = RB_INITIALIZER ();
+RB_HEAD (m2ap_timer_expiry_map, m2ap_timer_map_s) m2ap_timer_expiry_tree = RB_INITIALIZER ();
 
-/* RB tree functions for s1ap timer map are not exposed to the rest of the code
+/* RB tree functions for m2ap timer map are not exposed to the rest of the code
    only declare prototypes here.
 */
 RB_PROTOTYPE (m2ap_timer_map, m2ap_timer_map_s, entries, m2ap_mce_timer_map_compare_id);
+RB_PROTOTYPE (m2ap_timer_expiry_map, m2ap_timer_map_s, expiry_entries, m2ap_mce_timer_map_compare_expiry);
 
 RB_GENERATE (m2ap_timer_map, m2ap_timer_map_s, entries, m2ap_mce_timer_map_compare_id);
+RB_GENERATE (m2ap_timer_expiry_map, m2ap_timer_map_s, expiry_entries, m2ap_mce_timer_map_compare_expiry);
+
+static long                             m2ap_timer_tick_id = M2AP_TIMER_INACTIVE_ID;
+static uint64_t                         m2ap_timer_seq = 0;
+static uint32_t                         m2ap_timer_num_outstanding = 0;
+static uint32_t                         m2ap_response_timer_ms = 0;
+static uint8_t                          m2ap_response_retransmissions = 0;
 
+//------------------------------------------------------------------------------
 int                                     m2ap_mce_timer_map_compare_id (
   const struct m2ap_timer_map_s * const p1,
   const struct m2ap_timer_map_s * const p2)
 {
-//  if (p1->mce_mbms_m2ap_id > 0) {
-//    if (p1->mce_mbms_m2ap_id > p2->mce_mbms_m2ap_id) {
-//      return 1;
-//    }
-//
-//    if (p1->mce_mbms_m2ap_id < p2->mce_mbms_m2ap_id) {
-//      return -1;
-//    }
-//
-//    return 0;
-//  }
-//
-//  if (p1->timer_id > p2->timer_id) {
-//    return 1;
-//  }
-//
-//  if (p1->timer_id < p2->timer_id) {
-//    return -1;
-//  }
+  if (p1->sctp_assoc_id != p2->sctp_assoc_id) {
+    return (p1->sctp_assoc_id > p2->sctp_assoc_id) ? 1 : -1;
+  }
+
+  if (p1->procedure_code != p2->procedure_code) {
+    return (p1->procedure_code > p2->procedure_code) ? 1 : -1;
+  }
+
+  if (p1->mce_mbms_m2ap_id != p2->mce_mbms_m2ap_id) {
+    return (p1->mce_mbms_m2ap_id > p2->mce_mbms_m2ap_id) ? 1 : -1;
+  }
 
   /*
    * Match -> return 0
@@ -86,81 +100,294 @@ int                                     m2ap_mce_timer_map_compare_id (
 }
 
 //------------------------------------------------------------------------------
-// TODO (amar) unused, check with OAI if we can remove.
+static int                              m2ap_mce_timer_map_compare_expiry (
+  const struct m2ap_timer_map_s * const p1,
+  const struct m2ap_timer_map_s * const p2)
+{
+  if (p1->expiry_ms != p2->expiry_ms) {
+    return (p1->expiry_ms > p2->expiry_ms) ? 1 : -1;
+  }
 
+  /** Same expiry, keep the arming order. */
+  if (p1->seq != p2->seq) {
+    return (p1->seq > p2->seq) ? 1 : -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t m2ap_timer_now_ms (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * (Re)arm the response timer of the procedure. The timeout doubles with each retransmission.
+ */
+static void
+m2ap_timer_arm (
+  struct m2ap_timer_map_s * const timer,
+  const uint64_t now_ms)
+{
+  timer->expiry_ms = now_ms + ((uint64_t)m2ap_response_timer_ms << timer->num_retransmissions);
+  timer->seq = m2ap_timer_seq++;
+  RB_INSERT (m2ap_timer_expiry_map, &m2ap_timer_expiry_tree, timer);
+}
+
+//------------------------------------------------------------------------------
+m2ap_timer_payload_t *
+m2ap_timer_payload_create (
+  const_bstring payload)
+{
+  m2ap_timer_payload_t                   *timer_payload = NULL;
+
+  if (!m2ap_response_timer_ms)
+    return NULL;
+
+  if ((timer_payload = calloc (1, sizeof (m2ap_timer_payload_t))) == NULL
+      || (timer_payload->data = bstrcpy (payload)) == NULL) {
+    OAILOG_ERROR (LOG_M2AP, "Failed to keep the M2AP request for the retransmissions\n");
+    if (timer_payload)
+      free_wrapper ((void**)&timer_payload);
+    return NULL;
+  }
+  timer_payload->refs = 1;
+  return timer_payload;
+}
+
+//------------------------------------------------------------------------------
+void
+m2ap_timer_payload_release (
+  m2ap_timer_payload_t ** payload)
+{
+  m2ap_timer_payload_t                   *timer_payload = *payload;
+
+  if (!timer_payload)
+    return;
+  *payload = NULL;
+  if (--timer_payload->refs)
+    return;
+  bdestroy_wrapper (&timer_payload->data);
+  free_wrapper ((void**)&timer_payload);
+}
+
+//------------------------------------------------------------------------------
+static void
+m2ap_timer_free (
+  struct m2ap_timer_map_s * timer)
+{
+  RB_REMOVE (m2ap_timer_map, &m2ap_timer_tree, timer);
+  RB_REMOVE (m2ap_timer_expiry_map, &m2ap_timer_expiry_tree, timer);
+  m2ap_timer_payload_release (&timer->payload);
+  free_wrapper ((void**)&timer);
+  /** Stop the tick with the last outstanding procedure. */
+  if (!--m2ap_timer_num_outstanding && m2ap_timer_tick_id != M2AP_TIMER_INACTIVE_ID) {
+    timer_remove (m2ap_timer_tick_id, NULL);
+    m2ap_timer_tick_id = M2AP_TIMER_INACTIVE_ID;
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+m2ap_timer_init (void)
+{
+  mce_config_read_lock (&mce_config);
+  m2ap_response_timer_ms = mce_config.mbms.m2ap_response_timer_ms;
+  m2ap_response_retransmissions = mce_config.mbms.m2ap_response_retransmissions;
+  mce_config_unlock (&mce_config);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void
+m2ap_timer_exit (void)
+{
+  struct m2ap_timer_map_s                *timer = NULL;
+
+  while ((timer = RB_MIN (m2ap_timer_map, &m2ap_timer_tree)) != NULL) {
+    m2ap_timer_free (timer);
+  }
+}
+
+//------------------------------------------------------------------------------
 int
 m2ap_timer_insert (
+  const sctp_assoc_id_t sctp_assoc_id,
+  const long procedure_code,
   const mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
-  const long timer_id)
+  const sctp_stream_id_t stream,
+  const_bstring payload)
 {
-  struct m2ap_timer_map_s                *new = NULL;
+  m2ap_timer_payload_t                   *timer_payload = NULL;
+  int                                     rc = 0;
 
-  new = malloc (sizeof (struct m2ap_timer_map_s));
-  new->timer_id = timer_id;
-  new->mce_mbms_m2ap_id = mce_mbms_m2ap_id;
+  if (!m2ap_response_timer_ms)
+    return 0;
 
-  if (RB_INSERT (m2ap_timer_map, &m2ap_timer_tree, new) != NULL) {
-    OAILOG_WARNING (LOG_S1AP, "Timer with id 0x%lx already exists\n", timer_id);
-    free_wrapper ((void**)&new);
+  if ((timer_payload = m2ap_timer_payload_create (payload)) == NULL)
     return -1;
-  }
+  rc = m2ap_timer_insert_shared (sctp_assoc_id, procedure_code, mce_mbms_m2ap_id, stream, timer_payload);
+  m2ap_timer_payload_release (&timer_payload);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int
+m2ap_timer_insert_shared (
+  const sctp_assoc_id_t sctp_assoc_id,
+  const long procedure_code,
+  const mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
+  const sctp_stream_id_t stream,
+  m2ap_timer_payload_t * const payload)
+{
+  struct m2ap_timer_map_s                 elm = {0};
+  struct m2ap_timer_map_s                *timer = NULL;
+
+  if (!m2ap_response_timer_ms || !payload)
+    return 0;
 
+  elm.sctp_assoc_id = sctp_assoc_id;
+  elm.procedure_code = procedure_code;
+  elm.mce_mbms_m2ap_id = mce_mbms_m2ap_id;
+  if ((timer = RB_FIND (m2ap_timer_map, &m2ap_timer_tree, &elm)) != NULL) {
+    /** A new request of the same procedure replaces the outstanding one. */
+    RB_REMOVE (m2ap_timer_expiry_map, &m2ap_timer_expiry_tree, timer);
+    m2ap_timer_payload_release (&timer->payload);
+  } else {
+    if (m2ap_timer_tick_id == M2AP_TIMER_INACTIVE_ID
+        && timer_setup (0, M2AP_TIMER_TICK_MS * 1000, TASK_M2AP, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &m2ap_timer_tick_id) < 0) {
+      OAILOG_ERROR (LOG_M2AP, "Failed to start the M2AP response timer tick\n");
+      m2ap_timer_tick_id = M2AP_TIMER_INACTIVE_ID;
+      return -1;
+    }
+    timer = calloc (1, sizeof (struct m2ap_timer_map_s));
+    *timer = elm;
+    RB_INSERT (m2ap_timer_map, &m2ap_timer_tree, timer);
+    m2ap_timer_num_outstanding++;
+  }
+  timer->stream = stream;
+  payload->refs++;
+  timer->payload = payload;
+  timer->num_retransmissions = 0;
+  m2ap_timer_arm (timer, m2ap_timer_now_ms ());
   return 0;
 }
 
 //------------------------------------------------------------------------------
 int
-m2ap_handle_timer_expiry (
-  timer_has_expired_t * timer_has_expired)
+m2ap_timer_remove (
+  const sctp_assoc_id_t sctp_assoc_id,
+  const long procedure_code,
+  const mce_mbms_m2ap_id_t mce_mbms_m2ap_id)
 {
-//  struct m2ap_timer_map_s                *find = NULL;
-//  struct m2ap_timer_map_s                 elm = {0};
-//
-//  DevAssert (timer_has_expired != NULL);
-//  memset (&elm, 0, sizeof (elm));
-//  elm.timer_id = timer_has_expired->timer_id;
-//
-//  if ((find = RB_FIND (m2ap_timer_map, &m2ap_timer_tree, &elm)) == NULL) {
-//    OAILOG_WARNING (LOG_S1AP, "Timer id 0x%lx has not been found in tree. Maybe the timer " "reference has been removed before receiving timer signal\n", timer_has_expired->timer_id);
-//    return 0;
-//  }
-//
-//  /*
-//   * Remove the timer from the map
-//   */
-//  RB_REMOVE (m2ap_timer_map, &m2ap_timer_tree, find);
-//  /*
-//   * Destroy the element
-//   */
-//  free_wrapper ((void**)&find);
-//  /*
-//   * TODO: notify NAS and remove ue context
-//   */
+  struct m2ap_timer_map_s                 elm = {0};
+  struct m2ap_timer_map_s                *timer = NULL;
+
+  elm.sctp_assoc_id = sctp_assoc_id;
+  elm.procedure_code = procedure_code;
+  elm.mce_mbms_m2ap_id = mce_mbms_m2ap_id;
+  if ((timer = RB_FIND (m2ap_timer_map, &m2ap_timer_tree, &elm)) == NULL) {
+    return -1;
+  }
+  m2ap_timer_free (timer);
   return 0;
 }
 
 //------------------------------------------------------------------------------
-// TODO: (amar) unused check with OAI.
-int
-m2ap_timer_remove_ue (
+void
+m2ap_timer_remove_enb (
+  const sctp_assoc_id_t sctp_assoc_id)
+{
+  struct m2ap_timer_map_s                *timer = RB_ROOT (&m2ap_timer_tree);
+  struct m2ap_timer_map_s                *first = NULL;
+
+  /** Find the first procedure of the eNB, the procedures of an eNB are neighbours in the tree. */
+  while (timer) {
+    if (timer->sctp_assoc_id >= sctp_assoc_id) {
+      first = timer;
+      timer = RB_LEFT (timer, entries);
+    } else {
+      timer = RB_RIGHT (timer, entries);
+    }
+  }
+  while (first && first->sctp_assoc_id == sctp_assoc_id) {
+    timer = first;
+    first = RB_NEXT (m2ap_timer_map, &m2ap_timer_tree, first);
+    m2ap_timer_free (timer);
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The eNB did not answer the MBMS Session Update: stop the MBMS Service on the eNB, as for a Session Update Failure.
+ */
+static void
+m2ap_timer_session_update_timeout (
+  m2ap_enb_description_t * const m2ap_enb_ref,
   const mce_mbms_m2ap_id_t mce_mbms_m2ap_id)
 {
-  struct m2ap_timer_map_s                *find = NULL;
-
-//  OAILOG_DEBUG (LOG_S1AP, "Removing timer associated with UE " mce_mbms_m2ap_id_FMT "\n", mce_mbms_m2ap_id);
-//  DevAssert (mce_mbms_m2ap_id != 0);
-//  RB_FOREACH (find, m2ap_timer_map, &m2ap_timer_tree) {
-//    if (find->mce_mbms_m2ap_id == mce_mbms_m2ap_id) {
-//      timer_remove (find->timer_id, NULL);
-//      /*
-//       * Remove the timer from the map
-//       */
-//      RB_REMOVE (m2ap_timer_map, &m2ap_timer_tree, find);
-//      /*
-//       * Destroy the element
-//       */
-//      free_wrapper ((void**)&find);
-//    }
-//  }
+  mbms_description_t                     *mbms_ref = m2ap_is_mbms_mce_m2ap_id_in_list (mce_mbms_m2ap_id);
+
+  if (!mbms_ref)
+    return;
+  m2ap_generate_mbms_session_stop_request (mce_mbms_m2ap_id, m2ap_enb_ref->sctp_assoc_id);
+  hashtable_uint64_ts_free (&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)m2ap_enb_ref->sctp_assoc_id);
+  if (m2ap_enb_ref->nb_mbms_associated)
+    m2ap_enb_ref->nb_mbms_associated--;
+}
+
+//------------------------------------------------------------------------------
+int
+m2ap_handle_timer_expiry (
+  timer_has_expired_t * timer_has_expired)
+{
+  struct m2ap_timer_map_s                *timer = NULL;
+  m2ap_enb_description_t                 *m2ap_enb_ref = NULL;
+  uint64_t                                now_ms = 0;
+
+  DevAssert (timer_has_expired != NULL);
+  if (m2ap_timer_tick_id == M2AP_TIMER_INACTIVE_ID || timer_has_expired->timer_id != m2ap_timer_tick_id) {
+    return -1;
+  }
+
+  now_ms = m2ap_timer_now_ms ();
+  while ((timer = RB_MIN (m2ap_timer_expiry_map, &m2ap_timer_expiry_tree)) != NULL && timer->expiry_ms <= now_ms) {
+    const sctp_assoc_id_t    sctp_assoc_id = timer->sctp_assoc_id;
+    const long               procedure_code = timer->procedure_code;
+    const mce_mbms_m2ap_id_t mce_mbms_m2ap_id = timer->mce_mbms_m2ap_id;
+
+    m2ap_enb_ref = m2ap_is_enb_assoc_id_in_list (sctp_assoc_id);
+    /** The MBMS Service of a Session Start or Update may be removed in the meantime. */
+    if (!m2ap_enb_ref
+        || ((procedure_code == M2AP_ProcedureCode_id_sessionStart || procedure_code == M2AP_ProcedureCode_id_sessionUpdate)
+            && !m2ap_is_mbms_mce_m2ap_id_in_list (mce_mbms_m2ap_id))) {
+      m2ap_timer_free (timer);
+      continue;
+    }
+
+    if (timer->num_retransmissions < m2ap_response_retransmissions) {
+      bstring b = bstrcpy (timer->payload->data);
+      RB_REMOVE (m2ap_timer_expiry_map, &m2ap_timer_expiry_tree, timer);
+      timer->num_retransmissions++;
+      m2ap_enb_ref->num_m2ap_retransmissions++;
+      OAILOG_WARNING (LOG_M2AP, "No response of eNB with SCTP Assoc Id (%d) for M2AP procedure %ld (MCE MBMS M2AP ID " MCE_MBMS_M2AP_ID_FMT "), "
+          "retransmission %d.\n", sctp_assoc_id, procedure_code, mce_mbms_m2ap_id, timer->num_retransmissions);
+      m2ap_mce_itti_send_sctp_request (&b, sctp_assoc_id, timer->stream, mce_mbms_m2ap_id);
+      m2ap_timer_arm (timer, now_ms);
+      continue;
+    }
+
+    m2ap_enb_ref->num_m2ap_timeouts++;
+    OAILOG_ERROR (LOG_M2AP, "M2AP procedure %ld (MCE MBMS M2AP ID " MCE_MBMS_M2AP_ID_FMT ") timed out for eNB with SCTP Assoc Id (%d) after %d retransmissions. "
+        "Timeouts of the eNB (%u), retransmissions (%u).\n", procedure_code, mce_mbms_m2ap_id, sctp_assoc_id, timer->num_retransmissions,
+        m2ap_enb_ref->num_m2ap_timeouts, m2ap_enb_ref->num_m2ap_retransmissions);
+    m2ap_timer_free (timer);
+    if (procedure_code == M2AP_ProcedureCode_id_sessionUpdate) {
+      m2ap_timer_session_update_timeout (m2ap_enb_ref, mce_mbms_m2ap_id);
+    }
+  }
   return 0;
 }
@@ -21,7 +21,7 @@
 
 
 /*! \file m2ap_mce_retransmission.h
-  \brief
+  \brief Response timers of the MCE initiated M2AP procedures, with retransmission and backoff.
   \author Dincer BEKEN
   \company Blackned GmbH
 */
@@ -29,23 +29,73 @@
 #ifndef FILE_M2AP_MCE_RETRANSMISSION_SEEN
 #define FILE_M2AP_MCE_RETRANSMISSION_SEEN
 
+#include "bstrlib.h"
 #include "tree.h"
 
+/** Encoded request kept for the retransmissions, shared by the timers of all eNBs it was sent to. */
+typedef struct m2ap_timer_payload_s {
+  bstring            data;
+  uint32_t           refs;                  ///< Timers holding the payload, plus the creator until it releases it
+} m2ap_timer_payload_t;
+
+/** Outstanding M2AP procedure of an eNB, waiting for the response. */
 typedef struct m2ap_timer_map_s {
-  long               timer_id;
-  mce_mbms_m2ap_id_t mce_mbms_m2ap_id;
+  sctp_assoc_id_t    sctp_assoc_id;
+  long               procedure_code;
+  mce_mbms_m2ap_id_t mce_mbms_m2ap_id;      ///< INVALID_MCE_MBMS_M2AP_ID for procedures not related to an MBMS Service
+  sctp_stream_id_t   stream;
+  m2ap_timer_payload_t *payload;            ///< Encoded request, for the retransmissions
+  int                num_retransmissions;
+  uint64_t           expiry_ms;
+  uint64_t           seq;                   ///< Orders timers with the same expiry
 
   RB_ENTRY(m2ap_timer_map_s) entries;
+  RB_ENTRY(m2ap_timer_map_s) expiry_entries;
 } m2ap_timer_map_t;
 
 int m2ap_mce_timer_map_compare_id(
   const struct m2ap_timer_map_s * const p1, const struct m2ap_timer_map_s * const p2);
 
+/** \brief Read the response timer configuration.
+ **/
+int m2ap_timer_init(void);
+
+/** \brief Drop all outstanding procedures.
+ **/
+void m2ap_timer_exit(void);
+
+/** \brief Handle the expiry of an M2AP timer.
+ * @returns 0 if the timer is the tick of the response timers, -1 if it belongs to someone else
+ **/
 int m2ap_handle_timer_expiry(timer_has_expired_t *timer_has_expired);
 
-// TODO: (amar) unused functions check with OAI.
-int m2ap_timer_insert(const mce_mbms_m2ap_id_t mce_mbms_m2ap_id, const long timer_id);
+/** \brief Start the response timer of a request sent to an eNB. A copy of the payload is kept for the retransmissions.
+ * An outstanding request of the same procedure is replaced. Nothing is done if no response timer is configured.
+ **/
+int m2ap_timer_insert(const sctp_assoc_id_t sctp_assoc_id, const long procedure_code, const mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
+  const sctp_stream_id_t stream, const_bstring payload);
+
+/** \brief Copy a request sent to several eNBs once, for the response timers of all of them (m2ap_timer_insert_shared).
+ * @returns NULL if no response timer is configured or no memory is left
+ **/
+m2ap_timer_payload_t *m2ap_timer_payload_create(const_bstring payload);
+
+/** \brief Drop the reference of the creator, the payload is freed with the last timer holding it.
+ **/
+void m2ap_timer_payload_release(m2ap_timer_payload_t **payload);
+
+/** \brief Same as m2ap_timer_insert, the timer takes a reference on the shared payload. Nothing is done for a NULL payload.
+ **/
+int m2ap_timer_insert_shared(const sctp_assoc_id_t sctp_assoc_id, const long procedure_code, const mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
+  const sctp_stream_id_t stream, m2ap_timer_payload_t * const payload);
+
+/** \brief Stop the response timer on the response (or failure) of the eNB.
+ * @returns -1 if no such procedure is outstanding
+ **/
+int m2ap_timer_remove(const sctp_assoc_id_t sctp_assoc_id, const long procedure_code, const mce_mbms_m2ap_id_t mce_mbms_m2ap_id);
 
-int m2ap_timer_remove_ue(const mce_mbms_m2ap_id_t mce_mbms_m2ap_id);
+/** \brief Stop all response timers of an eNB.
+ **/
+void m2ap_timer_remove_enb(const sctp_assoc_id_t sctp_assoc_id);
 
 #endif /* FILE_M2AP_MCE_RETRANSMISSION_SEEN */
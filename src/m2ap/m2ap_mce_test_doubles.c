@@ -0,0 +1,104 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_mce_test_doubles.c
+  \brief Test doubles of the SCTP, ITTI and timer interfaces of the M2AP MCE layer.
+  The SCTP requests are handed to the test by m2ap_test_sent, the response timers are never started and ITTI messages are dropped.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "intertask_interface.h"
+#include "timer.h"
+#include "mce_config.h"
+#include "m2ap_mce.h"
+#include "m2ap_mce_handlers.h"
+#include "m2ap_mce_itti_messaging.h"
+#include "m2ap_mce_retransmission.h"
+#include "sctp_primitives_server.h"
+#include "mce_app_statistics.h"
+#include "m2ap_mce_test_doubles.h"
+
+mce_config_t                                mce_config = {.rw_lock = PTHREAD_RWLOCK_INITIALIZER, 0};
+
+//------------------------------------------------------------------------------
+int m2ap_mce_itti_send_sctp_request (STOLEN_REF bstring *payload, const uint32_t sctp_assoc_id,
+  const sctp_stream_id_t stream, const mce_mbms_m2ap_id_t mbms_id)
+{
+  m2ap_test_sent(*payload, sctp_assoc_id);
+  bdestroy_wrapper(payload);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int m2ap_mce_itti_send_sctp_multi_request (STOLEN_REF bstring *payload, const int num_assocs,
+  const sctp_assoc_id_t * const assoc_ids, const sctp_stream_id_t stream)
+{
+  for(int i = 0; i < num_assocs; i++)
+    m2ap_test_sent(*payload, assoc_ids[i]);
+  bdestroy_wrapper(payload);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int m2ap_timer_init (void) { return 0; }
+void m2ap_timer_exit (void) { }
+int m2ap_timer_insert (const sctp_assoc_id_t sctp_assoc_id, const long procedure_code, const mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
+  const sctp_stream_id_t stream, const_bstring payload) { return 0; }
+m2ap_timer_payload_t *m2ap_timer_payload_create (const_bstring payload) { return NULL; }
+void m2ap_timer_payload_release (m2ap_timer_payload_t **payload) { }
+int m2ap_timer_insert_shared (const sctp_assoc_id_t sctp_assoc_id, const long procedure_code, const mce_mbms_m2ap_id_t mce_mbms_m2ap_id,
+  const sctp_stream_id_t stream, m2ap_timer_payload_t * const payload) { return 0; }
+void m2ap_timer_remove_enb (const sctp_assoc_id_t sctp_assoc_id) { }
+int m2ap_handle_timer_expiry (timer_has_expired_t *timer_has_expired) { return -1; }
+int timer_setup (uint32_t interval_sec, uint32_t interval_us, task_id_t task_id, int32_t instance, timer_type_t type,
+  void *timer_arg, long *timer_id) { return -1; }
+int timer_remove (long timer_id, void ** arg) { return 0; }
+
+//------------------------------------------------------------------------------
+int m2ap_mce_handle_message (const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream, M2AP_M2AP_PDU_t *pdu) { return 0; }
+int m2ap_handle_new_association (sctp_new_peer_t *sctp_new_peer_p) { return 0; }
+int m2ap_handle_sctp_disconnection (const sctp_assoc_id_t assoc_id) { return 0; }
+int m2ap_handle_m3ap_enb_setup_res (itti_m3ap_enb_setup_res_t * m3ap_enb_setup_res) { return 0; }
+int m3ap_handle_enb_initiated_reset_ack (const itti_m3ap_enb_initiated_reset_ack_t * const m2ap_enb_reset_ack_p) { return 0; }
+void m2ap_m2_setup_admission_release (m2ap_enb_description_t * const m2ap_enb_association) { }
+void update_mce_app_stats_connected_m2ap_enb_sub (void) { }
+void sctp_release_recv_buffer (bstring * const payload) { bdestroy_wrapper(payload); }
+
+//------------------------------------------------------------------------------
+MessageDef *itti_alloc_new_message (task_id_t origin_task_id, MessagesIds message_id) { return NULL; }
+int itti_send_msg_to_task (task_id_t task_id, instance_t instance, MessageDef *message) { return 0; }
+void itti_receive_msg (task_id_t task_id, MessageDef **received_msg) { *received_msg = NULL; }
+int itti_create_task (task_id_t task_id, void *(*start_routine) (void *), void *args_p) { return 0; }
+void itti_mark_task_ready (task_id_t task_id) { }
+void itti_exit_task (void) { pthread_exit(NULL); }
+int itti_free (task_id_t task_id, void *ptr) { free(ptr); return 0; }
+void itti_free_msg_content (MessageDef * const message_p) { }
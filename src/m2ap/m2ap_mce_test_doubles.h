@@ -0,0 +1,40 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_mce_test_doubles.h
+  \brief Test doubles of the SCTP, ITTI and timer interfaces of the M2AP MCE layer.
+  Linked into the tests built with the M2AP MCE procedures, instead of the SCTP, ITTI and timer tasks.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#ifndef FILE_M2AP_MCE_TEST_DOUBLES_SEEN
+#define FILE_M2AP_MCE_TEST_DOUBLES_SEEN
+
+#include "bstrlib.h"
+#include "common_types.h"
+
+/** \brief Called for every M2AP message handed to the SCTP task, once per SCTP association. Defined by the test.
+ **/
+void m2ap_test_sent (const_bstring payload, const sctp_assoc_id_t sctp_assoc_id);
+
+#endif /* FILE_M2AP_MCE_TEST_DOUBLES_SEEN */
@@ -0,0 +1,267 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_scheduling_cache_test.c
+  \brief Check the cache of the encoded MBMS Scheduling Information over consecutive MBMS scheduling periods.
+  The test is linked with the M2AP MCE procedures and the test doubles of the SCTP, ITTI and timer interfaces.
+  Every M2AP message sent is decoded and its MCCH Update Time checked. The payloads of cache hits and of changed
+  MBSFN area configurations are compared against a fresh encoding of the same period, with an emptied cache.
+  Exits with 1 if any count or payload differs from the expected one.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "hashtable.h"
+#include "intertask_interface.h"
+#include "mce_config.h"
+#include "m2ap_common.h"
+#include "m2ap_mce.h"
+#include "m2ap_mce_procedures.h"
+#include "m2ap_mce_test_doubles.h"
+
+#define M2AP_SCHEDULING_CACHE_TEST_ENBS           8
+#define M2AP_SCHEDULING_CACHE_TEST_MBSFN_AREAS    2
+#define M2AP_SCHEDULING_CACHE_TEST_MODIF_RF       512   ///< MCCH modification period of all MBSFN areas
+
+extern hash_table_ts_t                      g_m2ap_enb_coll;  // SCTP Association ID association to M2AP eNB Reference;
+
+/** MBMS Scheduling Information sent per SCTP association (the eNB index) in the last MBMS scheduling period. */
+static int                                  m2ap_test_counts[M2AP_SCHEDULING_CACHE_TEST_ENBS + 1];
+static bstring                              m2ap_test_payloads[M2AP_SCHEDULING_CACHE_TEST_ENBS + 1];
+static long                                 m2ap_test_mcch_update_time = -1;
+static int                                  m2ap_test_errors = 0;
+static itti_m3ap_mbms_scheduling_info_t     m2ap_test_scheduling_info;
+
+/****************************************************************************/
+/**************************  M E S S A G E S   S E N T  *********************/
+/****************************************************************************/
+
+//------------------------------------------------------------------------------
+static long m2ap_test_decoded_mcch_update_time (const M2AP_M2AP_PDU_t * const pdu)
+{
+  const M2AP_MbmsSchedulingInformation_t * const msg = &pdu->choice.initiatingMessage.value.choice.MbmsSchedulingInformation;
+  for(int i = 0; i < msg->protocolIEs.list.count; i++) {
+    if(msg->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_MCCH_Update_Time)
+      return msg->protocolIEs.list.array[i]->value.choice.MCCH_Update_Time;
+  }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_test_sent (const_bstring payload, const sctp_assoc_id_t sctp_assoc_id)
+{
+  M2AP_M2AP_PDU_t                      *pdu = NULL;
+  asn_dec_rval_t                        dec_ret;
+  long                                  mcch_update_time = -1;
+
+  if(!sctp_assoc_id || sctp_assoc_id > M2AP_SCHEDULING_CACHE_TEST_ENBS) {
+    fprintf(stderr, "M2AP message sent to unknown SCTP assoc id (%u)\n", sctp_assoc_id);
+    m2ap_test_errors++;
+    return;
+  }
+  dec_ret = aper_decode(NULL, &asn_DEF_M2AP_M2AP_PDU, (void **)&pdu, payload->data, blength(payload), 0, 0);
+  if(dec_ret.code != RC_OK || pdu->present != M2AP_M2AP_PDU_PR_initiatingMessage
+      || pdu->choice.initiatingMessage.procedureCode != M2AP_ProcedureCode_id_mbmsSchedulingInformation) {
+    fprintf(stderr, "Undecodable or unexpected M2AP message sent to SCTP assoc id (%u)\n", sctp_assoc_id);
+    m2ap_test_errors++;
+    ASN_STRUCT_FREE(asn_DEF_M2AP_M2AP_PDU, pdu);
+    return;
+  }
+  /** A cached payload must carry the MCCH Update Time of this period, not the one it was encoded with. */
+  mcch_update_time = m2ap_test_decoded_mcch_update_time(pdu);
+  if(mcch_update_time != m2ap_test_mcch_update_time) {
+    fprintf(stderr, "MBMS Scheduling Information with MCCH Update Time (%ld) sent to SCTP assoc id (%u), expected (%ld)\n",
+        mcch_update_time, sctp_assoc_id, m2ap_test_mcch_update_time);
+    m2ap_test_errors++;
+  }
+  m2ap_test_counts[sctp_assoc_id]++;
+  bdestroy_wrapper(&m2ap_test_payloads[sctp_assoc_id]);
+  m2ap_test_payloads[sctp_assoc_id] = bstrcpy(payload);
+  ASN_STRUCT_FREE(asn_DEF_M2AP_M2AP_PDU, pdu);
+}
+
+/****************************************************************************/
+/*******************************  T E S T S  ********************************/
+/****************************************************************************/
+
+//------------------------------------------------------------------------------
+static void m2ap_test_add_enb (const sctp_assoc_id_t sctp_assoc_id, const int num_mbsfn_areas)
+{
+  m2ap_enb_description_t               *m2ap_enb_ref = m2ap_new_enb();
+
+  m2ap_enb_ref->sctp_assoc_id = sctp_assoc_id;
+  m2ap_enb_ref->m2ap_enb_id = sctp_assoc_id;
+  m2ap_enb_ref->m2_state = M2AP_READY;
+  m2ap_enb_ref->local_mbms_area = 0;
+  m2ap_enb_ref->mbsfn_area_ids.num_mbsfn_area_ids = num_mbsfn_areas;
+  for(int i = 0; i < num_mbsfn_areas; i++)
+    m2ap_enb_ref->mbsfn_area_ids.mbsfn_area_id[i] = i + 1;
+  DevAssert(hashtable_ts_insert(&g_m2ap_enb_coll, (const hash_key_t)sctp_assoc_id, (void *)m2ap_enb_ref) == HASH_TABLE_OK);
+  m2ap_enb_index_add(m2ap_enb_ref);
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_add_mbsfn_area (mbsfn_area_cfg_t * const cfg, const mbsfn_area_id_t mbsfn_area_id)
+{
+  cfg->mbsfnArea.mbsfn_area_id = mbsfn_area_id;
+  cfg->mbsfnArea.mbsfn_csa_period_rf = 128;
+  cfg->mbsfnArea.mcch_modif_period_rf = M2AP_SCHEDULING_CACHE_TEST_MODIF_RF;
+  cfg->csa_patterns.csa_pattern[0].mbms_csa_pattern_rfs = CSA_FOUR_FRAME;
+  cfg->csa_patterns.csa_pattern[0].csa_pattern_repetition_period_rf = 16;
+  cfg->csa_patterns.csa_pattern[0].csa_pattern_offset_rf = 1;
+  cfg->csa_patterns.csa_pattern[0].csa_pattern_sf.mbms_mch_csa_pattern_4rf = 0xfff000 >> mbsfn_area_id;
+  for(int n_mch = 0; n_mch < 2; n_mch++) {
+    mch_t * const mch = &cfg->mchs.mch_array[n_mch];
+    mch->mch_qci = n_mch + 1;
+    mch->mch_subframe_stop = 10 * (n_mch + 1);
+    mch->mcs = 10;
+    mch->msp_rf = 128;
+    mch->mbms_session_list.num_mbms_sessions = 2;
+    for(int num_mbms_session = 0; num_mbms_session < 2; num_mbms_session++) {
+      tmgi_t * const tmgi = &mch->mbms_session_list.tmgis[num_mbms_session];
+      tmgi->mbms_service_id = (mbsfn_area_id * 100) + (n_mch * 10) + num_mbms_session;
+      tmgi->plmn.mcc_digit3 = 1;
+      tmgi->plmn.mnc_digit2 = 1;
+      tmgi->plmn.mnc_digit3 = 0xF;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_schedule (const long mcch_rep_abs_rf)
+{
+  memset(m2ap_test_counts, 0, sizeof(m2ap_test_counts));
+  m2ap_test_mcch_update_time = (mcch_rep_abs_rf / M2AP_SCHEDULING_CACHE_TEST_MODIF_RF) % 256;
+  m2ap_test_scheduling_info.mcch_rep_abs_rf = mcch_rep_abs_rf;
+  m2ap_handle_m3ap_mbms_scheduling_info(&m2ap_test_scheduling_info);
+  for(int i = 1; i <= M2AP_SCHEDULING_CACHE_TEST_ENBS; i++) {
+    if(m2ap_test_counts[i] != 1) {
+      fprintf(stderr, "Period (%ld): eNB (%d) got (%d) MBMS Scheduling Information, expected (1)\n", mcch_rep_abs_rf, i, m2ap_test_counts[i]);
+      m2ap_test_errors++;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_expect_stats (const char * const step, const m2ap_mbms_scheduling_cache_stats_t * const before,
+  const uint64_t hits, const uint64_t misses, const uint64_t evictions)
+{
+  m2ap_mbms_scheduling_cache_stats_t    after = {0};
+
+  m2ap_mbms_scheduling_cache_get_stats(&after);
+  printf("%-44s hits %2lu  misses %2lu  uncacheable %2lu  evictions %2lu\n", step, after.num_hits - before->num_hits,
+      after.num_misses - before->num_misses, after.num_uncacheable - before->num_uncacheable, after.num_evictions - before->num_evictions);
+  if(after.num_hits - before->num_hits != hits || after.num_misses - before->num_misses != misses
+      || after.num_evictions - before->num_evictions != evictions || after.num_uncacheable != before->num_uncacheable) {
+    fprintf(stderr, "%s: expected (%lu) hits, (%lu) misses, (%lu) evictions and no uncacheable payloads\n", step, hits, misses, evictions);
+    m2ap_test_errors++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_expect_fresh_encoding (const char * const step, const long mcch_rep_abs_rf)
+{
+  bstring                               sent[M2AP_SCHEDULING_CACHE_TEST_ENBS + 1] = {NULL};
+
+  /** Move the payloads of the period away and encode it again without any cached payloads. */
+  memcpy(sent, m2ap_test_payloads, sizeof(sent));
+  memset(m2ap_test_payloads, 0, sizeof(m2ap_test_payloads));
+  m2ap_mbms_scheduling_cache_exit();
+  DevAssert(m2ap_mbms_scheduling_cache_init() == RETURNok);
+  m2ap_test_schedule(mcch_rep_abs_rf);
+  for(int i = 1; i <= M2AP_SCHEDULING_CACHE_TEST_ENBS; i++) {
+    if(!sent[i] || !m2ap_test_payloads[i] || biseq(sent[i], m2ap_test_payloads[i]) != 1) {
+      fprintf(stderr, "%s: payload sent to eNB (%d) differs from a fresh encoding\n", step, i);
+      m2ap_test_errors++;
+    }
+    bdestroy_wrapper(&sent[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  /**
+   * eNBs 1-4 broadcast both MBSFN areas and eNBs 5-8 only the first one, giving two scheduling groups.
+   * Changing the second MBSFN area must only invalidate the payload of the first group.
+   */
+  mbsfn_areas_t * const                 mbsfn_cluster = &m2ap_test_scheduling_info.mbsfn_cluster[0];
+  m2ap_mbms_scheduling_cache_stats_t    stats_before = {0};
+
+  mce_config.mbms.max_m2_enbs = M2AP_SCHEDULING_CACHE_TEST_ENBS;
+  mce_config.mbms.max_mbms_services = 16;
+  mce_config.mbms.m2ap_encoder_threads = 0;
+  if(m2ap_mce_init() != RETURNok) {
+    fprintf(stderr, "Error initializing the M2AP MCE layer\n");
+    return 1;
+  }
+  for(int i = 1; i <= M2AP_SCHEDULING_CACHE_TEST_ENBS; i++)
+    m2ap_test_add_enb(i, (i <= 4) ? M2AP_SCHEDULING_CACHE_TEST_MBSFN_AREAS : 1);
+  mbsfn_cluster->num_mbsfn_areas = M2AP_SCHEDULING_CACHE_TEST_MBSFN_AREAS;
+  for(int num_mbsfn = 0; num_mbsfn < M2AP_SCHEDULING_CACHE_TEST_MBSFN_AREAS; num_mbsfn++)
+    m2ap_test_add_mbsfn_area(&mbsfn_cluster->mbsfn_area_cfg[num_mbsfn], num_mbsfn + 1);
+
+  /** First period, nothing cached yet. */
+  m2ap_mbms_scheduling_cache_get_stats(&stats_before);
+  m2ap_test_schedule(1 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+  m2ap_test_expect_stats("Period 1 (empty cache)", &stats_before, 0, 2, 0);
+
+  /** Unchanged MBSFN area configurations, both payloads are reused with the new MCCH Update Time. */
+  m2ap_mbms_scheduling_cache_get_stats(&stats_before);
+  m2ap_test_schedule(2 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+  m2ap_test_expect_stats("Period 2 (unchanged)", &stats_before, 2, 0, 0);
+  m2ap_test_expect_fresh_encoding("Period 2 (unchanged)", 2 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+
+  /** A new MCS of the second MBSFN area, only the group of eNBs 1-4 is encoded again and its old payload evicted. */
+  mbsfn_cluster->mbsfn_area_cfg[1].mchs.mch_array[0].mcs = 20;
+  m2ap_mbms_scheduling_cache_get_stats(&stats_before);
+  m2ap_test_schedule(3 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+  m2ap_test_expect_stats("Period 3 (MCS of MBSFN area 2 changed)", &stats_before, 1, 1, 1);
+  if(biseq(m2ap_test_payloads[1], m2ap_test_payloads[5]) != 0) {
+    fprintf(stderr, "Period 3 (MCS of MBSFN area 2 changed): eNBs of different MBSFN areas got the same payload\n");
+    m2ap_test_errors++;
+  }
+  m2ap_test_expect_fresh_encoding("Period 3 (MCS of MBSFN area 2 changed)", 3 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+
+  /** An MBMS Session of the first MBSFN area ends, both groups are encoded again. */
+  mbsfn_cluster->mbsfn_area_cfg[0].mchs.mch_array[1].mbms_session_list.num_mbms_sessions = 1;
+  m2ap_mbms_scheduling_cache_get_stats(&stats_before);
+  m2ap_test_schedule(4 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+  m2ap_test_expect_stats("Period 4 (MBMS Session of MBSFN area 1 gone)", &stats_before, 0, 2, 2);
+  m2ap_test_expect_fresh_encoding("Period 4 (MBMS Session of MBSFN area 1 gone)", 4 * M2AP_SCHEDULING_CACHE_TEST_MODIF_RF);
+
+  printf("MBMS Scheduling Information cache checked over (4) MBMS scheduling periods, (%d) errors\n", m2ap_test_errors);
+  for(int i = 1; i <= M2AP_SCHEDULING_CACHE_TEST_ENBS; i++)
+    bdestroy_wrapper(&m2ap_test_payloads[i]);
+  m2ap_mce_exit();
+  return m2ap_test_errors ? 1 : 0;
+}
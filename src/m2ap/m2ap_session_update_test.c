@@ -0,0 +1,357 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file m2ap_session_update_test.c
+  \brief Count the M2AP messages sent to each eNB for an MBMS Session Update, against a stop/start cycle of the same MBMS Service.
+  The test is linked with the M2AP MCE procedures and the test doubles of the SCTP, ITTI and timer interfaces.
+  Every M2AP message sent is decoded and counted per eNB and procedure. The eNB responses are simulated by adding
+  the eNB MBMS M2AP IDs to the MBMS Service, as the MBMS Session Start Response handler does.
+  Exits with 1 if any count differs from the expected one.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "hashtable.h"
+#include "intertask_interface.h"
+#include "mce_config.h"
+#include "m2ap_common.h"
+#include "m2ap_mce.h"
+#include "m2ap_mce_procedures.h"
+#include "m2ap_mce_test_doubles.h"
+
+#define M2AP_SESSION_UPDATE_TEST_ENBS         8
+#define M2AP_SESSION_UPDATE_TEST_SAI_1        1
+#define M2AP_SESSION_UPDATE_TEST_SAI_2        2
+#define M2AP_SESSION_UPDATE_TEST_ENB_MBMS_ID  0x100   ///< Base of the simulated eNB MBMS M2AP IDs, the SCTP assoc id is added
+
+typedef enum m2ap_session_update_test_procedure_e {
+  M2AP_TEST_SESSION_START = 0,
+  M2AP_TEST_SESSION_STOP,
+  M2AP_TEST_SESSION_UPDATE,
+  M2AP_TEST_PROCEDURE_MAX
+} m2ap_session_update_test_procedure_t;
+
+extern hash_table_ts_t                      g_m2ap_enb_coll;  // SCTP Association ID association to M2AP eNB Reference;
+
+/** Messages sent per SCTP association (the eNB index) and procedure since the last reset. */
+static int                                  m2ap_test_counts[M2AP_SESSION_UPDATE_TEST_ENBS + 1][M2AP_TEST_PROCEDURE_MAX];
+static int                                  m2ap_test_errors = 0;
+static m2ap_enb_description_t              *m2ap_test_enbs[M2AP_SESSION_UPDATE_TEST_ENBS + 1];
+
+/****************************************************************************/
+/**************************  M E S S A G E S   S E N T  *********************/
+/****************************************************************************/
+
+//------------------------------------------------------------------------------
+static enb_mbms_m2ap_id_t m2ap_test_decoded_enb_mbms_m2ap_id (const M2AP_M2AP_PDU_t * const pdu)
+{
+  const long procedure_code = pdu->choice.initiatingMessage.procedureCode;
+  if(procedure_code == M2AP_ProcedureCode_id_sessionStop) {
+    const M2AP_SessionStopRequest_t * const msg = &pdu->choice.initiatingMessage.value.choice.SessionStopRequest;
+    for(int i = 0; i < msg->protocolIEs.list.count; i++) {
+      if(msg->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID)
+        return (enb_mbms_m2ap_id_t)msg->protocolIEs.list.array[i]->value.choice.ENB_MBMS_M2AP_ID;
+    }
+  } else if(procedure_code == M2AP_ProcedureCode_id_sessionUpdate) {
+    const M2AP_SessionUpdateRequest_t * const msg = &pdu->choice.initiatingMessage.value.choice.SessionUpdateRequest;
+    for(int i = 0; i < msg->protocolIEs.list.count; i++) {
+      if(msg->protocolIEs.list.array[i]->id == M2AP_ProtocolIE_ID_id_ENB_MBMS_M2AP_ID)
+        return (enb_mbms_m2ap_id_t)msg->protocolIEs.list.array[i]->value.choice.ENB_MBMS_M2AP_ID;
+    }
+  }
+  return INVALID_ENB_MBMS_M2AP_ID;
+}
+
+//------------------------------------------------------------------------------
+void m2ap_test_sent (const_bstring payload, const sctp_assoc_id_t sctp_assoc_id)
+{
+  M2AP_M2AP_PDU_t                      *pdu = NULL;
+  asn_dec_rval_t                        dec_ret;
+  enb_mbms_m2ap_id_t                    enb_mbms_m2ap_id = INVALID_ENB_MBMS_M2AP_ID;
+
+  if(!sctp_assoc_id || sctp_assoc_id > M2AP_SESSION_UPDATE_TEST_ENBS) {
+    fprintf(stderr, "M2AP message sent to unknown SCTP assoc id (%u)\n", sctp_assoc_id);
+    m2ap_test_errors++;
+    return;
+  }
+  dec_ret = aper_decode(NULL, &asn_DEF_M2AP_M2AP_PDU, (void **)&pdu, payload->data, blength(payload), 0, 0);
+  if(dec_ret.code != RC_OK || pdu->present != M2AP_M2AP_PDU_PR_initiatingMessage) {
+    fprintf(stderr, "Undecodable M2AP message sent to SCTP assoc id (%u)\n", sctp_assoc_id);
+    m2ap_test_errors++;
+    ASN_STRUCT_FREE(asn_DEF_M2AP_M2AP_PDU, pdu);
+    return;
+  }
+  switch(pdu->choice.initiatingMessage.procedureCode) {
+  case M2AP_ProcedureCode_id_sessionStart:
+    m2ap_test_counts[sctp_assoc_id][M2AP_TEST_SESSION_START]++;
+    break;
+  case M2AP_ProcedureCode_id_sessionStop:
+  case M2AP_ProcedureCode_id_sessionUpdate:
+    m2ap_test_counts[sctp_assoc_id][pdu->choice.initiatingMessage.procedureCode == M2AP_ProcedureCode_id_sessionStop ?
+        M2AP_TEST_SESSION_STOP : M2AP_TEST_SESSION_UPDATE]++;
+    /** The eNB MBMS M2AP ID must be the one of the receiving eNB, also if it is patched into a shared encoding. */
+    enb_mbms_m2ap_id = m2ap_test_decoded_enb_mbms_m2ap_id(pdu);
+    if(enb_mbms_m2ap_id != M2AP_SESSION_UPDATE_TEST_ENB_MBMS_ID + sctp_assoc_id) {
+      fprintf(stderr, "M2AP message with eNB MBMS M2AP ID (%u) sent to SCTP assoc id (%u)\n", enb_mbms_m2ap_id, sctp_assoc_id);
+      m2ap_test_errors++;
+    }
+    break;
+  default:
+    fprintf(stderr, "Unexpected M2AP procedure (%ld) sent to SCTP assoc id (%u)\n", pdu->choice.initiatingMessage.procedureCode, sctp_assoc_id);
+    m2ap_test_errors++;
+    break;
+  }
+  ASN_STRUCT_FREE(asn_DEF_M2AP_M2AP_PDU, pdu);
+}
+
+/****************************************************************************/
+/*******************************  T E S T S  ********************************/
+/****************************************************************************/
+
+//------------------------------------------------------------------------------
+static void m2ap_test_reset (void)
+{
+  memset(m2ap_test_counts, 0, sizeof(m2ap_test_counts));
+}
+
+//------------------------------------------------------------------------------
+static int m2ap_test_total (const m2ap_session_update_test_procedure_t procedure)
+{
+  int total = 0;
+  for(int i = 1; i <= M2AP_SESSION_UPDATE_TEST_ENBS; i++)
+    total += m2ap_test_counts[i][procedure];
+  return total;
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_expect (const char * const step, const int enb_from, const int enb_to,
+  const m2ap_session_update_test_procedure_t procedure, const int expected)
+{
+  for(int i = enb_from; i <= enb_to; i++) {
+    if(m2ap_test_counts[i][procedure] != expected) {
+      fprintf(stderr, "%s: eNB (%d) got (%d) %s, expected (%d)\n", step, i, m2ap_test_counts[i][procedure],
+          procedure == M2AP_TEST_SESSION_START ? "starts" : (procedure == M2AP_TEST_SESSION_STOP ? "stops" : "updates"), expected);
+      m2ap_test_errors++;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_print (const char * const step)
+{
+  printf("%-44s starts %2d  stops %2d  updates %2d  total %2d\n", step, m2ap_test_total(M2AP_TEST_SESSION_START),
+      m2ap_test_total(M2AP_TEST_SESSION_STOP), m2ap_test_total(M2AP_TEST_SESSION_UPDATE),
+      m2ap_test_total(M2AP_TEST_SESSION_START) + m2ap_test_total(M2AP_TEST_SESSION_STOP) + m2ap_test_total(M2AP_TEST_SESSION_UPDATE));
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_add_enb (const sctp_assoc_id_t sctp_assoc_id, const int num_sais, const mbms_service_area_id_t * const sais)
+{
+  m2ap_enb_description_t               *m2ap_enb_ref = m2ap_new_enb();
+
+  m2ap_enb_ref->sctp_assoc_id = sctp_assoc_id;
+  m2ap_enb_ref->m2ap_enb_id = sctp_assoc_id;
+  m2ap_enb_ref->m2_state = M2AP_READY;
+  m2ap_enb_ref->mbms_sa_list.num_service_area = num_sais;
+  for(int i = 0; i < num_sais; i++)
+    m2ap_enb_ref->mbms_sa_list.serviceArea[i] = sais[i];
+  DevAssert(hashtable_ts_insert(&g_m2ap_enb_coll, (const hash_key_t)sctp_assoc_id, (void *)m2ap_enb_ref) == HASH_TABLE_OK);
+  m2ap_enb_index_add(m2ap_enb_ref);
+  m2ap_test_enbs[sctp_assoc_id] = m2ap_enb_ref;
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_respond_session_starts (const tmgi_t * const tmgi, const mbms_service_area_id_t mbms_sai)
+{
+  mbms_description_t                   *mbms_ref = m2ap_is_mbms_tmgi_in_list(tmgi, mbms_sai);
+  if(!mbms_ref) {
+    fprintf(stderr, "No MBMS Service for TMGI " TMGI_FMT " in MBMS SA (%d)\n", TMGI_ARG(tmgi), mbms_sai);
+    m2ap_test_errors++;
+    return;
+  }
+  /** Successful MBMS Session Start Response of each eNB which received the request. */
+  for(int i = 1; i <= M2AP_SESSION_UPDATE_TEST_ENBS; i++) {
+    if(!m2ap_test_counts[i][M2AP_TEST_SESSION_START])
+      continue;
+    hashtable_uint64_ts_insert(&mbms_ref->g_m2ap_assoc_id2mce_enb_id_coll, (const hash_key_t)i, (uint64_t)(M2AP_SESSION_UPDATE_TEST_ENB_MBMS_ID + i));
+    m2ap_test_enbs[i]->nb_mbms_associated++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_session_start (const tmgi_t * const tmgi, const mbms_service_area_id_t mbms_sai, const teid_t cteid)
+{
+  itti_m3ap_mbms_session_start_req_t    req = {0};
+  req.tmgi = *tmgi;
+  req.mbms_service_area_id = mbms_sai;
+  req.mbms_bearer_tbc.bc_tbc.bearer_level_qos.qci = 1;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.cteid = cteid;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.distribution_address.pdn_type = IPv4;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.distribution_address.address.ipv4_address.s_addr = htonl(0xE8000001);
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.source_address.pdn_type = IPv4;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.source_address.address.ipv4_address.s_addr = htonl(0x0A000001);
+  m2ap_handle_mbms_session_start_request(&req);
+}
+
+//------------------------------------------------------------------------------
+static void m2ap_test_session_update (const tmgi_t * const tmgi, const mbms_service_area_id_t old_mbms_sai,
+  const mbms_service_area_id_t new_mbms_sai, const teid_t cteid, const bitrate_t mbr)
+{
+  itti_m3ap_mbms_session_update_req_t   req = {0};
+  req.tmgi = *tmgi;
+  req.old_mbms_service_area_id = old_mbms_sai;
+  req.new_mbms_service_area_id = new_mbms_sai;
+  req.mbms_bearer_tbc.bc_tbc.bearer_level_qos.qci = 1;
+  req.mbms_bearer_tbc.bc_tbc.bearer_level_qos.mbr.br_dl = mbr;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.cteid = cteid;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.distribution_address.pdn_type = IPv4;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.distribution_address.address.ipv4_address.s_addr = htonl(0xE8000001);
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.source_address.pdn_type = IPv4;
+  req.mbms_bearer_tbc.mbms_ip_mc_dist.source_address.address.ipv4_address.s_addr = htonl(0x0A000001);
+  m2ap_handle_mbms_session_update_request(&req);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  /**
+   * eNBs 1-4 serve both MBMS Service Areas, eNBs 5-6 only the first one and eNBs 7-8 only the second one.
+   * Moving an MBMS Service from the first to the second MBMS Service Area keeps eNBs 1-4, eNBs 5-6 leave and eNBs 7-8 join.
+   */
+  const mbms_service_area_id_t          sais_both[2] = {M2AP_SESSION_UPDATE_TEST_SAI_1, M2AP_SESSION_UPDATE_TEST_SAI_2};
+  const mbms_service_area_id_t          sais_1[1] = {M2AP_SESSION_UPDATE_TEST_SAI_1};
+  const mbms_service_area_id_t          sais_2[1] = {M2AP_SESSION_UPDATE_TEST_SAI_2};
+  tmgi_t                                tmgi_update = {.mbms_service_id = 0x000001,
+      .plmn = {.mcc_digit1 = 0, .mcc_digit2 = 0, .mcc_digit3 = 1, .mnc_digit1 = 0, .mnc_digit2 = 1, .mnc_digit3 = 0xF}};
+  tmgi_t                                tmgi_restart = tmgi_update;
+  m2ap_mbms_session_update_stats_t      stats_before, stats_after;
+  int                                   update_total = 0;
+  int                                   restart_total = 0;
+
+  tmgi_restart.mbms_service_id = 0x000002;
+  mce_config.mbms.max_m2_enbs = M2AP_SESSION_UPDATE_TEST_ENBS;
+  mce_config.mbms.max_mbms_services = 16;
+  mce_config.mbms.m2ap_encoder_threads = 0;
+  if(m2ap_mce_init() != RETURNok) {
+    fprintf(stderr, "Error initializing the M2AP MCE layer\n");
+    return 1;
+  }
+  for(int i = 1; i <= 4; i++)
+    m2ap_test_add_enb(i, 2, sais_both);
+  m2ap_test_add_enb(5, 1, sais_1);
+  m2ap_test_add_enb(6, 1, sais_1);
+  m2ap_test_add_enb(7, 1, sais_2);
+  m2ap_test_add_enb(8, 1, sais_2);
+
+  /** MBMS Service in the first MBMS Service Area, started on eNBs 1-6. */
+  m2ap_test_reset();
+  m2ap_test_session_start(&tmgi_update, M2AP_SESSION_UPDATE_TEST_SAI_1, 0x1000);
+  m2ap_test_print("Session Start (SAI 1)");
+  m2ap_test_expect("Session Start (SAI 1)", 1, 6, M2AP_TEST_SESSION_START, 1);
+  m2ap_test_expect("Session Start (SAI 1)", 7, 8, M2AP_TEST_SESSION_START, 0);
+  m2ap_test_respond_session_starts(&tmgi_update, M2AP_SESSION_UPDATE_TEST_SAI_1);
+
+  /** Only the QoS changes, which the M2AP MBMS Session Update does not carry. */
+  m2ap_test_reset();
+  m2ap_mbms_session_update_get_stats(&stats_before);
+  m2ap_test_session_update(&tmgi_update, M2AP_SESSION_UPDATE_TEST_SAI_1, M2AP_SESSION_UPDATE_TEST_SAI_1, 0x1000, 2000000);
+  m2ap_mbms_session_update_get_stats(&stats_after);
+  m2ap_test_print("Session Update (QoS only)");
+  m2ap_test_expect("Session Update (QoS only)", 1, 8, M2AP_TEST_SESSION_START, 0);
+  m2ap_test_expect("Session Update (QoS only)", 1, 8, M2AP_TEST_SESSION_STOP, 0);
+  m2ap_test_expect("Session Update (QoS only)", 1, 8, M2AP_TEST_SESSION_UPDATE, 0);
+  if(stats_after.num_enbs_unchanged - stats_before.num_enbs_unchanged != 6) {
+    fprintf(stderr, "Session Update (QoS only): (%lu) unchanged eNBs, expected (6)\n", stats_after.num_enbs_unchanged - stats_before.num_enbs_unchanged);
+    m2ap_test_errors++;
+  }
+
+  /** New TNL information, all eNBs stay. */
+  m2ap_test_reset();
+  m2ap_test_session_update(&tmgi_update, M2AP_SESSION_UPDATE_TEST_SAI_1, M2AP_SESSION_UPDATE_TEST_SAI_1, 0x2000, 2000000);
+  m2ap_test_print("Session Update (TNL, SAI 1)");
+  m2ap_test_expect("Session Update (TNL, SAI 1)", 1, 6, M2AP_TEST_SESSION_UPDATE, 1);
+  m2ap_test_expect("Session Update (TNL, SAI 1)", 7, 8, M2AP_TEST_SESSION_UPDATE, 0);
+  m2ap_test_expect("Session Update (TNL, SAI 1)", 1, 8, M2AP_TEST_SESSION_START, 0);
+  m2ap_test_expect("Session Update (TNL, SAI 1)", 1, 8, M2AP_TEST_SESSION_STOP, 0);
+
+  /** Move the MBMS Service into the second MBMS Service Area. */
+  m2ap_test_reset();
+  m2ap_mbms_session_update_get_stats(&stats_before);
+  m2ap_test_session_update(&tmgi_update, M2AP_SESSION_UPDATE_TEST_SAI_1, M2AP_SESSION_UPDATE_TEST_SAI_2, 0x2000, 2000000);
+  m2ap_mbms_session_update_get_stats(&stats_after);
+  m2ap_test_print("Session Update (SAI 1 -> SAI 2)");
+  m2ap_test_expect("Session Update (SAI 1 -> SAI 2)", 1, 4, M2AP_TEST_SESSION_UPDATE, 1);
+  m2ap_test_expect("Session Update (SAI 1 -> SAI 2)", 1, 4, M2AP_TEST_SESSION_STOP, 0);
+  m2ap_test_expect("Session Update (SAI 1 -> SAI 2)", 1, 4, M2AP_TEST_SESSION_START, 0);
+  m2ap_test_expect("Session Update (SAI 1 -> SAI 2)", 5, 6, M2AP_TEST_SESSION_STOP, 1);
+  m2ap_test_expect("Session Update (SAI 1 -> SAI 2)", 5, 8, M2AP_TEST_SESSION_UPDATE, 0);
+  m2ap_test_expect("Session Update (SAI 1 -> SAI 2)", 7, 8, M2AP_TEST_SESSION_START, 1);
+  update_total = m2ap_test_total(M2AP_TEST_SESSION_START) + m2ap_test_total(M2AP_TEST_SESSION_STOP) + m2ap_test_total(M2AP_TEST_SESSION_UPDATE);
+  if(stats_after.num_messages_saved - stats_before.num_messages_saved != 4) {
+    fprintf(stderr, "Session Update (SAI 1 -> SAI 2): (%lu) messages saved, expected (4)\n", stats_after.num_messages_saved - stats_before.num_messages_saved);
+    m2ap_test_errors++;
+  }
+  m2ap_test_respond_session_starts(&tmgi_update, M2AP_SESSION_UPDATE_TEST_SAI_2);
+
+  /** The same move of a second MBMS Service with a stop/start cycle. */
+  m2ap_test_reset();
+  m2ap_test_session_start(&tmgi_restart, M2AP_SESSION_UPDATE_TEST_SAI_1, 0x3000);
+  m2ap_test_respond_session_starts(&tmgi_restart, M2AP_SESSION_UPDATE_TEST_SAI_1);
+  m2ap_test_reset();
+  m2ap_handle_mbms_session_stop_request(&tmgi_restart, M2AP_SESSION_UPDATE_TEST_SAI_1, true);
+  m2ap_test_session_start(&tmgi_restart, M2AP_SESSION_UPDATE_TEST_SAI_2, 0x3000);
+  m2ap_test_print("Session Stop (SAI 1) + Session Start (SAI 2)");
+  m2ap_test_expect("Session Stop (SAI 1) + Session Start (SAI 2)", 1, 6, M2AP_TEST_SESSION_STOP, 1);
+  m2ap_test_expect("Session Stop (SAI 1) + Session Start (SAI 2)", 1, 4, M2AP_TEST_SESSION_START, 1);
+  m2ap_test_expect("Session Stop (SAI 1) + Session Start (SAI 2)", 5, 6, M2AP_TEST_SESSION_START, 0);
+  m2ap_test_expect("Session Stop (SAI 1) + Session Start (SAI 2)", 7, 8, M2AP_TEST_SESSION_START, 1);
+  restart_total = m2ap_test_total(M2AP_TEST_SESSION_START) + m2ap_test_total(M2AP_TEST_SESSION_STOP) + m2ap_test_total(M2AP_TEST_SESSION_UPDATE);
+  if(update_total != 8 || restart_total != 12) {
+    fprintf(stderr, "Moving the MBMS Service took (%d) M2AP messages with an update and (%d) with a stop/start cycle, expected (8) and (12)\n",
+        update_total, restart_total);
+    m2ap_test_errors++;
+  }
+
+  /** The eNBs only count the MBMS Services they run. */
+  for(int i = 1; i <= M2AP_SESSION_UPDATE_TEST_ENBS; i++) {
+    const int expected = (i <= 4 || i >= 7) ? 1 : 0;
+    if(m2ap_test_enbs[i]->nb_mbms_associated != expected) {
+      fprintf(stderr, "eNB (%d) runs (%d) MBMS Services, expected (%d)\n", i, m2ap_test_enbs[i]->nb_mbms_associated, expected);
+      m2ap_test_errors++;
+    }
+  }
+
+  printf("MBMS Service moved with (%d) M2AP messages against (%d) with a stop/start cycle, (%d) errors\n",
+      update_total, restart_total, m2ap_test_errors);
+  m2ap_mce_exit();
+  return m2ap_test_errors ? 1 : 0;
+}
@@ -93,6 +93,7 @@ bool mce_app_dump_mbms_service(const hash_key_t keyP, void *const mbms_service,
 void mce_app_handle_mbms_session_start_request( itti_sm_mbms_session_start_request_t * const mbms_session_start_pP );
 void mce_app_handle_mbms_session_update_request( itti_sm_mbms_session_update_request_t * const mbms_session_update_pP );
 void mce_app_handle_mbms_session_stop_request( itti_sm_mbms_session_stop_request_t * const mbms_session_stop_pP );
+void mce_app_handle_mbms_gw_restart_ind( const itti_sm_mbms_gw_restart_ind_t * const mbms_gw_restart_ind_pP );
 void mce_app_handle_m3ap_enb_setup_request(itti_m3ap_enb_setup_req_t * const m3ap_enb_setup_req_p);
 
 //------------------------------------------------------------------------------
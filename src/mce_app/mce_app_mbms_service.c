@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <time.h>
+#include <arpa/inet.h>
 
 #include "3gpp_requirements_23.246.h"
 #include "3gpp_requirements_29.468.h"
@@ -601,6 +602,45 @@ mce_app_handle_mbms_session_stop_request(
   OAILOG_FUNC_OUT (LOG_MCE_APP);
 }
 
+//------------------------------------------------------------------------------
+void
+mce_app_handle_mbms_gw_restart_ind(
+     const itti_sm_mbms_gw_restart_ind_t * const mbms_gw_restart_ind_pP
+    )
+{
+  OAILOG_FUNC_IN (LOG_MCE_APP);
+
+  mbms_service_t                        **mbms_services     = NULL;
+  int                                     num_mbms_services = 0;
+  char                                    ip[INET6_ADDRSTRLEN];
+  const struct sockaddr                  *mbms_peer_ip      = (const struct sockaddr*)&mbms_gw_restart_ind_pP->mbms_peer_ip;
+
+  inet_ntop(mbms_peer_ip->sa_family, mbms_peer_ip->sa_family == AF_INET6 ? (void*)&mbms_gw_restart_ind_pP->mbms_peer_ip.peer_ipv6.sin6_addr
+      : (void*)&mbms_gw_restart_ind_pP->mbms_peer_ip.peer_ipv4.sin_addr, ip, sizeof(ip));
+  /**
+   * The MBMS-GW lost its MBMS bearer contexts (3GPP TS 23.007). Release all its MBMS Services at once, collected in a single pass.
+   * Sm already removed their tunnels, so no SM_REMOVE_TUNNEL is sent.
+   */
+  num_mbms_services = mce_mbms_services_of_mbms_gw(&mce_app_desc.mce_mbms_service_contexts, mbms_peer_ip, &mbms_services);
+  OAILOG_WARNING(LOG_MCE_APP, "MBMS-GW %s restarted (restart counter %u). Releasing its %d MBMS Services (%u Sm tunnels released). \n",
+      ip, mbms_gw_restart_ind_pP->restart_counter, num_mbms_services, mbms_gw_restart_ind_pP->nb_tunnels);
+  for (int i = 0; i < num_mbms_services; i++) {
+    mbms_service_t                       *mbms_service = mbms_services[i];
+    tmgi_t                                tmgi         = mbms_service->privates.fields.tmgi;
+    const mbms_service_area_id_t          mbms_sa_id   = mbms_service->privates.fields.mbms_service_area_id;
+    const teid_t                          mme_teid_sm  = mbms_service->privates.fields.mme_teid_sm;
+
+    if(mbms_service->mbms_procedure){
+      mce_app_delete_mbms_procedure(mbms_service);
+    }
+    /** M3AP Session Stop Request --> No Response is expected. */
+    mce_app_itti_m3ap_mbms_session_stop_request(&tmgi, mbms_sa_id, true);
+    mce_app_stop_mbms_service(&tmgi, mbms_sa_id, mme_teid_sm, NULL);
+  }
+  free_wrapper((void**)&mbms_services);
+  OAILOG_FUNC_OUT (LOG_MCE_APP);
+}
+
 //------------------------------------------------------------------------------
 void
  mce_app_handle_m3ap_enb_setup_request(
@@ -385,6 +385,47 @@ mbms_cteid_in_list (const mce_mbms_services_t * const mce_mbms_services_p,
   return mbms_service_ref;
 }
 
+//------------------------------------------------------------------------------
+static bool mce_mbms_service_compare_by_mbms_peer_ip (__attribute__((unused)) const hash_key_t keyP,
+                                    void * const elementP,
+                                    void * parameterP, void **resultP)
+{
+  const struct sockaddr           * const mbms_peer_ip = (const struct sockaddr*const)parameterP;
+  mbms_service_t                  * mbms_service_ref  = (mbms_service_t*)elementP;
+  const struct sockaddr           * service_peer_ip = (const struct sockaddr*)&mbms_service_ref->privates.fields.mbms_peer_ip;
+
+  if (service_peer_ip->sa_family != mbms_peer_ip->sa_family)
+    return false;
+  if (mbms_peer_ip->sa_family == AF_INET6)
+    return !memcmp(&((const struct sockaddr_in6*)service_peer_ip)->sin6_addr, &((const struct sockaddr_in6*)mbms_peer_ip)->sin6_addr, sizeof(struct in6_addr));
+  return ((const struct sockaddr_in*)service_peer_ip)->sin_addr.s_addr == ((const struct sockaddr_in*)mbms_peer_ip)->sin_addr.s_addr;
+}
+
+//------------------------------------------------------------------------------
+int
+mce_mbms_services_of_mbms_gw (const mce_mbms_services_t * const mce_mbms_services_p,
+  const struct sockaddr * const mbms_peer_ip, mbms_service_t *** mbms_services)
+{
+  hashtable_element_array_t              ea;
+
+  *mbms_services = NULL;
+  memset(&ea, 0, sizeof(hashtable_element_array_t));
+  if (!mce_mbms_services_p->mbms_service_index_mbms_service_htbl->num_elements)
+    return 0;
+  /** Room for all MBMS Services, such that the collection is done in a single pass. */
+  ea.elements = calloc(mce_mbms_services_p->mbms_service_index_mbms_service_htbl->num_elements, sizeof(void*));
+  if (!ea.elements)
+    return 0;
+  hashtable_ts_apply_list_callback_on_elements(mce_mbms_services_p->mbms_service_index_mbms_service_htbl, mce_mbms_service_compare_by_mbms_peer_ip,
+      (void *)mbms_peer_ip, &ea);
+  if (!ea.num_elements) {
+    free_wrapper((void**)&ea.elements);
+    return 0;
+  }
+  *mbms_services = (mbms_service_t **)ea.elements;
+  return ea.num_elements;
+}
+
 ////------------------------------------------------------------------------------
 //void mce_app_handle_m2ap_enb_deregistered_ind (const itti_m2ap_eNB_deregistered_ind_t * const enb_dereg_ind)
 //{
@@ -251,6 +251,14 @@ mbms_service_t                      *
 mbms_cteid_in_list (const mce_mbms_services_t * const mce_mbms_services_p,
   const teid_t cteid);
 
+/** \brief Collect the MBMS Services whose Sm tunnel is towards the given MBMS-GW, in one pass over the MBMS Services.
+ * \param mbms_services Allocated array of the MBMS Services, to be freed by the caller (NULL if none)
+ * @returns the number of MBMS Services
+ */
+int
+mce_mbms_services_of_mbms_gw (const mce_mbms_services_t * const mce_mbms_services_p,
+  const struct sockaddr * const mbms_peer_ip, mbms_service_t *** mbms_services);
+
 /**
  * Get the MCE APP internal identifier for the MBMS Service context, uniquely based on the TMGI and per MBMS Service Area Id.
  */
@@ -240,6 +240,16 @@ static void mce_config_init (mce_config_t * config_pP)
   config_pP->itti_config.log_file = NULL;
   config_pP->sctp_config.in_streams = SCTP_IN_STREAMS;
   config_pP->sctp_config.out_streams = SCTP_OUT_STREAMS;
+  config_pP->sctp_config.epoll_max_events = SCTP_EPOLL_MAX_EVENTS;
+  config_pP->sctp_config.receiver_threads = SCTP_RECEIVER_THREADS;
+  config_pP->udp_config.recv_batch = UDP_RECV_BATCH;
+  config_pP->udp_config.send_batch = UDP_SEND_BATCH;
+  config_pP->udp_config.listener_sockets = UDP_LISTENER_SOCKETS;
+  config_pP->udp_config.sm_record_file = NULL;
+  config_pP->udp_config.sm_stack_shards = SM_STACK_SHARDS;
+  config_pP->udp_config.sm_echo_interval_sec = SM_ECHO_INTERVAL_SEC;
+  config_pP->udp_config.sm_echo_t3_sec = SM_ECHO_T3_SEC;
+  config_pP->udp_config.sm_echo_n3 = SM_ECHO_N3;
   config_pP->relative_capacity = RELATIVE_CAPACITY;
   config_pP->mme_statistic_timer = MME_STATISTIC_TIMER_S;
 
@@ -308,6 +318,7 @@ void mce_config_exit (void)
   bdestroy_wrapper(&mce_config.s6a_config.conf_file);
   bdestroy_wrapper(&mce_config.s6a_config.hss_host_name);
   bdestroy_wrapper(&mce_config.itti_config.log_file);
+  bdestroy_wrapper(&mce_config.udp_config.sm_record_file);
 
   free_wrapper((void**)&mce_config.served_tai.plmn_mcc);
   free_wrapper((void**)&mce_config.served_tai.plmn_mnc);
@@ -628,6 +639,43 @@ static int mce_config_parse_file (mce_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_OUTSTREAMS, &aint))) {
         config_pP->sctp_config.out_streams = (uint16_t) aint;
       }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_EPOLL_MAX_EVENTS, &aint)) && aint > 0) {
+        config_pP->sctp_config.epoll_max_events = (uint16_t) aint;
+      }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_RECEIVER_THREADS, &aint)) && aint > 0) {
+        config_pP->sctp_config.receiver_threads = (uint16_t) aint;
+      }
+    }
+    // UDP SETTING
+    setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_UDP_CONFIG);
+
+    if (setting != NULL) {
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_RECV_BATCH, &aint)) && aint > 0) {
+        config_pP->udp_config.recv_batch = (uint16_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_SEND_BATCH, &aint)) && aint > 0) {
+        config_pP->udp_config.send_batch = (uint16_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_LISTENER_SOCKETS, &aint)) && aint > 0) {
+        config_pP->udp_config.listener_sockets = (uint16_t) aint;
+      }
+      if ((config_setting_lookup_string (setting, MME_CONFIG_STRING_UDP_SM_RECORD_FILE, (const char **)&astring)) && astring && astring[0]) {
+        config_pP->udp_config.sm_record_file = bfromcstr (astring);
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_SM_STACK_SHARDS, &aint)) && aint > 0) {
+        config_pP->udp_config.sm_stack_shards = (uint16_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_SM_ECHO_INTERVAL, &aint)) && aint >= 0) {
+        config_pP->udp_config.sm_echo_interval_sec = (uint16_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_SM_ECHO_T3, &aint)) && aint > 0) {
+        config_pP->udp_config.sm_echo_t3_sec = (uint16_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_UDP_SM_ECHO_N3, &aint)) && aint >= 0) {
+        config_pP->udp_config.sm_echo_n3 = (uint16_t) aint;
+      }
     }
     // S1AP SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_S1AP_CONFIG);
@@ -999,6 +1047,32 @@ static int mce_config_parse_file (mce_config_t * config_pP)
       config_pP->mbms.max_m2_enbs = (uint32_t) aint;
     }
 
+    if ((config_setting_lookup_int (setting_mce, MME_CONFIG_STRING_M2AP_ENCODER_THREADS, &aint))) {
+      config_pP->mbms.m2ap_encoder_threads = (uint8_t) aint;
+    }
+
+    /** Admission of M2 Setup Requests. */
+    if ((config_setting_lookup_int (setting_mce, MME_CONFIG_STRING_M2_SETUP_RATE, &aint))) {
+      config_pP->mbms.m2_setup_rate = (uint32_t) aint;
+    }
+
+    if ((config_setting_lookup_int (setting_mce, MME_CONFIG_STRING_M2_SETUP_BURST, &aint))) {
+      config_pP->mbms.m2_setup_burst = (uint32_t) aint;
+    }
+
+    if ((config_setting_lookup_int (setting_mce, MME_CONFIG_STRING_M2_SETUP_MAX_PENDING, &aint))) {
+      config_pP->mbms.m2_setup_max_pending = (uint32_t) aint;
+    }
+
+    /** Response timers of the M2AP procedures. */
+    if ((config_setting_lookup_int (setting_mce, MME_CONFIG_STRING_M2AP_RESPONSE_TIMER, &aint))) {
+      config_pP->mbms.m2ap_response_timer_ms = (uint32_t) aint;
+    }
+
+    if ((config_setting_lookup_int (setting_mce, MME_CONFIG_STRING_M2AP_RESPONSE_RETRANSMISSIONS, &aint))) {
+      config_pP->mbms.m2ap_response_retransmissions = (uint8_t) aint;
+    }
+
     if ((config_setting_lookup_int (setting_mce, MME_CONFIG_MBMS_M2_ENB_BAND, &aint))) {
       config_pP->mbms.mbms_m2_enb_band = (enb_band_e) aint;
     }
@@ -1101,6 +1175,10 @@ static void mce_config_display (mce_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- Realm ................................: %s\n", bdata(config_pP->realm));
   OAILOG_INFO (LOG_CONFIG, "- Run mode .............................: %s\n", (RUN_MODE_BASIC == config_pP->run_mode) ? "BASIC":(RUN_MODE_SCENARIO_PLAYER == config_pP->run_mode) ? "SCENARIO_PLAYER":"UNKNOWN");
   OAILOG_INFO (LOG_CONFIG, "- Max M2 eNBs ..........................: %u\n", config_pP->mbms.max_m2_enbs);
+  OAILOG_INFO (LOG_CONFIG, "- M2AP encoder threads .................: %u\n", config_pP->mbms.m2ap_encoder_threads);
+  OAILOG_INFO (LOG_CONFIG, "- M2 Setup rate (burst) ................: %u/s (%u)\n", config_pP->mbms.m2_setup_rate, config_pP->mbms.m2_setup_burst);
+  OAILOG_INFO (LOG_CONFIG, "- M2 Setup max pending .................: %u\n", config_pP->mbms.m2_setup_max_pending);
+  OAILOG_INFO (LOG_CONFIG, "- M2AP response timer (retransmissions) : %u ms (%u)\n", config_pP->mbms.m2ap_response_timer_ms, config_pP->mbms.m2ap_response_retransmissions);
   OAILOG_INFO (LOG_CONFIG, "- Max MBMS-Services ....................: %u\n", config_pP->mbms.max_mbms_services);
   OAILOG_INFO (LOG_CONFIG, "- Max MBMS-Global-Areas.................: %u\n", config_pP->mbms.mbms_global_service_area_types);
   OAILOG_INFO (LOG_CONFIG, "- Max MBMS-Local-Areas..................: %u\n", config_pP->mbms.mbms_local_service_areas);
@@ -1122,6 +1200,16 @@ static void mce_config_display (mce_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- SCTP:\n");
   OAILOG_INFO (LOG_CONFIG, "    in streams .......: %u\n", config_pP->sctp_config.in_streams);
   OAILOG_INFO (LOG_CONFIG, "    out streams ......: %u\n", config_pP->sctp_config.out_streams);
+  OAILOG_INFO (LOG_CONFIG, "    epoll events .....: %u\n", config_pP->sctp_config.epoll_max_events);
+  OAILOG_INFO (LOG_CONFIG, "    receiver threads .: %u\n", config_pP->sctp_config.receiver_threads);
+  OAILOG_INFO (LOG_CONFIG, "- UDP:\n");
+  OAILOG_INFO (LOG_CONFIG, "    receive batch ....: %u\n", config_pP->udp_config.recv_batch);
+  OAILOG_INFO (LOG_CONFIG, "    send batch .......: %u\n", config_pP->udp_config.send_batch);
+  OAILOG_INFO (LOG_CONFIG, "    listener sockets .: %u\n", config_pP->udp_config.listener_sockets);
+  OAILOG_INFO (LOG_CONFIG, "    Sm record file ...: %s\n", config_pP->udp_config.sm_record_file ? bdata(config_pP->udp_config.sm_record_file) : "none");
+  OAILOG_INFO (LOG_CONFIG, "    Sm stack shards ..: %u\n", config_pP->udp_config.sm_stack_shards);
+  OAILOG_INFO (LOG_CONFIG, "    Sm echo ..........: every %u s, T3 %u s, N3 %u\n", config_pP->udp_config.sm_echo_interval_sec,
+      config_pP->udp_config.sm_echo_t3_sec, config_pP->udp_config.sm_echo_n3);
   OAILOG_INFO (LOG_CONFIG, "- GUMMEIs (PLMN|MMEGI|MMEC):\n");
   for (j = 0; j < config_pP->gummei.nb; j++) {
     OAILOG_INFO (LOG_CONFIG, "            " PLMN_FMT "|%u|%u \n",
@@ -78,6 +78,18 @@
 #define MME_CONFIG_STRING_SCTP_CONFIG                    "SCTP"
 #define MME_CONFIG_STRING_SCTP_INSTREAMS                 "SCTP_INSTREAMS"
 #define MME_CONFIG_STRING_SCTP_OUTSTREAMS                "SCTP_OUTSTREAMS"
+#define MME_CONFIG_STRING_SCTP_EPOLL_MAX_EVENTS          "SCTP_EPOLL_MAX_EVENTS"
+#define MME_CONFIG_STRING_SCTP_RECEIVER_THREADS          "SCTP_RECEIVER_THREADS"
+
+#define MME_CONFIG_STRING_UDP_CONFIG                     "UDP"
+#define MME_CONFIG_STRING_UDP_RECV_BATCH                 "UDP_RECV_BATCH"
+#define MME_CONFIG_STRING_UDP_SEND_BATCH                 "UDP_SEND_BATCH"
+#define MME_CONFIG_STRING_UDP_LISTENER_SOCKETS           "UDP_LISTENER_SOCKETS"
+#define MME_CONFIG_STRING_UDP_SM_RECORD_FILE             "UDP_SM_RECORD_FILE"
+#define MME_CONFIG_STRING_UDP_SM_STACK_SHARDS            "UDP_SM_STACK_SHARDS"
+#define MME_CONFIG_STRING_UDP_SM_ECHO_INTERVAL           "UDP_SM_ECHO_INTERVAL"
+#define MME_CONFIG_STRING_UDP_SM_ECHO_T3                 "UDP_SM_ECHO_T3"
+#define MME_CONFIG_STRING_UDP_SM_ECHO_N3                 "UDP_SM_ECHO_N3"
 
 
 #define MME_CONFIG_STRING_S1AP_CONFIG                    "S1AP"
@@ -115,6 +127,12 @@
 #define MME_CONFIG_MBMS_M2_ENB_BAND						 									"MBMS_M2_ENB_BAND"
 #define MME_CONFIG_MBMS_M2_ENB_BW																"MBMS_M2_ENB_BW"
 #define MME_CONFIG_MBMS_M2_ENB_TDD_UL_DL_SF_CONF 								"MBMS_M2_ENB_TDD_UL_DL_SF_CONF"
+#define MME_CONFIG_STRING_M2AP_ENCODER_THREADS									"M2AP_ENCODER_THREADS"
+#define MME_CONFIG_STRING_M2_SETUP_RATE											"M2_SETUP_RATE"
+#define MME_CONFIG_STRING_M2_SETUP_BURST										"M2_SETUP_BURST"
+#define MME_CONFIG_STRING_M2_SETUP_MAX_PENDING									"M2_SETUP_MAX_PENDING"
+#define MME_CONFIG_STRING_M2AP_RESPONSE_TIMER									"M2AP_RESPONSE_TIMER"
+#define MME_CONFIG_STRING_M2AP_RESPONSE_RETRANSMISSIONS					"M2AP_RESPONSE_RETRANSMISSIONS"
 
 #define MME_CONFIG_MBMS_ENB_SCPTM						 							"MBMS_ENB_SCPTM"
 #define MME_CONFIG_MBMS_RESOURCE_ALLOCATION_FULL		 			"MBMS_RESOURCE_ALLOCATION_FULL"
@@ -244,6 +262,12 @@ typedef struct mce_config_s {
 		enb_band_e  mbms_m2_enb_band;
 		enb_bw_e	  mbms_m2_enb_bw;
 		uint8_t  		mbms_m2_enb_tdd_ul_dl_sf_conf;
+		uint8_t  		m2ap_encoder_threads;		/**< Threads encoding the M2AP messages of different eNBs in parallel, 0 encodes in the M2AP task. */
+		uint32_t 		m2_setup_rate;					/**< M2 Setup Requests admitted per second, 0 admits all. */
+		uint32_t 		m2_setup_burst;					/**< M2 Setup Requests admitted at once after an idle period, 0 uses the rate. */
+		uint32_t 		m2_setup_max_pending;		/**< M2 Setups waiting for MCE_APP at the same time, 0 for no limit. */
+		uint32_t 		m2ap_response_timer_ms;	/**< Initial response timeout of the MCE initiated M2AP procedures, 0 for none. */
+		uint8_t  		m2ap_response_retransmissions;	/**< Retransmissions with doubled timeout before the procedure times out. */
 		/** Flags. */
 		uint8_t  	mbms_enb_scptm:1;
 		uint8_t  	mbms_resource_allocation_full:1;
@@ -277,8 +301,21 @@ typedef struct mce_config_s {
   struct {
     uint16_t in_streams;
     uint16_t out_streams;
+    uint16_t epoll_max_events;
+    uint16_t receiver_threads;
   } sctp_config;
 
+  struct {
+    uint16_t recv_batch;
+    uint16_t send_batch;
+    uint16_t listener_sockets;
+    bstring  sm_record_file;          ///< Sm datagrams recorded for sm_replay, if set
+    uint16_t sm_stack_shards;         ///< GTPv2-C stack instances of Sm, the MBMS-GWs are sharded among them by address
+    uint16_t sm_echo_interval_sec;    ///< Echo Request period towards each MBMS-GW, 0 for no path supervision
+    uint16_t sm_echo_t3_sec;          ///< Echo Response timeout
+    uint16_t sm_echo_n3;              ///< Echo Request retransmissions before the path is down
+  } udp_config;
+
   struct {
     uint16_t port_number;
     uint8_t  outcome_drop_timer_sec;
@@ -153,7 +153,7 @@ main (
           NULL));
   MSC_INIT (MSC_MME, THREAD_MAX + TASK_MAX);
   CHECK_INIT_RETURN (sctp_init (&mce_config));
-  CHECK_INIT_RETURN (udp_init ());
+  CHECK_INIT_RETURN (udp_init (&mce_config));
   OAILOG_DEBUG(LOG_MME_APP, "MME app initialization of mandatory interfaces complete.\n");
 
   CHECK_INIT_RETURN (m2ap_mce_init ());
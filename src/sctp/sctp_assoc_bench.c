@@ -0,0 +1,184 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file sctp_assoc_bench.c
+ *  \brief Measure the per message cost of the SCTP send path against the number of associations.
+ *  Each send copies the association out under the read lock and duplicates its socket, as sctp_send_msg does, writes the
+ *  payload on a local datagram socket after releasing the lock (SCTP is not needed) and counts it under the lock again.
+ *  The lookup alone and the former linked list walk are measured for comparison.
+ *  \author Dincer BEKEN
+ *  \company Blackned GmbH
+ *  \email: dbeken@blackned.de
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "sctp_assoc_table.h"
+
+#define SCTP_ASSOC_BENCH_DEFAULT_ASSOCS       "1,10,100,1000"
+#define SCTP_ASSOC_BENCH_DEFAULT_MESSAGES     200000
+#define SCTP_ASSOC_BENCH_PAYLOAD_SIZE         128
+/** Associations ids are not contiguous in practice. */
+#define SCTP_ASSOC_BENCH_ASSOC_ID(i)          (1000 + (i) * 7)
+
+/** The former association list, for comparison. */
+typedef struct sctp_assoc_bench_list_s {
+  struct sctp_assoc_bench_list_s *next;
+  sctp_assoc_id_t                 assoc_id;
+} sctp_assoc_bench_list_t;
+
+//------------------------------------------------------------------------------
+static uint64_t bench_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int run_bench (const int num_assocs, const int num_messages, const int sv[2])
+{
+  uint8_t                    payload[SCTP_ASSOC_BENCH_PAYLOAD_SIZE] = {0};
+  uint8_t                    drain[SCTP_ASSOC_BENCH_PAYLOAD_SIZE];
+  sctp_assoc_bench_list_t   *list = calloc(num_assocs, sizeof(sctp_assoc_bench_list_t));
+  uint64_t                   t0 = 0, list_ns = 0, lookup_ns = 0, send_ns = 0;
+  uint32_t                   state = 12345;
+  volatile uint64_t          sink = 0;
+  int                        num_failed = 0;
+
+  if (!list || sctp_assoc_table_init(num_assocs)) {
+    free(list);
+    return -1;
+  }
+  sctp_assoc_table_wrlock();
+  for (int i = 0; i < num_assocs; i++) {
+    /** Distinct descriptor keys for the fd index, all sends go to the local socket. */
+    sctp_association_t *association = sctp_assoc_table_add(SCTP_ASSOC_BENCH_ASSOC_ID(i), sv[0] + 1 + i);
+    if (!association) {
+      sctp_assoc_table_unlock();
+      sctp_assoc_table_exit(NULL);
+      free(list);
+      return -1;
+    }
+    association->ppid = 43;
+    list[i].assoc_id = SCTP_ASSOC_BENCH_ASSOC_ID(i);
+    list[i].next = (i + 1 < num_assocs) ? &list[i + 1] : NULL;
+  }
+  sctp_assoc_table_unlock();
+
+  /** Former list walk. */
+  t0 = bench_now_ns();
+  for (int m = 0; m < num_messages; m++) {
+    state = state * 1103515245 + 12345;
+    const sctp_assoc_id_t assoc_id = SCTP_ASSOC_BENCH_ASSOC_ID((state >> 8) % num_assocs);
+    sctp_assoc_bench_list_t *l = list;
+    while (l && l->assoc_id != assoc_id)
+      l = l->next;
+    sink += (uintptr_t)l;
+  }
+  list_ns = bench_now_ns() - t0;
+
+  /** Lookup only. */
+  t0 = bench_now_ns();
+  for (int m = 0; m < num_messages; m++) {
+    state = state * 1103515245 + 12345;
+    sctp_assoc_table_rdlock();
+    sink += (uintptr_t)sctp_assoc_table_get(SCTP_ASSOC_BENCH_ASSOC_ID((state >> 8) % num_assocs));
+    sctp_assoc_table_unlock();
+  }
+  lookup_ns = bench_now_ns() - t0;
+
+  /** Lookup and send, the receiving side is drained outside of the measurement. */
+  for (int m = 0; m < num_messages; m++) {
+    state = state * 1103515245 + 12345;
+    const sctp_assoc_id_t assoc_id = SCTP_ASSOC_BENCH_ASSOC_ID((state >> 8) % num_assocs);
+    int sd = -1;
+    t0 = bench_now_ns();
+    sctp_assoc_table_rdlock();
+    if (sctp_assoc_table_get(assoc_id)) {
+      sd = dup(sv[0]);
+    }
+    sctp_assoc_table_unlock();
+    if (sd < 0 || send(sd, payload, sizeof(payload), MSG_DONTWAIT) < 0) {
+      num_failed++;
+    } else {
+      sctp_assoc_table_rdlock();
+      sctp_association_t *association = sctp_assoc_table_get(assoc_id);
+      if (association) {
+        association->messages_sent++;
+      }
+      sctp_assoc_table_unlock();
+    }
+    if (sd >= 0) {
+      close(sd);
+    }
+    send_ns += bench_now_ns() - t0;
+    while (recv(sv[1], drain, sizeof(drain), MSG_DONTWAIT) > 0);
+  }
+
+  printf("  %5d associations: list walk %8.1f ns  table lookup %8.1f ns  lookup+send %8.1f ns  (%d failed)\n",
+      num_assocs, (double)list_ns / num_messages, (double)lookup_ns / num_messages, (double)send_ns / num_messages, num_failed);
+  sctp_assoc_table_exit(NULL);
+  free(list);
+  return (sink && !num_failed) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  const char        *assocs = SCTP_ASSOC_BENCH_DEFAULT_ASSOCS;
+  int                num_messages = SCTP_ASSOC_BENCH_DEFAULT_MESSAGES;
+  int                sv[2] = {-1, -1};
+  int                opt = 0;
+  int                rc = 0;
+
+  while ((opt = getopt(argc, argv, "a:m:h")) != -1) {
+    switch (opt) {
+    case 'a': assocs = optarg; break;
+    case 'm': num_messages = atoi(optarg); break;
+    default:
+      fprintf(stderr, "Usage: %s [-a association counts, e.g. %s] [-m messages]\n", argv[0], SCTP_ASSOC_BENCH_DEFAULT_ASSOCS);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (num_messages <= 0 || socketpair(AF_UNIX, SOCK_DGRAM, 0, sv)) {
+    fprintf(stderr, "Usage: %s [-a association counts] [-m messages]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%d messages of %d bytes per association count\n", num_messages, SCTP_ASSOC_BENCH_PAYLOAD_SIZE);
+  for (const char *a = assocs; a && *a; a = strchr(a, ',') ? strchr(a, ',') + 1 : NULL) {
+    const int num_assocs = atoi(a);
+    if (num_assocs <= 0 || run_bench(num_assocs, num_messages, sv))
+      rc = 1;
+  }
+  close(sv[0]);
+  close(sv[1]);
+  return rc;
+}
@@ -0,0 +1,206 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file sctp_assoc_table.c
+ *  \brief SCTP associations of the server, indexed by association id and by socket descriptor.
+ *  Kept free of the ITTI dependencies, such that it can be used by the SCTP benchmarks.
+ *  \author Dincer BEKEN
+ *  \company Blackned GmbH
+ *  \email: dbeken@blackned.de
+ *  @ingroup _sctp
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+#include "sctp_assoc_table.h"
+
+/** Minimum number of buckets of the indexes. */
+#define SCTP_ASSOC_TABLE_MIN_SIZE      64
+
+typedef struct sctp_assoc_table_s {
+  pthread_rwlock_t                        rwlock;
+  hash_table_t                           *assoc_id_htbl;        ///< Owns the associations, key is the association id
+  hash_table_t                           *sd_htbl;      ///< Key is the socket descriptor
+} sctp_assoc_table_t;
+
+static sctp_assoc_table_t sctp_assoc_table = {
+  .rwlock = PTHREAD_RWLOCK_INITIALIZER,
+};
+
+typedef struct sctp_assoc_table_release_arg_s {
+  void                                  (*release_f)(sctp_association_t * const association);
+} sctp_assoc_table_release_arg_t;
+
+//------------------------------------------------------------------------------
+static bool sctp_assoc_table_release_cb (sctp_association_t * const association, void * const arg)
+{
+  ((sctp_assoc_table_release_arg_t *)arg)->release_f (association);
+  return false;
+}
+
+//------------------------------------------------------------------------------
+int sctp_assoc_table_init (const uint32_t num_associations)
+{
+  const hash_size_t                       size = (num_associations > SCTP_ASSOC_TABLE_MIN_SIZE) ? num_associations : SCTP_ASSOC_TABLE_MIN_SIZE;
+
+  sctp_assoc_table.assoc_id_htbl = hashtable_create (size, NULL, hash_free_func, NULL);
+  sctp_assoc_table.sd_htbl = hashtable_create (size, NULL, hash_free_int_func, NULL);
+  if (!sctp_assoc_table.assoc_id_htbl || !sctp_assoc_table.sd_htbl) {
+    sctp_assoc_table_exit (NULL);
+    return -1;
+  }
+  /** Lookups of unknown keys are part of the data path, no traces. */
+  sctp_assoc_table.assoc_id_htbl->log_enabled = false;
+  sctp_assoc_table.sd_htbl->log_enabled = false;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void sctp_assoc_table_exit (void (*release_f)(sctp_association_t * const association))
+{
+  pthread_rwlock_wrlock (&sctp_assoc_table.rwlock);
+  if (sctp_assoc_table.sd_htbl) {
+    hashtable_destroy (sctp_assoc_table.sd_htbl);
+    sctp_assoc_table.sd_htbl = NULL;
+  }
+  if (sctp_assoc_table.assoc_id_htbl) {
+    if (release_f) {
+      sctp_assoc_table_release_arg_t      release_arg = {.release_f = release_f};
+      sctp_assoc_table_apply (sctp_assoc_table_release_cb, &release_arg);
+    }
+    hashtable_destroy (sctp_assoc_table.assoc_id_htbl);
+    sctp_assoc_table.assoc_id_htbl = NULL;
+  }
+  pthread_rwlock_unlock (&sctp_assoc_table.rwlock);
+}
+
+//------------------------------------------------------------------------------
+void sctp_assoc_table_rdlock (void)
+{
+  pthread_rwlock_rdlock (&sctp_assoc_table.rwlock);
+}
+
+//------------------------------------------------------------------------------
+void sctp_assoc_table_wrlock (void)
+{
+  pthread_rwlock_wrlock (&sctp_assoc_table.rwlock);
+}
+
+//------------------------------------------------------------------------------
+void sctp_assoc_table_unlock (void)
+{
+  pthread_rwlock_unlock (&sctp_assoc_table.rwlock);
+}
+
+//------------------------------------------------------------------------------
+sctp_association_t *sctp_assoc_table_add (const sctp_assoc_id_t assoc_id, const int sd)
+{
+  sctp_association_t                     *association = NULL;
+
+  if (hashtable_is_key_exists (sctp_assoc_table.assoc_id_htbl, (hash_key_t)assoc_id) == HASH_TABLE_OK
+      || hashtable_is_key_exists (sctp_assoc_table.sd_htbl, (hash_key_t)sd) == HASH_TABLE_OK) {
+    return NULL;
+  }
+  if ((association = calloc (1, sizeof (sctp_association_t))) == NULL) {
+    return NULL;
+  }
+  association->assoc_id = assoc_id;
+  association->sd = sd;
+  if (hashtable_insert (sctp_assoc_table.assoc_id_htbl, (hash_key_t)assoc_id, association) != HASH_TABLE_OK) {
+    free_wrapper ((void**)&association);
+    return NULL;
+  }
+  if (hashtable_insert (sctp_assoc_table.sd_htbl, (hash_key_t)sd, association) != HASH_TABLE_OK) {
+    hashtable_free (sctp_assoc_table.assoc_id_htbl, (hash_key_t)assoc_id);
+    return NULL;
+  }
+  return association;
+}
+
+//------------------------------------------------------------------------------
+sctp_association_t *sctp_assoc_table_remove (const sctp_assoc_id_t assoc_id)
+{
+  sctp_association_t                     *association = NULL;
+
+  if (hashtable_remove (sctp_assoc_table.assoc_id_htbl, (hash_key_t)assoc_id, (void **)&association) != HASH_TABLE_OK) {
+    return NULL;
+  }
+  hashtable_free (sctp_assoc_table.sd_htbl, (hash_key_t)association->sd);
+  return association;
+}
+
+//------------------------------------------------------------------------------
+sctp_association_t *sctp_assoc_table_get (const sctp_assoc_id_t assoc_id)
+{
+  sctp_association_t                     *association = NULL;
+
+  if (hashtable_get (sctp_assoc_table.assoc_id_htbl, (hash_key_t)assoc_id, (void **)&association) != HASH_TABLE_OK) {
+    return NULL;
+  }
+  return association;
+}
+
+//------------------------------------------------------------------------------
+sctp_association_t *sctp_assoc_table_get_by_sd (const int sd)
+{
+  sctp_association_t                     *association = NULL;
+
+  if (hashtable_get (sctp_assoc_table.sd_htbl, (hash_key_t)sd, (void **)&association) != HASH_TABLE_OK) {
+    return NULL;
+  }
+  return association;
+}
+
+//------------------------------------------------------------------------------
+uint32_t sctp_assoc_table_count (void)
+{
+  return sctp_assoc_table.assoc_id_htbl ? sctp_assoc_table.assoc_id_htbl->num_elements : 0;
+}
+
+//------------------------------------------------------------------------------
+typedef struct sctp_assoc_table_apply_arg_s {
+  bool                                  (*cb)(sctp_association_t * const association, void * const arg);
+  void                                   *arg;
+} sctp_assoc_table_apply_arg_t;
+
+static bool sctp_assoc_table_apply_cb (__attribute__((unused)) const hash_key_t key, void * const element, void * const arg, __attribute__((unused)) void **result)
+{
+  sctp_assoc_table_apply_arg_t * const apply_arg = (sctp_assoc_table_apply_arg_t *)arg;
+  return apply_arg->cb ((sctp_association_t *)element, apply_arg->arg);
+}
+
+//------------------------------------------------------------------------------
+void sctp_assoc_table_apply (bool (*cb)(sctp_association_t * const association, void * const arg), void * const arg)
+{
+  sctp_assoc_table_apply_arg_t            apply_arg = {.cb = cb, .arg = arg};
+
+  if (sctp_assoc_table.assoc_id_htbl) {
+    hashtable_apply_callback_on_elements (sctp_assoc_table.assoc_id_htbl, sctp_assoc_table_apply_cb, &apply_arg, NULL);
+  }
+}
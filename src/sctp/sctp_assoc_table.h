@@ -0,0 +1,89 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file sctp_assoc_table.h
+ *  \brief SCTP associations of the server, indexed by association id and by socket descriptor.
+ *  The receiver thread adds and removes associations, the SCTP task sends on them. Lookups and the use of the
+ *  returned association happen under the read lock, adding and removing under the write lock. The SCTP task copies
+ *  what a send needs under the read lock and sends after releasing it.
+ *  \author Dincer BEKEN
+ *  \company Blackned GmbH
+ *  \email: dbeken@blackned.de
+ *  @ingroup _sctp
+ */
+
+#ifndef FILE_SCTP_ASSOC_TABLE_SEEN
+#define FILE_SCTP_ASSOC_TABLE_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#include "common_types.h"
+
+typedef struct sctp_association_s {
+  int                                     sd;   ///< Socket descriptor
+  uint32_t                                ppid; ///< Payload protocol Identifier
+  uint16_t                                instreams;    ///< Number of input streams negociated for this connection
+  uint16_t                                outstreams;   ///< Number of output strams negotiated for this connection
+  sctp_assoc_id_t                         assoc_id;     ///< SCTP association id for the connection
+  uint32_t                                messages_recv;        ///< Number of messages received on this connection
+  uint32_t                                messages_sent;        ///< Number of messages sent on this connection
+
+  struct sockaddr                        *peer_addresses;       ///< A list of peer addresses
+  int                                     nb_peer_addresses;
+} sctp_association_t;
+
+/** \brief Create the indexes, sized for the expected number of associations.
+ * @returns 0 on success, -1 on error
+ **/
+int sctp_assoc_table_init (const uint32_t num_associations);
+
+/** \brief Destroy the indexes and free the remaining associations, after release_f was called on each of them (may be NULL).
+ **/
+void sctp_assoc_table_exit (void (*release_f)(sctp_association_t * const association));
+
+void sctp_assoc_table_rdlock (void);
+void sctp_assoc_table_wrlock (void);
+void sctp_assoc_table_unlock (void);
+
+/** \brief Add a new association with the given id and socket. Write lock held.
+ * @returns the new association, NULL if the id or socket is already used or no memory is left
+ **/
+sctp_association_t *sctp_assoc_table_add (const sctp_assoc_id_t assoc_id, const int sd);
+
+/** \brief Remove the association from both indexes. Write lock held. The caller frees the returned association.
+ * @returns the association, NULL if unknown
+ **/
+sctp_association_t *sctp_assoc_table_remove (const sctp_assoc_id_t assoc_id);
+
+/** \brief Lookups, read or write lock held. */
+sctp_association_t *sctp_assoc_table_get (const sctp_assoc_id_t assoc_id) __attribute__ ((hot));
+sctp_association_t *sctp_assoc_table_get_by_sd (const int sd) __attribute__ ((hot));
+
+/** \brief Number of associations, lock held. */
+uint32_t sctp_assoc_table_count (void);
+
+/** \brief Call cb on each association until it returns true, lock held. */
+void sctp_assoc_table_apply (bool (*cb)(sctp_association_t * const association, void * const arg), void * const arg);
+
+#endif /* FILE_SCTP_ASSOC_TABLE_SEEN */
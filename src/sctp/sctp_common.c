@@ -32,6 +32,7 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -252,3 +253,29 @@ int sctp_get_localaddresses (
 
   return 0;
 }
+
+/* Raise the soft limit of open files (as far as the hard limit allows), one socket per association.
+*/
+//------------------------------------------------------------------------------
+int sctp_raise_fd_limit (
+  const int num_fds)
+{
+  struct rlimit                           limit = {0};
+
+  if (getrlimit (RLIMIT_NOFILE, &limit) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "getrlimit: %d:%s\n", errno, strerror (errno));
+    return -1;
+  }
+
+  if (limit.rlim_cur >= (rlim_t) num_fds) {
+    return 0;
+  }
+
+  limit.rlim_cur = (limit.rlim_max == RLIM_INFINITY || limit.rlim_max >= (rlim_t) num_fds) ? (rlim_t) num_fds : limit.rlim_max;
+  if (setrlimit (RLIMIT_NOFILE, &limit) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "setrlimit: %d:%s\n", errno, strerror (errno));
+    return -1;
+  }
+
+  return (limit.rlim_cur >= (rlim_t) num_fds) ? 0 : -1;
+}
@@ -45,4 +45,6 @@ int sctp_get_peeraddresses(int sock, struct sockaddr **remote_addr,
 int sctp_get_localaddresses(int sock, struct sockaddr **local_addr,
                             int *nb_local_addresses);
 
+int sctp_raise_fd_limit(const int num_fds);
+
 #endif /* FILE_SCTP_COMMON_SEEN */
@@ -34,7 +34,6 @@
 #include <arpa/inet.h>
 
 #include "assertions.h"
-#include "sctp_eNB_defs.h"
 #include "sctp_common.h"
 #include "sctp_primitives_client.h"
 #include "mme_default_values.h"
@@ -44,8 +43,8 @@
 int
 sctp_send_msg (
   sctp_data_t * sctp_data_p,
-  constuint16_t ppid,
-  constsctp_stream_id_t stream,
+  const uint16_t ppid,
+  const sctp_stream_id_t stream,
   const uint8_t * buffer,
   const size_t length)
 {
@@ -139,7 +138,13 @@ sctp_run (
          * Other peer is deconnected
          */
         OAILOG_ERROR (LOG_SCTP, "[SD %d] An error occured during read (%d:%s)\n", sd, errno, strerror (errno));
-        return 0;
+        return -1;
+      } else if (n == 0) {
+        /*
+         * Orderly shutdown by the peer, the socket stays readable.
+         */
+        OAILOG_DEBUG (LOG_SCTP, "[SD %d] Association closed by peer\n", sd);
+        return -1;
       }
 
       if (flags & MSG_NOTIFICATION) {
@@ -182,7 +187,7 @@ sctp_connect_to_remote_host (
   char *local_ip_addr[],
   int nb_local_addr,
   char *remote_ip_addr,
-  constuint16_t port,
+  const uint16_t port,
   int socket_type,
   sctp_data_t * sctp_data_p)
 {
@@ -227,8 +232,10 @@ sctp_connect_to_remote_host (
 
   if (sctp_bindx (sd, bindx_add_addr, nb_local_addr, SCTP_BINDX_ADD_ADDR) < 0) {
     OAILOG_ERROR (LOG_SCTP, "Socket bind failed: %s\n", strerror (errno));
-    return -1;
+    free (bindx_add_addr);
+    goto err;
   }
+  free (bindx_add_addr);
 
   memset ((void *)&init, 0, sizeof (struct sctp_initmsg));
   /*
@@ -241,7 +248,7 @@ sctp_connect_to_remote_host (
 
   if (setsockopt (sd, IPPROTO_SCTP, SCTP_INITMSG, &init, (socklen_t) sizeof (struct sctp_initmsg)) < 0) {
     OAILOG_ERROR (LOG_SCTP, "Setsockopt IPPROTO_SCTP_INITMSG failed: %s\n", strerror (errno));
-    return -1;
+    goto err;
   }
 
   /*
@@ -251,7 +258,7 @@ sctp_connect_to_remote_host (
 
   if (setsockopt (sd, IPPROTO_SCTP, SCTP_EVENTS, &events, sizeof (struct sctp_event_subscribe)) < 0) {
     OAILOG_ERROR (LOG_SCTP, "Setsockopt IPPROTO_SCTP_EVENTS failed: %s\n", strerror (errno));
-    return -1;
+    goto err;
   }
 
   /*
@@ -286,13 +293,14 @@ sctp_connect_to_remote_host (
    */
   sctp_get_sockinfo (sd, &sctp_data_p->instreams, &sctp_data_p->outstreams, &sctp_data_p->assoc_id);
   sctp_data_p->sd = sd;
+  sctp_data_p->remote_port = port;
   sctp_get_peeraddresses (sd, &sctp_data_p->remote_ip_addresses, &sctp_data_p->nb_remote_addresses);
   sctp_get_localaddresses (sd, NULL, NULL);
   TAILQ_INIT (&sctp_data_p->sctp_queue);
   return sd;
 err:
 
-  if (sd != 0) {
+  if (sd >= 0) {
     close (sd);
   }
 
@@ -21,8 +21,10 @@
 
 
 #include <stdint.h>
+#include <sys/queue.h>
+#include <sys/socket.h>
 
-#include "sctp_eNB_defs.h"
+#include "common_types.h"
 
 #ifndef FILE_SCTP_PRIMITIVES_CLIENT_SEEN
 #define FILE_SCTP_PRIMITIVES_CLIENT_SEEN
@@ -32,6 +34,36 @@
  * @{
  */
 
+/** \brief Message received on a client association, queued by sctp_run.
+ */
+typedef struct sctp_queue_item_s {
+  sctp_assoc_id_t                       assoc_id;
+  sctp_stream_id_t                      local_stream;
+  uint16_t                              remote_port;
+  uint32_t                              remote_addr;
+  uint32_t                              ppid;
+  uint8_t                              *buffer;          ///< Owned by the item, freed by the user
+  uint32_t                              length;
+  TAILQ_ENTRY(sctp_queue_item_s)        entry;
+} sctp_queue_item_t;
+
+/** \brief Client association towards a remote SCTP server.
+ */
+typedef struct sctp_data_s {
+  int                                   sd;
+  sctp_assoc_id_t                       assoc_id;
+  sctp_stream_id_t                      instreams;
+  sctp_stream_id_t                      outstreams;
+  uint16_t                              remote_port;
+  struct sockaddr                      *remote_ip_addresses;
+  int                                   nb_remote_addresses;
+
+  /** Messages received by sctp_run and not yet consumed by the user. */
+  TAILQ_HEAD(sctp_queue_head_s, sctp_queue_item_s) sctp_queue;
+  uint32_t                              queue_length;
+  uint32_t                              queue_size;
+} sctp_data_t;
+
 /** \brief SCTP recv callback prototype. Will be called every time a message is
  * received on socket.
  * \param assocId SCTP association ID
@@ -84,9 +116,9 @@ int sctp_connect_to_remote_host(char *local_ip_addr[],
 int sctp_send_msg(sctp_data_t *sctp_data_p, const uint16_t ppid, const sctp_stream_id_t stream,
                   const uint8_t * const buffer, const size_t length);
 
-/** \brief Flush the FIFO of messages from the socket
+/** \brief Flush the FIFO of messages from the socket into the queue of sctp_data_p
  * \param sctp_data_p
- * @return < 0 in case of failure
+ * @return the number of bytes queued, < 0 if the association failed or was closed by the peer
  */
 int sctp_run(sctp_data_t *sctp_data_p);
 
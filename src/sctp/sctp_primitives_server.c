@@ -28,13 +28,18 @@
     @ingroup _sctp
 */
 
+#define _GNU_SOURCE             // required for accept4()
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/sctp.h>
@@ -42,6 +47,7 @@
 
 #include "bstrlib.h"
 
+#include "bstr_pool.h"
 #include "dynamic_memory_check.h"
 #include "common_defs.h"
 #include "assertions.h"
@@ -52,165 +58,141 @@
 #include "sctp_primitives_server.h"
 #include "conversions.h"
 #include "sctp_common.h"
+#include "sctp_assoc_table.h"
 #include "sctp_itti_messaging.h"
 
 
 #define SCTP_RC_ERROR       -1
 #define SCTP_RC_NORMAL_READ  0
 #define SCTP_RC_DISCONNECT   1
-
-typedef struct sctp_association_s {
-  struct sctp_association_s              *next_assoc;   ///< Next association in the list
-  struct sctp_association_s              *previous_assoc;       ///< Previous association in the list
-  int                                     sd;   ///< Socket descriptor
-  uint32_t                                ppid; ///< Payload protocol Identifier
-  uint16_t                                instreams;    ///< Number of input streams negociated for this connection
-  uint16_t                                outstreams;   ///< Number of output strams negotiated for this connection
-  sctp_assoc_id_t                         assoc_id;     ///< SCTP association id for the connection
-  uint32_t                                messages_recv;        ///< Number of messages received on this connection
-  uint32_t                                messages_sent;        ///< Number of messages sent on this connection
-
-  struct sockaddr                        *peer_addresses;       ///< A list of peer addresses
-  int                                     nb_peer_addresses;
-} sctp_association_t;
+#define SCTP_RC_NO_DATA      2   ///< Socket drained, wait for the next edge
+
+/** Receive statistics, written by the owning receiver thread only. */
+typedef struct sctp_recv_stats_s {
+  uint64_t                                messages;     ///< Data messages handed over to the upper layer
+  uint64_t                                bytes;        ///< Payload bytes of these messages
+  uint64_t                                bytes_copied; ///< Payload bytes copied after the read (buffer growth for long messages)
+  uint64_t                                first_ns;     ///< Reception of the first data message
+  uint64_t                                last_ns;      ///< Reception of the last data message
+} sctp_recv_stats_t;
+
+/** Batched send statistics, written by the SCTP task only. */
+typedef struct sctp_send_stats_s {
+  uint64_t                                batches;      ///< SCTP_DATA_MULTI_REQ handled
+  uint64_t                                dests;        ///< Associations addressed by these requests
+  uint64_t                                failed;       ///< Associations the payload could not be sent to
+  uint64_t                                duration_ns;  ///< Wall time of the send passes
+  uint64_t                                max_duration_ns;
+} sctp_send_stats_t;
+
+/** What a send needs of an association, copied out of the table under the read lock. */
+typedef struct sctp_send_dest_s {
+  sctp_assoc_id_t                         assoc_id;
+  uint16_t                                stream;
+  int                                     sd;           ///< Duplicate of the association socket, closed after the send
+  uint32_t                                ppid;
+} sctp_send_dest_t;
+
+/** Receiver thread, with its own epoll set of association sockets. */
+typedef struct sctp_receiver_s {
+  int                                     index;
+  pthread_t                               thread;
+  bool                                    started;
+  int                                     epoll_fd;     ///< Association sockets (and the listeners for receiver 0), edge-triggered
+  uint32_t                                num_sockets;  ///< Association sockets assigned to this receiver so far
+  sctp_recv_stats_t                       stats;
+} sctp_receiver_t;
 
 typedef struct sctp_descriptor_s {
-  // List of connected peers
-  struct sctp_association_s              *available_connections_head;
-  struct sctp_association_s              *available_connections_tail;
-
-  uint32_t                                number_of_connections;
   uint16_t                                nb_instreams;
   uint16_t                                nb_outstreams;
+
+  int                                     epoll_max_events;     ///< Events handled per epoll_wait
+  int                                     nb_receivers;
+  sctp_receiver_t                        *receivers;
+  uint32_t                                next_receiver;        ///< Round-robin assignment of new associations, used by receiver 0 only
+  int                                     reserve_fd;           ///< Released to reject a pending association when no descriptor is left
 } sctp_descriptor_t;
 
+/** Context of a socket registered in an epoll set. */
 typedef struct sctp_arg_s {
   int                                     sd;
   uint32_t                                ppid;
+  bool                                    listener;     ///< Listening socket, accept the new associations
+  sctp_receiver_t                        *receiver;     ///< Receiver reading this socket, for its whole lifetime
+  bstring                                 partial;      ///< Message whose rest was not queued yet, completed on the next edge
+  bool                                    discard;      ///< Rest of a message which could not be stored, skipped up to its end
 } sctp_arg_t;
 
 static struct sctp_descriptor_s         sctp_desc;
 
-// Thread used to handle sctp messages
-static pthread_t                        assoc_thread;
+/** Receive buffers, which are read into directly and passed with the SCTP_DATA_IND to the upper layer. Shared by all receivers. */
+static bstr_pool_t                      sctp_recv_pool;
+static sctp_send_stats_t                sctp_send_stats;
 
 // LOCAL FUNCTIONS prototypes
 void                                   *sctp_receiver_thread (void *args_p);
+static uint64_t                         sctp_now_ns (void);
 static int sctp_send_msg (
     sctp_assoc_id_t sctp_assoc_id,
     uint16_t stream,
     STOLEN_REF bstring *payload);
 
-// Association list related local functions prototypes
-static struct sctp_association_s       *sctp_is_assoc_in_list (sctp_assoc_id_t assoc_id);
-static struct sctp_association_s       *sctp_add_new_peer (void);
+// Association related local functions prototypes
 static int                              sctp_handle_com_down (sctp_assoc_id_t assoc_id);
 static void                             sctp_dump_list (void);
 static void sctp_exit (void);
+static void                             sctp_stop_receivers (void);
+static int                              sctp_epoll_add (struct sctp_arg_s * const sctp_arg_p);
 
 //------------------------------------------------------------------------------
-static struct sctp_association_s *sctp_add_new_peer (void)
+static uint64_t sctp_now_ns (void)
 {
-  struct sctp_association_s              *new_sctp_descriptor = calloc (1, sizeof (struct sctp_association_s));
-
-  if (new_sctp_descriptor == NULL) {
-    OAILOG_ERROR (LOG_SCTP, "Failed to allocate memory for new peer (%s:%d)\n", __FILE__, __LINE__);
-    return NULL;
-  }
-
-  new_sctp_descriptor->next_assoc = NULL;
-  new_sctp_descriptor->previous_assoc = NULL;
-
-  if (sctp_desc.available_connections_tail == NULL) {
-    sctp_desc.available_connections_head = new_sctp_descriptor;
-    sctp_desc.available_connections_tail = sctp_desc.available_connections_head;
-  } else {
-    new_sctp_descriptor->previous_assoc = sctp_desc.available_connections_tail;
-    sctp_desc.available_connections_tail->next_assoc = new_sctp_descriptor;
-    sctp_desc.available_connections_tail = new_sctp_descriptor;
-  }
+  struct timespec                         ts;
 
-  sctp_desc.number_of_connections++;
-  sctp_dump_list ();
-  return new_sctp_descriptor;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
 //------------------------------------------------------------------------------
-static struct sctp_association_s *sctp_is_assoc_in_list (sctp_assoc_id_t assoc_id)
+static void sctp_release_assoc (sctp_association_t * const assoc_desc)
 {
-  struct sctp_association_s              *assoc_desc = NULL;
-
-  if (assoc_id < 0) {
-    return NULL;
-  }
-
-  for (assoc_desc = sctp_desc.available_connections_head; assoc_desc; assoc_desc = assoc_desc->next_assoc) {
-    if (assoc_desc->assoc_id == assoc_id) {
-      break;
-    }
+  if (assoc_desc->peer_addresses) {
+    int rv = sctp_freepaddrs(assoc_desc->peer_addresses);
+    if (rv) OAILOG_DEBUG (LOG_SCTP, "sctp_freepaddrs(%p) failed\n", assoc_desc->peer_addresses);
+    assoc_desc->peer_addresses = NULL;
   }
-
-  return assoc_desc;
 }
 
 //------------------------------------------------------------------------------
-static int sctp_remove_assoc_from_list (sctp_assoc_id_t assoc_id)
+static int sctp_remove_assoc (sctp_assoc_id_t assoc_id)
 {
-  struct sctp_association_s              *assoc_desc = NULL;
+  sctp_association_t                     *assoc_desc = NULL;
+
+  sctp_assoc_table_wrlock ();
+  assoc_desc = sctp_assoc_table_remove (assoc_id);
+  sctp_assoc_table_unlock ();
 
   /*
-   * Association not in the list
+   * Association not in the table
    */
-  if ((assoc_desc = sctp_is_assoc_in_list (assoc_id)) == NULL) {
+  if (assoc_desc == NULL) {
     return -1;
   }
 
-  if (assoc_desc->next_assoc == NULL) {
-    if (assoc_desc->previous_assoc == NULL) {
-      /*
-       * Head and tail
-       */
-      sctp_desc.available_connections_head = sctp_desc.available_connections_tail = NULL;
-    } else {
-      /*
-       * Not head but tail
-       */
-      sctp_desc.available_connections_tail = assoc_desc->previous_assoc;
-      assoc_desc->previous_assoc->next_assoc = NULL;
-    }
-  } else {
-    if (assoc_desc->previous_assoc == NULL) {
-      /*
-       * Head but not tail
-       */
-      sctp_desc.available_connections_head = assoc_desc->next_assoc;
-      assoc_desc->next_assoc->previous_assoc = NULL;
-    } else {
-      /*
-       * Not head and not tail
-       */
-      assoc_desc->previous_assoc->next_assoc = assoc_desc->next_assoc;
-      assoc_desc->next_assoc->previous_assoc = assoc_desc->previous_assoc;
-    }
-  }
-
-  if (assoc_desc->peer_addresses) {
-    int rv = sctp_freepaddrs(assoc_desc->peer_addresses);
-    if (rv) OAILOG_DEBUG (LOG_SCTP, "sctp_freepaddrs(%p) failed\n", assoc_desc->peer_addresses);
-  }
+  sctp_release_assoc (assoc_desc);
   free_wrapper ((void**)&assoc_desc);
-  sctp_desc.number_of_connections--;
   return 0;
 }
 
 //------------------------------------------------------------------------------
-static void sctp_dump_assoc (struct sctp_association_s *sctp_assoc_p)
+static bool sctp_dump_assoc (sctp_association_t * const sctp_assoc_p, __attribute__((unused)) void * const arg)
 {
 #if SCTP_DUMP_LIST
   int                                     i;
 
   if (sctp_assoc_p == NULL) {
-    return;
+    return false;
   }
 
   OAILOG_DEBUG (LOG_SCTP, "sd           : %d\n", sctp_assoc_p->sd);
@@ -230,42 +212,41 @@ static void sctp_dump_assoc (struct sctp_association_s *sctp_assoc_p)
   }
 
 #else
-  sctp_assoc_p = sctp_assoc_p;
+  (void)sctp_assoc_p;
 #endif
+  return false;
 }
 
 //------------------------------------------------------------------------------
 static void sctp_dump_list (void)
 {
 #if SCTP_DUMP_LIST
-  struct sctp_association_s              *sctp_assoc_p = sctp_desc.available_connections_head;
-  OAILOG_DEBUG (LOG_SCTP, "SCTP list contains %d associations\n", sctp_desc.number_of_connections);
-
-  while (sctp_assoc_p != NULL) {
-    sctp_dump_assoc (sctp_assoc_p);
-    sctp_assoc_p = sctp_assoc_p->next_assoc;
-  }
-
+  sctp_assoc_table_rdlock ();
+  OAILOG_DEBUG (LOG_SCTP, "SCTP table contains %u associations\n", sctp_assoc_table_count ());
+  sctp_assoc_table_apply (sctp_dump_assoc, NULL);
+  sctp_assoc_table_unlock ();
 #else
-  sctp_dump_assoc (NULL);
+  sctp_dump_assoc (NULL, NULL);
 #endif
 }
 
 //------------------------------------------------------------------------------
-static int sctp_send_msg (
+/*
+ * Copy what a send on the association needs, called with the association table locked (read).
+ * The socket is duplicated: the receiver thread closes it once the association is removed, possibly while the SCTP task
+ * sends, and the descriptor number could be reused by a new association meanwhile.
+ */
+static int sctp_get_send_dest (
     sctp_assoc_id_t sctp_assoc_id,
     uint16_t stream,
-    STOLEN_REF bstring *payload)
+    sctp_send_dest_t * const dest)
 {
-  struct sctp_association_s              *assoc_desc = NULL;
+  sctp_association_t                     *assoc_desc = NULL;
 
-  DevAssert (*payload);
-
-  if ((assoc_desc = sctp_is_assoc_in_list (sctp_assoc_id)) == NULL) {
+  if ((assoc_desc = sctp_assoc_table_get (sctp_assoc_id)) == NULL) {
     OAILOG_DEBUG (LOG_SCTP, "This assoc id has not been fount in list (%d)\n", sctp_assoc_id);
     return -1;
   }
-
   if (assoc_desc->sd == -1) {
     /*
      * The socket is invalid may be closed.
@@ -273,23 +254,136 @@ static int sctp_send_msg (
     OAILOG_DEBUG (LOG_SCTP, "The socket is invalid may be closed (assoc id %d)\n", sctp_assoc_id);
     return -1;
   }
+  if ((dest->sd = dup (assoc_desc->sd)) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "[%d] dup: %s:%d", sctp_assoc_id, strerror (errno), errno);
+    return -1;
+  }
+  dest->assoc_id = sctp_assoc_id;
+  dest->stream = stream;
+  dest->ppid = assoc_desc->ppid;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Send the payload on the copied association, without the association table locked: a blocking send does not hold off
+ * the receiver threads adding or removing associations.
+ */
+static int sctp_send_to_dest (
+    sctp_send_dest_t * const dest,
+    const_bstring payload)
+{
+  int                                     rc = 0;
 
   OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
-      assoc_desc->sd, sctp_assoc_id, bdata(*payload), blength(*payload), stream, assoc_desc->ppid);
+      dest->sd, dest->assoc_id, bdata(payload), blength(payload), dest->stream, dest->ppid);
 
   /*
    * Send message_p on specified stream of the sd association
    */
-  if (sctp_sendmsg (assoc_desc->sd, (const void *)bdata(*payload), blength(*payload), NULL, 0, htonl(assoc_desc->ppid), 0, stream, 0, 0) < 0) {
-    bdestroy_wrapper(payload);
-    OAILOG_ERROR (LOG_SCTP, "send: %s:%d", strerror (errno), errno);
-    return -1;
+  if (sctp_sendmsg (dest->sd, (const void *)bdata(payload), blength(payload), NULL, 0, htonl(dest->ppid), 0, dest->stream, 0, 0) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "[%d] send: %s:%d", dest->assoc_id, strerror (errno), errno);
+    rc = -1;
+  } else {
+    OAILOG_DEBUG (LOG_SCTP, "Successfully sent %d bytes on stream %d\n", blength(payload), dest->stream);
+  }
+  close (dest->sd);
+  dest->sd = -1;
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Count a sent message on the association, if it is still in the table. Called with the association table locked (read),
+ * messages_sent is only written by the SCTP task.
+ */
+static void sctp_count_sent (
+    sctp_assoc_id_t sctp_assoc_id)
+{
+  sctp_association_t                     *assoc_desc = NULL;
+
+  if ((assoc_desc = sctp_assoc_table_get (sctp_assoc_id)) != NULL) {
+    assoc_desc->messages_sent++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static int sctp_send_msg (
+    sctp_assoc_id_t sctp_assoc_id,
+    uint16_t stream,
+    STOLEN_REF bstring *payload)
+{
+  sctp_send_dest_t                        dest = {0};
+  int                                     rc = -1;
+
+  DevAssert (*payload);
+
+  sctp_assoc_table_rdlock ();
+  rc = sctp_get_send_dest (sctp_assoc_id, stream, &dest);
+  sctp_assoc_table_unlock ();
+  if (rc == 0 && (rc = sctp_send_to_dest (&dest, *payload)) == 0) {
+    sctp_assoc_table_rdlock ();
+    sctp_count_sent (sctp_assoc_id);
+    sctp_assoc_table_unlock ();
   }
-  OAILOG_DEBUG (LOG_SCTP, "Successfully sent %d bytes on stream %d\n", blength(*payload), stream);
   bdestroy_wrapper(payload);
+  return rc;
+}
 
-  assoc_desc->messages_sent++;
-  return 0;
+//------------------------------------------------------------------------------
+/*
+ * Send the same payload to all destinations in one pass, all from the payload buffer of the request: the associations
+ * are copied under one table lock, then one sctp_sendmsg per association without the lock.
+ * Failed destinations are confirmed to the requesting task, after the pass.
+ */
+static void sctp_send_msg_multi (
+    const task_id_t origin_task_id,
+    sctp_data_multi_req_t * const req)
+{
+  bool                                    failed[req->nb_dests ? req->nb_dests : 1];
+  sctp_send_dest_t                        dests[req->nb_dests ? req->nb_dests : 1];
+  uint32_t                                nb_failed = 0;
+  uint64_t                                t0 = sctp_now_ns ();
+  uint64_t                                duration_ns = 0;
+
+  DevAssert (req->payload);
+
+  sctp_assoc_table_rdlock ();
+  for (uint32_t i = 0; i < req->nb_dests; i++) {
+    failed[i] = (sctp_get_send_dest (req->dests[i].assoc_id, req->dests[i].stream, &dests[i]) < 0);
+  }
+  sctp_assoc_table_unlock ();
+
+  for (uint32_t i = 0; i < req->nb_dests; i++) {
+    if (!failed[i]) {
+      failed[i] = (sctp_send_to_dest (&dests[i], req->payload) < 0);
+    }
+    nb_failed += failed[i];
+  }
+
+  if (nb_failed < req->nb_dests) {
+    sctp_assoc_table_rdlock ();
+    for (uint32_t i = 0; i < req->nb_dests; i++) {
+      if (!failed[i]) {
+        sctp_count_sent (req->dests[i].assoc_id);
+      }
+    }
+    sctp_assoc_table_unlock ();
+  }
+
+  duration_ns = sctp_now_ns () - t0;
+  sctp_send_stats.batches++;
+  sctp_send_stats.dests += req->nb_dests;
+  sctp_send_stats.failed += nb_failed;
+  sctp_send_stats.duration_ns += duration_ns;
+  sctp_send_stats.max_duration_ns = (duration_ns > sctp_send_stats.max_duration_ns) ? duration_ns : sctp_send_stats.max_duration_ns;
+  OAILOG_DEBUG (LOG_SCTP, "Sent %d bytes to %u associations (%u failed) in %" PRIu64 " ns\n", blength(req->payload), req->nb_dests, nb_failed, duration_ns);
+
+  for (uint32_t i = 0; nb_failed && i < req->nb_dests; i++) {
+    if (failed[i]) {
+      sctp_itti_send_lower_layer_conf (origin_task_id, req->dests[i].assoc_id, req->dests[i].stream, 0, false);
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -372,21 +466,32 @@ static int sctp_create_new_listener (SctpInit * init_p)
 		  return -1;
 	  }
 
-	  if (listen (sd, 5) < 0) {
+	  if (listen (sd, SOMAXCONN) < 0) {
 		  OAILOG_ERROR (LOG_SCTP, "listen: %s:%d\n", strerror (errno), errno);
 		  return -1;
 	  }
 
-	  if ((sctp_arg_p = malloc (sizeof (struct sctp_arg_s))) == NULL) {
-		  return -1;
+	  /*
+	   * The receiver thread accepts until EAGAIN on each edge.
+	   */
+	  if (fcntl (sd, F_SETFL, fcntl (sd, F_GETFL, 0) | O_NONBLOCK) < 0) {
+		  OAILOG_ERROR (LOG_SCTP, "fcntl: %s:%d\n", strerror (errno), errno);
+		  goto err;
+	  }
+
+	  if ((sctp_arg_p = calloc (1, sizeof (struct sctp_arg_s))) == NULL) {
+		  goto err;
 	  }
 
 	  sctp_arg_p->sd = sd;
 	  sctp_arg_p->ppid = init_p->ppid;
+	  sctp_arg_p->listener = true;
+	  /** All listeners are served by the first receiver, which distributes the new associations. */
+	  sctp_arg_p->receiver = &sctp_desc.receivers[0];
 
-	  if (pthread_create (&assoc_thread, NULL, &sctp_receiver_thread, (void *)sctp_arg_p) < 0) {
-		  OAILOG_ERROR (LOG_SCTP, "pthread_create: %s:%d\n", strerror (errno), errno);
-		  return -1;
+	  if (sctp_epoll_add (sctp_arg_p) < 0) {
+		  free_wrapper ((void**)&sctp_arg_p);
+		  goto err;
 	  }
   }
 
@@ -402,39 +507,211 @@ err:
 }
 
 //------------------------------------------------------------------------------
-static inline int sctp_read_from_socket (int sd, int ppid)
+void sctp_release_recv_buffer (bstring * const payload)
+{
+  bstr_pool_put (&sctp_recv_pool, payload);
+}
+
+//------------------------------------------------------------------------------
+static int sctp_epoll_add (struct sctp_arg_s * const sctp_arg_p)
+{
+  struct epoll_event                      event = {0};
+
+  event.events = EPOLLIN | EPOLLET;
+  event.data.ptr = sctp_arg_p;
+  if (epoll_ctl (sctp_arg_p->receiver->epoll_fd, EPOLL_CTL_ADD, sctp_arg_p->sd, &event) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "[%d] epoll_ctl: %s:%d\n", sctp_arg_p->sd, strerror (errno), errno);
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Same as sctp_recvmsg, without blocking. The association sockets stay blocking for sending.
+ */
+static int sctp_recvmsg_dontwait (
+    int sd,
+    void *buffer,
+    size_t length,
+    struct sockaddr *from,
+    socklen_t *from_len,
+    struct sctp_sndrcvinfo *sinfo,
+    int *msg_flags)
+{
+  struct iovec                            iov = {.iov_base = buffer, .iov_len = length};
+  uint8_t                                 control[CMSG_SPACE (sizeof (struct sctp_sndrcvinfo))];
+  struct msghdr                           msg = {0};
+  struct cmsghdr                         *cmsg = NULL;
+  ssize_t                                 n = 0;
+
+  msg.msg_name = from;
+  msg.msg_namelen = from_len ? *from_len : 0;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+  if ((n = recvmsg (sd, &msg, MSG_DONTWAIT)) < 0) {
+    return -1;
+  }
+  if (from_len) {
+    *from_len = msg.msg_namelen;
+  }
+  *msg_flags = msg.msg_flags;
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_SCTP && cmsg->cmsg_type == SCTP_SNDRCV) {
+      memcpy (sinfo, CMSG_DATA (cmsg), sizeof (struct sctp_sndrcvinfo));
+    }
+  }
+  return (int)n;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Peer closed or the association failed, without a notification being read before.
+ */
+static int sctp_handle_read_closed (const int sd, const int n)
+{
+  sctp_association_t                     *association = NULL;
+  sctp_assoc_id_t                         assoc_id = 0;
+
+  OAILOG_DEBUG (LOG_SCTP, "[%d] Connection closed: %s\n", sd, n ? strerror (errno) : "EOF");
+  sctp_assoc_table_rdlock ();
+  if ((association = sctp_assoc_table_get_by_sd (sd)) != NULL) {
+    assoc_id = association->assoc_id;
+  }
+  sctp_assoc_table_unlock ();
+  if (association) {
+    sctp_handle_com_down (assoc_id);
+  }
+  return SCTP_RC_DISCONNECT;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Skips the rest of a message which could not be stored, so that the next read starts with a new message.
+ * The edge is consumed either way: if the end of the message is not queued yet, it is skipped on the next edge.
+ */
+static int sctp_discard_message (struct sctp_arg_s * const sctp_arg_p)
+{
+  unsigned char                           scratch[SCTP_RECV_BUFFER_SIZE];
+  struct sctp_sndrcvinfo                  sinfo = {0};
+  int                                     flags = 0,
+                                          n;
+
+  do {
+    n = sctp_recvmsg_dontwait (sctp_arg_p->sd, (void *)scratch, sizeof (scratch), NULL, NULL, &sinfo, &flags);
+  } while ((n > 0 && !(flags & MSG_EOR)) || (n < 0 && errno == EINTR));
+
+  sctp_arg_p->discard = false;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    sctp_arg_p->discard = true;
+    return SCTP_RC_NO_DATA;
+  }
+  if (n <= 0) {
+    return sctp_handle_read_closed (sctp_arg_p->sd, n);
+  }
+  return SCTP_RC_ERROR;
+}
+
+//------------------------------------------------------------------------------
+static inline int sctp_read_from_socket (sctp_receiver_t * const receiver, struct sctp_arg_s * const sctp_arg_p)
 {
+  const int                               sd = sctp_arg_p->sd;
+  const int                               ppid = sctp_arg_p->ppid;
   int                                     flags = 0,
     n;
   socklen_t                               from_len = 0;
   struct sctp_sndrcvinfo                  sinfo = {0};
   struct sockaddr_in6                     addr = {0};
-  uint8_t                                 buffer[SCTP_RECV_BUFFER_SIZE];
+  bstring                                 buffer = NULL;
 
   if (sd < 0) {
     return -1;
   }
 
-  memset ((void *)&addr, 0, sizeof (struct sockaddr_in6));
-  from_len = (socklen_t) sizeof (struct sockaddr_in6);
-  memset ((void *)&sinfo, 0, sizeof (struct sctp_sndrcvinfo));
-  n = sctp_recvmsg (sd, (void *)buffer, SCTP_RECV_BUFFER_SIZE, (struct sockaddr *)&addr, &from_len, &sinfo, &flags);
+  if (sctp_arg_p->discard) {
+    return sctp_discard_message (sctp_arg_p);
+  }
 
-  if (n < 0) {
-    OAILOG_DEBUG (LOG_SCTP, "An error occured during read\n");
-    OAILOG_ERROR (LOG_SCTP, "sctp_recvmsg: %s:%d\n", strerror (errno), errno);
-    return SCTP_RC_ERROR;
+  if (sctp_arg_p->partial) {
+    /** The first part of the message was read on an earlier edge. */
+    buffer = sctp_arg_p->partial;
+    sctp_arg_p->partial = NULL;
+  } else {
+    /*
+     * Read directly into a pooled buffer, which is handed over to the upper layer without copying.
+     * An empty pool allocates, so no buffer means no memory: the message is dropped, not left behind the edge.
+     */
+    if ((buffer = bstr_pool_get (&sctp_recv_pool)) == NULL) {
+      OAILOG_ERROR (LOG_SCTP, "[%d] Failed to allocate a receive buffer, the message is dropped\n", sd);
+      return sctp_discard_message (sctp_arg_p);
+    }
+
+    memset ((void *)&addr, 0, sizeof (struct sockaddr_in6));
+    from_len = (socklen_t) sizeof (struct sockaddr_in6);
+    memset ((void *)&sinfo, 0, sizeof (struct sctp_sndrcvinfo));
+    n = sctp_recvmsg_dontwait (sd, (void *)buffer->data, buffer->mlen - 1, (struct sockaddr *)&addr, &from_len, &sinfo, &flags);
+
+    if (n <= 0) {
+      int                                     rc = SCTP_RC_ERROR;
+
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        rc = SCTP_RC_NO_DATA;
+      } else if (n == 0 || errno != EINTR) {
+        rc = sctp_handle_read_closed (sd, n);
+      }
+      bstr_pool_put (&sctp_recv_pool, &buffer);
+      return rc;
+    }
+    buffer->slen = n;
+  }
+
+  /*
+   * The rest of a message longer than the buffer is read behind the first part.
+   * If it is not queued yet, the buffer stays with the socket until the next edge.
+   */
+  while (!(flags & MSG_EOR)) {
+    unsigned char                          *data = buffer->data;
+
+    if (balloc (buffer, buffer->slen + sctp_recv_pool.buffer_size + 1) != BSTR_OK) {
+      OAILOG_ERROR (LOG_SCTP, "[%d] Failed to grow the receive buffer beyond %d bytes, the message is dropped\n", sd, buffer->slen);
+      bstr_pool_put (&sctp_recv_pool, &buffer);
+      return sctp_discard_message (sctp_arg_p);
+    }
+    if (data != buffer->data) {
+      receiver->stats.bytes_copied += buffer->slen;
+    }
+    n = sctp_recvmsg_dontwait (sd, (void *)(buffer->data + buffer->slen), buffer->mlen - buffer->slen - 1, NULL, NULL, &sinfo, &flags);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      OAILOG_DEBUG (LOG_SCTP, "[%d] %d bytes of a message received, waiting for the rest\n", sd, buffer->slen);
+      sctp_arg_p->partial = buffer;
+      return SCTP_RC_NO_DATA;
+    }
+    if (n <= 0) {
+      const int                               rc = sctp_handle_read_closed (sd, n);
+
+      bstr_pool_put (&sctp_recv_pool, &buffer);
+      return rc;
+    }
+    buffer->slen += n;
   }
+  buffer->data[buffer->slen] = '\0';
+  n = buffer->slen;
 
   if (flags & MSG_NOTIFICATION) {
-    union sctp_notification                *snp = (union sctp_notification *)buffer;
+    union sctp_notification                *snp = (union sctp_notification *)buffer->data;
+    int                                     rc = SCTP_RC_NORMAL_READ;
 
     /*
      * Client deconnection
      */
     if (SCTP_SHUTDOWN_EVENT == snp->sn_header.sn_type) {
       OAILOG_DEBUG (LOG_SCTP, "SCTP_SHUTDOWN_EVENT received\n");
-      return sctp_handle_com_down (snp->sn_shutdown_event.sse_assoc_id);
+      rc = sctp_handle_com_down (snp->sn_shutdown_event.sse_assoc_id);
     }
     /*
      * Association has changed.
@@ -450,27 +727,29 @@ static inline int sctp_read_from_socket (int sd, int ppid)
        */
       switch (sctp_assoc_changed->sac_state) {
       case SCTP_COMM_UP:{
-          struct sctp_association_s              *new_association = NULL;
+          sctp_association_t                     *new_association = NULL;
 
           sctp_get_sockinfo (sd, NULL, NULL, NULL);
           OAILOG_DEBUG (LOG_SCTP, "New connection\n");
 
-          if ((new_association = sctp_add_new_peer ()) == NULL) {
-            // TODO: handle this case
-            DevMessage ("Unexpected error...\n");
-            return SCTP_RC_ERROR;
-          } else {
-            new_association->sd = sd;
+          sctp_assoc_table_wrlock ();
+          if ((new_association = sctp_assoc_table_add (sctp_assoc_changed->sac_assoc_id, sd)) != NULL) {
             new_association->ppid = ppid;
             new_association->instreams = sctp_assoc_changed->sac_inbound_streams;
             new_association->outstreams = sctp_assoc_changed->sac_outbound_streams;
-            new_association->assoc_id = sctp_assoc_changed->sac_assoc_id;
             sctp_get_localaddresses (sd, NULL, NULL);
             sctp_get_peeraddresses (sd, &new_association->peer_addresses, &new_association->nb_peer_addresses);
+          }
+          sctp_assoc_table_unlock ();
 
-            if (sctp_itti_send_new_association (new_association->assoc_id, new_association->instreams, new_association->outstreams) < 0) {
-              OAILOG_ERROR (LOG_SCTP, "Failed to send message to S1AP\n");
-              return SCTP_RC_ERROR;
+          if (new_association == NULL) {
+            OAILOG_ERROR (LOG_SCTP, "[%d][%d] Could not add the association, already known or no memory left\n", sctp_assoc_changed->sac_assoc_id, sd);
+            rc = SCTP_RC_ERROR;
+          } else {
+            sctp_dump_list ();
+            if (sctp_itti_send_new_association (sctp_assoc_changed->sac_assoc_id, sctp_assoc_changed->sac_inbound_streams, sctp_assoc_changed->sac_outbound_streams) < 0) {
+              OAILOG_ERROR (LOG_SCTP, "Failed to send message to M2AP\n");
+              rc = SCTP_RC_ERROR;
             }
           }
         }
@@ -479,7 +758,7 @@ static inline int sctp_read_from_socket (int sd, int ppid)
       case SCTP_RESTART:{
         OAILOG_DEBUG (LOG_SCTP, "Received SCTP restart for the new connection.\n");
         /** No separate SCTP INIT will be expected.. */
-        return SCTP_RC_ERROR;
+        rc = SCTP_RC_ERROR;
       }
       break;
 
@@ -487,31 +766,54 @@ static inline int sctp_read_from_socket (int sd, int ppid)
         break;
       }
     }
+    /** Notifications are consumed here, the buffer can be reused right away. */
+    bstr_pool_put (&sctp_recv_pool, &buffer);
+    return rc;
   } else {
     /*
      * Data payload received
      */
-    struct sctp_association_s              *association;
+    sctp_association_t                     *association;
+    uint32_t                                assoc_ppid;
+    sctp_stream_id_t                        instreams,
+                                            outstreams;
 
-    if ((association = sctp_is_assoc_in_list (sinfo.sinfo_assoc_id)) == NULL) {
+    sctp_assoc_table_rdlock ();
+    if ((association = sctp_assoc_table_get (sinfo.sinfo_assoc_id)) == NULL) {
       // TODO: handle this case
+      sctp_assoc_table_unlock ();
+      bstr_pool_put (&sctp_recv_pool, &buffer);
       return SCTP_RC_ERROR;
     }
 
     association->messages_recv++;
+    assoc_ppid = association->ppid;
+    instreams = association->instreams;
+    outstreams = association->outstreams;
+    sctp_assoc_table_unlock ();
 
-    if (ntohl (sinfo.sinfo_ppid) != association->ppid) {
+    if (ntohl (sinfo.sinfo_ppid) != assoc_ppid) {
       /*
        * Mismatch in Payload Protocol Identifier,
-       * * * * may be we received unsollicited traffic from stack other than S1AP.
+       * * * * may be we received unsollicited traffic from stack other than M2AP.
        */
-      OAILOG_ERROR (LOG_SCTP, "Received data from peer with unsollicited PPID %d, expecting %d\n", ntohl (sinfo.sinfo_ppid), association->ppid);
+      OAILOG_ERROR (LOG_SCTP, "Received data from peer with unsollicited PPID %d, expecting %d\n", ntohl (sinfo.sinfo_ppid), assoc_ppid);
+      bstr_pool_put (&sctp_recv_pool, &buffer);
       return SCTP_RC_ERROR;
     }
 
     OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Msg of length %d received from port %u, on stream %d, PPID %d\n", sinfo.sinfo_assoc_id, sd, n, ntohs (addr.sin6_port), sinfo.sinfo_stream, ntohl (sinfo.sinfo_ppid));
-    bstring payload = blk2bstr(buffer, n);
-    sctp_itti_send_new_message_ind (&payload, sinfo.sinfo_assoc_id, sinfo.sinfo_stream, association->instreams, association->outstreams);
+    receiver->stats.last_ns = sctp_now_ns ();
+    if (!receiver->stats.messages++) {
+      receiver->stats.first_ns = receiver->stats.last_ns;
+    }
+    receiver->stats.bytes += n;
+    /*
+     * The association context travels with the message. An association is read by one receiver only,
+     * so the messages of each stream reach the upper layer in order.
+     * The buffer is released by the upper layer after decoding (sctp_release_recv_buffer).
+     */
+    sctp_itti_send_new_message_ind (&buffer, sinfo.sinfo_assoc_id, sinfo.sinfo_stream, instreams, outstreams);
   }
 
   OAILOG_DEBUG (LOG_SCTP, "SCTP RETURNING!!\n");
@@ -525,10 +827,10 @@ static int sctp_handle_com_down (sctp_assoc_id_t assoc_id)
   OAILOG_DEBUG (LOG_SCTP, "Sending close connection for assoc_id %u\n", assoc_id);
 
   if (sctp_itti_send_com_down_ind (assoc_id) < 0) {
-    OAILOG_ERROR (LOG_SCTP, "Failed to send message to TASK_S1AP\n");
+    OAILOG_ERROR (LOG_SCTP, "Failed to send message to TASK_M2AP\n");
   }
 
-  if (sctp_remove_assoc_from_list (assoc_id) < 0) {
+  if (sctp_remove_assoc (assoc_id) < 0) {
     OAILOG_ERROR (LOG_SCTP, "Failed to find client in list\n");
   }
 
@@ -536,98 +838,117 @@ static int sctp_handle_com_down (sctp_assoc_id_t assoc_id)
 }
 
 //------------------------------------------------------------------------------
-void *sctp_receiver_thread (void *args_p)
+static void sctp_accept_new_associations (struct sctp_arg_s * const listener_p)
 {
-  struct sctp_arg_s                      *sctp_arg_p = NULL;
+  int                                     clientsock = -1;
 
   /*
-   * maximum file descriptor number
+   * Edge-triggered, accept until no connection is pending anymore.
    */
-  int                                     fdmax,
-                                          clientsock,
-                                          i;
+  for (;;) {
+    struct sctp_arg_s                      *sctp_arg_p = NULL;
 
-  /*
-   * master file descriptor list
-   */
-  fd_set                                  master;
+    if ((clientsock = accept4 (listener_p->sd, NULL, NULL, SOCK_CLOEXEC)) < 0) {
+      if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+        /** Interrupted, or the association was aborted while pending: the next ones are still queued. */
+        continue;
+      }
+      if ((errno == EMFILE || errno == ENFILE) && sctp_desc.reserve_fd >= 0) {
+        /*
+         * Without a descriptor the pending association stays queued and the listener gets no new edge.
+         * Accept it on the reserved descriptor and close it right away, then the next ones.
+         */
+        close (sctp_desc.reserve_fd);
+        clientsock = accept4 (listener_p->sd, NULL, NULL, SOCK_CLOEXEC);
+        if (clientsock >= 0) {
+          OAILOG_ERROR (LOG_SCTP, "[%d] No file descriptor left, association rejected\n", listener_p->sd);
+          close (clientsock);
+        }
+        if ((sctp_desc.reserve_fd = open ("/dev/null", O_RDONLY | O_CLOEXEC)) < 0) {
+          OAILOG_WARNING (LOG_SCTP, "Could not reserve a file descriptor again: %s:%d\n", strerror (errno), errno);
+        }
+        if (clientsock >= 0) {
+          continue;
+        }
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        OAILOG_ERROR (LOG_SCTP, "[%d] accept: %s:%d\n", listener_p->sd, strerror (errno), errno);
+      }
+      break;
+    }
 
-  /*
-   * temp file descriptor list for select()
-   */
-  fd_set                                  read_fds;
+    if ((sctp_arg_p = calloc (1, sizeof (struct sctp_arg_s))) == NULL) {
+      close (clientsock);
+      continue;
+    }
+    sctp_arg_p->sd = clientsock;
+    sctp_arg_p->ppid = listener_p->ppid;
+    sctp_arg_p->listener = false;
+    /** The association stays with this receiver until it is closed. */
+    sctp_arg_p->receiver = &sctp_desc.receivers[sctp_desc.next_receiver++ % sctp_desc.nb_receivers];
+    sctp_arg_p->receiver->num_sockets++;
+    OAILOG_DEBUG (LOG_SCTP, "[%d] New association socket assigned to receiver %d\n", clientsock, sctp_arg_p->receiver->index);
+    /** Data already received is signalled right away. */
+    if (sctp_epoll_add (sctp_arg_p) < 0) {
+      close (clientsock);
+      free_wrapper ((void**)&sctp_arg_p);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void *sctp_receiver_thread (void *args_p)
+{
+  sctp_receiver_t                        *receiver = (sctp_receiver_t *)args_p;
+  struct epoll_event                     *events = calloc (sctp_desc.epoll_max_events, sizeof (struct epoll_event));
+  int                                     num_events = 0,
+                                          i;
 
-  if ((sctp_arg_p = (struct sctp_arg_s *)args_p) == NULL) {
+  if (events == NULL) {
     pthread_exit (NULL);
   }
 
-  /*
-   * clear the master and temp sets
-   */
-  FD_ZERO (&master);
-  FD_ZERO (&read_fds);
-  FD_SET (sctp_arg_p->sd, &master);
-  fdmax = sctp_arg_p->sd;       /* so far, it's this one */
-
   while (1) {
-    memcpy (&read_fds, &master, sizeof (master));
-
-    if (select (fdmax + 1, &read_fds, NULL, NULL, NULL) == -1) {
-      OAILOG_ERROR (LOG_SCTP, "[%d] Select() error: %s", sctp_arg_p->sd, strerror (errno));
-      free_wrapper ((void**)&args_p);
-      pthread_exit (NULL);
+    if ((num_events = epoll_wait (receiver->epoll_fd, events, sctp_desc.epoll_max_events, -1)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      OAILOG_ERROR (LOG_SCTP, "Receiver %d epoll_wait() error: %s", receiver->index, strerror (errno));
+      break;
     }
 
-    for (i = 0; i <= fdmax; i++) {
-      if (FD_ISSET (i, &read_fds)) {
-        if (i == sctp_arg_p->sd) {
-          /*
-           * There is data to read on listener socket. This means we have to accept
-           * * * * the connection.
-           */
-          if ((clientsock = accept (sctp_arg_p->sd, NULL, NULL)) < 0) {
-            OAILOG_ERROR (LOG_SCTP, "[%d] accept: %s:%d\n", sctp_arg_p->sd, strerror (errno), errno);
-            free_wrapper ((void**)&args_p);
-            pthread_exit (NULL);
-          } else {
-            FD_SET (clientsock, &master);       /* add to master set */
+    for (i = 0; i < num_events; i++) {
+      struct sctp_arg_s                      *sctp_arg_p = (struct sctp_arg_s *)events[i].data.ptr;
 
-            if (clientsock > fdmax) {
-              /*
-               * keep track of the maximum
-               */
-              fdmax = clientsock;
-            }
-          }
-        } else {
-          int                                     ret;
+      if (sctp_arg_p->listener) {
+        /*
+         * There is data to read on listener socket. This means we have to accept
+         * * * * the connection.
+         */
+        sctp_accept_new_associations (sctp_arg_p);
+      } else {
+        int                                     ret;
 
-          /*
-           * Read from socket
-           */
-          ret = sctp_read_from_socket (i, sctp_arg_p->ppid);
+        /*
+         * Read from socket, until drained
+         */
+        do {
+          ret = sctp_read_from_socket (receiver, sctp_arg_p);
+        } while (ret != SCTP_RC_NO_DATA && ret != SCTP_RC_DISCONNECT);
 
-          /*
-           * When the socket is disconnected we have to update
-           * * * * the fd_set.
-           */
-          if (ret == SCTP_RC_DISCONNECT) {
-            /*
-             * Remove the socket from the FD set and update the max sd
-             */
-            FD_CLR (i, &master);
-
-            if (i == fdmax) {
-              while (FD_ISSET (fdmax, &master) == false)
-                fdmax -= 1;
-            }
-          }
+        /*
+         * When the socket is disconnected, closing it removes it from the epoll set.
+         */
+        if (ret == SCTP_RC_DISCONNECT) {
+          close (sctp_arg_p->sd);
+          bstr_pool_put (&sctp_recv_pool, &sctp_arg_p->partial);
+          free_wrapper ((void**)&sctp_arg_p);
         }
       }
     }
   }
 
-  free_wrapper ((void**)&args_p);
+  free_wrapper ((void**)&events);
   return NULL;
 }
 
@@ -668,6 +989,11 @@ static void * sctp_intertask_interface (void *args_p)
       }
       break;
 
+    case SCTP_DATA_MULTI_REQ:{
+        sctp_send_msg_multi (received_message_p->ittiMsgHeader.originTaskId, &SCTP_DATA_MULTI_REQ (received_message_p));
+      }
+      break;
+
     case SCTP_INIT_MSG:{
         OAILOG_DEBUG (LOG_SCTP, "Received SCTP_INIT_MSG\n");
 
@@ -710,6 +1036,58 @@ static void * sctp_intertask_interface (void *args_p)
   return NULL;
 }
 
+//------------------------------------------------------------------------------
+static void sctp_stop_receivers (void)
+{
+  for (int i = 0; i < sctp_desc.nb_receivers && sctp_desc.receivers; i++) {
+    sctp_receiver_t                        *receiver = &sctp_desc.receivers[i];
+
+    if (receiver->started) {
+      int rv = pthread_cancel (receiver->thread);
+      if (rv) {
+        OAILOG_DEBUG (LOG_SCTP, "pthread_cancel(%08lX) failed: %d:%s\n", receiver->thread, rv, strerror(rv));
+      } else {
+        pthread_join (receiver->thread, NULL);
+      }
+      receiver->started = false;
+    }
+    if (receiver->epoll_fd > 0) {
+      close (receiver->epoll_fd);
+      receiver->epoll_fd = -1;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Receive rate of each receiver and of all receivers together, over the time data was received.
+ */
+static void sctp_log_recv_stats (void)
+{
+  sctp_recv_stats_t                       total = {0};
+
+  for (int i = 0; i < sctp_desc.nb_receivers; i++) {
+    const sctp_recv_stats_t                *stats = &sctp_desc.receivers[i].stats;
+
+    OAILOG_INFO (LOG_SCTP, "Receiver %d: %u associations, received %" PRIu64 " messages, %" PRIu64 " bytes, %.1f msg/s\n",
+        i, sctp_desc.receivers[i].num_sockets, stats->messages, stats->bytes,
+        (stats->last_ns > stats->first_ns) ? (double)(stats->messages - 1) * 1e9 / (stats->last_ns - stats->first_ns) : 0.0);
+    if (!stats->messages) {
+      continue;
+    }
+    total.first_ns = (!total.messages || stats->first_ns < total.first_ns) ? stats->first_ns : total.first_ns;
+    total.last_ns = (stats->last_ns > total.last_ns) ? stats->last_ns : total.last_ns;
+    total.messages += stats->messages;
+    total.bytes += stats->bytes;
+    total.bytes_copied += stats->bytes_copied;
+  }
+  OAILOG_INFO (LOG_SCTP, "Received %" PRIu64 " messages, %" PRIu64 " bytes with %d receivers, %.1f msg/s, %.2f bytes copied per message, %" PRIu64 " receive buffers allocated, %" PRIu64 " reused\n",
+      total.messages, total.bytes, sctp_desc.nb_receivers,
+      (total.last_ns > total.first_ns) ? (double)(total.messages - 1) * 1e9 / (total.last_ns - total.first_ns) : 0.0,
+      total.messages ? (double)total.bytes_copied / total.messages : 0.0,
+      sctp_recv_pool.num_allocated, sctp_recv_pool.num_reused);
+}
+
 //------------------------------------------------------------------------------
 int sctp_init (const mce_config_t * mce_config_p)
 {
@@ -721,6 +1099,57 @@ int sctp_init (const mce_config_t * mce_config_p)
   sctp_desc.nb_instreams = mce_config_p->sctp_config.in_streams;
   sctp_desc.nb_outstreams = mce_config_p->sctp_config.out_streams;
 
+  sctp_desc.epoll_max_events = mce_config_p->sctp_config.epoll_max_events ? mce_config_p->sctp_config.epoll_max_events : SCTP_EPOLL_MAX_EVENTS;
+  sctp_desc.nb_receivers = mce_config_p->sctp_config.receiver_threads ? mce_config_p->sctp_config.receiver_threads : SCTP_RECEIVER_THREADS;
+  /** Kept to reject pending associations when the descriptors are exhausted, see sctp_accept_new_associations. */
+  if ((sctp_desc.reserve_fd = open ("/dev/null", O_RDONLY | O_CLOEXEC)) < 0) {
+    OAILOG_WARNING (LOG_SCTP, "Could not reserve a file descriptor: %s:%d\n", strerror (errno), errno);
+  }
+
+  /*
+   * One socket per eNB association, more than FD_SETSIZE are possible.
+   */
+  if (sctp_raise_fd_limit (mce_config_p->mbms.max_m2_enbs + SCTP_RESERVED_FDS) < 0) {
+    OAILOG_WARNING (LOG_SCTP, "Could not raise the open file limit for %u eNB associations\n", mce_config_p->mbms.max_m2_enbs);
+  }
+
+  if (sctp_assoc_table_init (mce_config_p->mbms.max_m2_enbs) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "Failed to allocate the SCTP association table\n");
+    return -1;
+  }
+
+  /** Receive buffers are kept for a full epoll batch of each receiver. */
+  if (bstr_pool_init (&sctp_recv_pool, SCTP_RECV_BUFFER_SIZE, SCTP_RECV_BUFFER_POOL_SIZE * sctp_desc.nb_receivers) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "Failed to allocate the SCTP receive buffers\n");
+    return -1;
+  }
+
+  if ((sctp_desc.receivers = calloc (sctp_desc.nb_receivers, sizeof (sctp_receiver_t))) == NULL) {
+    OAILOG_ERROR (LOG_SCTP, "Failed to allocate %d SCTP receivers\n", sctp_desc.nb_receivers);
+    return -1;
+  }
+
+  /*
+   * The receiver threads are started before the first listener is added.
+   */
+  for (int i = 0; i < sctp_desc.nb_receivers; i++) {
+    sctp_receiver_t                        *receiver = &sctp_desc.receivers[i];
+
+    receiver->index = i;
+    if ((receiver->epoll_fd = epoll_create1 (EPOLL_CLOEXEC)) < 0) {
+      OAILOG_ERROR (LOG_SCTP, "epoll_create1: %s:%d\n", strerror (errno), errno);
+      sctp_stop_receivers ();
+      return -1;
+    }
+    if (pthread_create (&receiver->thread, NULL, &sctp_receiver_thread, receiver) != 0) {
+      OAILOG_ERROR (LOG_SCTP, "pthread_create: %s:%d\n", strerror (errno), errno);
+      sctp_stop_receivers ();
+      return -1;
+    }
+    receiver->started = true;
+  }
+  OAILOG_INFO (LOG_SCTP, "Started %d SCTP receiver threads\n", sctp_desc.nb_receivers);
+
   if (itti_create_task (TASK_SCTP, &sctp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR (LOG_SCTP, "create task failed");
     OAILOG_DEBUG (LOG_SCTP, "Initializing SCTP task interface: FAILED\n");
@@ -734,22 +1163,20 @@ int sctp_init (const mce_config_t * mce_config_p)
 //------------------------------------------------------------------------------
 static void sctp_exit (void)
 {
-
-  int rv = pthread_cancel(assoc_thread);
-  if (rv) OAILOG_DEBUG (LOG_SCTP, "pthread_cancel(%08lX) failed: %d:%s\n", assoc_thread, rv, strerror(rv));
-
-  struct sctp_association_s              *sctp_assoc_p = sctp_desc.available_connections_head;
-  struct sctp_association_s              *next_sctp_assoc_p = sctp_desc.available_connections_head;
-
-  while (next_sctp_assoc_p) {
-    next_sctp_assoc_p = sctp_assoc_p->next_assoc;
-    if (sctp_assoc_p->peer_addresses) {
-      rv = sctp_freepaddrs(sctp_assoc_p->peer_addresses);
-      if (rv) OAILOG_DEBUG (LOG_SCTP, "sctp_freepaddrs(%p) failed\n", sctp_assoc_p->peer_addresses);
-    }
-    free_wrapper ((void**)&sctp_assoc_p);
-    sctp_desc.number_of_connections--;
-    sctp_assoc_p = next_sctp_assoc_p;
+  sctp_stop_receivers ();
+
+  sctp_assoc_table_exit (sctp_release_assoc);
+  sctp_log_recv_stats ();
+  if (sctp_send_stats.batches) {
+    OAILOG_INFO (LOG_SCTP, "Sent %" PRIu64 " batched requests to %" PRIu64 " associations (%" PRIu64 " failed), fan-out avg %.1f us, max %.1f us\n",
+        sctp_send_stats.batches, sctp_send_stats.dests, sctp_send_stats.failed,
+        (double)sctp_send_stats.duration_ns / sctp_send_stats.batches / 1000.0, (double)sctp_send_stats.max_duration_ns / 1000.0);
+  }
+  free_wrapper ((void**)&sctp_desc.receivers);
+  bstr_pool_exit (&sctp_recv_pool);
+  if (sctp_desc.reserve_fd >= 0) {
+    close (sctp_desc.reserve_fd);
+    sctp_desc.reserve_fd = -1;
   }
   OAI_FPRINTF_INFO("TASK_SCTP terminated\n");
 }
@@ -41,6 +41,7 @@
 # include "config.h"
 #endif
 
+#include "bstrlib.h"
 #include "mce_config.h"
 
 /** \brief SCTP data received callback
@@ -56,6 +57,11 @@ typedef void (*sctp_recv_callback)(uint8_t *buffer, uint32_t length);
 struct mce_config_s;
 int sctp_init(const struct mce_config_s *mce_config_p);
 
+/** \brief Give the payload of a SCTP_DATA_IND back to the SCTP receive buffers, once it has been decoded.
+ \param payload The payload, reset to NULL
+ **/
+void sctp_release_recv_buffer(bstring * const payload);
+
 #endif /* FILE_SCTP_PRIMITIVES_SERVER_SEEN */
 
 /* @} */
@@ -0,0 +1,560 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_echo_restart_test.c
+* \brief Sm path supervision and MBMS-GW restart handling of the MCE, tested against sm_mbms_gw_loadgen -R.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+* A single nwgtpv2c stack instance acts as the Sm interface of the MCE, with the path supervision of the Sm task
+* (sm_mce_path.c): the MBMS Session Start, Update and Stop Requests of the MBMS-GW are accepted with one local tunnel
+* per session, Echo Requests are sent periodically (T3, N3) and the restart counter of the Echo Requests and Responses
+* of the MBMS-GW is checked. On a new restart counter, its transactions and tunnels are released with one nwGtpv2cPurgePeer.
+* At the end of the run, the test fails (exit status 1) unless:
+*  - a restart of the MBMS-GW was detected, and its purge released all tunnels active at that moment,
+*  - no request of the MBMS-GW referred to a released tunnel (no Context Not Found),
+*  - no tunnel is left (the MBMS-GW stops its remaining sessions at its end).
+*/
+
+#define _GNU_SOURCE             // required for ppoll()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "common_defs.h"
+#include "3gpp_29.274.h"
+
+#include "NwTypes.h"
+#include "NwLog.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cMsgParser.h"
+#include "sm_mce_path.h"
+
+#define SM_ECHO_RESTART_TEST_DEFAULT_PORT                       (2123)
+#define SM_ECHO_RESTART_TEST_DEFAULT_DURATION                   (15)
+#define SM_ECHO_RESTART_TEST_DEFAULT_ECHO_INTERVAL              (1)
+#define SM_ECHO_RESTART_TEST_ECHO_T3                            (1)
+#define SM_ECHO_RESTART_TEST_ECHO_N3                            (2)
+#define SM_ECHO_RESTART_TEST_MAX_TUNNELS                        (1 << 16)
+#define SM_ECHO_RESTART_TEST_RECV_BUFFER_SIZE                   (4096)
+
+#define NSEC_PER_SEC                                            (1000000000ULL)
+#define NSEC_PER_USEC                                           (1000ULL)
+
+/** Sm tunnel of an MBMS session, indexed by the local TEID. */
+typedef struct sm_echo_restart_tunnel_s {
+  nw_gtpv2c_tunnel_handle_t       hTunnel;
+  uint32_t                        mbms_gw_teid;                ///< Sm MBMS-GW GTP-C TEID, from the Start Request
+} sm_echo_restart_tunnel_t;
+
+typedef struct sm_echo_restart_test_s {
+  nw_gtpv2c_stack_handle_t        hStack;
+  int                             sd;
+  uint16_t                        port;
+  uint32_t                        log_level;
+
+  sm_echo_restart_tunnel_t       *tunnels;
+  uint32_t                        next_teid;
+  uint32_t                        nb_tunnels;                  ///< Active
+
+  /** The MBMS-GW, learned from its first datagram. */
+  bool                            peer_known;
+  sm_mce_path_t                   path;
+  sm_mce_path_config_t            path_config;
+
+  /** The single timer the stack keeps running (the earliest of its timers). */
+  bool                            timer_armed;
+  uint64_t                        timer_deadline_ns;
+  void                           *timer_arg;
+
+  uint64_t                        created;
+  uint64_t                        stopped;
+  uint64_t                        updated;
+  uint64_t                        context_not_found;
+  uint64_t                        echo_requests;
+  uint64_t                        echo_responses;
+  uint64_t                        path_failures;
+  uint64_t                        restarts;
+  uint64_t                        purged;                      ///< Tunnels released by the purges
+  uint64_t                        active_at_restart;           ///< Tunnels active when the restarts were detected
+} sm_echo_restart_test_t;
+
+static sm_echo_restart_test_t           test;
+static volatile sig_atomic_t            sm_echo_restart_test_terminate = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t
+sm_echo_restart_test_now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_echo_restart_test_signal_handler (__attribute__((unused)) int sig)
+{
+  sm_echo_restart_test_terminate = 1;
+}
+
+/*------------------------------------------------------------------------------
+                   S T A C K   E N T I T I E S   ( U D P ,   T I M E R ,   L O G )
+  ----------------------------------------------------------------------------*/
+
+static nw_rc_t
+sm_echo_restart_test_udp_data_req (
+  nw_gtpv2c_udp_handle_t udpHandle,
+  uint8_t * dataBuf,
+  uint32_t dataSize,
+  uint16_t localPort,
+  struct sockaddr * peerIp,
+  uint16_t peerPort)
+{
+  struct sockaddr_in                      peer = *(struct sockaddr_in *)peerIp;
+
+  peer.sin_port = htons (peerPort);
+  if (sendto (test.sd, dataBuf, dataSize, 0, (struct sockaddr *)&peer, sizeof (peer)) < 0) {
+    fprintf (stderr, "sendto: %s\n", strerror (errno));
+  }
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_echo_restart_test_timer_start (
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  uint32_t timeoutSec,
+  uint32_t timeoutUsec,
+  uint32_t tmrType,
+  void *tmrArg,
+  nw_gtpv2c_timer_handle_t * tmrHandle)
+{
+  test.timer_armed = true;
+  test.timer_deadline_ns = sm_echo_restart_test_now_ns () + (uint64_t)timeoutSec * NSEC_PER_SEC + (uint64_t)timeoutUsec * NSEC_PER_USEC;
+  test.timer_arg = tmrArg;
+  *tmrHandle = (nw_gtpv2c_timer_handle_t) 1;
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_echo_restart_test_timer_stop (
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  nw_gtpv2c_timer_handle_t tmrHandle)
+{
+  test.timer_armed = false;
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_echo_restart_test_log (
+  nw_gtpv2c_log_mgr_handle_t logMgrHandle,
+  uint32_t logLevel,
+  char *file,
+  uint32_t line,
+  char *logStr)
+{
+  if (logLevel <= test.log_level)
+    fprintf (stderr, "%s:%u %s\n", file, line, logStr);
+  return NW_OK;
+}
+
+/*------------------------------------------------------------------------------
+                        M B M S   S E S S I O N   R E Q U E S T S
+  ----------------------------------------------------------------------------*/
+
+static void
+sm_echo_restart_test_respond (
+  nw_gtpv2c_ulp_api_t * pUlpApi,
+  uint8_t msg_type,
+  uint32_t teid,
+  uint8_t cause,
+  uint32_t mce_teid)
+{
+  nw_gtpv2c_ulp_api_t                     ulp_rsp;
+  struct in_addr                          ipv4 = {.s_addr = htonl (INADDR_LOOPBACK)};
+
+  memset (&ulp_rsp, 0, sizeof (ulp_rsp));
+  ulp_rsp.apiType = NW_GTPV2C_ULP_API_TRIGGERED_RSP;
+  ulp_rsp.u_api_info.triggeredRspInfo.hTrxn = pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
+  nwGtpv2cMsgNew (test.hStack, true, msg_type, teid, 0, &ulp_rsp.hMsg);
+  nwGtpv2cMsgAddIeCause (ulp_rsp.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, cause, 0, 0, 0);
+  if (mce_teid)
+    nwGtpv2cMsgAddIeFteid (ulp_rsp.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, SM_MCE_GTP_C, mce_teid, &ipv4, NULL);
+  if (nwGtpv2cProcessUlpReq (test.hStack, &ulp_rsp) != NW_OK)
+    fprintf (stderr, "Could not send the response of type %u\n", msg_type);
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_echo_restart_test_ie_skip (
+  uint8_t ieType,
+  uint16_t ieLength,
+  uint8_t ieInstance,
+  uint8_t * ieValue,
+  void *arg)
+{
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_echo_restart_test_fteid_ie_get (
+  uint8_t ieType,
+  uint16_t ieLength,
+  uint8_t ieInstance,
+  uint8_t * ieValue,
+  void *arg)
+{
+  if (ieLength < 5)
+    return NW_GTPV2C_IE_INCORRECT;
+  *(uint32_t *)arg = ((uint32_t)ieValue[1] << 24) | ((uint32_t)ieValue[2] << 16) | ((uint32_t)ieValue[3] << 8) | ieValue[4];
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Sm MBMS-GW GTP-C TEID of a Start Request. The stack does not parse the IEs of requests: as in the MCE, a message parser reads it.
+ */
+static nw_rc_t
+sm_echo_restart_test_start_request_parse (nw_gtpv2c_msg_handle_t hMsg, uint32_t * mbms_gw_teid)
+{
+  nw_gtpv2c_msg_parser_t                 *pMsgParser = NULL;
+  uint8_t                                 offending_type = 0, offending_instance = 0;
+  uint16_t                                offending_length = 0;
+  nw_rc_t                                 rc = NW_OK;
+
+  if (nwGtpv2cMsgParserNew (test.hStack, NW_GTP_MBMS_SESSION_START_REQ, sm_echo_restart_test_ie_skip, NULL, &pMsgParser) != NW_OK)
+    return NW_FAILURE;
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
+      sm_echo_restart_test_fteid_ie_get, mbms_gw_teid);
+  rc = nwGtpv2cMsgParserRun (pMsgParser, hMsg, &offending_type, &offending_instance, &offending_length);
+  nwGtpv2cMsgParserDelete (test.hStack, pMsgParser);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * A Start creates the local tunnel of the session, an Update and a Stop need it: otherwise the MBMS-GW refers to a
+ * session the MCE released (Context Not Found).
+ */
+static void
+sm_echo_restart_test_handle_request (nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  const uint8_t                           msg_type = pUlpApi->u_api_info.initialReqIndInfo.msgType;
+  const uint32_t                          teid = nwGtpv2cMsgGetTeid (pUlpApi->hMsg);
+  sm_echo_restart_tunnel_t               *tunnel = (teid && teid < SM_ECHO_RESTART_TEST_MAX_TUNNELS) ? &test.tunnels[teid] : NULL;
+
+  if (msg_type == NW_GTP_MBMS_SESSION_START_REQ) {
+    nw_gtpv2c_ulp_api_t                   ulp_req;
+    uint32_t                              mbms_gw_teid = 0;
+
+    if (sm_echo_restart_test_start_request_parse (pUlpApi->hMsg, &mbms_gw_teid) != NW_OK
+        || test.next_teid >= SM_ECHO_RESTART_TEST_MAX_TUNNELS) {
+      sm_echo_restart_test_respond (pUlpApi, NW_GTP_MBMS_SESSION_START_RSP, mbms_gw_teid, SYSTEM_FAILURE, 0);
+      return;
+    }
+    memset (&ulp_req, 0, sizeof (ulp_req));
+    ulp_req.apiType = NW_GTPV2C_ULP_CREATE_LOCAL_TUNNEL;
+    ulp_req.u_api_info.createLocalTunnelInfo.teidLocal = test.next_teid;
+    ulp_req.u_api_info.createLocalTunnelInfo.peerIp = pUlpApi->u_api_info.initialReqIndInfo.peerIp;
+    if (nwGtpv2cProcessUlpReq (test.hStack, &ulp_req) != NW_OK) {
+      sm_echo_restart_test_respond (pUlpApi, NW_GTP_MBMS_SESSION_START_RSP, mbms_gw_teid, SYSTEM_FAILURE, 0);
+      return;
+    }
+    tunnel = &test.tunnels[test.next_teid];
+    tunnel->hTunnel = ulp_req.u_api_info.createLocalTunnelInfo.hTunnel;
+    tunnel->mbms_gw_teid = mbms_gw_teid;
+    test.nb_tunnels++;
+    test.created++;
+    sm_echo_restart_test_respond (pUlpApi, NW_GTP_MBMS_SESSION_START_RSP, mbms_gw_teid, REQUEST_ACCEPTED, test.next_teid++);
+    return;
+  }
+
+  if (msg_type != NW_GTP_MBMS_SESSION_UPDATE_REQ && msg_type != NW_GTP_MBMS_SESSION_STOP_REQ)
+    return;
+  if (!tunnel || !tunnel->hTunnel) {
+    test.context_not_found++;
+    sm_echo_restart_test_respond (pUlpApi, msg_type + 1, 0, CONTEXT_NOT_FOUND, 0);
+    return;
+  }
+  sm_echo_restart_test_respond (pUlpApi, msg_type + 1, tunnel->mbms_gw_teid, REQUEST_ACCEPTED, 0);
+  if (msg_type == NW_GTP_MBMS_SESSION_STOP_REQ) {
+    nw_gtpv2c_ulp_api_t                   ulp_req;
+
+    memset (&ulp_req, 0, sizeof (ulp_req));
+    ulp_req.apiType = NW_GTPV2C_ULP_DELETE_LOCAL_TUNNEL;
+    ulp_req.u_api_info.deleteLocalTunnelInfo.hTunnel = tunnel->hTunnel;
+    nwGtpv2cProcessUlpReq (test.hStack, &ulp_req);
+    memset (tunnel, 0, sizeof (*tunnel));
+    test.nb_tunnels--;
+    test.stopped++;
+  } else {
+    test.updated++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_echo_restart_test_ulp_req (
+  nw_gtpv2c_ulp_handle_t hUlp,
+  nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  if (pUlpApi->apiType == NW_GTPV2C_ULP_API_INITIAL_REQ_IND)
+    sm_echo_restart_test_handle_request (pUlpApi);
+  if (pUlpApi->hMsg)
+    nwGtpv2cMsgDelete (test.hStack, pUlpApi->hMsg);
+  return NW_OK;
+}
+
+/*------------------------------------------------------------------------------
+                          P A T H   S U P E R V I S I O N
+  ----------------------------------------------------------------------------*/
+
+static void
+sm_echo_restart_test_release_tunnel (void *arg, uint32_t teid_local)
+{
+  if (teid_local < SM_ECHO_RESTART_TEST_MAX_TUNNELS && test.tunnels[teid_local].hTunnel) {
+    memset (&test.tunnels[teid_local], 0, sizeof (sm_echo_restart_tunnel_t));
+    test.nb_tunnels--;
+    test.purged++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_echo_restart_test_path_events (const sm_mce_path_events_t * events, uint32_t active)
+{
+  if (events->echo_request)
+    test.echo_requests++;
+  if (events->echo_request_failed)
+    fprintf (stderr, "Could not send an Echo Request\n");
+  if (events->echo_response)
+    test.echo_responses++;
+  if (events->path_failure) {
+    test.path_failures++;
+    printf ("Sm path to the MBMS-GW down, dropped %u pending transactions\n", events->nb_trxns);
+  }
+  if (events->recovery_learned)
+    printf ("Learned the restart counter %u of the MBMS-GW\n", test.path.recovery);
+  if (events->restart) {
+    printf ("MBMS-GW restarted (restart counter %u -> %u): purged %u transactions and %u of %u tunnels, %u left\n",
+        events->old_recovery, test.path.recovery, events->nb_trxns, events->nb_tunnels, active, test.nb_tunnels);
+    test.restarts++;
+    test.active_at_restart += active;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_echo_restart_test_handle_datagram (uint8_t * buffer, uint32_t length, struct sockaddr_in * peer)
+{
+  sm_mce_path_events_t                    events;
+  const uint32_t                          active = test.nb_tunnels;
+  bool                                    echo_response = false;
+
+  if (!test.peer_known) {
+    test.peer_known = true;
+    sm_mce_path_init (&test.path, (struct sockaddr *)peer);
+  }
+  echo_response = sm_mce_path_receive (&test.path, &test.path_config, test.hStack, buffer, length, ntohs (peer->sin_port),
+      sm_echo_restart_test_now_ns (), sm_echo_restart_test_release_tunnel, NULL, &events);
+  sm_echo_restart_test_path_events (&events, active);
+  if (echo_response || length < NW_GTPV2C_MINIMUM_HEADER_SIZE)
+    return;
+  nwGtpv2cProcessUdpReq (test.hStack, buffer, length, test.port, ntohs (peer->sin_port), (struct sockaddr *)peer);
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Wait for datagrams until the deadline or the stack timer, handle them and the expired stack timer.
+ */
+static void
+sm_echo_restart_test_poll (uint64_t deadline_ns)
+{
+  uint8_t                                 buffer[SM_ECHO_RESTART_TEST_RECV_BUFFER_SIZE];
+  struct pollfd                           pfd = {.fd = test.sd, .events = POLLIN};
+  uint64_t                                now_ns = sm_echo_restart_test_now_ns ();
+  struct timespec                         timeout = {0};
+
+  if (test.timer_armed && test.timer_deadline_ns < deadline_ns)
+    deadline_ns = test.timer_deadline_ns;
+  if (deadline_ns > now_ns) {
+    timeout.tv_sec = (deadline_ns - now_ns) / NSEC_PER_SEC;
+    timeout.tv_nsec = (deadline_ns - now_ns) % NSEC_PER_SEC;
+  }
+  if (ppoll (&pfd, 1, &timeout, NULL) > 0) {
+    struct sockaddr_in                      peer;
+    socklen_t                               peer_len = sizeof (peer);
+    ssize_t                                 len = 0;
+
+    while ((len = recvfrom (test.sd, buffer, sizeof (buffer), 0, (struct sockaddr *)&peer, &peer_len)) > 0) {
+      sm_echo_restart_test_handle_datagram (buffer, len, &peer);
+      peer_len = sizeof (peer);
+    }
+  }
+  if (test.timer_armed && test.timer_deadline_ns <= sm_echo_restart_test_now_ns ()) {
+    test.timer_armed = false;
+    nwGtpv2cProcessTimeout (test.timer_arg);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_echo_restart_test_usage (const char * const name)
+{
+  fprintf (stderr, "Usage: %s [options]\n", name);
+  fprintf (stderr, "  -l address       local Sm address of the MCE (default 127.0.0.1)\n");
+  fprintf (stderr, "  -p port          local Sm port of the MCE (default %d)\n", SM_ECHO_RESTART_TEST_DEFAULT_PORT);
+  fprintf (stderr, "  -t seconds       duration, longer than the one of the MBMS-GW (default %d)\n", SM_ECHO_RESTART_TEST_DEFAULT_DURATION);
+  fprintf (stderr, "  -e seconds       Echo Request interval (default %d)\n", SM_ECHO_RESTART_TEST_DEFAULT_ECHO_INTERVAL);
+  fprintf (stderr, "  -v level         stack log level 0 (emergency) to 7 (debug) (default 3)\n");
+}
+
+//------------------------------------------------------------------------------
+int
+main (int argc, char **argv)
+{
+  const char                             *local_address = "127.0.0.1";
+  uint32_t                                duration = SM_ECHO_RESTART_TEST_DEFAULT_DURATION;
+  uint32_t                                echo_interval = SM_ECHO_RESTART_TEST_DEFAULT_ECHO_INTERVAL;
+  struct sockaddr_in                      local_addr = {0};
+  nw_gtpv2c_ulp_entity_t                  ulp;
+  nw_gtpv2c_udp_entity_t                  udp;
+  nw_gtpv2c_timer_mgr_entity_t            tmr_mgr;
+  nw_gtpv2c_log_mgr_entity_t              log_mgr;
+  uint64_t                                end_ns = 0, now_ns = 0;
+  int                                     errors = 0;
+  int                                     opt = 0;
+
+  test.port = SM_ECHO_RESTART_TEST_DEFAULT_PORT;
+  test.log_level = NW_LOG_LEVEL_ERRO;
+  test.next_teid = 1;
+  while ((opt = getopt (argc, argv, "l:p:t:e:v:h")) != -1) {
+    switch (opt) {
+    case 'l': local_address = optarg; break;
+    case 'p': test.port = (uint16_t)atoi (optarg); break;
+    case 't': duration = atoi (optarg); break;
+    case 'e': echo_interval = atoi (optarg); break;
+    case 'v': test.log_level = atoi (optarg); break;
+    default:
+      sm_echo_restart_test_usage (argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  local_addr.sin_family = AF_INET;
+  local_addr.sin_port = htons (test.port);
+  if (!duration || !echo_interval || inet_pton (AF_INET, local_address, &local_addr.sin_addr) != 1) {
+    sm_echo_restart_test_usage (argv[0]);
+    return 1;
+  }
+  test.path_config.echo_interval_ns = (uint64_t)echo_interval * NSEC_PER_SEC;
+  test.path_config.echo_t3_ns = SM_ECHO_RESTART_TEST_ECHO_T3 * NSEC_PER_SEC;
+  test.path_config.echo_n3 = SM_ECHO_RESTART_TEST_ECHO_N3;
+
+  if ((test.sd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0
+      || bind (test.sd, (struct sockaddr *)&local_addr, sizeof (local_addr)) < 0
+      || fcntl (test.sd, F_SETFL, O_NONBLOCK) < 0) {
+    fprintf (stderr, "Could not open the Sm socket on %s:%u: %s\n", local_address, test.port, strerror (errno));
+    return 1;
+  }
+
+  if (nwGtpv2cInitialize (&test.hStack) != NW_OK) {
+    fprintf (stderr, "Could not create the GTPv2-C stack instance\n");
+    return 1;
+  }
+  ulp.hUlp = (nw_gtpv2c_ulp_handle_t) &test;
+  ulp.ulpReqCallback = sm_echo_restart_test_ulp_req;
+  nwGtpv2cSetUlpEntity (test.hStack, &ulp);
+  udp.hUdp = (nw_gtpv2c_udp_handle_t) &test;
+  udp.gtpv2cStandardPort = test.port;
+  udp.udpDataReqCallback = sm_echo_restart_test_udp_data_req;
+  nwGtpv2cSetUdpEntity (test.hStack, &udp);
+  tmr_mgr.tmrMgrHandle = 0;
+  tmr_mgr.tmrStartCallback = sm_echo_restart_test_timer_start;
+  tmr_mgr.tmrStopCallback = sm_echo_restart_test_timer_stop;
+  nwGtpv2cSetTimerMgrEntity (test.hStack, &tmr_mgr);
+  log_mgr.logMgrHandle = 0;
+  log_mgr.logReqCallback = sm_echo_restart_test_log;
+  nwGtpv2cSetLogMgrEntity (test.hStack, &log_mgr);
+  nwGtpv2cSetLogLevel (test.hStack, test.log_level);
+
+  test.tunnels = calloc (SM_ECHO_RESTART_TEST_MAX_TUNNELS, sizeof (sm_echo_restart_tunnel_t));
+  signal (SIGINT, sm_echo_restart_test_signal_handler);
+  signal (SIGTERM, sm_echo_restart_test_signal_handler);
+  printf ("MCE Sm %s:%u, Echo Requests every %u s, %u s\n", local_address, test.port, echo_interval, duration);
+
+  end_ns = sm_echo_restart_test_now_ns () + (uint64_t)duration * NSEC_PER_SEC;
+  while (!sm_echo_restart_test_terminate && (now_ns = sm_echo_restart_test_now_ns ()) < end_ns) {
+    sm_mce_path_events_t                  events;
+
+    sm_mce_path_supervise (&test.path, &test.path_config, test.hStack, now_ns, &events);
+    sm_echo_restart_test_path_events (&events, test.nb_tunnels);
+    sm_echo_restart_test_poll ((test.peer_known && test.path.echo_due_ns < end_ns) ? test.path.echo_due_ns : end_ns);
+  }
+
+  printf ("Sessions created %" PRIu64 ", updated %" PRIu64 ", stopped %" PRIu64 ", purged %" PRIu64 ", remaining %u, Context Not Found %" PRIu64 "\n",
+      test.created, test.updated, test.stopped, test.purged, test.nb_tunnels, test.context_not_found);
+  printf ("Echo Responses %" PRIu64 "/%" PRIu64 ", restarts %" PRIu64 ", path failures %" PRIu64 "\n",
+      test.echo_responses, test.echo_requests, test.restarts, test.path_failures);
+  if (!test.restarts) {
+    printf ("FAILED: no restart of the MBMS-GW detected\n");
+    errors++;
+  }
+  if (test.purged != test.active_at_restart) {
+    printf ("FAILED: %" PRIu64 " tunnels purged, %" PRIu64 " were active at the restarts\n", test.purged, test.active_at_restart);
+    errors++;
+  }
+  if (test.context_not_found) {
+    printf ("FAILED: %" PRIu64 " requests for released sessions (Context Not Found)\n", test.context_not_found);
+    errors++;
+  }
+  if (test.nb_tunnels) {
+    printf ("FAILED: %u tunnels left\n", test.nb_tunnels);
+    errors++;
+  }
+
+  nwGtpv2cFinalize (test.hStack);
+  close (test.sd);
+  free (test.tunnels);
+  return errors ? 1 : 0;
+}
@@ -20,6 +20,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
@@ -63,6 +64,11 @@ sm_tmgi_ie_get (
 
   DevAssert (tmgi);
 
+  if (ieLength < 6) {
+    OAILOG_ERROR (LOG_SM, "Bad TMGI IE length %"PRIu16"\n", ieLength);
+    return NW_GTPV2C_IE_INCORRECT;
+  }
+
   /** Set the MBMS Service ID. */
   DECODE_U24(ieValue, tmgi->mbms_service_id, decoded);
   ieValue+=decoded;
@@ -90,8 +96,14 @@ sm_mbms_session_duration_ie_get (
 {
   DevAssert (arg );
   mbms_session_duration_t * msd = (mbms_session_duration_t *) arg;
-  msd->seconds = (ieValue[0] << 17) + (ieValue[1] << 9) + (ieValue[2] & 0x80);
-  msd->days = (ieValue[3] & 0x7F);
+
+  if (ieLength < 3) {
+    OAILOG_ERROR (LOG_SM, "Bad MBMS Session Duration IE length %"PRIu16"\n", ieLength);
+    return NW_GTPV2C_IE_INCORRECT;
+  }
+  /** 17 bits of seconds and 7 bits of days in 3 octets (TS 29.274 8.69). */
+  msd->seconds = (ieValue[0] << 9) + (ieValue[1] << 1) + ((ieValue[2] & 0x80) >> 7);
+  msd->days = (ieValue[2] & 0x7F);
   ieValue+=3;
   return NW_OK;
 }
@@ -108,12 +120,17 @@ sm_mbms_service_area_ie_get (
 
   DevAssert (mbms_service_area);
 
+  if (ieLength < 1 || ieLength < 1 + 2 * ieValue[0]) {
+    OAILOG_ERROR (LOG_SM, "Bad MBMS Service Area IE length %"PRIu16"\n", ieLength);
+    return NW_GTPV2C_IE_INCORRECT;
+  }
   mbms_service_area->num_service_area = *ieValue;
   ieValue++;
   int decoded = 0;
   while (decoded < mbms_service_area->num_service_area){
-	  mbms_service_area->serviceArea[decoded] = *(uint16_t*)ieValue;
+	  memcpy(&mbms_service_area->serviceArea[decoded], ieValue, sizeof(uint16_t));
 	  ieValue+=2;
+	  decoded++;
   }
 
   return NW_OK;
@@ -130,7 +147,11 @@ sm_mbms_flow_identifier_ie_get (
   uint16_t                                *flow_id = (uint16_t *) arg;
 
   DevAssert (flow_id);
-  *flow_id = *(uint16_t*)ieValue;
+  if (ieLength < 2) {
+    OAILOG_ERROR (LOG_SM, "Bad MBMS Flow Identifier IE length %"PRIu16"\n", ieLength);
+    return NW_GTPV2C_IE_INCORRECT;
+  }
+  memcpy(flow_id, ieValue, sizeof(uint16_t));
   ieValue+=2;
   OAILOG_DEBUG (LOG_SM, "\t- Flow-ID %d\n", *flow_id);
   return NW_OK;
@@ -145,8 +166,15 @@ sm_mbms_ip_multicast_distribution_ie_get (
   void *arg)
 {
   mbms_ip_multicast_distribution_t           *mbms_ip_mc_addr = (mbms_ip_multicast_distribution_t *) arg;
+  uint8_t                                    *ieEnd = ieValue + ieLength;
   DevAssert (mbms_ip_mc_addr );
 
+  /** CTEID, both address types and the HC indication. */
+  if (ieLength < 4 + 1 + 1 + 1) {
+    OAILOG_ERROR (LOG_SM, "Bad MBMS IP Multicast Distribution IE length %"PRIu16"\n", ieLength);
+    return NW_GTPV2C_IE_INCORRECT;
+  }
+
   /*
    * Copy the CTEID
    */
@@ -160,6 +188,11 @@ sm_mbms_ip_multicast_distribution_ie_get (
   int da_type = (*ieValue & 0xC0) >> 6;
   int da_length = (*ieValue & 0x3F);
   ieValue++;
+  /** Address, source address type and length, HC indication. */
+  if (ieValue + (da_type == 0 ? 4 : da_length) + 2 > ieEnd) {
+    OAILOG_ERROR (LOG_SM, "\t- Received truncated IP Multicast distribution addr. \n");
+    return NW_GTPV2C_IE_INCORRECT;
+  }
 
   if (da_type == 0) {
     /*
@@ -200,6 +233,10 @@ sm_mbms_ip_multicast_distribution_ie_get (
   int sa_type = (*ieValue & 0xC0) >> 6;
   int sa_length = (*ieValue & 0x3F);
   ieValue++;
+  if (ieValue + (sa_type == 0 ? 4 : sa_length) + 1 > ieEnd) {
+    OAILOG_ERROR (LOG_SM, "\t- Received truncated IP Multicast source addr. \n");
+    return NW_GTPV2C_IE_INCORRECT;
+  }
 
   if (sa_type == 0) {
     /*
@@ -252,6 +289,10 @@ nw_rc_t sm_mbms_data_transfer_start_ie_get (
   uint8_t		b_useconds[4];
   DevAssert (abs_time);
 
+  if (ieLength < 8) {
+    OAILOG_ERROR (LOG_SM, "Bad MBMS Absolute Time IE length %"PRIu16"\n", ieLength);
+    return NW_GTPV2C_IE_INCORRECT;
+  }
   memcpy((void*)b_seconds, ieValue, 4);
   memcpy((void*)b_useconds, ieValue+4, 4);
 
@@ -0,0 +1,1029 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_mbms_gw_loadgen.c
+* \brief Local MBMS-GW stand-in, generating MBMS session requests towards the Sm interface of an MCE.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+* A single nwgtpv2c stack instance acts as MBMS-GW: it sends MBMS Session Start, Update and Stop Requests at a given
+* rate and mix, for a set of MBMS sessions (one TMGI, flow and Sm tunnel each), with randomly drawn SAIs, QCIs,
+* bitrates and durations. A session has at most one request outstanding: Start on an idle session, Update and Stop on
+* an active one. T3 and N3 of the requests are handled by the stack (retransmissions and timeouts).
+* The responses are validated (message type, TEID, cause and, for Start, the Sm MCE F-TEID). The latency of each
+* request (until the response, retransmissions included), the timeouts and the retransmissions are reported per
+* message type, with the latency percentiles of the run. The remaining active sessions are stopped at the end.
+* The stack answers the Echo Requests of the MCE with its restart counter. A restart of the MBMS-GW can be simulated
+* during the run: the restart counter is incremented, the active sessions are lost and an Echo Request tells the MCE,
+* which is expected to release their MBMS services at once.
+*/
+
+#define _GNU_SOURCE             // required for ppoll()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "common_defs.h"
+#include "3gpp_29.274.h"
+
+#include "NwTypes.h"
+#include "NwLog.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+
+#define SM_MBMS_GW_LOADGEN_DEFAULT_PORT                         (2123)
+#define SM_MBMS_GW_LOADGEN_DEFAULT_SESSIONS                     (256)
+#define SM_MBMS_GW_LOADGEN_DEFAULT_RATE                         (100)
+#define SM_MBMS_GW_LOADGEN_DEFAULT_DURATION                     (10)
+#define SM_MBMS_GW_LOADGEN_DEFAULT_INTERVAL                     (1)
+#define SM_MBMS_GW_LOADGEN_MAX_SESSIONS                         (1 << 20)
+#define SM_MBMS_GW_LOADGEN_MAX_SAIS                             (64)
+#define SM_MBMS_GW_LOADGEN_MAX_QCIS                             (16)
+#define SM_MBMS_GW_LOADGEN_RECV_BUFFER_SIZE                     (4096)
+
+/** Latency histogram in microseconds: exact below 32 us, then 16 buckets per power of two (resolution 6%). */
+#define SM_MBMS_GW_LOADGEN_HIST_SUB_BITS                        (4)
+#define SM_MBMS_GW_LOADGEN_HIST_BUCKETS                         (48 << SM_MBMS_GW_LOADGEN_HIST_SUB_BITS)
+
+#define NSEC_PER_SEC                                            (1000000000ULL)
+#define NSEC_PER_USEC                                           (1000ULL)
+
+typedef enum {
+  SM_MBMS_GW_LOADGEN_START = 0,
+  SM_MBMS_GW_LOADGEN_UPDATE,
+  SM_MBMS_GW_LOADGEN_STOP,
+  SM_MBMS_GW_LOADGEN_PROCEDURES
+} sm_mbms_gw_loadgen_procedure_t;
+
+static const char * const sm_mbms_gw_loadgen_procedure_str[SM_MBMS_GW_LOADGEN_PROCEDURES] = {"Start", "Update", "Stop"};
+static const uint8_t sm_mbms_gw_loadgen_req_type[SM_MBMS_GW_LOADGEN_PROCEDURES] = {
+  NW_GTP_MBMS_SESSION_START_REQ, NW_GTP_MBMS_SESSION_UPDATE_REQ, NW_GTP_MBMS_SESSION_STOP_REQ};
+
+typedef enum {
+  SM_MBMS_GW_SESSION_IDLE = 0,
+  SM_MBMS_GW_SESSION_ACTIVE,
+  SM_MBMS_GW_SESSION_PENDING,                                  ///< Request outstanding
+} sm_mbms_gw_session_state_t;
+
+/** An MBMS session of the MBMS-GW: one TMGI, flow and Sm tunnel. */
+typedef struct sm_mbms_gw_session_s {
+  uint32_t                        index;
+  sm_mbms_gw_session_state_t      state;
+  sm_mbms_gw_loadgen_procedure_t  procedure;                   ///< Of the outstanding request
+  uint32_t                        list_pos;                    ///< Position in the idle or active list
+  uint32_t                        local_teid;                  ///< Sm MBMS-GW GTP-C TEID
+  uint32_t                        mce_teid;                    ///< Sm MCE GTP-C TEID, from the Start Response
+  nw_gtpv2c_tunnel_handle_t       hTunnel;
+  uint64_t                        sent_ns;
+} sm_mbms_gw_session_t;
+
+typedef struct sm_mbms_gw_loadgen_stats_s {
+  uint64_t  sent;                                              ///< Requests
+  uint64_t  transmitted;                                       ///< Datagrams, retransmissions included
+  uint64_t  accepted;
+  uint64_t  rejected;                                          ///< Valid responses with a cause other than Request Accepted
+  uint64_t  invalid;                                           ///< Responses failing the validation
+  uint64_t  timeouts;                                          ///< No response after N3 retransmissions
+  uint64_t  latency_sum_us;
+  uint64_t  latency_max_us;
+  uint64_t  hist[SM_MBMS_GW_LOADGEN_HIST_BUCKETS];
+} sm_mbms_gw_loadgen_stats_t;
+
+/** A list of session indexes, with O(1) random removal. */
+typedef struct sm_mbms_gw_session_list_s {
+  uint32_t *index;
+  uint32_t  size;
+} sm_mbms_gw_session_list_t;
+
+typedef struct sm_mbms_gw_loadgen_s {
+  nw_gtpv2c_stack_handle_t        hStack;
+  int                             sd;
+  struct sockaddr_in              local_addr;
+  struct sockaddr_in              mce_addr;
+  uint32_t                        log_level;
+
+  /** Traffic model. */
+  double                          rate;
+  uint32_t                        mix[SM_MBMS_GW_LOADGEN_PROCEDURES];
+  uint32_t                        tmgi_base;
+  uint16_t                        sai_first;
+  uint16_t                        sai_last;
+  uint32_t                        sais_max;
+  uint8_t                         qcis[SM_MBMS_GW_LOADGEN_MAX_QCIS];
+  uint32_t                        nb_qcis;
+  uint64_t                        bitrate_min;                 ///< kbps
+  uint64_t                        bitrate_max;
+  uint32_t                        duration_min;                ///< seconds
+  uint32_t                        duration_max;
+  uint16_t                        t3;
+  uint16_t                        n3;
+
+  /** Simulated restart of the MBMS-GW. */
+  uint32_t                        restart_after;               ///< seconds, 0 for no restart
+  uint8_t                         restart_counter;
+  uint64_t                        restart_ns;                  ///< Requests sent before are lost
+  uint32_t                        lost;                        ///< Active sessions lost by the restart
+
+  sm_mbms_gw_session_t           *sessions;
+  uint32_t                        nb_sessions;
+  sm_mbms_gw_session_list_t       idle;
+  sm_mbms_gw_session_list_t       active;
+  uint32_t                        pending;
+  uint32_t                        seed;
+
+  /** The single timer the stack keeps running (the earliest of its timers). */
+  bool                            timer_armed;
+  uint64_t                        timer_deadline_ns;
+  void                           *timer_arg;
+
+  sm_mbms_gw_loadgen_stats_t      stats[SM_MBMS_GW_LOADGEN_PROCEDURES];
+  uint64_t                        causes[256];
+  uint64_t                        unmatched;                   ///< Datagrams of other types
+} sm_mbms_gw_loadgen_t;
+
+static sm_mbms_gw_loadgen_t             loadgen;
+static volatile sig_atomic_t            sm_mbms_gw_loadgen_terminate = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t
+sm_mbms_gw_loadgen_now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_signal_handler (__attribute__((unused)) int sig)
+{
+  sm_mbms_gw_loadgen_terminate = 1;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t
+sm_mbms_gw_loadgen_random (uint32_t range)
+{
+  /** xorshift32, reproducible with the seed. */
+  loadgen.seed ^= loadgen.seed << 13;
+  loadgen.seed ^= loadgen.seed >> 17;
+  loadgen.seed ^= loadgen.seed << 5;
+  return range ? loadgen.seed % range : 0;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t
+sm_mbms_gw_loadgen_random_between (uint64_t min, uint64_t max)
+{
+  return min + sm_mbms_gw_loadgen_random ((uint32_t)(max - min + 1));
+}
+
+/*------------------------------------------------------------------------------
+                        L A T E N C Y   H I S T O G R A M
+  ----------------------------------------------------------------------------*/
+
+static uint32_t
+sm_mbms_gw_loadgen_hist_index (uint64_t us)
+{
+  uint32_t                                msb = 0;
+  uint32_t                                shift = 0;
+  uint32_t                                index = 0;
+
+  if (us < (2 << SM_MBMS_GW_LOADGEN_HIST_SUB_BITS))
+    return (uint32_t)us;
+  msb = 63 - __builtin_clzll (us);
+  shift = msb - SM_MBMS_GW_LOADGEN_HIST_SUB_BITS;
+  index = (shift << SM_MBMS_GW_LOADGEN_HIST_SUB_BITS) + (uint32_t)(us >> shift);
+  return (index < SM_MBMS_GW_LOADGEN_HIST_BUCKETS) ? index : SM_MBMS_GW_LOADGEN_HIST_BUCKETS - 1;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t
+sm_mbms_gw_loadgen_hist_value (uint32_t index)
+{
+  uint32_t                                shift = 0;
+
+  if (index < (2 << SM_MBMS_GW_LOADGEN_HIST_SUB_BITS))
+    return index;
+  shift = (index >> SM_MBMS_GW_LOADGEN_HIST_SUB_BITS) - 1;
+  return (uint64_t)((index & ((1 << SM_MBMS_GW_LOADGEN_HIST_SUB_BITS) - 1)) | (1 << SM_MBMS_GW_LOADGEN_HIST_SUB_BITS)) << shift;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t
+sm_mbms_gw_loadgen_hist_percentile (const sm_mbms_gw_loadgen_stats_t * stats, double percentile)
+{
+  uint64_t                                count = 0;
+  uint64_t                                total = 0;
+  uint64_t                                rank = 0;
+
+  for (uint32_t i = 0; i < SM_MBMS_GW_LOADGEN_HIST_BUCKETS; i++)
+    total += stats->hist[i];
+  if (!total)
+    return 0;
+  rank = (uint64_t)(percentile / 100.0 * total);
+  if (rank >= total)
+    rank = total - 1;
+  for (uint32_t i = 0; i < SM_MBMS_GW_LOADGEN_HIST_BUCKETS; i++) {
+    count += stats->hist[i];
+    if (count > rank)
+      return sm_mbms_gw_loadgen_hist_value (i);
+  }
+  return stats->latency_max_us;
+}
+
+/*------------------------------------------------------------------------------
+                            S E S S I O N   L I S T S
+  ----------------------------------------------------------------------------*/
+
+static void
+sm_mbms_gw_loadgen_list_add (sm_mbms_gw_session_list_t * list, sm_mbms_gw_session_t * session)
+{
+  session->list_pos = list->size;
+  list->index[list->size++] = session->index;
+}
+
+//------------------------------------------------------------------------------
+static sm_mbms_gw_session_t *
+sm_mbms_gw_loadgen_list_take (sm_mbms_gw_session_list_t * list)
+{
+  uint32_t                                pos = 0;
+  sm_mbms_gw_session_t                   *session = NULL;
+
+  if (!list->size)
+    return NULL;
+  pos = sm_mbms_gw_loadgen_random (list->size);
+  session = &loadgen.sessions[list->index[pos]];
+  list->index[pos] = list->index[--list->size];
+  loadgen.sessions[list->index[pos]].list_pos = pos;
+  return session;
+}
+
+/*------------------------------------------------------------------------------
+                   S T A C K   E N T I T I E S   ( U D P ,   T I M E R ,   L O G )
+  ----------------------------------------------------------------------------*/
+
+static nw_rc_t
+sm_mbms_gw_loadgen_udp_data_req (
+  nw_gtpv2c_udp_handle_t udpHandle,
+  uint8_t * dataBuf,
+  uint32_t dataSize,
+  uint16_t localPort,
+  struct sockaddr * peerIp,
+  uint16_t peerPort)
+{
+  struct sockaddr_in                      peer = loadgen.mce_addr;
+
+  /** Initial requests go to the standard port, the MCE may listen on another one. */
+  if (peerIp->sa_family == AF_INET)
+    peer.sin_addr = ((struct sockaddr_in *)peerIp)->sin_addr;
+  for (int p = 0; p < SM_MBMS_GW_LOADGEN_PROCEDURES; p++) {
+    if (dataSize > 1 && dataBuf[1] == sm_mbms_gw_loadgen_req_type[p])
+      loadgen.stats[p].transmitted++;
+  }
+  if (sendto (loadgen.sd, dataBuf, dataSize, 0, (struct sockaddr *)&peer, sizeof (peer)) < 0) {
+    fprintf (stderr, "sendto: %s\n", strerror (errno));
+    /** Lost, as on the wire: T3 retransmits. */
+  }
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_mbms_gw_loadgen_timer_start (
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  uint32_t timeoutSec,
+  uint32_t timeoutUsec,
+  uint32_t tmrType,
+  void *tmrArg,
+  nw_gtpv2c_timer_handle_t * tmrHandle)
+{
+  loadgen.timer_armed = true;
+  loadgen.timer_deadline_ns = sm_mbms_gw_loadgen_now_ns () + (uint64_t)timeoutSec * NSEC_PER_SEC + (uint64_t)timeoutUsec * NSEC_PER_USEC;
+  loadgen.timer_arg = tmrArg;
+  *tmrHandle = (nw_gtpv2c_timer_handle_t) 1;
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_mbms_gw_loadgen_timer_stop (
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  nw_gtpv2c_timer_handle_t tmrHandle)
+{
+  loadgen.timer_armed = false;
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_mbms_gw_loadgen_log (
+  nw_gtpv2c_log_mgr_handle_t logMgrHandle,
+  uint32_t logLevel,
+  char *file,
+  uint32_t line,
+  char *logStr)
+{
+  if (logLevel <= loadgen.log_level)
+    fprintf (stderr, "%s:%u %s\n", file, line, logStr);
+  return NW_OK;
+}
+
+/*------------------------------------------------------------------------------
+                                R E Q U E S T S
+  ----------------------------------------------------------------------------*/
+
+static void
+sm_mbms_gw_loadgen_add_session_ies (
+  nw_gtpv2c_msg_handle_t hMsg,
+  sm_mbms_gw_session_t * session,
+  bool flow_id)
+{
+  uint8_t                                 service_area[1 + 2 * SM_MBMS_GW_LOADGEN_MAX_SAIS];
+  uint8_t                                 qos[22] = {0};
+  uint8_t                                 duration[3];
+  uint8_t                                 tmgi[6];
+  uint8_t                                 flow[2];
+  uint32_t                                nb_sais = sm_mbms_gw_loadgen_random_between (1, loadgen.sais_max);
+  uint64_t                                bitrate = sm_mbms_gw_loadgen_random_between (loadgen.bitrate_min, loadgen.bitrate_max);
+  uint32_t                                seconds = sm_mbms_gw_loadgen_random_between (loadgen.duration_min, loadgen.duration_max);
+  uint32_t                                service_id = loadgen.tmgi_base + session->index;
+
+  /** TMGI: MBMS Service ID and PLMN 208/93. */
+  tmgi[0] = service_id >> 16; tmgi[1] = service_id >> 8; tmgi[2] = service_id;
+  tmgi[3] = 0x02; tmgi[4] = 0xf8; tmgi[5] = 0x39;
+  nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_TMGI, sizeof (tmgi), NW_GTPV2C_IE_INSTANCE_ZERO, tmgi);
+  /** 17 bits of seconds and 7 bits of days (TS 29.274 8.69). */
+  duration[0] = seconds >> 9; duration[1] = seconds >> 1; duration[2] = (seconds & 1) << 7;
+  nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_MBMS_SESSION_DURATION, sizeof (duration), NW_GTPV2C_IE_INSTANCE_ZERO, duration);
+  /** Service area: number of SAIs, then the SAIs, distinct per request only by chance. */
+  service_area[0] = nb_sais;
+  for (uint32_t i = 0; i < nb_sais; i++) {
+    uint16_t                                sai = sm_mbms_gw_loadgen_random_between (loadgen.sai_first, loadgen.sai_last);
+
+    service_area[1 + 2 * i] = sai >> 8;
+    service_area[2 + 2 * i] = sai;
+  }
+  nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_MBMS_SERVICE_AREA, 1 + 2 * nb_sais, NW_GTPV2C_IE_INSTANCE_ZERO, service_area);
+  if (flow_id) {
+    flow[0] = session->index >> 8; flow[1] = session->index;
+    nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, sizeof (flow), NW_GTPV2C_IE_INSTANCE_ZERO, flow);
+  }
+  /** Bearer level QoS: ARP, QCI, MBR and GBR (UL, DL) in kbps on 5 octets, downlink only. */
+  qos[0] = 0x04 << 2;
+  qos[1] = loadgen.qcis[sm_mbms_gw_loadgen_random (loadgen.nb_qcis)];
+  for (int i = 0; i < 5; i++) {
+    qos[7 + i] = bitrate >> (8 * (4 - i));                     /**< MBR downlink */
+    qos[17 + i] = bitrate >> (8 * (4 - i));                    /**< GBR downlink */
+  }
+  nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_BEARER_LEVEL_QOS, sizeof (qos), NW_GTPV2C_IE_INSTANCE_ZERO, qos);
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_add_ip_mc_distribution (
+  nw_gtpv2c_msg_handle_t hMsg,
+  sm_mbms_gw_session_t * session)
+{
+  /** Common TEID, IPv4 distribution address 232.x.y.z and source address 10.0.0.1, no header compression. */
+  const uint32_t                          cteid = session->local_teid;
+  const uint8_t                           ip_mc[15] = {cteid >> 24, cteid >> 16, cteid >> 8, cteid,
+                                                       4, 232, session->index >> 16, session->index >> 8, session->index,
+                                                       4, 10, 0, 0, 1, 0};
+
+  nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_MBMS_IP_MULTICAST_DISTRIBUTION, sizeof (ip_mc), NW_GTPV2C_IE_INSTANCE_ZERO, (uint8_t *)ip_mc);
+}
+
+//------------------------------------------------------------------------------
+static bool
+sm_mbms_gw_loadgen_send (
+  sm_mbms_gw_session_t * session,
+  sm_mbms_gw_loadgen_procedure_t procedure)
+{
+  nw_gtpv2c_ulp_api_t                     ulp_req;
+  nw_rc_t                                 rc = NW_OK;
+
+  memset (&ulp_req, 0, sizeof (ulp_req));
+  ulp_req.apiType = NW_GTPV2C_ULP_API_INITIAL_REQ;
+  /** The Start Request carries the MBMS-GW F-TEID, the others are sent to the TEID of the MCE. */
+  rc = nwGtpv2cMsgNew (loadgen.hStack, true, sm_mbms_gw_loadgen_req_type[procedure],
+      procedure == SM_MBMS_GW_LOADGEN_START ? 0 : session->mce_teid, 0, &ulp_req.hMsg);
+  if (rc != NW_OK)
+    return false;
+  switch (procedure) {
+  case SM_MBMS_GW_LOADGEN_START:
+    nwGtpv2cMsgAddIeFteid (ulp_req.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, SM_MBMS_GW_GTP_C, session->local_teid,
+        &loadgen.local_addr.sin_addr, NULL);
+    sm_mbms_gw_loadgen_add_session_ies (ulp_req.hMsg, session, true);
+    sm_mbms_gw_loadgen_add_ip_mc_distribution (ulp_req.hMsg, session);
+    break;
+  case SM_MBMS_GW_LOADGEN_UPDATE:
+    sm_mbms_gw_loadgen_add_session_ies (ulp_req.hMsg, session, true);
+    break;
+  default: {
+      const uint8_t                         flow[2] = {session->index >> 8, session->index};
+
+      nwGtpv2cMsgAddIe (ulp_req.hMsg, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, sizeof (flow), NW_GTPV2C_IE_INSTANCE_ZERO, (uint8_t *)flow);
+    }
+    break;
+  }
+  ulp_req.u_api_info.initialReqInfo.hTunnel = session->hTunnel;
+  ulp_req.u_api_info.initialReqInfo.hUlpTrxn = (nw_gtpv2c_ulp_trxn_handle_t) session->index + 1;
+  ulp_req.u_api_info.initialReqInfo.hUlpTunnel = (nw_gtpv2c_ulp_tunnel_handle_t) session->index + 1;
+  ulp_req.u_api_info.initialReqInfo.teidLocal = session->local_teid;
+  ulp_req.u_api_info.initialReqInfo.edns_peer_ip = (struct sockaddr *)&loadgen.mce_addr;
+  ulp_req.u_api_info.initialReqInfo.t3Timer = loadgen.t3;
+  ulp_req.u_api_info.initialReqInfo.maxRetries = loadgen.n3;
+  session->procedure = procedure;
+  session->state = SM_MBMS_GW_SESSION_PENDING;
+  session->sent_ns = sm_mbms_gw_loadgen_now_ns ();
+  rc = nwGtpv2cProcessUlpReq (loadgen.hStack, &ulp_req);
+  if (rc != NW_OK) {
+    nwGtpv2cMsgDelete (loadgen.hStack, ulp_req.hMsg);
+    return false;
+  }
+  /** The tunnel of the session is created by the first request. */
+  session->hTunnel = ulp_req.u_api_info.initialReqInfo.hTunnel;
+  loadgen.stats[procedure].sent++;
+  loadgen.pending++;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_delete_tunnel (sm_mbms_gw_session_t * session)
+{
+  nw_gtpv2c_ulp_api_t                     ulp_req;
+
+  if (!session->hTunnel)
+    return;
+  memset (&ulp_req, 0, sizeof (ulp_req));
+  ulp_req.apiType = NW_GTPV2C_ULP_DELETE_LOCAL_TUNNEL;
+  ulp_req.u_api_info.deleteLocalTunnelInfo.hTunnel = session->hTunnel;
+  nwGtpv2cProcessUlpReq (loadgen.hStack, &ulp_req);
+  session->hTunnel = 0;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_session_done (
+  sm_mbms_gw_session_t * session,
+  bool active)
+{
+  loadgen.pending--;
+  if (active) {
+    session->state = SM_MBMS_GW_SESSION_ACTIVE;
+    sm_mbms_gw_loadgen_list_add (&loadgen.active, session);
+  } else {
+    sm_mbms_gw_loadgen_delete_tunnel (session);
+    session->mce_teid = 0;
+    session->state = SM_MBMS_GW_SESSION_IDLE;
+    sm_mbms_gw_loadgen_list_add (&loadgen.idle, session);
+  }
+}
+
+/**
+ * Restart of the MBMS-GW: the active sessions are lost, the outstanding requests are lost once answered. The Echo
+ * Request with the new restart counter reaches the MCE before any request sent after the restart.
+ */
+static void
+sm_mbms_gw_loadgen_restart (void)
+{
+  sm_mbms_gw_session_t                   *session = NULL;
+  uint32_t                                seq = 0;
+
+  loadgen.restart_counter++;
+  loadgen.restart_ns = sm_mbms_gw_loadgen_now_ns ();
+  nwGtpv2cSetRestartCounter (loadgen.hStack, loadgen.restart_counter);
+  while ((session = sm_mbms_gw_loadgen_list_take (&loadgen.active))) {
+    sm_mbms_gw_loadgen_delete_tunnel (session);
+    session->mce_teid = 0;
+    session->state = SM_MBMS_GW_SESSION_IDLE;
+    sm_mbms_gw_loadgen_list_add (&loadgen.idle, session);
+    loadgen.lost++;
+  }
+  if (nwGtpv2cSendEchoReq (loadgen.hStack, (struct sockaddr *)&loadgen.mce_addr, ntohs (loadgen.mce_addr.sin_port), false, &seq) != NW_OK)
+    fprintf (stderr, "Could not send the Echo Request of the restart\n");
+  printf ("Restarted the MBMS-GW with restart counter %u, %u active sessions lost, %u requests outstanding\n",
+      loadgen.restart_counter, loadgen.lost, loadgen.pending);
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Send the next request of the mix. If no session is in the state the drawn procedure needs (idle for Start, active
+ * for Update and Stop), another procedure is used. Returns false if all sessions have a request outstanding.
+ */
+static bool
+sm_mbms_gw_loadgen_send_next (void)
+{
+  const uint32_t                          total = loadgen.mix[0] + loadgen.mix[1] + loadgen.mix[2];
+  uint32_t                                draw = sm_mbms_gw_loadgen_random (total);
+  sm_mbms_gw_loadgen_procedure_t          procedure = SM_MBMS_GW_LOADGEN_START;
+  sm_mbms_gw_session_t                   *session = NULL;
+
+  while (procedure < SM_MBMS_GW_LOADGEN_STOP && draw >= loadgen.mix[procedure])
+    draw -= loadgen.mix[procedure++];
+  if (procedure != SM_MBMS_GW_LOADGEN_START && !loadgen.active.size)
+    procedure = SM_MBMS_GW_LOADGEN_START;
+  else if (procedure == SM_MBMS_GW_LOADGEN_START && !loadgen.idle.size)
+    procedure = (loadgen.mix[SM_MBMS_GW_LOADGEN_UPDATE] >= loadgen.mix[SM_MBMS_GW_LOADGEN_STOP]) ?
+        SM_MBMS_GW_LOADGEN_UPDATE : SM_MBMS_GW_LOADGEN_STOP;
+  session = sm_mbms_gw_loadgen_list_take (procedure == SM_MBMS_GW_LOADGEN_START ? &loadgen.idle : &loadgen.active);
+  if (!session)
+    return false;
+  if (!sm_mbms_gw_loadgen_send (session, procedure)) {
+    sm_mbms_gw_loadgen_list_add (procedure == SM_MBMS_GW_LOADGEN_START ? &loadgen.idle : &loadgen.active, session);
+    session->state = (procedure == SM_MBMS_GW_LOADGEN_START) ? SM_MBMS_GW_SESSION_IDLE : SM_MBMS_GW_SESSION_ACTIVE;
+    return false;
+  }
+  return true;
+}
+
+/*------------------------------------------------------------------------------
+                               R E S P O N S E S
+  ----------------------------------------------------------------------------*/
+
+/**
+ * Validate a response of the MCE. Returns the cause, 0 if the response is invalid.
+ */
+static uint8_t
+sm_mbms_gw_loadgen_validate (
+  sm_mbms_gw_session_t * session,
+  nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  nw_gtpv2c_msg_handle_t                  hMsg = pUlpApi->hMsg;
+  uint8_t                                 cause = 0;
+  uint8_t                                 flags = 0;
+  uint8_t                                 offending_type = 0;
+  uint8_t                                 offending_instance = 0;
+  uint8_t                                 if_type = 0;
+  uint32_t                                teid = 0;
+  struct in_addr                          ipv4 = {0};
+  struct in6_addr                         ipv6;
+
+  if (pUlpApi->u_api_info.triggeredRspIndInfo.error.cause != NW_GTPV2C_CAUSE_REQUEST_ACCEPTED
+      || pUlpApi->u_api_info.triggeredRspIndInfo.msgType != sm_mbms_gw_loadgen_req_type[session->procedure] + 1
+      || nwGtpv2cMsgGetTeid (hMsg) != session->local_teid
+      || nwGtpv2cMsgGetIeCause (hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, &cause, &flags, &offending_type, &offending_instance) != NW_OK
+      || !cause)
+    return 0;
+  if (session->procedure == SM_MBMS_GW_LOADGEN_START && cause == REQUEST_ACCEPTED) {
+    if (nwGtpv2cMsgGetIeFteid (hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, &if_type, &teid, &ipv4, &ipv6) != NW_OK
+        || if_type != SM_MCE_GTP_C || !teid)
+      return 0;
+    session->mce_teid = teid;
+  }
+  return cause;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_handle_response (nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  const uint64_t                          index = pUlpApi->u_api_info.triggeredRspIndInfo.hUlpTrxn;
+  sm_mbms_gw_session_t                   *session = NULL;
+  sm_mbms_gw_loadgen_stats_t             *stats = NULL;
+  uint64_t                                latency_us = 0;
+  uint8_t                                 cause = 0;
+
+  if (!index || index > loadgen.nb_sessions || loadgen.sessions[index - 1].state != SM_MBMS_GW_SESSION_PENDING) {
+    loadgen.unmatched++;
+    return;
+  }
+  session = &loadgen.sessions[index - 1];
+  stats = &loadgen.stats[session->procedure];
+  latency_us = (sm_mbms_gw_loadgen_now_ns () - session->sent_ns) / NSEC_PER_USEC;
+  stats->latency_sum_us += latency_us;
+  if (latency_us > stats->latency_max_us)
+    stats->latency_max_us = latency_us;
+  stats->hist[sm_mbms_gw_loadgen_hist_index (latency_us)]++;
+
+  cause = sm_mbms_gw_loadgen_validate (session, pUlpApi);
+  if (!cause) {
+    stats->invalid++;
+  } else if (cause == REQUEST_ACCEPTED) {
+    stats->accepted++;
+  } else {
+    stats->rejected++;
+    loadgen.causes[cause]++;
+  }
+  /**
+   * A Start makes the session active, a Stop idle. A failed Update leaves it active, a failed Start idle. A session
+   * whose request was sent before a restart is lost.
+   */
+  switch (session->procedure) {
+  case SM_MBMS_GW_LOADGEN_START:
+    sm_mbms_gw_loadgen_session_done (session, cause == REQUEST_ACCEPTED && session->sent_ns >= loadgen.restart_ns);
+    break;
+  case SM_MBMS_GW_LOADGEN_UPDATE:
+    sm_mbms_gw_loadgen_session_done (session, session->sent_ns >= loadgen.restart_ns);
+    break;
+  default:
+    sm_mbms_gw_loadgen_session_done (session, false);
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_mbms_gw_loadgen_ulp_req (
+  nw_gtpv2c_ulp_handle_t hUlp,
+  nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  switch (pUlpApi->apiType) {
+  case NW_GTPV2C_ULP_API_TRIGGERED_RSP_IND:
+    sm_mbms_gw_loadgen_handle_response (pUlpApi);
+    break;
+
+  case NW_GTPV2C_ULP_API_RSP_FAILURE_IND: {
+      const uint64_t                        index = pUlpApi->u_api_info.rspFailureInfo.hUlpTrxn;
+
+      if (index && index <= loadgen.nb_sessions && loadgen.sessions[index - 1].state == SM_MBMS_GW_SESSION_PENDING) {
+        sm_mbms_gw_session_t               *session = &loadgen.sessions[index - 1];
+
+        loadgen.stats[session->procedure].timeouts++;
+        /** State unknown at the MCE: a timed out Update keeps the session, a Start or Stop drops it. */
+        sm_mbms_gw_loadgen_session_done (session, session->procedure == SM_MBMS_GW_LOADGEN_UPDATE);
+      }
+    }
+    break;
+
+  default:
+    loadgen.unmatched++;
+    break;
+  }
+  if (pUlpApi->hMsg)
+    nwGtpv2cMsgDelete (loadgen.hStack, pUlpApi->hMsg);
+  return NW_OK;
+}
+
+/*------------------------------------------------------------------------------
+                                 R E P O R T S
+  ----------------------------------------------------------------------------*/
+
+static void
+sm_mbms_gw_loadgen_report_interval (
+  const sm_mbms_gw_loadgen_stats_t * last,
+  double seconds)
+{
+  printf ("%6.1f s:", seconds);
+  for (int p = 0; p < SM_MBMS_GW_LOADGEN_PROCEDURES; p++) {
+    const sm_mbms_gw_loadgen_stats_t       *s = &loadgen.stats[p];
+
+    printf ("  %s %" PRIu64 "/%" PRIu64 " ok", sm_mbms_gw_loadgen_procedure_str[p], s->accepted - last[p].accepted, s->sent - last[p].sent);
+    if (s->timeouts - last[p].timeouts)
+      printf (" %" PRIu64 " to", s->timeouts - last[p].timeouts);
+  }
+  printf ("  active %u pending %u\n", loadgen.active.size, loadgen.pending);
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_report (double seconds)
+{
+  sm_mbms_gw_loadgen_stats_t              total = {0};
+
+  printf ("\n%-7s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n", "request", "sent", "retrans", "accepted", "rejected",
+      "invalid", "timeout", "avg us", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+  for (int p = 0; p <= SM_MBMS_GW_LOADGEN_PROCEDURES; p++) {
+    const sm_mbms_gw_loadgen_stats_t       *s = (p < SM_MBMS_GW_LOADGEN_PROCEDURES) ? &loadgen.stats[p] : &total;
+    const uint64_t                          answered = s->accepted + s->rejected + s->invalid;
+
+    if (p < SM_MBMS_GW_LOADGEN_PROCEDURES) {
+      total.sent += s->sent; total.transmitted += s->transmitted; total.accepted += s->accepted; total.rejected += s->rejected;
+      total.invalid += s->invalid; total.timeouts += s->timeouts; total.latency_sum_us += s->latency_sum_us;
+      if (s->latency_max_us > total.latency_max_us)
+        total.latency_max_us = s->latency_max_us;
+      for (uint32_t i = 0; i < SM_MBMS_GW_LOADGEN_HIST_BUCKETS; i++)
+        total.hist[i] += s->hist[i];
+    }
+    printf ("%-7s %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64
+        " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 "\n",
+        (p < SM_MBMS_GW_LOADGEN_PROCEDURES) ? sm_mbms_gw_loadgen_procedure_str[p] : "all", s->sent, s->transmitted - s->sent,
+        s->accepted, s->rejected, s->invalid, s->timeouts, answered ? s->latency_sum_us / answered : 0,
+        sm_mbms_gw_loadgen_hist_percentile (s, 50), sm_mbms_gw_loadgen_hist_percentile (s, 90),
+        sm_mbms_gw_loadgen_hist_percentile (s, 99), sm_mbms_gw_loadgen_hist_percentile (s, 99.9), s->latency_max_us);
+  }
+  printf ("%.1f requests/s answered over %.1f s", (total.accepted + total.rejected + total.invalid) / seconds, seconds);
+  if (loadgen.unmatched)
+    printf (", %" PRIu64 " unmatched messages", loadgen.unmatched);
+  if (loadgen.restart_counter)
+    printf (", restart counter %u (%u active sessions lost)", loadgen.restart_counter, loadgen.lost);
+  printf ("\n");
+  for (int c = 0; c < 256; c++) {
+    if (loadgen.causes[c])
+      printf ("  rejected with cause %d: %" PRIu64 "\n", c, loadgen.causes[c]);
+  }
+}
+
+/*------------------------------------------------------------------------------
+                                  M A I N
+  ----------------------------------------------------------------------------*/
+
+/**
+ * Process the received responses and the expired stack timer, waiting at most until deadline_ns.
+ */
+static void
+sm_mbms_gw_loadgen_poll (uint64_t deadline_ns)
+{
+  uint8_t                                 buffer[SM_MBMS_GW_LOADGEN_RECV_BUFFER_SIZE];
+  struct pollfd                           pfd = {.fd = loadgen.sd, .events = POLLIN};
+  uint64_t                                now_ns = sm_mbms_gw_loadgen_now_ns ();
+  struct timespec                         timeout = {0};
+
+  if (loadgen.timer_armed && loadgen.timer_deadline_ns < deadline_ns)
+    deadline_ns = loadgen.timer_deadline_ns;
+  if (deadline_ns > now_ns) {
+    timeout.tv_sec = (deadline_ns - now_ns) / NSEC_PER_SEC;
+    timeout.tv_nsec = (deadline_ns - now_ns) % NSEC_PER_SEC;
+  }
+  if (ppoll (&pfd, 1, &timeout, NULL) > 0) {
+    struct sockaddr_in                      peer;
+    socklen_t                               peer_len = sizeof (peer);
+    ssize_t                                 len = 0;
+
+    while ((len = recvfrom (loadgen.sd, buffer, sizeof (buffer), 0, (struct sockaddr *)&peer, &peer_len)) > 0) {
+      nwGtpv2cProcessUdpReq (loadgen.hStack, buffer, len, ntohs (loadgen.local_addr.sin_port), ntohs (peer.sin_port), (struct sockaddr *)&peer);
+      peer_len = sizeof (peer);
+    }
+  }
+  if (loadgen.timer_armed && loadgen.timer_deadline_ns <= sm_mbms_gw_loadgen_now_ns ()) {
+    loadgen.timer_armed = false;
+    nwGtpv2cProcessTimeout (loadgen.timer_arg);
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool
+sm_mbms_gw_loadgen_parse_range (const char *arg, uint64_t * min, uint64_t * max)
+{
+  char                                   *end = NULL;
+
+  *min = strtoull (arg, &end, 10);
+  *max = (*end == ':') ? strtoull (end + 1, &end, 10) : *min;
+  return !*end && *min <= *max;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_mbms_gw_loadgen_usage (const char * const name)
+{
+  fprintf (stderr, "Usage: %s [options]\n", name);
+  fprintf (stderr, "  -a address       MCE Sm address (default 127.0.0.1)\n");
+  fprintf (stderr, "  -p port          MCE Sm port (default %d)\n", SM_MBMS_GW_LOADGEN_DEFAULT_PORT);
+  fprintf (stderr, "  -l address       local MBMS-GW address (default 127.0.0.2), an ephemeral port is used\n");
+  fprintf (stderr, "  -r rate          requests per second (default %d)\n", SM_MBMS_GW_LOADGEN_DEFAULT_RATE);
+  fprintf (stderr, "  -t seconds       duration (default %d)\n", SM_MBMS_GW_LOADGEN_DEFAULT_DURATION);
+  fprintf (stderr, "  -i seconds       report interval (default %d)\n", SM_MBMS_GW_LOADGEN_DEFAULT_INTERVAL);
+  fprintf (stderr, "  -m s:u:t         weights of Start, Update and Stop Requests (default 1:2:1)\n");
+  fprintf (stderr, "  -n sessions      MBMS sessions, one TMGI each (default %d)\n", SM_MBMS_GW_LOADGEN_DEFAULT_SESSIONS);
+  fprintf (stderr, "  -g service-id    MBMS service ID of the first TMGI (default 1)\n");
+  fprintf (stderr, "  -s first:last    SAI range (default 1:16)\n");
+  fprintf (stderr, "  -S count         maximum SAIs per request (default 4, max %d)\n", SM_MBMS_GW_LOADGEN_MAX_SAIS);
+  fprintf (stderr, "  -q qci[,qci]     QCIs drawn for the bearers (default 1)\n");
+  fprintf (stderr, "  -b min:max       GBR/MBR downlink range in kbps (default 64:2048)\n");
+  fprintf (stderr, "  -d min:max       MBMS session duration range in seconds (default 60:3600)\n");
+  fprintf (stderr, "  -T seconds       T3 (default 2)\n");
+  fprintf (stderr, "  -N retries       N3 (default 2)\n");
+  fprintf (stderr, "  -x seed          random seed (default 1)\n");
+  fprintf (stderr, "  -R seconds       restart the MBMS-GW once after seconds: new restart counter, active sessions lost\n");
+  fprintf (stderr, "  -k               keep the sessions active at the end (no final Stop Requests)\n");
+  fprintf (stderr, "  -v level         stack log level 0 (emergency) to 7 (debug) (default 3)\n");
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  const char                             *mce_address = "127.0.0.1";
+  const char                             *local_address = "127.0.0.2";
+  uint16_t                                mce_port = SM_MBMS_GW_LOADGEN_DEFAULT_PORT;
+  uint32_t                                duration = SM_MBMS_GW_LOADGEN_DEFAULT_DURATION;
+  uint32_t                                interval = SM_MBMS_GW_LOADGEN_DEFAULT_INTERVAL;
+  bool                                    keep = false;
+  bool                                    valid = true;
+  uint64_t                                min = 0, max = 0;
+  nw_gtpv2c_ulp_entity_t                  ulp;
+  nw_gtpv2c_udp_entity_t                  udp;
+  nw_gtpv2c_timer_mgr_entity_t            tmr_mgr;
+  nw_gtpv2c_log_mgr_entity_t              log_mgr;
+  sm_mbms_gw_loadgen_stats_t             *last = NULL;
+  socklen_t                               addr_len = sizeof (struct sockaddr_in);
+  uint64_t                                start_ns = 0, end_ns = 0, next_ns = 0, report_ns = 0, now_ns = 0, restart_ns = 0;
+  uint64_t                                period_ns = 0;
+  int                                     opt = 0;
+
+  loadgen.rate = SM_MBMS_GW_LOADGEN_DEFAULT_RATE;
+  loadgen.mix[SM_MBMS_GW_LOADGEN_START] = 1;
+  loadgen.mix[SM_MBMS_GW_LOADGEN_UPDATE] = 2;
+  loadgen.mix[SM_MBMS_GW_LOADGEN_STOP] = 1;
+  loadgen.nb_sessions = SM_MBMS_GW_LOADGEN_DEFAULT_SESSIONS;
+  loadgen.tmgi_base = 1;
+  loadgen.sai_first = 1;
+  loadgen.sai_last = 16;
+  loadgen.sais_max = 4;
+  loadgen.qcis[0] = 1;
+  loadgen.nb_qcis = 1;
+  loadgen.bitrate_min = 64;
+  loadgen.bitrate_max = 2048;
+  loadgen.duration_min = 60;
+  loadgen.duration_max = 3600;
+  loadgen.t3 = 2;
+  loadgen.n3 = 2;
+  loadgen.seed = 1;
+  loadgen.log_level = NW_LOG_LEVEL_ERRO;
+
+  while ((opt = getopt (argc, argv, "a:p:l:r:t:i:m:n:g:s:S:q:b:d:T:N:x:R:kv:h")) != -1) {
+    switch (opt) {
+    case 'a': mce_address = optarg; break;
+    case 'p': mce_port = (uint16_t)atoi (optarg); break;
+    case 'l': local_address = optarg; break;
+    case 'r': loadgen.rate = atof (optarg); break;
+    case 't': duration = atoi (optarg); break;
+    case 'i': interval = atoi (optarg); break;
+    case 'm':
+      valid &= sscanf (optarg, "%u:%u:%u", &loadgen.mix[0], &loadgen.mix[1], &loadgen.mix[2]) == 3;
+      break;
+    case 'n': loadgen.nb_sessions = atoi (optarg); break;
+    case 'g': loadgen.tmgi_base = strtoul (optarg, NULL, 0); break;
+    case 's':
+      valid &= sm_mbms_gw_loadgen_parse_range (optarg, &min, &max) && max <= UINT16_MAX;
+      loadgen.sai_first = min; loadgen.sai_last = max;
+      break;
+    case 'S': loadgen.sais_max = atoi (optarg); break;
+    case 'q': {
+        char                               *qci = strtok (optarg, ",");
+
+        for (loadgen.nb_qcis = 0; qci && loadgen.nb_qcis < SM_MBMS_GW_LOADGEN_MAX_QCIS; qci = strtok (NULL, ","))
+          loadgen.qcis[loadgen.nb_qcis++] = atoi (qci);
+      }
+      break;
+    case 'b':
+      valid &= sm_mbms_gw_loadgen_parse_range (optarg, &loadgen.bitrate_min, &loadgen.bitrate_max);
+      break;
+    case 'd':
+      valid &= sm_mbms_gw_loadgen_parse_range (optarg, &min, &max) && max < (1 << 17);
+      loadgen.duration_min = min; loadgen.duration_max = max;
+      break;
+    case 'T': loadgen.t3 = atoi (optarg); break;
+    case 'N': loadgen.n3 = atoi (optarg); break;
+    case 'x': loadgen.seed = strtoul (optarg, NULL, 0); break;
+    case 'R': loadgen.restart_after = atoi (optarg); break;
+    case 'k': keep = true; break;
+    case 'v': loadgen.log_level = atoi (optarg); break;
+    default:
+      sm_mbms_gw_loadgen_usage (argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  loadgen.mce_addr.sin_family = AF_INET;
+  loadgen.mce_addr.sin_port = htons (mce_port);
+  loadgen.local_addr.sin_family = AF_INET;
+  if (!valid || loadgen.rate <= 0 || !duration || !interval || !loadgen.nb_sessions || loadgen.nb_sessions > SM_MBMS_GW_LOADGEN_MAX_SESSIONS
+      || !(loadgen.mix[0] + loadgen.mix[1] + loadgen.mix[2]) || !loadgen.sais_max || loadgen.sais_max > SM_MBMS_GW_LOADGEN_MAX_SAIS
+      || !loadgen.nb_qcis || !loadgen.t3 || !loadgen.seed
+      || inet_pton (AF_INET, mce_address, &loadgen.mce_addr.sin_addr) != 1
+      || inet_pton (AF_INET, local_address, &loadgen.local_addr.sin_addr) != 1) {
+    sm_mbms_gw_loadgen_usage (argv[0]);
+    return 1;
+  }
+
+  /** Socket of the MBMS-GW, non blocking, all responses are read per poll. */
+  if ((loadgen.sd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0
+      || bind (loadgen.sd, (struct sockaddr *)&loadgen.local_addr, sizeof (loadgen.local_addr)) < 0
+      || getsockname (loadgen.sd, (struct sockaddr *)&loadgen.local_addr, &addr_len) < 0
+      || fcntl (loadgen.sd, F_SETFL, O_NONBLOCK) < 0) {
+    fprintf (stderr, "Could not open the MBMS-GW socket on %s: %s\n", local_address, strerror (errno));
+    return 1;
+  }
+
+  /** Stack instance of the MBMS-GW. */
+  if (nwGtpv2cInitialize (&loadgen.hStack) != NW_OK) {
+    fprintf (stderr, "Could not create the GTPv2-C stack instance\n");
+    return 1;
+  }
+  ulp.hUlp = (nw_gtpv2c_ulp_handle_t) &loadgen;
+  ulp.ulpReqCallback = sm_mbms_gw_loadgen_ulp_req;
+  nwGtpv2cSetUlpEntity (loadgen.hStack, &ulp);
+  udp.hUdp = (nw_gtpv2c_udp_handle_t) &loadgen;
+  udp.gtpv2cStandardPort = SM_MBMS_GW_LOADGEN_DEFAULT_PORT;
+  udp.udpDataReqCallback = sm_mbms_gw_loadgen_udp_data_req;
+  nwGtpv2cSetUdpEntity (loadgen.hStack, &udp);
+  tmr_mgr.tmrMgrHandle = 0;
+  tmr_mgr.tmrStartCallback = sm_mbms_gw_loadgen_timer_start;
+  tmr_mgr.tmrStopCallback = sm_mbms_gw_loadgen_timer_stop;
+  nwGtpv2cSetTimerMgrEntity (loadgen.hStack, &tmr_mgr);
+  log_mgr.logMgrHandle = 0;
+  log_mgr.logReqCallback = sm_mbms_gw_loadgen_log;
+  nwGtpv2cSetLogMgrEntity (loadgen.hStack, &log_mgr);
+  nwGtpv2cSetLogLevel (loadgen.hStack, loadgen.log_level);
+
+  /** All sessions idle. */
+  loadgen.sessions = calloc (loadgen.nb_sessions, sizeof (sm_mbms_gw_session_t));
+  loadgen.idle.index = calloc (loadgen.nb_sessions, sizeof (uint32_t));
+  loadgen.active.index = calloc (loadgen.nb_sessions, sizeof (uint32_t));
+  last = calloc (SM_MBMS_GW_LOADGEN_PROCEDURES, sizeof (sm_mbms_gw_loadgen_stats_t));
+  for (uint32_t i = 0; i < loadgen.nb_sessions; i++) {
+    loadgen.sessions[i].index = i;
+    loadgen.sessions[i].local_teid = 0x10000 + i;
+    sm_mbms_gw_loadgen_list_add (&loadgen.idle, &loadgen.sessions[i]);
+  }
+  signal (SIGINT, sm_mbms_gw_loadgen_signal_handler);
+  signal (SIGTERM, sm_mbms_gw_loadgen_signal_handler);
+
+  printf ("MBMS-GW %s:%u towards MCE %s:%u, %u sessions (TMGI service IDs %u..%u), %.1f requests/s, mix %u:%u:%u, %u s\n",
+      local_address, ntohs (loadgen.local_addr.sin_port), mce_address, mce_port, loadgen.nb_sessions, loadgen.tmgi_base,
+      loadgen.tmgi_base + loadgen.nb_sessions - 1, loadgen.rate, loadgen.mix[0], loadgen.mix[1], loadgen.mix[2], duration);
+
+  /** With a restart to come, the MCE learns the restart counter first. */
+  if (loadgen.restart_after) {
+    uint32_t                                seq = 0;
+
+    nwGtpv2cSendEchoReq (loadgen.hStack, (struct sockaddr *)&loadgen.mce_addr, mce_port, false, &seq);
+  }
+
+  /** Requests at a constant rate, late requests are sent at once (no coordinated omission). */
+  period_ns = (uint64_t)(NSEC_PER_SEC / loadgen.rate);
+  start_ns = next_ns = report_ns = sm_mbms_gw_loadgen_now_ns ();
+  end_ns = start_ns + (uint64_t)duration * NSEC_PER_SEC;
+  restart_ns = loadgen.restart_after ? start_ns + (uint64_t)loadgen.restart_after * NSEC_PER_SEC : 0;
+  while (!sm_mbms_gw_loadgen_terminate && (now_ns = sm_mbms_gw_loadgen_now_ns ()) < end_ns) {
+    if (restart_ns && now_ns >= restart_ns) {
+      sm_mbms_gw_loadgen_restart ();
+      restart_ns = 0;
+    }
+    while (next_ns <= now_ns) {
+      sm_mbms_gw_loadgen_send_next ();
+      next_ns += period_ns;
+    }
+    if (now_ns - report_ns >= (uint64_t)interval * NSEC_PER_SEC) {
+      sm_mbms_gw_loadgen_report_interval (last, (double)(now_ns - start_ns) / NSEC_PER_SEC);
+      memcpy (last, loadgen.stats, sizeof (loadgen.stats));
+      report_ns = now_ns;
+    }
+    sm_mbms_gw_loadgen_poll (next_ns < end_ns ? next_ns : end_ns);
+  }
+  now_ns = sm_mbms_gw_loadgen_now_ns ();
+
+  /** Wait for the outstanding requests, stop the active sessions, at the same rate. */
+  while (!sm_mbms_gw_loadgen_terminate && (loadgen.pending || (!keep && loadgen.active.size))) {
+    now_ns = sm_mbms_gw_loadgen_now_ns ();
+    while (!keep && loadgen.active.size && next_ns <= now_ns) {
+      sm_mbms_gw_session_t                 *session = sm_mbms_gw_loadgen_list_take (&loadgen.active);
+
+      if (!sm_mbms_gw_loadgen_send (session, SM_MBMS_GW_LOADGEN_STOP))
+        sm_mbms_gw_loadgen_session_done (session, false);
+      next_ns += period_ns;
+    }
+    if (next_ns < now_ns)
+      next_ns = now_ns;
+    sm_mbms_gw_loadgen_poll ((!keep && loadgen.active.size) ? next_ns : now_ns + NSEC_PER_SEC);
+  }
+  sm_mbms_gw_loadgen_report ((double)(end_ns < now_ns ? end_ns - start_ns : now_ns - start_ns) / NSEC_PER_SEC);
+
+  nwGtpv2cFinalize (loadgen.hStack);
+  close (loadgen.sd);
+  free (loadgen.sessions);
+  free (loadgen.idle.index);
+  free (loadgen.active.index);
+  free (last);
+  return 0;
+}
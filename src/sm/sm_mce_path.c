@@ -0,0 +1,181 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_mce_path.c
+* \brief Sm path supervision of an MBMS-GW and its restart detection.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include "NwTypes.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "sm_mce_path.h"
+
+//------------------------------------------------------------------------------
+static uint32_t sm_mce_path_echo_seq (const uint8_t *buffer)
+{
+  const uint8_t                          *seq = buffer + ((buffer[0] & 0x08) ? 8 : 4);
+
+  return ((uint32_t)seq[0] << 16) | ((uint32_t)seq[1] << 8) | seq[2];
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Restart counter of the Recovery IE of an Echo Request or Response, without decoding the whole message.
+ */
+static bool sm_mce_path_echo_recovery (const uint8_t *buffer, uint32_t length, uint8_t *recovery)
+{
+  uint32_t                                offset = (buffer[0] & 0x08) ? 12 : NW_GTPV2C_MINIMUM_HEADER_SIZE;
+  uint32_t                                end = 4 + (((uint32_t)buffer[2] << 8) | buffer[3]);
+
+  if (end > length) {
+    end = length;
+  }
+  while (offset + 4 <= end) {
+    const uint32_t                        ie_length = ((uint32_t)buffer[offset + 1] << 8) | buffer[offset + 2];
+
+    if (offset + 4 + ie_length > end) {
+      break;
+    }
+    if (buffer[offset] == NW_GTPV2C_IE_RECOVERY && ie_length >= 1) {
+      *recovery = buffer[offset + 4];
+      return true;
+    }
+    offset += 4 + ie_length;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Compare the restart counter of the MBMS-GW with the one learned. On a restart, all its transactions and tunnels
+ * are released in one pass over the stack.
+ */
+static void sm_mce_path_check_recovery (sm_mce_path_t *path, nw_gtpv2c_stack_handle_t stack_handle, uint8_t recovery,
+    sm_mce_path_release_tunnel_cb_t release_tunnel, void *arg, sm_mce_path_events_t *events)
+{
+  if (!path->recovery_known) {
+    path->recovery_known = true;
+    path->recovery = recovery;
+    events->recovery_learned = true;
+    return;
+  }
+  if (path->recovery == recovery) {
+    return;
+  }
+  events->restart = true;
+  events->old_recovery = path->recovery;
+  path->recovery = recovery;
+  nwGtpv2cPurgePeer (stack_handle, (struct sockaddr *)&path->address, release_tunnel, arg, &events->nb_trxns, &events->nb_tunnels);
+}
+
+//------------------------------------------------------------------------------
+void sm_mce_path_init (sm_mce_path_t *path, const struct sockaddr *address)
+{
+  memset (path, 0, sizeof (*path));
+  memcpy (&path->address, address, address->sa_family == AF_INET6 ? sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in));
+}
+
+//------------------------------------------------------------------------------
+bool sm_mce_path_receive (sm_mce_path_t *path, const sm_mce_path_config_t *config, nw_gtpv2c_stack_handle_t stack_handle,
+    const uint8_t *buffer, uint32_t length, uint16_t peer_port, uint64_t now_ns,
+    sm_mce_path_release_tunnel_cb_t release_tunnel, void *arg, sm_mce_path_events_t *events)
+{
+  uint8_t                                 recovery = 0;
+
+  memset (events, 0, sizeof (*events));
+  if (!path->port && config->echo_interval_ns) {
+    /** New peer, learn its restart counter with the next tick of the supervision. */
+    path->echo_due_ns = now_ns;
+  }
+  path->port = peer_port;
+  if (length < NW_GTPV2C_MINIMUM_HEADER_SIZE) {
+    return false;
+  }
+
+  if (buffer[1] == NW_GTP_ECHO_RSP) {
+    /** Answer to the path supervision, not handed to the stack. */
+    if (path->echo_outstanding && sm_mce_path_echo_seq (buffer) == path->echo_seq) {
+      path->echo_outstanding = false;
+      path->echo_retries = 0;
+      path->echo_due_ns = now_ns + config->echo_interval_ns;
+      events->echo_response = true;
+      if (path->path_down) {
+        path->path_down = false;
+        events->path_restored = true;
+      }
+    }
+    if (sm_mce_path_echo_recovery (buffer, length, &recovery)) {
+      sm_mce_path_check_recovery (path, stack_handle, recovery, release_tunnel, arg, events);
+    }
+    return true;
+  }
+  if (buffer[1] == NW_GTP_ECHO_REQ && sm_mce_path_echo_recovery (buffer, length, &recovery)) {
+    /** A restarted MBMS-GW is released before the stack answers. */
+    sm_mce_path_check_recovery (path, stack_handle, recovery, release_tunnel, arg, events);
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void sm_mce_path_supervise (sm_mce_path_t *path, const sm_mce_path_config_t *config, nw_gtpv2c_stack_handle_t stack_handle,
+    uint64_t now_ns, sm_mce_path_events_t *events)
+{
+  bool                                    retransmit = false;
+
+  memset (events, 0, sizeof (*events));
+  if (!path->port || now_ns < path->echo_due_ns) {
+    return;
+  }
+  if (path->echo_outstanding && path->echo_retries >= config->echo_n3) {
+    uint32_t                              nb_tunnels = 0;
+
+    path->echo_outstanding = false;
+    path->echo_retries = 0;
+    path->echo_due_ns = now_ns + config->echo_interval_ns;
+    if (!path->path_down) {
+      path->path_down = true;
+      events->path_failure = true;
+      nwGtpv2cPurgePeer (stack_handle, (struct sockaddr *)&path->address, NULL, NULL, &events->nb_trxns, &nb_tunnels);
+    }
+    return;
+  }
+  retransmit = path->echo_outstanding;
+  if (nwGtpv2cSendEchoReq (stack_handle, (struct sockaddr *)&path->address, path->port, retransmit, &path->echo_seq) != NW_OK) {
+    events->echo_request_failed = true;
+  }
+  if (retransmit) {
+    path->echo_retries++;
+  }
+  path->echo_outstanding = true;
+  path->echo_due_ns = now_ns + config->echo_t3_ns;
+  events->echo_request = true;
+}
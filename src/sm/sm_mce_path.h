@@ -0,0 +1,99 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_mce_path.h
+* \brief Sm path supervision of an MBMS-GW: Echo Requests (T3, N3) and the restart counter of its Recovery IE.
+* Owned by the user of a GTPv2-C stack instance (the shards of the Sm task, sm_echo_restart_test), which passes each
+* datagram of the peer and ticks the supervision. On a path failure or a restart, the transactions and tunnels of the
+* peer are released in the stack. The user accounts and reports the events.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+*/
+
+#ifndef FILE_SM_MCE_PATH_SEEN
+#define FILE_SM_MCE_PATH_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#include "NwTypes.h"
+#include "NwGtpv2c.h"
+
+typedef struct sm_mce_path_config_s {
+  uint64_t                  echo_interval_ns;           ///< Between Echo Requests, 0 without supervision
+  uint64_t                  echo_t3_ns;                 ///< Until an unanswered Echo Request is retransmitted
+  uint16_t                  echo_n3;                    ///< Retransmissions until the path is down
+} sm_mce_path_config_t;
+
+/** Path to an MBMS-GW, identified by its address (any port). */
+typedef struct sm_mce_path_s {
+  struct sockaddr_storage   address;
+  uint16_t                  port;                       ///< Source port of its last datagram, Echo Requests go there. 0 until then.
+  uint64_t                  echo_due_ns;                ///< Next Echo Request or retransmission
+  uint32_t                  echo_seq;                   ///< Of the outstanding Echo Request
+  bool                      echo_outstanding;
+  uint16_t                  echo_retries;
+  bool                      path_down;
+  bool                      recovery_known;             ///< Restart counter of the MBMS-GW learned
+  uint8_t                   recovery;
+} sm_mce_path_t;
+
+/** What a datagram or a tick of the supervision did to a path. */
+typedef struct sm_mce_path_events_s {
+  bool                      echo_request;               ///< Echo Request sent or retransmitted
+  bool                      echo_request_failed;        ///< Echo Request could not be sent
+  bool                      echo_response;              ///< Outstanding Echo Request answered
+  bool                      path_restored;
+  bool                      path_failure;               ///< N3 retransmissions unanswered, the pending transactions dropped
+  bool                      recovery_learned;
+  bool                      restart;                    ///< New restart counter, the transactions and tunnels released
+  uint8_t                   old_recovery;               ///< Restart counter before the restart
+  uint32_t                  nb_trxns;                   ///< Released by the path failure or the restart
+  uint32_t                  nb_tunnels;                 ///< Released by the restart
+} sm_mce_path_events_t;
+
+/** Called for each tunnel of a restarted MBMS-GW, after the stack deleted it. */
+typedef void (*sm_mce_path_release_tunnel_cb_t)(void *arg, uint32_t teid_local);
+
+/* @brief Path to the MBMS-GW of the address, without a port until its first datagram. */
+void sm_mce_path_init(sm_mce_path_t *path, const struct sockaddr *address);
+
+/*
+ * @brief Supervision of a datagram of the MBMS-GW, before the stack gets it. The restart counter of Echo Requests and
+ * Responses is checked; a restarted MBMS-GW is released before the stack answers its Echo Request.
+ * @return true for an Echo Response, which is not handed to the stack.
+ */
+bool sm_mce_path_receive(sm_mce_path_t *path, const sm_mce_path_config_t *config, nw_gtpv2c_stack_handle_t stack_handle,
+    const uint8_t *buffer, uint32_t length, uint16_t peer_port, uint64_t now_ns,
+    sm_mce_path_release_tunnel_cb_t release_tunnel, void *arg, sm_mce_path_events_t *events);
+
+/*
+ * @brief Send the Echo Request due to the MBMS-GW or retransmit the unanswered one. The path is down after N3
+ * unanswered retransmissions: the pending transactions of the peer are dropped, its tunnels are kept until it
+ * answers with another restart counter.
+ */
+void sm_mce_path_supervise(sm_mce_path_t *path, const sm_mce_path_config_t *config, nw_gtpv2c_stack_handle_t stack_handle,
+    uint64_t now_ns, sm_mce_path_events_t *events);
+
+#endif /* FILE_SM_MCE_PATH_SEEN */
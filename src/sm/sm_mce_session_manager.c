@@ -48,18 +48,18 @@
 #include "NwGtpv2cIe.h"
 #include "NwGtpv2cMsg.h"
 #include "NwGtpv2cMsgParser.h"
+#include "sm_mce_shard.h"
 #include "sm_mce_session_manager.h"
 
 #include "gtpv2c_ie_formatter.h"
 #include "sm_common.h"
 #include "sm_ie_formatter.h"
-
-extern hash_table_ts_t                        *sm_mce_teid_2_gtv2c_teid_handle;
+#include "sm_msg_decoder.h"
 
 //------------------------------------------------------------------------------
 int
 sm_mce_handle_mbms_session_start_request(
-  nw_gtpv2c_stack_handle_t * stack_p,
+  sm_mce_shard_t *shard,
   nw_gtpv2c_ulp_api_t * pUlpApi)
 {
   nw_rc_t                                 rc = NW_OK;
@@ -68,9 +68,8 @@ sm_mce_handle_mbms_session_start_request(
   uint16_t                                offendingIeLength;
   itti_sm_mbms_session_start_request_t   *req_p;
   MessageDef                             *message_p;
-  nw_gtpv2c_msg_parser_t                 *pMsgParser;
 
-  DevAssert (stack_p );
+  DevAssert (shard );
 
   teid_t teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
@@ -83,93 +82,20 @@ sm_mce_handle_mbms_session_start_request(
 		  sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
 
   /*
-   * Create a new message parser for the SM MBMS SESSION START REQUEST.
-   */
-  rc = nwGtpv2cMsgParserNew (*stack_p, NW_GTP_MBMS_SESSION_START_REQ, sm_ie_indication_generic, NULL, &pMsgParser);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * Sender (MBMS-GW) FTEID for CP IE
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-      gtpv2c_fteid_ie_get, &req_p->sm_mbms_fteid);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * TMGI
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_TMGI, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  sm_tmgi_ie_get, &req_p->tmgi);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Session Duration
+   * Decode the SM MBMS SESSION START REQUEST in a single pass (same validation as the generic message parser).
    */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_SESSION_DURATION, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  sm_mbms_session_duration_ie_get, &req_p->mbms_session_duration);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Service Area
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_SERVICE_AREA, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  sm_mbms_service_area_ie_get, &req_p->mbms_service_area);
-  DevAssert (NW_OK == rc);
-
-  /** Skip Session Identifier. */
-
-  /*
-   * MBMS Flow Identifier
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
-	  sm_mbms_flow_identifier_ie_get, &req_p->mbms_flow_id);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * QoS Profile
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_BEARER_LEVEL_QOS, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  gtpv2c_bearer_qos_ie_get, &req_p->mbms_bearer_level_qos);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS IP Multicast Distribution Address
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_IP_MULTICAST_DISTRIBUTION, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  sm_mbms_ip_multicast_distribution_ie_get, &req_p->mbms_ip_mc_address);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Absolute Time of Data Transfer Start
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL,
-	  sm_mbms_data_transfer_start_ie_get, &req_p->abs_start_time);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS-Flags
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_FLAGS, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL,
-	  sm_mbms_flags_ie_get, &req_p->mbms_flags);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * Run the parser
-   */
-  rc = nwGtpv2cMsgParserRun (pMsgParser, (pUlpApi->hMsg), &offendingIeType, &offendingIeInstance, &offendingIeLength);
+  rc = sm_mbms_session_start_request_decode ((pUlpApi->hMsg), req_p, &offendingIeType, &offendingIeInstance, &offendingIeLength);
   if (rc != NW_OK) {
+    OAILOG_WARNING (LOG_SM, "Discarding MBMS Session Start Request (rc %d, offending IE type %u instance %u length %u).\n",
+        rc, offendingIeType, offendingIeInstance, offendingIeLength);
     itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
-    DevAssert (NW_OK == rc);
-    rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+    rc = nwGtpv2cMsgDelete (shard->stack_handle, (pUlpApi->hMsg));
     DevAssert (NW_OK == rc);
     return RETURNerror;
   }
 
-  rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
-  DevAssert (NW_OK == rc);
-  rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+  rc = nwGtpv2cMsgDelete (shard->stack_handle, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
 
   return itti_send_msg_to_task (TASK_MCE_APP, INSTANCE_DEFAULT, message_p);
@@ -178,7 +104,7 @@ sm_mce_handle_mbms_session_start_request(
 //------------------------------------------------------------------------------
 int
 sm_mce_mbms_session_start_response (
-    nw_gtpv2c_stack_handle_t *stack_p,
+    sm_mce_shard_t *shard,
     itti_sm_mbms_session_start_response_t *mbms_session_start_response_p)
 {
 
@@ -189,7 +115,7 @@ sm_mce_mbms_session_start_response (
    OAILOG_FUNC_IN (LOG_SM);
 
    DevAssert (mbms_session_start_response_p );
-   DevAssert (stack_p );
+   DevAssert (shard );
    trxn = (nw_gtpv2c_trxn_handle_t) mbms_session_start_response_p->trxn;
    DevAssert (trxn );
    memset (&ulp_req, 0, sizeof (nw_gtpv2c_ulp_api_t));
@@ -204,7 +130,7 @@ sm_mce_mbms_session_start_response (
      ulp_req.u_api_info.createLocalTunnelInfo.peerIp = &mbms_session_start_response_p->mbms_peer_ip;
      ulp_req.u_api_info.createLocalTunnelInfo.hUlpTunnel = 0;
      ulp_req.u_api_info.createLocalTunnelInfo.hTunnel    = 0;
-     rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+     rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_req);
 
      if(NW_OK != rc){
        OAILOG_ERROR(LOG_SM, "Error, we could not setup local tunnel while sending MBMS_SESSION_START_RESPONSE!. \n");
@@ -214,13 +140,15 @@ sm_mce_mbms_session_start_response (
      OAILOG_INFO(LOG_SM, "Successfully created tunnel while MBMS_SESSION_START_RESPONSE!. \n");
      OAILOG_INFO (LOG_SM, "INSERTING INTO SM HASHTABLE (3) teid " TEID_FMT " and tunnel object %p. \n", ulp_req.u_api_info.createLocalTunnelInfo.teidLocal, ulp_req.u_api_info.createLocalTunnelInfo.hTunnel);
 
-     hashtable_rc_t hash_rc = hashtable_ts_insert(sm_mce_teid_2_gtv2c_teid_handle,
+     hashtable_rc_t hash_rc = hashtable_insert(shard->teid_2_tunnel,
          (hash_key_t) ulp_req.u_api_info.createLocalTunnelInfo.teidLocal,
          (void *)ulp_req.u_api_info.createLocalTunnelInfo.hTunnel);
 
-     hash_rc = hashtable_ts_get(sm_mce_teid_2_gtv2c_teid_handle,
+     hash_rc = hashtable_get(shard->teid_2_tunnel,
          (hash_key_t) ulp_req.u_api_info.createLocalTunnelInfo.teidLocal, (void **)(uintptr_t)&ulp_req.u_api_info.createLocalTunnelInfo.hTunnel);
      DevAssert(hash_rc == HASH_TABLE_OK);
+     /** The MBMS service is owned by the shard of the MBMS-GW. */
+     sm_mce_shard_get_peer(shard, (struct sockaddr *)&mbms_session_start_response_p->mbms_peer_ip)->services++;
    }else{
      OAILOG_WARNING (LOG_SM, "The cause is not REQUEST_ACCEPTED but %d for MBMS_SESSION_START_RESPONSE. "
          "Not creating a local SM Tunnel. \n", mbms_session_start_response_p->cause);
@@ -233,7 +161,7 @@ sm_mce_mbms_session_start_response (
    memset (&cause, 0, sizeof (gtpv2c_cause_t));
    ulp_req.apiType = NW_GTPV2C_ULP_API_TRIGGERED_RSP;
    ulp_req.u_api_info.triggeredRspInfo.hTrxn = trxn;
-   rc = nwGtpv2cMsgNew (*stack_p, true, NW_GTP_MBMS_SESSION_START_RSP, 0, 0, &(ulp_req.hMsg));
+   rc = nwGtpv2cMsgNew (shard->stack_handle, true, NW_GTP_MBMS_SESSION_START_RSP, 0, 0, &(ulp_req.hMsg));
    DevAssert (NW_OK == rc);
 
    /**
@@ -253,7 +181,7 @@ sm_mce_mbms_session_start_response (
 		   mbms_session_start_response_p->sm_mce_teid.ipv6 ? &mbms_session_start_response_p->sm_mce_teid.ipv6_address : NULL);
 
    /** No allocated context remains. */
-   rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+   rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_req);
    DevAssert (NW_OK == rc);
 
    return RETURNok;
@@ -262,7 +190,7 @@ sm_mce_mbms_session_start_response (
 //------------------------------------------------------------------------------
 int
 sm_mce_handle_mbms_session_update_request(
-  nw_gtpv2c_stack_handle_t * stack_p,
+  sm_mce_shard_t *shard,
   nw_gtpv2c_ulp_api_t * pUlpApi)
 {
   nw_rc_t                                 rc = NW_OK;
@@ -271,9 +199,8 @@ sm_mce_handle_mbms_session_update_request(
   uint16_t                                offendingIeLength;
   itti_sm_mbms_session_update_request_t  *req_p;
   MessageDef                             *message_p;
-  nw_gtpv2c_msg_parser_t                 *pMsgParser;
 
-  DevAssert (stack_p );
+  DevAssert (shard );
 
   teid_t teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
@@ -286,80 +213,21 @@ sm_mce_handle_mbms_session_update_request(
 		  sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
 
   /*
-   * Create a new message parser for the SM MBMS SESSION UPDATE REQUEST.
-   */
-  rc = nwGtpv2cMsgParserNew (*stack_p, NW_GTP_MBMS_SESSION_UPDATE_REQ, sm_ie_indication_generic, NULL, &pMsgParser);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Service Area
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_SERVICE_AREA, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
-	  sm_mbms_service_area_ie_get, &req_p->mbms_service_area);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * TMGI
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_TMGI, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  sm_tmgi_ie_get, &req_p->tmgi);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * Sender (MBMS-GW) FTEID for CP IE
+   * Decode the SM MBMS SESSION UPDATE REQUEST in a single pass (same validation as the generic message parser).
    */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL,
-      gtpv2c_fteid_ie_get, &req_p->sm_mbms_fteid);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Session Duration
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_SESSION_DURATION, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  sm_mbms_session_duration_ie_get, &req_p->mbms_session_duration);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * QoS Profile
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_BEARER_LEVEL_QOS, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
-	  gtpv2c_bearer_qos_ie_get, &req_p->mbms_bearer_level_qos);
-  DevAssert (NW_OK == rc);
-
-  /** Skip Session Identifier. */
-
-  /*
-   * MBMS Flow Identifier
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
-	  sm_mbms_flow_identifier_ie_get, &req_p->mbms_flow_id);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Absolute Time of Data Transfer Start
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL,
-	  sm_mbms_data_transfer_start_ie_get, &req_p->abs_update_time);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * Run the parser
-   */
-  rc = nwGtpv2cMsgParserRun (pMsgParser, (pUlpApi->hMsg), &offendingIeType, &offendingIeInstance, &offendingIeLength);
+  rc = sm_mbms_session_update_request_decode ((pUlpApi->hMsg), req_p, &offendingIeType, &offendingIeInstance, &offendingIeLength);
 
   if (rc != NW_OK) {
+    OAILOG_WARNING (LOG_SM, "Discarding MBMS Session Update Request (rc %d, offending IE type %u instance %u length %u).\n",
+        rc, offendingIeType, offendingIeInstance, offendingIeLength);
     itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
-    DevAssert (NW_OK == rc);
-    rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+    rc = nwGtpv2cMsgDelete (shard->stack_handle, (pUlpApi->hMsg));
     DevAssert (NW_OK == rc);
     return RETURNerror;
   }
 
-  rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
-  DevAssert (NW_OK == rc);
-  rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+  rc = nwGtpv2cMsgDelete (shard->stack_handle, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
 
   return itti_send_msg_to_task (TASK_MCE_APP, INSTANCE_DEFAULT, message_p);
@@ -368,7 +236,7 @@ sm_mce_handle_mbms_session_update_request(
 //------------------------------------------------------------------------------
 int
 sm_mce_mbms_session_update_response (
-    nw_gtpv2c_stack_handle_t *stack_p,
+    sm_mce_shard_t *shard,
     itti_sm_mbms_session_update_response_t *mbms_session_update_response_p)
 {
    nw_rc_t                                 rc;
@@ -378,7 +246,7 @@ sm_mce_mbms_session_update_response (
    OAILOG_FUNC_IN (LOG_SM);
 
    DevAssert (mbms_session_update_response_p );
-   DevAssert (stack_p );
+   DevAssert (shard );
    trxn = (nw_gtpv2c_trxn_handle_t) mbms_session_update_response_p->trxn;
    DevAssert (trxn );
    /**
@@ -392,7 +260,7 @@ sm_mce_mbms_session_update_response (
    ulp_rsp.u_api_info.triggeredRspInfo.hTunnel    = 0;
    ulp_rsp.u_api_info.triggeredRspInfo.hTrxn = trxn;
 
-   hashtable_rc_t hash_rc = hashtable_ts_get(sm_mce_teid_2_gtv2c_teid_handle,
+   hashtable_rc_t hash_rc = hashtable_get(shard->teid_2_tunnel,
        (hash_key_t) ulp_rsp.u_api_info.triggeredRspInfo.teidLocal, (void **)(uintptr_t)&ulp_rsp.u_api_info.triggeredRspInfo.hTunnel);
 
    if (HASH_TABLE_OK != hash_rc) {
@@ -400,7 +268,7 @@ sm_mce_mbms_session_update_response (
      return RETURNerror;
    }
 
-   rc = nwGtpv2cMsgNew (*stack_p, true, NW_GTP_MBMS_SESSION_UPDATE_RSP, 0, 0, &(ulp_rsp.hMsg));
+   rc = nwGtpv2cMsgNew (shard->stack_handle, true, NW_GTP_MBMS_SESSION_UPDATE_RSP, 0, 0, &(ulp_rsp.hMsg));
    DevAssert (NW_OK == rc);
 
    /**
@@ -414,7 +282,7 @@ sm_mce_mbms_session_update_response (
    DevAssert( NW_OK == rc );
 
    /** No allocated context remains. */
-   rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_rsp);
+   rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_rsp);
    DevAssert (NW_OK == rc);
 
    return RETURNok;
@@ -423,7 +291,7 @@ sm_mce_mbms_session_update_response (
 //------------------------------------------------------------------------------
 int
 sm_mce_handle_mbms_session_stop_request(
-  nw_gtpv2c_stack_handle_t * stack_p,
+  sm_mce_shard_t *shard,
   nw_gtpv2c_ulp_api_t * pUlpApi)
 {
   nw_rc_t                                 rc = NW_OK;
@@ -432,9 +300,8 @@ sm_mce_handle_mbms_session_stop_request(
   uint16_t                                offendingIeLength;
   itti_sm_mbms_session_stop_request_t  *req_p;
   MessageDef                             *message_p;
-  nw_gtpv2c_msg_parser_t                 *pMsgParser;
 
-  DevAssert (stack_p );
+  DevAssert (shard );
 
   teid_t teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
@@ -447,50 +314,21 @@ sm_mce_handle_mbms_session_stop_request(
 		  sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
 
   /*
-   * Create a new message parser for the SM MBMS SESSION STOP REQUEST.
-   */
-  rc = nwGtpv2cMsgParserNew (*stack_p, NW_GTP_MBMS_SESSION_STOP_REQ, sm_ie_indication_generic, NULL, &pMsgParser);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Flow Identifier
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
-	  sm_mbms_flow_identifier_ie_get, &req_p->mbms_flow_id);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS Absolute Time of Data Transfer Stop
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL,
-		  sm_mbms_data_transfer_start_ie_get, &req_p->abs_stop_time);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * MBMS-Flags
-   */
-  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_MBMS_FLAGS, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL,
-	  sm_mbms_flags_ie_get, &req_p->mbms_flags);
-  DevAssert (NW_OK == rc);
-
-  /*
-   * Run the parser
+   * Decode the SM MBMS SESSION STOP REQUEST in a single pass (same validation as the generic message parser).
    */
-  rc = nwGtpv2cMsgParserRun (pMsgParser, (pUlpApi->hMsg), &offendingIeType, &offendingIeInstance, &offendingIeLength);
+  rc = sm_mbms_session_stop_request_decode ((pUlpApi->hMsg), req_p, &offendingIeType, &offendingIeInstance, &offendingIeLength);
 
   if (rc != NW_OK) {
+	  OAILOG_WARNING (LOG_SM, "Discarding MBMS Session Stop Request (rc %d, offending IE type %u instance %u length %u).\n",
+	      rc, offendingIeType, offendingIeInstance, offendingIeLength);
 	  itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
 	  message_p = NULL;
-	  rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
-	  DevAssert (NW_OK == rc);
-	  rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+	  rc = nwGtpv2cMsgDelete (shard->stack_handle, (pUlpApi->hMsg));
 	  DevAssert (NW_OK == rc);
 	  return RETURNerror;
   }
 
-  rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
-  DevAssert (NW_OK == rc);
-  rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+  rc = nwGtpv2cMsgDelete (shard->stack_handle, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
 
   return itti_send_msg_to_task (TASK_MCE_APP, INSTANCE_DEFAULT, message_p);
@@ -499,7 +337,7 @@ sm_mce_handle_mbms_session_stop_request(
 //------------------------------------------------------------------------------
 int
 sm_mce_mbms_session_stop_response (
-    nw_gtpv2c_stack_handle_t *stack_p,
+    sm_mce_shard_t *shard,
     itti_sm_mbms_session_stop_response_t *mbms_session_stop_response_p)
 {
   nw_rc_t                                 rc;
@@ -509,7 +347,7 @@ sm_mce_mbms_session_stop_response (
   OAILOG_FUNC_IN (LOG_SM);
 
   DevAssert (mbms_session_stop_response_p );
-  DevAssert (stack_p );
+  DevAssert (shard );
   trxn = (nw_gtpv2c_trxn_handle_t) mbms_session_stop_response_p->trxn;
   DevAssert (trxn );
   /**
@@ -523,7 +361,7 @@ sm_mce_mbms_session_stop_response (
   ulp_rsp.u_api_info.triggeredRspInfo.hTunnel    = 0;
   ulp_rsp.u_api_info.triggeredRspInfo.hTrxn = trxn;
 
-  hashtable_rc_t hash_rc = hashtable_ts_get(sm_mce_teid_2_gtv2c_teid_handle,
+  hashtable_rc_t hash_rc = hashtable_get(shard->teid_2_tunnel,
 	(hash_key_t) ulp_rsp.u_api_info.triggeredRspInfo.teidLocal, (void **)(uintptr_t)&ulp_rsp.u_api_info.triggeredRspInfo.hTunnel);
 
   if (HASH_TABLE_OK != hash_rc) {
@@ -531,7 +369,7 @@ sm_mce_mbms_session_stop_response (
 	  return RETURNerror;
   }
 
-  rc = nwGtpv2cMsgNew (*stack_p, true, NW_GTP_MBMS_SESSION_STOP_RSP, 0, 0, &(ulp_rsp.hMsg));
+  rc = nwGtpv2cMsgNew (shard->stack_handle, true, NW_GTP_MBMS_SESSION_STOP_RSP, 0, 0, &(ulp_rsp.hMsg));
   DevAssert (NW_OK == rc);
 
   /**
@@ -545,7 +383,7 @@ sm_mce_mbms_session_stop_response (
   DevAssert( NW_OK == rc );
 
   /** No allocated context remains. */
-  rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_rsp);
+  rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_rsp);
   DevAssert (NW_OK == rc);
 
   /** Try to remove the tunnel directly. */
@@ -553,16 +391,21 @@ sm_mce_mbms_session_stop_response (
   nw_gtpv2c_ulp_api_t                         ulp_req;
   memset (&ulp_req, 0, sizeof (nw_gtpv2c_ulp_api_t));
   ulp_req.apiType = NW_GTPV2C_ULP_DELETE_LOCAL_TUNNEL;
-  hash_rc = hashtable_ts_get(sm_mce_teid_2_gtv2c_teid_handle,
+  hash_rc = hashtable_get(shard->teid_2_tunnel,
 		  (hash_key_t) mbms_session_stop_response_p->teid,
 		  (void **)(uintptr_t)&ulp_req.u_api_info.deleteLocalTunnelInfo.hTunnel);
   if (HASH_TABLE_OK != hash_rc) {
   	OAILOG_ERROR (LOG_SM, "Could not get GTPv2-C hTunnel for local teid %X (skipping deletion of tunnel)\n", mbms_session_stop_response_p->teid);
   } else {
-  	rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+  	rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_req);
   	DevAssert (NW_OK == rc);
-  	hash_rc = hashtable_ts_free(sm_mce_teid_2_gtv2c_teid_handle, (hash_key_t) mbms_session_stop_response_p->teid);
+  	hash_rc = hashtable_free(shard->teid_2_tunnel, (hash_key_t) mbms_session_stop_response_p->teid);
   	DevAssert (HASH_TABLE_OK == hash_rc);
+  	sm_mce_peer_t *peer = sm_mce_shard_get_peer(shard, (struct sockaddr *)&mbms_session_stop_response_p->mbms_peer_ip);
+  	/** The services of a restarted MBMS-GW were already released at once. */
+  	if (peer->services) {
+  	  peer->services--;
+  	}
   }
 
   return RETURNok;
@@ -572,12 +415,12 @@ sm_mce_mbms_session_stop_response (
 // todo: evaluate later the error cause in the removal!! --> eventually if something goes wrong here.. check the reason!
 int
 sm_mce_remove_tunnel (
-    nw_gtpv2c_stack_handle_t *stack_p, itti_sm_remove_tunnel_t * remove_tunnel_p)
+    sm_mce_shard_t *shard, itti_sm_remove_tunnel_t * remove_tunnel_p)
 {
   OAILOG_FUNC_IN (LOG_SM);
   nw_rc_t                                   rc = NW_OK;
   hashtable_rc_t                          hash_rc = HASH_TABLE_OK;
-  DevAssert (stack_p );
+  DevAssert (shard );
   DevAssert (remove_tunnel_p );
   MSC_LOG_RX_MESSAGE (MSC_SM_MME, MSC_SGW, NULL, 0, "Removing SM Tunnels for local SM teid " TEID_FMT " ",
       remove_tunnel_p->local_teid);
@@ -590,7 +433,7 @@ sm_mce_remove_tunnel (
     OAILOG_FUNC_RETURN(LOG_SM, rc);
   }
 
-  hash_rc = hashtable_ts_get(sm_mce_teid_2_gtv2c_teid_handle,
+  hash_rc = hashtable_get(shard->teid_2_tunnel,
       (hash_key_t) remove_tunnel_p->local_teid,
       (void **)(uintptr_t)&ulp_req.u_api_info.deleteLocalTunnelInfo.hTunnel);
   if (HASH_TABLE_OK != hash_rc) {
@@ -611,7 +454,7 @@ sm_mce_remove_tunnel (
     ulp_req.apiType = NW_GTPV2C_ULP_FIND_LOCAL_TUNNEL;
     ulp_req.u_api_info.findLocalTunnelInfo.teidLocal = remove_tunnel_p->local_teid;
     ulp_req.u_api_info.findLocalTunnelInfo.edns_peer_ip = &remove_tunnel_p->mbms_peer_ip;
-    rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+    rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_req);
     DevAssert (NW_OK == rc);
     if(ulp_req.u_api_info.findLocalTunnelInfo.hTunnel){
       OAILOG_ERROR (LOG_SM, "Could FIND A GTPv2-C hTunnel for local teid " TEID_FMT " @ DELETION \n", remove_tunnel_p->local_teid);
@@ -624,7 +467,7 @@ sm_mce_remove_tunnel (
 
     ulp_req.apiType = NW_GTPV2C_ULP_DELETE_LOCAL_TUNNEL;
 
-    rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+    rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_req);
     DevAssert (NW_OK == rc);
     OAILOG_INFO(LOG_SM, "DELETED local SM teid (TEID FOUND IN HASH_MAP)" TEID_FMT " \n", remove_tunnel_p->local_teid);
 
@@ -633,7 +476,7 @@ sm_mce_remove_tunnel (
     ulp_req.apiType = NW_GTPV2C_ULP_FIND_LOCAL_TUNNEL;
     ulp_req.u_api_info.findLocalTunnelInfo.teidLocal = remove_tunnel_p->local_teid;
     ulp_req.u_api_info.findLocalTunnelInfo.edns_peer_ip = &remove_tunnel_p->mbms_peer_ip;
-    rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+    rc = nwGtpv2cProcessUlpReq (shard->stack_handle, &ulp_req);
     DevAssert (NW_OK == rc);
     if(ulp_req.u_api_info.findLocalTunnelInfo.hTunnel){
       OAILOG_WARNING (LOG_SM, "Could FIND A GTPv2-C hTunnel for local teid " TEID_FMT " @ DELETION (2) \n", remove_tunnel_p->local_teid);
@@ -646,8 +489,13 @@ sm_mce_remove_tunnel (
      * The value is removed from the map. But the value itself (int) is not freed.
      * The Tunnels are not deallocated but just set back to the Tunnel pool.
      */
-    hash_rc = hashtable_ts_free(sm_mce_teid_2_gtv2c_teid_handle, (hash_key_t) remove_tunnel_p->local_teid);
+    hash_rc = hashtable_free(shard->teid_2_tunnel, (hash_key_t) remove_tunnel_p->local_teid);
     DevAssert (HASH_TABLE_OK == hash_rc);
+    sm_mce_peer_t *peer = sm_mce_shard_get_peer(shard, (struct sockaddr *)&remove_tunnel_p->mbms_peer_ip);
+    /** The services of a restarted MBMS-GW were already released at once. */
+    if (peer->services) {
+      peer->services--;
+    }
 
     OAILOG_DEBUG(LOG_SM, "Successfully removed SM Tunnel local teid " TEID_FMT ".\n", remove_tunnel_p->local_teid);
     OAILOG_FUNC_RETURN(LOG_SM, RETURNok);
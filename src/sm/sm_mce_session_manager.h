@@ -35,32 +35,32 @@
  */
 
 /* @brief Handle an MBMS Session Start Request received from MBMS-GW. */
-int sm_mce_handle_mbms_session_start_request(nw_gtpv2c_stack_handle_t * stack_p, nw_gtpv2c_ulp_api_t * pUlpApi);
+int sm_mce_handle_mbms_session_start_request(sm_mce_shard_t *shard, nw_gtpv2c_ulp_api_t * pUlpApi);
 
 /* @brief Create a new MBMS Session Start Response and send it to provided MBMS-GW. */
-int sm_mce_mbms_session_start_response(nw_gtpv2c_stack_handle_t *stack_p,     itti_sm_mbms_session_start_response_t *mbms_session_start_rsp_p);
+int sm_mce_mbms_session_start_response(sm_mce_shard_t *shard,     itti_sm_mbms_session_start_response_t *mbms_session_start_rsp_p);
 
 /**
  * MBMS SESSION UPDATE REQUEST
  */
 
 /* @brief Handle an MBMS Session Update Request received from MBMS-GW. */
-int sm_mce_handle_mbms_session_update_request(nw_gtpv2c_stack_handle_t * stack_p, nw_gtpv2c_ulp_api_t * pUlpApi);
+int sm_mce_handle_mbms_session_update_request(sm_mce_shard_t *shard, nw_gtpv2c_ulp_api_t * pUlpApi);
 
 /* @brief Create a new MBMS Session Update Response and send it to provided MBMS-GW. */
-int sm_mce_mbms_session_update_response(nw_gtpv2c_stack_handle_t *stack_p,     itti_sm_mbms_session_update_response_t *mbms_session_update_rsp_p);
+int sm_mce_mbms_session_update_response(sm_mce_shard_t *shard,     itti_sm_mbms_session_update_response_t *mbms_session_update_rsp_p);
 
 /**
  * MBMS SESSION STOP REQUEST
  */
 
 /* @brief Handle an MBMS Session Stop Request received from MBMS-GW. */
-int sm_mce_handle_mbms_session_stop_request(nw_gtpv2c_stack_handle_t * stack_p, nw_gtpv2c_ulp_api_t * pUlpApi);
+int sm_mce_handle_mbms_session_stop_request(sm_mce_shard_t *shard, nw_gtpv2c_ulp_api_t * pUlpApi);
 
 /* @brief Create a new MBMS Session Stop Response and send it to provided MBMS-GW. */
-int sm_mce_mbms_session_stop_response(nw_gtpv2c_stack_handle_t *stack_p,     itti_sm_mbms_session_stop_response_t *mbms_session_stop_rsp_p);
+int sm_mce_mbms_session_stop_response(sm_mce_shard_t *shard,     itti_sm_mbms_session_stop_response_t *mbms_session_stop_rsp_p);
 
 /** Remove Tunnel in unexpected situations. */
-int sm_mce_remove_tunnel ( nw_gtpv2c_stack_handle_t *stack_p, itti_sm_remove_tunnel_t * remove_tunnel_p);
+int sm_mce_remove_tunnel ( sm_mce_shard_t *shard, itti_sm_remove_tunnel_t * remove_tunnel_p);
 
 #endif /* FILE_SM_MCE_SESSION_MANAGER_SEEN */
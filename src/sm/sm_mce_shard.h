@@ -0,0 +1,128 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_mce_shard.h
+* \brief Shards of the Sm task.
+* Each shard runs its own GTPv2-C stack instance for the MBMS-GWs whose address hashes to it. A peer always stays with
+* the same shard, which owns its transactions, its tunnels and thereby its MBMS services. With more than one shard,
+* each shard has its own thread and the Sm task only dispatches the messages, such that a slow peer only delays the
+* peers of its own shard.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+*/
+
+#ifndef FILE_SM_MCE_SHARD_SEEN
+#define FILE_SM_MCE_SHARD_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "sm_mce_path.h"
+
+#define SM_MCE_SHARDS_MAX                 (64)
+
+typedef enum {
+  SM_MCE_PEER_REQUEST_START = 0,
+  SM_MCE_PEER_REQUEST_UPDATE,
+  SM_MCE_PEER_REQUEST_STOP,
+  SM_MCE_PEER_REQUEST_MAX,
+} sm_mce_peer_request_t;
+
+typedef struct sm_mce_peer_stats_s {
+  uint64_t  requests[SM_MCE_PEER_REQUEST_MAX];          ///< MBMS Session requests given to MCE_APP
+  uint64_t  discarded;                                  ///< Requests which could not be decoded
+  uint64_t  responses;                                  ///< Responses sent to the MBMS-GW
+  uint64_t  datagrams_in;
+  uint64_t  bytes_in;
+  uint64_t  datagrams_out;
+  uint64_t  bytes_out;
+  /** From the Sm task taking the request until the response is sent (queueing in the shard included). */
+  uint64_t  latency_count;
+  uint64_t  latency_sum_us;
+  uint64_t  latency_max_us;
+  /** Path supervision. */
+  uint64_t  echo_requests;                              ///< Echo Requests sent, retransmissions included
+  uint64_t  echo_responses;
+  uint64_t  path_failures;
+  uint64_t  restarts;                                   ///< Changed restart counters of the MBMS-GW
+} sm_mce_peer_stats_t;
+
+/** An MBMS-GW served by a shard, identified by its address (any port). */
+typedef struct sm_mce_peer_s {
+  sm_mce_path_t             path;                       ///< Address and supervision, driven by the shared echo timer of the Sm task
+  uint32_t                  services;                   ///< Local Sm tunnels (MBMS services) of the peer
+
+  sm_mce_peer_stats_t       total;
+  sm_mce_peer_stats_t       interval;                   ///< Since the last report
+} sm_mce_peer_t;
+
+struct sm_mce_shared_message_s;
+
+typedef enum {
+  SM_MCE_JOB_MESSAGE = 0,                               ///< Handle the message and release it
+  SM_MCE_JOB_REPORT,                                    ///< Report the peer metrics
+  SM_MCE_JOB_ECHO,                                      ///< Send the Echo Requests due to the peers
+} sm_mce_job_type_t;
+
+/** A message of the Sm task handed to a shard. */
+typedef struct sm_mce_job_s {
+  sm_mce_job_type_t                  type;
+  MessageDef                        *message;           ///< Only with SM_MCE_JOB_MESSAGE
+  uint64_t                           received_ns;       ///< When the Sm task took the message
+  struct sm_mce_shared_message_s    *shared;            ///< Set if the datagrams of the message are split among shards
+} sm_mce_job_t;
+
+typedef struct sm_mce_shard_s {
+  int                         index;
+  nw_gtpv2c_stack_handle_t    stack_handle;
+  hash_table_t               *teid_2_tunnel;            ///< MBMS services of the shard: local Sm TEID to GTPv2-C tunnel
+  hash_table_t               *trxn_2_received_ns;       ///< Pending requests of the MBMS-GWs, by transaction, for the latency
+  uint64_t                    received_ns;              ///< Of the message being handled
+
+  /** Only a handful of MBMS-GWs are expected per shard. */
+  sm_mce_peer_t              *peers;
+  int                         nb_peers;
+  int                         size_peers;
+  int                         last_peer;
+
+  /** The stack runs a single timer at a time, armed with the shard as argument. Only used by the shard thread. */
+  long                        timer_id;
+  void                       *timer_arg;                ///< Timeout argument of the stack
+
+  /** Jobs queued by the Sm task. The shard thread takes all of them at once. Unused with a single shard. */
+  pthread_t                   thread;
+  pthread_mutex_t             mutex;
+  pthread_cond_t              cond;
+  sm_mce_job_t               *jobs;
+  int                         nb_jobs;
+  int                         size_jobs;
+  int                         max_queued;               ///< Largest backlog since the last report
+  bool                        terminate;
+} sm_mce_shard_t;
+
+/* @brief Peer entry of an MBMS-GW in a shard, created on first use. Only valid until the next call. */
+sm_mce_peer_t *sm_mce_shard_get_peer(sm_mce_shard_t *shard, const struct sockaddr *address);
+
+#endif /* FILE_SM_MCE_SHARD_SEEN */
@@ -28,12 +28,16 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
 #include <pthread.h>
 #include <assert.h>
 #include <errno.h>
+#include <time.h>
+#include <arpa/inet.h>
 
 #include "bstrlib.h"
 
@@ -47,15 +51,170 @@
 #include "timer.h"
 #include "NwLog.h"
 #include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
 #include "NwGtpv2cMsg.h"
+#include "NwGtpv2cHash.h"
 #include "sm_mce.h"
+#include "sm_mce_shard.h"
 #include "sm_mce_session_manager.h"
+#include "sm_record.h"
 
-static nw_gtpv2c_stack_handle_t             sm_mce_stack_handle = 0;
-// Store the GTPv2-C teid handle
-hash_table_ts_t                        *sm_mce_teid_2_gtv2c_teid_handle = NULL;
+/**
+ * A batch of datagrams whose peers belong to several shards. Each of them handles its own datagrams, the last one
+ * releases the message.
+ */
+typedef struct sm_mce_shared_message_s {
+  MessageDef                             *message;
+  int                                     refs;
+  uint8_t                                 shard_of[];   ///< Shard of each datagram
+} sm_mce_shared_message_t;
+
+static sm_mce_shard_t                      *sm_mce_shards = NULL;
+static int                                  sm_mce_nb_shards = 0;
+/** Periodic report of the peer metrics. */
+static long                                 sm_mce_report_timer_id = 0;
+static uint32_t                             sm_mce_report_interval_sec = 0;
+/** Path supervision of the MBMS-GWs: a single periodic timer, each shard sends the Echo Requests due to its peers. */
+static long                                 sm_mce_echo_timer_id = 0;
+static sm_mce_path_config_t                 sm_mce_path_config = {0};
+/** Recording of the Sm datagrams, received ones written by the Sm task, sent ones by the shards. */
+static sm_recorder_t                        sm_mce_recorder;
+/** Sm addresses, the source of the datagrams sent. Other sockets of the UDP task may share the Sm port. */
+static struct in_addr                       sm_mce_local_v4;
+static struct in6_addr                      sm_mce_local_v6;
 static void sm_exit(void);
 
+//------------------------------------------------------------------------------
+static uint64_t sm_mce_now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int sm_mce_shard_index (const struct sockaddr *address)
+{
+  if (sm_mce_nb_shards == 1) {
+    return 0;
+  }
+  return (int)(nwGtpv2cHashPeer (0, address) % (uint32_t)sm_mce_nb_shards);
+}
+
+//------------------------------------------------------------------------------
+static bool sm_mce_peer_address_equal (const struct sockaddr *a, const struct sockaddr_storage *b)
+{
+  if (a->sa_family != b->ss_family) {
+    return false;
+  }
+  if (a->sa_family == AF_INET6) {
+    return !memcmp (&((const struct sockaddr_in6 *)a)->sin6_addr, &((const struct sockaddr_in6 *)b)->sin6_addr, sizeof (struct in6_addr));
+  }
+  return ((const struct sockaddr_in *)a)->sin_addr.s_addr == ((const struct sockaddr_in *)b)->sin_addr.s_addr;
+}
+
+//------------------------------------------------------------------------------
+sm_mce_peer_t *sm_mce_shard_get_peer (sm_mce_shard_t *shard, const struct sockaddr *address)
+{
+  sm_mce_peer_t                          *peer = NULL;
+
+  if (shard->last_peer < shard->nb_peers && sm_mce_peer_address_equal (address, &shard->peers[shard->last_peer].path.address)) {
+    return &shard->peers[shard->last_peer];
+  }
+  for (int i = 0; i < shard->nb_peers; i++) {
+    if (sm_mce_peer_address_equal (address, &shard->peers[i].path.address)) {
+      shard->last_peer = i;
+      return &shard->peers[i];
+    }
+  }
+  if (shard->nb_peers == shard->size_peers) {
+    const int                             size = shard->size_peers ? 2 * shard->size_peers : 8;
+    sm_mce_peer_t                        *peers = realloc (shard->peers, size * sizeof (sm_mce_peer_t));
+
+    DevAssert (peers);
+    shard->peers = peers;
+    shard->size_peers = size;
+  }
+  peer = &shard->peers[shard->nb_peers];
+  memset (peer, 0, sizeof (*peer));
+  sm_mce_path_init (&peer->path, address);
+  shard->last_peer = shard->nb_peers++;
+  return peer;
+}
+
+//------------------------------------------------------------------------------
+static void sm_mce_peer_add_latency (sm_mce_peer_stats_t *stats, uint64_t latency_us)
+{
+  stats->responses++;
+  stats->latency_count++;
+  stats->latency_sum_us += latency_us;
+  if (latency_us > stats->latency_max_us) {
+    stats->latency_max_us = latency_us;
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Account the response of MCE_APP to a request of an MBMS-GW. The receive time of the request is kept by transaction
+ * and released with the response, whether it could be sent or not: the transaction is not handed back afterwards.
+ */
+static void sm_mce_shard_account_response (sm_mce_shard_t *shard, const struct sockaddr *address, void *trxn, const bool sent)
+{
+  sm_mce_peer_t                          *peer = sm_mce_shard_get_peer (shard, address);
+  void                                   *received_ns = NULL;
+
+  if (trxn && hashtable_get (shard->trxn_2_received_ns, (hash_key_t)(uintptr_t)trxn, &received_ns) == HASH_TABLE_OK) {
+    const uint64_t                        latency_us = (sm_mce_now_ns () - (uint64_t)(uintptr_t)received_ns) / 1000;
+
+    hashtable_free (shard->trxn_2_received_ns, (hash_key_t)(uintptr_t)trxn);
+    if (sent) {
+      sm_mce_peer_add_latency (&peer->total, latency_us);
+      sm_mce_peer_add_latency (&peer->interval, latency_us);
+    }
+  } else if (sent) {
+    peer->total.responses++;
+    peer->interval.responses++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void sm_mce_shard_report (sm_mce_shard_t *shard, const bool total)
+{
+  int                                     max_queued = 0;
+
+  for (int i = 0; i < shard->nb_peers; i++) {
+    sm_mce_peer_t                        *peer = &shard->peers[i];
+    sm_mce_peer_stats_t                  *stats = total ? &peer->total : &peer->interval;
+    const uint64_t                        requests = stats->requests[SM_MCE_PEER_REQUEST_START] + stats->requests[SM_MCE_PEER_REQUEST_UPDATE]
+                                                   + stats->requests[SM_MCE_PEER_REQUEST_STOP];
+    char                                  address[INET6_ADDRSTRLEN];
+
+    inet_ntop (peer->path.address.ss_family, peer->path.address.ss_family == AF_INET6 ? (void *)&((struct sockaddr_in6 *)&peer->path.address)->sin6_addr
+        : (void *)&((struct sockaddr_in *)&peer->path.address)->sin_addr, address, sizeof (address));
+    OAILOG_INFO (LOG_SM, "Sm peer %s (shard %d) %s: %u services, %" PRIu64 " requests (%" PRIu64 " start, %" PRIu64 " update, %" PRIu64 " stop"
+        ", %" PRIu64 "/s), %" PRIu64 " discarded, %" PRIu64 " responses, latency avg %" PRIu64 " us max %" PRIu64 " us"
+        ", in %" PRIu64 " datagrams %" PRIu64 " bytes, out %" PRIu64 " datagrams %" PRIu64 " bytes"
+        ", echo %" PRIu64 "/%" PRIu64 " answered, %" PRIu64 " path failures, %" PRIu64 " restarts, path %s\n",
+        address, shard->index, total ? "in total" : "since the last report", peer->services, requests,
+        stats->requests[SM_MCE_PEER_REQUEST_START], stats->requests[SM_MCE_PEER_REQUEST_UPDATE], stats->requests[SM_MCE_PEER_REQUEST_STOP],
+        (!total && sm_mce_report_interval_sec) ? requests / sm_mce_report_interval_sec : 0, stats->discarded, stats->responses,
+        stats->latency_count ? stats->latency_sum_us / stats->latency_count : 0, stats->latency_max_us,
+        stats->datagrams_in, stats->bytes_in, stats->datagrams_out, stats->bytes_out,
+        stats->echo_responses, stats->echo_requests, stats->path_failures, stats->restarts, peer->path.path_down ? "down" : "up");
+    if (!total) {
+      memset (stats, 0, sizeof (*stats));
+    }
+  }
+  if (sm_mce_nb_shards > 1) {
+    pthread_mutex_lock (&shard->mutex);
+    max_queued = shard->max_queued;
+    shard->max_queued = 0;
+    pthread_mutex_unlock (&shard->mutex);
+    OAILOG_INFO (LOG_SM, "Sm shard %d: %d peers, largest backlog %d messages\n", shard->index, shard->nb_peers, max_queued);
+  }
+}
+
 //------------------------------------------------------------------------------
 static nw_rc_t
 sm_mce_log_wrapper (
@@ -77,6 +236,8 @@ sm_mce_ulp_process_stack_req_cb (
   nw_gtpv2c_ulp_api_t * pUlpApi)
 {
   //     nw_rc_t rc = NW_OK;
+  sm_mce_shard_t                         *shard = (sm_mce_shard_t *)hUlp;
+  sm_mce_peer_request_t                   request = SM_MCE_PEER_REQUEST_MAX;
   int                                     ret = 0;
 
   DevAssert (pUlpApi );
@@ -87,20 +248,36 @@ sm_mce_ulp_process_stack_req_cb (
 
     switch (pUlpApi->u_api_info.initialReqIndInfo.msgType) {
     case NW_GTP_MBMS_SESSION_START_REQ:
-      ret = sm_mce_handle_mbms_session_start_request(&sm_mce_stack_handle, pUlpApi);
+      request = SM_MCE_PEER_REQUEST_START;
+      ret = sm_mce_handle_mbms_session_start_request(shard, pUlpApi);
       break;
     case NW_GTP_MBMS_SESSION_UPDATE_REQ:
-      ret = sm_mce_handle_mbms_session_update_request(&sm_mce_stack_handle, pUlpApi);
+      request = SM_MCE_PEER_REQUEST_UPDATE;
+      ret = sm_mce_handle_mbms_session_update_request(shard, pUlpApi);
       break;
 
     case NW_GTP_MBMS_SESSION_STOP_REQ:
-      ret = sm_mce_handle_mbms_session_stop_request(&sm_mce_stack_handle, pUlpApi);
+      request = SM_MCE_PEER_REQUEST_STOP;
+      ret = sm_mce_handle_mbms_session_stop_request(shard, pUlpApi);
       break;
 
     default:
       OAILOG_WARNING (LOG_SM, "Received unhandled message type %d\n", pUlpApi->u_api_info.triggeredRspIndInfo.msgType);
       break;
     }
+    if (request != SM_MCE_PEER_REQUEST_MAX) {
+      sm_mce_peer_t                      *peer = sm_mce_shard_get_peer (shard, pUlpApi->u_api_info.initialReqIndInfo.peerIp);
+
+      if (ret == 0) {
+        peer->total.requests[request]++;
+        peer->interval.requests[request]++;
+        hashtable_insert (shard->trxn_2_received_ns, (hash_key_t)(uintptr_t)pUlpApi->u_api_info.initialReqIndInfo.hTrxn,
+            (void *)(uintptr_t)shard->received_ns);
+      } else {
+        peer->total.discarded++;
+        peer->interval.discarded++;
+      }
+    }
     break;
 
   case NW_GTPV2C_ULP_API_TRIGGERED_RSP_IND:
@@ -132,15 +309,38 @@ sm_mce_send_udp_msg (
   // Create and alloc new message
   MessageDef                             *message_p;
   udp_data_req_t                         *udp_data_req_p;
+  sm_mce_peer_t                          *peer = sm_mce_shard_get_peer ((sm_mce_shard_t *)udpHandle, peerIpAddr);
   int                                     ret = 0;
 
+  if (buffer_len > UDP_DATA_MAX_MSG_LEN) {
+    OAILOG_ERROR (LOG_SM, "Not sending GTPv2-C message of size %u, longer than %d bytes\n", buffer_len, UDP_DATA_MAX_MSG_LEN);
+    return NW_FAILURE;
+  }
+  /** The stack releases the message and may trim it from its pool once we return, the UDP task sends a copy. */
   message_p = itti_alloc_new_message (TASK_SM, UDP_DATA_REQ);
   udp_data_req_p = &message_p->ittiMsg.udp_data_req;
   udp_data_req_p->local_port = localPort;
-  udp_data_req_p->peer_address = peerIpAddr;
+  if (peerIpAddr->sa_family == AF_INET6) {
+    udp_data_req_p->peer_address.addrv6 = *(struct sockaddr_in6 *)peerIpAddr;
+    if (!IN6_IS_ADDR_UNSPECIFIED (&sm_mce_local_v6)) {
+      udp_data_req_p->local_address.addrv6.sin6_family = AF_INET6;
+      udp_data_req_p->local_address.addrv6.sin6_addr = sm_mce_local_v6;
+    }
+  } else {
+    udp_data_req_p->peer_address.addrv4 = *(struct sockaddr_in *)peerIpAddr;
+    if (sm_mce_local_v4.s_addr) {
+      udp_data_req_p->local_address.addrv4.sin_family = AF_INET;
+      udp_data_req_p->local_address.addrv4.sin_addr = sm_mce_local_v4;
+    }
+  }
   udp_data_req_p->peer_port = peerPort;
-  udp_data_req_p->buffer = buffer;
+  memcpy (udp_data_req_p->buffer, buffer, buffer_len);
   udp_data_req_p->buffer_length = buffer_len;
+  sm_recorder_write (&sm_mce_recorder, SM_RECORD_DIRECTION_OUT, peerIpAddr, peerPort, buffer, buffer_len);
+  peer->total.datagrams_out++;
+  peer->total.bytes_out += buffer_len;
+  peer->interval.datagrams_out++;
+  peer->interval.bytes_out += buffer_len;
 
   ret = itti_send_msg_to_task (TASK_UDP, INSTANCE_DEFAULT, message_p);
   return ((ret == 0) ? NW_OK : NW_FAILURE);
@@ -156,15 +356,19 @@ sm_mce_start_timer_wrapper (
   void *timeoutArg,
   nw_gtpv2c_timer_handle_t * hTmr)
 {
+  sm_mce_shard_t                         *shard = (sm_mce_shard_t *)tmrMgrHandle;
   long                                    timer_id;
   int                                     ret = 0;
 
   if (tmrType == NW_GTPV2C_TMR_TYPE_REPETITIVE) {
-    ret = timer_setup (timeoutSec, timeoutUsec, TASK_SM, INSTANCE_DEFAULT, TIMER_PERIODIC, timeoutArg, &timer_id);
+    ret = timer_setup (timeoutSec, timeoutUsec, TASK_SM, INSTANCE_DEFAULT, TIMER_PERIODIC, shard, &timer_id);
   } else {
-    ret = timer_setup (timeoutSec, timeoutUsec, TASK_SM, INSTANCE_DEFAULT, TIMER_ONE_SHOT, timeoutArg, &timer_id);
+    ret = timer_setup (timeoutSec, timeoutUsec, TASK_SM, INSTANCE_DEFAULT, TIMER_ONE_SHOT, shard, &timer_id);
   }
 
+  /** The expiry is routed to the shard by the timer argument, it may fire before timer_setup returns. */
+  shard->timer_id = (ret == 0) ? timer_id : 0;
+  shard->timer_arg = (ret == 0) ? timeoutArg : NULL;
   *hTmr = (nw_gtpv2c_timer_handle_t) timer_id;
   return ((ret == 0) ? NW_OK : NW_FAILURE);
 }
@@ -175,13 +379,333 @@ sm_mce_stop_timer_wrapper (
   nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
   nw_gtpv2c_timer_handle_t tmrHandle)
 {
+  sm_mce_shard_t                         *shard = (sm_mce_shard_t *)tmrMgrHandle;
   long                                    timer_id;
   void                                   *timeoutArg = NULL;
 
   timer_id = (long)tmrHandle;
+  if (shard->timer_id == timer_id) {
+    shard->timer_id = 0;
+    shard->timer_arg = NULL;
+  }
   return ((timer_remove (timer_id, &timeoutArg) == 0) ? NW_OK : NW_FAILURE);
 }
 
+//------------------------------------------------------------------------------
+static void sm_mce_shard_release_tunnel (void *arg, uint32_t teid_local)
+{
+  hashtable_free (((sm_mce_shard_t *)arg)->teid_2_tunnel, (hash_key_t)teid_local);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Account the events of the path supervision of a peer. On a restart of the MBMS-GW, its transactions and tunnels
+ * were released in the stack: MCE_APP is told to release its MBMS services at once, without MBMS Session Stop Requests
+ * of the MBMS-GW.
+ */
+static void sm_mce_shard_path_events (sm_mce_shard_t *shard, sm_mce_peer_t *peer, const sm_mce_path_events_t *events)
+{
+  MessageDef                             *message_p = NULL;
+  itti_sm_mbms_gw_restart_ind_t          *restart_ind_p = NULL;
+
+  if (events->echo_request) {
+    peer->total.echo_requests++;
+    peer->interval.echo_requests++;
+  }
+  if (events->echo_request_failed) {
+    OAILOG_ERROR (LOG_SM, "Could not send an Echo Request from Sm shard %d\n", shard->index);
+  }
+  if (events->echo_response) {
+    peer->total.echo_responses++;
+    peer->interval.echo_responses++;
+  }
+  if (events->path_restored) {
+    OAILOG_INFO (LOG_SM, "Sm path to the MBMS-GW of shard %d restored\n", shard->index);
+  }
+  if (events->path_failure) {
+    peer->total.path_failures++;
+    peer->interval.path_failures++;
+    OAILOG_WARNING (LOG_SM, "Sm path to an MBMS-GW of shard %d is down, dropped %u pending transactions, %u services kept\n",
+        shard->index, events->nb_trxns, peer->services);
+  }
+  if (!events->restart) {
+    return;
+  }
+  OAILOG_WARNING (LOG_SM, "MBMS-GW of Sm shard %d restarted (restart counter %u -> %u), released %u of its %u services\n",
+      shard->index, events->old_recovery, peer->path.recovery, events->nb_tunnels, peer->services);
+  peer->total.restarts++;
+  peer->interval.restarts++;
+  peer->services = (events->nb_tunnels < peer->services) ? peer->services - events->nb_tunnels : 0;
+
+  message_p = itti_alloc_new_message (TASK_SM, SM_MBMS_GW_RESTART_IND);
+  DevAssert (message_p);
+  restart_ind_p = &message_p->ittiMsg.sm_mbms_gw_restart_ind;
+  memcpy ((void*)&restart_ind_p->mbms_peer_ip, &peer->path.address,
+      peer->path.address.ss_family == AF_INET6 ? sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in));
+  restart_ind_p->restart_counter = peer->path.recovery;
+  restart_ind_p->nb_tunnels = events->nb_tunnels;
+  itti_send_msg_to_task (TASK_MCE_APP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void sm_mce_shard_handle_datagram (
+  sm_mce_shard_t *shard,
+  uint8_t *buffer,
+  uint32_t length,
+  uint16_t local_port,
+  uint16_t peer_port,
+  struct sockaddr *peer_address)
+{
+  sm_mce_peer_t                          *peer = sm_mce_shard_get_peer (shard, peer_address);
+  sm_mce_path_events_t                    events;
+  bool                                    echo_response = false;
+  nw_rc_t                                 rc;
+
+  peer->total.datagrams_in++;
+  peer->total.bytes_in += length;
+  peer->interval.datagrams_in++;
+  peer->interval.bytes_in += length;
+  echo_response = sm_mce_path_receive (&peer->path, &sm_mce_path_config, shard->stack_handle, buffer, length, peer_port,
+      sm_mce_now_ns (), sm_mce_shard_release_tunnel, shard, &events);
+  sm_mce_shard_path_events (shard, peer, &events);
+  if (echo_response) {
+    return;
+  }
+  rc = nwGtpv2cProcessUdpReq (shard->stack_handle, buffer, length, local_port, peer_port, peer_address);
+  DevAssert (rc == NW_OK);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Send the Echo Requests due to the peers of a shard and retransmit the unanswered ones.
+ */
+static void sm_mce_shard_supervise (sm_mce_shard_t *shard, uint64_t now_ns)
+{
+  sm_mce_path_events_t                    events;
+
+  for (int i = 0; i < shard->nb_peers; i++) {
+    sm_mce_path_supervise (&shard->peers[i].path, &sm_mce_path_config, shard->stack_handle, now_ns, &events);
+    sm_mce_shard_path_events (shard, &shard->peers[i], &events);
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Handle a message of the Sm task in its shard and release it.
+ */
+static void sm_mce_shard_handle (sm_mce_shard_t *shard, sm_mce_job_t *job)
+{
+  MessageDef                             *received_message_p = job->message;
+
+  if (job->type == SM_MCE_JOB_REPORT) {
+    sm_mce_shard_report (shard, false);
+    return;
+  } else if (job->type == SM_MCE_JOB_ECHO) {
+    sm_mce_shard_supervise (shard, job->received_ns);
+    return;
+  }
+  shard->received_ns = job->received_ns;
+
+  switch (ITTI_MSG_ID (received_message_p)) {
+  /** Only the signals to send. */
+
+  case SM_MBMS_SESSION_START_RESPONSE:{
+    itti_sm_mbms_session_start_response_t *response_p = &received_message_p->ittiMsg.sm_mbms_session_start_response;
+    const bool                              sent = (sm_mce_mbms_session_start_response (shard, response_p) == RETURNok);
+
+    sm_mce_shard_account_response (shard, (struct sockaddr *)&response_p->mbms_peer_ip, response_p->trxn, sent);
+  }
+  break;
+
+  case SM_MBMS_SESSION_UPDATE_RESPONSE:{
+    itti_sm_mbms_session_update_response_t *response_p = &received_message_p->ittiMsg.sm_mbms_session_update_response;
+    const bool                              sent = (sm_mce_mbms_session_update_response (shard, response_p) == RETURNok);
+
+    sm_mce_shard_account_response (shard, (struct sockaddr *)&response_p->mbms_peer_ip, response_p->trxn, sent);
+  }
+  break;
+
+  case SM_MBMS_SESSION_STOP_RESPONSE:{
+    itti_sm_mbms_session_stop_response_t *response_p = &received_message_p->ittiMsg.sm_mbms_session_stop_response;
+    const bool                              sent = (sm_mce_mbms_session_stop_response (shard, response_p) == RETURNok);
+
+    sm_mce_shard_account_response (shard, (struct sockaddr *)&response_p->mbms_peer_ip, response_p->trxn, sent);
+  }
+  break;
+
+  /**
+   * Use this message in case of an error to remove the SM Local Tunnel endpoints.
+   * No response to MME_APP is sent/expected.
+   */
+  case SM_REMOVE_TUNNEL:{
+    sm_mce_remove_tunnel(shard, &received_message_p->ittiMsg.sm_remove_tunnel);
+  }
+  break;
+
+  case UDP_DATA_IND:{
+    /*
+     * We received new data to handle from the UDP layer
+     */
+    udp_data_ind_t                         *udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
+
+    sm_mce_shard_handle_datagram (shard, udp_data_ind->msgBuf, udp_data_ind->buffer_length, udp_data_ind->local_port,
+        udp_data_ind->peer_port, (struct sockaddr *)&udp_data_ind->sock_addr);
+  }
+  break;
+
+  case UDP_DATA_MULTI_IND:{
+    /*
+     * Batch of datagrams read from one socket, the ones of the shard handled in the order received
+     */
+    udp_data_multi_ind_t                   *udp_data_multi_ind = &received_message_p->ittiMsg.udp_data_multi_ind;
+
+    for (uint32_t i = 0; i < udp_data_multi_ind->nb_datagrams; i++) {
+      udp_datagram_t                       *datagram = &udp_data_multi_ind->datagrams[i];
+
+      if (job->shared && job->shared->shard_of[i] != shard->index) {
+        continue;
+      }
+      sm_mce_shard_handle_datagram (shard, datagram->buffer, datagram->buffer_length, udp_data_multi_ind->local_port,
+          datagram->peer_port, (struct sockaddr *)&datagram->sock_addr);
+    }
+  }
+  break;
+
+  case TIMER_HAS_EXPIRED:{
+      const long                              timer_id = received_message_p->ittiMsg.timer_has_expired.timer_id;
+
+      if (timer_id != shard->timer_id) {
+        /** Stopped or replaced by the stack meanwhile. */
+        OAILOG_DEBUG (LOG_SM, "Ignoring the expiry of the stopped timer_id 0x%lx\n", timer_id);
+        break;
+      }
+      OAILOG_DEBUG (LOG_SM, "Processing timeout for timer_id 0x%lx and arg %p\n", timer_id, shard->timer_arg);
+      DevAssert (nwGtpv2cProcessTimeout (shard->timer_arg) == NW_OK);
+    }
+  break;
+
+  default:{
+  	OAILOG_ERROR (LOG_SM, "Unknown message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+  }
+  break;
+  }
+
+  if (job->shared) {
+    if (__sync_sub_and_fetch (&job->shared->refs, 1)) {
+      return;
+    }
+    free_wrapper ((void**)&job->shared);
+  }
+  itti_free_msg_content(received_message_p);
+  itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+}
+
+//------------------------------------------------------------------------------
+static void *sm_mce_shard_thread (void *args)
+{
+  sm_mce_shard_t                         *shard = (sm_mce_shard_t *)args;
+  sm_mce_job_t                           *jobs = NULL;
+  int                                     size_jobs = 0;
+
+  pthread_mutex_lock (&shard->mutex);
+  while (1) {
+    while (!shard->nb_jobs && !shard->terminate) {
+      pthread_cond_wait (&shard->cond, &shard->mutex);
+    }
+    if (!shard->nb_jobs) {
+      break;
+    }
+    /** Take the whole backlog, the Sm task continues with the spare array. */
+    sm_mce_job_t                         *taken = shard->jobs;
+    const int                             nb_jobs = shard->nb_jobs;
+    const int                             size_taken = shard->size_jobs;
+
+    shard->jobs = jobs;
+    shard->size_jobs = size_jobs;
+    shard->nb_jobs = 0;
+    pthread_mutex_unlock (&shard->mutex);
+    for (int i = 0; i < nb_jobs; i++) {
+      sm_mce_shard_handle (shard, &taken[i]);
+    }
+    jobs = taken;
+    size_jobs = size_taken;
+    pthread_mutex_lock (&shard->mutex);
+  }
+  pthread_mutex_unlock (&shard->mutex);
+  free_wrapper ((void**)&jobs);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Hand a message to a shard. With a single shard, the Sm task handles it directly.
+ */
+static void sm_mce_shard_post (sm_mce_shard_t *shard, sm_mce_job_type_t type, MessageDef *message, uint64_t received_ns,
+    sm_mce_shared_message_t *shared)
+{
+  sm_mce_job_t                            job = {.type = type, .message = message, .received_ns = received_ns, .shared = shared};
+
+  if (sm_mce_nb_shards == 1) {
+    sm_mce_shard_handle (shard, &job);
+    return;
+  }
+  pthread_mutex_lock (&shard->mutex);
+  if (shard->nb_jobs == shard->size_jobs) {
+    const int                             size = shard->size_jobs ? 2 * shard->size_jobs : 64;
+    sm_mce_job_t                         *jobs = realloc (shard->jobs, size * sizeof (sm_mce_job_t));
+
+    DevAssert (jobs);
+    shard->jobs = jobs;
+    shard->size_jobs = size;
+  }
+  shard->jobs[shard->nb_jobs++] = job;
+  if (shard->nb_jobs > shard->max_queued) {
+    shard->max_queued = shard->nb_jobs;
+  }
+  if (shard->nb_jobs == 1) {
+    pthread_cond_signal (&shard->cond);
+  }
+  pthread_mutex_unlock (&shard->mutex);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Split a batch of datagrams among the shards of their peers, without copying it.
+ */
+static void sm_mce_shard_post_datagrams (MessageDef *message, uint64_t received_ns)
+{
+  udp_data_multi_ind_t                   *udp_data_multi_ind = &message->ittiMsg.udp_data_multi_ind;
+  sm_mce_shared_message_t                *shared = NULL;
+  uint64_t                                shards = 0;
+  int                                     index = 0;
+
+  if (sm_mce_nb_shards == 1) {
+    sm_mce_shard_post (&sm_mce_shards[0], SM_MCE_JOB_MESSAGE, message, received_ns, NULL);
+    return;
+  }
+  shared = malloc (sizeof (sm_mce_shared_message_t) + udp_data_multi_ind->nb_datagrams);
+  DevAssert (shared);
+  for (uint32_t i = 0; i < udp_data_multi_ind->nb_datagrams; i++) {
+    index = sm_mce_shard_index ((struct sockaddr *)&udp_data_multi_ind->datagrams[i].sock_addr);
+    shared->shard_of[i] = (uint8_t)index;
+    shards |= (1ULL << index);
+  }
+  if (!(shards & (shards - 1))) {
+    /** Usual case, all from peers of the same shard. */
+    free_wrapper ((void**)&shared);
+    sm_mce_shard_post (&sm_mce_shards[index], SM_MCE_JOB_MESSAGE, message, received_ns, NULL);
+    return;
+  }
+  shared->message = message;
+  shared->refs = __builtin_popcountll (shards);
+  for (index = 0; index < sm_mce_nb_shards; index++) {
+    if (shards & (1ULL << index)) {
+      sm_mce_shard_post (&sm_mce_shards[index], SM_MCE_JOB_MESSAGE, message, received_ns, shared);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
 static void                            *
 sm_mce_thread (
   void *args)
@@ -190,55 +714,81 @@ sm_mce_thread (
 
   while (1) {
     MessageDef                             *received_message_p = NULL;
+    sm_mce_shard_t                         *shard = NULL;
+    uint64_t                                received_ns;
 
     itti_receive_msg (TASK_SM, &received_message_p);
     assert (received_message_p );
+    received_ns = sm_mce_now_ns ();
 
+    /**
+     * Dispatch the message to the shard of the MBMS-GW. The shard releases it.
+     */
     switch (ITTI_MSG_ID (received_message_p)) {
-    /** Only the signals to send. */
+    case SM_MBMS_SESSION_START_RESPONSE:
+      shard = &sm_mce_shards[sm_mce_shard_index ((struct sockaddr *)&received_message_p->ittiMsg.sm_mbms_session_start_response.mbms_peer_ip)];
+      break;
 
-    case SM_MBMS_SESSION_START_RESPONSE:{
-      sm_mce_mbms_session_start_response(&sm_mce_stack_handle, &received_message_p->ittiMsg.sm_mbms_session_start_response);
-    }
-    break;
+    case SM_MBMS_SESSION_UPDATE_RESPONSE:
+      shard = &sm_mce_shards[sm_mce_shard_index ((struct sockaddr *)&received_message_p->ittiMsg.sm_mbms_session_update_response.mbms_peer_ip)];
+      break;
 
-    case SM_MBMS_SESSION_UPDATE_RESPONSE:{
-      sm_mce_mbms_session_update_response(&sm_mce_stack_handle, &received_message_p->ittiMsg.sm_mbms_session_update_response);
-    }
-    break;
+    case SM_MBMS_SESSION_STOP_RESPONSE:
+      shard = &sm_mce_shards[sm_mce_shard_index ((struct sockaddr *)&received_message_p->ittiMsg.sm_mbms_session_stop_response.mbms_peer_ip)];
+      break;
 
-    case SM_MBMS_SESSION_STOP_RESPONSE:{
-      sm_mce_mbms_session_stop_response(&sm_mce_stack_handle, &received_message_p->ittiMsg.sm_mbms_session_stop_response);
-    }
-    break;
+    case SM_REMOVE_TUNNEL:
+      shard = &sm_mce_shards[sm_mce_shard_index ((struct sockaddr *)&received_message_p->ittiMsg.sm_remove_tunnel.mbms_peer_ip)];
+      break;
 
-    /**
-     * Use this message in case of an error to remove the SM Local Tunnel endpoints.
-     * No response to MME_APP is sent/expected.
-     */
-    case SM_REMOVE_TUNNEL:{
-      sm_mce_remove_tunnel(&sm_mce_stack_handle, &received_message_p->ittiMsg.sm_remove_tunnel);
+    case UDP_DATA_IND:{
+      udp_data_ind_t                         *udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
+
+      sm_recorder_write (&sm_mce_recorder, SM_RECORD_DIRECTION_IN, (struct sockaddr *)&udp_data_ind->sock_addr, udp_data_ind->peer_port,
+          udp_data_ind->msgBuf, udp_data_ind->buffer_length);
+      shard = &sm_mce_shards[sm_mce_shard_index ((struct sockaddr *)&udp_data_ind->sock_addr)];
     }
     break;
 
-    case UDP_DATA_IND:{
-      /*
-       * We received new data to handle from the UDP layer
-       */
-      nw_rc_t                                   rc;
-      udp_data_ind_t                         *udp_data_ind;
-
-      udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
-      rc = nwGtpv2cProcessUdpReq (sm_mce_stack_handle, udp_data_ind->msgBuf, udp_data_ind->buffer_length, udp_data_ind->local_port,
-    		  udp_data_ind->peer_port, &udp_data_ind->sock_addr);
-      DevAssert (rc == NW_OK);
+    case UDP_DATA_MULTI_IND:{
+      udp_data_multi_ind_t                   *udp_data_multi_ind = &received_message_p->ittiMsg.udp_data_multi_ind;
+
+      for (uint32_t i = 0; i < udp_data_multi_ind->nb_datagrams; i++) {
+        udp_datagram_t                       *datagram = &udp_data_multi_ind->datagrams[i];
+        sm_recorder_write (&sm_mce_recorder, SM_RECORD_DIRECTION_IN, (struct sockaddr *)&datagram->sock_addr, datagram->peer_port,
+            datagram->buffer, datagram->buffer_length);
+      }
+      sm_mce_shard_post_datagrams (received_message_p, received_ns);
+      received_message_p = NULL;
     }
     break;
 
     case TIMER_HAS_EXPIRED:{
-        OAILOG_DEBUG (LOG_SM, "Processing timeout for timer_id 0x%lx and arg %p\n", received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
-        DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
+      const long                              timer_id = received_message_p->ittiMsg.timer_has_expired.timer_id;
+
+      if (timer_id == sm_mce_report_timer_id) {
+        for (int i = 0; i < sm_mce_nb_shards; i++) {
+          sm_mce_shard_post (&sm_mce_shards[i], SM_MCE_JOB_REPORT, NULL, received_ns, NULL);
+        }
+        break;
+      }
+      if (timer_id == sm_mce_echo_timer_id) {
+        for (int i = 0; i < sm_mce_nb_shards; i++) {
+          sm_mce_shard_post (&sm_mce_shards[i], SM_MCE_JOB_ECHO, NULL, received_ns, NULL);
+        }
+        break;
+      }
+      /** Stack timers carry their shard, the shard drops the expiry if the timer was stopped meanwhile. */
+      for (int i = 0; i < sm_mce_nb_shards; i++) {
+        if (received_message_p->ittiMsg.timer_has_expired.arg == &sm_mce_shards[i]) {
+          shard = &sm_mce_shards[i];
+          break;
+        }
+      }
+      if (!shard) {
+        OAILOG_WARNING (LOG_SM, "Ignoring the expiry of the unknown timer_id 0x%lx\n", timer_id);
       }
+    }
     break;
 
     case TERMINATE_MESSAGE: {
@@ -252,8 +802,13 @@ sm_mce_thread (
     }
     break;
     }
-    itti_free_msg_content(received_message_p);
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+
+    if (shard) {
+      sm_mce_shard_post (shard, SM_MCE_JOB_MESSAGE, received_message_p, received_ns, NULL);
+    } else if (received_message_p) {
+      itti_free_msg_content(received_message_p);
+      itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+    }
     received_message_p = NULL;
 
   }
@@ -288,63 +843,147 @@ sm_send_init_udp (
 }
 
 //------------------------------------------------------------------------------
-int
-sm_mce_init (
-  const mce_config_t * mce_config_p)
+static int
+sm_mce_shard_init (
+  sm_mce_shard_t *shard,
+  const int index,
+  const uint16_t port,
+  const hash_size_t max_services)
 {
-  int                                     ret = 0;
   nw_gtpv2c_ulp_entity_t                  ulp;
   nw_gtpv2c_udp_entity_t                  udp;
   nw_gtpv2c_timer_mgr_entity_t            tmrMgr;
   nw_gtpv2c_log_mgr_entity_t              logMgr;
-  struct in_addr                          addr;
-  char                                   *sm_address_str = NULL;
+  bstring                                 b = NULL;
 
-  OAILOG_DEBUG (LOG_SM, "Initializing Sm interface\n");
+  memset (shard, 0, sizeof (*shard));
+  shard->index = index;
+  pthread_mutex_init (&shard->mutex, NULL);
+  pthread_cond_init (&shard->cond, NULL);
 
-  if (nwGtpv2cInitialize (&sm_mce_stack_handle) != NW_OK) {
-    OAILOG_ERROR (LOG_SM, "Failed to initialize gtpv2-c stack\n");
-    goto fail;
+  if (nwGtpv2cInitialize (&shard->stack_handle) != NW_OK) {
+    OAILOG_ERROR (LOG_SM, "Failed to initialize gtpv2-c stack of Sm shard %d\n", index);
+    return RETURNerror;
   }
 
   /*
    * Set ULP entity
    */
-  ulp.hUlp = (nw_gtpv2c_ulp_handle_t) NULL;
+  ulp.hUlp = (nw_gtpv2c_ulp_handle_t) shard;
   ulp.ulpReqCallback = sm_mce_ulp_process_stack_req_cb;
-  DevAssert (NW_OK == nwGtpv2cSetUlpEntity (sm_mce_stack_handle, &ulp));
+  DevAssert (NW_OK == nwGtpv2cSetUlpEntity (shard->stack_handle, &ulp));
   /*
    * Set UDP entity
    */
-  udp.hUdp = (nw_gtpv2c_udp_handle_t) NULL;
-  mce_config_read_lock (&mce_config);
-  udp.gtpv2cStandardPort = mce_config.mbms.ip.port_sm;
-  mce_config_unlock (&mce_config);
+  udp.hUdp = (nw_gtpv2c_udp_handle_t) shard;
+  udp.gtpv2cStandardPort = port;
   udp.udpDataReqCallback = sm_mce_send_udp_msg;
-  DevAssert (NW_OK == nwGtpv2cSetUdpEntity (sm_mce_stack_handle, &udp));
+  DevAssert (NW_OK == nwGtpv2cSetUdpEntity (shard->stack_handle, &udp));
   /*
    * Set Timer entity
    */
-  tmrMgr.tmrMgrHandle = (nw_gtpv2c_timer_mgr_handle_t) NULL;
+  tmrMgr.tmrMgrHandle = (nw_gtpv2c_timer_mgr_handle_t) shard;
   tmrMgr.tmrStartCallback = sm_mce_start_timer_wrapper;
   tmrMgr.tmrStopCallback 	= sm_mce_stop_timer_wrapper;
-  DevAssert (NW_OK == nwGtpv2cSetTimerMgrEntity (sm_mce_stack_handle, &tmrMgr));
+  DevAssert (NW_OK == nwGtpv2cSetTimerMgrEntity (shard->stack_handle, &tmrMgr));
   logMgr.logMgrHandle = 0;
   logMgr.logReqCallback = sm_mce_log_wrapper;
-  DevAssert (NW_OK == nwGtpv2cSetLogMgrEntity (sm_mce_stack_handle, &logMgr));
+  DevAssert (NW_OK == nwGtpv2cSetLogMgrEntity (shard->stack_handle, &logMgr));
+  DevAssert (NW_OK == nwGtpv2cSetLogLevel (shard->stack_handle, NW_LOG_LEVEL_DEBG));
+
+  b = bformat ("sm_mce_shard_%d_teid_2_tunnel", index);
+  shard->teid_2_tunnel = hashtable_create (max_services, HASH_TABLE_DEFAULT_HASH_FUNC, hash_free_int_func, b);
+  bdestroy_wrapper (&b);
+  b = bformat ("sm_mce_shard_%d_trxn_2_received_ns", index);
+  shard->trxn_2_received_ns = hashtable_create (max_services, HASH_TABLE_DEFAULT_HASH_FUNC, hash_free_int_func, b);
+  bdestroy_wrapper (&b);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int
+sm_mce_init (
+  const mce_config_t * mce_config_p)
+{
+  int                                     ret = 0;
+  uint16_t                                port_sm = 0;
+
+  OAILOG_DEBUG (LOG_SM, "Initializing Sm interface\n");
+
+  mce_config_read_lock (&mce_config);
+  port_sm = mce_config.mbms.ip.port_sm;
+  sm_mce_local_v4 = mce_config.mbms.ip.mc_mce_v4;
+  sm_mce_local_v6 = mce_config.mbms.ip.mc_mce_v6;
+  mce_config_unlock (&mce_config);
+
+  sm_mce_nb_shards = mce_config_p->udp_config.sm_stack_shards;
+  if (sm_mce_nb_shards > SM_MCE_SHARDS_MAX) {
+    OAILOG_WARNING (LOG_SM, "Limiting the Sm stack shards from %d to %d\n", sm_mce_nb_shards, SM_MCE_SHARDS_MAX);
+    sm_mce_nb_shards = SM_MCE_SHARDS_MAX;
+  } else if (sm_mce_nb_shards < 1) {
+    sm_mce_nb_shards = 1;
+  }
+  sm_mce_shards = calloc (sm_mce_nb_shards, sizeof (sm_mce_shard_t));
+  if (!sm_mce_shards) {
+    goto fail;
+  }
+  for (int i = 0; i < sm_mce_nb_shards; i++) {
+    if (sm_mce_shard_init (&sm_mce_shards[i], i, port_sm, mce_config_p->max_ues / sm_mce_nb_shards + 1) != RETURNok) {
+      goto fail;
+    }
+  }
+
+  /*
+   * Optional recording of the Sm traffic, before the Sm task handles any datagram
+   */
+  memset (&sm_mce_recorder, 0, sizeof (sm_mce_recorder));
+  if (mce_config_p->udp_config.sm_record_file) {
+    if (sm_recorder_open (&sm_mce_recorder, bdata (mce_config_p->udp_config.sm_record_file)) < 0) {
+      OAILOG_ERROR (LOG_SM, "Could not open the Sm record file %s: %s\n", bdata (mce_config_p->udp_config.sm_record_file), strerror (errno));
+    } else {
+      OAILOG_INFO (LOG_SM, "Recording the Sm datagrams into %s\n", bdata (mce_config_p->udp_config.sm_record_file));
+    }
+  }
+
+  /*
+   * A single shard is served by the Sm task itself.
+   */
+  if (sm_mce_nb_shards > 1) {
+    for (int i = 0; i < sm_mce_nb_shards; i++) {
+      if (pthread_create (&sm_mce_shards[i].thread, NULL, sm_mce_shard_thread, &sm_mce_shards[i])) {
+        OAILOG_ERROR (LOG_SM, "Sm shard %d pthread_create: %s\n", i, strerror (errno));
+        goto fail;
+      }
+    }
+    OAILOG_INFO (LOG_SM, "Started %d Sm stack shards\n", sm_mce_nb_shards);
+  }
 
   if (itti_create_task (TASK_SM, &sm_mce_thread, NULL) < 0) {
     OAILOG_ERROR (LOG_SM, "gtpv2c phtread_create: %s\n", strerror (errno));
     goto fail;
   }
 
-  DevAssert (NW_OK == nwGtpv2cSetLogLevel (sm_mce_stack_handle, NW_LOG_LEVEL_DEBG));
   /** Create 2 sockets, one for 2123 (received initial requests), another high port. */
-  sm_send_init_udp(&mce_config.mbms.ip.mc_mce_v4, &mce_config.mbms.ip.mc_mce_v6, udp.gtpv2cStandardPort); /**< Only low port (2123) is enough. */
+  sm_send_init_udp(&mce_config.mbms.ip.mc_mce_v4, &mce_config.mbms.ip.mc_mce_v6, port_sm); /**< Only low port (2123) is enough. */
+
+  /** Periodic report of the peer metrics. */
+  sm_mce_report_interval_sec = mce_config_p->mme_statistic_timer;
+  if (sm_mce_report_interval_sec
+      && timer_setup (sm_mce_report_interval_sec, 0, TASK_SM, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &sm_mce_report_timer_id) < 0) {
+    OAILOG_ERROR (LOG_SM, "Failed to start the Sm report timer\n");
+    sm_mce_report_timer_id = 0;
+  }
 
-  bstring b = bfromcstr("sm_mce_teid_2_gtv2c_teid_handle");
-  sm_mce_teid_2_gtv2c_teid_handle = hashtable_ts_create(mce_config_p->max_ues, HASH_TABLE_DEFAULT_HASH_FUNC, hash_free_int_func, b);
-  bdestroy_wrapper(&b);
+  /** Path supervision, the timer ticks every second and each peer keeps its own due time. */
+  sm_mce_path_config.echo_interval_ns = (uint64_t)mce_config_p->udp_config.sm_echo_interval_sec * 1000000000ULL;
+  sm_mce_path_config.echo_t3_ns = (uint64_t)mce_config_p->udp_config.sm_echo_t3_sec * 1000000000ULL;
+  sm_mce_path_config.echo_n3 = mce_config_p->udp_config.sm_echo_n3;
+  if (sm_mce_path_config.echo_interval_ns
+      && timer_setup (1, 0, TASK_SM, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &sm_mce_echo_timer_id) < 0) {
+    OAILOG_ERROR (LOG_SM, "Failed to start the Sm echo timer\n");
+    sm_mce_echo_timer_id = 0;
+    sm_mce_path_config.echo_interval_ns = 0;
+  }
 
   OAILOG_DEBUG (LOG_SM, "Initializing SM interface: DONE\n");
   return ret;
@@ -356,10 +995,51 @@ fail:
 
 static void sm_exit(void)
 {
-  if (nwGtpv2cFinalize(sm_mce_stack_handle) != NW_OK) {
-    OAI_FPRINTF_ERR ("An error occurred during tear down of nwGtp sm stack.\n");
+  void                                   *timer_arg = NULL;
+
+  if (sm_mce_report_timer_id) {
+    timer_remove (sm_mce_report_timer_id, &timer_arg);
+    sm_mce_report_timer_id = 0;
+  }
+  if (sm_mce_echo_timer_id) {
+    timer_remove (sm_mce_echo_timer_id, &timer_arg);
+    sm_mce_echo_timer_id = 0;
+  }
+  /** The shard threads handle their backlog before they stop. */
+  if (sm_mce_nb_shards > 1) {
+    for (int i = 0; i < sm_mce_nb_shards; i++) {
+      pthread_mutex_lock (&sm_mce_shards[i].mutex);
+      sm_mce_shards[i].terminate = true;
+      pthread_cond_signal (&sm_mce_shards[i].cond);
+      pthread_mutex_unlock (&sm_mce_shards[i].mutex);
+    }
+    for (int i = 0; i < sm_mce_nb_shards; i++) {
+      if (sm_mce_shards[i].thread) {
+        pthread_join (sm_mce_shards[i].thread, NULL);
+      }
+    }
+  }
+  for (int i = 0; i < sm_mce_nb_shards; i++) {
+    sm_mce_shard_t                       *shard = &sm_mce_shards[i];
+
+    sm_mce_shard_report (shard, true);
+    if (nwGtpv2cFinalize(shard->stack_handle) != NW_OK) {
+      OAI_FPRINTF_ERR ("An error occurred during tear down of nwGtp sm stack.\n");
+    }
+    if (hashtable_destroy(shard->teid_2_tunnel) != HASH_TABLE_OK) {
+      OAI_FPRINTF_ERR("An error occured while destroying sm teid hash table");
+    }
+    hashtable_destroy (shard->trxn_2_received_ns);
+    free_wrapper ((void**)&shard->peers);
+    free_wrapper ((void**)&shard->jobs);
+    pthread_mutex_destroy (&shard->mutex);
+    pthread_cond_destroy (&shard->cond);
   }
-  if (hashtable_ts_destroy(sm_mce_teid_2_gtv2c_teid_handle) != HASH_TABLE_OK) {
-    OAI_FPRINTF_ERR("An error occured while destroying sm teid hash table");
+  free_wrapper ((void**)&sm_mce_shards);
+  sm_mce_nb_shards = 0;
+  if (sm_mce_recorder.file) {
+    OAILOG_INFO (LOG_SM, "Recorded %" PRIu64 " Sm datagrams (%" PRIu64 " bytes), %" PRIu64 " not written\n",
+        sm_mce_recorder.records, sm_mce_recorder.bytes, sm_mce_recorder.failed);
+    sm_recorder_close (&sm_mce_recorder);
   }
 }
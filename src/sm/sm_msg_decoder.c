@@ -0,0 +1,320 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_msg_decoder.c
+* \brief Single pass decoders of the MBMS Session Start/Update/Stop Requests into the Sm ITTI messages.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "common_types_mbms.h"
+#include "sm_messages_types.h"
+
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cMsgParser.h"
+
+#include "gtpv2c_ie_formatter.h"
+#include "sm_common.h"
+#include "sm_ie_formatter.h"
+#include "sm_msg_decoder.h"
+
+/** IE of a decoded message, all of instance zero. */
+typedef struct sm_msg_decoder_ie_s {
+  uint8_t                 ie_type;
+  uint8_t                 ie_presence;
+  nw_rc_t               (*ie_get) (uint8_t ieType, uint16_t ieLength, uint8_t ieInstance, uint8_t * ieValue, void *arg);
+  size_t                  arg_offset;     ///< Offset of the decoded field in the ITTI message
+} sm_msg_decoder_ie_t;
+
+/**
+ * IE tables, ordered by IE type: the first missing mandatory IE is the one the generic parser reports.
+ * The index tables map the IE type to the table position + 1.
+ */
+static const sm_msg_decoder_ie_t sm_mbms_session_start_request_ies[] = {
+  {NW_GTPV2C_IE_BEARER_LEVEL_QOS, NW_GTPV2C_IE_PRESENCE_MANDATORY, gtpv2c_bearer_qos_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, mbms_bearer_level_qos)},
+  {NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_PRESENCE_MANDATORY, gtpv2c_fteid_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, sm_mbms_fteid)},
+  {NW_GTPV2C_IE_MBMS_SESSION_DURATION, NW_GTPV2C_IE_PRESENCE_MANDATORY, sm_mbms_session_duration_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, mbms_session_duration)},
+  {NW_GTPV2C_IE_MBMS_SERVICE_AREA, NW_GTPV2C_IE_PRESENCE_MANDATORY, sm_mbms_service_area_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, mbms_service_area)},
+  {NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, sm_mbms_flow_identifier_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, mbms_flow_id)},
+  {NW_GTPV2C_IE_MBMS_IP_MULTICAST_DISTRIBUTION, NW_GTPV2C_IE_PRESENCE_MANDATORY, sm_mbms_ip_multicast_distribution_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, mbms_ip_mc_address)},
+  {NW_GTPV2C_IE_TMGI, NW_GTPV2C_IE_PRESENCE_MANDATORY, sm_tmgi_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, tmgi)},
+  {NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL, sm_mbms_data_transfer_start_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, abs_start_time)},
+  {NW_GTPV2C_IE_MBMS_FLAGS, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL, sm_mbms_flags_ie_get,
+      offsetof (itti_sm_mbms_session_start_request_t, mbms_flags)},
+};
+
+static const uint8_t sm_mbms_session_start_request_ie_index[NW_GTPV2C_IE_TYPE_MAXIMUM] = {
+  [NW_GTPV2C_IE_BEARER_LEVEL_QOS]                 = 1,
+  [NW_GTPV2C_IE_FTEID]                            = 2,
+  [NW_GTPV2C_IE_MBMS_SESSION_DURATION]            = 3,
+  [NW_GTPV2C_IE_MBMS_SERVICE_AREA]                = 4,
+  [NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER]             = 5,
+  [NW_GTPV2C_IE_MBMS_IP_MULTICAST_DISTRIBUTION]   = 6,
+  [NW_GTPV2C_IE_TMGI]                             = 7,
+  [NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER] = 8,
+  [NW_GTPV2C_IE_MBMS_FLAGS]                       = 9,
+};
+
+static const sm_msg_decoder_ie_t sm_mbms_session_update_request_ies[] = {
+  {NW_GTPV2C_IE_BEARER_LEVEL_QOS, NW_GTPV2C_IE_PRESENCE_MANDATORY, gtpv2c_bearer_qos_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, mbms_bearer_level_qos)},
+  {NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_PRESENCE_OPTIONAL, gtpv2c_fteid_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, sm_mbms_fteid)},
+  {NW_GTPV2C_IE_MBMS_SESSION_DURATION, NW_GTPV2C_IE_PRESENCE_MANDATORY, sm_mbms_session_duration_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, mbms_session_duration)},
+  {NW_GTPV2C_IE_MBMS_SERVICE_AREA, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, sm_mbms_service_area_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, mbms_service_area)},
+  {NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, sm_mbms_flow_identifier_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, mbms_flow_id)},
+  {NW_GTPV2C_IE_TMGI, NW_GTPV2C_IE_PRESENCE_MANDATORY, sm_tmgi_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, tmgi)},
+  {NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL, sm_mbms_data_transfer_start_ie_get,
+      offsetof (itti_sm_mbms_session_update_request_t, abs_update_time)},
+};
+
+static const uint8_t sm_mbms_session_update_request_ie_index[NW_GTPV2C_IE_TYPE_MAXIMUM] = {
+  [NW_GTPV2C_IE_BEARER_LEVEL_QOS]                 = 1,
+  [NW_GTPV2C_IE_FTEID]                            = 2,
+  [NW_GTPV2C_IE_MBMS_SESSION_DURATION]            = 3,
+  [NW_GTPV2C_IE_MBMS_SERVICE_AREA]                = 4,
+  [NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER]             = 5,
+  [NW_GTPV2C_IE_TMGI]                             = 6,
+  [NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER] = 7,
+};
+
+static const sm_msg_decoder_ie_t sm_mbms_session_stop_request_ies[] = {
+  {NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, sm_mbms_flow_identifier_ie_get,
+      offsetof (itti_sm_mbms_session_stop_request_t, mbms_flow_id)},
+  {NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL, sm_mbms_data_transfer_start_ie_get,
+      offsetof (itti_sm_mbms_session_stop_request_t, abs_stop_time)},
+  {NW_GTPV2C_IE_MBMS_FLAGS, NW_GTPV2C_IE_PRESENCE_CONDITIONAL_OPTIONAL, sm_mbms_flags_ie_get,
+      offsetof (itti_sm_mbms_session_stop_request_t, mbms_flags)},
+};
+
+static const uint8_t sm_mbms_session_stop_request_ie_index[NW_GTPV2C_IE_TYPE_MAXIMUM] = {
+  [NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER]             = 1,
+  [NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER] = 2,
+  [NW_GTPV2C_IE_MBMS_FLAGS]                       = 3,
+};
+
+#define SM_MSG_DECODER_NB_IES(iEs)      (sizeof(iEs) / sizeof(sm_msg_decoder_ie_t))
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_msg_decode_ies (
+  nw_gtpv2c_msg_handle_t hMsg,
+  const sm_msg_decoder_ie_t * ies,
+  const uint8_t * ie_index,
+  const int nb_ies,
+  void *msg,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  uint8_t                                *msgBuf = nwGtpv2cMsgGetBuffer (hMsg);
+  uint8_t                                *pIeStart = msgBuf + ((msgBuf[0] & 0x08) ? 12 : 8);
+  uint8_t                                *pIeEnd = msgBuf + nwGtpv2cMsgGetLength (hMsg);
+  uint32_t                                received = 0;
+  nw_rc_t                                 rc = NW_OK;
+
+  while (pIeStart < pIeEnd) {
+    if (pIeStart + 4 > pIeEnd) {
+      *pOffendingIeType = pIeStart[0];
+      *pOffendingIeInstance = 0;
+      *pOffendingIeLength = 0;
+      return NW_GTPV2C_MSG_MALFORMED;
+    }
+
+    const uint8_t                           ieType = pIeStart[0];
+    const uint16_t                          ieLength = (pIeStart[1] << 8) | pIeStart[2];
+    const uint8_t                           ieInstance = pIeStart[3] & 0x0F;
+
+    if (pIeStart + 4 + ieLength > pIeEnd) {
+      *pOffendingIeType = ieType;
+      *pOffendingIeInstance = ieInstance;
+      *pOffendingIeLength = ieLength;
+      return NW_GTPV2C_MSG_MALFORMED;
+    }
+
+    if (ieInstance == NW_GTPV2C_IE_INSTANCE_ZERO && ie_index[ieType]) {
+      const int                               i = ie_index[ieType] - 1;
+
+      /** Repeated IEs are decoded again, as by the generic parser. */
+      rc = ies[i].ie_get (ieType, ieLength, ieInstance, pIeStart + 4, (uint8_t *) msg + ies[i].arg_offset);
+      if (rc != NW_OK) {
+        OAILOG_ERROR (LOG_SM, "Error while decoding IE %u with instance %u and length %u!\n", ieType, ieInstance, ieLength);
+        *pOffendingIeType = ieType;
+        *pOffendingIeInstance = ieInstance;
+        *pOffendingIeLength = ieLength;
+        return rc;
+      }
+      received |= (1 << i);
+    }
+    pIeStart += (ieLength + 4);
+  }
+
+  for (int i = 0; i < nb_ies; i++) {
+    if (ies[i].ie_presence == NW_GTPV2C_IE_PRESENCE_MANDATORY && !(received & (1 << i))) {
+      OAILOG_WARNING (LOG_SM, "Mandatory IE %u missing in msg type %u!\n", ies[i].ie_type, nwGtpv2cMsgGetMsgType (hMsg));
+      *pOffendingIeType = ies[i].ie_type;
+      *pOffendingIeInstance = NW_GTPV2C_IE_INSTANCE_ZERO;
+      *pOffendingIeLength = 0;
+      return NW_GTPV2C_MANDATORY_IE_MISSING;
+    }
+  }
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+nw_rc_t
+sm_mbms_session_start_request_decode (
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_sm_mbms_session_start_request_t * req_p,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  DevAssert (req_p);
+  return sm_msg_decode_ies (hMsg, sm_mbms_session_start_request_ies, sm_mbms_session_start_request_ie_index,
+      SM_MSG_DECODER_NB_IES (sm_mbms_session_start_request_ies), req_p, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+}
+
+//------------------------------------------------------------------------------
+nw_rc_t
+sm_mbms_session_update_request_decode (
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_sm_mbms_session_update_request_t * req_p,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  DevAssert (req_p);
+  return sm_msg_decode_ies (hMsg, sm_mbms_session_update_request_ies, sm_mbms_session_update_request_ie_index,
+      SM_MSG_DECODER_NB_IES (sm_mbms_session_update_request_ies), req_p, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+}
+
+//------------------------------------------------------------------------------
+nw_rc_t
+sm_mbms_session_stop_request_decode (
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_sm_mbms_session_stop_request_t * req_p,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  DevAssert (req_p);
+  return sm_msg_decode_ies (hMsg, sm_mbms_session_stop_request_ies, sm_mbms_session_stop_request_ie_index,
+      SM_MSG_DECODER_NB_IES (sm_mbms_session_stop_request_ies), req_p, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+}
+
+//------------------------------------------------------------------------------
+static nw_rc_t
+sm_msg_parse_ies (
+  nw_gtpv2c_stack_handle_t hStack,
+  nw_gtpv2c_msg_handle_t hMsg,
+  const sm_msg_decoder_ie_t * ies,
+  const int nb_ies,
+  void *msg,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  nw_gtpv2c_msg_parser_t                 *pMsgParser = NULL;
+  nw_rc_t                                 rc = NW_OK;
+  nw_rc_t                                 parse_rc = NW_OK;
+
+  rc = nwGtpv2cMsgParserNew (hStack, nwGtpv2cMsgGetMsgType (hMsg), sm_ie_indication_generic, NULL, &pMsgParser);
+  DevAssert (NW_OK == rc);
+  for (int i = 0; i < nb_ies; i++) {
+    rc = nwGtpv2cMsgParserAddIe (pMsgParser, ies[i].ie_type, NW_GTPV2C_IE_INSTANCE_ZERO, ies[i].ie_presence,
+        ies[i].ie_get, (uint8_t *) msg + ies[i].arg_offset);
+    DevAssert (NW_OK == rc);
+  }
+  parse_rc = nwGtpv2cMsgParserRun (pMsgParser, hMsg, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+  rc = nwGtpv2cMsgParserDelete (hStack, pMsgParser);
+  DevAssert (NW_OK == rc);
+  return parse_rc;
+}
+
+//------------------------------------------------------------------------------
+nw_rc_t
+sm_mbms_session_start_request_parse (
+  nw_gtpv2c_stack_handle_t hStack,
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_sm_mbms_session_start_request_t * req_p,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  return sm_msg_parse_ies (hStack, hMsg, sm_mbms_session_start_request_ies, SM_MSG_DECODER_NB_IES (sm_mbms_session_start_request_ies),
+      req_p, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+}
+
+//------------------------------------------------------------------------------
+nw_rc_t
+sm_mbms_session_update_request_parse (
+  nw_gtpv2c_stack_handle_t hStack,
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_sm_mbms_session_update_request_t * req_p,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  return sm_msg_parse_ies (hStack, hMsg, sm_mbms_session_update_request_ies, SM_MSG_DECODER_NB_IES (sm_mbms_session_update_request_ies),
+      req_p, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+}
+
+//------------------------------------------------------------------------------
+nw_rc_t
+sm_mbms_session_stop_request_parse (
+  nw_gtpv2c_stack_handle_t hStack,
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_sm_mbms_session_stop_request_t * req_p,
+  uint8_t * pOffendingIeType,
+  uint8_t * pOffendingIeInstance,
+  uint16_t * pOffendingIeLength)
+{
+  return sm_msg_parse_ies (hStack, hMsg, sm_mbms_session_stop_request_ies, SM_MSG_DECODER_NB_IES (sm_mbms_session_stop_request_ies),
+      req_p, pOffendingIeType, pOffendingIeInstance, pOffendingIeLength);
+}
@@ -0,0 +1,65 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_msg_decoder.h
+* \brief Single pass decoders of the MBMS Session Start/Update/Stop Requests into the Sm ITTI messages.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+*/
+
+#ifndef FILE_SM_MSG_DECODER_SEEN
+#define FILE_SM_MSG_DECODER_SEEN
+
+/**
+ * The decoders walk the IEs of the received message once and fill the ITTI message directly with the Sm IE getters.
+ * The results (return code, offending IE type/instance/length and decoded fields) are the ones of the generic
+ * nwGtpv2cMsgParserRun() with the same IEs registered, which the *_parse() reference functions do.
+ * Return NW_OK, NW_GTPV2C_MSG_MALFORMED, NW_GTPV2C_MANDATORY_IE_MISSING or the error of the failing IE getter.
+ */
+
+/* @brief Decode an MBMS Session Start Request received from MBMS-GW. */
+nw_rc_t sm_mbms_session_start_request_decode(nw_gtpv2c_msg_handle_t hMsg, itti_sm_mbms_session_start_request_t *req_p,
+    uint8_t *pOffendingIeType, uint8_t *pOffendingIeInstance, uint16_t *pOffendingIeLength);
+
+/* @brief Decode an MBMS Session Update Request received from MBMS-GW. */
+nw_rc_t sm_mbms_session_update_request_decode(nw_gtpv2c_msg_handle_t hMsg, itti_sm_mbms_session_update_request_t *req_p,
+    uint8_t *pOffendingIeType, uint8_t *pOffendingIeInstance, uint16_t *pOffendingIeLength);
+
+/* @brief Decode an MBMS Session Stop Request received from MBMS-GW. */
+nw_rc_t sm_mbms_session_stop_request_decode(nw_gtpv2c_msg_handle_t hMsg, itti_sm_mbms_session_stop_request_t *req_p,
+    uint8_t *pOffendingIeType, uint8_t *pOffendingIeInstance, uint16_t *pOffendingIeLength);
+
+/**
+ * Reference decoders on the generic message parser, kept to cross-check the single pass decoders (sm_msg_decoder_bench).
+ */
+
+nw_rc_t sm_mbms_session_start_request_parse(nw_gtpv2c_stack_handle_t hStack, nw_gtpv2c_msg_handle_t hMsg, itti_sm_mbms_session_start_request_t *req_p,
+    uint8_t *pOffendingIeType, uint8_t *pOffendingIeInstance, uint16_t *pOffendingIeLength);
+
+nw_rc_t sm_mbms_session_update_request_parse(nw_gtpv2c_stack_handle_t hStack, nw_gtpv2c_msg_handle_t hMsg, itti_sm_mbms_session_update_request_t *req_p,
+    uint8_t *pOffendingIeType, uint8_t *pOffendingIeInstance, uint16_t *pOffendingIeLength);
+
+nw_rc_t sm_mbms_session_stop_request_parse(nw_gtpv2c_stack_handle_t hStack, nw_gtpv2c_msg_handle_t hMsg, itti_sm_mbms_session_stop_request_t *req_p,
+    uint8_t *pOffendingIeType, uint8_t *pOffendingIeInstance, uint16_t *pOffendingIeLength);
+
+#endif /* FILE_SM_MSG_DECODER_SEEN */
@@ -0,0 +1,474 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_msg_decoder_bench.c
+* \brief Differential fuzzer and benchmark of the single pass MBMS session request decoders against the generic parser.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+* The corpus is a set of MBMS Session Start/Update/Stop Requests, built in or read from a file with one hex encoded
+* GTPv2-C message per line, e.g. captured with: tshark -r sm.pcap -Y gtpv2 -T fields -e udp.payload
+* Each message is decoded with sm_mbms_session_*_request_parse() and sm_mbms_session_*_request_decode(), the results
+* must be identical. The fuzzer mutates the corpus and compares the return code, the offending IE and the decoded
+* ITTI message of both paths.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <ctype.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "common_types_mbms.h"
+#include "sm_messages_types.h"
+
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cMsgParser.h"
+
+#include "sm_msg_decoder.h"
+
+#define SM_MSG_DECODER_BENCH_MAX_MSG_LEN                        (4096)
+#define SM_MSG_DECODER_BENCH_MAX_CORPUS                         (1024)
+#define SM_MSG_DECODER_BENCH_DEFAULT_ITERATIONS                 (1000000)
+
+typedef struct sm_msg_decoder_bench_msg_s {
+  uint8_t                 buf[SM_MSG_DECODER_BENCH_MAX_MSG_LEN];
+  uint32_t                len;
+} sm_msg_decoder_bench_msg_t;
+
+typedef union sm_msg_decoder_bench_req_u {
+  itti_sm_mbms_session_start_request_t    start;
+  itti_sm_mbms_session_update_request_t   update;
+  itti_sm_mbms_session_stop_request_t     stop;
+} sm_msg_decoder_bench_req_t;
+
+typedef struct sm_msg_decoder_bench_result_s {
+  nw_rc_t                 rc;
+  uint8_t                 offendingIeType;
+  uint8_t                 offendingIeInstance;
+  uint16_t                offendingIeLength;
+  sm_msg_decoder_bench_req_t req;
+} sm_msg_decoder_bench_result_t;
+
+static sm_msg_decoder_bench_msg_t corpus[SM_MSG_DECODER_BENCH_MAX_CORPUS];
+static int                        corpus_size = 0;
+static nw_gtpv2c_stack_handle_t   hStack = 0;
+
+//------------------------------------------------------------------------------
+static uint8_t *
+sm_msg_decoder_bench_add_ie (
+  uint8_t * p,
+  uint8_t ieType,
+  const uint8_t * value,
+  uint16_t length)
+{
+  p[0] = ieType;
+  p[1] = length >> 8;
+  p[2] = length & 0xFF;
+  p[3] = NW_GTPV2C_IE_INSTANCE_ZERO;
+  memcpy (p + 4, value, length);
+  return p + 4 + length;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_msg_decoder_bench_add_msg (
+  uint8_t msgType,
+  uint32_t teid,
+  uint32_t seqNum,
+  const uint8_t * ies,
+  uint32_t iesLength)
+{
+  sm_msg_decoder_bench_msg_t             *msg = &corpus[corpus_size++];
+
+  msg->buf[0] = 0x48;
+  msg->buf[1] = msgType;
+  msg->buf[2] = (iesLength + 8) >> 8;
+  msg->buf[3] = (iesLength + 8) & 0xFF;
+  msg->buf[4] = teid >> 24;
+  msg->buf[5] = teid >> 16;
+  msg->buf[6] = teid >> 8;
+  msg->buf[7] = teid;
+  msg->buf[8] = seqNum >> 16;
+  msg->buf[9] = seqNum >> 8;
+  msg->buf[10] = seqNum;
+  msg->buf[11] = 0;
+  memcpy (msg->buf + 12, ies, iesLength);
+  msg->len = iesLength + 12;
+}
+
+/**
+ * Built in corpus, the MBMS session requests of an MBMS-GW for a few TMGIs with IPv4 and IPv6 multicast bearers.
+ */
+static void
+sm_msg_decoder_bench_build_corpus (void)
+{
+  static const uint8_t                    qos[22] = {0x04, 0x01, 0, 0, 0, 0x03, 0xe8, 0, 0, 0, 0x03, 0xe8,
+                                                     0, 0, 0, 0x03, 0xe8, 0, 0, 0, 0x03, 0xe8};
+  static const uint8_t                    duration[3] = {0x00, 0x1c, 0x20};
+  static const uint8_t                    abs_time[8] = {0xe3, 0x4b, 0x2c, 0x00, 0x00, 0x00, 0x00, 0x00};
+  static const uint8_t                    flags[1] = {0x01};
+  uint8_t                                 ies[512];
+  uint8_t                                *p = NULL;
+
+  for (uint32_t i = 0; i < 16; i++) {
+    const uint8_t                           fteid[9] = {0x80 | 21, 0x10, 0, 0, i, 192, 168, 61, 10 + (i & 3)};
+    const uint8_t                           service_area[5] = {2, 0, i, 0, i + 1};
+    const uint8_t                           flow_id[2] = {0, i};
+    const uint8_t                           tmgi[6] = {0x00, 0x00, i, 0x02, 0xf8, 0x39};
+    uint8_t                                 ip_mc[48] = {0, 0, 0x10, i};
+    uint16_t                                ip_mc_length = 4;
+
+    if (i & 1) {
+      /** IPv6 distribution and source addresses. */
+      ip_mc[ip_mc_length++] = 0x40 | 16;
+      ip_mc[ip_mc_length] = 0xff; ip_mc[ip_mc_length + 1] = 0x3e; ip_mc[ip_mc_length + 15] = i;
+      ip_mc_length += 16;
+      ip_mc[ip_mc_length++] = 0x40 | 16;
+      ip_mc[ip_mc_length] = 0x20; ip_mc[ip_mc_length + 1] = 0x01; ip_mc[ip_mc_length + 15] = 1;
+      ip_mc_length += 16;
+    } else {
+      ip_mc[ip_mc_length++] = 4;
+      ip_mc[ip_mc_length++] = 232; ip_mc[ip_mc_length++] = 0; ip_mc[ip_mc_length++] = 0; ip_mc[ip_mc_length++] = i;
+      ip_mc[ip_mc_length++] = 4;
+      ip_mc[ip_mc_length++] = 10; ip_mc[ip_mc_length++] = 0; ip_mc[ip_mc_length++] = 0; ip_mc[ip_mc_length++] = 1;
+    }
+    ip_mc[ip_mc_length++] = 0;
+
+    /** MBMS Session Start Request, IEs in the order of TS 29.274 Table 7.13.1-1. */
+    p = ies;
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_FTEID, fteid, sizeof (fteid));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_TMGI, tmgi, sizeof (tmgi));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_SESSION_DURATION, duration, sizeof (duration));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_SERVICE_AREA, service_area, sizeof (service_area));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, flow_id, sizeof (flow_id));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_BEARER_LEVEL_QOS, qos, sizeof (qos));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_IP_MULTICAST_DISTRIBUTION, ip_mc, ip_mc_length);
+    if (i & 2)
+      p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, abs_time, sizeof (abs_time));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_FLAGS, flags, sizeof (flags));
+    sm_msg_decoder_bench_add_msg (NW_GTP_MBMS_SESSION_START_REQ, 0, 3 * i, ies, p - ies);
+
+    /** MBMS Session Update Request. */
+    p = ies;
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_SERVICE_AREA, service_area, sizeof (service_area));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_TMGI, tmgi, sizeof (tmgi));
+    if (i & 1)
+      p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_FTEID, fteid, sizeof (fteid));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_SESSION_DURATION, duration, sizeof (duration));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_BEARER_LEVEL_QOS, qos, sizeof (qos));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, flow_id, sizeof (flow_id));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, abs_time, sizeof (abs_time));
+    sm_msg_decoder_bench_add_msg (NW_GTP_MBMS_SESSION_UPDATE_REQ, 0x1000 + i, 3 * i + 1, ies, p - ies);
+
+    /** MBMS Session Stop Request. */
+    p = ies;
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_FLOW_IDENTIFIER, flow_id, sizeof (flow_id));
+    if (i & 2)
+      p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_ABSOLUTE_TIME_MBMS_DATA_TRANSFER, abs_time, sizeof (abs_time));
+    p = sm_msg_decoder_bench_add_ie (p, NW_GTPV2C_IE_MBMS_FLAGS, flags, sizeof (flags));
+    sm_msg_decoder_bench_add_msg (NW_GTP_MBMS_SESSION_STOP_REQ, 0x1000 + i, 3 * i + 2, ies, p - ies);
+  }
+}
+
+/**
+ * Load a corpus file, one hex encoded message per line. Messages which are no MBMS session requests are skipped.
+ */
+static int
+sm_msg_decoder_bench_load_corpus (
+  const char *path)
+{
+  FILE                                   *fp = fopen (path, "r");
+  char                                    line[2 * SM_MSG_DECODER_BENCH_MAX_MSG_LEN + 2];
+
+  if (!fp) {
+    perror (path);
+    return -1;
+  }
+  while (fgets (line, sizeof (line), fp) && corpus_size < SM_MSG_DECODER_BENCH_MAX_CORPUS) {
+    sm_msg_decoder_bench_msg_t             *msg = &corpus[corpus_size];
+    uint32_t                                len = 0;
+    unsigned int                            byte = 0;
+
+    for (char *c = line; isxdigit (c[0]) && isxdigit (c[1]) && len < SM_MSG_DECODER_BENCH_MAX_MSG_LEN; c += 2) {
+      sscanf (c, "%2x", &byte);
+      msg->buf[len++] = byte;
+    }
+    if (len < 12 || (msg->buf[1] != NW_GTP_MBMS_SESSION_START_REQ && msg->buf[1] != NW_GTP_MBMS_SESSION_UPDATE_REQ
+        && msg->buf[1] != NW_GTP_MBMS_SESSION_STOP_REQ))
+      continue;
+    msg->len = len;
+    corpus_size++;
+  }
+  fclose (fp);
+  return corpus_size;
+}
+
+//------------------------------------------------------------------------------
+static void
+sm_msg_decoder_bench_run (
+  uint8_t msgType,
+  nw_gtpv2c_msg_handle_t hMsg,
+  bool fast,
+  sm_msg_decoder_bench_result_t * result)
+{
+  if (msgType == NW_GTP_MBMS_SESSION_START_REQ) {
+    result->rc = fast ?
+        sm_mbms_session_start_request_decode (hMsg, &result->req.start, &result->offendingIeType, &result->offendingIeInstance, &result->offendingIeLength) :
+        sm_mbms_session_start_request_parse (hStack, hMsg, &result->req.start, &result->offendingIeType, &result->offendingIeInstance, &result->offendingIeLength);
+  } else if (msgType == NW_GTP_MBMS_SESSION_UPDATE_REQ) {
+    result->rc = fast ?
+        sm_mbms_session_update_request_decode (hMsg, &result->req.update, &result->offendingIeType, &result->offendingIeInstance, &result->offendingIeLength) :
+        sm_mbms_session_update_request_parse (hStack, hMsg, &result->req.update, &result->offendingIeType, &result->offendingIeInstance, &result->offendingIeLength);
+  } else {
+    result->rc = fast ?
+        sm_mbms_session_stop_request_decode (hMsg, &result->req.stop, &result->offendingIeType, &result->offendingIeInstance, &result->offendingIeLength) :
+        sm_mbms_session_stop_request_parse (hStack, hMsg, &result->req.stop, &result->offendingIeType, &result->offendingIeInstance, &result->offendingIeLength);
+  }
+}
+
+/**
+ * Decode a message with both paths, the message type of the corpus entry selects the decoder (the mutated one may differ).
+ * Returns false on a mismatch.
+ */
+static bool
+sm_msg_decoder_bench_compare (
+  uint8_t msgType,
+  const uint8_t * buf,
+  uint32_t len,
+  nw_rc_t * rc)
+{
+  sm_msg_decoder_bench_result_t           generic;
+  sm_msg_decoder_bench_result_t           fast;
+  nw_gtpv2c_msg_handle_t                  hMsg = 0;
+
+  memset (&generic, 0, sizeof (generic));
+  memset (&fast, 0, sizeof (fast));
+  DevAssert (NW_OK == nwGtpv2cMsgFromBufferNew (hStack, (uint8_t *) buf, len, &hMsg));
+  sm_msg_decoder_bench_run (msgType, hMsg, false, &generic);
+  sm_msg_decoder_bench_run (msgType, hMsg, true, &fast);
+  DevAssert (NW_OK == nwGtpv2cMsgDelete (hStack, hMsg));
+  *rc = generic.rc;
+  /** The partially decoded message is compared too: both paths decode the IEs in message order and stop at the same IE. */
+  return !memcmp (&generic, &fast, sizeof (generic));
+}
+
+//------------------------------------------------------------------------------
+static uint32_t
+sm_msg_decoder_bench_mutate (
+  uint8_t * buf,
+  uint32_t len)
+{
+  const int                               nb_mutations = 1 + rand () % 4;
+
+  for (int m = 0; m < nb_mutations; m++) {
+    const int                               mutation = rand () % 6;
+    uint32_t                                offset = 12;
+    uint32_t                                target = 0;
+    int                                     nb_ies = 0;
+
+    if (mutation == 0) {
+      /** Bit flip, the header included. */
+      buf[rand () % len] ^= 1 << (rand () % 8);
+      continue;
+    }
+    if (mutation == 1) {
+      /** Random byte in the IEs. */
+      if (len > 12)
+        buf[12 + rand () % (len - 12)] = rand ();
+      continue;
+    }
+    if (mutation == 2) {
+      /** Truncation, the header is kept. */
+      if (len > 12)
+        len = 12 + rand () % (len - 12);
+      continue;
+    }
+
+    /** Pick one of the well formed IEs. */
+    while (offset + 4 <= len && offset + 4 + ((buf[offset + 1] << 8) | buf[offset + 2]) <= len) {
+      if (rand () % ++nb_ies == 0)
+        target = offset;
+      offset += 4 + ((buf[offset + 1] << 8) | buf[offset + 2]);
+    }
+    if (!nb_ies)
+      continue;
+
+    if (mutation == 3) {
+      /** IE length, shortened or random. */
+      const uint16_t                          ie_len = (buf[target + 1] << 8) | buf[target + 2];
+      const uint16_t                          new_len = rand () % 2 ? (ie_len ? rand () % ie_len : 0) : rand () % 0x10000;
+
+      buf[target + 1] = new_len >> 8;
+      buf[target + 2] = new_len & 0xFF;
+    } else if (mutation == 4) {
+      /** IE instance. */
+      buf[target + 3] = rand () % 2 ? rand () : (buf[target + 3] & 0xF0) | (rand () % 2);
+    } else {
+      /** Duplicated IE, appended. */
+      const uint32_t                          ie_len = 4 + ((buf[target + 1] << 8) | buf[target + 2]);
+
+      if (len + ie_len <= SM_MSG_DECODER_BENCH_MAX_MSG_LEN) {
+        memcpy (buf + len, buf + target, ie_len);
+        len += ie_len;
+      }
+    }
+  }
+  return len;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t
+sm_msg_decoder_bench_now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double
+sm_msg_decoder_bench_time (
+  uint64_t iterations,
+  bool fast)
+{
+  nw_gtpv2c_msg_handle_t                  hMsgs[SM_MSG_DECODER_BENCH_MAX_CORPUS];
+  sm_msg_decoder_bench_result_t           result;
+  uint64_t                                start = 0;
+  uint64_t                                failures = 0;
+
+  for (int i = 0; i < corpus_size; i++)
+    DevAssert (NW_OK == nwGtpv2cMsgFromBufferNew (hStack, corpus[i].buf, corpus[i].len, &hMsgs[i]));
+  start = sm_msg_decoder_bench_now_ns ();
+  for (uint64_t n = 0; n < iterations; n++) {
+    const int                               i = n % corpus_size;
+
+    sm_msg_decoder_bench_run (corpus[i].buf[1], hMsgs[i], fast, &result);
+    failures += (result.rc != NW_OK);
+  }
+  start = sm_msg_decoder_bench_now_ns () - start;
+  for (int i = 0; i < corpus_size; i++)
+    nwGtpv2cMsgDelete (hStack, hMsgs[i]);
+  if (failures)
+    fprintf (stderr, "%s: %"PRIu64" messages failed to decode\n", fast ? "fast" : "generic", failures);
+  return (double)start / iterations;
+}
+
+//------------------------------------------------------------------------------
+static void
+usage (
+  const char *name)
+{
+  fprintf (stderr, "Usage: %s [-f corpus] [-n iterations] [-z fuzz_cases] [-s seed]\n", name);
+  fprintf (stderr, "  -f corpus      one hex encoded GTPv2-C message per line (default: built in MBMS session requests)\n");
+  fprintf (stderr, "  -n iterations  decodes per path for the benchmark (default %d, 0 to skip)\n", SM_MSG_DECODER_BENCH_DEFAULT_ITERATIONS);
+  fprintf (stderr, "  -z fuzz_cases  mutated messages decoded by both paths and compared (default 0)\n");
+  fprintf (stderr, "  -s seed        fuzzer seed (default: time)\n");
+}
+
+int
+main (
+  int argc,
+  char **argv)
+{
+  const char                             *corpus_path = NULL;
+  uint64_t                                iterations = SM_MSG_DECODER_BENCH_DEFAULT_ITERATIONS;
+  uint64_t                                fuzz_cases = 0;
+  unsigned int                            seed = time (NULL);
+  int                                     opt = 0;
+  nw_rc_t                                 rc = NW_OK;
+
+  while ((opt = getopt (argc, argv, "f:n:z:s:h")) != -1) {
+    switch (opt) {
+    case 'f': corpus_path = optarg; break;
+    case 'n': iterations = strtoull (optarg, NULL, 0); break;
+    case 'z': fuzz_cases = strtoull (optarg, NULL, 0); break;
+    case 's': seed = strtoul (optarg, NULL, 0); break;
+    default:
+      usage (argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  DevAssert (NW_OK == nwGtpv2cInitialize (&hStack));
+  if (corpus_path) {
+    if (sm_msg_decoder_bench_load_corpus (corpus_path) <= 0) {
+      fprintf (stderr, "No MBMS session requests in %s\n", corpus_path);
+      return 1;
+    }
+  } else {
+    sm_msg_decoder_bench_build_corpus ();
+  }
+  printf ("Corpus: %d MBMS session requests\n", corpus_size);
+
+  /** The corpus itself must decode identically. */
+  for (int i = 0; i < corpus_size; i++) {
+    if (!sm_msg_decoder_bench_compare (corpus[i].buf[1], corpus[i].buf, corpus[i].len, &rc)) {
+      fprintf (stderr, "Mismatch on corpus message %d\n", i);
+      return 2;
+    }
+  }
+
+  if (fuzz_cases) {
+    uint64_t                                nb_rc[4] = {0};
+    uint8_t                                 buf[SM_MSG_DECODER_BENCH_MAX_MSG_LEN];
+
+    srand (seed);
+    for (uint64_t n = 0; n < fuzz_cases; n++) {
+      const sm_msg_decoder_bench_msg_t       *msg = &corpus[rand () % corpus_size];
+      uint32_t                                len = 0;
+
+      memcpy (buf, msg->buf, msg->len);
+      len = sm_msg_decoder_bench_mutate (buf, msg->len);
+      if (!sm_msg_decoder_bench_compare (msg->buf[1], buf, len, &rc)) {
+        fprintf (stderr, "Mismatch on fuzz case %"PRIu64" (seed %u), message:\n", n, seed);
+        for (uint32_t i = 0; i < len; i++)
+          fprintf (stderr, "%02x", buf[i]);
+        fprintf (stderr, "\n");
+        return 2;
+      }
+      nb_rc[rc == NW_OK ? 0 : rc == NW_GTPV2C_MSG_MALFORMED ? 1 : rc == NW_GTPV2C_MANDATORY_IE_MISSING ? 2 : 3]++;
+    }
+    printf ("Fuzzed %"PRIu64" messages (seed %u), no mismatch: %"PRIu64" ok, %"PRIu64" malformed, %"PRIu64" mandatory IE missing, %"PRIu64" IE error\n",
+        fuzz_cases, seed, nb_rc[0], nb_rc[1], nb_rc[2], nb_rc[3]);
+  }
+
+  if (iterations) {
+    const double                            generic_ns = sm_msg_decoder_bench_time (iterations, false);
+    const double                            fast_ns = sm_msg_decoder_bench_time (iterations, true);
+
+    printf ("Generic parser : %8.1f ns/msg\n", generic_ns);
+    printf ("Single pass    : %8.1f ns/msg (x%.1f)\n", fast_ns, generic_ns / fast_ns);
+  }
+  nwGtpv2cFinalize (hStack);
+  return 0;
+}
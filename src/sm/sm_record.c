@@ -0,0 +1,202 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_record.c
+* \brief Writer and reader of the Sm record files.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <endian.h>
+#include <netinet/in.h>
+
+#include "sm_record.h"
+
+/** Buffer of the record file, the Sm task writes a record per datagram. */
+#define SM_RECORD_FILE_BUFFER_SIZE        (1 << 20)
+#define SM_RECORD_MAX_LENGTH              (65535)
+
+//------------------------------------------------------------------------------
+static uint64_t sm_record_clock_ns (clockid_t clock)
+{
+  struct timespec                         ts;
+
+  clock_gettime (clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+int sm_recorder_open (sm_recorder_t *recorder, const char *path)
+{
+  sm_record_file_header_t                 file_header;
+
+  memset (recorder, 0, sizeof (*recorder));
+  if (!(recorder->file = fopen (path, "wb"))) {
+    return -1;
+  }
+  setvbuf (recorder->file, NULL, _IOFBF, SM_RECORD_FILE_BUFFER_SIZE);
+  memset (&file_header, 0, sizeof (file_header));
+  file_header.magic = htonl (SM_RECORD_MAGIC);
+  file_header.version = htons (SM_RECORD_VERSION);
+  file_header.start_time_ns = htobe64 (sm_record_clock_ns (CLOCK_REALTIME));
+  if (fwrite (&file_header, sizeof (file_header), 1, recorder->file) != 1) {
+    fclose (recorder->file);
+    recorder->file = NULL;
+    return -1;
+  }
+  recorder->start_ns = sm_record_clock_ns (CLOCK_MONOTONIC);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void sm_recorder_write (
+  sm_recorder_t *recorder,
+  sm_record_direction_t direction,
+  const struct sockaddr *peer,
+  uint16_t peer_port,
+  const uint8_t *buffer,
+  uint32_t length)
+{
+  sm_record_header_t                      header;
+
+  if (!recorder->file) {
+    return;
+  }
+  /** The Sm shards write their responses concurrently, a record is written as a whole. */
+  flockfile (recorder->file);
+  memset (&header, 0, sizeof (header));
+  header.time_ns = htobe64 (sm_record_clock_ns (CLOCK_MONOTONIC) - recorder->start_ns);
+  header.direction = direction;
+  header.family = peer->sa_family;
+  header.peer_port = htons (peer_port);
+  if (peer->sa_family == AF_INET6) {
+    memcpy (header.peer_address, &((const struct sockaddr_in6 *)peer)->sin6_addr, 16);
+  } else {
+    memcpy (header.peer_address, &((const struct sockaddr_in *)peer)->sin_addr, 4);
+  }
+  header.length = htonl (length);
+  if (fwrite (&header, sizeof (header), 1, recorder->file) != 1 || fwrite (buffer, 1, length, recorder->file) != length) {
+    recorder->failed++;
+    funlockfile (recorder->file);
+    return;
+  }
+  recorder->records++;
+  recorder->bytes += length;
+  funlockfile (recorder->file);
+}
+
+//------------------------------------------------------------------------------
+void sm_recorder_close (sm_recorder_t *recorder)
+{
+  if (recorder->file) {
+    fclose (recorder->file);
+    recorder->file = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+int sm_record_read_file (const char *path, sm_record_file_header_t *file_header, sm_record_t **records)
+{
+  FILE                                   *file = fopen (path, "rb");
+  sm_record_header_t                      header;
+  sm_record_t                            *array = NULL;
+  int                                     nb_records = 0;
+  int                                     size = 0;
+
+  *records = NULL;
+  if (!file) {
+    return -1;
+  }
+  if (fread (file_header, sizeof (*file_header), 1, file) != 1 || ntohl (file_header->magic) != SM_RECORD_MAGIC
+      || ntohs (file_header->version) != SM_RECORD_VERSION) {
+    fclose (file);
+    errno = EINVAL;
+    return -1;
+  }
+  file_header->magic = SM_RECORD_MAGIC;
+  file_header->version = SM_RECORD_VERSION;
+  file_header->start_time_ns = be64toh (file_header->start_time_ns);
+
+  while (fread (&header, sizeof (header), 1, file) == 1) {
+    sm_record_t                            *record = NULL;
+    const uint32_t                          length = ntohl (header.length);
+
+    if (length > SM_RECORD_MAX_LENGTH) {
+      break;
+    }
+    if (nb_records == size) {
+      sm_record_t                          *grown = realloc (array, (size ? 2 * size : 1024) * sizeof (sm_record_t));
+
+      if (!grown) {
+        break;
+      }
+      array = grown;
+      size = size ? 2 * size : 1024;
+    }
+    record = &array[nb_records];
+    memset (record, 0, sizeof (*record));
+    if (!(record->buffer = malloc (length ? length : 1))) {
+      break;
+    }
+    if (fread (record->buffer, 1, length, file) != length) {
+      free (record->buffer);
+      break;
+    }
+    record->time_ns = be64toh (header.time_ns);
+    record->direction = header.direction;
+    record->length = length;
+    if (header.family == AF_INET6) {
+      struct sockaddr_in6                  *addr = (struct sockaddr_in6 *)&record->peer;
+
+      addr->sin6_family = AF_INET6;
+      addr->sin6_port = header.peer_port;
+      memcpy (&addr->sin6_addr, header.peer_address, 16);
+    } else {
+      struct sockaddr_in                   *addr = (struct sockaddr_in *)&record->peer;
+
+      addr->sin_family = AF_INET;
+      addr->sin_port = header.peer_port;
+      memcpy (&addr->sin_addr, header.peer_address, 4);
+    }
+    nb_records++;
+  }
+  fclose (file);
+  *records = array;
+  return nb_records;
+}
+
+//------------------------------------------------------------------------------
+void sm_record_free (sm_record_t *records, int nb_records)
+{
+  for (int i = 0; i < nb_records; i++) {
+    free (records[i].buffer);
+  }
+  free (records);
+}
@@ -0,0 +1,104 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_record.h
+* \brief Recording of the Sm GTPv2-C datagrams of the MCE, for the replay against a local MCE (sm_replay).
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+*/
+
+#ifndef FILE_SM_RECORD_SEEN
+#define FILE_SM_RECORD_SEEN
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+/**
+ * A record file is a file header followed by one record per datagram, in the order handled by the Sm task.
+ * All fields are in network byte order. The timestamp of a record is the time since the file header (monotonic clock),
+ * the received datagrams are stamped when the Sm task takes them, before the GTPv2-C stack.
+ * The responses of the MCE are recorded too, such that a replay can map the TEIDs and compare the causes.
+ */
+#define SM_RECORD_MAGIC                   (0x534d5243)  ///< "SMRC"
+#define SM_RECORD_VERSION                 (1)
+
+typedef enum {
+  SM_RECORD_DIRECTION_IN = 0,                           ///< Received from an MBMS-GW
+  SM_RECORD_DIRECTION_OUT,                              ///< Sent by the MCE
+} sm_record_direction_t;
+
+typedef struct __attribute__((packed)) sm_record_file_header_s {
+  uint32_t  magic;
+  uint16_t  version;
+  uint16_t  reserved;
+  uint64_t  start_time_ns;                              ///< Wall clock (realtime) of the recording start
+} sm_record_file_header_t;
+
+typedef struct __attribute__((packed)) sm_record_header_s {
+  uint64_t  time_ns;                                    ///< Since the recording start
+  uint8_t   direction;                                  ///< sm_record_direction_t
+  uint8_t   family;                                     ///< AF_INET or AF_INET6, of the peer
+  uint16_t  peer_port;
+  uint8_t   peer_address[16];                           ///< IPv4 address in the first 4 bytes
+  uint32_t  length;                                     ///< Of the datagram following the header
+} sm_record_header_t;
+
+/** A recorded datagram, as read back. */
+typedef struct sm_record_s {
+  uint64_t               time_ns;
+  sm_record_direction_t  direction;
+  struct sockaddr_storage peer;                         ///< Address and port of the peer
+  uint32_t               length;
+  uint8_t               *buffer;                        ///< Owned by the record
+} sm_record_t;
+
+typedef struct sm_recorder_s {
+  FILE      *file;
+  uint64_t   start_ns;
+  uint64_t   records;
+  uint64_t   bytes;
+  uint64_t   failed;                                    ///< Records not written (disk full)
+} sm_recorder_t;
+
+/* @brief Create the record file and write its header. Returns 0, -1 with errno set on failure. */
+int sm_recorder_open(sm_recorder_t *recorder, const char *path);
+
+/* @brief Append a datagram. The peer port is in host byte order. May be called from several threads. */
+void sm_recorder_write(sm_recorder_t *recorder, sm_record_direction_t direction, const struct sockaddr *peer, uint16_t peer_port,
+    const uint8_t *buffer, uint32_t length);
+
+/* @brief Flush and close the record file. */
+void sm_recorder_close(sm_recorder_t *recorder);
+
+/**
+ * Read all the records of a file. The records are allocated in one array, released with sm_record_free().
+ * Returns the number of records, -1 if the file cannot be read or is not a record file. A truncated last record
+ * (recording interrupted) is ignored.
+ */
+int sm_record_read_file(const char *path, sm_record_file_header_t *file_header, sm_record_t **records);
+
+void sm_record_free(sm_record_t *records, int nb_records);
+
+#endif /* FILE_SM_RECORD_SEEN */
@@ -0,0 +1,749 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sm_replay.c
+* \brief Replay of a Sm record file (UDP_SM_RECORD_FILE) against a local MCE.
+* \author Dincer Beken
+* \company Blackned GmbH
+* \email: dbeken@blackned.de
+*
+* The received datagrams of the recording are sent again to the Sm port of the MCE, at the recorded times scaled by
+* the speed factor, or back to back. Each recorded MBMS-GW peer is replayed from its own socket and loopback address
+* (the MCE keys its tunnels on the peer address). The TEID of the MCE in the Update and Stop Requests is replaced by
+* the one the MCE allocated in the replay, learned from the Start Responses.
+* The responses of the MCE are matched to the requests by peer and sequence number. Reported per request type are the
+* response time of the MCE (its processing time, over loopback), the responses lost, the rejects and the causes which
+* differ from the recorded responses. The final service state (active MBMS sessions by TMGI, from the accepted Start
+* and Stop Requests) of the replay is compared to the one of the recording.
+*/
+
+#define _GNU_SOURCE             // required for ppoll()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "NwTypes.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "sm_record.h"
+
+#define SM_REPLAY_DEFAULT_PORT                (2123)
+#define SM_REPLAY_DEFAULT_WAIT                (3)
+#define SM_REPLAY_MAX_PEERS                   (256)
+#define SM_REPLAY_RECV_BUFFER_SIZE            (4096)
+#define SM_REPLAY_SEQ_SLOTS                   (1 << 16)         ///< Outstanding requests per peer, by sequence number
+#define SM_REPLAY_MAX_LISTED                  (16)              ///< TMGIs listed per service state difference
+
+/** Latency histogram in microseconds: exact below 32 us, then 16 buckets per power of two (resolution 6%). */
+#define SM_REPLAY_HIST_SUB_BITS               (4)
+#define SM_REPLAY_HIST_BUCKETS                (48 << SM_REPLAY_HIST_SUB_BITS)
+
+#define NSEC_PER_SEC                          (1000000000ULL)
+#define NSEC_PER_USEC                         (1000ULL)
+
+/** A received datagram of the recording, with what the recording tells about it. */
+typedef struct sm_replay_request_s {
+  const sm_record_t  *record;
+  int                 peer;
+  uint8_t             type;
+  uint32_t            seq;
+  uint32_t            teid;                     ///< Header TEID, the MCE TEID of Update and Stop Requests
+  uint64_t            tmgi;                     ///< Start Requests
+  uint8_t             recorded_cause;           ///< Of the recorded response, 0 if none
+  uint32_t            recorded_mce_teid;        ///< Of the recorded Start Response
+  int32_t             start;                    ///< Update and Stop Requests: index of the Start Request of the session, -1 if none
+  bool                retransmission;           ///< Of the previous request of the peer with the sequence number
+  uint64_t            sent_ns;                  ///< Replay
+  bool                held;                     ///< Waited for the Start Response
+  bool                answered;
+} sm_replay_request_t;
+
+typedef struct sm_replay_peer_s {
+  struct sockaddr_in  recorded;                 ///< MBMS-GW address and port of the recording
+  struct sockaddr_in  local;                    ///< Replay address
+  int                 sd;
+  int32_t            *slots;                    ///< Request index by sequence number, -1 if none
+} sm_replay_peer_t;
+
+typedef struct sm_replay_stats_s {
+  uint64_t  sent;                               ///< Retransmissions not included
+  uint64_t  retransmitted;
+  uint64_t  answered;
+  uint64_t  rejected;                           ///< Cause other than Request Accepted
+  uint64_t  mismatches;                         ///< Cause other than the recorded one
+  uint64_t  unmapped;                           ///< MCE TEID of the recording not known in the replay
+  uint64_t  held;                               ///< Waits for the Start Response of the session
+  uint64_t  latency_sum_us;
+  uint64_t  latency_max_us;
+  uint64_t  hist[SM_REPLAY_HIST_BUCKETS];
+} sm_replay_stats_t;
+
+/** Open addressing map of 32 bit keys (TEIDs, not 0) to 64 bit values. */
+typedef struct sm_replay_map_s {
+  uint32_t  *keys;
+  uint64_t  *values;
+  uint32_t   mask;
+} sm_replay_map_t;
+
+static sm_replay_peer_t                  sm_replay_peers[SM_REPLAY_MAX_PEERS];
+static int                               sm_replay_nb_peers = 0;
+static sm_replay_request_t              *sm_replay_requests = NULL;
+static int                               sm_replay_nb_requests = 0;
+static sm_replay_stats_t                 sm_replay_stats[256];
+static uint64_t                          sm_replay_unmatched = 0;
+static bool                              sm_replay_verbose = false;
+static sm_replay_map_t                   sm_replay_teid_map;          ///< MCE TEID of the recording to the one of the replay
+static sm_replay_map_t                   sm_replay_recorded_tmgi;     ///< MCE TEID of the recording to TMGI
+static sm_replay_map_t                   sm_replay_replayed_tmgi;     ///< MCE TEID of the replay to TMGI
+static sm_replay_map_t                   sm_replay_start_index;       ///< MCE TEID of the recording to the Start Request
+static volatile sig_atomic_t             sm_replay_terminate = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t sm_replay_now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void sm_replay_signal_handler (__attribute__((unused)) int sig)
+{
+  sm_replay_terminate = 1;
+}
+
+/*------------------------------------------------------------------------------
+                                   M A P S
+  ----------------------------------------------------------------------------*/
+
+static void sm_replay_map_init (sm_replay_map_t * map, uint32_t entries)
+{
+  uint32_t                                size = 64;
+
+  while (size < 2 * entries)
+    size <<= 1;
+  map->keys = calloc (size, sizeof (uint32_t));
+  map->values = calloc (size, sizeof (uint64_t));
+  map->mask = size - 1;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t sm_replay_map_slot (const sm_replay_map_t * map, uint32_t key)
+{
+  uint32_t                                slot = (key * 2654435761U) & map->mask;
+
+  while (map->keys[slot] && map->keys[slot] != key)
+    slot = (slot + 1) & map->mask;
+  return slot;
+}
+
+//------------------------------------------------------------------------------
+static void sm_replay_map_put (sm_replay_map_t * map, uint32_t key, uint64_t value)
+{
+  const uint32_t                          slot = sm_replay_map_slot (map, key);
+
+  /** Sized for all the Start Requests of the recording, a key is never removed. */
+  map->keys[slot] = key;
+  map->values[slot] = value;
+}
+
+//------------------------------------------------------------------------------
+static bool sm_replay_map_get (const sm_replay_map_t * map, uint32_t key, uint64_t * value)
+{
+  const uint32_t                          slot = sm_replay_map_slot (map, key);
+
+  if (!key || !map->keys[slot])
+    return false;
+  *value = map->values[slot];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void sm_replay_map_free (sm_replay_map_t * map)
+{
+  free (map->keys);
+  free (map->values);
+}
+
+/*------------------------------------------------------------------------------
+                        L A T E N C Y   H I S T O G R A M
+  ----------------------------------------------------------------------------*/
+
+static uint32_t sm_replay_hist_index (uint64_t us)
+{
+  uint32_t                                shift = 0;
+  uint32_t                                index = 0;
+
+  if (us < (2 << SM_REPLAY_HIST_SUB_BITS))
+    return (uint32_t)us;
+  shift = 63 - __builtin_clzll (us) - SM_REPLAY_HIST_SUB_BITS;
+  index = (shift << SM_REPLAY_HIST_SUB_BITS) + (uint32_t)(us >> shift);
+  return (index < SM_REPLAY_HIST_BUCKETS) ? index : SM_REPLAY_HIST_BUCKETS - 1;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t sm_replay_hist_percentile (const sm_replay_stats_t * stats, double percentile)
+{
+  uint64_t                                count = 0;
+  uint64_t                                rank = (uint64_t)(percentile / 100.0 * stats->answered);
+
+  if (!stats->answered)
+    return 0;
+  if (rank >= stats->answered)
+    rank = stats->answered - 1;
+  for (uint32_t i = 0; i < SM_REPLAY_HIST_BUCKETS; i++) {
+    count += stats->hist[i];
+    if (count > rank) {
+      const uint32_t                        shift = (i >> SM_REPLAY_HIST_SUB_BITS) - 1;
+
+      return (i < (2 << SM_REPLAY_HIST_SUB_BITS)) ? i :
+          (uint64_t)((i & ((1 << SM_REPLAY_HIST_SUB_BITS) - 1)) | (1 << SM_REPLAY_HIST_SUB_BITS)) << shift;
+    }
+  }
+  return stats->latency_max_us;
+}
+
+/*------------------------------------------------------------------------------
+                           G T P v 2 - C   F I E L D S
+  ----------------------------------------------------------------------------*/
+
+static bool sm_replay_parse_header (const uint8_t * buffer, uint32_t length, uint8_t * type, uint32_t * teid, uint32_t * seq, uint32_t * ies)
+{
+  const bool                              teid_present = (length > 0) && (buffer[0] & 0x08);
+  const uint32_t                          header_length = teid_present ? 12 : 8;
+
+  if (length < header_length || (buffer[0] & 0xE0) != 0x40)
+    return false;
+  *type = buffer[1];
+  *teid = teid_present ? ((uint32_t)buffer[4] << 24) | (buffer[5] << 16) | (buffer[6] << 8) | buffer[7] : 0;
+  *seq = ((uint32_t)buffer[header_length - 4] << 16) | (buffer[header_length - 3] << 8) | buffer[header_length - 2];
+  *ies = header_length;
+  return true;
+}
+
+/**
+ * Find the first IE of the type with instance 0 on the top level. Returns its value and length, NULL if none.
+ */
+static const uint8_t *sm_replay_find_ie (const uint8_t * buffer, uint32_t length, uint32_t offset, uint8_t type, uint16_t * ie_length)
+{
+  while (offset + 4 <= length) {
+    const uint16_t                          len = (buffer[offset + 1] << 8) | buffer[offset + 2];
+
+    if (offset + 4 + len > length)
+      return NULL;
+    if (buffer[offset] == type && !(buffer[offset + 3] & 0x0F)) {
+      *ie_length = len;
+      return &buffer[offset + 4];
+    }
+    offset += 4 + len;
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static uint8_t sm_replay_get_cause (const uint8_t * buffer, uint32_t length, uint32_t offset)
+{
+  uint16_t                                len = 0;
+  const uint8_t                          *cause = sm_replay_find_ie (buffer, length, offset, NW_GTPV2C_IE_CAUSE, &len);
+
+  return (cause && len >= 1) ? cause[0] : 0;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t sm_replay_get_fteid (const uint8_t * buffer, uint32_t length, uint32_t offset)
+{
+  uint16_t                                len = 0;
+  const uint8_t                          *fteid = sm_replay_find_ie (buffer, length, offset, NW_GTPV2C_IE_FTEID, &len);
+
+  return (fteid && len >= 5) ? ((uint32_t)fteid[1] << 24) | (fteid[2] << 16) | (fteid[3] << 8) | fteid[4] : 0;
+}
+
+//------------------------------------------------------------------------------
+static const char *sm_replay_type_str (uint8_t type)
+{
+  static char                             other[16];
+
+  switch (type) {
+  case NW_GTP_ECHO_REQ: return "Echo";
+  case NW_GTP_MBMS_SESSION_START_REQ: return "Start";
+  case NW_GTP_MBMS_SESSION_UPDATE_REQ: return "Update";
+  case NW_GTP_MBMS_SESSION_STOP_REQ: return "Stop";
+  default:
+    snprintf (other, sizeof (other), "type %u", type);
+    return other;
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool sm_replay_is_request (uint8_t type)
+{
+  return type == NW_GTP_ECHO_REQ || type == NW_GTP_MBMS_SESSION_START_REQ || type == NW_GTP_MBMS_SESSION_UPDATE_REQ
+      || type == NW_GTP_MBMS_SESSION_STOP_REQ;
+}
+
+/*------------------------------------------------------------------------------
+                             R E C O R D I N G
+  ----------------------------------------------------------------------------*/
+
+static int sm_replay_get_peer (const struct sockaddr_in * addr)
+{
+  for (int i = 0; i < sm_replay_nb_peers; i++) {
+    if (sm_replay_peers[i].recorded.sin_addr.s_addr == addr->sin_addr.s_addr && sm_replay_peers[i].recorded.sin_port == addr->sin_port)
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * Collect the received datagrams to replay, their peers and what the recorded responses of the MCE were.
+ * Returns the number of IPv6 datagrams, which are not replayed.
+ */
+static uint64_t sm_replay_prepare (const sm_record_t * records, int nb_records, uint64_t * nb_recorded_active)
+{
+  uint64_t                                skipped = 0;
+  uint64_t                                tmgi = 0;
+  uint64_t                                start = 0;
+
+  sm_replay_requests = calloc (nb_records, sizeof (sm_replay_request_t));
+  for (int i = 0; i < nb_records; i++) {
+    const sm_record_t                      *record = &records[i];
+    const struct sockaddr_in               *addr = (const struct sockaddr_in *)&record->peer;
+    uint8_t                                 type = 0;
+    uint32_t                                teid = 0, seq = 0, ies = 0;
+    int                                     peer = -1;
+
+    if (record->peer.ss_family != AF_INET) {
+      skipped += (record->direction == SM_RECORD_DIRECTION_IN);
+      continue;
+    }
+    if (!sm_replay_parse_header (record->buffer, record->length, &type, &teid, &seq, &ies))
+      continue;
+    peer = sm_replay_get_peer (addr);
+    if (record->direction == SM_RECORD_DIRECTION_IN) {
+      sm_replay_request_t                  *request = &sm_replay_requests[sm_replay_nb_requests];
+      uint16_t                              len = 0;
+      const uint8_t                        *ie = NULL;
+
+      if (peer < 0) {
+        if (sm_replay_nb_peers == SM_REPLAY_MAX_PEERS) {
+          skipped++;
+          continue;
+        }
+        peer = sm_replay_nb_peers++;
+        sm_replay_peers[peer].recorded = *addr;
+        sm_replay_peers[peer].slots = malloc (SM_REPLAY_SEQ_SLOTS * sizeof (int32_t));
+        memset (sm_replay_peers[peer].slots, 0xff, SM_REPLAY_SEQ_SLOTS * sizeof (int32_t));
+      }
+      request->record = record;
+      request->peer = peer;
+      request->type = type;
+      request->seq = seq;
+      request->teid = teid;
+      request->start = -1;
+      if ((type == NW_GTP_MBMS_SESSION_UPDATE_REQ || type == NW_GTP_MBMS_SESSION_STOP_REQ) && sm_replay_map_get (&sm_replay_start_index, teid, &start))
+        request->start = (int32_t)start;
+      if (sm_replay_peers[peer].slots[seq & (SM_REPLAY_SEQ_SLOTS - 1)] >= 0) {
+        const sm_replay_request_t          *previous = &sm_replay_requests[sm_replay_peers[peer].slots[seq & (SM_REPLAY_SEQ_SLOTS - 1)]];
+
+        if (previous->seq == seq && previous->type == type) {
+          /** The MBMS-GW retransmitted, the MCE answers the original request (cached response). */
+          request->retransmission = true;
+          sm_replay_nb_requests++;
+          continue;
+        }
+      }
+      if (type == NW_GTP_MBMS_SESSION_START_REQ && (ie = sm_replay_find_ie (record->buffer, record->length, ies, NW_GTPV2C_IE_TMGI, &len)) && len >= 6) {
+        for (int b = 0; b < 6; b++)
+          request->tmgi = (request->tmgi << 8) | ie[b];
+      }
+      sm_replay_peers[peer].slots[seq & (SM_REPLAY_SEQ_SLOTS - 1)] = sm_replay_nb_requests++;
+    } else if (peer >= 0) {
+      /** A response of the MCE, to the last request of the peer with the sequence number. */
+      const int32_t                         index = sm_replay_peers[peer].slots[seq & (SM_REPLAY_SEQ_SLOTS - 1)];
+      sm_replay_request_t                  *request = (index >= 0) ? &sm_replay_requests[index] : NULL;
+
+      if (!request || request->seq != seq || type != request->type + 1)
+        continue;
+      request->recorded_cause = sm_replay_get_cause (record->buffer, record->length, ies);
+      if (type == NW_GTP_MBMS_SESSION_START_RSP && request->recorded_cause == NW_GTPV2C_CAUSE_REQUEST_ACCEPTED) {
+        request->recorded_mce_teid = sm_replay_get_fteid (record->buffer, record->length, ies);
+        if (request->recorded_mce_teid) {
+          sm_replay_map_put (&sm_replay_recorded_tmgi, request->recorded_mce_teid, request->tmgi | (1ULL << 63));
+          sm_replay_map_put (&sm_replay_start_index, request->recorded_mce_teid, index);
+        }
+      } else if (type == NW_GTP_MBMS_SESSION_STOP_RSP && request->recorded_cause == NW_GTPV2C_CAUSE_REQUEST_ACCEPTED
+          && sm_replay_map_get (&sm_replay_recorded_tmgi, request->teid, &tmgi)) {
+        sm_replay_map_put (&sm_replay_recorded_tmgi, request->teid, tmgi & ~(1ULL << 63));
+      }
+    }
+  }
+  for (uint32_t slot = 0; slot <= sm_replay_recorded_tmgi.mask; slot++)
+    *nb_recorded_active += sm_replay_recorded_tmgi.keys[slot] && (sm_replay_recorded_tmgi.values[slot] >> 63);
+  for (int peer = 0; peer < sm_replay_nb_peers; peer++)
+    memset (sm_replay_peers[peer].slots, 0xff, SM_REPLAY_SEQ_SLOTS * sizeof (int32_t));
+  return skipped;
+}
+
+/*------------------------------------------------------------------------------
+                                 R E P L A Y
+  ----------------------------------------------------------------------------*/
+
+static void sm_replay_send (sm_replay_request_t * request, const struct sockaddr_in * mce_addr)
+{
+  sm_replay_peer_t                       *peer = &sm_replay_peers[request->peer];
+  uint8_t                                 buffer[SM_REPLAY_RECV_BUFFER_SIZE];
+  uint32_t                                length = request->record->length;
+  uint64_t                                teid = 0;
+
+  if (length > sizeof (buffer))
+    return;
+  memcpy (buffer, request->record->buffer, length);
+  /** Update and Stop Requests are sent to the MCE TEID of the replay. */
+  if (request->teid && (request->type == NW_GTP_MBMS_SESSION_UPDATE_REQ || request->type == NW_GTP_MBMS_SESSION_STOP_REQ)) {
+    if (sm_replay_map_get (&sm_replay_teid_map, request->teid, &teid)) {
+      buffer[4] = teid >> 24; buffer[5] = teid >> 16; buffer[6] = teid >> 8; buffer[7] = teid;
+    } else {
+      sm_replay_stats[request->type].unmapped++;
+    }
+  }
+  if (request->retransmission) {
+    sm_replay_stats[request->type].retransmitted++;
+  } else {
+    request->sent_ns = sm_replay_now_ns ();
+    request->answered = false;
+    if (sm_replay_is_request (request->type)) {
+      peer->slots[request->seq & (SM_REPLAY_SEQ_SLOTS - 1)] = request - sm_replay_requests;
+    }
+    sm_replay_stats[request->type].sent++;
+  }
+  if (sendto (peer->sd, buffer, length, 0, (const struct sockaddr *)mce_addr, sizeof (*mce_addr)) < 0) {
+    fprintf (stderr, "sendto: %s\n", strerror (errno));
+  }
+}
+
+//------------------------------------------------------------------------------
+static void sm_replay_handle_response (int peer, const uint8_t * buffer, uint32_t length)
+{
+  uint8_t                                 type = 0;
+  uint32_t                                teid = 0, seq = 0, ies = 0;
+  int32_t                                 index = -1;
+  sm_replay_request_t                    *request = NULL;
+  sm_replay_stats_t                      *stats = NULL;
+  uint64_t                                latency_us = 0;
+  uint64_t                                tmgi = 0;
+  uint8_t                                 cause = 0;
+
+  if (!sm_replay_parse_header (buffer, length, &type, &teid, &seq, &ies)
+      || (index = sm_replay_peers[peer].slots[seq & (SM_REPLAY_SEQ_SLOTS - 1)]) < 0
+      || (request = &sm_replay_requests[index])->seq != seq || type != request->type + 1 || request->answered) {
+    sm_replay_unmatched++;
+    return;
+  }
+  stats = &sm_replay_stats[request->type];
+  request->answered = true;
+  latency_us = (sm_replay_now_ns () - request->sent_ns) / NSEC_PER_USEC;
+  stats->answered++;
+  stats->latency_sum_us += latency_us;
+  if (latency_us > stats->latency_max_us)
+    stats->latency_max_us = latency_us;
+  stats->hist[sm_replay_hist_index (latency_us)]++;
+  if (type == NW_GTP_ECHO_RSP)
+    return;
+
+  cause = sm_replay_get_cause (buffer, length, ies);
+  if (cause != NW_GTPV2C_CAUSE_REQUEST_ACCEPTED)
+    stats->rejected++;
+  if (cause != request->recorded_cause) {
+    stats->mismatches++;
+    if (sm_replay_verbose)
+      fprintf (stderr, "%s Request seq %u of peer %d: cause %u, recorded %u\n", sm_replay_type_str (request->type), seq, peer, cause,
+          request->recorded_cause);
+  }
+  if (cause != NW_GTPV2C_CAUSE_REQUEST_ACCEPTED)
+    return;
+  if (type == NW_GTP_MBMS_SESSION_START_RSP) {
+    const uint32_t                          mce_teid = sm_replay_get_fteid (buffer, length, ies);
+
+    if (mce_teid) {
+      if (request->recorded_mce_teid)
+        sm_replay_map_put (&sm_replay_teid_map, request->recorded_mce_teid, mce_teid);
+      sm_replay_map_put (&sm_replay_replayed_tmgi, mce_teid, request->tmgi | (1ULL << 63));
+    }
+  } else if (type == NW_GTP_MBMS_SESSION_STOP_RSP) {
+    uint64_t                                mce_teid = request->teid;
+
+    sm_replay_map_get (&sm_replay_teid_map, request->teid, &mce_teid);
+    if (sm_replay_map_get (&sm_replay_replayed_tmgi, mce_teid, &tmgi))
+      sm_replay_map_put (&sm_replay_replayed_tmgi, mce_teid, tmgi & ~(1ULL << 63));
+  }
+}
+
+//------------------------------------------------------------------------------
+static void sm_replay_poll (struct pollfd * pfds, uint64_t deadline_ns)
+{
+  uint8_t                                 buffer[SM_REPLAY_RECV_BUFFER_SIZE];
+  const uint64_t                          now_ns = sm_replay_now_ns ();
+  struct timespec                         timeout = {0};
+
+  if (deadline_ns > now_ns) {
+    timeout.tv_sec = (deadline_ns - now_ns) / NSEC_PER_SEC;
+    timeout.tv_nsec = (deadline_ns - now_ns) % NSEC_PER_SEC;
+  }
+  if (ppoll (pfds, sm_replay_nb_peers, &timeout, NULL) <= 0)
+    return;
+  for (int peer = 0; peer < sm_replay_nb_peers; peer++) {
+    ssize_t                                 len = 0;
+
+    if (!(pfds[peer].revents & POLLIN))
+      continue;
+    while ((len = recv (pfds[peer].fd, buffer, sizeof (buffer), 0)) > 0)
+      sm_replay_handle_response (peer, buffer, len);
+  }
+}
+
+/*------------------------------------------------------------------------------
+                                 R E P O R T
+  ----------------------------------------------------------------------------*/
+
+/**
+ * List the TMGIs active in one service state and not in the other. Returns their number.
+ */
+static uint64_t sm_replay_diff_state (const sm_replay_map_t * state, const sm_replay_map_t * other, const char *label)
+{
+  uint64_t                                nb_diff = 0;
+
+  for (uint32_t slot = 0; slot <= state->mask; slot++) {
+    const uint64_t                          tmgi = state->values[slot] & ~(1ULL << 63);
+    bool                                    found = false;
+
+    if (!state->keys[slot] || !(state->values[slot] >> 63))
+      continue;
+    for (uint32_t o = 0; o <= other->mask && !found; o++)
+      found = other->keys[o] && (other->values[o] >> 63) && (other->values[o] & ~(1ULL << 63)) == tmgi;
+    if (found)
+      continue;
+    if (nb_diff++ < SM_REPLAY_MAX_LISTED)
+      printf ("  TMGI %012" PRIx64 " active %s only\n", tmgi, label);
+  }
+  return nb_diff;
+}
+
+//------------------------------------------------------------------------------
+static void sm_replay_report (double seconds, uint64_t nb_recorded_active)
+{
+  uint64_t                                nb_active = 0;
+  uint64_t                                nb_diff = 0;
+
+  printf ("\n%-8s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n", "request", "sent", "retrans", "held", "answered", "lost", "rejected",
+      "mismatch", "unmapped", "avg us", "p50 us", "p90 us", "p99 us", "max us");
+  for (int type = 0; type < 256; type++) {
+    const sm_replay_stats_t                *s = &sm_replay_stats[type];
+
+    if (!s->sent)
+      continue;
+    if (!sm_replay_is_request (type)) {
+      printf ("%-8s %9" PRIu64 " (not a request, not answered)\n", sm_replay_type_str (type), s->sent);
+      continue;
+    }
+    printf ("%-8s %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64
+        " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 "\n",
+        sm_replay_type_str (type), s->sent, s->retransmitted, s->held, s->answered, s->sent - s->answered, s->rejected, s->mismatches, s->unmapped,
+        s->answered ? s->latency_sum_us / s->answered : 0, sm_replay_hist_percentile (s, 50), sm_replay_hist_percentile (s, 90),
+        sm_replay_hist_percentile (s, 99), s->latency_max_us);
+  }
+  printf ("Replayed in %.3f s", seconds);
+  if (sm_replay_unmatched)
+    printf (", %" PRIu64 " unmatched datagrams (responses to retransmissions included)", sm_replay_unmatched);
+  printf ("\n");
+
+  /** Final service state: the MBMS sessions active after the accepted Start and Stop Requests. */
+  for (uint32_t slot = 0; slot <= sm_replay_replayed_tmgi.mask; slot++)
+    nb_active += sm_replay_replayed_tmgi.keys[slot] && (sm_replay_replayed_tmgi.values[slot] >> 63);
+  printf ("Final service state: %" PRIu64 " active MBMS sessions, %" PRIu64 " in the recording\n", nb_active, nb_recorded_active);
+  nb_diff += sm_replay_diff_state (&sm_replay_replayed_tmgi, &sm_replay_recorded_tmgi, "in the replay");
+  nb_diff += sm_replay_diff_state (&sm_replay_recorded_tmgi, &sm_replay_replayed_tmgi, "in the recording");
+  printf ("%s\n", nb_diff ? "Service state differs from the recording" : "Service state matches the recording");
+}
+
+/*------------------------------------------------------------------------------
+                                  M A I N
+  ----------------------------------------------------------------------------*/
+
+static void sm_replay_usage (const char * const name)
+{
+  fprintf (stderr, "Usage: %s -f file [options]\n", name);
+  fprintf (stderr, "  -f file          Sm record file (UDP_SM_RECORD_FILE of the MCE)\n");
+  fprintf (stderr, "  -a address       MCE Sm address (default 127.0.0.1)\n");
+  fprintf (stderr, "  -p port          MCE Sm port (default %d)\n", SM_REPLAY_DEFAULT_PORT);
+  fprintf (stderr, "  -l address       local address of the first MBMS-GW peer, incremented per peer (default 127.0.1.1)\n");
+  fprintf (stderr, "  -s speed         speed factor on the recorded times, 0 sends back to back (default 1)\n");
+  fprintf (stderr, "  -w seconds       wait for the last responses (default %d)\n", SM_REPLAY_DEFAULT_WAIT);
+  fprintf (stderr, "  -v               print the causes differing from the recording\n");
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  const char                             *path = NULL;
+  const char                             *mce_address = "127.0.0.1";
+  const char                             *local_address = "127.0.1.1";
+  struct sockaddr_in                      mce_addr = {.sin_family = AF_INET, .sin_port = htons (SM_REPLAY_DEFAULT_PORT)};
+  struct in_addr                          local_base;
+  double                                  speed = 1.0;
+  uint32_t                                wait = SM_REPLAY_DEFAULT_WAIT;
+  sm_record_file_header_t                 file_header;
+  sm_record_t                            *records = NULL;
+  int                                     nb_records = 0;
+  uint64_t                                nb_skipped = 0;
+  uint64_t                                nb_recorded_active = 0;
+  struct pollfd                          *pfds = NULL;
+  uint64_t                                start_ns = 0, first_ns = 0, end_ns = 0;
+  int                                     next = 0;
+  int                                     opt = 0;
+
+  while ((opt = getopt (argc, argv, "f:a:p:l:s:w:vh")) != -1) {
+    switch (opt) {
+    case 'f': path = optarg; break;
+    case 'a': mce_address = optarg; break;
+    case 'p': mce_addr.sin_port = htons ((uint16_t)atoi (optarg)); break;
+    case 'l': local_address = optarg; break;
+    case 's': speed = atof (optarg); break;
+    case 'w': wait = atoi (optarg); break;
+    case 'v': sm_replay_verbose = true; break;
+    default:
+      sm_replay_usage (argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (!path || speed < 0 || inet_pton (AF_INET, mce_address, &mce_addr.sin_addr) != 1 || inet_pton (AF_INET, local_address, &local_base) != 1) {
+    sm_replay_usage (argv[0]);
+    return 1;
+  }
+  if ((nb_records = sm_record_read_file (path, &file_header, &records)) < 0) {
+    fprintf (stderr, "Could not read the record file %s: %s\n", path, strerror (errno));
+    return 1;
+  }
+  sm_replay_map_init (&sm_replay_teid_map, nb_records);
+  sm_replay_map_init (&sm_replay_recorded_tmgi, nb_records);
+  sm_replay_map_init (&sm_replay_replayed_tmgi, nb_records);
+  sm_replay_map_init (&sm_replay_start_index, nb_records);
+  nb_skipped = sm_replay_prepare (records, nb_records, &nb_recorded_active);
+  if (!sm_replay_nb_requests) {
+    fprintf (stderr, "No received IPv4 datagram in %s\n", path);
+    return 1;
+  }
+
+  /** One socket per recorded MBMS-GW, on consecutive local addresses. */
+  pfds = calloc (sm_replay_nb_peers, sizeof (struct pollfd));
+  for (int peer = 0; peer < sm_replay_nb_peers; peer++) {
+    sm_replay_peer_t                       *p = &sm_replay_peers[peer];
+
+    p->local.sin_family = AF_INET;
+    p->local.sin_addr.s_addr = htonl (ntohl (local_base.s_addr) + peer);
+    if ((p->sd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0 || bind (p->sd, (struct sockaddr *)&p->local, sizeof (p->local)) < 0
+        || fcntl (p->sd, F_SETFL, O_NONBLOCK) < 0) {
+      fprintf (stderr, "Could not open the socket of peer %d on %s: %s\n", peer, inet_ntoa (p->local.sin_addr), strerror (errno));
+      return 1;
+    }
+    pfds[peer].fd = p->sd;
+    pfds[peer].events = POLLIN;
+  }
+  printf ("Replaying %d datagrams of %d MBMS-GW peers from %s (recording of %.3f s, %" PRIu64 " IPv6 datagrams skipped) to %s:%u, ",
+      sm_replay_nb_requests, sm_replay_nb_peers, path,
+      (double)(sm_replay_requests[sm_replay_nb_requests - 1].record->time_ns - sm_replay_requests[0].record->time_ns) / NSEC_PER_SEC,
+      nb_skipped, mce_address, ntohs (mce_addr.sin_port));
+  if (speed)
+    printf ("speed x%.2f\n", speed);
+  else
+    printf ("back to back\n");
+  signal (SIGINT, sm_replay_signal_handler);
+  signal (SIGTERM, sm_replay_signal_handler);
+
+  /**
+   * Send each datagram at its recorded time, relative to the first one and scaled. An Update or Stop Request waits for
+   * the response to the Start Request of its session (at most the wait time), which gives the MCE TEID of the replay:
+   * the order of the procedures of a session is kept, whatever the speed.
+   */
+  first_ns = sm_replay_requests[0].record->time_ns;
+  start_ns = sm_replay_now_ns ();
+  while (!sm_replay_terminate && next < sm_replay_nb_requests) {
+    const uint64_t                          now_ns = sm_replay_now_ns ();
+    uint64_t                                due_ns = now_ns;
+
+    while (next < sm_replay_nb_requests) {
+      const sm_replay_request_t            *start = (sm_replay_requests[next].start >= 0) ? &sm_replay_requests[sm_replay_requests[next].start] : NULL;
+
+      due_ns = speed ? start_ns + (uint64_t)((sm_replay_requests[next].record->time_ns - first_ns) / speed) : now_ns;
+      if (due_ns > now_ns)
+        break;
+      if (start && !start->answered && now_ns < start->sent_ns + (uint64_t)wait * NSEC_PER_SEC) {
+        if (!sm_replay_requests[next].held) {
+          sm_replay_requests[next].held = true;
+          sm_replay_stats[sm_replay_requests[next].type].held++;
+        }
+        due_ns = start->sent_ns + (uint64_t)wait * NSEC_PER_SEC;
+        break;
+      }
+      sm_replay_send (&sm_replay_requests[next++], &mce_addr);
+    }
+    sm_replay_poll (pfds, (next < sm_replay_nb_requests) ? due_ns : now_ns);
+  }
+  end_ns = sm_replay_now_ns ();
+
+  /** Wait for the last responses. */
+  while (!sm_replay_terminate && sm_replay_now_ns () < end_ns + (uint64_t)wait * NSEC_PER_SEC) {
+    uint64_t                                pending = 0;
+
+    for (int type = 0; type < 256; type++)
+      pending += sm_replay_is_request (type) ? sm_replay_stats[type].sent - sm_replay_stats[type].answered : 0;
+    if (!pending)
+      break;
+    sm_replay_poll (pfds, sm_replay_now_ns () + NSEC_PER_SEC / 10);
+  }
+  sm_replay_report ((double)(end_ns - start_ns) / NSEC_PER_SEC, nb_recorded_active);
+
+  for (int peer = 0; peer < sm_replay_nb_peers; peer++) {
+    close (sm_replay_peers[peer].sd);
+    free (sm_replay_peers[peer].slots);
+  }
+  free (pfds);
+  free (sm_replay_requests);
+  sm_record_free (records, nb_records);
+  sm_replay_map_free (&sm_replay_teid_map);
+  sm_replay_map_free (&sm_replay_recorded_tmgi);
+  sm_replay_map_free (&sm_replay_replayed_tmgi);
+  sm_replay_map_free (&sm_replay_start_index);
+  return 0;
+}
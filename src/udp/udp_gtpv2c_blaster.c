@@ -0,0 +1,340 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_gtpv2c_blaster.c
+  \brief Local GTPv2-C blaster for the Sm receive path of the MCE.
+  Sends GTPv2-C Echo Requests (each with its own sequence number) in batches to the Sm port and counts the Echo Responses.
+  Each simulated MBMS-GW peer has its own socket (source port) and thread, such that several Sm listener sockets of
+  the MCE (SO_REUSEPORT) can be loaded. Reports the sent and answered packets per second, per report interval and for
+  the whole run.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#define _GNU_SOURCE             // required for sendmmsg() and recvmmsg()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define UDP_BLASTER_DEFAULT_PORT            2123
+#define UDP_BLASTER_DEFAULT_BATCH           32
+#define UDP_BLASTER_DEFAULT_DURATION        10
+#define UDP_BLASTER_DEFAULT_INTERVAL        1
+#define UDP_BLASTER_MAX_BATCH               1024
+#define UDP_BLASTER_MAX_PEERS               256
+#define UDP_BLASTER_ECHO_REQUEST_LENGTH     13      ///< Header without TEID (8) and Recovery IE (5)
+#define UDP_BLASTER_RECV_BUFFER_SIZE        4096
+
+#define GTPV2C_ECHO_REQUEST                 1
+#define GTPV2C_ECHO_RESPONSE                2
+#define GTPV2C_IE_RECOVERY                  3
+
+#define NSEC_PER_SEC                        1000000000ULL
+
+typedef struct udp_blaster_stats_s {
+  uint64_t  sent;
+  uint64_t  send_failed;              ///< Datagrams not taken by the socket (buffer full)
+  uint64_t  answered;                 ///< Echo Responses
+  uint64_t  other;                    ///< Other received datagrams
+} udp_blaster_stats_t;
+
+/** A simulated MBMS-GW peer, sending from its own socket. */
+typedef struct udp_blaster_peer_s {
+  int                       index;
+  int                       sd;
+  pthread_t                 thread;
+  const struct sockaddr_in *mce_addr;
+  int                       batch;
+  double                    rate;               ///< Per peer, 0 unlimited
+  uint64_t                  start_ns;
+  uint64_t                  end_ns;
+  udp_blaster_stats_t       stats;              ///< Read by the main thread for the reports
+} udp_blaster_peer_t;
+
+static volatile sig_atomic_t            udp_blaster_terminate = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t udp_blaster_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void udp_blaster_signal_handler (__attribute__((unused)) int sig)
+{
+  udp_blaster_terminate = 1;
+}
+
+//------------------------------------------------------------------------------
+static void udp_blaster_encode_echo_request (uint8_t * const buffer, const uint32_t sequence_number)
+{
+  buffer[0] = 0x40;                                 /**< Version 2, no piggybacking, no TEID */
+  buffer[1] = GTPV2C_ECHO_REQUEST;
+  buffer[2] = 0;
+  buffer[3] = UDP_BLASTER_ECHO_REQUEST_LENGTH - 4;
+  buffer[4] = (sequence_number >> 16) & 0xFF;
+  buffer[5] = (sequence_number >> 8) & 0xFF;
+  buffer[6] = sequence_number & 0xFF;
+  buffer[7] = 0;
+  buffer[8] = GTPV2C_IE_RECOVERY;
+  buffer[9] = 0;
+  buffer[10] = 1;
+  buffer[11] = 0;                                   /**< Instance */
+  buffer[12] = 0;                                   /**< Restart counter */
+}
+
+//------------------------------------------------------------------------------
+static void udp_blaster_receive (const int sd, udp_blaster_stats_t * const stats, const int batch)
+{
+  static uint8_t          buffers[UDP_BLASTER_MAX_BATCH][UDP_BLASTER_RECV_BUFFER_SIZE];
+  struct iovec            iovecs[UDP_BLASTER_MAX_BATCH];
+  struct mmsghdr          msgs[UDP_BLASTER_MAX_BATCH];
+  int                     n = 0;
+
+  do {
+    memset(msgs, 0, batch * sizeof(struct mmsghdr));
+    for (int i = 0; i < batch; i++) {
+      iovecs[i].iov_base = buffers[i];
+      iovecs[i].iov_len = UDP_BLASTER_RECV_BUFFER_SIZE;
+      msgs[i].msg_hdr.msg_iov = &iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    if ((n = recvmmsg(sd, msgs, batch, MSG_DONTWAIT, NULL)) <= 0)
+      return;
+    for (int i = 0; i < n; i++) {
+      if (msgs[i].msg_len >= 8 && (buffers[i][0] & 0xE0) == 0x40 && buffers[i][1] == GTPV2C_ECHO_RESPONSE)
+        stats->answered++;
+      else
+        stats->other++;
+    }
+  } while (n == batch);
+}
+
+//------------------------------------------------------------------------------
+static void *udp_blaster_peer_thread (void *arg)
+{
+  udp_blaster_peer_t * const peer = (udp_blaster_peer_t*)arg;
+  uint8_t               (*requests)[UDP_BLASTER_ECHO_REQUEST_LENGTH] = calloc(peer->batch, UDP_BLASTER_ECHO_REQUEST_LENGTH);
+  struct iovec           *iovecs = calloc(peer->batch, sizeof(struct iovec));
+  struct mmsghdr         *msgs = calloc(peer->batch, sizeof(struct mmsghdr));
+  udp_blaster_stats_t     total = {0};
+  uint32_t                sequence_number = (uint32_t)peer->index << 16;
+
+  while (!udp_blaster_terminate && requests && iovecs && msgs) {
+    const uint64_t now_ns = udp_blaster_now_ns();
+    int num = peer->batch;
+    int n = 0;
+
+    if (now_ns >= peer->end_ns)
+      break;
+    if (peer->rate > 0) {
+      const uint64_t due = (uint64_t)((double)(now_ns - peer->start_ns) * peer->rate / NSEC_PER_SEC);
+      num = (due > total.sent) ? (int)((due - total.sent < (uint64_t)peer->batch) ? due - total.sent : (uint64_t)peer->batch) : 0;
+    }
+
+    if (num > 0) {
+      memset(msgs, 0, num * sizeof(struct mmsghdr));
+      for (int i = 0; i < num; i++) {
+        udp_blaster_encode_echo_request(requests[i], (sequence_number + i) & 0xFFFFFF);
+        iovecs[i].iov_base = requests[i];
+        iovecs[i].iov_len = UDP_BLASTER_ECHO_REQUEST_LENGTH;
+        msgs[i].msg_hdr.msg_name = (void*)peer->mce_addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+      if ((n = sendmmsg(peer->sd, msgs, num, MSG_DONTWAIT)) < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED) {
+          fprintf(stderr, "peer %d sendmmsg: %s\n", peer->index, strerror(errno));
+          break;
+        }
+        n = 0;
+      }
+      sequence_number += n;
+      total.sent += n;
+      total.send_failed += num - n;
+    }
+
+    udp_blaster_receive(peer->sd, &total, peer->batch);
+    if (peer->rate > 0 || num == 0) {
+      /** Paced, wait for the responses or the next due request. */
+      struct pollfd pfd = {.fd = peer->sd, .events = POLLIN};
+      poll(&pfd, 1, 1);
+    }
+    peer->stats = total;
+  }
+
+  /** Collect the late responses. */
+  for (int i = 0; i < 100; i++) {
+    struct pollfd pfd = {.fd = peer->sd, .events = POLLIN};
+    if (poll(&pfd, 1, 10) <= 0)
+      break;
+    udp_blaster_receive(peer->sd, &total, peer->batch);
+  }
+  peer->stats = total;
+  free(requests);
+  free(iovecs);
+  free(msgs);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void udp_blaster_sum_stats (const udp_blaster_peer_t * const peers, const int nb_peers, udp_blaster_stats_t * const sum)
+{
+  memset(sum, 0, sizeof(*sum));
+  for (int p = 0; p < nb_peers; p++) {
+    const udp_blaster_stats_t stats = peers[p].stats;
+    sum->sent += stats.sent;
+    sum->send_failed += stats.send_failed;
+    sum->answered += stats.answered;
+    sum->other += stats.other;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void udp_blaster_report (const char * const what, const udp_blaster_stats_t * const stats, const double seconds)
+{
+  printf("%-8s %10lu sent %10.1f pkt/s  %10lu answered %10.1f pkt/s  %8lu send failures  %6lu other\n", what,
+      stats->sent, seconds > 0 ? stats->sent / seconds : 0.0,
+      stats->answered, seconds > 0 ? stats->answered / seconds : 0.0,
+      stats->send_failed, stats->other);
+  fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+static void udp_blaster_usage (const char * const name)
+{
+  fprintf(stderr, "Usage: %s [options]\n", name);
+  fprintf(stderr, "  -a address   MCE Sm address (default 127.0.0.1)\n");
+  fprintf(stderr, "  -p port      MCE Sm port (default %d)\n", UDP_BLASTER_DEFAULT_PORT);
+  fprintf(stderr, "  -c peers     simulated MBMS-GW peers, each with its own socket and thread (default 1, max %d)\n", UDP_BLASTER_MAX_PEERS);
+  fprintf(stderr, "  -b batch     datagrams per sendmmsg (default %d, max %d)\n", UDP_BLASTER_DEFAULT_BATCH, UDP_BLASTER_MAX_BATCH);
+  fprintf(stderr, "  -r rate      Echo Requests per second over all peers, up to 1000 batches per second and peer (default as fast as possible)\n");
+  fprintf(stderr, "  -t seconds   duration (default %d)\n", UDP_BLASTER_DEFAULT_DURATION);
+  fprintf(stderr, "  -i seconds   report interval (default %d)\n", UDP_BLASTER_DEFAULT_INTERVAL);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  const char             *address = "127.0.0.1";
+  uint16_t                port = UDP_BLASTER_DEFAULT_PORT;
+  int                     nb_peers = 1;
+  int                     batch = UDP_BLASTER_DEFAULT_BATCH;
+  double                  rate = 0;
+  int                     duration = UDP_BLASTER_DEFAULT_DURATION;
+  int                     interval = UDP_BLASTER_DEFAULT_INTERVAL;
+  struct sockaddr_in      mce_addr = {0};
+  udp_blaster_peer_t     *peers = NULL;
+  udp_blaster_stats_t     total = {0};
+  udp_blaster_stats_t     last = {0};
+  uint64_t                start_ns = 0;
+  uint64_t                report_ns = 0;
+  int                     nb_started = 0;
+  int                     opt = 0;
+
+  while ((opt = getopt(argc, argv, "a:p:c:b:r:t:i:h")) != -1) {
+    switch (opt) {
+    case 'a': address = optarg; break;
+    case 'p': port = (uint16_t)atoi(optarg); break;
+    case 'c': nb_peers = atoi(optarg); break;
+    case 'b': batch = atoi(optarg); break;
+    case 'r': rate = atof(optarg); break;
+    case 't': duration = atoi(optarg); break;
+    case 'i': interval = atoi(optarg); break;
+    default:
+      udp_blaster_usage(argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  mce_addr.sin_family = AF_INET;
+  mce_addr.sin_port = htons(port);
+  if (nb_peers <= 0 || nb_peers > UDP_BLASTER_MAX_PEERS || batch <= 0 || batch > UDP_BLASTER_MAX_BATCH || duration <= 0 || interval <= 0
+      || inet_pton(AF_INET, address, &mce_addr.sin_addr) != 1) {
+    udp_blaster_usage(argv[0]);
+    return 1;
+  }
+  signal(SIGINT, udp_blaster_signal_handler);
+  signal(SIGTERM, udp_blaster_signal_handler);
+
+  printf("Echo Requests towards %s:%u from %d peers, %d per sendmmsg, rate %.1f/s (0: unlimited), %d s\n",
+      address, port, nb_peers, batch, rate, duration);
+  peers = calloc(nb_peers, sizeof(udp_blaster_peer_t));
+  start_ns = report_ns = udp_blaster_now_ns();
+  for (int p = 0; p < nb_peers; p++) {
+    peers[p].index = p;
+    peers[p].mce_addr = &mce_addr;
+    peers[p].batch = batch;
+    peers[p].rate = rate / nb_peers;
+    peers[p].start_ns = start_ns;
+    peers[p].end_ns = start_ns + (uint64_t)duration * NSEC_PER_SEC;
+    if ((peers[p].sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
+      fprintf(stderr, "socket: %s\n", strerror(errno));
+      break;
+    }
+    if (pthread_create(&peers[p].thread, NULL, udp_blaster_peer_thread, &peers[p])) {
+      fprintf(stderr, "Could not start peer %d\n", p);
+      close(peers[p].sd);
+      break;
+    }
+    nb_started++;
+  }
+
+  while (!udp_blaster_terminate && nb_started) {
+    const uint64_t now_ns = udp_blaster_now_ns();
+
+    if (now_ns - start_ns >= (uint64_t)duration * NSEC_PER_SEC)
+      break;
+    if (now_ns - report_ns >= (uint64_t)interval * NSEC_PER_SEC) {
+      udp_blaster_sum_stats(peers, nb_started, &total);
+      udp_blaster_stats_t delta = {
+        .sent = total.sent - last.sent, .send_failed = total.send_failed - last.send_failed,
+        .answered = total.answered - last.answered, .other = total.other - last.other};
+      udp_blaster_report("interval", &delta, (double)(now_ns - report_ns) / NSEC_PER_SEC);
+      last = total;
+      report_ns = now_ns;
+    }
+    usleep(10000);
+  }
+
+  for (int p = 0; p < nb_started; p++) {
+    pthread_join(peers[p].thread, NULL);
+    close(peers[p].sd);
+  }
+  udp_blaster_sum_stats(peers, nb_started, &total);
+  udp_blaster_report("total", &total, (double)(udp_blaster_now_ns() - start_ns) / NSEC_PER_SEC);
+  free(peers);
+  return nb_started ? 0 : 1;
+}
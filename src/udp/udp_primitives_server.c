@@ -26,6 +26,7 @@
   \email: lionel.gauthier@eurecom.fr
 */
 
+#define _GNU_SOURCE             // required for recvmmsg() and sendmmsg()
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,8 +39,12 @@
 #include <fcntl.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include <poll.h>
 
 #include "bstrlib.h"
+#include "hashtable.h"
 
 #include "dynamic_memory_check.h"
 #include "assertions.h"
@@ -50,34 +55,150 @@
 #include "intertask_interface.h"
 #include "udp_primitives_server.h"
 #include "itti_free_defined_msg.h"
+#include "mme_default_values.h"
 
 
+/** Peer address of a received datagram. */
+typedef union udp_peer_addr_u {
+  struct sockaddr_in                      addrv4;
+  struct sockaddr_in6                     addrv6;
+} udp_peer_addr_t;
+
+/** Receive statistics of a socket, written by the thread serving the socket only. */
+typedef struct udp_recv_stats_s {
+  uint64_t                                datagrams;
+  uint64_t                                bytes;
+  uint64_t                                batches;      ///< recvmmsg calls which returned datagrams
+  uint64_t                                first_ns;
+  uint64_t                                last_ns;
+} udp_recv_stats_t;
+
 struct udp_socket_desc_s {
-  uint8_t                                 buffer[4096];
+  /** Receive batch, filled by a single recvmmsg. */
+  uint8_t                               (*buffers)[UDP_DATA_MAX_MSG_LEN];
+  struct iovec                           *iovecs;
+  struct mmsghdr                         *msgs;
+  udp_peer_addr_t                        *peer_addrs;
+
+  /** Send batch, the queued UDP_DATA_REQ datagrams written by a single sendmmsg. */
+  uint8_t                               (*send_buffers)[UDP_DATA_MAX_MSG_LEN];
+  struct iovec                           *send_iovecs;
+  struct mmsghdr                         *send_msgs;
+  udp_peer_addr_t                        *send_peer_addrs;
+  int                                     nb_send_pending;
+  bool                                    send_listed;  /* In the list of sockets to flush */
+
   int                                     sd;   /* Socket descriptor to use */
 
   pthread_t                               listener_thread;      /* Thread affected to recv */
+  bool                                    listener_started;     /* Served by listener_thread instead of the UDP task */
+  volatile bool                           listener_stop;
+  int                                     listener_index;       /* Index among the SO_REUSEPORT sockets of the address */
+  udp_recv_stats_t                        recv_stats;
 
-  struct sockaddr                         local_addr;        /* Local ipv4 or ipv6 address to use */
+  struct sockaddr_storage                 local_addr;        /* Local ipv4 or ipv6 address to use */
   uint16_t                                local_port;   /* Local port to use */
+  struct udp_socket_desc_s               *next_on_port;        /* Socket of the task on the next local address, same family and port */
+  struct udp_socket_desc_s               *next_on_high_port;   /* Same, among the sockets bound to a high port */
 
   task_id_t                               task_id;      /* Task who has requested the new endpoint */
                                           STAILQ_ENTRY (
   udp_socket_desc_s)                      entries;
+                                          STAILQ_ENTRY (
+  udp_socket_desc_s)                      send_entries;
 };
 
+/*
+ * The socket list, its indexes and the send list are only accessed by the UDP task (UDP_INIT, UDP_DATA_REQ, socket events),
+ * no lock is needed. A listener thread only receives on its own socket.
+ */
 static
 STAILQ_HEAD (
   udp_socket_list_s,
   udp_socket_desc_s) udp_socket_list;
-     static pthread_mutex_t                  udp_socket_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+static
+STAILQ_HEAD (
+  udp_send_list_s,
+  udp_socket_desc_s) udp_send_list;
+static hash_table_t                    *udp_socket_sd_htbl = NULL;      ///< Key socket descriptor
+static hash_table_t                    *udp_socket_port_htbl = NULL;    ///< Key UDP_SOCKET_KEY (task, address family, local port)
+
+#define UDP_SOCKET_TABLE_SIZE     16
+/** The sockets of a task on the same family and port, one per local address, are chained from the entry of the key. */
+#define UDP_SOCKET_KEY(tASK, fAMILY, pORT)  (((hash_key_t)(tASK) << 32) | ((hash_key_t)(fAMILY) << 16) | (hash_key_t)(pORT))
+
+/** Send statistics, written by the UDP task only. */
+typedef struct udp_send_stats_s {
+  uint64_t                                datagrams;
+  uint64_t                                bytes;
+  uint64_t                                batches;      ///< sendmmsg calls which sent datagrams
+  uint64_t                                failed;
+} udp_send_stats_t;
+
+static int                              udp_recv_batch = UDP_RECV_BATCH;
+static int                              udp_send_batch = UDP_SEND_BATCH;
+static int                              udp_listener_sockets = UDP_LISTENER_SOCKETS;
+static udp_send_stats_t                 udp_send_stats;
+static uint64_t                         udp_send_held_since_ns = 0;   ///< First datagram queued since the last flush of all batches
+static int                              udp_send_held_msgs = 0;       ///< ITTI messages handled since then
 
 
 static void                             udp_server_receive_and_process (
   struct udp_socket_desc_s *udp_sock_pP);
 
 
-/* @brief Retrieve the descriptor associated with the task_id
+//------------------------------------------------------------------------------
+static bool
+udp_server_is_bound_to (
+  const struct udp_socket_desc_s *udp_sock_pP,
+  const struct sockaddr *address)
+{
+  if (address->sa_family == AF_INET6) {
+    return !memcmp (&((const struct sockaddr_in6 *)&udp_sock_pP->local_addr)->sin6_addr, &((const struct sockaddr_in6 *)address)->sin6_addr,
+        sizeof (struct in6_addr));
+  }
+  return ((const struct sockaddr_in *)&udp_sock_pP->local_addr)->sin_addr.s_addr == ((const struct sockaddr_in *)address)->sin_addr.s_addr;
+}
+
+//------------------------------------------------------------------------------
+static bool
+udp_server_is_bound_to_any (
+  const struct udp_socket_desc_s *udp_sock_pP)
+{
+  if (udp_sock_pP->local_addr.ss_family == AF_INET6) {
+    return IN6_IS_ADDR_UNSPECIFIED (&((const struct sockaddr_in6 *)&udp_sock_pP->local_addr)->sin6_addr);
+  }
+  return ((const struct sockaddr_in *)&udp_sock_pP->local_addr)->sin_addr.s_addr == htonl (INADDR_ANY);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Socket of the chain which sends from the local address: the one bound to it, else the first one bound to the wildcard
+ * address. Without a local address (AF_UNSPEC), the first socket of the chain.
+ */
+static struct udp_socket_desc_s *
+udp_server_select_local_addr (
+  struct udp_socket_desc_s *udp_sock_pP,
+  const struct sockaddr *local_address,
+  bool high_port)
+{
+  struct udp_socket_desc_s               *any_sock_p = NULL;
+
+  if (local_address->sa_family == AF_UNSPEC) {
+    return udp_sock_pP;
+  }
+  for (; udp_sock_pP; udp_sock_pP = high_port ? udp_sock_pP->next_on_high_port : udp_sock_pP->next_on_port) {
+    if (udp_server_is_bound_to (udp_sock_pP, local_address)) {
+      return udp_sock_pP;
+    }
+    if (!any_sock_p && udp_server_is_bound_to_any (udp_sock_pP)) {
+      any_sock_p = udp_sock_pP;
+    }
+  }
+  return any_sock_p;
+}
+
+/* @brief Retrieve the descriptor associated with the task_id, sending from the local address
 */
 static
 struct udp_socket_desc_s               *
@@ -85,30 +206,29 @@ udp_server_get_socket_desc (
   task_id_t task_id,
   uint16_t  local_port,
   uint16_t  peer_port,
-  int 		sa_family)
+  int 		sa_family,
+  const struct sockaddr *local_address)
 {
   struct udp_socket_desc_s               *udp_sock_p = NULL;
 
+  if (local_port) {
+    if (hashtable_get (udp_socket_port_htbl, UDP_SOCKET_KEY (task_id, sa_family, local_port), (void **)&udp_sock_p) != HASH_TABLE_OK) {
+      return NULL;
+    }
+    return udp_server_select_local_addr (udp_sock_p, local_address, false);
+  }
+  /** No local port: the socket bound to a high port. If no local port is given, the destination will be 2123. That cannot be the local port. */
+  if (hashtable_get (udp_socket_port_htbl, UDP_SOCKET_KEY (task_id, sa_family, 0), (void **)&udp_sock_p) == HASH_TABLE_OK
+      && udp_sock_p->local_port != peer_port
+      && (udp_sock_p = udp_server_select_local_addr (udp_sock_p, local_address, true))) {
+    return udp_sock_p;
+  }
   OAILOG_DEBUG (LOG_UDP, "Looking for task %d\n", task_id);
   STAILQ_FOREACH (udp_sock_p, &udp_socket_list, entries) {
-    if (udp_sock_p->task_id == task_id && udp_sock_p->local_addr.sa_family == sa_family) {
-      if(local_port){
-    	  if(udp_sock_p->local_port == local_port){
-    		  OAILOG_DEBUG (LOG_UDP, "Found matching local port %d. \n", local_port);
-    		  break;
-    	  } else {
-    		  continue;
-    	  }
-      }
-      /** Reach here only if no local port. */
-      if(udp_sock_p->local_port != peer_port){
-    	  /** Must be high port. */
-    	  OAILOG_DEBUG (LOG_UDP, "Found matching port with high port %d. \n", udp_sock_p->local_port);
-    	  break;
-      } else {
-    	  /** If no local port is given, the destination will be 2123. That cannot be the local port. */
-    	  continue;
-      }
+    if (udp_sock_p->task_id == task_id && udp_sock_p->local_addr.ss_family == sa_family && udp_sock_p->local_port != peer_port
+        && (local_address->sa_family == AF_UNSPEC || udp_server_is_bound_to (udp_sock_p, local_address) || udp_server_is_bound_to_any (udp_sock_p))) {
+      OAILOG_DEBUG (LOG_UDP, "Found matching port with high port %d. \n", udp_sock_p->local_port);
+      break;
     }
   }
   return udp_sock_p;
@@ -121,13 +241,54 @@ udp_server_get_socket_desc_by_sd (
 {
   struct udp_socket_desc_s               *udp_sock_p = NULL;
 
-  OAILOG_DEBUG (LOG_UDP, "Looking for sd %d\n", sdP);
-  STAILQ_FOREACH (udp_sock_p, &udp_socket_list, entries) {
-    if (udp_sock_p->sd == sdP) {
-      break;
+  hashtable_get (udp_socket_sd_htbl, (hash_key_t)sdP, (void **)&udp_sock_p);
+  return udp_sock_p;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Chain the socket of a new local address to the sockets of the key. The additional SO_REUSEPORT sockets of an address
+ * only receive, the first one sends.
+ */
+static void
+udp_server_chain_socket_desc (
+  hash_key_t key,
+  struct udp_socket_desc_s *socket_desc_p,
+  bool high_port)
+{
+  struct udp_socket_desc_s               *udp_sock_p = NULL;
+  struct udp_socket_desc_s              **next_pp = NULL;
+
+  if (hashtable_get (udp_socket_port_htbl, key, (void **)&udp_sock_p) != HASH_TABLE_OK) {
+    hashtable_insert (udp_socket_port_htbl, key, socket_desc_p);
+    return;
+  }
+  for (;;) {
+    if (udp_server_is_bound_to (udp_sock_p, (struct sockaddr *)&socket_desc_p->local_addr)) {
+      return;
     }
+    next_pp = high_port ? &udp_sock_p->next_on_high_port : &udp_sock_p->next_on_port;
+    if (*next_pp == NULL) {
+      *next_pp = socket_desc_p;
+      return;
+    }
+    udp_sock_p = *next_pp;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+udp_server_add_socket_desc (
+  struct udp_socket_desc_s *socket_desc_p,
+  uint16_t requested_port)
+{
+  STAILQ_INSERT_TAIL (&udp_socket_list, socket_desc_p, entries);
+  hashtable_insert (udp_socket_sd_htbl, (hash_key_t)socket_desc_p->sd, socket_desc_p);
+  udp_server_chain_socket_desc (UDP_SOCKET_KEY (socket_desc_p->task_id, socket_desc_p->local_addr.ss_family, socket_desc_p->local_port),
+      socket_desc_p, false);
+  if (!requested_port) {
+    udp_server_chain_socket_desc (UDP_SOCKET_KEY (socket_desc_p->task_id, socket_desc_p->local_addr.ss_family, 0), socket_desc_p, true);
   }
-  return udp_sock_p;
 }
 
 static void
@@ -145,7 +306,6 @@ udp_server_flush_sockets (
       /*
        * If the event has not been yet been processed (not an itti message)
        */
-      pthread_mutex_lock (&udp_socket_list_mutex);
       udp_sock_p = udp_server_get_socket_desc_by_sd (events[event].data.fd);
 
       if (udp_sock_p != NULL) {
@@ -153,67 +313,301 @@ udp_server_flush_sockets (
       } else {
         OAILOG_ERROR (LOG_UDP, "Failed to retrieve the udp socket descriptor %d", events[event].data.fd);
       }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static uint64_t udp_now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Read up to a batch of datagrams with one recvmmsg and hand them to the owning task with one UDP_DATA_MULTI_IND.
+ * The received bytes are copied once, into a single allocation holding the datagram descriptors and payloads.
+ * Returns the number of datagrams read, 0 if none was pending, -1 on error.
+ */
+static int
+udp_server_receive_batch (
+  struct udp_socket_desc_s *udp_sock_pP)
+{
+  MessageDef                             *message_p = NULL;
+  udp_data_multi_ind_t                   *udp_data_multi_ind_p = NULL;
+  uint8_t                                *payload = NULL;
+  size_t                                  total_length = 0;
+  int                                     nb_received = 0;
+  int                                     nb_datagrams = 0;
+
+  for (int i = 0; i < udp_recv_batch; i++) {
+    udp_sock_pP->iovecs[i].iov_base = udp_sock_pP->buffers[i];
+    udp_sock_pP->iovecs[i].iov_len = UDP_DATA_MAX_MSG_LEN;
+    memset (&udp_sock_pP->msgs[i], 0, sizeof (struct mmsghdr));
+    udp_sock_pP->msgs[i].msg_hdr.msg_name = &udp_sock_pP->peer_addrs[i];
+    udp_sock_pP->msgs[i].msg_hdr.msg_namelen = sizeof (udp_peer_addr_t);
+    udp_sock_pP->msgs[i].msg_hdr.msg_iov = &udp_sock_pP->iovecs[i];
+    udp_sock_pP->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  if ((nb_received = recvmmsg (udp_sock_pP->sd, udp_sock_pP->msgs, udp_recv_batch, MSG_DONTWAIT, NULL)) <= 0) {
+    if (nb_received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      OAILOG_ERROR (LOG_UDP, "recvmmsg failed %s\n", strerror (errno));
+      return -1;
+    }
+    return 0;
+  }
 
-      pthread_mutex_unlock (&udp_socket_list_mutex);
+  for (int i = 0; i < nb_received; i++) {
+    total_length += udp_sock_pP->msgs[i].msg_len;
+  }
+  message_p = itti_alloc_new_message (TASK_UDP, UDP_DATA_MULTI_IND);
+  DevAssert (message_p != NULL);
+  udp_data_multi_ind_p = &message_p->ittiMsg.udp_data_multi_ind;
+  udp_data_multi_ind_p->local_port = udp_sock_pP->local_port;
+  udp_data_multi_ind_p->datagrams = malloc ((nb_received * sizeof (udp_datagram_t)) + total_length);
+  DevAssert (udp_data_multi_ind_p->datagrams != NULL);
+  payload = (uint8_t *)&udp_data_multi_ind_p->datagrams[nb_received];
+
+  for (int i = 0; i < nb_received; i++) {
+    const struct msghdr                    *msg_hdr = &udp_sock_pP->msgs[i].msg_hdr;
+    udp_datagram_t                         *datagram = &udp_data_multi_ind_p->datagrams[nb_datagrams];
+    const bool                              ipv6 = ((struct sockaddr *)msg_hdr->msg_name)->sa_family == AF_INET6;
+
+    if (msg_hdr->msg_flags & MSG_TRUNC) {
+      OAILOG_ERROR (LOG_UDP, "Dropping datagram longer than %d bytes\n", UDP_DATA_MAX_MSG_LEN);
+      continue;
     }
+    memset (&datagram->sock_addr, 0, sizeof (datagram->sock_addr));
+    memcpy (&datagram->sock_addr, msg_hdr->msg_name, ipv6 ? sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in));
+    datagram->peer_port = ipv6 ? htons (udp_sock_pP->peer_addrs[i].addrv6.sin6_port) : htons (udp_sock_pP->peer_addrs[i].addrv4.sin_port);
+    datagram->buffer = payload;
+    datagram->buffer_length = udp_sock_pP->msgs[i].msg_len;
+    memcpy (payload, udp_sock_pP->buffers[i], datagram->buffer_length);
+    payload += datagram->buffer_length;
+    udp_sock_pP->recv_stats.bytes += datagram->buffer_length;
+    nb_datagrams++;
+    OAILOG_DEBUG (LOG_UDP, "Msg of length %d received from %s:%u\n", datagram->buffer_length,
+        (!ipv6) ? inet_ntoa (udp_sock_pP->peer_addrs[i].addrv4.sin_addr) : "TODO_IPV6", ntohs (udp_sock_pP->peer_addrs[i].addrv4.sin_port));
+  }
+  udp_data_multi_ind_p->nb_datagrams = nb_datagrams;
+
+  udp_sock_pP->recv_stats.last_ns = udp_now_ns ();
+  if (!udp_sock_pP->recv_stats.datagrams) {
+    udp_sock_pP->recv_stats.first_ns = udp_sock_pP->recv_stats.last_ns;
+  }
+  udp_sock_pP->recv_stats.datagrams += nb_datagrams;
+  udp_sock_pP->recv_stats.batches++;
+
+  if (!nb_datagrams) {
+    itti_free_msg_content (message_p);
+    itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
+  } else if (itti_send_msg_to_task (udp_sock_pP->task_id, INSTANCE_DEFAULT, message_p) < 0) {
+    OAILOG_DEBUG (LOG_UDP, "Failed to send message %d to task %d\n", UDP_DATA_MULTI_IND, udp_sock_pP->task_id);
   }
+  return nb_received;
 }
 
+//------------------------------------------------------------------------------
 static void
 udp_server_receive_and_process (
   struct udp_socket_desc_s *udp_sock_pP)
 {
-  OAILOG_DEBUG (LOG_UDP, "Inserting new descriptor for task %d, sd %d\n", udp_sock_pP->task_id, udp_sock_pP->sd);
-  {
-    int                                     bytes_received = 0;
-    socklen_t                               from_len;
-    struct sockaddr_in                      addr;
-    struct sockaddr_in6                     addr6;
-
-    bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
-
-    if(ipv6) {
-    	from_len = (socklen_t) sizeof (struct sockaddr_in6);
-    	memset(&addr, 0 , sizeof (struct sockaddr_in6));
-    } else {
-    	from_len = (socklen_t) sizeof (struct sockaddr_in);
-    	memset(&addr6, 0 , sizeof (struct sockaddr_in));
+  /*
+   * Drain the socket in batches. Bounded, such that the pending ITTI messages (UDP_DATA_REQ) are served in between,
+   * the socket is signalled again while not empty.
+   */
+  for (int batch = 0; batch < UDP_RECV_MAX_BATCHES; batch++) {
+    if (udp_server_receive_batch (udp_sock_pP) < udp_recv_batch) {
+      break;
     }
+  }
+}
 
-    if ((bytes_received = recvfrom (udp_sock_pP->sd, udp_sock_pP->buffer, sizeof (udp_sock_pP->buffer), 0,
-    		ipv6 ? (struct sockaddr *)&addr6 : (struct sockaddr *)&addr, &from_len)) <= 0) {
-      OAILOG_ERROR (LOG_UDP, "Recvfrom failed %s\n", strerror (errno));
-      //break;
-    } else {
-      MessageDef                             *message_p = NULL;
-      udp_data_ind_t                         *udp_data_ind_p;
-      AssertFatal (sizeof (udp_sock_pP->buffer) >= bytes_received, "UDP BUFFER OVERFLOW");
-      message_p = itti_alloc_new_message (TASK_UDP, UDP_DATA_IND);
-      DevAssert (message_p != NULL);
-      udp_data_ind_p = &message_p->ittiMsg.udp_data_ind;
-      memcpy (udp_data_ind_p->msgBuf, udp_sock_pP->buffer, bytes_received);
-
-      udp_data_ind_p->buffer_length = bytes_received;
-      udp_data_ind_p->local_port = udp_sock_pP->local_port;
-      udp_data_ind_p->peer_port = ipv6 ? htons (addr6.sin6_port) : htons (addr.sin_port);
-      memcpy((void*)&udp_data_ind_p->sock_addr, (ipv6) ? (struct sockaddr_in6*)&addr6 : (struct sockaddr_in*)&addr,
-    		  (ipv6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
-
-      OAILOG_DEBUG (LOG_UDP, "Msg of length %d received from %s:%u\n", bytes_received,
-    		  (!ipv6) ? inet_ntoa (addr.sin_addr) : "TODO_IPV6", ntohs (addr.sin_port));
-
-      if (itti_send_msg_to_task (udp_sock_pP->task_id, INSTANCE_DEFAULT, message_p) < 0) {
-        OAILOG_DEBUG (LOG_UDP, "Failed to send message %d to task %d\n", UDP_DATA_IND, udp_sock_pP->task_id);
-        //break;
+//------------------------------------------------------------------------------
+/*
+ * Receive loop of an additional SO_REUSEPORT socket. The kernel selects the socket by a hash over the peer and local
+ * address and port, such that all the datagrams of a peer are read by the same thread, in order.
+ */
+static void *
+udp_server_listener_thread (
+  void *arg_p)
+{
+  struct udp_socket_desc_s               *udp_sock_p = (struct udp_socket_desc_s *)arg_p;
+  struct pollfd                           pfd = {.fd = udp_sock_p->sd, .events = POLLIN};
+
+  OAILOG_DEBUG (LOG_UDP, "Listener thread %d started for sd %d, port %" PRIu16 "\n", udp_sock_p->listener_index, udp_sock_p->sd, udp_sock_p->local_port);
+  while (!udp_sock_p->listener_stop) {
+    if (poll (&pfd, 1, UDP_LISTENER_POLL_TIMEOUT_MS) > 0) {
+      udp_server_receive_and_process (udp_sock_p);
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Serve the socket by the UDP task or, for the additional SO_REUSEPORT sockets, by its own listener thread.
+ */
+static int
+udp_server_serve_socket (
+  struct udp_socket_desc_s *socket_desc_p)
+{
+  if (!socket_desc_p->listener_index) {
+    itti_subscribe_event_fd (TASK_UDP, socket_desc_p->sd);
+    return 0;
+  }
+  if (pthread_create (&socket_desc_p->listener_thread, NULL, udp_server_listener_thread, socket_desc_p)) {
+    OAILOG_ERROR (LOG_UDP, "Could not start the listener thread for sd %d\n", socket_desc_p->sd);
+    return -1;
+  }
+  socket_desc_p->listener_started = true;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Write the queued datagrams of the socket, with one sendmmsg if the socket takes them all.
+ * A datagram the socket refuses is dropped, as with sendto, and the following ones are tried.
+ */
+static void
+udp_server_flush_send_batch (
+  struct udp_socket_desc_s *udp_sock_pP)
+{
+  int                                     nb_sent = 0;
+
+  while (nb_sent < udp_sock_pP->nb_send_pending) {
+    const int                               n = sendmmsg (udp_sock_pP->sd, &udp_sock_pP->send_msgs[nb_sent], udp_sock_pP->nb_send_pending - nb_sent, 0);
+
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
       }
+      OAILOG_ERROR (LOG_UDP, "There was an error while writing to socket " "(%d:%s)\n", errno, strerror (errno));
+      udp_send_stats.failed++;
+      nb_sent++;
+      continue;
+    }
+    for (int i = nb_sent; i < nb_sent + n; i++) {
+      udp_send_stats.bytes += udp_sock_pP->send_msgs[i].msg_len;
     }
+    udp_send_stats.datagrams += n;
+    udp_send_stats.batches++;
+    nb_sent += n;
+  }
+  udp_sock_pP->nb_send_pending = 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Write the send batches of all sockets, once no further ITTI message is pending.
+ */
+static void
+udp_server_flush_send_batches (void)
+{
+  struct udp_socket_desc_s               *udp_sock_p = NULL;
+
+  while ((udp_sock_p = STAILQ_FIRST (&udp_send_list))) {
+    STAILQ_REMOVE_HEAD (&udp_send_list, send_entries);
+    udp_sock_p->send_listed = false;
+    udp_server_flush_send_batch (udp_sock_p);
   }
-  //close(udp_sock_pP->sd);
-  //udp_sock_pP->sd = -1;
-  //pthread_mutex_lock(&udp_socket_list_mutex);
-  //STAILQ_REMOVE(&udp_socket_list, udp_sock_pP, udp_socket_desc_s, entries);
-  //pthread_mutex_unlock(&udp_socket_list_mutex);
-  //return NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Queue a datagram in the send batch of the socket, the batch is written when full or when the ITTI queue is empty.
+ * A busy queue holds a partial batch for a batch of ITTI messages or UDP_SEND_MAX_DELAY_US at most.
+ * The payload and the peer address are copied from the request, which is freed right away.
+ */
+static int
+udp_server_queue_send (
+  struct udp_socket_desc_s *udp_sock_pP,
+  const udp_data_req_t * const udp_data_req_pP)
+{
+  const int                               i = udp_sock_pP->nb_send_pending;
+  udp_peer_addr_t                        *peer_addr = &udp_sock_pP->send_peer_addrs[i];
+  socklen_t                               peer_addr_len = 0;
+
+  if (udp_data_req_pP->buffer_length > UDP_DATA_MAX_MSG_LEN) {
+    OAILOG_ERROR (LOG_UDP, "Not sending message of size %u, longer than %d bytes\n", udp_data_req_pP->buffer_length, UDP_DATA_MAX_MSG_LEN);
+    udp_send_stats.failed++;
+    return -1;
+  }
+  memset (peer_addr, 0, sizeof (udp_peer_addr_t));
+  if (udp_data_req_pP->peer_address.addrv4.sin_family == AF_INET) {
+    peer_addr->addrv4.sin_family = AF_INET;
+    peer_addr->addrv4.sin_port = htons (udp_data_req_pP->peer_port);
+    peer_addr->addrv4.sin_addr = udp_data_req_pP->peer_address.addrv4.sin_addr;
+    peer_addr_len = sizeof (struct sockaddr_in);
+    OAILOG_DEBUG (LOG_UDP, "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
+        udp_sock_pP->sd, udp_data_req_pP->buffer_length, PRI_IN_ADDR (peer_addr->addrv4.sin_addr), udp_data_req_pP->peer_port);
+  } else {
+    peer_addr->addrv6.sin6_family = AF_INET6;
+    peer_addr->addrv6.sin6_port = htons (udp_data_req_pP->peer_port);
+    peer_addr->addrv6.sin6_addr = udp_data_req_pP->peer_address.addrv6.sin6_addr;
+    peer_addr_len = sizeof (struct sockaddr_in6);
+  }
+  memcpy (udp_sock_pP->send_buffers[i], udp_data_req_pP->buffer, udp_data_req_pP->buffer_length);
+  udp_sock_pP->send_iovecs[i].iov_base = udp_sock_pP->send_buffers[i];
+  udp_sock_pP->send_iovecs[i].iov_len = udp_data_req_pP->buffer_length;
+  memset (&udp_sock_pP->send_msgs[i], 0, sizeof (struct mmsghdr));
+  udp_sock_pP->send_msgs[i].msg_hdr.msg_name = peer_addr;
+  udp_sock_pP->send_msgs[i].msg_hdr.msg_namelen = peer_addr_len;
+  udp_sock_pP->send_msgs[i].msg_hdr.msg_iov = &udp_sock_pP->send_iovecs[i];
+  udp_sock_pP->send_msgs[i].msg_hdr.msg_iovlen = 1;
+
+  if (STAILQ_EMPTY (&udp_send_list)) {
+    udp_send_held_since_ns = udp_now_ns ();
+    udp_send_held_msgs = 0;
+  }
+  if (!udp_sock_pP->send_listed) {
+    STAILQ_INSERT_TAIL (&udp_send_list, udp_sock_pP, send_entries);
+    udp_sock_pP->send_listed = true;
+  }
+  if (++udp_sock_pP->nb_send_pending == udp_send_batch) {
+    udp_server_flush_send_batch (udp_sock_pP);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static struct udp_socket_desc_s *
+udp_server_new_socket_desc (void)
+{
+  struct udp_socket_desc_s               *socket_desc_p = calloc (1, sizeof (struct udp_socket_desc_s));
+
+  DevAssert (socket_desc_p != NULL);
+  socket_desc_p->buffers = calloc (udp_recv_batch, UDP_DATA_MAX_MSG_LEN);
+  socket_desc_p->iovecs = calloc (udp_recv_batch, sizeof (struct iovec));
+  socket_desc_p->msgs = calloc (udp_recv_batch, sizeof (struct mmsghdr));
+  socket_desc_p->peer_addrs = calloc (udp_recv_batch, sizeof (udp_peer_addr_t));
+  DevAssert (socket_desc_p->buffers && socket_desc_p->iovecs && socket_desc_p->msgs && socket_desc_p->peer_addrs);
+  socket_desc_p->send_buffers = calloc (udp_send_batch, UDP_DATA_MAX_MSG_LEN);
+  socket_desc_p->send_iovecs = calloc (udp_send_batch, sizeof (struct iovec));
+  socket_desc_p->send_msgs = calloc (udp_send_batch, sizeof (struct mmsghdr));
+  socket_desc_p->send_peer_addrs = calloc (udp_send_batch, sizeof (udp_peer_addr_t));
+  DevAssert (socket_desc_p->send_buffers && socket_desc_p->send_iovecs && socket_desc_p->send_msgs && socket_desc_p->send_peer_addrs);
+  return socket_desc_p;
+}
+
+//------------------------------------------------------------------------------
+static void
+udp_server_free_socket_desc (
+  struct udp_socket_desc_s *socket_desc_p)
+{
+  free_wrapper ((void**)&socket_desc_p->buffers);
+  free_wrapper ((void**)&socket_desc_p->iovecs);
+  free_wrapper ((void**)&socket_desc_p->msgs);
+  free_wrapper ((void**)&socket_desc_p->peer_addrs);
+  free_wrapper ((void**)&socket_desc_p->send_buffers);
+  free_wrapper ((void**)&socket_desc_p->send_iovecs);
+  free_wrapper ((void**)&socket_desc_p->send_msgs);
+  free_wrapper ((void**)&socket_desc_p->send_peer_addrs);
+  free_wrapper ((void**)&socket_desc_p);
 }
 
 //------------------------------------------------------------------------------
@@ -222,7 +616,8 @@ static
 udp_server_create_socket_v4 (
   uint16_t port,
   struct in_addr *address,
-  task_id_t task_id)
+  task_id_t task_id,
+  int listener_index)
 {
   struct sockaddr_in                      addr;
   int                                     sd;
@@ -239,6 +634,15 @@ udp_server_create_socket_v4 (
     return sd;
   }
 
+  /*
+   * Several sockets on the same address and port, the kernel distributes the peers among them
+   */
+  if (port && udp_listener_sockets > 1 && setsockopt (sd, SOL_SOCKET, SO_REUSEPORT, &(int){1}, sizeof (int)) < 0) {
+    OAILOG_ERROR (LOG_UDP, "setsockopt SO_REUSEPORT failed for IPv4: %s\n", strerror (errno));
+    close (sd);
+    return -1;
+  }
+
   memset (&addr, 0, sizeof (struct sockaddr_in));
   addr.sin_family = AF_INET;
   addr.sin_port = htons (port);
@@ -274,18 +678,16 @@ udp_server_create_socket_v4 (
     return -1;
   }
 
-  socket_desc_p = calloc (1, sizeof (struct udp_socket_desc_s));
-  DevAssert (socket_desc_p != NULL);
+  socket_desc_p = udp_server_new_socket_desc ();
   socket_desc_p->sd = sd;
   ((struct sockaddr_in*)&socket_desc_p->local_addr)->sin_addr = *address;
-  socket_desc_p->local_addr.sa_family = AF_INET;
+  socket_desc_p->local_addr.ss_family = AF_INET;
   socket_desc_p->local_port = ntohs(addr_check.sin_port);
   socket_desc_p->task_id = task_id;
-  OAILOG_DEBUG (LOG_UDP, "(IPv4) Inserting new descriptor for task %d, sd %d\n", socket_desc_p->task_id, socket_desc_p->sd);
-  pthread_mutex_lock (&udp_socket_list_mutex);
-  STAILQ_INSERT_TAIL (&udp_socket_list, socket_desc_p, entries);
-  pthread_mutex_unlock (&udp_socket_list_mutex);
-  itti_subscribe_event_fd (TASK_UDP, sd);
+  socket_desc_p->listener_index = listener_index;
+  OAILOG_DEBUG (LOG_UDP, "(IPv4) Inserting new descriptor for task %d, sd %d, listener %d\n", socket_desc_p->task_id, socket_desc_p->sd, listener_index);
+  udp_server_add_socket_desc (socket_desc_p, port);
+  udp_server_serve_socket (socket_desc_p);
   return sd;
 }
 
@@ -295,7 +697,8 @@ static
 udp_server_create_socket_v6 (
   uint16_t port,
   struct in6_addr *address,
-  task_id_t task_id)
+  task_id_t task_id,
+  int listener_index)
 {
   struct sockaddr_in6                    addr;
   int                                    sd;
@@ -313,6 +716,12 @@ udp_server_create_socket_v6 (
     return sd;
   }
 
+  if (port && udp_listener_sockets > 1 && setsockopt (sd, SOL_SOCKET, SO_REUSEPORT, &(int){1}, sizeof (int)) < 0) {
+    OAILOG_ERROR (LOG_UDP, "setsockopt SO_REUSEPORT failed for IPv6: %s\n", strerror (errno));
+    close (sd);
+    return -1;
+  }
+
   memset (&addr, 0, sizeof (struct sockaddr_in6));
   addr.sin6_family = AF_INET6;
   addr.sin6_port = htons (port);
@@ -347,20 +756,18 @@ udp_server_create_socket_v6 (
     return -1;
   }
 
-  socket_desc_p = calloc (1, sizeof (struct udp_socket_desc_s));
-  DevAssert (socket_desc_p != NULL);
+  socket_desc_p = udp_server_new_socket_desc ();
   socket_desc_p->sd = sd;
   ((struct sockaddr_in6*)&socket_desc_p->local_addr)->sin6_addr = *address;
-  socket_desc_p->local_addr.sa_family = AF_INET6;
+  socket_desc_p->local_addr.ss_family = AF_INET6;
 
 //  ((struct sockaddr_in6*)&socket_desc_p->local_addr)->sin6_family = AF_INET;
   socket_desc_p->local_port = ntohs(addr_check.sin_port);
   socket_desc_p->task_id = task_id;
-  OAILOG_DEBUG (LOG_UDP, "(IPv6) Inserting new descriptor for task %d, sd %d\n", socket_desc_p->task_id, socket_desc_p->sd);
-  pthread_mutex_lock (&udp_socket_list_mutex);
-  STAILQ_INSERT_TAIL (&udp_socket_list, socket_desc_p, entries);
-  pthread_mutex_unlock (&udp_socket_list_mutex);
-  itti_subscribe_event_fd (TASK_UDP, sd);
+  socket_desc_p->listener_index = listener_index;
+  OAILOG_DEBUG (LOG_UDP, "(IPv6) Inserting new descriptor for task %d, sd %d, listener %d\n", socket_desc_p->task_id, socket_desc_p->sd, listener_index);
+  udp_server_add_socket_desc (socket_desc_p, port);
+  udp_server_serve_socket (socket_desc_p);
   return sd;
 }
 
@@ -376,7 +783,20 @@ static void *udp_intertask_interface (void *args_p)
   while (1) {
     MessageDef                             *received_message_p = NULL;
 
-    itti_receive_msg (TASK_UDP, &received_message_p);
+    if (STAILQ_EMPTY (&udp_send_list)) {
+      itti_receive_msg (TASK_UDP, &received_message_p);
+    } else {
+      /**
+       * Batch the UDP_DATA_REQ messages already queued, write them once the queue is empty.
+       * If the queue does not run empty (other messages, requests for other sockets), the wait is bounded.
+       */
+      itti_try_receive_msg (TASK_UDP, &received_message_p);
+      if (received_message_p == NULL
+          || ++udp_send_held_msgs >= udp_send_batch
+          || udp_now_ns () - udp_send_held_since_ns >= (uint64_t)UDP_SEND_MAX_DELAY_US * 1000) {
+        udp_server_flush_send_batches ();
+      }
+    }
 
     if (received_message_p != NULL) {
       switch (ITTI_MSG_ID (received_message_p)) {
@@ -387,6 +807,7 @@ static void *udp_intertask_interface (void *args_p)
 
 
       case TERMINATE_MESSAGE:{
+          udp_server_flush_send_batches ();
           udp_exit();
           itti_free_msg_content(received_message_p);
           itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
@@ -397,77 +818,48 @@ static void *udp_intertask_interface (void *args_p)
 
       case UDP_INIT:{
           udp_init_t                             *udp_init_p = &received_message_p->ittiMsg.udp_init;
-          if(udp_init_p->in_addr)
-        	  udp_server_create_socket_v4 (udp_init_p->port, udp_init_p->in_addr, ITTI_MSG_ORIGIN_ID (received_message_p));
-          if(udp_init_p->in6_addr)
-        	  udp_server_create_socket_v6 (udp_init_p->port, udp_init_p->in6_addr, ITTI_MSG_ORIGIN_ID (received_message_p));
+          /** A well known port may be served by several SO_REUSEPORT sockets, the first one is served by the UDP task and used to send. */
+          const int                               nb_listeners = udp_init_p->port ? udp_listener_sockets : 1;
+          for (int listener = 0; listener < nb_listeners; listener++) {
+            if(udp_init_p->in_addr)
+          	  udp_server_create_socket_v4 (udp_init_p->port, udp_init_p->in_addr, ITTI_MSG_ORIGIN_ID (received_message_p), listener);
+            if(udp_init_p->in6_addr)
+          	  udp_server_create_socket_v6 (udp_init_p->port, udp_init_p->in6_addr, ITTI_MSG_ORIGIN_ID (received_message_p), listener);
+          }
         }
         break;
 
       case UDP_DATA_REQ:{
-          int                                     udp_sd = -1;
-          ssize_t                                 bytes_written;
           struct udp_socket_desc_s               *udp_sock_p = NULL;
           udp_data_req_t                         *udp_data_req_p;
-          struct sockaddr_in                      peer_addr;
-          struct sockaddr_in6                     peer_addr6;
+          sa_family_t                             peer_family;
+          sa_family_t                             local_family;
 
           udp_data_req_p = &received_message_p->ittiMsg.udp_data_req;
+          peer_family = udp_data_req_p->peer_address.addrv4.sin_family;
+          local_family = udp_data_req_p->local_address.addrv4.sin_family;
           //UDP_DEBUG("-- UDP_DATA_REQ -----------------------------------------------------\n%s :\n",
           //        __FUNCTION__);
-          //udp_print_hex_octets(&udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
+          //udp_print_hex_octets(udp_data_req_p->buffer,
           //        udp_data_req_p->buffer_length);
-          if(udp_data_req_p->peer_address->sa_family == AF_INET){
-        	  memset (&peer_addr, 0, sizeof (struct sockaddr_in));
-        	  peer_addr.sin_family = AF_INET;
-        	  peer_addr.sin_port = htons (udp_data_req_p->peer_port);
-        	  peer_addr.sin_addr = ((struct sockaddr_in*)udp_data_req_p->peer_address)->sin_addr;
-        	  pthread_mutex_lock (&udp_socket_list_mutex);
-        	  udp_sock_p = udp_server_get_socket_desc (ITTI_MSG_ORIGIN_ID (received_message_p), udp_data_req_p->local_port, udp_data_req_p->peer_port, AF_INET);
-
-        	  if (udp_sock_p == NULL) {
-        		  OAILOG_ERROR (LOG_UDP, "Failed to retrieve the udp socket descriptor for IPv4 " "associated with task %d\n", ITTI_MSG_ORIGIN_ID (received_message_p));
-        		  pthread_mutex_unlock (&udp_socket_list_mutex);
-        		  // no free udp_data_req_p->buffer, statically allocated
-        		  goto on_error;
-        	  }
-
-        	  udp_sd = udp_sock_p->sd;
-        	  pthread_mutex_unlock (&udp_socket_list_mutex);
-        	  OAILOG_DEBUG (LOG_UDP, "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
-        			  udp_sd, udp_data_req_p->buffer_length, PRI_IN_ADDR (((struct sockaddr_in*)udp_data_req_p->peer_address)->sin_addr), udp_data_req_p->peer_port);
-        	  bytes_written = sendto (udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset], udp_data_req_p->buffer_length, 0, (struct sockaddr *)&peer_addr, sizeof (struct sockaddr_in));
-        	  // no free udp_data_req_p->buffer, statically allocated
-
-        	  if (bytes_written != udp_data_req_p->buffer_length) {
-        		  OAILOG_ERROR (LOG_UDP, "There was an error while writing to socket " "(%d:%s)\n", errno, strerror (errno));
-        	  }
-          } else if (udp_data_req_p->peer_address->sa_family == AF_INET6) {
-        	  memset (&peer_addr6, 0, sizeof (struct sockaddr_in6));
-        	  peer_addr6.sin6_family = AF_INET6;
-        	  peer_addr6.sin6_port = htons (udp_data_req_p->peer_port);
-        	  peer_addr6.sin6_addr = ((struct sockaddr_in6*)udp_data_req_p->peer_address)->sin6_addr;
-        	  pthread_mutex_lock (&udp_socket_list_mutex);
-        	  udp_sock_p = udp_server_get_socket_desc (ITTI_MSG_ORIGIN_ID (received_message_p), udp_data_req_p->local_port, udp_data_req_p->peer_port, AF_INET6);
-
-        	  if (udp_sock_p == NULL) {
-        		  OAILOG_ERROR (LOG_UDP, "Failed to retrieve the udp socket descriptor for IPv6 " "associated with task %d\n", ITTI_MSG_ORIGIN_ID (received_message_p));
-        		  pthread_mutex_unlock (&udp_socket_list_mutex);
-        		  // no free udp_data_req_p->buffer, statically allocated
-        		  goto on_error;
-        	  }
-
-        	  udp_sd = udp_sock_p->sd;
-        	  pthread_mutex_unlock (&udp_socket_list_mutex);
-//        	  OAILOG_DEBUG (LOG_UDP, "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
-//        			  udp_sd, udp_data_req_p->buffer_length, PRI_IN_ADDR (udp_data_req_p->peer_address), udp_data_req_p->peer_port);
-        	  bytes_written = sendto (udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset], udp_data_req_p->buffer_length, 0, (struct sockaddr *)&peer_addr6, sizeof (struct sockaddr_in6));
-        	  // no free udp_data_req_p->buffer, statically allocated
-
-        	  if (bytes_written != udp_data_req_p->buffer_length) {
-        		  OAILOG_ERROR (LOG_UDP, "There was an error while writing to socket " "(%d:%s)\n", errno, strerror (errno));
-        	  }
+          if (peer_family != AF_INET && peer_family != AF_INET6) {
+            goto on_error;
+          }
+          if (local_family != AF_UNSPEC && local_family != peer_family) {
+            OAILOG_ERROR (LOG_UDP, "Local address family %d differs from the peer address family %d\n", local_family, peer_family);
+            goto on_error;
+          }
+          udp_sock_p = udp_server_get_socket_desc (ITTI_MSG_ORIGIN_ID (received_message_p), udp_data_req_p->local_port, udp_data_req_p->peer_port,
+              peer_family, (struct sockaddr *)&udp_data_req_p->local_address);
+
+          if (udp_sock_p == NULL) {
+            OAILOG_ERROR (LOG_UDP, "Failed to retrieve the udp socket descriptor for %s " "associated with task %d\n",
+                (peer_family == AF_INET) ? "IPv4" : "IPv6", ITTI_MSG_ORIGIN_ID (received_message_p));
+            // no free udp_data_req_p->buffer, part of the message
+            goto on_error;
           }
+          udp_server_queue_send (udp_sock_p, udp_data_req_p);
+          // no free udp_data_req_p->buffer, part of the message, copied in the send batch
         }
         break;
 
@@ -498,10 +890,24 @@ static void *udp_intertask_interface (void *args_p)
 }
 
 //------------------------------------------------------------------------------
-int udp_init (void)
+int udp_init (const mce_config_t * mce_config_p)
 {
   OAILOG_DEBUG (LOG_UDP, "Initializing UDP task interface\n");
   STAILQ_INIT (&udp_socket_list);
+  STAILQ_INIT (&udp_send_list);
+  udp_socket_sd_htbl = hashtable_create (UDP_SOCKET_TABLE_SIZE, NULL, hash_free_int_func, NULL);
+  udp_socket_port_htbl = hashtable_create (UDP_SOCKET_TABLE_SIZE, NULL, hash_free_int_func, NULL);
+  if (!udp_socket_sd_htbl || !udp_socket_port_htbl) {
+    OAILOG_ERROR (LOG_UDP, "Could not create the UDP socket tables\n");
+    return -1;
+  }
+  /** Lookups of unknown keys are part of the send path (high port), no traces. */
+  udp_socket_sd_htbl->log_enabled = false;
+  udp_socket_port_htbl->log_enabled = false;
+  udp_recv_batch = mce_config_p->udp_config.recv_batch ? mce_config_p->udp_config.recv_batch : UDP_RECV_BATCH;
+  udp_send_batch = mce_config_p->udp_config.send_batch ? mce_config_p->udp_config.send_batch : UDP_SEND_BATCH;
+  udp_listener_sockets = mce_config_p->udp_config.listener_sockets ? mce_config_p->udp_config.listener_sockets : UDP_LISTENER_SOCKETS;
+  memset (&udp_send_stats, 0, sizeof (udp_send_stats));
 
   if (itti_create_task (TASK_UDP, &udp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR (LOG_UDP, "udp pthread_create (%s)\n", strerror (errno));
@@ -516,11 +922,41 @@ int udp_init (void)
 void udp_exit (void)
 {
   struct udp_socket_desc_s               *socket_desc_p = NULL;
+  udp_recv_stats_t                        recv_stats = {0};
+
   while ((socket_desc_p = STAILQ_FIRST (&udp_socket_list))) {
-    itti_unsubscribe_event_fd(TASK_UDP, socket_desc_p->sd);
+    if (socket_desc_p->listener_started) {
+      socket_desc_p->listener_stop = true;
+      pthread_join (socket_desc_p->listener_thread, NULL);
+    } else {
+      itti_unsubscribe_event_fd(TASK_UDP, socket_desc_p->sd);
+    }
+    OAILOG_INFO (LOG_UDP, "Socket port %" PRIu16 " listener %d received %" PRIu64 " datagrams\n",
+        socket_desc_p->local_port, socket_desc_p->listener_index, socket_desc_p->recv_stats.datagrams);
+    recv_stats.datagrams += socket_desc_p->recv_stats.datagrams;
+    recv_stats.bytes += socket_desc_p->recv_stats.bytes;
+    recv_stats.batches += socket_desc_p->recv_stats.batches;
+    if (socket_desc_p->recv_stats.datagrams) {
+      recv_stats.first_ns = (!recv_stats.first_ns || socket_desc_p->recv_stats.first_ns < recv_stats.first_ns) ? socket_desc_p->recv_stats.first_ns : recv_stats.first_ns;
+      recv_stats.last_ns = (socket_desc_p->recv_stats.last_ns > recv_stats.last_ns) ? socket_desc_p->recv_stats.last_ns : recv_stats.last_ns;
+    }
     close(socket_desc_p->sd);
-    pthread_mutex_destroy(&udp_socket_list_mutex);
     STAILQ_REMOVE_HEAD (&udp_socket_list, entries);
-    free_wrapper ((void**)&socket_desc_p);
+    udp_server_free_socket_desc (socket_desc_p);
+  }
+  if (udp_socket_sd_htbl) {
+    hashtable_destroy (udp_socket_sd_htbl);
+    udp_socket_sd_htbl = NULL;
+  }
+  if (udp_socket_port_htbl) {
+    hashtable_destroy (udp_socket_port_htbl);
+    udp_socket_port_htbl = NULL;
   }
+  OAILOG_INFO (LOG_UDP, "Received %" PRIu64 " datagrams, %" PRIu64 " bytes in %" PRIu64 " batches (%.1f per batch), %.1f datagrams/s\n",
+      recv_stats.datagrams, recv_stats.bytes, recv_stats.batches,
+      recv_stats.batches ? (double)recv_stats.datagrams / recv_stats.batches : 0.0,
+      (recv_stats.last_ns > recv_stats.first_ns) ? (double)(recv_stats.datagrams - 1) * 1e9 / (recv_stats.last_ns - recv_stats.first_ns) : 0.0);
+  OAILOG_INFO (LOG_UDP, "Sent %" PRIu64 " datagrams, %" PRIu64 " bytes in %" PRIu64 " sendmmsg calls (%.1f per call), %" PRIu64 " failed\n",
+      udp_send_stats.datagrams, udp_send_stats.bytes, udp_send_stats.batches,
+      udp_send_stats.batches ? (double)udp_send_stats.datagrams / udp_send_stats.batches : 0.0, udp_send_stats.failed);
 }
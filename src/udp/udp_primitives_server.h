@@ -33,7 +33,7 @@
 /** \brief UDP task init function.
  @returns -1 on error, 0 otherwise.
  **/
-int udp_init(void);
+int udp_init(const mce_config_t * mce_config_p);
 void udp_exit (void);
 
 
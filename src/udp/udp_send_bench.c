@@ -0,0 +1,254 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_send_bench.c
+  \brief Loopback throughput of the UDP task send path, for several send batch sizes (1: one sendmmsg per datagram).
+  The bench sends UDP_DATA_REQ messages to the UDP task of udp_primitives_server.c, which queues them in the send batch of
+  the socket and writes them with sendmmsg. The task runs on the test doubles of ITTI of udp_test_doubles.c, which count
+  the sendmmsg calls.
+  The task has two sockets on the same port, bound to 127.0.0.1 and 127.0.0.2. The datagrams alternate between the two
+  local addresses, the receiver checks that each one arrives from the address it was sent from. Exits with 1 otherwise.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#define _GNU_SOURCE             // required for sendmmsg() and recvmmsg()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "intertask_interface.h"
+#include "mce_config.h"
+#include "udp_primitives_server.h"
+#include "udp_test_doubles.h"
+
+#define UDP_SEND_BENCH_DEFAULT_DATAGRAMS    1000000
+#define UDP_SEND_BENCH_DEFAULT_LENGTH       120         ///< Typical MBMS Session Start Response size
+#define UDP_SEND_BENCH_DEFAULT_BATCHES      "1,8,32,64"
+#define UDP_SEND_BENCH_DEFAULT_PORT         21230
+#define UDP_SEND_BENCH_MAX_BATCH            1024
+#define UDP_SEND_BENCH_RCVBUF               (8 * 1024 * 1024)
+#define UDP_SEND_BENCH_IDLE_NS              200000000ULL
+
+typedef struct udp_send_bench_receiver_s {
+  int                 sd;
+  volatile bool       stop;
+  uint64_t            received;
+  uint64_t            wrong_source;   ///< Datagrams not from the local address they were sent from
+  uint64_t            last_ns;
+} udp_send_bench_receiver_t;
+
+/** Local addresses of the two sockets of the UDP task, the first payload byte of a datagram is the index of its address. */
+static struct in_addr                       udp_send_bench_local_addrs[2];
+
+//------------------------------------------------------------------------------
+static uint64_t udp_send_bench_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void *udp_send_bench_receiver (void *arg)
+{
+  udp_send_bench_receiver_t * const receiver = (udp_send_bench_receiver_t*)arg;
+  static uint8_t          buffers[64][UDP_DATA_MAX_MSG_LEN];
+  struct sockaddr_in      sources[64];
+  struct iovec            iovecs[64];
+  struct mmsghdr          msgs[64];
+
+  while (!receiver->stop) {
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < 64; i++) {
+      iovecs[i].iov_base = buffers[i];
+      iovecs[i].iov_len = UDP_DATA_MAX_MSG_LEN;
+      msgs[i].msg_hdr.msg_name = &sources[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      msgs[i].msg_hdr.msg_iov = &iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int n = recvmmsg(receiver->sd, msgs, 64, MSG_WAITFORONE, NULL);
+    if (n <= 0)
+      continue;
+    for (int i = 0; i < n; i++) {
+      if (!msgs[i].msg_len || buffers[i][0] > 1 || sources[i].sin_addr.s_addr != udp_send_bench_local_addrs[buffers[i][0]].s_addr)
+        __sync_fetch_and_add(&receiver->wrong_source, 1);
+    }
+    __sync_fetch_and_add(&receiver->received, n);
+    receiver->last_ns = udp_send_bench_now_ns();
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void udp_send_bench_udp_init (const struct in_addr * const address, const uint16_t port)
+{
+  MessageDef *message_p = itti_alloc_new_message(TASK_SM, UDP_INIT);
+
+  message_p->ittiMsg.udp_init.in_addr = (struct in_addr *)address;
+  message_p->ittiMsg.udp_init.port = port;
+  itti_send_msg_to_task(TASK_UDP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static int udp_send_bench_run (const struct sockaddr_in * const peer, udp_send_bench_receiver_t * const receiver,
+    const uint16_t port, const int batch, const uint64_t nb_datagrams, const int length)
+{
+  mce_config_t            config;
+  const uint64_t          received_before = __sync_fetch_and_add(&receiver->received, 0);
+  uint64_t                received = 0;
+  uint64_t                last_received = 0;
+  uint64_t                last_progress_ns = 0;
+  uint64_t                t0 = 0;
+
+  /** A UDP task per batch size, with the two sockets on the same port. */
+  memset(&config, 0, sizeof(config));
+  config.udp_config.send_batch = batch;
+  config.udp_config.listener_sockets = 1;
+  udp_test_sendmmsg_calls = 0;
+  if (udp_init(&config) < 0) {
+    fprintf(stderr, "Could not start the UDP task\n");
+    return -1;
+  }
+  udp_send_bench_udp_init(&udp_send_bench_local_addrs[0], port);
+  udp_send_bench_udp_init(&udp_send_bench_local_addrs[1], port);
+
+  t0 = udp_send_bench_now_ns();
+  for (uint64_t n = 0; n < nb_datagrams; n++) {
+    MessageDef     *message_p = itti_alloc_new_message(TASK_SM, UDP_DATA_REQ);
+    udp_data_req_t *udp_data_req_p = &message_p->ittiMsg.udp_data_req;
+
+    memset(udp_data_req_p->buffer, 0x5A, length);
+    udp_data_req_p->buffer[0] = n & 1;
+    udp_data_req_p->buffer_length = length;
+    udp_data_req_p->local_port = port;
+    udp_data_req_p->local_address.addrv4.sin_family = AF_INET;
+    udp_data_req_p->local_address.addrv4.sin_addr = udp_send_bench_local_addrs[n & 1];
+    udp_data_req_p->peer_address.addrv4 = *peer;
+    udp_data_req_p->peer_port = ntohs(peer->sin_port);
+    itti_send_msg_to_task(TASK_UDP, INSTANCE_DEFAULT, message_p);
+  }
+
+  /** Until all datagrams are received, or none for a while (dropped). */
+  last_progress_ns = udp_send_bench_now_ns();
+  while ((received = __sync_fetch_and_add(&receiver->received, 0) - received_before) < nb_datagrams
+      && udp_send_bench_now_ns() - last_progress_ns < UDP_SEND_BENCH_IDLE_NS) {
+    if (received != last_received) {
+      last_received = received;
+      last_progress_ns = udp_send_bench_now_ns();
+    }
+    usleep(1000);
+  }
+  const uint64_t duration = (received ? receiver->last_ns : udp_send_bench_now_ns()) - t0;
+
+  itti_send_msg_to_task(TASK_UDP, INSTANCE_DEFAULT, itti_alloc_new_message(TASK_SM, TERMINATE_MESSAGE));
+  udp_test_join_udp_task();
+  printf("  batch %4d: %10lu received %12.1f pkt/s  %8.1f ns/pkt  %10lu sendmmsg  %8lu lost\n",
+      batch, received, duration ? (double)received * 1e9 / duration : 0.0, received ? (double)duration / received : 0.0,
+      udp_test_sendmmsg_calls, nb_datagrams - received);
+  return received ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  uint64_t                    nb_datagrams = UDP_SEND_BENCH_DEFAULT_DATAGRAMS;
+  int                         length = UDP_SEND_BENCH_DEFAULT_LENGTH;
+  const char                 *batches = UDP_SEND_BENCH_DEFAULT_BATCHES;
+  uint16_t                    port = UDP_SEND_BENCH_DEFAULT_PORT;
+  udp_send_bench_receiver_t   receiver = {.sd = -1};
+  struct sockaddr_in          addr = {0};
+  socklen_t                   addr_len = sizeof(addr);
+  const int                   rcvbuf = UDP_SEND_BENCH_RCVBUF;
+  const struct timeval        rcvtimeo = {.tv_sec = 0, .tv_usec = 10000};   ///< The recvmmsg timeout is only checked after a datagram
+  pthread_t                   thread;
+  int                         rc = 0;
+  int                         opt = 0;
+
+  while ((opt = getopt(argc, argv, "n:l:b:p:h")) != -1) {
+    switch (opt) {
+    case 'n': nb_datagrams = strtoull(optarg, NULL, 10); break;
+    case 'l': length = atoi(optarg); break;
+    case 'b': batches = optarg; break;
+    case 'p': port = atoi(optarg); break;
+    default:
+      fprintf(stderr, "Usage: %s [-n datagrams] [-l length] [-b send batch sizes, e.g. %s] [-p local port of the UDP task, default %d]\n",
+          argv[0], UDP_SEND_BENCH_DEFAULT_BATCHES, UDP_SEND_BENCH_DEFAULT_PORT);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (!nb_datagrams || length <= 0 || length > UDP_DATA_MAX_MSG_LEN || !port) {
+    fprintf(stderr, "Invalid number of datagrams, length (max %d) or port\n", UDP_DATA_MAX_MSG_LEN);
+    return 1;
+  }
+
+  inet_pton(AF_INET, "127.0.0.1", &udp_send_bench_local_addrs[0]);
+  inet_pton(AF_INET, "127.0.0.2", &udp_send_bench_local_addrs[1]);
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if ((receiver.sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0
+      || bind(receiver.sd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || getsockname(receiver.sd, (struct sockaddr*)&addr, &addr_len) < 0) {
+    fprintf(stderr, "Could not set up the loopback receiver: %s\n", strerror(errno));
+    return 1;
+  }
+  setsockopt(receiver.sd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  setsockopt(receiver.sd, SOL_SOCKET, SO_RCVTIMEO, &rcvtimeo, sizeof(rcvtimeo));
+  if (pthread_create(&thread, NULL, udp_send_bench_receiver, &receiver)) {
+    fprintf(stderr, "Could not start the receiver thread\n");
+    return 1;
+  }
+
+  printf("%lu UDP_DATA_REQ of %d bytes from 127.0.0.1:%u and 127.0.0.2:%u to 127.0.0.1:%u\n",
+      nb_datagrams, length, port, port, ntohs(addr.sin_port));
+  for (const char *b = batches; b && *b; b = strchr(b, ',') ? strchr(b, ',') + 1 : NULL) {
+    const int batch = atoi(b);
+    if (batch <= 0 || batch > UDP_SEND_BENCH_MAX_BATCH) {
+      fprintf(stderr, "Skipping batch size %d (1..%d)\n", batch, UDP_SEND_BENCH_MAX_BATCH);
+      continue;
+    }
+    if (udp_send_bench_run(&addr, &receiver, port, batch, nb_datagrams, length) < 0)
+      rc = 1;
+  }
+
+  receiver.stop = true;
+  pthread_join(thread, NULL);
+  close(receiver.sd);
+  if (receiver.wrong_source) {
+    printf("%lu datagrams not sent from their local address\n", receiver.wrong_source);
+    rc = 1;
+  }
+  return rc;
+}
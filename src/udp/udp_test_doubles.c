@@ -0,0 +1,146 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_test_doubles.c
+  \brief Test doubles of the ITTI interface of the UDP task.
+  The messages to the UDP task go through a bounded queue, the sender waits while it is full. The socket events of the task
+  are never signalled and the messages to other tasks are dropped.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#define _GNU_SOURCE             // required for sendmmsg()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "assertions.h"
+#include "intertask_interface.h"
+#include "itti_free_defined_msg.h"
+#include "udp_test_doubles.h"
+
+#define UDP_TEST_QUEUE_SIZE           4096
+
+static struct {
+  pthread_mutex_t     mutex;
+  pthread_cond_t      not_empty;
+  pthread_cond_t      not_full;
+  MessageDef         *messages[UDP_TEST_QUEUE_SIZE];
+  int                 head;
+  int                 count;
+} udp_test_queue = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static const size_t                         udp_test_message_sizes[] = {
+#define MESSAGE_DEF(iD, pRIO, sTRUCT, fIELDnAME) sizeof(sTRUCT),
+#include <messages_def.h>
+#undef MESSAGE_DEF
+};
+
+static pthread_t                            udp_test_udp_task;
+uint64_t                                    udp_test_sendmmsg_calls = 0;
+
+int __real_sendmmsg (int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags);
+
+//------------------------------------------------------------------------------
+int __wrap_sendmmsg (int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+  udp_test_sendmmsg_calls++;
+  return __real_sendmmsg(sockfd, msgvec, vlen, flags);
+}
+
+//------------------------------------------------------------------------------
+MessageDef *itti_alloc_new_message (task_id_t origin_task_id, MessagesIds message_id)
+{
+  MessageDef *message_p = calloc(1, sizeof(MessageHeader) + udp_test_message_sizes[message_id]);
+
+  DevAssert(message_p != NULL);
+  message_p->ittiMsgHeader.messageId = message_id;
+  message_p->ittiMsgHeader.originTaskId = origin_task_id;
+  message_p->ittiMsgHeader.ittiMsgSize = udp_test_message_sizes[message_id];
+  return message_p;
+}
+
+//------------------------------------------------------------------------------
+static MessageDef *udp_test_dequeue (const bool wait)
+{
+  MessageDef *message_p = NULL;
+
+  pthread_mutex_lock(&udp_test_queue.mutex);
+  while (wait && !udp_test_queue.count)
+    pthread_cond_wait(&udp_test_queue.not_empty, &udp_test_queue.mutex);
+  if (udp_test_queue.count) {
+    message_p = udp_test_queue.messages[udp_test_queue.head];
+    udp_test_queue.head = (udp_test_queue.head + 1) % UDP_TEST_QUEUE_SIZE;
+    if (udp_test_queue.count-- == UDP_TEST_QUEUE_SIZE)
+      pthread_cond_signal(&udp_test_queue.not_full);
+  }
+  pthread_mutex_unlock(&udp_test_queue.mutex);
+  return message_p;
+}
+
+//------------------------------------------------------------------------------
+int itti_send_msg_to_task (task_id_t task_id, instance_t instance, MessageDef *message)
+{
+  if (task_id != TASK_UDP) {
+    itti_free_msg_content(message);
+    free(message);
+    return 0;
+  }
+  message->ittiMsgHeader.destinationTaskId = task_id;
+  message->ittiMsgHeader.instance = instance;
+  pthread_mutex_lock(&udp_test_queue.mutex);
+  while (udp_test_queue.count == UDP_TEST_QUEUE_SIZE)
+    pthread_cond_wait(&udp_test_queue.not_full, &udp_test_queue.mutex);
+  udp_test_queue.messages[(udp_test_queue.head + udp_test_queue.count++) % UDP_TEST_QUEUE_SIZE] = message;
+  pthread_cond_signal(&udp_test_queue.not_empty);
+  pthread_mutex_unlock(&udp_test_queue.mutex);
+  return 0;
+}
+
+void itti_receive_msg (task_id_t task_id, MessageDef **received_msg) { *received_msg = udp_test_dequeue(true); }
+void itti_try_receive_msg (task_id_t task_id, MessageDef **received_msg) { *received_msg = udp_test_dequeue(false); }
+int itti_get_events (task_id_t task_id, struct epoll_event **events) { *events = NULL; return 0; }
+void itti_subscribe_event_fd (task_id_t task_id, int fd) { }
+void itti_unsubscribe_event_fd (task_id_t task_id, int fd) { }
+int itti_create_task (task_id_t task_id, void *(*start_routine) (void *), void *args_p)
+{
+  return pthread_create(&udp_test_udp_task, NULL, start_routine, args_p) ? -1 : 0;
+}
+void itti_mark_task_ready (task_id_t task_id) { }
+void itti_exit_task (void) { pthread_exit(NULL); }
+int itti_free (task_id_t task_id, void *ptr) { free(ptr); return EXIT_SUCCESS; }
+
+//------------------------------------------------------------------------------
+void itti_free_msg_content (MessageDef * const message_p)
+{
+  if (ITTI_MSG_ID(message_p) == UDP_DATA_MULTI_IND)
+    free(message_p->ittiMsg.udp_data_multi_ind.datagrams);
+}
+
+//------------------------------------------------------------------------------
+void udp_test_join_udp_task (void)
+{
+  pthread_join(udp_test_udp_task, NULL);
+}
@@ -0,0 +1,43 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_test_doubles.h
+  \brief Test doubles of the ITTI interface of the UDP task.
+  Linked into the tools built with udp_primitives_server.c, instead of the ITTI tasks. sendmmsg is wrapped at link time
+  (-Wl,--wrap=sendmmsg) to count the calls.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#ifndef FILE_UDP_TEST_DOUBLES_SEEN
+#define FILE_UDP_TEST_DOUBLES_SEEN
+
+#include <stdint.h>
+
+/** sendmmsg calls of the UDP task, read once the task terminated. */
+extern uint64_t udp_test_sendmmsg_calls;
+
+/** \brief Wait for the UDP task to terminate, after a TERMINATE_MESSAGE.
+ **/
+void udp_test_join_udp_task (void);
+
+#endif /* FILE_UDP_TEST_DOUBLES_SEEN */
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file bstr_pool.c
+  \brief Pool of preallocated bstrings used as receive buffers.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "bstr_pool.h"
+
+/** Buffers which grew beyond this multiple of the buffer size (long messages) are not kept. */
+#define BSTR_POOL_MAX_GROWTH     4
+
+//------------------------------------------------------------------------------
+static bstring bstr_pool_alloc (const int buffer_size)
+{
+  /** One more byte for the terminating '\0'. */
+  return bfromcstralloc(buffer_size + 1, "");
+}
+
+//------------------------------------------------------------------------------
+int bstr_pool_init (bstr_pool_t * const pool, const int buffer_size, const int max_free)
+{
+  if (buffer_size <= 0 || max_free < 0)
+    return -1;
+  pthread_mutex_init(&pool->mutex, NULL);
+  pool->buffer_size = buffer_size;
+  pool->max_free = max_free;
+  pool->num_free = 0;
+  pool->num_allocated = 0;
+  pool->num_reused = 0;
+  pool->free_buffers = calloc(max_free ? max_free : 1, sizeof(bstring));
+  if (!pool->free_buffers)
+    return -1;
+  while (pool->num_free < max_free) {
+    bstring b = bstr_pool_alloc(buffer_size);
+    if (!b)
+      break;
+    pool->free_buffers[pool->num_free++] = b;
+    pool->num_allocated++;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void bstr_pool_exit (bstr_pool_t * const pool)
+{
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->num_free) {
+    bdestroy(pool->free_buffers[--pool->num_free]);
+  }
+  free(pool->free_buffers);
+  pool->free_buffers = NULL;
+  pool->max_free = 0;
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+//------------------------------------------------------------------------------
+bstring bstr_pool_get (bstr_pool_t * const pool)
+{
+  bstring b = NULL;
+
+  pthread_mutex_lock(&pool->mutex);
+  if (pool->num_free) {
+    b = pool->free_buffers[--pool->num_free];
+    pool->num_reused++;
+  } else {
+    pool->num_allocated++;
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  if (!b)
+    b = bstr_pool_alloc(pool->buffer_size);
+  return b;
+}
+
+//------------------------------------------------------------------------------
+void bstr_pool_put (bstr_pool_t * const pool, bstring * const buffer)
+{
+  bstring b = *buffer;
+
+  if (!b)
+    return;
+  *buffer = NULL;
+  if (b->mlen > pool->buffer_size && b->mlen <= (BSTR_POOL_MAX_GROWTH * (pool->buffer_size + 1))) {
+    b->slen = 0;
+    b->data[0] = '\0';
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->num_free < pool->max_free) {
+      pool->free_buffers[pool->num_free++] = b;
+      b = NULL;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+  }
+  if (b)
+    bdestroy(b);
+}
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file bstr_pool.h
+  \brief Pool of preallocated bstrings used as receive buffers.
+  A receiving thread takes an empty bstring of at least the pool buffer size, reads the socket directly into its data
+  and hands it over (e.g. via ITTI) to the consumer, which puts it back into the pool once decoded. Bstrings of the pool
+  are plain bstrings, so a consumer or an error path may still bdestroy them, the pool then just allocates a new one.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#ifndef FILE_BSTR_POOL_SEEN
+#define FILE_BSTR_POOL_SEEN
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+
+typedef struct bstr_pool_s {
+  pthread_mutex_t   mutex;
+  int               buffer_size;      ///< Usable size of each buffer, without the terminating '\0'
+  int               max_free;         ///< Maximum number of buffers kept in the pool
+  int               num_free;
+  bstring          *free_buffers;
+  uint64_t          num_allocated;    ///< Buffers allocated since the pool was created (pool was empty)
+  uint64_t          num_reused;       ///< Buffers taken from the pool
+} bstr_pool_t;
+
+/** \brief Initialize the pool and preallocate max_free buffers of buffer_size bytes.
+ * @returns 0 on success, -1 on error
+ **/
+int bstr_pool_init (bstr_pool_t * const pool, const int buffer_size, const int max_free);
+
+/** \brief Release all buffers kept in the pool. Buffers still in use may be put back or destroyed later.
+ **/
+void bstr_pool_exit (bstr_pool_t * const pool);
+
+/** \brief Take an empty buffer (slen 0, mlen > buffer_size) from the pool or allocate a new one.
+ * @returns NULL if no memory is left
+ **/
+bstring bstr_pool_get (bstr_pool_t * const pool);
+
+/** \brief Give the buffer back to the pool (or destroy it, if the pool is full or the buffer grew too large) and reset the reference.
+ **/
+void bstr_pool_put (bstr_pool_t * const pool, bstring * const buffer);
+
+#endif /* FILE_BSTR_POOL_SEEN */
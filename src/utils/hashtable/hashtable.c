@@ -361,6 +361,9 @@ hashtable_ts_destroy (
   free_wrapper ((void**)&hashtblP->nodes);
   bdestroy_wrapper (&hashtblP->name);
   free_wrapper((void**)&hashtblP->lock_nodes);
+  /** Free functions of other tables may still iterate over this one, leave it empty. */
+  hashtblP->size = 0;
+  hashtblP->num_elements = 0;
   if (hashtblP->is_allocated_by_malloc) {
     free_wrapper ((void**)&hashtblP);
   }
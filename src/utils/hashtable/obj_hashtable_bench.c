@@ -0,0 +1,409 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file obj_hashtable_bench.c
+  \brief Benchmark and hash quality report for the object hashtables (obj_hashtable, obj_hashtable_uint64).
+  Loads key sets shaped like the keys used in the MCE (random, sequential TEIDs, TMGIs, IPv4/TEID tuples),
+  reports the chain length histogram, the probe counts and the ns/op of insert/get/remove and flags clustering.
+  \author Dincer BEKEN
+  \company Blackned GmbH
+  \email: dbeken@blackned.de
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "bstrlib.h"
+
+#include "3gpp_23.003.h"
+#include "obj_hashtable.h"
+#include "dynamic_memory_check.h"
+
+#define BENCH_DEFAULT_NUM_KEYS        65536
+#define BENCH_DEFAULT_TABLE_SIZE      16384
+#define BENCH_CHAIN_HISTOGRAM_SIZE    10     /**< Last slot counts all longer chains. */
+/**
+ * Successful lookups needing more than this factor of the probes of a uniform hash, or more than this factor of
+ * the empty buckets of a uniform hash (plus 5% of the buckets) are reported as clustered.
+ */
+#define BENCH_CLUSTERING_FACTOR       1.5
+
+typedef enum {
+  KEY_SET_RANDOM = 0,
+  KEY_SET_SEQUENTIAL,
+  KEY_SET_TMGI,
+  KEY_SET_IPV4_TEID,
+  KEY_SET_MAX
+} key_set_type_t;
+
+static const char * const key_set_str[KEY_SET_MAX] = {"random", "sequential", "tmgi", "ipv4-teid"};
+
+/** IPv4/TEID tuple, as used to identify a GTP tunnel endpoint of a peer. */
+typedef struct ipv4_teid_key_s {
+  uint32_t    ipv4_address;
+  uint32_t    teid;
+} ipv4_teid_key_t;
+
+typedef struct key_set_s {
+  key_set_type_t  type;
+  int             num_keys;
+  int             key_size;
+  uint8_t        *keys;      /**< num_keys * key_size bytes. */
+  uint8_t        *miss_keys; /**< Keys not in the set, same shape. */
+} key_set_t;
+
+typedef struct hash_func_desc_s {
+  const char   *name;
+  hash_size_t (*hashfunc)(const void*, int); /**< NULL selects the default hash function of the hashtable. */
+} hash_func_desc_t;
+
+typedef struct bench_result_s {
+  double      insert_ns;
+  double      get_ns;
+  double      get_miss_ns;
+  double      remove_ns;
+  double      uint64_insert_ns;
+  double      uint64_get_ns;
+  double      uint64_remove_ns;
+  hash_size_t num_buckets;
+  hash_size_t num_empty_buckets;
+  hash_size_t max_chain;
+  hash_size_t histogram[BENCH_CHAIN_HISTOGRAM_SIZE];
+  double      probes_hit;
+  double      probes_miss;
+  double      expected_probes_hit;
+} bench_result_t;
+
+//------------------------------------------------------------------------------
+static uint64_t bench_rand_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t bench_rand (void)
+{
+  /** xorshift64*, reproducible between runs. */
+  bench_rand_state ^= bench_rand_state >> 12;
+  bench_rand_state ^= bench_rand_state << 25;
+  bench_rand_state ^= bench_rand_state >> 27;
+  return bench_rand_state * 0x2545F4914F6CDD1DULL;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t bench_now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * FNV-1a, as alternative to the default hash function of the object hashtables, which XORs the key in 32 bit words.
+ */
+static hash_size_t bench_fnv1a_hashfunc (const void * const keyP, const int key_sizeP)
+{
+  uint64_t       hash = 0xcbf29ce484222325ULL;
+  const uint8_t *key  = (const uint8_t*)keyP;
+  for (int i = 0; i < key_sizeP; i++) {
+    hash ^= key[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return (hash_size_t)hash;
+}
+
+static const hash_func_desc_t bench_hash_funcs[] = {
+  {"default", NULL},
+  {"fnv1a",   bench_fnv1a_hashfunc},
+};
+#define BENCH_NUM_HASH_FUNCS (sizeof(bench_hash_funcs)/sizeof(bench_hash_funcs[0]))
+
+//------------------------------------------------------------------------------
+static void bench_no_free_data_func (void ** data)
+{
+  ; // data is the index of the key, not allocated
+}
+
+//------------------------------------------------------------------------------
+static void bench_fill_key (const key_set_type_t type, const int index, const bool miss, uint8_t * const key)
+{
+  switch (type) {
+  case KEY_SET_RANDOM: {
+    uint64_t val = bench_rand();
+    memcpy(key, &val, sizeof(val));
+  }
+  break;
+  case KEY_SET_SEQUENTIAL: {
+    /** Sequentially allocated TEIDs, misses are just beyond the allocated range. */
+    uint32_t teid = (miss ? 0x80000000 : 0x00000001) + index;
+    memcpy(key, &teid, sizeof(teid));
+  }
+  break;
+  case KEY_SET_TMGI: {
+    /** Sequential MBMS Service Ids spread over a few PLMNs. Padding bytes are zeroed, since the whole struct is hashed. */
+    static const uint16_t mnc[] = {1, 2, 3, 93};
+    tmgi_t tmgi;
+    memset(&tmgi, 0, sizeof(tmgi));
+    tmgi.mbms_service_id  = ((miss ? 0x800000 : 0x000001) + (index / 4)) & 0xFFFFFF;
+    tmgi.plmn.mcc_digit1  = 2;
+    tmgi.plmn.mcc_digit2  = 6;
+    tmgi.plmn.mcc_digit3  = 2;
+    tmgi.plmn.mnc_digit1  = (mnc[index % 4] / 10) % 10;
+    tmgi.plmn.mnc_digit2  = mnc[index % 4] % 10;
+    tmgi.plmn.mnc_digit3  = 0xF;
+    memcpy(key, &tmgi, sizeof(tmgi));
+  }
+  break;
+  case KEY_SET_IPV4_TEID: {
+    /** A few peers (10.0.x.1), each allocating sequential TEIDs. */
+    ipv4_teid_key_t tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    tuple.ipv4_address = 0x0A000001 | (((index % 16) + (miss ? 16 : 0)) << 8);
+    tuple.teid         = 1 + (index / 16);
+    memcpy(key, &tuple, sizeof(tuple));
+  }
+  break;
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static int bench_create_key_set (key_set_t * const key_set, const key_set_type_t type, const int num_keys)
+{
+  static const int key_sizes[KEY_SET_MAX] = {sizeof(uint64_t), sizeof(uint32_t), sizeof(tmgi_t), sizeof(ipv4_teid_key_t)};
+  memset(key_set, 0, sizeof(*key_set));
+  key_set->type      = type;
+  key_set->num_keys  = num_keys;
+  key_set->key_size  = key_sizes[type];
+  key_set->keys      = calloc(num_keys, key_set->key_size);
+  key_set->miss_keys = calloc(num_keys, key_set->key_size);
+  if (!key_set->keys || !key_set->miss_keys) {
+    free_wrapper((void**)&key_set->keys);
+    free_wrapper((void**)&key_set->miss_keys);
+    return -1;
+  }
+  bench_rand_state = 0x9E3779B97F4A7C15ULL;
+  for (int i = 0; i < num_keys; i++) {
+    bench_fill_key(type, i, false, &key_set->keys[i * key_set->key_size]);
+    bench_fill_key(type, i, true, &key_set->miss_keys[i * key_set->key_size]);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void bench_analyze_chains (const obj_hash_table_t * const hashtbl, bench_result_t * const result)
+{
+  double sum_hit_probes = 0;
+  double sum_miss_probes = 0;
+
+  result->num_buckets = hashtbl->size;
+  for (hash_size_t n = 0; n < hashtbl->size; n++) {
+    hash_size_t chain = 0;
+    for (const obj_hash_node_t * node = hashtbl->nodes[n]; node; node = node->next) {
+      chain++;
+    }
+    if (!chain)
+      result->num_empty_buckets++;
+    if (chain > result->max_chain)
+      result->max_chain = chain;
+    result->histogram[(chain < BENCH_CHAIN_HISTOGRAM_SIZE - 1) ? chain : (BENCH_CHAIN_HISTOGRAM_SIZE - 1)]++;
+    /** The i-th element of a chain needs i probes, a miss walks the whole chain. */
+    sum_hit_probes  += (double)chain * (chain + 1) / 2;
+    sum_miss_probes += (double)chain * chain;
+  }
+  if (hashtbl->num_elements) {
+    result->probes_hit  = sum_hit_probes / hashtbl->num_elements;
+    /** Misses weighted by the number of keys hashing to the bucket, equals the load factor for a uniform hash. */
+    result->probes_miss = sum_miss_probes / hashtbl->num_elements;
+    result->expected_probes_hit = 1.0 + ((double)hashtbl->num_elements - 1) / (2.0 * hashtbl->size);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int bench_run (const key_set_t * const key_set, const hash_func_desc_t * const hash_func, const hash_size_t table_size, bench_result_t * const result)
+{
+  obj_hash_table_t         *hashtbl = NULL;
+  obj_hash_table_uint64_t  *hashtbl_uint64 = NULL;
+  void                     *data = NULL;
+  uint64_t                  data_uint64 = 0;
+  uint64_t                  t0 = 0;
+  const int                 n = key_set->num_keys;
+  bstring                   bs = bfromcstr("obj_hashtable_bench");
+
+  memset(result, 0, sizeof(*result));
+  /** Keys are copied by the hashtable, the data is not allocated. */
+  if (!(hashtbl = obj_hashtable_create(table_size, hash_func->hashfunc, NULL, bench_no_free_data_func, bs))) {
+    bdestroy_wrapper(&bs);
+    return -1;
+  }
+  hashtbl->log_enabled = false;
+
+  /** Object hashtable. */
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_insert(hashtbl, &key_set->keys[i * key_set->key_size], key_set->key_size, (void*)(uintptr_t)(i + 1));
+  }
+  result->insert_ns = (double)(bench_now_ns() - t0) / n;
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_get(hashtbl, &key_set->keys[i * key_set->key_size], key_set->key_size, &data);
+  }
+  result->get_ns = (double)(bench_now_ns() - t0) / n;
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_get(hashtbl, &key_set->miss_keys[i * key_set->key_size], key_set->key_size, &data);
+  }
+  result->get_miss_ns = (double)(bench_now_ns() - t0) / n;
+
+  /** Distribution is analyzed on the full table. */
+  bench_analyze_chains(hashtbl, result);
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_remove(hashtbl, &key_set->keys[i * key_set->key_size], key_set->key_size, &data);
+  }
+  result->remove_ns = (double)(bench_now_ns() - t0) / n;
+
+  obj_hashtable_destroy(hashtbl);
+
+  /** Object hashtable with uint64 values, same key set and hash function. */
+  if (!(hashtbl_uint64 = obj_hashtable_uint64_create(table_size, hash_func->hashfunc, NULL, bs))) {
+    bdestroy_wrapper(&bs);
+    return -1;
+  }
+  hashtbl_uint64->log_enabled = false;
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_uint64_insert(hashtbl_uint64, &key_set->keys[i * key_set->key_size], key_set->key_size, (uint64_t)i);
+  }
+  result->uint64_insert_ns = (double)(bench_now_ns() - t0) / n;
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_uint64_get(hashtbl_uint64, &key_set->keys[i * key_set->key_size], key_set->key_size, &data_uint64);
+  }
+  result->uint64_get_ns = (double)(bench_now_ns() - t0) / n;
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < n; i++) {
+    obj_hashtable_uint64_remove(hashtbl_uint64, &key_set->keys[i * key_set->key_size], key_set->key_size);
+  }
+  result->uint64_remove_ns = (double)(bench_now_ns() - t0) / n;
+  obj_hashtable_uint64_destroy(hashtbl_uint64);
+
+  bdestroy_wrapper(&bs);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static bool bench_report (const key_set_t * const key_set, const hash_func_desc_t * const hash_func, const bench_result_t * const result)
+{
+  const double load = (double)key_set->num_keys / result->num_buckets;
+  /** Fraction of empty buckets of a uniform hash is e^-load. */
+  const double expected_empty = exp(-load) * result->num_buckets;
+  const bool clustered = (result->probes_hit > (BENCH_CLUSTERING_FACTOR * result->expected_probes_hit))
+      || (result->num_empty_buckets > (BENCH_CLUSTERING_FACTOR * expected_empty + 0.05 * result->num_buckets));
+
+  printf("%-10s %-8s keys %-7d buckets %-7zu load %.2f empty %5.1f%% max chain %-5zu probes hit %.2f (uniform %.2f) miss %.2f  %s\n",
+      key_set_str[key_set->type], hash_func->name, key_set->num_keys, result->num_buckets, load,
+      100.0 * result->num_empty_buckets / result->num_buckets,
+      result->max_chain, result->probes_hit, result->expected_probes_hit, result->probes_miss,
+      clustered ? "CLUSTERED" : "ok");
+  printf("    obj_hashtable        ns/op insert %7.1f get %7.1f get(miss) %7.1f remove %7.1f\n",
+      result->insert_ns, result->get_ns, result->get_miss_ns, result->remove_ns);
+  printf("    obj_hashtable_uint64 ns/op insert %7.1f get %7.1f                   remove %7.1f\n",
+      result->uint64_insert_ns, result->uint64_get_ns, result->uint64_remove_ns);
+  printf("    chain length histogram:");
+  for (int i = 0; i < BENCH_CHAIN_HISTOGRAM_SIZE; i++) {
+    printf(" %d%s:%zu", i, (i == BENCH_CHAIN_HISTOGRAM_SIZE - 1) ? "+" : "", result->histogram[i]);
+  }
+  printf("\n");
+  return clustered;
+}
+
+//------------------------------------------------------------------------------
+static void usage (const char * const exe_name)
+{
+  fprintf(stderr, "Usage: %s [-n num_keys] [-s table_size] [-k random|sequential|tmgi|ipv4-teid|all] [-f default|fnv1a|all]\n", exe_name);
+  fprintf(stderr, "  -n  Number of keys per key set (default %d)\n", BENCH_DEFAULT_NUM_KEYS);
+  fprintf(stderr, "  -s  Number of buckets, rounded up to a power of 2 by the hashtable (default %d)\n", BENCH_DEFAULT_TABLE_SIZE);
+  fprintf(stderr, "  -k  Key set (default all)\n");
+  fprintf(stderr, "  -f  Hash function (default all)\n");
+  fprintf(stderr, "Exit code is 2 if clustering was detected for any combination.\n");
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int          num_keys   = BENCH_DEFAULT_NUM_KEYS;
+  hash_size_t  table_size = BENCH_DEFAULT_TABLE_SIZE;
+  const char  *key_set_name  = "all";
+  const char  *hash_func_name = "all";
+  bool         clustered  = false;
+  int          opt = 0;
+
+  while ((opt = getopt(argc, argv, "n:s:k:f:h")) != -1) {
+    switch (opt) {
+    case 'n': num_keys   = atoi(optarg); break;
+    case 's': table_size = (hash_size_t)strtoul(optarg, NULL, 0); break;
+    case 'k': key_set_name   = optarg; break;
+    case 'f': hash_func_name = optarg; break;
+    default:
+      usage(argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (num_keys <= 0 || !table_size) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  for (key_set_type_t type = KEY_SET_RANDOM; type < KEY_SET_MAX; type++) {
+    key_set_t key_set;
+    if (strcmp(key_set_name, "all") && strcmp(key_set_name, key_set_str[type]))
+      continue;
+    if (bench_create_key_set(&key_set, type, num_keys)) {
+      fprintf(stderr, "Could not allocate key set %s\n", key_set_str[type]);
+      return 1;
+    }
+    for (int f = 0; f < BENCH_NUM_HASH_FUNCS; f++) {
+      bench_result_t result;
+      if (strcmp(hash_func_name, "all") && strcmp(hash_func_name, bench_hash_funcs[f].name))
+        continue;
+      if (bench_run(&key_set, &bench_hash_funcs[f], table_size, &result)) {
+        fprintf(stderr, "Could not create hashtable of size %zu\n", table_size);
+        return 1;
+      }
+      clustered |= bench_report(&key_set, &bench_hash_funcs[f], &result);
+    }
+    free_wrapper((void**)&key_set.keys);
+    free_wrapper((void**)&key_set.miss_keys);
+  }
+  return clustered ? 2 : 0;
+}
@@ -68,10 +68,29 @@
  * SCTP Constants
  ******************************************************************************/
 
-#define SCTP_RECV_BUFFER_SIZE (1 << 16)
+#define SCTP_RECV_BUFFER_SIZE (1 << 11) ///< Pooled receive buffer, fits the M2AP messages. Longer messages grow their buffer while being read
+#define SCTP_RECV_BUFFER_POOL_SIZE (64) ///< Receive buffers kept for reuse, the others are allocated on demand
 #define SCTP_OUT_STREAMS      (32)
 #define SCTP_IN_STREAMS       (32)
 #define SCTP_MAX_ATTEMPTS     (5)
+#define SCTP_EPOLL_MAX_EVENTS (64)  ///< Socket events handled per wakeup of the SCTP receiver
+#define SCTP_RECEIVER_THREADS (1)   ///< Threads reading the eNB associations, each association is read by one of them
+
+/*******************************************************************************
+ * UDP Constants
+ ******************************************************************************/
+
+#define UDP_RECV_BATCH        (32)  ///< Datagrams read with one recvmmsg and delivered with one UDP_DATA_MULTI_IND
+#define UDP_RECV_MAX_BATCHES  (8)   ///< Batches read from a socket per wakeup, before the ITTI messages are served again
+#define UDP_SEND_BATCH        (32)  ///< Queued UDP_DATA_REQ datagrams of a socket written with one sendmmsg
+#define UDP_SEND_MAX_DELAY_US (500) ///< Longest hold of a partial send batch while further ITTI messages keep the UDP task busy
+#define UDP_LISTENER_SOCKETS  (1)   ///< SO_REUSEPORT sockets on a well known port, each served by its own thread
+#define UDP_LISTENER_POLL_TIMEOUT_MS  (100)  ///< Poll timeout of a listener thread, bounds the time to stop it
+#define SM_STACK_SHARDS       (1)   ///< GTPv2-C stacks of Sm, each with its own thread if more than one
+#define SM_ECHO_INTERVAL_SEC  (60)  ///< Echo Request period towards each MBMS-GW (TS 29.274 7.6: not more often than every 60s)
+#define SM_ECHO_T3_SEC        (3)   ///< Echo Response timeout
+#define SM_ECHO_N3            (3)   ///< Echo Request retransmissions before the path to the MBMS-GW is down
+#define SCTP_RESERVED_FDS     (256) ///< Open files needed besides the eNB associations
 
 /*******************************************************************************
  * MME global definitions